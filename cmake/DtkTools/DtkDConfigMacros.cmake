@@ -12,8 +12,8 @@ function(dtk_add_config_to_cpp OUTPUT_VAR JSON_FILE)
 
     cmake_parse_arguments(
         "arg"
-        ""
-        "OUTPUT_FILE_NAME;CLASS_NAME"
+        "COALESCE_SETTERS;DIRECT"
+        "OUTPUT_FILE_NAME;CLASS_NAME;COALESCE_INTERVAL"
         ""
         ${ARGN}
     )
@@ -33,10 +33,24 @@ function(dtk_add_config_to_cpp OUTPUT_VAR JSON_FILE)
         set(CLASS_NAME_ARG "")
     endif()
 
+    # Coalesce the values written by the setters
+    set(COALESCE_ARG "")
+    if(arg_COALESCE_SETTERS)
+        list(APPEND COALESCE_ARG --coalesce-setters)
+    endif()
+    if(DEFINED arg_COALESCE_INTERVAL)
+        list(APPEND COALESCE_ARG --coalesce-interval ${arg_COALESCE_INTERVAL})
+    endif()
+
+    # Hold the DConfig in the thread of the generated object
+    if(arg_DIRECT)
+        list(APPEND COALESCE_ARG --direct)
+    endif()
+
     # Add a custom command to run dconfig2cpp
     add_custom_command(
         OUTPUT ${OUTPUT_HEADER}
-        COMMAND ${DTK_DCONFIG2CPP} -o ${OUTPUT_HEADER} ${CLASS_NAME_ARG} ${JSON_FILE}
+        COMMAND ${DTK_DCONFIG2CPP} -o ${OUTPUT_HEADER} ${CLASS_NAME_ARG} ${COALESCE_ARG} ${JSON_FILE}
         DEPENDS ${JSON_FILE} ${DTK_XML2CPP}
         COMMENT "Generating ${OUTPUT_HEADER} from ${JSON_FILE}"
         VERBATIM
@@ -147,5 +147,84 @@ private:
     qint64 m_code;
     QString m_msg;
 };
+
+/**
+ * @brief 轻量的错误类型，只保存错误代码和静态的错误信息，可平凡复制，构造和复制时不分配内存
+ * @note 错误信息需要是静态存储的字符串，例如字符串字面量，在调用 getErrorMessage 或转换为 DError 时才格式化为 QString。
+ * 期待类型也可平凡复制时，Dtk::Core::DExpected<T, DErrorCode> 同样可平凡复制
+ */
+class DErrorCode
+{
+public:
+    /*!
+     * @brief 默认构造函数
+     * @attention 错误代码默认为-1，错误信息默认为空
+     */
+    constexpr DErrorCode() noexcept
+        : m_code(-1)
+        , m_msg(nullptr)
+    {
+    }
+
+    /*!
+     * @brief 构造函数
+     * @param[in] code 错误代码
+     * @param[in] msg  静态的错误信息，使用 UTF-8 编码
+     */
+    constexpr DErrorCode(qint64 code, const char *msg = nullptr) noexcept
+        : m_code(code)
+        , m_msg(msg)
+    {
+    }
+
+    /*!
+     * @brief 获取错误代码
+     * @return 错误代码
+     */
+    constexpr qint64 getErrorCode() const noexcept { return m_code; }
+
+    /*!
+     * @brief 获取未格式化的错误信息
+     * @return 构造时传入的静态字符串，可能为空指针
+     */
+    constexpr const char *errorMessageData() const noexcept { return m_msg; }
+
+    /*!
+     * @brief 获取错误信息
+     * @return 格式化后的错误信息
+     */
+    QString getErrorMessage() const { return QString::fromUtf8(m_msg); }
+
+    /*!
+     * @brief 转换为 DError
+     */
+    operator DError() const { return DError(m_code, getErrorMessage()); }
+
+    /*!
+     * @brief 重载相等运算符
+     */
+    friend bool operator==(const DErrorCode &x, const DErrorCode &y) noexcept
+    {
+        return x.m_code == y.m_code and (x.m_msg == y.m_msg or (x.m_msg and y.m_msg and qstrcmp(x.m_msg, y.m_msg) == 0));
+    }
+
+    /*!
+     * @brief 重载不等运算符
+     */
+    friend bool operator!=(const DErrorCode &x, const DErrorCode &y) noexcept { return !(x == y); }
+
+    /*!
+     * @brief 重载输出运算符
+     */
+    friend QDebug operator<<(QDebug debug, const DErrorCode &e)
+    {
+        debug << "Error Code:" << e.m_code << "Message:" << e.m_msg;
+        return debug;
+    }
+
+private:
+    qint64 m_code;
+    const char *m_msg;
+};
 DCORE_END_NAMESPACE
 #endif
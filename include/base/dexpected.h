@@ -142,7 +142,11 @@ struct Guard
     Guard(const Guard &) = delete;
     Guard &operator=(const Guard &) = delete;
 
-    T &&release() noexcept { return std::move(m_tmp); }
+    T &&release() noexcept
+    {
+        m_guarded = nullptr;
+        return std::move(m_tmp);
+    }
 
 private:
     T *m_guarded;
@@ -364,6 +368,186 @@ private:
     E m_error;
 };
 
+namespace __dexpected {
+
+struct _void_value
+{
+};
+
+// the value or the error is the result of a function, it's constructed in place
+struct _invoke_value_tag
+{
+};
+
+struct _invoke_error_tag
+{
+};
+
+/*!
+ * @brief Dtk::Core::DExpected的存储，期待类型和不期待类型都可平凡复制时，Dtk::Core::DExpected也可平凡复制，
+ * 复制和析构时不需要判断保有的值
+ */
+template <typename T, typename E, bool = std::is_trivially_copyable<T>::value and std::is_trivially_copyable<E>::value>
+struct _storage
+{
+    template <typename... Args>
+    constexpr explicit _storage(emplace_tag, Args &&...args) noexcept(std::is_nothrow_constructible<T, Args...>::value)
+        : m_has_value(true)
+        , m_value(std::forward<Args>(args)...)
+    {
+    }
+
+    template <typename... Args>
+    constexpr explicit _storage(dunexpected_tag, Args &&...args) noexcept(std::is_nothrow_constructible<E, Args...>::value)
+        : m_has_value(false)
+        , m_error(std::forward<Args>(args)...)
+    {
+    }
+
+    // the value or the error is constructed later
+    explicit _storage(bool has_value) noexcept
+        : m_has_value(has_value)
+    {
+    }
+
+    template <typename F, typename... Args>
+    constexpr explicit _storage(_invoke_value_tag, F &&_f, Args &&...args)
+        : m_has_value(true)
+        , m_value(std::forward<F>(_f)(std::forward<Args>(args)...))
+    {
+    }
+
+    template <typename F, typename... Args>
+    constexpr explicit _storage(_invoke_error_tag, F &&_f, Args &&...args)
+        : m_has_value(false)
+        , m_error(std::forward<F>(_f)(std::forward<Args>(args)...))
+    {
+    }
+
+    bool m_has_value;
+    union
+    {
+        T m_value;
+        E m_error;
+    };
+};
+
+template <typename T, typename E>
+struct _storage<T, E, false>
+{
+    template <typename... Args>
+    constexpr explicit _storage(emplace_tag, Args &&...args) noexcept(std::is_nothrow_constructible<T, Args...>::value)
+        : m_has_value(true)
+        , m_value(std::forward<Args>(args)...)
+    {
+    }
+
+    template <typename... Args>
+    constexpr explicit _storage(dunexpected_tag, Args &&...args) noexcept(std::is_nothrow_constructible<E, Args...>::value)
+        : m_has_value(false)
+        , m_error(std::forward<Args>(args)...)
+    {
+    }
+
+    explicit _storage(bool has_value) noexcept
+        : m_has_value(has_value)
+    {
+    }
+
+    template <typename F, typename... Args>
+    constexpr explicit _storage(_invoke_value_tag, F &&_f, Args &&...args)
+        : m_has_value(true)
+        , m_value(std::forward<F>(_f)(std::forward<Args>(args)...))
+    {
+    }
+
+    template <typename F, typename... Args>
+    constexpr explicit _storage(_invoke_error_tag, F &&_f, Args &&...args)
+        : m_has_value(false)
+        , m_error(std::forward<F>(_f)(std::forward<Args>(args)...))
+    {
+    }
+
+    _storage(const _storage &_x) noexcept(
+        std::is_nothrow_copy_constructible<T>::value and std::is_nothrow_copy_constructible<E>::value)
+        : m_has_value(_x.m_has_value)
+    {
+        if (m_has_value)
+            construct_at(std::addressof(m_value), _x.m_value);
+        else
+            construct_at(std::addressof(m_error), _x.m_error);
+    }
+
+    _storage(_storage &&_x) noexcept(
+        std::is_nothrow_move_constructible<T>::value and std::is_nothrow_move_constructible<E>::value)
+        : m_has_value(_x.m_has_value)
+    {
+        if (m_has_value)
+            construct_at(std::addressof(m_value), std::move(_x.m_value));
+        else
+            construct_at(std::addressof(m_error), std::move(_x.m_error));
+    }
+
+    _storage &operator=(const _storage &_x)
+    {
+        if (_x.m_has_value)
+            assign_value(_x.m_value);
+        else
+            assign_error(_x.m_error);
+        return *this;
+    }
+
+    _storage &operator=(_storage &&_x) noexcept(
+        std::is_nothrow_move_constructible<T>::value and std::is_nothrow_move_constructible<E>::value and
+        std::is_nothrow_move_assignable<T>::value and std::is_nothrow_move_assignable<E>::value)
+    {
+        if (_x.m_has_value)
+            assign_value(std::move(_x.m_value));
+        else
+            assign_error(std::move(_x.m_error));
+        return *this;
+    }
+
+    ~_storage()
+    {
+        if (m_has_value)
+            __dexpected::destroy_at_obj(std::addressof(m_value));
+        else
+            __dexpected::destroy_at_obj(std::addressof(m_error));
+    }
+
+    template <typename V>
+    void assign_value(V &&_v)
+    {
+        if (m_has_value) {
+            m_value = std::forward<V>(_v);
+        } else {
+            reinit(std::addressof(m_value), std::addressof(m_error), std::forward<V>(_v));
+            m_has_value = true;
+        }
+    }
+
+    template <typename V>
+    void assign_error(V &&_v)
+    {
+        if (m_has_value) {
+            reinit(std::addressof(m_error), std::addressof(m_value), std::forward<V>(_v));
+            m_has_value = false;
+        } else {
+            m_error = std::forward<V>(_v);
+        }
+    }
+
+    bool m_has_value;
+    union
+    {
+        T m_value;
+        E m_error;
+    };
+};
+
+}  // namespace __dexpected
+
 /*!
  * @brief
  * 模板类Dtk::Core::DExpected提供存储两个值之一的方式。Dtk::Core::DExpected的对象要么保有一个期待的T类型值，要么保有一个不期待的E类型值，不会没有值。
@@ -372,10 +556,11 @@ private:
  * @note 该类自DtkCore 5.6.3引入
  */
 template <typename T, typename E = DError>
-class DExpected
+class DExpected : private __dexpected::_storage<T, E>
 {
     template <typename, typename>
     friend class DExpected;
+    using _Storage = __dexpected::_storage<T, E>;
     static_assert(!std::is_reference<T>::value, "type T can't be reference type");
     static_assert(!std::is_function<T>::value, "type T can't be function type");
     static_assert(!std::is_same<typename std::remove_cv<T>::type, dunexpected_tag>::value, "type T can't be dunexpected_tag");
@@ -402,11 +587,6 @@ class DExpected
         return !std::is_convertible<U, T>::value or !std::is_convertible<G, E>::value;
     }
 
-    static constexpr bool des_value()
-    {
-        return !std::is_trivially_destructible<T>::value or !std::is_trivially_destructible<E>::value;
-    }
-
     template <typename V>
     void assign_val(V &&_v)
     {
@@ -463,42 +643,33 @@ public:
     /*!
      * @brief Dtk::Core::DExpected的默认构造函数
      */
-    template <typename std::enable_if<std::is_default_constructible<T>::value, bool>::type = true>
+    template <typename U = T, typename std::enable_if<std::is_default_constructible<U>::value, bool>::type = true>
     constexpr DExpected() noexcept(std::is_nothrow_default_constructible<T>::value)
-        : m_has_value(true)
-        , m_value()
+        : _Storage(emplace_tag::USE_EMPLACE)
     {
     }
 
     /*!
      * @brief Dtk::Core::DExpected的拷贝构造函数
+     * @note 期待类型和不期待类型都可平凡复制时，该函数是平凡的
      */
-    template <
-        typename std::enable_if<std::is_copy_constructible<T>::value and std::is_copy_constructible<E>::value, bool>::type = true>
-    DExpected(const DExpected &_x) noexcept(
-        std::is_nothrow_copy_constructible<T>::value and std::is_nothrow_copy_constructible<E>::value)
-        : m_has_value(_x.m_has_value)
-    {
-        if (m_has_value)
-            construct_at(std::addressof(m_value), _x.m_value);
-        else
-            construct_at(std::addressof(m_error), _x.m_error);
-    }
+    DExpected(const DExpected &) = default;
 
     /*!
      * @brief Dtk::Core::DExpected的移动构造函数
      */
-    template <
-        typename std::enable_if<std::is_move_constructible<T>::value and std::is_move_constructible<E>::value, bool>::type = true>
-    DExpected(DExpected &&_x) noexcept(
-        std::is_nothrow_move_constructible<T>::value and std::is_nothrow_move_constructible<E>::value)
-        : m_has_value(_x.m_has_value)
-    {
-        if (m_has_value)
-            construct_at(std::addressof(m_value), std::move(_x).m_value);
-        else
-            construct_at(std::addressof(m_error), std::move(_x).m_error);
-    }
+    DExpected(DExpected &&) = default;
+
+    /*!
+     * @brief Dtk::Core::DExpected的拷贝赋值运算符
+     */
+    DExpected &operator=(const DExpected &) = default;
+
+    /*!
+     * @brief Dtk::Core::DExpected的移动赋值运算符
+     * @attention 赋值后原对象不可用
+     */
+    DExpected &operator=(DExpected &&) = default;
 
     /*!
      * @brief Dtk::Core::DExpected的拷贝构造函数
@@ -514,7 +685,7 @@ public:
                                 bool>::type = true>
     DExpected(const DExpected<U, G> &_x) noexcept(
         std::is_nothrow_constructible<T, const U &>::value and std::is_nothrow_constructible<E, const G &>::value)
-        : m_has_value(_x.m_has_value)
+        : _Storage(_x.m_has_value)
     {
         if (m_has_value)
             construct_at(std::addressof(m_value), _x.m_value);
@@ -537,7 +708,7 @@ public:
                                 bool>::type = true>
     explicit DExpected(const DExpected<U, G> &_x) noexcept(
         std::is_nothrow_constructible<T, const U &>::value and std::is_nothrow_constructible<E, const G &>::value)
-        : m_has_value(_x.m_has_value)
+        : _Storage(_x.m_has_value)
     {
         if (m_has_value)
             construct_at(std::addressof(m_value), _x.m_value);
@@ -559,7 +730,7 @@ public:
                                       bool>::type = true>
     DExpected(DExpected<U, G> &&_x) noexcept(
         std::is_nothrow_constructible<T, U>::value and std::is_nothrow_constructible<E, G>::value)
-        : m_has_value(_x.m_has_value)
+        : _Storage(_x.m_has_value)
     {
         if (m_has_value)
             construct_at(std::addressof(m_value), std::move(_x).m_value);
@@ -581,7 +752,7 @@ public:
                                       bool>::type = true>
     explicit DExpected(DExpected<U, G> &&_x) noexcept(
         std::is_nothrow_constructible<T, U>::value and std::is_nothrow_constructible<E, G>::value)
-        : m_has_value(_x.m_has_value)
+        : _Storage(_x.m_has_value)
     {
         if (m_has_value)
             construct_at(std::addressof(m_value), std::move(_x).m_value);
@@ -603,8 +774,7 @@ public:
                                           std::is_constructible<T, U>::value and !std::is_convertible<U, T>::value,
                                       bool>::type = true>
     constexpr explicit DExpected(U &&_v) noexcept(std::is_nothrow_constructible<T, U>::value)
-        : m_has_value(true)
-        , m_value(std::forward<U>(_v))
+        : _Storage(emplace_tag::USE_EMPLACE, std::forward<U>(_v))
 
     {
     }
@@ -623,8 +793,7 @@ public:
                                           std::is_constructible<T, U>::value and std::is_convertible<U, T>::value,
                                       bool>::type = true>
     constexpr DExpected(U &&_v) noexcept(std::is_nothrow_constructible<T, U>::value)
-        : m_has_value(true)
-        , m_value(std::forward<U>(_v))
+        : _Storage(emplace_tag::USE_EMPLACE, std::forward<U>(_v))
     {
     }
 
@@ -639,8 +808,7 @@ public:
               typename std::enable_if<std::is_constructible<E, const G &>::value and !std::is_convertible<const G &, E>::value,
                                       bool>::type = true>
     constexpr explicit DExpected(const DUnexpected<G> &_u) noexcept(std::is_nothrow_constructible<E, const G &>::value)
-        : m_has_value(false)
-        , m_error(_u.error())
+        : _Storage(dunexpected_tag::DUNEXPECTED, _u.error())
     {
     }
 
@@ -654,8 +822,7 @@ public:
               typename std::enable_if<std::is_constructible<E, const G &>::value and std::is_convertible<const G &, E>::value,
                                       bool>::type = true>
     constexpr DExpected(const DUnexpected<G> &_u) noexcept(std::is_nothrow_constructible<E, const G &>::value)
-        : m_has_value(false)
-        , m_error(_u.error())
+        : _Storage(dunexpected_tag::DUNEXPECTED, _u.error())
     {
     }
 
@@ -670,8 +837,7 @@ public:
         typename G = E,
         typename std::enable_if<std::is_constructible<E, G>::value and !std::is_convertible<G, E>::value, bool>::type = true>
     constexpr explicit DExpected(DUnexpected<G> &&_u) noexcept(std::is_nothrow_constructible<E, G>::value)
-        : m_has_value(false)
-        , m_error(std::move(_u).error())
+        : _Storage(dunexpected_tag::DUNEXPECTED, std::move(_u).error())
     {
     }
 
@@ -685,8 +851,7 @@ public:
     template <typename G = E,
               typename std::enable_if<std::is_constructible<E, G>::value and std::is_convertible<G, E>::value, bool>::type = true>
     constexpr DExpected(DUnexpected<G> &&_u) noexcept(std::is_nothrow_constructible<E, G>::value)
-        : m_has_value(false)
-        , m_error(std::move(_u).error())
+        : _Storage(dunexpected_tag::DUNEXPECTED, std::move(_u).error())
     {
     }
 
@@ -699,8 +864,7 @@ public:
      */
     template <typename... Args>
     constexpr explicit DExpected(emplace_tag, Args &&...args) noexcept(std::is_nothrow_constructible<T, Args...>::value)
-        : m_has_value(true)
-        , m_value(std::forward<Args>(args)...)
+        : _Storage(emplace_tag::USE_EMPLACE, std::forward<Args>(args)...)
 
     {
         static_assert(std::is_constructible<T, Args...>::value, "can't construct T from args.");
@@ -718,8 +882,7 @@ public:
     template <typename U, typename... Args>
     constexpr explicit DExpected(emplace_tag, std::initializer_list<U> _li, Args &&...args) noexcept(
         std::is_nothrow_constructible<T, std::initializer_list<U> &, Args...>::value)
-        : m_has_value(true)
-        , m_value(_li, std::forward<Args>(args)...)
+        : _Storage(emplace_tag::USE_EMPLACE, _li, std::forward<Args>(args)...)
     {
         static_assert(std::is_constructible<T, std::initializer_list<U> &, Args...>::value, "can't construct T from args.");
     }
@@ -733,8 +896,7 @@ public:
      */
     template <typename... Args>
     constexpr explicit DExpected(dunexpected_tag, Args &&...args) noexcept(std::is_nothrow_constructible<E, Args...>::value)
-        : m_has_value(false)
-        , m_error(std::forward<Args>(args)...)
+        : _Storage(dunexpected_tag::DUNEXPECTED, std::forward<Args>(args)...)
 
     {
         static_assert(std::is_constructible<E, Args...>::value, "can't construct E from args.");
@@ -752,72 +914,11 @@ public:
     template <typename U, typename... Args>
     constexpr explicit DExpected(dunexpected_tag, std::initializer_list<U> _li, Args &&...args) noexcept(
         std::is_nothrow_constructible<E, std::initializer_list<U> &, Args...>::value)
-        : m_has_value(false)
-        , m_error(_li, std::forward<Args>(args)...)
+        : _Storage(dunexpected_tag::DUNEXPECTED, _li, std::forward<Args>(args)...)
     {
         static_assert(std::is_constructible<E, std::initializer_list<U> &, Args...>::value, "can't construct E from args.");
     }
 
-    /*!
-     * @brief Dtk::Core::DExpected的析构函数
-     */
-    ~DExpected()
-    {
-        if (des_value()) {
-            if (m_has_value) {
-                destroy_at(std::addressof(m_value));
-            } else {
-                destroy_at(std::addressof(m_error));
-            }
-        }
-    }
-
-    /*!
-     * @brief Dtk::Core::DExpected的默认拷贝赋值运算符
-     */
-    DExpected &operator=(const DExpected &) = delete;
-
-    /*!
-     * @brief Dtk::Core::DExpected的拷贝赋值运算符
-     * @param[in] _x 同类型的Dtk::Core::DExpected对象
-     */
-    template <typename std::enable_if<std::is_copy_assignable<T>::value and std::is_copy_constructible<T>::value and
-                                          std::is_copy_assignable<E>::value and std::is_copy_constructible<E>::value and
-                                          (std::is_nothrow_move_constructible<T>::value or
-                                           std::is_nothrow_move_constructible<E>::value),
-                                      bool>::type = true>
-    DExpected &operator=(const DExpected &_x) noexcept(
-        std::is_nothrow_copy_constructible<T>::value and std::is_nothrow_copy_constructible<E>::value
-            and std::is_nothrow_copy_assignable<T>::value and std::is_nothrow_copy_assignable<E>::value)
-    {
-        if (_x.m_has_value)
-            this->assign_val(_x.m_value);
-        else
-            this->assign_err(_x.m_error);
-        return *this;
-    }
-
-    /*!
-     * @brief Dtk::Core::DExpected的移动赋值运算符
-     * @param[in] _x 同类型的Dtk::Core::DExpected对象
-     * @attention 赋值后原对象不可用
-     */
-    template <typename std::enable_if<std::is_move_assignable<T>::value and std::is_move_constructible<T>::value and
-                                          std::is_move_assignable<E>::value and std::is_move_constructible<E>::value and
-                                          (std::is_nothrow_move_constructible<T>::value or
-                                           std::is_nothrow_move_constructible<E>::value),
-                                      bool>::type = true>
-    DExpected &operator=(DExpected &&_x) noexcept(
-        std::is_nothrow_move_constructible<T>::value and std::is_nothrow_move_constructible<E>::value
-            and std::is_nothrow_move_assignable<T>::value and std::is_nothrow_move_assignable<E>::value)
-    {
-        if (_x.m_has_value)
-            assign_val(std::move(_x.m_value));
-        else
-            assign_err(std::move(_x.m_error));
-        return *this;
-    }
-
     /*!
      * @brief Dtk::Core::DExpected的转发赋值运算符
      * @tparam U 期待类型，默认为T
@@ -1139,6 +1240,252 @@ public:
         return static_cast<T>(std::forward<U>(_v));
     }
 
+private:
+    template <typename Self, typename F>
+    using _and_then_result = typename remove_cvref<decltype(std::declval<F>()(std::declval<Self>().m_value))>::type;
+
+    template <typename Self, typename F>
+    using _transform_result = typename std::remove_cv<decltype(std::declval<F>()(std::declval<Self>().m_value))>::type;
+
+    template <typename Self, typename F>
+    using _or_else_result = typename remove_cvref<decltype(std::declval<F>()(std::declval<Self>().m_error))>::type;
+
+    template <typename Self, typename F>
+    using _transform_error_result = typename std::remove_cv<decltype(std::declval<F>()(std::declval<Self>().m_error))>::type;
+
+    template <typename Self, typename F, typename U = _and_then_result<Self, F>>
+    static U and_then_impl(Self &&_self, F &&_f)
+    {
+        static_assert(__dexpected::_is_dexpected<U>::value, "the function must return a DExpected.");
+        static_assert(std::is_same<typename U::error_type, E>::value, "the function must return a DExpected with the same error type.");
+        if (_self.m_has_value)
+            return std::forward<F>(_f)(std::forward<Self>(_self).m_value);
+        return U(dunexpected_tag::DUNEXPECTED, std::forward<Self>(_self).m_error);
+    }
+
+    template <typename Self,
+              typename F,
+              typename U = _transform_result<Self, F>,
+              typename std::enable_if<!std::is_void<U>::value, bool>::type = true>
+    static DExpected<U, E> transform_impl(Self &&_self, F &&_f)
+    {
+        // 直接在新的Dtk::Core::DExpected中构造函数的返回值，不产生临时对象
+        if (_self.m_has_value)
+            return DExpected<U, E>(__dexpected::_invoke_value_tag{}, std::forward<F>(_f), std::forward<Self>(_self).m_value);
+        return DExpected<U, E>(dunexpected_tag::DUNEXPECTED, std::forward<Self>(_self).m_error);
+    }
+
+    template <typename Self,
+              typename F,
+              typename U = _transform_result<Self, F>,
+              typename std::enable_if<std::is_void<U>::value, bool>::type = true>
+    static DExpected<void, E> transform_impl(Self &&_self, F &&_f)
+    {
+        if (_self.m_has_value) {
+            std::forward<F>(_f)(std::forward<Self>(_self).m_value);
+            return DExpected<void, E>();
+        }
+        return DExpected<void, E>(dunexpected_tag::DUNEXPECTED, std::forward<Self>(_self).m_error);
+    }
+
+    template <typename Self, typename F, typename G = _or_else_result<Self, F>>
+    static G or_else_impl(Self &&_self, F &&_f)
+    {
+        static_assert(__dexpected::_is_dexpected<G>::value, "the function must return a DExpected.");
+        static_assert(std::is_same<typename G::value_type, T>::value, "the function must return a DExpected with the same value type.");
+        if (_self.m_has_value)
+            return G(emplace_tag::USE_EMPLACE, std::forward<Self>(_self).m_value);
+        return std::forward<F>(_f)(std::forward<Self>(_self).m_error);
+    }
+
+    template <typename Self, typename F, typename G = _transform_error_result<Self, F>>
+    static DExpected<T, G> transform_error_impl(Self &&_self, F &&_f)
+    {
+        if (_self.m_has_value)
+            return DExpected<T, G>(emplace_tag::USE_EMPLACE, std::forward<Self>(_self).m_value);
+        return DExpected<T, G>(__dexpected::_invoke_error_tag{}, std::forward<F>(_f), std::forward<Self>(_self).m_error);
+    }
+
+    template <typename F, typename... Args>
+    constexpr explicit DExpected(__dexpected::_invoke_value_tag _tag, F &&_f, Args &&...args)
+        : _Storage(_tag, std::forward<F>(_f), std::forward<Args>(args)...)
+    {
+    }
+
+    template <typename F, typename... Args>
+    constexpr explicit DExpected(__dexpected::_invoke_error_tag _tag, F &&_f, Args &&...args)
+        : _Storage(_tag, std::forward<F>(_f), std::forward<Args>(args)...)
+    {
+    }
+
+public:
+    /*!
+     * @brief 如果有期待值，以期待值调用函数并返回函数的结果，否则返回保有相同不期待值的Dtk::Core::DExpected
+     * @tparam F 函数的类型，函数需要返回不期待类型为E的Dtk::Core::DExpected
+     * @param[in] _f 以期待值调用的函数
+     * @return 函数的返回值或保有不期待值的Dtk::Core::DExpected
+     */
+    template <typename F>
+    _and_then_result<DExpected &, F> and_then(F &&_f) &
+    {
+        return and_then_impl(*this, std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果有期待值，以期待值调用函数并返回函数的结果，否则返回保有相同不期待值的Dtk::Core::DExpected
+     * @tparam F 函数的类型，函数需要返回不期待类型为E的Dtk::Core::DExpected
+     * @param[in] _f 以期待值调用的函数
+     * @return 函数的返回值或保有不期待值的Dtk::Core::DExpected
+     */
+    template <typename F>
+    _and_then_result<const DExpected &, F> and_then(F &&_f) const &
+    {
+        return and_then_impl(*this, std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果有期待值，以期待值的右值调用函数并返回函数的结果，否则返回保有相同不期待值的Dtk::Core::DExpected
+     * @tparam F 函数的类型，函数需要返回不期待类型为E的Dtk::Core::DExpected
+     * @param[in] _f 以期待值调用的函数
+     * @return 函数的返回值或保有不期待值的Dtk::Core::DExpected
+     * @attention 调用后原Dtk::Core::DExpected的值不可用，期待值和不期待值都会被移动而不是复制
+     */
+    template <typename F>
+    _and_then_result<DExpected &&, F> and_then(F &&_f) &&
+    {
+        return and_then_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果有期待值，以期待值调用函数并返回函数的结果，否则返回保有相同不期待值的Dtk::Core::DExpected
+     */
+    template <typename F>
+    _and_then_result<const DExpected &&, F> and_then(F &&_f) const &&
+    {
+        return and_then_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果有期待值，返回保有以期待值调用函数的结果的Dtk::Core::DExpected，否则返回保有相同不期待值的Dtk::Core::DExpected
+     * @tparam F 函数的类型
+     * @param[in] _f 以期待值调用的函数
+     * @return 期待类型为函数返回值类型的Dtk::Core::DExpected
+     * @note 函数的返回值直接构造在返回的Dtk::Core::DExpected中
+     */
+    template <typename F>
+    DExpected<_transform_result<DExpected &, F>, E> transform(F &&_f) &
+    {
+        return transform_impl(*this, std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果有期待值，返回保有以期待值调用函数的结果的Dtk::Core::DExpected，否则返回保有相同不期待值的Dtk::Core::DExpected
+     */
+    template <typename F>
+    DExpected<_transform_result<const DExpected &, F>, E> transform(F &&_f) const &
+    {
+        return transform_impl(*this, std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果有期待值，返回保有以期待值的右值调用函数的结果的Dtk::Core::DExpected，否则返回保有相同不期待值的Dtk::Core::DExpected
+     * @attention 调用后原Dtk::Core::DExpected的值不可用，期待值和不期待值都会被移动而不是复制
+     */
+    template <typename F>
+    DExpected<_transform_result<DExpected &&, F>, E> transform(F &&_f) &&
+    {
+        return transform_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果有期待值，返回保有以期待值调用函数的结果的Dtk::Core::DExpected，否则返回保有相同不期待值的Dtk::Core::DExpected
+     */
+    template <typename F>
+    DExpected<_transform_result<const DExpected &&, F>, E> transform(F &&_f) const &&
+    {
+        return transform_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果没有期待值，以不期待值调用函数并返回函数的结果，否则返回保有相同期待值的Dtk::Core::DExpected
+     * @tparam F 函数的类型，函数需要返回期待类型为T的Dtk::Core::DExpected
+     * @param[in] _f 以不期待值调用的函数
+     * @return 函数的返回值或保有期待值的Dtk::Core::DExpected
+     */
+    template <typename F>
+    _or_else_result<DExpected &, F> or_else(F &&_f) &
+    {
+        return or_else_impl(*this, std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果没有期待值，以不期待值调用函数并返回函数的结果，否则返回保有相同期待值的Dtk::Core::DExpected
+     */
+    template <typename F>
+    _or_else_result<const DExpected &, F> or_else(F &&_f) const &
+    {
+        return or_else_impl(*this, std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果没有期待值，以不期待值的右值调用函数并返回函数的结果，否则返回保有相同期待值的Dtk::Core::DExpected
+     * @attention 调用后原Dtk::Core::DExpected的值不可用，期待值和不期待值都会被移动而不是复制
+     */
+    template <typename F>
+    _or_else_result<DExpected &&, F> or_else(F &&_f) &&
+    {
+        return or_else_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果没有期待值，以不期待值调用函数并返回函数的结果，否则返回保有相同期待值的Dtk::Core::DExpected
+     */
+    template <typename F>
+    _or_else_result<const DExpected &&, F> or_else(F &&_f) const &&
+    {
+        return or_else_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果没有期待值，返回保有以不期待值调用函数的结果的Dtk::Core::DExpected，否则返回保有相同期待值的Dtk::Core::DExpected
+     * @tparam F 函数的类型
+     * @param[in] _f 以不期待值调用的函数
+     * @return 不期待类型为函数返回值类型的Dtk::Core::DExpected
+     */
+    template <typename F>
+    DExpected<T, _transform_error_result<DExpected &, F>> transform_error(F &&_f) &
+    {
+        return transform_error_impl(*this, std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果没有期待值，返回保有以不期待值调用函数的结果的Dtk::Core::DExpected，否则返回保有相同期待值的Dtk::Core::DExpected
+     */
+    template <typename F>
+    DExpected<T, _transform_error_result<const DExpected &, F>> transform_error(F &&_f) const &
+    {
+        return transform_error_impl(*this, std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果没有期待值，返回保有以不期待值的右值调用函数的结果的Dtk::Core::DExpected，否则返回保有相同期待值的Dtk::Core::DExpected
+     * @attention 调用后原Dtk::Core::DExpected的值不可用，期待值和不期待值都会被移动而不是复制
+     */
+    template <typename F>
+    DExpected<T, _transform_error_result<DExpected &&, F>> transform_error(F &&_f) &&
+    {
+        return transform_error_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    /*!
+     * @brief 如果没有期待值，返回保有以不期待值调用函数的结果的Dtk::Core::DExpected，否则返回保有相同期待值的Dtk::Core::DExpected
+     */
+    template <typename F>
+    DExpected<T, _transform_error_result<const DExpected &&, F>> transform_error(F &&_f) const &&
+    {
+        return transform_error_impl(std::move(*this), std::forward<F>(_f));
+    }
+
     /*!
      *@brief 重载相等运算符
      */
@@ -1178,12 +1525,9 @@ public:
     friend void swap(DExpected &_x, DExpected &_y) noexcept(noexcept(_x.swap(_y))) { _x.swap(_y); }
 
 private:
-    bool m_has_value;
-    union
-    {
-        T m_value;
-        E m_error;
-    };
+    using _Storage::m_has_value;
+    using _Storage::m_value;
+    using _Storage::m_error;
 };
 
 /*!
@@ -1191,13 +1535,13 @@ private:
  * @tparam E 不期待值的类型
  */
 template <typename E>
-class DExpected<void, E>
+class DExpected<void, E> : private __dexpected::_storage<__dexpected::_void_value, E>
 {
     static_assert(__dexpected::_can_be_dunexpected<E>(), "type E can't be DUnexpected.");
-    static constexpr bool des_value() { return !std::is_trivially_destructible<E>::value; }
 
     template <typename, typename>
     friend class DExpected;
+    using _Storage = __dexpected::_storage<__dexpected::_void_value, E>;
 
     template <typename U, typename G, typename Unex = DUnexpected<E>>
     static constexpr bool __cons_from_DExpected()
@@ -1226,28 +1570,17 @@ public:
     using rebind = DExpected<U, error_type>;
 
     constexpr DExpected() noexcept
-        : m_has_value(true)
-        , m_void()
+        : _Storage(emplace_tag::USE_EMPLACE)
     {
     }
 
-    template <typename std::enable_if<std::is_copy_constructible<E>::value, bool>::type = true>
-    DExpected(const DExpected &_x) noexcept(std::is_nothrow_copy_constructible<E>::value)
-        : m_has_value(_x.m_has_value)
-        , m_void()
-    {
-        if (!m_has_value)
-            construct_at(std::addressof(m_error), _x.m_error);
-    }
+    DExpected(const DExpected &) = default;
 
-    template <typename std::enable_if<std::is_move_constructible<E>::value, bool>::type = true>
-    DExpected(DExpected &&_x) noexcept(std::is_nothrow_move_constructible<E>::value)
-        : m_has_value(_x.m_has_value)
-        , m_void()
-    {
-        if (!m_has_value)
-            construct_at(std::addressof(m_error), std::move(_x).m_error);
-    }
+    DExpected(DExpected &&) = default;
+
+    DExpected &operator=(const DExpected &) = default;
+
+    DExpected &operator=(DExpected &&) = default;
 
     template <typename U,
               typename G,
@@ -1255,8 +1588,7 @@ public:
                                           !__cons_from_DExpected<U, G>() and !std::is_convertible<const G &, E>::value,
                                       bool>::type = true>
     explicit DExpected(const DExpected<U, G> &_x) noexcept(std::is_nothrow_constructible<E, const G &>::value)
-        : m_has_value(_x.m_has_value)
-        , m_void()
+        : _Storage(_x.m_has_value)
     {
         if (!m_has_value)
             construct_at(std::addressof(m_error), _x.m_error);
@@ -1268,8 +1600,7 @@ public:
                                           !__cons_from_DExpected<U, G>() and std::is_convertible<const G &, E>::value,
                                       bool>::type = true>
     DExpected(const DExpected<U, G> &_x) noexcept(std::is_nothrow_constructible<E, const G &>::value)
-        : m_has_value(_x.m_has_value)
-        , m_void()
+        : _Storage(_x.m_has_value)
     {
         if (!m_has_value)
             construct_at(std::addressof(m_error), _x.m_error);
@@ -1281,8 +1612,7 @@ public:
                                           __cons_from_DExpected<U, G>() and !std::is_convertible<G, E>::value,
                                       bool>::type = true>
     explicit DExpected(DExpected<U, G> &&_x) noexcept(std::is_nothrow_constructible<E, G>::value)
-        : m_has_value(_x.m_has_value)
-        , m_void()
+        : _Storage(_x.m_has_value)
     {
         if (!m_has_value)
             construct_at(std::addressof(m_error), std::move(_x).m_error);
@@ -1294,8 +1624,7 @@ public:
                                           __cons_from_DExpected<U, G>() and std::is_convertible<G, E>::value,
                                       bool>::type = true>
     DExpected(DExpected<U, G> &&_x) noexcept(std::is_nothrow_constructible<E, G>::value)
-        : m_has_value(_x.m_has_value)
-        , m_void()
+        : _Storage(_x.m_has_value)
     {
         if (!m_has_value)
             construct_at(std::addressof(m_error), std::move(_x).m_error);
@@ -1305,8 +1634,7 @@ public:
               typename std::enable_if<std::is_constructible<E, const G &>::value and !std::is_convertible<const G &, E>::value,
                                       bool>::type = true>
     constexpr explicit DExpected(const DUnexpected<G> &_u) noexcept(std::is_nothrow_constructible<E, const G &>::value)
-        : m_has_value(false)
-        , m_error(_u.error())
+        : _Storage(dunexpected_tag::DUNEXPECTED, _u.error())
     {
     }
 
@@ -1314,8 +1642,7 @@ public:
               typename std::enable_if<std::is_constructible<E, const G &>::value and std::is_convertible<const G &, E>::value,
                                       bool>::type = true>
     constexpr DExpected(const DUnexpected<G> &_u) noexcept(std::is_nothrow_constructible<E, const G &>::value)
-        : m_has_value(false)
-        , m_error(_u.error())
+        : _Storage(dunexpected_tag::DUNEXPECTED, _u.error())
     {
     }
 
@@ -1323,16 +1650,14 @@ public:
         typename G = E,
         typename std::enable_if<std::is_constructible<E, G>::value and !std::is_convertible<G, E>::value, bool>::type = true>
     constexpr explicit DExpected(DUnexpected<G> &&_u) noexcept(std::is_nothrow_constructible<E, G>::value)
-        : m_has_value(false)
-        , m_error(std::move(_u).error())
+        : _Storage(dunexpected_tag::DUNEXPECTED, std::move(_u).error())
     {
     }
 
     template <typename G = E,
               typename std::enable_if<std::is_constructible<E, G>::value and std::is_convertible<G, E>::value, bool>::type = true>
     constexpr DExpected(DUnexpected<G> &&_u) noexcept(std::is_nothrow_constructible<E, G>::value)
-        : m_has_value(false)
-        , m_error(std::move(_u).error())
+        : _Storage(dunexpected_tag::DUNEXPECTED, std::move(_u).error())
     {
     }
 
@@ -1344,8 +1669,7 @@ public:
 
     template <typename... Args>
     constexpr explicit DExpected(dunexpected_tag, Args &&...args) noexcept(std::is_nothrow_constructible<E, Args...>::value)
-        : m_has_value(false)
-        , m_error(std::forward<Args>(args)...)
+        : _Storage(dunexpected_tag::DUNEXPECTED, std::forward<Args>(args)...)
     {
         static_assert(std::is_constructible<E, Args...>::value, "type E can't construct from args");
     }
@@ -1354,45 +1678,11 @@ public:
     constexpr explicit DExpected(dunexpected_tag,
                                  std::initializer_list<U> _li,
                                  Args &&...args) noexcept(std::is_nothrow_constructible<E, Args...>::value)
-        : m_has_value(false)
-        , m_error(_li, std::forward<Args>(args)...)
+        : _Storage(dunexpected_tag::DUNEXPECTED, _li, std::forward<Args>(args)...)
     {
         static_assert(std::is_constructible<E, std::initializer_list<U> &, Args...>::value, "type E can't construct from args");
     }
 
-    ~DExpected()
-    {
-        if (des_value() and !m_has_value) {
-            destroy_at(std::addressof(m_error));
-        }
-    }
-
-    DExpected &operator=(const DExpected &) = delete;
-
-    template <
-        typename std::enable_if<std::is_copy_constructible<E>::value and std::is_copy_assignable<E>::value, bool>::type = true>
-    DExpected &operator=(const DExpected &_x) noexcept(
-        std::is_nothrow_copy_constructible<E>::value and std::is_nothrow_copy_assignable<E>::value)
-    {
-        if (_x.m_has_value)
-            emplace();
-        else
-            assign_err(_x.m_error);
-        return *this;
-    }
-
-    template <
-        typename std::enable_if<std::is_move_constructible<E>::value and std::is_move_assignable<E>::value, bool>::type = true>
-    DExpected &
-    operator=(DExpected &&_x) noexcept(std::is_nothrow_move_constructible<E>::value and std::is_nothrow_move_assignable<E>::value)
-    {
-        if (_x.m_has_value)
-            emplace();
-        else
-            assign_err(std::move(_x.m_error));
-        return *this;
-    }
-
     template <typename G,
               typename std::enable_if<std::is_constructible<E, const G &>::value and std::is_assignable<E &, const G &>::value,
                                       bool>::type = true>
@@ -1486,6 +1776,174 @@ public:
         return std::move(m_error);
     }
 
+private:
+    template <typename F>
+    using _and_then_result = typename remove_cvref<decltype(std::declval<F>()())>::type;
+
+    template <typename F>
+    using _transform_result = typename std::remove_cv<decltype(std::declval<F>()())>::type;
+
+    template <typename Self, typename F>
+    using _or_else_result = typename remove_cvref<decltype(std::declval<F>()(std::declval<Self>().m_error))>::type;
+
+    template <typename Self, typename F>
+    using _transform_error_result = typename std::remove_cv<decltype(std::declval<F>()(std::declval<Self>().m_error))>::type;
+
+    template <typename Self, typename F, typename U = _and_then_result<F>>
+    static U and_then_impl(Self &&_self, F &&_f)
+    {
+        static_assert(__dexpected::_is_dexpected<U>::value, "the function must return a DExpected.");
+        static_assert(std::is_same<typename U::error_type, E>::value, "the function must return a DExpected with the same error type.");
+        if (_self.m_has_value)
+            return std::forward<F>(_f)();
+        return U(dunexpected_tag::DUNEXPECTED, std::forward<Self>(_self).m_error);
+    }
+
+    template <typename Self,
+              typename F,
+              typename U = _transform_result<F>,
+              typename std::enable_if<!std::is_void<U>::value, bool>::type = true>
+    static DExpected<U, E> transform_impl(Self &&_self, F &&_f)
+    {
+        if (_self.m_has_value)
+            return DExpected<U, E>(__dexpected::_invoke_value_tag{}, std::forward<F>(_f));
+        return DExpected<U, E>(dunexpected_tag::DUNEXPECTED, std::forward<Self>(_self).m_error);
+    }
+
+    template <typename Self,
+              typename F,
+              typename U = _transform_result<F>,
+              typename std::enable_if<std::is_void<U>::value, bool>::type = true>
+    static DExpected<void, E> transform_impl(Self &&_self, F &&_f)
+    {
+        if (_self.m_has_value) {
+            std::forward<F>(_f)();
+            return DExpected<void, E>();
+        }
+        return DExpected<void, E>(dunexpected_tag::DUNEXPECTED, std::forward<Self>(_self).m_error);
+    }
+
+    template <typename Self, typename F, typename G = _or_else_result<Self, F>>
+    static G or_else_impl(Self &&_self, F &&_f)
+    {
+        static_assert(__dexpected::_is_dexpected<G>::value, "the function must return a DExpected.");
+        static_assert(std::is_void<typename G::value_type>::value, "the function must return a DExpected with the same value type.");
+        if (_self.m_has_value)
+            return G();
+        return std::forward<F>(_f)(std::forward<Self>(_self).m_error);
+    }
+
+    template <typename Self, typename F, typename G = _transform_error_result<Self, F>>
+    static DExpected<void, G> transform_error_impl(Self &&_self, F &&_f)
+    {
+        if (_self.m_has_value)
+            return DExpected<void, G>();
+        return DExpected<void, G>(__dexpected::_invoke_error_tag{}, std::forward<F>(_f), std::forward<Self>(_self).m_error);
+    }
+
+    template <typename F, typename... Args>
+    constexpr explicit DExpected(__dexpected::_invoke_error_tag _tag, F &&_f, Args &&...args)
+        : _Storage(_tag, std::forward<F>(_f), std::forward<Args>(args)...)
+    {
+    }
+
+public:
+    template <typename F>
+    _and_then_result<F> and_then(F &&_f) &
+    {
+        return and_then_impl(*this, std::forward<F>(_f));
+    }
+
+    template <typename F>
+    _and_then_result<F> and_then(F &&_f) const &
+    {
+        return and_then_impl(*this, std::forward<F>(_f));
+    }
+
+    template <typename F>
+    _and_then_result<F> and_then(F &&_f) &&
+    {
+        return and_then_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    template <typename F>
+    _and_then_result<F> and_then(F &&_f) const &&
+    {
+        return and_then_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    template <typename F>
+    DExpected<_transform_result<F>, E> transform(F &&_f) &
+    {
+        return transform_impl(*this, std::forward<F>(_f));
+    }
+
+    template <typename F>
+    DExpected<_transform_result<F>, E> transform(F &&_f) const &
+    {
+        return transform_impl(*this, std::forward<F>(_f));
+    }
+
+    template <typename F>
+    DExpected<_transform_result<F>, E> transform(F &&_f) &&
+    {
+        return transform_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    template <typename F>
+    DExpected<_transform_result<F>, E> transform(F &&_f) const &&
+    {
+        return transform_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    template <typename F>
+    _or_else_result<DExpected &, F> or_else(F &&_f) &
+    {
+        return or_else_impl(*this, std::forward<F>(_f));
+    }
+
+    template <typename F>
+    _or_else_result<const DExpected &, F> or_else(F &&_f) const &
+    {
+        return or_else_impl(*this, std::forward<F>(_f));
+    }
+
+    template <typename F>
+    _or_else_result<DExpected &&, F> or_else(F &&_f) &&
+    {
+        return or_else_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    template <typename F>
+    _or_else_result<const DExpected &&, F> or_else(F &&_f) const &&
+    {
+        return or_else_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    template <typename F>
+    DExpected<void, _transform_error_result<DExpected &, F>> transform_error(F &&_f) &
+    {
+        return transform_error_impl(*this, std::forward<F>(_f));
+    }
+
+    template <typename F>
+    DExpected<void, _transform_error_result<const DExpected &, F>> transform_error(F &&_f) const &
+    {
+        return transform_error_impl(*this, std::forward<F>(_f));
+    }
+
+    template <typename F>
+    DExpected<void, _transform_error_result<DExpected &&, F>> transform_error(F &&_f) &&
+    {
+        return transform_error_impl(std::move(*this), std::forward<F>(_f));
+    }
+
+    template <typename F>
+    DExpected<void, _transform_error_result<const DExpected &&, F>> transform_error(F &&_f) const &&
+    {
+        return transform_error_impl(std::move(*this), std::forward<F>(_f));
+    }
+
     template <typename U, typename E2, typename std::enable_if<std::is_void<U>::value, bool>::type = true>
     friend bool operator==(const DExpected &_x, const DExpected<U, E2> &_y) noexcept(noexcept(bool(_x.error() == _y.error())))
     {
@@ -1505,14 +1963,8 @@ public:
     friend void swap(DExpected &_x, DExpected &_y) noexcept(noexcept(_x.swap(_y))) { _x.swap(_y); }
 
 private:
-    bool m_has_value;
-    union
-    {
-        struct
-        {
-        } m_void;
-        E m_error;
-    };
+    using _Storage::m_has_value;
+    using _Storage::m_error;
 };
 
 DCORE_END_NAMESPACE
@@ -7,6 +7,9 @@
 
 #include <QScopedPointer>
 
+#include <cstddef>
+#include <new>
+
 #include "dtkcore_global.h"
 
 DCORE_BEGIN_NAMESPACE
@@ -18,6 +21,78 @@ DCORE_BEGIN_NAMESPACE
 #define D_DC(Class) Q_D(const Class)
 #define D_QC(Class) Q_Q(const Class)
 #define D_PRIVATE_SLOT(Func) Q_PRIVATE_SLOT(d_func(), Func)
+#define D_DECLARE_POOLED_PRIVATE(Class) \
+    static void *operator new(std::size_t size) { return DTK_CORE_NAMESPACE::DPrivatePool<Class>::allocate(size); } \
+    static void operator delete(void *ptr, std::size_t size) noexcept { DTK_CORE_NAMESPACE::DPrivatePool<Class>::deallocate(ptr, size); }
+
+// Caches the freed blocks of Class in a per-thread free list, used by D_DECLARE_POOLED_PRIVATE
+template<typename Class>
+class DPrivatePool
+{
+public:
+    static constexpr int MaxFreeCount = 64;
+
+    static void *allocate(std::size_t size)
+    {
+        FreeList &list = freeList();
+        // the subclasses have different sizes, they're not pooled
+        if (size != sizeof(Class) || !list.head)
+            return ::operator new(size);
+
+        Block *block = list.head;
+        list.head = block->next;
+        --list.count;
+        return block;
+    }
+
+    static void deallocate(void *ptr, std::size_t size) noexcept
+    {
+        if (!ptr)
+            return;
+
+        FreeList &list = freeList();
+        if (size != sizeof(Class) || list.count >= MaxFreeCount) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        // the block may be allocated in another thread, it's cached by the current thread
+        Block *block = static_cast<Block *>(ptr);
+        block->next = list.head;
+        list.head = block;
+        ++list.count;
+    }
+
+private:
+    struct Block
+    {
+        Block *next;
+    };
+    static_assert(sizeof(Class) >= sizeof(Block), "the class is too small to be pooled");
+
+    struct FreeList
+    {
+        ~FreeList()
+        {
+            while (head) {
+                Block *block = head;
+                head = block->next;
+                ::operator delete(block);
+            }
+            // the objects destroyed after the thread local data don't use the pool
+            count = MaxFreeCount;
+        }
+
+        Block *head = nullptr;
+        int count = 0;
+    };
+
+    static FreeList &freeList()
+    {
+        static thread_local FreeList list;
+        return list;
+    }
+};
 
 class DObjectPrivate;
 
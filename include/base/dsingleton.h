@@ -7,6 +7,9 @@
 
 #include "dtkcore_global.h"
 
+#include <atomic>
+#include <mutex>
+
 DCORE_BEGIN_NAMESPACE
 
 /*!
@@ -68,6 +71,77 @@ protected:
     virtual ~DSingleton() = default;
 };
 
+/*!
+  销毁 DFastSingleton 创建的单例对象。
+
+  单例对象按照注册时指定的顺序销毁，顺序值小的先销毁，顺序值相同时后创建的先销毁。
+  程序退出时会自动调用 teardown，也可以提前调用（例如在 QCoreApplication 析构之前）。
+ */
+class LIBDTKCORESHARED_EXPORT DSingletonTeardown
+{
+public:
+    static void add(int order, void (*destroy)());
+    static void teardown();
+};
+
+/*!
+  访问开销更小的单例模板，初始化之后 instance() 只需读取一次指针。
+
+  可以在程序启动时调用 init() 显式地初始化，init() 是线程安全的，第一次调用
+  instance() 时也会初始化。销毁之后 instance() 返回 nullptr。
+  T 的构造函数不公开时，需要将 DFastSingleton<T> 声明为友元类。
+
+  使用示例:
+
+```
+   class Example
+   {
+       friend class DFastSingleton<Example>;
+   };
+
+   DFastSingleton<Example>::init(1); // 在顺序值为0的单例之后销毁
+   DFastSingleton<Example>::instance()->foo();
+```
+ */
+template <class T>
+class DFastSingleton
+{
+public:
+    static inline T *instance()
+    {
+        T *ptr = s_instance.load(std::memory_order_acquire);
+        if (Q_LIKELY(ptr))
+            return ptr;
+
+        return init();
+    }
+
+    static T *init(int teardownOrder = 0)
+    {
+        std::call_once(s_once, [teardownOrder] {
+            s_instance.store(new T, std::memory_order_release);
+            DSingletonTeardown::add(teardownOrder, &DFastSingleton::destroy);
+        });
+
+        return s_instance.load(std::memory_order_acquire);
+    }
+
+    static void destroy()
+    {
+        delete s_instance.exchange(nullptr, std::memory_order_acq_rel);
+    }
+
+private:
+    static std::atomic<T *> s_instance;
+    static std::once_flag s_once;
+};
+
+template <class T>
+std::atomic<T *> DFastSingleton<T>::s_instance {nullptr};
+
+template <class T>
+std::once_flag DFastSingleton<T>::s_once;
+
 DCORE_END_NAMESPACE
 
 #endif // DSINGLETON_H
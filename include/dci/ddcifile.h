@@ -14,7 +14,10 @@
 #define D_DECLARE_PRIVATE(Class) Class##Private *d;
 #endif
 
+#include <QPair>
 #include <QStringList>
+#include <QSharedPointer>
+#include <QVector>
 
 QT_BEGIN_NAMESPACE
 class QIODevice;
@@ -37,10 +40,22 @@ public:
         Symlink = 3
     };
 
+    enum LoadMode {
+        ReadAll = 0x0,
+        MapFile = 0x1,
+        LazyLoad = 0x2
+    };
+    Q_DECLARE_FLAGS(LoadModes, LoadMode)
+
     static void registerFileEngine();
 
     DDciFile();
     explicit DDciFile(const QString &fileName);
+    DDciFile(const QString &fileName, LoadModes mode);
+
+    static QSharedPointer<const DDciFile> shared(const QString &fileName, LoadModes mode = ReadAll);
+    static void setSharedCacheLimit(qint64 bytes);
+    static qint64 sharedCacheLimit();
     explicit DDciFile(const QByteArray &data);
 
     bool isValid() const;
@@ -50,24 +65,33 @@ public:
     bool writeToDevice(QIODevice *device) const;
     QByteArray toData() const;
 
+    int version() const;
+    bool setVersion(int version);
+
     static constexpr int metadataSizeV1();
 
     // for reader
     QStringList list(const QString &dir, bool onlyFileName = false) const;
     int childrenCount(const QString &dir) const;
+    QVector<FileType> childrenTypes(const QString &dir) const;
     bool exists(const QString &filePath) const;
     FileType type(const QString &filePath) const;
     QByteArray dataRef(const QString &filePath) const;
     QString name(const QString &filePath) const;
     QString symlinkTarget(const QString &filePath, bool originData = false) const;
+    bool isCompressed(const QString &filePath) const;
 
     // for writer
     bool mkdir(const QString &filePath);
     bool writeFile(const QString &filePath, const QByteArray &data, bool override = false);
+    bool writeFiles(const QVector<QPair<QString, QByteArray>> &files, bool override = false);
+    bool setCompressed(const QString &filePath, bool compressed);
     bool remove(const QString &filePath);
     bool rename(const QString &filePath, const QString &newFilePath, bool override = false);
     bool copy(const QString &from, const QString &to);
     bool link(const QString &source, const QString &to);
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(DDciFile::LoadModes)
+
 DCORE_END_NAMESPACE
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#ifndef DTK_NO_PROJECT
+#include <DObject>
+#include <dtkcore_global.h>
+#else
+#define DCORE_BEGIN_NAMESPACE
+#define DCORE_END_NAMESPACE
+#define LIBDTKCORESHARED_EXPORT
+#define D_DECLARE_PRIVATE(Class) Class##Private *d;
+#endif
+
+#include <QString>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+DCORE_BEGIN_NAMESPACE
+
+class DDciFileWriterPrivate;
+class LIBDTKCORESHARED_EXPORT DDciFileWriter
+#ifndef DTK_NO_PROJECT
+        : public DObject
+#endif
+{
+    D_DECLARE_PRIVATE(DDciFileWriter)
+public:
+    explicit DDciFileWriter(QIODevice *device, int version = 1);
+    ~DDciFileWriter();
+
+    bool isValid() const;
+    QString lastErrorString() const;
+
+    bool beginDirectory(const QString &name);
+    bool endDirectory();
+    bool writeFile(const QString &name, const QByteArray &data);
+    bool writeFile(const QString &name, QIODevice *source);
+    bool writeCompressedFile(const QString &name, const QByteArray &data);
+    bool link(const QString &name, const QString &source);
+    bool finish();
+};
+
+DCORE_END_NAMESPACE
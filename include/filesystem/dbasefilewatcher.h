@@ -28,10 +28,14 @@ public:
 
     virtual void setEnabledSubfileWatcher(const QUrl &subfileUrl, bool enabled = true);
 
+    int coalescingInterval() const;
+    void setCoalescingInterval(int msec);
+
     using SignalType1 = void(DBaseFileWatcher::*)(const QUrl &);
     using SignalType2 = void(DBaseFileWatcher::*)(const QUrl &, const QUrl &);
     static bool ghostSignal(const QUrl &targetUrl, SignalType1 signal, const QUrl &arg1);
     static bool ghostSignal(const QUrl &targetUrl, SignalType2 signal, const QUrl &arg1, const QUrl &arg2);
+    static int ghostSignalToChildren(const QUrl &parentUrl, SignalType1 signal, const QUrl &arg1);
 
 Q_SIGNALS:
     void fileDeleted(const QUrl &url);
@@ -9,6 +9,7 @@
 
 #include <DObject>
 #include <QDir>
+#include <QDirIterator>
 #include <QFile>
 
 DCORE_BEGIN_NAMESPACE
@@ -100,6 +101,30 @@ private:
     QSharedDataPointer<DCapDirPrivate> dd_ptr;
 };
 
+class DCapDirIteratorPrivate;
+class DCapDirIterator
+{
+public:
+    explicit DCapDirIterator(const DCapDir &dir, QDirIterator::IteratorFlags flags = QDirIterator::NoIteratorFlags);
+    DCapDirIterator(const QString &path, QDir::Filters filters,
+                    QDirIterator::IteratorFlags flags = QDirIterator::NoIteratorFlags);
+    DCapDirIterator(const QString &path, const QStringList &nameFilters, QDir::Filters filters = QDir::NoFilter,
+                    QDirIterator::IteratorFlags flags = QDirIterator::NoIteratorFlags);
+    ~DCapDirIterator();
+
+    QString next();
+    bool hasNext() const;
+
+    QString fileName() const;
+    QString filePath() const;
+    QFileInfo fileInfo() const;
+    QString path() const;
+
+private:
+    Q_DISABLE_COPY(DCapDirIterator)
+    QScopedPointer<DCapDirIteratorPrivate> d;
+};
+
 DCORE_END_NAMESPACE
 Q_DECLARE_SHARED(DTK_CORE_NAMESPACE::DCapDir)
 #endif // DCAPFILE_H
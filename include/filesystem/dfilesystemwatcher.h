@@ -19,17 +19,50 @@ class LIBDTKCORESHARED_EXPORT DFileSystemWatcher : public QObject, public DObjec
     D_DECLARE_PRIVATE(DFileSystemWatcher)
 
 public:
+    struct Statistics
+    {
+        int watchCount = 0; // the watched inodes of inotify
+        quint64 eventCount = 0;
+        double eventsPerSecond = 0;
+        quint64 batchCount = 0;
+        qint64 lastBatchTime = 0; // in microseconds
+        qint64 maxBatchTime = 0; // in microseconds
+        qint64 totalBatchTime = 0; // in microseconds
+        quint64 overflowCount = 0;
+    };
+
+    enum EventType {
+        FileDeletedEvent = 0x01,
+        FileAttributeChangedEvent = 0x02,
+        FileClosedEvent = 0x04,
+        FileMovedEvent = 0x08,
+        FileCreatedEvent = 0x10,
+        FileModifiedEvent = 0x20,
+        AllEvents = 0x3f
+    };
+    Q_DECLARE_FLAGS(EventTypes, EventType)
+
     DFileSystemWatcher(QObject *parent = Q_NULLPTR);
     DFileSystemWatcher(const QStringList &paths, QObject *parent = Q_NULLPTR);
     ~DFileSystemWatcher();
 
     bool addPath(const QString &file);
+    bool addPath(const QString &file, EventTypes types, const QStringList &excludes = QStringList());
     QStringList addPaths(const QStringList &files);
     bool removePath(const QString &file);
     QStringList removePaths(const QStringList &files);
+    bool addRecursive(const QString &path, const QStringList &filters = QStringList());
+    bool removeRecursive(const QString &path);
+    bool addFilesystem(const QString &path);
+    bool removeFilesystem(const QString &path);
 
     QStringList files() const;
     QStringList directories() const;
+    EventTypes eventTypes(const QString &path) const;
+    QStringList excludePatterns(const QString &path) const;
+
+    Statistics statistics() const;
+    void resetStatistics();
 
 Q_SIGNALS:
     void fileDeleted(const QString &path, const QString &name, QPrivateSignal);
@@ -39,11 +72,14 @@ Q_SIGNALS:
                    const QString &toPath, const QString &toName, QPrivateSignal);
     void fileCreated(const QString &path, const QString &name, QPrivateSignal);
     void fileModified(const QString &path, const QString &name, QPrivateSignal);
+    void overflowed(QPrivateSignal);
 
 private:
     Q_PRIVATE_SLOT(d_func(), void _q_readFromInotify())
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(DFileSystemWatcher::EventTypes)
+
 DCORE_END_NAMESPACE
 
 #endif // DFILESYSTEMWATCHER_H
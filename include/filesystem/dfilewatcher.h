@@ -15,8 +15,24 @@ class LIBDTKCORESHARED_EXPORT DFileWatcher : public DBaseFileWatcher
     Q_OBJECT
 
 public:
+    enum WatchMode {
+        AutoMode,
+        NotifyMode,
+        PollingMode
+    };
+
     explicit DFileWatcher(const QString &filePath, QObject *parent = 0);
 
+    WatchMode watchMode() const;
+    void setWatchMode(WatchMode mode);
+    bool isPolling() const;
+
+    static void setPollingInterval(int minMsec, int maxMsec);
+    static int minimumPollingInterval();
+    static int maximumPollingInterval();
+    static void setMaximumPolledEntries(int count);
+    static int maximumPolledEntries();
+
 private Q_SLOTS:
     void onFileDeleted(const QString &path, const QString &name);
     void onFileAttributeChanged(const QString &path, const QString &name);
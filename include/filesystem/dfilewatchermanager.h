@@ -28,6 +28,13 @@ public:
     void remove(const QString &filePath);
     void removeAll();
     QStringList watchedFiles() const;
+
+    QStringList addMany(const QStringList &filePaths);
+    void removeMany(const QStringList &filePaths);
+
+    bool addPrefix(const QString &pathPrefix);
+    void removePrefix(const QString &pathPrefix);
+    QStringList watchedPrefixes() const;
 Q_SIGNALS:
     void fileDeleted(const QString &filePath);
     void fileAttributeChanged(const QString &filePath);
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <QDir>
+#include <QStringView>
 
 #include "dtkcore_global.h"
 
@@ -52,4 +53,73 @@ private:
     QString m_path;
 };
 
+class LIBDTKCORESHARED_EXPORT DPathBuilder
+{
+public:
+    DPathBuilder() = default;
+    explicit DPathBuilder(QStringView root, int reserveSize = 0)
+    {
+        m_path.reserve(qMax(reserveSize, int(root.size())));
+        m_path.append(root.data(), int(root.size()));
+    }
+    explicit DPathBuilder(QLatin1String root, int reserveSize = 0)
+    {
+        m_path.reserve(qMax(reserveSize, root.size()));
+        m_path.append(root);
+    }
+
+    DPathBuilder &reserve(int size)
+    {
+        m_path.reserve(size);
+        return *this;
+    }
+
+    DPathBuilder &append(QStringView segment)
+    {
+        separate();
+        m_path.append(segment.data(), int(segment.size()));
+        return *this;
+    }
+
+    DPathBuilder &append(QLatin1String segment)
+    {
+        separate();
+        m_path.append(segment);
+        return *this;
+    }
+
+    DPathBuilder &append(const QString &segment)
+    {
+        return append(QStringView(segment));
+    }
+
+    DPathBuilder &append(const char *segment)
+    {
+        separate();
+        m_path.append(QString::fromUtf8(segment));
+        return *this;
+    }
+
+    template<typename Segment>
+    DPathBuilder &operator/=(const Segment &segment)
+    {
+        return append(segment);
+    }
+
+    void clear() { m_path.clear(); }
+    bool isEmpty() const { return m_path.isEmpty(); }
+
+    QString toString() const;
+    DPathBuf toPathBuf() const { return DPathBuf(toString()); }
+
+private:
+    void separate()
+    {
+        if (!m_path.isEmpty() && !m_path.endsWith(QLatin1Char('/')))
+            m_path.append(QLatin1Char('/'));
+    }
+
+    QString m_path;
+};
+
 DCORE_END_NAMESPACE
@@ -74,6 +74,8 @@ public:
     static QString filePath(XDG type, QString fileName);
     static QString filePath(DSG type, QString fileName);
 
+    static void invalidateCache();
+
 private:
     DStandardPaths();
     ~DStandardPaths();
@@ -8,10 +8,49 @@
 #include <dtkcore_global.h>
 #include <DObject>
 
+#include <QDateTime>
 #include <QObject>
+#include <QStringList>
 
 DCORE_BEGIN_NAMESPACE
 
+class DTrashJobPrivate;
+class LIBDTKCORESHARED_EXPORT DTrashJob : public QObject, public DObject
+{
+    Q_OBJECT
+    D_DECLARE_PRIVATE(DTrashJob)
+public:
+    ~DTrashJob() override;
+
+    int totalCount() const;
+    int finishedCount() const;
+    QStringList failedFiles() const;
+
+    bool isFinished() const;
+    bool isCanceled() const;
+    void cancel();
+    bool waitForFinished(int msecs = -1);
+
+Q_SIGNALS:
+    void progressChanged(int finishedCount, int totalCount);
+    void finished();
+
+private:
+    explicit DTrashJob(QObject *parent = nullptr);
+    friend class DTrashManager;
+};
+
+struct DTrashItem
+{
+    QString id;
+    QString filePath;
+    QString originalPath;
+    QDateTime deletionDate;
+    qint64 size = -1;
+
+    inline bool isValid() const { return !id.isEmpty(); }
+};
+
 class DTrashManagerPrivate;
 class LIBDTKCORESHARED_EXPORT DTrashManager : public QObject, public DObject
 {
@@ -19,8 +58,15 @@ public:
     static DTrashManager *instance();
 
     bool trashIsEmpty() const;
+    int trashItemCount() const;
+    qint64 trashSize() const;
+    QList<DTrashItem> trashItems() const;
+    DTrashItem trashItem(const QString &id) const;
+    bool restoreFromTrash(const QString &id, const QString &targetPath = QString());
     bool cleanTrash();
+    DTrashJob *cleanTrashAsync(int maxThreadCount = 0);
     bool moveToTrash(const QString &filePath, bool followSymlink = false);
+    DTrashJob *moveToTrashAsync(const QStringList &filePaths, bool followSymlink = false, int maxThreadCount = 0);
 
 protected:
     DTrashManager();
@@ -10,8 +10,15 @@
 
 #include <QObject>
 #include <QVariant>
+#include <QFuture>
+
+#include <functional>
 
 DCORE_BEGIN_NAMESPACE
+namespace DUtil {
+class DExportedInterface;
+}
+
 class DConfigBackend {
 public:
     virtual ~DConfigBackend();
@@ -52,6 +59,12 @@ public:
 
     static void setAppId(const QString &appId);
     static QThread *globalThread();
+    static QThread *workerThread();
+    static void setWorkerThreadCount(int count);
+    static int workerThreadCount();
+
+    static QList<QVariantMap> statistics();
+    static void exportStatistics(DUtil::DExportedInterface *interface);
 
     QString backendName() const;
 
@@ -60,10 +73,25 @@ public:
     bool isValid() const;
     bool isDefaultValue(const QString &key) const;
     QVariant value(const QString &key, const QVariant &fallback = QVariant()) const;
+    QVariantMap values(const QStringList &keys = QStringList()) const;
     void setValue(const QString &key, const QVariant &value);
+    void setValues(const QVariantMap &values);
+    QFuture<QVariant> valueAsync(const QString &key, const QVariant &fallback = QVariant()) const;
+    QFuture<void> setValueAsync(const QString &key, const QVariant &value);
     void reset(const QString &key);
     bool isReadOnly(const QString &key) const;
 
+    void setSnapshotEnabled(bool enabled);
+    bool isSnapshotEnabled() const;
+    QVariantHash snapshot() const;
+    QVariant snapshotValue(const QString &key, const QVariant &fallback = QVariant()) const;
+
+    int subscribeKeys(const QStringList &keys, QObject *context,
+                      std::function<void(const QStringList &)> callback);
+    int subscribePrefix(const QString &prefix, QObject *context,
+                        std::function<void(const QStringList &)> callback);
+    void unsubscribe(int id);
+
     QString name() const;
     QString subpath() const;
 
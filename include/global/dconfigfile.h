@@ -43,11 +43,23 @@ public:
         Public
     };
 
+    enum Durability {
+        NoSync,
+        DataSync,
+        FullSync
+    };
+
     struct Version {
         quint16 major;
         quint16 minor;
     };
 
+    struct PrefetchEntry {
+        QString appId;
+        QString name;
+        QString subpath;
+    };
+
     static constexpr Version supportedVersion();
 
     explicit DConfigFile(const QString &appId, const QString &name,
@@ -65,12 +77,18 @@ public:
     QVariant cacheValue(DConfigCache *userCache, const QString &key) const;
     bool setValue(const QString &key, const QVariant &value, const QString &callerAppid,
                   DConfigCache *userCache = nullptr);
+    bool setValues(const QVariantMap &values, const QString &callerAppid,
+                   DConfigCache *userCache = nullptr, QStringList *changedKeys = nullptr);
+    bool reloadOverrides(const QString &localPrefix = QString(), QStringList *changedKeys = nullptr);
 
     DConfigCache *createUserCache(const uint uid);
     DConfigCache *globalCache() const;
 
     DConfigMeta *meta();
 
+    static QList<PrefetchEntry> prefetchEntries(const QString &localPrefix = QString());
+    static int prefetch(const QList<PrefetchEntry> &entries, const QString &localPrefix = QString());
+
 protected:
     friend QDebug operator<<(QDebug, const DConfigFile &);
 };
@@ -120,6 +138,8 @@ public:
     virtual uint uid() const = 0;
 
     virtual void setCachePathPrefix(const QString &prefix) = 0;
+    void setSaveDelay(int msec);
+    void setDurability(DConfigFile::Durability durability);
 };
 
 #ifndef QT_NO_DEBUG_STREAM
@@ -8,6 +8,8 @@
 
 #include <QIODevice>
 #include <QObject>
+#include <QSharedPointer>
+#include <QStringView>
 #include <QVariant>
 
 DCORE_BEGIN_NAMESPACE
@@ -48,7 +50,10 @@ public:
     explicit DDesktopEntry(const QString &filePath) noexcept;
     ~DDesktopEntry();
 
+    static QList<QSharedPointer<DDesktopEntry>> loadMany(const QStringList &paths, int maxThreadCount = 0);
+
     bool save() const;
+    bool reload();
 
     Status status() const;
     QStringList keys(const QString &section = "Desktop Entry") const;
@@ -82,6 +87,10 @@ public:
     static QString &escapeExec(QString &str);
     static QString &unescape(QString &str, bool unescapeSemicolons = false);
     static QString &unescapeExec(QString &str);
+    static QString escape(QStringView str);
+    static QString escapeExec(QStringView str);
+    static QString unescape(QStringView str, bool unescapeSemicolons = false);
+    static QString unescapeExec(QStringView str);
 
 protected:
     bool setStatus(const Status &status);
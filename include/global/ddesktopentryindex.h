@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "dtkcore_global.h"
+
+#include <DObject>
+
+#include <QLocale>
+#include <QMap>
+#include <QObject>
+#include <QStringList>
+
+DCORE_BEGIN_NAMESPACE
+
+class DDesktopEntryIndexPrivate;
+class LIBDTKCORESHARED_EXPORT DDesktopEntryIndex : public QObject, public DObject
+{
+    Q_OBJECT
+    D_DECLARE_PRIVATE(DDesktopEntryIndex)
+
+public:
+    struct LIBDTKCORESHARED_EXPORT Entry
+    {
+        QString desktopId;
+        QString filePath;
+        QString name;
+        QMap<QString, QString> localizedNames;
+        QString icon;
+        QString exec;
+        QStringList categories;
+        QStringList mimeTypes;
+        bool noDisplay = false;
+
+        QString localizedName(const QLocale &locale = QLocale()) const;
+    };
+
+    explicit DDesktopEntryIndex(QObject *parent = nullptr);
+    DDesktopEntryIndex(const QStringList &directories, const QString &indexFile, QObject *parent = nullptr);
+    ~DDesktopEntryIndex() override;
+
+    static QStringList applicationDirectories();
+    static QStringList desktopFilePaths(const QString &desktopId);
+    static QString desktopIdOfFile(const QString &filePath);
+    static QString defaultIndexFile(const QStringList &directories);
+
+    QStringList directories() const;
+    QString indexFile() const;
+    bool isValid() const;
+
+    bool update();
+    bool isWatchEnabled() const;
+    void setWatchEnabled(bool enabled);
+
+    int count() const;
+    QStringList desktopIds() const;
+    bool contains(const QString &desktopId) const;
+    Entry entry(const QString &desktopId) const;
+    QList<Entry> entries() const;
+
+Q_SIGNALS:
+    void updated();
+};
+
+DCORE_END_NAMESPACE
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "dtkcore_global.h"
+#include "ddesktopentry.h"
+
+#include <DObject>
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+
+DCORE_BEGIN_NAMESPACE
+
+class DDesktopEntryWatcherPrivate;
+class LIBDTKCORESHARED_EXPORT DDesktopEntryWatcher : public QObject, public DObject
+{
+    Q_OBJECT
+    D_DECLARE_PRIVATE(DDesktopEntryWatcher)
+
+public:
+    explicit DDesktopEntryWatcher(const QString &filePath, QObject *parent = nullptr);
+    ~DDesktopEntryWatcher() override;
+
+    QString filePath() const;
+    QSharedPointer<DDesktopEntry> entry() const;
+
+public Q_SLOTS:
+    void refresh();
+
+Q_SIGNALS:
+    void keysChanged(const QString &section, const QStringList &keys);
+};
+
+DCORE_END_NAMESPACE
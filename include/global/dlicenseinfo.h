@@ -34,6 +34,7 @@ public:
         QString version() const;
         QString copyRight() const;
         QString licenseName() const;
+        QByteArray licenseContent() const;
 
     private:
         D_DECLARE_PRIVATE(DComponentInfo)
@@ -6,6 +6,7 @@
 
 #include "dtkcore_global.h"
 #include <QString>
+#include <QStringView>
 
 DCORE_BEGIN_NAMESPACE
 
@@ -17,4 +18,37 @@ public:
     ~DSecureString();
 };
 
+class LIBDTKCORESHARED_EXPORT DSecureBuffer
+{
+public:
+    DSecureBuffer() noexcept;
+    explicit DSecureBuffer(QStringView text);
+    DSecureBuffer(const DSecureBuffer &other);
+    DSecureBuffer(DSecureBuffer &&other) noexcept;
+    ~DSecureBuffer();
+
+    DSecureBuffer &operator=(const DSecureBuffer &other);
+    DSecureBuffer &operator=(DSecureBuffer &&other) noexcept;
+
+    inline bool isEmpty() const noexcept { return m_size == 0; }
+    inline int size() const noexcept { return m_size; }
+    inline int capacity() const noexcept { return m_capacity; }
+    inline const QChar *constData() const noexcept { return m_data; }
+    inline QStringView view() const noexcept { return QStringView(m_data, m_size); }
+    QString toRawString() const;
+
+    void reserve(int size);
+    void append(QChar ch);
+    void append(QStringView text);
+    void chop(int n);
+    void clear();
+
+private:
+    void reallocate(int capacity);
+
+    QChar *m_data = nullptr;
+    int m_size = 0;
+    int m_capacity = 0;
+};
+
 DCORE_END_NAMESPACE
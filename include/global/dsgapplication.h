@@ -7,6 +7,8 @@
 
 #include "dtkcore_global.h"
 
+#include <QFuture>
+
 DCORE_BEGIN_NAMESPACE
 
 class LIBDTKCORESHARED_EXPORT DSGApplication
@@ -14,6 +16,7 @@ class LIBDTKCORESHARED_EXPORT DSGApplication
 public:
     static QByteArray id();
     static QByteArray getId(qint64 pid);
+    static QFuture<QByteArray> getIdAsync(qint64 pid);
 };
 
 DCORE_END_NAMESPACE
@@ -8,6 +8,8 @@
 #include <dtkcore_global.h>
 
 #include <QLocale>
+#include <QDateTime>
+#include <QFuture>
 
 DCORE_BEGIN_NAMESPACE
 
@@ -188,8 +190,36 @@ public:
     static QDateTime shutdownTime();
     static qint64 uptime();
     static Arch arch();
+
+    enum InfoField {
+        ComputerNameField = 1 << 0,
+        CpuModelNameField = 1 << 1,
+        MemoryInstalledSizeField = 1 << 2,
+        MemoryTotalSizeField = 1 << 3,
+        SystemDiskSizeField = 1 << 4,
+        BootTimeField = 1 << 5,
+        ShutdownTimeField = 1 << 6,
+        UptimeField = 1 << 7,
+        AllInfoFields = (1 << 8) - 1
+    };
+    Q_DECLARE_FLAGS(InfoFields, InfoField)
+
+    struct Info {
+        QString computerName;
+        QString cpuModelName;
+        qint64 memoryInstalledSize = -1;
+        qint64 memoryTotalSize = -1;
+        qint64 systemDiskSize = -1;
+        QDateTime bootTime;
+        QDateTime shutdownTime;
+        qint64 uptime = -1;
+    };
+
+    static QFuture<Info> queryAsync(InfoFields fields = AllInfoFields);
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(DSysInfo::InfoFields)
+
 DCORE_END_NAMESPACE
 
 #endif // DSYSINFO_H
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include "dtkcore_global.h"
+
+#include <DObject>
+
+#include <QObject>
+#include <QVector>
+
+DCORE_BEGIN_NAMESPACE
+
+class DSysInfoSamplerPrivate;
+class LIBDTKCORESHARED_EXPORT DSysInfoSampler : public QObject, public DObject
+{
+    Q_OBJECT
+    D_DECLARE_PRIVATE(DSysInfoSampler)
+
+public:
+    struct Sample {
+        // the milliseconds since the previous sample, 0 for the first one
+        qint64 interval = 0;
+        // in [0, 1], the first one is of all cores, followed by each core
+        QVector<qreal> cpuUsage;
+        // in bytes
+        qint64 memoryTotal = -1;
+        qint64 memoryAvailable = -1;
+        qint64 swapTotal = -1;
+        qint64 swapFree = -1;
+        qreal loadAverage[3] = {0, 0, 0};
+        // the bytes which are read and written by the disks since the previous sample
+        qint64 diskReadBytes = 0;
+        qint64 diskWrittenBytes = 0;
+        // in degrees Celsius, of each thermal zone
+        QVector<qreal> temperatures;
+    };
+
+    explicit DSysInfoSampler(QObject *parent = nullptr);
+    ~DSysInfoSampler() override;
+
+    int interval() const;
+    void setInterval(int msec);
+    bool isActive() const;
+
+    const Sample &lastSample() const;
+
+public Q_SLOTS:
+    void start();
+    void stop();
+    bool sample();
+
+Q_SIGNALS:
+    void sampled();
+};
+
+DCORE_END_NAMESPACE
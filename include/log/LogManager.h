@@ -10,6 +10,10 @@
 
 #include "dtkcore_global.h"
 
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
 DCORE_BEGIN_NAMESPACE
 
 class DLogManagerPrivate;
@@ -17,6 +21,11 @@ class LIBDTKCORESHARED_EXPORT DLogManager
 {
     Q_DISABLE_COPY(DLogManager)
 public:
+    enum OverflowPolicy {
+        BlockWhenFull,
+        DropWhenFull
+    };
+
     static void registerConsoleAppender();
     static void registerFileAppender();
     static void registerJournalAppender();
@@ -31,6 +40,18 @@ public:
 
     static void setLogFormat(const QString &format);
 
+    static void setAsyncLogging(bool enabled, int queueSize = 8192, OverflowPolicy policy = BlockWhenFull);
+    static bool isAsyncLogging();
+    static void flush();
+
+    static void setLogRateLimit(int burst, int interval = 1000, const QString &category = QString());
+
+    static bool isLevelEnabled(QtMsgType type);
+
+    static void setBinaryLogFormat(bool enabled);
+    static bool isBinaryLogFormat();
+    static bool decodeBinaryLog(const QString &path, QIODevice *output, const QString &format = QString());
+
 private:
     void initConsoleAppender();
     void initRollingFileAppender();
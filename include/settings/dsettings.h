@@ -16,6 +16,34 @@ class DSettingsBackend;
 class DSettingsOption;
 class DSettingsGroup;
 class DSettingsPrivate;
+
+// generated by dtk-settings-tools --schema, see DSettings::fromCompiled()
+struct DSettingsCompiledOption
+{
+    const char *key;
+    const char *viewType;
+    int valueType;
+    const char *defaultValue;
+    bool canReset;
+    const char *name;
+    const char *text;
+};
+
+struct DSettingsCompiledGroup
+{
+    const char *key;
+    const char *name;
+};
+
+struct DSettingsCompiledSchema
+{
+    const char *json;
+    int optionCount;
+    const DSettingsCompiledOption *options;
+    int groupCount;
+    const DSettingsCompiledGroup *groups;
+};
+
 class LIBDTKCORESHARED_EXPORT DSettings : public QObject
 {
     Q_OBJECT
@@ -27,6 +55,7 @@ public:
 
     static QPointer<DSettings> fromJson(const QByteArray &json);
     static QPointer<DSettings> fromJsonFile(const QString &filepath);
+    static QPointer<DSettings> fromCompiled(const DSettingsCompiledSchema &schema);
     QJsonObject meta() const;
 
     QStringList keys() const;
@@ -12,14 +12,14 @@
 DCORE_BEGIN_NAMESPACE
 
 class DSettings;
+class DSettingsBackendQueue;
 class LIBDTKCORESHARED_EXPORT DSettingsBackend : public QObject
 {
     Q_OBJECT
 public:
     explicit DSettingsBackend(QObject *parent = Q_NULLPTR): QObject(parent)
     {
-        connect(this, &DSettingsBackend::sync, this, &DSettingsBackend::doSync, Qt::QueuedConnection);
-        connect(this, &DSettingsBackend::setOption, this, &DSettingsBackend::doSetOption, Qt::QueuedConnection);
+        initWriteQueue();
     }
     virtual ~DSettingsBackend() {}
 
@@ -28,6 +28,11 @@ public:
 
     virtual void doSync() = 0;
 
+    int writeDelay() const;
+    void setWriteDelay(int msec);
+
+    void flush();
+
 protected:
     virtual void doSetOption(const QString &key, const QVariant &value) = 0;
 
@@ -38,6 +43,11 @@ Q_SIGNALS:
 Q_SIGNALS:
     void sync();
     void setOption(const QString &key, const QVariant &value);
+
+private:
+    // the queue is kept out of the class, so its size stays the same
+    void initWriteQueue();
+    friend class DSettingsBackendQueue;
 };
 
 DCORE_END_NAMESPACE
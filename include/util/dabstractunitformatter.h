@@ -26,10 +26,13 @@ protected:
     virtual qreal unitValueMin(int unitId) const { Q_UNUSED(unitId); return 1; }
     virtual QString unitStr(int unitId) const = 0;
 
+    static void appendNumber(QString &out, qreal value, int precision);
+
 public:
     qreal formatAs(qreal value, int currentUnit, const int targetUnit) const;
     QPair<qreal, int> format(const qreal value, const int unit) const;
     QList<QPair<qreal, int>> formatAsUnitList(const qreal value, int unit) const;
+    void formatMany(const qreal *values, int count, int unit, QString *results, int precision = -1) const;
 };
 
 DCORE_END_NAMESPACE
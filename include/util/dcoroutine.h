@@ -0,0 +1,261 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DCOROUTINE_H
+#define DCOROUTINE_H
+
+#include <dtkcore_global.h>
+
+// the coroutine support is optional, it needs a C++20 compiler on the user side.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define DTK_CORE_HAS_COROUTINE
+
+#include "dthreadpool.h"
+#include "dthreadutils.h"
+
+#include <QAbstractEventDispatcher>
+#include <QDBusPendingCall>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QFuture>
+#include <QMetaObject>
+#include <QPromise>
+#include <QThread>
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <type_traits>
+
+DCORE_BEGIN_NAMESPACE
+
+namespace DCoroutinePrivate {
+// resumes in the thread which awaited if it runs an event loop, or in place otherwise.
+inline void resumeIn(QThread *thread, std::coroutine_handle<> handle)
+{
+    QObject *dispatcher = QAbstractEventDispatcher::instance(thread);
+    if (thread == QThread::currentThread() || !dispatcher) {
+        handle.resume();
+        return;
+    }
+    QMetaObject::invokeMethod(dispatcher, [handle] { handle.resume(); }, Qt::QueuedConnection);
+}
+
+template <typename T>
+struct IsDBusReply : std::false_type {};
+template <typename... Types>
+struct IsDBusReply<QDBusPendingReply<Types...>> : std::true_type {};
+template <typename T>
+struct IsFuture : std::false_type {};
+template <typename T>
+struct IsFuture<QFuture<T>> : std::true_type {};
+
+// the types transformed by DCoroutine, the others are awaited as they are.
+template <typename T>
+concept Transformed = IsFuture<std::remove_cvref_t<T>>::value || IsDBusReply<std::remove_cvref_t<T>>::value
+    || std::is_same_v<std::remove_cvref_t<T>, QDBusPendingCall> || std::is_same_v<std::remove_cvref_t<T>, DThreadUtils>
+    || std::is_same_v<std::remove_cvref_t<T>, DThreadPool>;
+}
+
+template <typename T>
+class DFutureAwaiter
+{
+public:
+    explicit DFutureAwaiter(QFuture<T> future)
+        : m_future(std::move(future))
+    {
+    }
+
+    bool await_ready() const { return m_future.isFinished(); }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        QThread *thread = QThread::currentThread();
+        // a failed future is canceled too, the coroutine must be resumed only once.
+        auto resume = [thread, handle, resumed = std::make_shared<std::atomic_bool>(false)] {
+            if (!resumed->exchange(true))
+                DCoroutinePrivate::resumeIn(thread, handle);
+        };
+        // continuations of the future, no watcher object is involved.
+        m_future.then(QtFuture::Launch::Sync, [resume](const QFuture<T> &) { resume(); })
+            .onCanceled([resume] { resume(); });
+    }
+
+    // rethrows the exception of the future, a canceled future without result gives a default constructed value.
+    T await_resume()
+    {
+        m_future.waitForFinished();
+        if constexpr (!std::is_void_v<T>) {
+            if (m_future.resultCount() == 0)
+                return T();
+            return m_future.result();
+        }
+    }
+
+private:
+    QFuture<T> m_future;
+};
+
+template <typename Reply = QDBusPendingCall>
+class DDBusCallAwaiter
+{
+public:
+    explicit DDBusCallAwaiter(const Reply &call)
+        : m_call(call)
+    {
+    }
+
+    bool await_ready() const { return m_call.isFinished(); }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        // QtDBus only notifies a pending call through a watcher, it lives in the awaiting thread.
+        auto watcher = new QDBusPendingCallWatcher(m_call);
+        QObject::connect(watcher, &QDBusPendingCallWatcher::finished, watcher, [handle](QDBusPendingCallWatcher *watcher) {
+            watcher->deleteLater();
+            handle.resume();
+        });
+    }
+
+    Reply await_resume() const { return m_call; }
+
+private:
+    Reply m_call;
+};
+
+class DThreadSwitchAwaiter
+{
+public:
+    explicit DThreadSwitchAwaiter(DThreadUtils &utils)
+        : m_utils(&utils)
+    {
+    }
+
+    explicit DThreadSwitchAwaiter(DThreadPool &pool)
+        : m_pool(&pool)
+    {
+    }
+
+    bool await_ready() const { return m_utils && m_utils->thread() == QThread::currentThread(); }
+
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        if (m_utils)
+            m_utils->run([handle] { handle.resume(); });
+        else
+            m_pool->run([handle] { handle.resume(); });
+    }
+
+    void await_resume() const { }
+
+private:
+    DThreadUtils *m_utils = nullptr;
+    DThreadPool *m_pool = nullptr;
+};
+
+template <typename T>
+inline DFutureAwaiter<T> operator co_await(QFuture<T> future)
+{
+    return DFutureAwaiter<T>(std::move(future));
+}
+
+inline DDBusCallAwaiter<> operator co_await(const QDBusPendingCall &call)
+{
+    return DDBusCallAwaiter<>(call);
+}
+
+template <typename... Types>
+inline DDBusCallAwaiter<QDBusPendingReply<Types...>> operator co_await(const QDBusPendingReply<Types...> &reply)
+{
+    return DDBusCallAwaiter<QDBusPendingReply<Types...>>(reply);
+}
+
+// `co_await DThreadUtils::gui()` continues in the thread of DThreadUtils
+inline DThreadSwitchAwaiter operator co_await(DThreadUtils &utils)
+{
+    return DThreadSwitchAwaiter(utils);
+}
+
+// `co_await DThreadPool::global()` continues in a thread of the pool
+inline DThreadSwitchAwaiter operator co_await(DThreadPool &pool)
+{
+    return DThreadSwitchAwaiter(pool);
+}
+
+/*
+ * The return type of a coroutine, it starts at once and its result is reported by a QFuture.
+ * In its body the QFuture, QDBusPendingCall, DThreadUtils and DThreadPool can be awaited
+ * without using the Dtk::Core namespace.
+ */
+template <typename T = void>
+class DCoroutine
+{
+    struct PromiseBase
+    {
+        PromiseBase() { promise.start(); }
+
+        DCoroutine get_return_object() { return DCoroutine(promise.future()); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+
+        void unhandled_exception()
+        {
+            promise.setException(std::current_exception());
+            promise.finish();
+        }
+
+        template <typename U>
+        DFutureAwaiter<U> await_transform(QFuture<U> future) { return DFutureAwaiter<U>(std::move(future)); }
+        DDBusCallAwaiter<> await_transform(const QDBusPendingCall &call) { return DDBusCallAwaiter<>(call); }
+        template <typename... Types>
+        DDBusCallAwaiter<QDBusPendingReply<Types...>> await_transform(const QDBusPendingReply<Types...> &reply)
+        {
+            return DDBusCallAwaiter<QDBusPendingReply<Types...>>(reply);
+        }
+        DThreadSwitchAwaiter await_transform(DThreadUtils &utils) { return DThreadSwitchAwaiter(utils); }
+        DThreadSwitchAwaiter await_transform(DThreadPool &pool) { return DThreadSwitchAwaiter(pool); }
+        template <typename Awaitable>
+            requires (!DCoroutinePrivate::Transformed<Awaitable>)
+        Awaitable &&await_transform(Awaitable &&awaitable) { return std::forward<Awaitable>(awaitable); }
+
+        QPromise<T> promise;
+    };
+
+    struct ValuePromise : PromiseBase
+    {
+        template <typename U>
+        void return_value(U &&value)
+        {
+            this->promise.addResult(std::forward<U>(value));
+            this->promise.finish();
+        }
+    };
+
+    struct VoidPromise : PromiseBase
+    {
+        void return_void() { this->promise.finish(); }
+    };
+
+public:
+    using promise_type = std::conditional_t<std::is_void_v<T>, VoidPromise, ValuePromise>;
+
+    QFuture<T> future() const { return m_future; }
+    operator QFuture<T>() const { return m_future; }
+
+    auto operator co_await() const { return DFutureAwaiter<T>(m_future); }
+
+private:
+    explicit DCoroutine(QFuture<T> future)
+        : m_future(std::move(future))
+    {
+    }
+
+    QFuture<T> m_future;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // __cpp_impl_coroutine
+#endif // DCOROUTINE_H
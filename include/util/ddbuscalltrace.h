@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <dtkcore_global.h>
+
+#include <QString>
+
+DCORE_BEGIN_NAMESPACE
+
+class LIBDTKCORESHARED_EXPORT DDBusCallTrace
+{
+public:
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    static int blockingThreshold();
+    static void setBlockingThreshold(int msec);
+
+    static QString summary();
+    static void reset();
+
+private:
+    DDBusCallTrace() = delete;
+};
+
+DCORE_END_NAMESPACE
@@ -29,6 +29,9 @@ public:
     inline bool useCache() const { return m_useCache; }
     inline void setUseCache(bool useCache) { m_useCache = useCache; }
 
+    bool prefetch() const;
+    void setPrefetch(bool prefetch);
+
     void getAllProperties();
     inline QDBusError lastExtendedError() const { return m_lastExtendedError; }
 
@@ -66,6 +69,7 @@ private Q_SLOTS:
 private:
     QVariant asyncProperty(const QString &propertyName);
     void asyncSetProperty(const QString &propertyName, const QVariant &value);
+    void connectPropertiesChanged();
     static QVariant
     demarshall(const QString &interface, const QMetaProperty &metaProperty, const QVariant &value, QDBusError *error);
 
@@ -5,6 +5,7 @@
 #pragma once
 #include "dtkcore_global.h"
 #include <QDBusAbstractInterface>
+#include <QDBusPendingCall>
 
 DCORE_BEGIN_NAMESPACE
 
@@ -29,6 +30,8 @@ public:
 
     QVariant property(const char *propName);
     void setProperty(const char *propName, const QVariant &value);
+    QDBusPendingCall asyncSetProperty(const char *propName, const QVariant &value);
+    QDBusPendingCall refreshProperties();
 
 Q_SIGNALS:
     void serviceValidChanged(const bool valid) const;
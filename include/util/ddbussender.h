@@ -19,6 +19,7 @@ class LIBDTKCORESHARED_EXPORT DDBusData
 public:
     DDBusData();
     QDBusPendingCall asyncCallWithArguments(const QString &method, const QVariantList &arguments, const QString &iface = QString());
+    QDBusMessage createMethodCall(const QString &method, const QVariantList &arguments, const QString &iface = QString()) const;
 
     QString service;
     QString path;
@@ -30,6 +31,7 @@ public:
 class LIBDTKCORESHARED_EXPORT DDBusCaller
 {
     friend class DDBusSender;
+    friend class DDBusBatch;
 
 public:
     QDBusPendingCall call();
@@ -97,4 +99,44 @@ private:
     std::shared_ptr<DDBusData> m_dbusData;
 };
 
+class LIBDTKCORESHARED_EXPORT DDBusBatchWatcher : public QObject
+{
+    Q_OBJECT
+    friend class DDBusBatch;
+
+public:
+    QList<QDBusPendingCall> calls() const;
+    bool isFinished() const;
+    bool isError() const;
+    void waitForFinished();
+
+Q_SIGNALS:
+    void finished(DDBusBatchWatcher *self);
+
+private:
+    explicit DDBusBatchWatcher(const QList<QDBusPendingCall> &calls, QObject *parent);
+    void onCallFinished();
+
+    QList<QDBusPendingCall> m_calls;
+    int m_pending;
+};
+
+class LIBDTKCORESHARED_EXPORT DDBusBatch
+{
+public:
+    DDBusBatch();
+    ~DDBusBatch();
+
+    DDBusBatch &add(const DDBusCaller &caller);
+    DDBusBatch &operator<<(const DDBusCaller &caller);
+    int count() const;
+
+    DDBusBatchWatcher *flush(QObject *parent = nullptr);
+
+private:
+    Q_DISABLE_COPY(DDBusBatch)
+
+    QList<QPair<QDBusConnection, QDBusMessage>> m_queue;
+};
+
 #endif // DDBUSSENDER_H
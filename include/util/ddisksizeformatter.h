@@ -27,6 +27,9 @@ public:
 
     DDiskSizeFormatter rate(int rate);
 
+    QPair<qreal, int> formatBytes(quint64 bytes) const;
+    void appendBytes(quint64 bytes, QString &out, int precision = 1) const;
+
 protected:
     int unitMin() const override { return B; }
     int unitMax() const override { return T; }
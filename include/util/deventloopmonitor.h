@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DEVENTLOOPMONITOR_H
+#define DEVENTLOOPMONITOR_H
+
+#include <dtkcore_global.h>
+#include <dobject.h>
+
+#include <QObject>
+
+DCORE_BEGIN_NAMESPACE
+
+class DEventLoopMonitorPrivate;
+class LIBDTKCORESHARED_EXPORT DEventLoopMonitor : public QObject, public DObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int threshold READ threshold WRITE setThreshold)
+public:
+    explicit DEventLoopMonitor(QThread *thread = nullptr, QObject *parent = nullptr);
+    ~DEventLoopMonitor() override;
+
+    QThread *monitoredThread() const;
+
+    int threshold() const;
+    void setThreshold(int msec);
+
+    bool isActive() const;
+    bool start();
+    void stop();
+
+Q_SIGNALS:
+    void stalled(int eventType, const QString &receiverClass, qint64 msec);
+
+private:
+    D_DECLARE_PRIVATE(DEventLoopMonitor)
+};
+
+DCORE_END_NAMESPACE
+
+#endif // DEVENTLOOPMONITOR_H
@@ -8,7 +8,9 @@
 #include <dtkcore_global.h>
 #include <dobject.h>
 
+#include <QFuture>
 #include <QObject>
+#include <QVariant>
 
 #include <functional>
 
@@ -24,7 +26,10 @@ public:
     ~DExportedInterface();
 
     void registerAction(const QString &action, const QString &description, const std::function<QVariant(QString)> handler = nullptr);
+    void registerTypedAction(const QString &action, const QString &description, const std::function<QVariant(const QVariantList &)> handler);
+    void registerAsyncAction(const QString &action, const QString &description, const std::function<QFuture<QVariant>(const QVariantList &)> handler);
     virtual QVariant invoke(const QString &action, const QString &parameters) const;
+    QFuture<QVariant> call(const QString &action, const QVariantList &arguments) const;
 private:
     D_DECLARE_PRIVATE(DExportedInterface)
 };
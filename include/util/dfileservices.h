@@ -7,6 +7,7 @@
 
 #include <dtkcore_global.h>
 
+#include <QDBusPendingCall>
 #include <QUrl>
 
 DCORE_BEGIN_NAMESPACE
@@ -29,6 +30,11 @@ public:
     static bool showFileItem(QUrl url, const QString &startupId = QString());
     static bool showFileItems(const QList<QUrl> urls, const QString &startupId = QString());
 
+    static QDBusPendingCall showFoldersAsync(const QList<QUrl> &urls, const QString &startupId = QString());
+    static QDBusPendingCall showFileItemPropertiesAsync(const QList<QUrl> &urls, const QString &startupId = QString());
+    static QDBusPendingCall showFileItemsAsync(const QList<QUrl> &urls, const QString &startupId = QString());
+    static void postShowFileItems(const QList<QUrl> &urls, const QString &startupId = QString());
+
     static bool trash(QString localFilePath);
     static bool trash(const QList<QString> localFilePaths);
     static bool trash(QUrl urlstartupId);
@@ -8,6 +8,8 @@
 #include "dtkcore_global.h"
 
 #include <QDBusPendingCall>
+#include <QObject>
+#include <QScopedPointer>
 #include <memory>
 
 DCORE_BEGIN_NAMESPACE
@@ -29,6 +31,30 @@ public:
 private:
     std::shared_ptr<DNotifyData> m_dbusData;
 };
+
+class DNotificationPrivate;
+class LIBDTKCORESHARED_EXPORT DNotification : public QObject {
+    Q_OBJECT
+public:
+    explicit DNotification(QObject *parent = nullptr);
+    ~DNotification() override;
+
+    uint id() const;
+    int minimumInterval() const;
+    void setMinimumInterval(int msec);
+
+    void notify(const DNotifySender &sender);
+    void flush();
+    void close();
+
+Q_SIGNALS:
+    void notified(uint id);
+
+private:
+    QScopedPointer<DNotificationPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(DNotification)
+    Q_DISABLE_COPY(DNotification)
+};
 }  // namespace DUtil
 
 DCORE_END_NAMESPACE
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DPERFCOUNTERS_H
+#define DPERFCOUNTERS_H
+
+#include <dtkcore_global.h>
+
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+#include <atomic>
+#include <chrono>
+#include <initializer_list>
+
+DCORE_BEGIN_NAMESPACE
+
+namespace DUtil {
+class DExportedInterface;
+}
+
+class LIBDTKCORESHARED_EXPORT DPerfCounter
+{
+public:
+    explicit DPerfCounter(const char *name) noexcept;
+    ~DPerfCounter();
+
+    inline void add(qint64 n = 1) noexcept { m_value.fetch_add(n, std::memory_order_relaxed); }
+    inline qint64 value() const noexcept { return m_value.load(std::memory_order_relaxed); }
+    inline const char *name() const noexcept { return m_name; }
+    void reset() noexcept;
+
+private:
+    Q_DISABLE_COPY(DPerfCounter)
+
+    const char *m_name;
+    std::atomic<qint64> m_value {0};
+};
+
+class LIBDTKCORESHARED_EXPORT DPerfHistogram
+{
+public:
+    enum { MaxBounds = 15 };
+
+    class ScopedTimer
+    {
+    public:
+        inline explicit ScopedTimer(DPerfHistogram &histogram) noexcept
+            : m_histogram(histogram)
+            , m_start(std::chrono::steady_clock::now())
+        {
+        }
+        inline ~ScopedTimer()
+        {
+            m_histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now() - m_start).count());
+        }
+
+    private:
+        Q_DISABLE_COPY(ScopedTimer)
+
+        DPerfHistogram &m_histogram;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    DPerfHistogram(const char *name, std::initializer_list<qint64> bounds) noexcept;
+    ~DPerfHistogram();
+
+    inline void record(qint64 value) noexcept
+    {
+        int i = 0;
+        while (i < m_boundCount && value > m_bounds[i])
+            ++i;
+        m_counts[i].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    inline const char *name() const noexcept { return m_name; }
+    QVector<qint64> bounds() const;
+    QVector<qint64> counts() const;
+    qint64 count() const noexcept;
+    qint64 sum() const noexcept;
+    void reset() noexcept;
+
+private:
+    Q_DISABLE_COPY(DPerfHistogram)
+
+    const char *m_name;
+    int m_boundCount = 0;
+    qint64 m_bounds[MaxBounds] = {};
+    std::atomic<qint64> m_counts[MaxBounds + 1] = {};
+    std::atomic<qint64> m_sum {0};
+};
+
+class LIBDTKCORESHARED_EXPORT DPerfCounters
+{
+public:
+    static QStringList counterNames();
+    static QStringList histogramNames();
+    static qint64 counterValue(const QString &name);
+    static QVariantMap snapshot();
+    static void reset();
+
+    static void exportTo(DUtil::DExportedInterface *interface, const QString &action = QStringLiteral("perf-counters"));
+};
+
+DCORE_END_NAMESPACE
+
+#endif // DPERFCOUNTERS_H
@@ -8,6 +8,9 @@
 #include <dtkcore_global.h>
 
 #include <QHash>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QVector>
 
 DCORE_BEGIN_NAMESPACE
 
@@ -24,10 +27,52 @@ enum ToneStyle {
 // support polyphonic
 QStringList LIBDTKCORESHARED_EXPORT pinyin(const QString& words, ToneStyle ts = TS_Tone, bool *ok = nullptr);
 
+// support polyphonic, the most common readings first, at most count results
+QStringList LIBDTKCORESHARED_EXPORT commonPinyin(const QString &words, int count, ToneStyle ts = TS_Tone, bool *ok = nullptr);
+
+// support polyphonic, the combinations are generated lazily
+class DPinyinIteratorPrivate;
+class LIBDTKCORESHARED_EXPORT DPinyinIterator
+{
+public:
+    enum Order {
+        Lexicographic,   /*!< @~english the same order as pinyin() */
+        MostCommonFirst, /*!< @~english the combinations of the most common readings first */
+    };
+
+    explicit DPinyinIterator(const QString &words, ToneStyle ts = TS_Tone, Order order = Lexicographic);
+    ~DPinyinIterator();
+
+    bool hasNext() const;
+    QString next();
+
+    bool isAllFound() const;
+
+private:
+    Q_DISABLE_COPY(DPinyinIterator)
+    QScopedPointer<DPinyinIteratorPrivate> d;
+};
+
 // support polyphonic
 QStringList LIBDTKCORESHARED_EXPORT firstLetters(const QString& words);
 QStringList LIBDTKCORESHARED_EXPORT firstLetters(const QString& words, ToneStyle ts);
 
+// the results of a batch, the results of words i are values[offsets[i], offsets[i + 1])
+struct DPinyinBatch
+{
+    QStringList values;
+    QVector<int> offsets;
+    QVector<bool> found;
+
+    inline int size() const { return found.size(); }
+    inline int count(int index) const { return offsets.at(index + 1) - offsets.at(index); }
+    inline QStringList at(int index) const { return values.mid(offsets.at(index), count(index)); }
+};
+
+// convert a list of words, maxThreadCount <= 0 means QThread::idealThreadCount()
+DPinyinBatch LIBDTKCORESHARED_EXPORT batchPinyin(const QStringList &words, ToneStyle ts = TS_Tone, int maxThreadCount = 1);
+DPinyinBatch LIBDTKCORESHARED_EXPORT batchFirstLetters(const QStringList &words, ToneStyle ts = TS_Tone, int maxThreadCount = 1);
+
 DCORE_END_NAMESPACE
 
 #endif // DPINYIN_H
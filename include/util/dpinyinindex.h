@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DPINYININDEX_H
+#define DPINYININDEX_H
+
+#include <dtkcore_global.h>
+
+#include <QScopedPointer>
+#include <QStringList>
+#include <QVector>
+
+DCORE_BEGIN_NAMESPACE
+
+class DPinyinIndexPrivate;
+class LIBDTKCORESHARED_EXPORT DPinyinIndex
+{
+public:
+    DPinyinIndex();
+    explicit DPinyinIndex(const QStringList &texts);
+    ~DPinyinIndex();
+
+    int insert(const QString &text);
+    void clear();
+
+    int size() const;
+    QString text(int id) const;
+
+    QVector<int> search(const QString &query, int limit = -1) const;
+
+private:
+    Q_DISABLE_COPY(DPinyinIndex)
+    QScopedPointer<DPinyinIndexPrivate> d;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // DPINYININDEX_H
@@ -6,7 +6,12 @@
 #define DRECENTMANAGER_H
 
 #include "dtkcore_global.h"
+#include "dobject.h"
 #include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QFuture>
+#include <QObject>
 
 DCORE_BEGIN_NAMESPACE
 
@@ -17,12 +22,51 @@ struct LIBDTKCORESHARED_EXPORT DRecentData
     QString mimeType;
 };
 
+struct LIBDTKCORESHARED_EXPORT DRecentItem
+{
+    QString uri;
+    QString mimeType;
+    QDateTime added;
+    QDateTime modified;
+    QDateTime visited;
+    QStringList applications;
+};
+
+struct LIBDTKCORESHARED_EXPORT DRecentFilter
+{
+    QString appName;
+    QString mimeType;
+    QDateTime since;
+    QDateTime until;
+    int limit = -1;
+};
+
 class LIBDTKCORESHARED_EXPORT DRecentManager
 {
 public:
     static bool addItem(const QString &uri, DRecentData &data);
+    static QFuture<bool> addItems(const QStringList &uris, const DRecentData &data);
     static void removeItem(const QString &target);
     static void removeItems(const QStringList &list);
+    static void setMaxItemCount(int count);
+    static int maxItemCount();
+
+    static QList<DRecentItem> items(const DRecentFilter &filter = DRecentFilter());
+};
+
+class DRecentWatcherPrivate;
+class LIBDTKCORESHARED_EXPORT DRecentWatcher : public QObject, public DObject
+{
+    Q_OBJECT
+public:
+    explicit DRecentWatcher(QObject *parent = nullptr);
+    ~DRecentWatcher() override;
+
+Q_SIGNALS:
+    void changed();
+
+private:
+    D_DECLARE_PRIVATE(DRecentWatcher)
 };
 
 DCORE_END_NAMESPACE
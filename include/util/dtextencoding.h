@@ -9,14 +9,31 @@
 
 #include <QString>
 #include <QByteArray>
+#include <QByteArrayList>
+#include <QHash>
+#include <QScopedPointer>
+
+#include <functional>
 
 DCORE_BEGIN_NAMESPACE
 
 class LIBDTKCORESHARED_EXPORT DTextEncoding
 {
 public:
+    typedef std::function<void(qint64 convertedBytes, qint64 totalBytes)> ProgressFunction;
+    typedef std::function<void(const QString &fileName, const QByteArray &encoding)> DetectedFunction;
+
     static QByteArray detectTextEncoding(const QByteArray &content);
     static QByteArray detectFileEncoding(const QString &fileName, bool *isOk = nullptr);
+    static QHash<QString, QByteArray> detectFileEncodings(const QStringList &fileNames,
+                                                          const DetectedFunction &detected = DetectedFunction(),
+                                                          int maxThreadCount = 0);
+
+    static void setDetectionCacheSize(int size);
+    static int detectionCacheSize();
+    static void clearDetectionCache();
+    static quint64 detectionCacheHits();
+    static quint64 detectionCacheMisses();
 
     static bool convertTextEncoding(QByteArray &content,
                                     QByteArray &outContent,
@@ -38,6 +55,44 @@ public:
                                       const QByteArray &toEncoding,
                                       const QByteArray &fromEncoding = QByteArray(),
                                       QString *errString = nullptr);
+    static bool convertFileEncoding(const QString &fileName,
+                                    const QByteArray &toEncoding,
+                                    const QByteArray &fromEncoding,
+                                    QString *errString,
+                                    const ProgressFunction &progress);
+    static bool convertFileEncodingTo(const QString &fromFile,
+                                      const QString &toFile,
+                                      const QByteArray &toEncoding,
+                                      const QByteArray &fromEncoding,
+                                      QString *errString,
+                                      const ProgressFunction &progress);
+};
+
+class DTextConverterPrivate;
+class LIBDTKCORESHARED_EXPORT DTextConverter
+{
+public:
+    DTextConverter(const QByteArray &toEncoding, const QByteArray &fromEncoding);
+    ~DTextConverter();
+
+    QByteArray toEncoding() const;
+    QByteArray fromEncoding() const;
+    bool isValid() const;
+
+    bool convert(const QByteArray &content,
+                 QByteArray &outContent,
+                 QString *errString = nullptr,
+                 int *convertedBytes = nullptr) const;
+    bool convert(const char *data,
+                 int size,
+                 QByteArray &outContent,
+                 QString *errString = nullptr,
+                 int *convertedBytes = nullptr) const;
+    bool convert(const QByteArrayList &contents, QByteArrayList &outContents, QString *errString = nullptr) const;
+
+private:
+    Q_DISABLE_COPY(DTextConverter)
+    QScopedPointer<DTextConverterPrivate> d;
 };
 
 DCORE_END_NAMESPACE
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DTHREADPOOL_H
+#define DTHREADPOOL_H
+
+#include <dtkcore_global.h>
+
+#include <QFuture>
+#include <QPromise>
+#include <QScopedPointer>
+#include <QThread>
+
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+
+DCORE_BEGIN_NAMESPACE
+
+class DThreadPoolPrivate;
+class LIBDTKCORESHARED_EXPORT DThreadPool final
+{
+    friend class DThreadPoolPrivate;
+public:
+    explicit DThreadPool(int threadCount = QThread::idealThreadCount());
+    ~DThreadPool();
+
+    static DThreadPool &global();
+
+    int threadCount() const;
+    int pendingCount() const;
+    bool waitForDone(int msecs = -1);
+
+    template <typename Func, typename... Args>
+    inline QFuture<std::invoke_result_t<std::decay_t<Func>, std::decay_t<Args>...>> run(Func &&fun, Args &&...args)
+    {
+        using Task = RunTask<std::decay_t<Func>, std::decay_t<Args>...>;
+        auto task = new Task(std::forward<Func>(fun), std::forward<Args>(args)...);
+        auto future = task->promise.future();
+        submit(task);
+        return future;
+    }
+
+private:
+    Q_DISABLE_COPY(DThreadPool)
+
+    class AbstractTask
+    {
+    public:
+        virtual ~AbstractTask() = default;
+        virtual void run() = 0;
+    };
+
+    template <typename Func, typename... Args>
+    class Q_DECL_HIDDEN RunTask : public AbstractTask
+    {
+        using ReturnType = std::invoke_result_t<Func, Args...>;
+
+    public:
+        template <typename F, typename... A>
+        RunTask(F &&fun, A &&...args)
+            : function(std::forward<F>(fun))
+            , arguments(std::forward<A>(args)...)
+        {
+        }
+
+        void run() override
+        {
+            if (promise.isCanceled()) {
+                return;
+            }
+
+            promise.start();
+#ifndef QT_NO_EXCEPTIONS
+            try {
+#endif
+                if constexpr (std::is_void_v<ReturnType>) {
+                    std::apply(function, std::move(arguments));
+                } else {
+                    promise.addResult(std::apply(function, std::move(arguments)));
+                }
+#ifndef QT_NO_EXCEPTIONS
+            } catch (...) {
+                promise.setException(std::current_exception());
+            }
+#endif
+            promise.finish();
+        }
+
+        Func function;
+        std::tuple<Args...> arguments;
+        QPromise<ReturnType> promise;
+    };
+
+    void submit(AbstractTask *task);
+
+    QScopedPointer<DThreadPoolPrivate> d;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // DTHREADPOOL_H
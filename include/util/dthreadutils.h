@@ -171,6 +171,9 @@ public:
 
     QThread *thread() const noexcept;
 
+    bool isBatchingEnabled() const;
+    void setBatchingEnabled(bool enabled);
+
     template <typename Func, typename... Args>
     inline auto run(QObject *context,typename QtPrivate::FunctionPointer<Func>::Object *obj, Func fun, Args &&...args)
     {
@@ -219,6 +222,9 @@ private:
         {
         }
         virtual void call() = 0;
+
+        // the link of the batching queue
+        AbstractCallEvent *next{nullptr};
     };
 
     template <typename Func, typename... Args>
@@ -311,13 +317,14 @@ private:
             event->context = context;
             event->contextChecker = context;
 
-            QCoreApplication::postEvent(ensureThreadContextObject(), event);
+            post(event);
         }
 
         return future;
     }
 
     QObject *ensureThreadContextObject();
+    void post(AbstractCallEvent *event);
 
     static inline QEvent::Type eventType;
     QThread *m_thread;
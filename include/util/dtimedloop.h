@@ -9,6 +9,8 @@
 
 #include <QEventLoop>
 
+#include <functional>
+
 DCORE_BEGIN_NAMESPACE
 
 class DObject;
@@ -36,6 +38,14 @@ public:
     int exec(const QString &executionName, QEventLoop::ProcessEventsFlags flags = QEventLoop::AllEvents);
     int exec(int durationMs, const QString &executionName, QEventLoop::ProcessEventsFlags flags = QEventLoop::AllEvents);
 
+    // 方式3：不开启嵌套的事件循环，立即返回，在 exit 或者定时结束时调用 callback，参数为 exit 的 returnCode，定时结束为 0
+    // durationMs 小于 0 时不定时，executionName 与 exec 的相同，用于输出执行时间
+    // 等待中再次调用会以 -1 结束上一次的等待
+    void execAsync(const std::function<void(int)> &callback);
+    void execAsync(int durationMs, const std::function<void(int)> &callback);
+    void execAsync(int durationMs, const QString &executionName, const std::function<void(int)> &callback);
+    bool isWaiting() const;
+
 private:
     Q_DISABLE_COPY(DTimedLoop)
     D_DECLARE_PRIVATE(DTimedLoop)
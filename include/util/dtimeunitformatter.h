@@ -25,6 +25,9 @@ public:
 
     QString unitStr(int unitId) const override;
 
+    QPair<qreal, int> formatSeconds(quint64 seconds) const;
+    void appendSeconds(quint64 seconds, QString &out) const;
+
 protected:
     int unitMax() const override { return Day; }
     int unitMin() const override { return Seconds; }
@@ -11,6 +11,10 @@
 #include <QRegularExpression>
 #include <QStandardPaths>
 #include <QDir>
+#include <QHash>
+#include <QVarLengthArray>
+
+#include "ddesktopentryindex.h"
 #include <type_traits>
 #include <cstring>
 
@@ -54,45 +58,122 @@ void SecureErase(T &obj)
     }
 }
 
-inline QString escapeToObjectPath(const QString &str)
+namespace ObjectPathEscape {
+// the characters which are kept as is in the object path, others are escaped to "_" and the hex
+constexpr bool isPlainChar(char16_t c)
+{
+    return (c >= u'a' && c <= u'z') || (c >= u'A' && c <= u'Z') || (c >= u'0' && c <= u'9');
+}
+
+constexpr int hexValue(char16_t c)
+{
+    return (c >= u'0' && c <= u'9') ? c - u'0' : (c >= u'a' && c <= u'f') ? c - u'a' + 10 : (c >= u'A' && c <= u'F') ? c - u'A' + 10 : -1;
+}
+
+constexpr char HexDigits[] = "0123456789abcdef";
+
+// the hex digits without the leading zeros, the same as QString::number(value, 16)
+inline void appendHex(QString &out, uint value)
+{
+    int shift = 28;
+    while (shift > 0 && !(value >> shift))
+        shift -= 4;
+    for (; shift >= 0; shift -= 4)
+        out.append(QLatin1Char(HexDigits[(value >> shift) & 0xf]));
+}
+}
+
+inline QString escapeToObjectPath(QStringView str)
 {
     if (str.isEmpty()) {
-        return "_";
+        return QStringLiteral("_");
     }
 
-    auto ret = str;
-    QRegularExpression re{R"([^a-zA-Z0-9])"};
-    auto matcher = re.globalMatch(ret);
-    while (matcher.hasNext()) {
-        auto replaceList = matcher.next().capturedTexts();
-        replaceList.removeDuplicates();
-        for (const auto &c : replaceList) {
-            auto hexStr = QString::number(static_cast<uint>(c.front().toLatin1()), 16);
-            ret.replace(c, QString{R"(_%1)"}.arg(hexStr));
+    // The result is the same as the one of the former regular expression, which replaced every
+    // occurrence of a character in turn, so that the object paths match the ones of the other
+    // processes. A character is escaped to "_" and the hex of its Latin-1 value without padding,
+    // it's 0 out of Latin-1. Every '_' of the input replaced all of the '_' of the result by "_5f"
+    // again, so an escape gets one "5f" for every '_' after the first occurrence of its character.
+    QVarLengthArray<int, 64> underscoresAfter(int(str.size()) + 1);
+    underscoresAfter[int(str.size())] = 0;
+    for (int i = int(str.size()) - 1; i >= 0; --i)
+        underscoresAfter[i] = underscoresAfter[i + 1] + (str[i] == QLatin1Char('_') ? 1 : 0);
+    const int underscores = underscoresAfter[0];
+    QHash<ushort, int> firstIndex;
+
+    QString ret;
+    ret.reserve(int(str.size() * 3));
+    for (int i = 0; i < int(str.size()); ++i) {
+        const QChar c = str[i];
+        if (ObjectPathEscape::isPlainChar(c.unicode())) {
+            ret.append(c);
+            continue;
         }
+
+        int count = underscores;
+        if (c != QLatin1Char('_') && underscores > 0) {
+            int first = firstIndex.value(c.unicode(), -1);
+            if (first < 0) {
+                first = i;
+                firstIndex.insert(c.unicode(), first);
+            }
+            count = underscoresAfter[first + 1];
+        } else if (c != QLatin1Char('_')) {
+            count = 0;
+        }
+
+        ret.append(QLatin1Char('_'));
+        for (; count > 0; --count)
+            ret.append(QLatin1String("5f"));
+        if (c != QLatin1Char('_'))
+            ObjectPathEscape::appendHex(ret, static_cast<uint>(c.toLatin1()));
     }
     return ret;
 }
 
-inline QString unescapeFromObjectPath(const QString &str)
+inline QString escapeToObjectPath(const QString &str)
 {
-    auto ret = str;
-    for (int i = 0; i < str.size(); ++i) {
-        if (str[i] == '_' && i + 2 < str.size()) {
-            auto hexStr = str.mid(i + 1, 2);
-            ret.replace(QString{"_%1"}.arg(hexStr), QChar::fromLatin1(hexStr.toUInt(nullptr, 16)));
-            i += 2;
+    return escapeToObjectPath(QStringView(str));
+}
+
+inline QString unescapeFromObjectPath(QStringView str)
+{
+    QString ret(int(str.size()), Qt::Uninitialized);
+    QChar *out = ret.data();
+    for (qsizetype i = 0; i < str.size(); ++i) {
+        if (str[i] == QLatin1Char('_') && i + 2 < str.size()) {
+            const int high = ObjectPathEscape::hexValue(str[i + 1].unicode());
+            const int low = ObjectPathEscape::hexValue(str[i + 2].unicode());
+            if (high >= 0 && low >= 0) {
+                *out++ = QChar::fromLatin1(char(high << 4 | low));
+                i += 2;
+                continue;
+            }
         }
+        *out++ = str[i];
     }
+    ret.truncate(int(out - ret.constData()));
     return ret;
 }
 
+inline QString unescapeFromObjectPath(const QString &str)
+{
+    return unescapeFromObjectPath(QStringView(str));
+}
+
 inline QString getAppIdFromAbsolutePath(const QString &path)
 {
     static QString desktopSuffix{u8".desktop"};
-    const auto &appDirs = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
-    if (!path.endsWith(desktopSuffix) ||
-        !std::any_of(appDirs.cbegin(), appDirs.constEnd(), [&path](const QString &dir) { return path.startsWith(dir); })) {
+    if (!path.endsWith(desktopSuffix))
+        return {};
+
+    // the existing desktop files are looked up in the cached ids
+    const QString &desktopId = DTK_CORE_NAMESPACE::DDesktopEntryIndex::desktopIdOfFile(path);
+    if (!desktopId.isEmpty())
+        return desktopId.chopped(desktopSuffix.size());
+
+    const auto &appDirs = DTK_CORE_NAMESPACE::DDesktopEntryIndex::applicationDirectories();
+    if (!std::any_of(appDirs.cbegin(), appDirs.constEnd(), [&path](const QString &dir) { return path.startsWith(dir); })) {
         return {};
     }
 
@@ -109,23 +190,6 @@ inline QString getAppIdFromAbsolutePath(const QString &path)
 
 inline QStringList getAbsolutePathFromAppId(const QString &appId)
 {
-    auto components = appId.split('-', Qt::SkipEmptyParts);
-    auto appDirs = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
-
-    QStringList ret;
-    for (const auto &dirPath : appDirs) {
-        auto currentDir = dirPath;
-        for (auto it = components.cbegin(); it != components.cend(); ++it) {
-            auto currentName = QStringList{it, components.cend()}.join('-') + QString{".desktop"};
-            QDir dir{currentDir};
-            if (dir.exists(currentName)) {
-                ret.append(dir.filePath(currentName));
-            }
-
-            currentDir.append(QDir::separator() + *it);
-        }
-    }
-
-    return ret;
+    return DTK_CORE_NAMESPACE::DDesktopEntryIndex::desktopFilePaths(appId + QStringLiteral(".desktop"));
 }
 }
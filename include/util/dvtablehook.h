@@ -9,6 +9,8 @@
 
 #include <QObject>
 #include <QSet>
+#include <QByteArrayList>
+#include <QVector>
 #include <QDebug>
 #include <QLoggingCategory>
 #include <functional>
@@ -67,7 +69,12 @@ public:
     static quintptr resetVfptrFun(const void *obj, quintptr functionOffset);
     static quintptr originalFun(const void *obj, quintptr functionOffset);
     static bool forceWriteMemory(void *adr, const void *data, size_t length);
+    static void beginWriteBatch();
+    static bool endWriteBatch();
+    static void setVtableSharingEnabled(bool enabled);
+    static bool isVtableSharingEnabled();
     static QFunctionPointer resolve(const char *symbol);
+    static QVector<QFunctionPointer> resolve(const QByteArrayList &symbols);
 
     template <typename T> class OverrideDestruct : public T { ~OverrideDestruct() override;};
     template <typename List1, typename List2> struct CheckCompatibleArguments { enum { value = false }; };
@@ -119,10 +126,13 @@ public:
             return false;
         }
 
+        detachVtable(t1);
+
         quintptr *vfptr_t1 = getVtableOfObject(t1);
         quintptr *vfptr_t2 = getVtableOfObject(t2);
 
         bool ok = overrideVfptrFun(vfptr_t1, fun1, vfptr_t2, fun2, false);
+        shareVtable(t1);
 
         if (!ok) {
             // 恢复旧环境
@@ -253,7 +263,9 @@ public:
             return false;
         }
 
+        detachVtable(t1);
         bool ok = overrideVfptrFun(getVtableOfObject(t1), fun1, fun2, false);
+        shareVtable(t1);
 
         if (!ok) {
             // 恢复旧环境
@@ -307,7 +319,9 @@ public:
         public:
             ~_ResetVFun() {
                 *(vfptr + offset / sizeof(quintptr)) = oldFun;
+                DVtableHook::shareVtable(obj);
             }
+            const void *obj = nullptr;
             quintptr *vfptr = nullptr;
             quint16 offset = 0;
             quintptr oldFun = 0;
@@ -315,9 +329,11 @@ public:
 
         _ResetVFun rvf;
 
-        rvf.vfptr = *(quintptr**)(obj);
+        rvf.obj = obj;
         rvf.offset = fun_offset;
-        rvf.oldFun = DVtableHook::resetVfptrFun((void*)obj, fun_offset);
+        // the shared vtable is detached here, and shared again after the call
+        rvf.oldFun = DVtableHook::resetVfptrFun((void*)obj, fun_offset, false);
+        rvf.vfptr = *(quintptr**)(obj);
 
         if (!rvf.oldFun) {
             qCWarning(vtableHook) << "Reset the function failed, object: " << obj;
@@ -331,6 +347,10 @@ public:
 private:
     static bool copyVtable(quintptr **obj);
     static bool clearGhostVtable(const void *obj);
+    static bool ensureSharedVtable(quintptr **obj, std::function<void(void)> destoryObjFun);
+    static void detachVtable(const void *obj);
+    static void shareVtable(const void *obj);
+    static quintptr resetVfptrFun(const void *obj, quintptr functionOffset, bool share);
 #if DTK_VERSION < DTK_VERSION_CHECK(6, 0, 0, 0)
     Q_DECL_DEPRECATED static bool isFinalClass(quintptr *obj);
     Q_DECL_DEPRECATED static quintptr **adjustThis(quintptr *obj);
@@ -357,6 +377,8 @@ private:
         delete obj;
     }
 
+    // ABI placeholders, they're exported symbols of the library and always empty,
+    // the hooked objects are kept in the sharded tables of dvtablehook.cpp
     static QMap<quintptr**, quintptr*> objToOriginalVfptr;
     static QMap<const void*, quintptr*> objToGhostVfptr;
     static QMap<const void*, quintptr> objDestructFun;
@@ -0,0 +1,196 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef DWORKQUEUE_H
+#define DWORKQUEUE_H
+
+#include <dtkcore_global.h>
+
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QPointer>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * The successor of DAsync: the data posted are handled in order by the work function in a
+ * worker thread, and every result is passed to the continuations, in the worker thread by then()
+ * and in the main thread (or the thread of a context object) by thenInMain().
+ *
+ * The worker sleeps on a condition variable and is woken up exactly by post(), cancel() and the
+ * destructor, there is no polling. cancel() drops the queued data and the results not delivered
+ * to the main thread yet. The destructor cancels and waits for the worker thread.
+ */
+template <typename In, typename Out>
+class DWorkQueue
+{
+    template <typename T>
+    using Function = std::conditional_t<std::is_void_v<T>, std::function<Out()>, std::function<Out(T)>>;
+    template <typename T>
+    using Handler = std::conditional_t<std::is_void_v<T>, std::function<void()>, std::function<void(T)>>;
+
+public:
+    using WorkFunction = Function<In>;
+    using Continuation = Handler<Out>;
+
+    explicit DWorkQueue(WorkFunction work)
+        : m_work(std::move(work))
+    {
+    }
+
+    ~DWorkQueue()
+    {
+        cancel();
+        if (!m_thread.joinable())
+            return;
+        // destroyed by a continuation in the worker thread
+        if (m_thread.get_id() == std::this_thread::get_id())
+            m_thread.detach();
+        else
+            m_thread.join();
+    }
+
+    DWorkQueue &then(Continuation continuation)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_then = std::move(continuation);
+        return *this;
+    }
+
+    DWorkQueue &thenInMain(Continuation continuation, QObject *context = nullptr)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_thenInMain = std::move(continuation);
+        m_context = context ? context : QCoreApplication::instance();
+        return *this;
+    }
+
+    template <typename T = In, typename = std::enable_if_t<!std::is_void_v<T>>>
+    bool post(T data)
+    {
+        return enqueue([this, data = std::move(data)]() mutable { return m_work(std::move(data)); });
+    }
+
+    template <typename T = In, typename = std::enable_if_t<std::is_void_v<T>>>
+    bool post()
+    {
+        return enqueue([this] { return m_work(); });
+    }
+
+    void cancel()
+    {
+        {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            m_canceled->store(true);
+            m_queue.clear();
+        }
+        m_condition.notify_all();
+    }
+
+    bool isCanceled() const { return m_canceled->load(); }
+
+    int pendingCount() const
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        return static_cast<int>(m_queue.size()) + (m_running ? 1 : 0);
+    }
+
+    // waits until the queued data are handled, the continuations in the main thread aren't waited.
+    void waitForIdle()
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_idleCondition.wait(locker, [this] { return m_queue.empty() && !m_running; });
+    }
+
+private:
+    Q_DISABLE_COPY(DWorkQueue)
+
+    bool enqueue(std::function<Out()> task)
+    {
+        {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            if (m_canceled->load())
+                return false;
+            m_queue.push_back(std::move(task));
+            if (!m_thread.joinable())
+                m_thread = std::thread(&DWorkQueue::run, this);
+        }
+        m_condition.notify_one();
+        return true;
+    }
+
+    void run()
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        while (true) {
+            m_condition.wait(locker, [this] { return m_canceled->load() || !m_queue.empty(); });
+            if (m_canceled->load())
+                break;
+
+            std::function<Out()> task = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_running = true;
+            Continuation then = m_then;
+            Continuation thenInMain = m_thenInMain;
+            QPointer<QObject> context = m_context;
+            locker.unlock();
+
+            if constexpr (std::is_void_v<Out>) {
+                task();
+                if (then)
+                    then();
+                if (thenInMain && context) {
+                    QMetaObject::invokeMethod(context.data(), [thenInMain, canceled = m_canceled] {
+                        if (!canceled->load())
+                            thenInMain();
+                    }, Qt::QueuedConnection);
+                }
+            } else {
+                Out result = task();
+                if (then)
+                    then(result);
+                if (thenInMain && context) {
+                    QMetaObject::invokeMethod(context.data(), [thenInMain, canceled = m_canceled, result = std::move(result)] {
+                        if (!canceled->load())
+                            thenInMain(result);
+                    }, Qt::QueuedConnection);
+                }
+            }
+
+            locker.lock();
+            m_running = false;
+            if (m_queue.empty())
+                m_idleCondition.notify_all();
+        }
+        m_running = false;
+        m_idleCondition.notify_all();
+    }
+
+    WorkFunction m_work;
+    Continuation m_then;
+    Continuation m_thenInMain;
+    QPointer<QObject> m_context;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::condition_variable m_idleCondition;
+    std::deque<std::function<Out()>> m_queue;
+    bool m_running = false;
+    // shared with the continuations queued to the main thread, they may outlive the queue.
+    std::shared_ptr<std::atomic_bool> m_canceled = std::make_shared<std::atomic_bool>(false);
+    std::thread m_thread;
+};
+
+DCORE_END_NAMESPACE
+
+#endif // DWORKQUEUE_H
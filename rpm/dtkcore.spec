@@ -14,8 +14,10 @@ BuildRequires:  gcc-c++
 BuildRequires:  annobin
 BuildRequires:  pkgconfig(Qt5Core)
 BuildRequires:  pkgconfig(gsettings-qt)
+BuildRequires:  pkgconfig(gio-2.0)
 BuildRequires:  gtest-devel
 BuildRequires:  uchardet-devel
+BuildRequires:  pkgconfig(libzstd)
 BuildRequires:  libicu-devel
 
 # since f30
@@ -5,4 +5,5 @@ set(base_SRCS
   ${CMAKE_CURRENT_LIST_DIR}/../../include/base/dexpected.h
   ${CMAKE_CURRENT_LIST_DIR}/../../include/base/derror.h
   ${CMAKE_CURRENT_LIST_DIR}/dobject.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/dsingleton.cpp
 )
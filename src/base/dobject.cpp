@@ -174,6 +174,18 @@ DObject::~DObject()
    \sa D_DECLARE_PUBLIC D_Q
 */
 
+/*!
+   \macro D_DECLARE_POOLED_PRIVATE(Class)
+   \relates Dtk::Core::DObject
+
+   \brief 这个宏用于私有类中，为私有类定义 operator new 和 operator delete，释放的对象内存
+   缓存在当前线程的空闲链表中（每个线程最多缓存 64 个），再次创建对象时直接复用。适用于频繁创建
+   和销毁的短生命周期对象，例如每次打开文件都会创建的 DCapFSFileEngine。
+   \a Class 私有类的类名
+   \note 私有类的派生类大小不同，不会使用缓存。
+   \sa D_DECLARE_PUBLIC
+*/
+
 /*!
  \macro D_PRIVATE_SLOT(Func)
  \relates Dtk::Core::DObject
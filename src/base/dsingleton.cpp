@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dsingleton.h"
+
+#include <QMutex>
+#include <QVector>
+#include <algorithm>
+
+DCORE_BEGIN_NAMESPACE
+
+struct SingletonDestructor
+{
+    int order;
+    void (*destroy)();
+};
+
+struct SingletonTeardownList
+{
+    ~SingletonTeardownList()
+    {
+        run();
+    }
+
+    void run()
+    {
+        QVector<SingletonDestructor> list;
+        {
+            QMutexLocker locker(&mutex);
+            list.swap(destructors);
+        }
+
+        // the later created are destroyed first in the same order
+        std::reverse(list.begin(), list.end());
+        std::stable_sort(list.begin(), list.end(), [](const SingletonDestructor &a, const SingletonDestructor &b) {
+            return a.order < b.order;
+        });
+
+        for (const SingletonDestructor &destructor : std::as_const(list))
+            destructor.destroy();
+    }
+
+    QMutex mutex;
+    QVector<SingletonDestructor> destructors;
+};
+
+// it's destroyed at exit, the singletons not destroyed are destroyed then
+static SingletonTeardownList &teardownList()
+{
+    static SingletonTeardownList list;
+    return list;
+}
+
+void DSingletonTeardown::add(int order, void (*destroy)())
+{
+    QMutexLocker locker(&teardownList().mutex);
+    teardownList().destructors.append({order, destroy});
+}
+
+void DSingletonTeardown::teardown()
+{
+    teardownList().run();
+}
+
+DCORE_END_NAMESPACE
@@ -1,6 +1,9 @@
 set(dci_SRCS
   ${CMAKE_CURRENT_LIST_DIR}/../../include/dci/ddcifile.h
   ${CMAKE_CURRENT_LIST_DIR}/ddcifile.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/../../include/dci/ddcifilewriter.h
+  ${CMAKE_CURRENT_LIST_DIR}/ddcifilewriter.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/private/ddcifileformat_p.h
   ${CMAKE_CURRENT_LIST_DIR}/private/ddcifileengine_p.h
   ${CMAKE_CURRENT_LIST_DIR}/private/ddcifileengine.cpp
 )
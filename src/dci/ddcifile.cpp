@@ -4,9 +4,11 @@
 
 #include "ddcifile.h"
 #include "private/ddcifileengine_p.h"
+#include "private/ddcifileformat_p.h"
 
 #ifndef DTK_NO_PROJECT
 #include <DObjectPrivate>
+#include <DPerfCounters>
 #else
 #define D_D(class)
 #define D_DC(class)
@@ -19,23 +21,16 @@
 #include <QDir>
 #include <QBuffer>
 #include <QCollator>
+#include <QCache>
+#include <QMutex>
+#include <QSet>
 
-DCORE_BEGIN_NAMESPACE
-
-#define MAGIC "DCI"
-
-#define MAGIC_SIZE 4
-#define VERSION_SIZE 1
-#define FILE_COUNT_SIZE 3
-#define FILE_META_SIZE 72
+#include <algorithm>
+#include <limits>
 
-#define FILE_TYPE_SIZE 1
-#define FILE_NAME_SIZE 63
-#define FILE_DATA_SIZE 8
+#include <sys/stat.h>
 
-#define FILE_TYPE_FILE DDciFile::FileType::File
-#define FILE_TYPE_DIR DDciFile::FileType::Directory
-#define FILE_TYPE_SYMLINK DDciFile::FileType::Symlink
+DCORE_BEGIN_NAMESPACE
 
 #ifdef QT_DEBUG
 Q_LOGGING_CATEGORY(logDF, "dtk.dci.file")
@@ -63,8 +58,8 @@ public:
 
     void setErrorString(const QString &message);
 
-    void load(const QString &fileName);
-    void load(const QByteArray &data);
+    void load(const QString &fileName, DDciFile::LoadModes mode = DDciFile::ReadAll);
+    void load(const QByteArray &data, bool lazy = false);
 
     QString errorMessage;
     struct Node {
@@ -73,12 +68,56 @@ public:
 
         Node *parent = nullptr;
         QVector<Node*> children; // for directory
+        // 按名称查找子节点，与 children 同步修改
+        QHash<QString, Node*> childByName;
         QByteArray data; // for file
+        // 文件数据以 zstd 压缩，此时 data 为压缩后的数据，读取时解压到 uncompressedData 中
+        bool compressed = false;
+        mutable QByteArray uncompressedData;
+        // 延迟加载的目录，其子节点的数据在 rawData 中的位置，为 -1 时表示已加载
+        qint64 lazyOffset = -1;
+        qint64 lazySize = 0;
+        // name 的排序键，首次比较时生成，name 改变时需清除
+        mutable QScopedPointer<QCollatorSortKey> sortKey;
 
         ~Node() {
             qDeleteAll(children);
         }
 
+        Node *child(const QString &name) const {
+            return childByName.value(name);
+        }
+
+        // index 为 -1 时追加到末尾
+        void addChild(Node *node, int index = -1) {
+            node->parent = this;
+            if (index < 0)
+                children << node;
+            else
+                children.insert(index, node);
+            childByName.insert(node->name, node);
+        }
+
+        void takeChild(Node *node) {
+            children.removeOne(node);
+            if (childByName.value(node->name) == node)
+                childByName.remove(node->name);
+        }
+
+        bool isAncestorOf(const Node *node) const {
+            for (const Node *current = node->parent; current; current = current->parent) {
+                if (current == this)
+                    return true;
+            }
+            return false;
+        }
+
+        const QCollatorSortKey &nameSortKey() const {
+            if (!sortKey)
+                sortKey.reset(new QCollatorSortKey(nameCollator().sortKey(name)));
+            return *sortKey;
+        }
+
         QString path() const {
             QString p = name;
             Node *current = parent;
@@ -115,25 +154,69 @@ public:
         }
     };
 
+    using IndexList = DDciIndexList;
+    QByteArray fileData(const Node *node) const;
+    bool setFileData(Node *node, const QByteArray &data);
+    QByteArray metaDataForNode(const Node *node, qint64 dataSize) const;
     qint64 writeMetaDataForNode(QIODevice *device, Node *node, qint64 dataSize) const;
     qint64 writeDataForNode(QIODevice *device, Node *node) const;
     qint64 writeNode(QIODevice *device, Node *node) const;
+    qint64 layoutVersion2(const Node *node, qint64 pos, QHash<const Node *, qint64> *dataSizes) const;
+    bool writeNodeVersion2(DDciChecksumWriter *writer, const Node *node,
+                           const QHash<const Node *, qint64> &dataSizes, IndexList *index) const;
+    bool writeVersion2(QIODevice *device) const;
 
     Node *mkNode(const QString &filePath);
     void removeNode(Node *node);
     void copyNode(const Node *from, Node *to);
 
+    Node *readNode(Node *parent, const QByteArray &data, qint64 &offset, qint64 end, bool lazy);
     bool loadDirectory(Node *directory,
-                       const QByteArray &data, qint64 &begin, qint64 end,
-                       QHash<QString, Node *> &pathToNode);
-
-    // 按标准中规定的文件排序计算此 name 在这个列表中的位置
+                       const QByteArray &data, qint64 &begin, qint64 end, bool lazy = false);
+    bool loadIndex(const QByteArray &data, bool verifyChecksum, qint64 &treeEnd);
+    qint64 indexLookup(const QString &filePath) const;
+    Node *indexedNode(const QString &filePath) const;
+    void loadChildren(Node *directory) const;
+    void loadChildrenLocked(Node *directory) const;
+    bool verifyPendingChecksum() const;
+    void loadAll() const;
+    // 逐级按名称查找，load 为 true 时加载路径上延迟加载的目录
+    Node *walk(const QString &filePath, bool load) const;
+    Node *findNode(const QString &filePath) const { return walk(filePath, false); }
+    Node *node(const QString &filePath) const;
+    Node *nodeLocked(const QString &filePath) const;
+    // 所有节点的数量（不含根目录）及文件数据的大小
+    void treeSize(int *nodeCount, qint64 *dataSize) const;
+
+    // 按标准中规定的文件排序计算此 name 在这个列表中的位置，列表需已排序
+    static QCollator &nameCollator();
     static int getOrderedIndexOfNodeName(const decltype(Node::children) &list, const QString &name);
+    static void sortChildren(Node *directory);
+    // 批量写入时新节点追加到父目录末尾，结束时每个目录只排序一次
+    bool deferSorting = false;
+    QSet<Node *> unsortedDirectories;
 
     qint8 version = 0;
     QScopedPointer<Node> root;
-    QHash<QString, Node*> pathToNode;
     QByteArray rawData;
+    // 以 MapFile 方式加载时 rawData 引用此文件的只读映射
+    QScopedPointer<QFile> mappedFile;
+    // 只读的对象可在多个线程中使用，解压文件数据时需加锁
+    mutable QMutex uncompressMutex;
+    // 延迟加载节点时会修改节点树，需加锁
+    mutable QMutex loadMutex;
+
+    // 版本 2 的路径索引，仅延迟加载时使用，指向 rawData 中的数据
+    const char *indexEntries = nullptr;
+    const char *indexBuckets = nullptr;
+    const char *indexStrings = nullptr;
+    quint32 indexEntryCount = 0;
+    quint32 indexBucketCount = 0;
+    qint64 indexStringsSize = 0;
+    qint64 treeEnd = 0;
+    // 延迟加载时在首次查找节点时才校验数据
+    mutable bool checksumPending = false;
+    mutable bool checksumMismatched = false;
 };
 
 DDciFilePrivate::~DDciFilePrivate()
@@ -147,19 +230,32 @@ void DDciFilePrivate::setErrorString(const QString &message)
     errorMessage = message;
 }
 
-void DDciFilePrivate::load(const QString &fileName)
+void DDciFilePrivate::load(const QString &fileName, DDciFile::LoadModes mode)
 {
-    QFile file(fileName);
+    QScopedPointer<QFile> file(new QFile(fileName));
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        setErrorString(file.errorString());
+    if (!file->open(QIODevice::ReadOnly)) {
+        setErrorString(file->errorString());
         return;
     }
 
-    return load(file.readAll());
+    const bool lazy = mode.testFlag(DDciFile::LazyLoad);
+    if (mode.testFlag(DDciFile::MapFile)) {
+        const qint64 size = file->size();
+        // 映射失败时（如空文件、不支持 mmap 的文件系统）回退到读取全部数据
+        if (uchar *address = size > 0 ? file->map(0, size) : nullptr) {
+            load(QByteArray::fromRawData(reinterpret_cast<const char *>(address), size), lazy);
+            if (root)
+                mappedFile.swap(file);
+            return;
+        }
+        qCDebug(logDF, "Failed on map the \"%s\" file, fallback to read all", qPrintable(fileName));
+    }
+
+    return load(file->readAll(), lazy);
 }
 
-void DDciFilePrivate::load(const QByteArray &data)
+void DDciFilePrivate::load(const QByteArray &data, bool lazy)
 {
     // check magic
     if (!data.startsWith("DCI")) {
@@ -170,7 +266,7 @@ void DDciFilePrivate::load(const QByteArray &data)
     }
 
     qint8 version = data.at(MAGIC_SIZE);
-    if (version != 1) {
+    if (version < 1 || version > 3) {
         setErrorString(QString("Not supported version: %1").arg(version));
         return;
     }
@@ -191,46 +287,87 @@ void DDciFilePrivate::load(const QByteArray &data)
     root->type = FILE_TYPE_DIR;
     root->parent = nullptr;
 
-    QHash<QString, Node*> pathToNode;
+    // 解析节点时需根据版本计算数据的位置
+    this->version = version;
+    qint64 treeEnd = data.size() - 1;
+    // 延迟加载时不校验全部数据，避免读取整个文件
+    if (version >= 2 && !loadIndex(data, !lazy, treeEnd)) {
+        delete root;
+        return;
+    }
 
-    if (!loadDirectory(root, data, offset, data.size() - 1, pathToNode)
+    if (!loadDirectory(root, data, offset, treeEnd, lazy)
             || fileCount != root->children.count()) {
         delete root;
         return;
     }
 
-    this->version = version;
+    this->treeEnd = treeEnd;
+    checksumPending = lazy && version >= 2;
+    if (!lazy)
+        indexEntryCount = 0;
     this->root.reset(root);
-    this->pathToNode = pathToNode;
-    this->pathToNode["/"] = root;
     // Node 中保存的文件数据仅是此数据的引用，因此要确保此数据一直存在
     this->rawData = data;
 }
 
-qint64 DDciFilePrivate::writeMetaDataForNode(QIODevice *device, DDciFilePrivate::Node *node, qint64 dataSize) const
+// 解压后的文件数据，解压的结果会缓存在节点中
+QByteArray DDciFilePrivate::fileData(const Node *node) const
+{
+    if (!node->compressed)
+        return node->data;
+
+    QMutexLocker locker(&uncompressMutex);
+    if (node->uncompressedData.isNull() && !dciDecompress(node->data, &node->uncompressedData)) {
+        qCWarning(logDF, "Failed on uncompress the \"%s\" file", qPrintable(node->path()));
+        return QByteArray();
+    }
+
+    return node->uncompressedData;
+}
+
+bool DDciFilePrivate::setFileData(Node *node, const QByteArray &data)
+{
+    if (!node->compressed) {
+        node->data = data;
+        return true;
+    }
+
+    const QByteArray &compressedData = dciCompress(data);
+    if (compressedData.isNull()) {
+        setErrorString(QString("Failed on compress the \"%1\" file").arg(node->path()));
+        return false;
+    }
+
+    node->data = compressedData;
+    node->uncompressedData = data;
+    return true;
+}
+
+QByteArray DDciFilePrivate::metaDataForNode(const Node *node, qint64 dataSize) const
 {
-    qint64 size = 0;
-    device->putChar(static_cast<char>(node->type));
-    size += FILE_TYPE_SIZE;
+    QByteArray meta(FILE_META_SIZE, '\0');
+    const bool compressed = node->compressed && version >= 3;
+    meta[0] = static_cast<char>(node->type | (compressed ? FILE_FLAG_COMPRESSED : 0));
 
+    // 未使用的部分以 0 填充
     const QByteArray rawName = node->name.toUtf8().left(FILE_NAME_SIZE - 1);
-    size += device->write(rawName);
-    // 填充未使用的部分
-    size += device->write(QByteArray(FILE_NAME_SIZE - rawName.size(), '\0'));
+    memcpy(meta.data() + FILE_TYPE_SIZE, rawName.constData(), size_t(rawName.size()));
+    qToLittleEndian<qint64>(dataSize, meta.data() + FILE_TYPE_SIZE + FILE_NAME_SIZE);
 
-    char int64[FILE_DATA_SIZE];
-    qToLittleEndian<qint64>(dataSize, int64);
-    size += device->write(int64, FILE_DATA_SIZE);
-    Q_ASSERT(size == FILE_META_SIZE);
+    return meta;
+}
 
-    return size;
+qint64 DDciFilePrivate::writeMetaDataForNode(QIODevice *device, DDciFilePrivate::Node *node, qint64 dataSize) const
+{
+    return device->write(metaDataForNode(node, dataSize));
 }
 
 qint64 DDciFilePrivate::writeDataForNode(QIODevice *device, DDciFilePrivate::Node *node) const
 {
     if (node->type == FILE_TYPE_FILE
             ||  node->type == FILE_TYPE_SYMLINK) {
-        return device->write(node->data);
+        return device->write(node->compressed ? fileData(node) : node->data);
     } else if (node->type == FILE_TYPE_DIR) {
         qint64 dataSize = 0;
         for (Node *child : node->children) {
@@ -253,11 +390,79 @@ qint64 DDciFilePrivate::writeNode(QIODevice *device, DDciFilePrivate::Node *node
     return metaDataSize + dataSize;
 }
 
+// 计算数据从 pos 开始的节点的数据大小，版本 2 中对齐填充的大小取决于数据的位置
+qint64 DDciFilePrivate::layoutVersion2(const Node *node, qint64 pos, QHash<const Node *, qint64> *dataSizes) const
+{
+    qint64 dataSize = 0;
+    if (node->type == FILE_TYPE_FILE || node->type == FILE_TYPE_SYMLINK) {
+        // 低版本中不支持压缩，写入解压后的数据
+        const qint64 size = node->compressed && version < 3 ? fileData(node).size() : node->data.size();
+        dataSize = alignPaddingV2(pos) + size;
+    } else if (node->type == FILE_TYPE_DIR) {
+        for (const Node *child : node->children)
+            dataSize += FILE_META_SIZE + layoutVersion2(child, pos + dataSize + FILE_META_SIZE, dataSizes);
+    }
+
+    dataSizes->insert(node, dataSize);
+    return dataSize;
+}
+
+bool DDciFilePrivate::writeNodeVersion2(DDciChecksumWriter *writer, const Node *node,
+                                        const QHash<const Node *, qint64> &dataSizes, IndexList *index) const
+{
+    if (node != root.data()) {
+        index->append(qMakePair(node->path().toUtf8(), writer->pos()));
+        if (!writer->write(metaDataForNode(node, dataSizes.value(node))))
+            return false;
+    }
+
+    if (node->type == FILE_TYPE_FILE || node->type == FILE_TYPE_SYMLINK) {
+        return writer->write(QByteArray(alignPaddingV2(writer->pos()), '\0'))
+                && writer->write(node->compressed && version < 3 ? fileData(node) : node->data);
+    } else if (node->type == FILE_TYPE_DIR) {
+        for (const Node *child : node->children) {
+            if (!writeNodeVersion2(writer, child, dataSizes, index))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool DDciFilePrivate::writeVersion2(QIODevice *device) const
+{
+    // 节点的元数据位于其数据之前，因此先计算所有节点的数据大小，再按顺序写出并计算校验和
+    QHash<const Node *, qint64> dataSizes;
+    layoutVersion2(root.data(), MAGIC_SIZE + VERSION_SIZE + FILE_COUNT_SIZE, &dataSizes);
+
+    DDciChecksumWriter writer(device);
+    writer.write(QByteArrayLiteral("DCI\0"));
+    const char versionData = static_cast<char>(version);
+    writer.write(&versionData, VERSION_SIZE);
+    char fileCountData[sizeof(int)];
+    qToLittleEndian<int>(root->children.count(), fileCountData);
+    writer.write(fileCountData, FILE_COUNT_SIZE);
+
+    IndexList index;
+    if (!writeNodeVersion2(&writer, root.data(), dataSizes, &index))
+        return false;
+
+    const qint64 indexOffset = writer.pos();
+    char trailer[TRAILER_SIZE] = {};
+    qToLittleEndian<qint64>(indexOffset, trailer);
+    if (!writer.write(buildIndexV2(index)) || !writer.write(trailer, 8))
+        return false;
+
+    qToLittleEndian<quint32>(writer.checksum(), trailer + 8);
+    memcpy(trailer + 12, TRAILER_MAGIC, 4);
+    return device->write(trailer + 8, 8) == 8;
+}
+
 DDciFilePrivate::Node *DDciFilePrivate::mkNode(const QString &filePath)
 {
     qCDebug(logDF, "Request create a node");
 
-    if (pathToNode.contains(filePath)) {
+    if (findNode(filePath)) {
         setErrorString(QString("The \"%1\" is existed").arg(filePath));
         return nullptr;
     }
@@ -265,7 +470,7 @@ DDciFilePrivate::Node *DDciFilePrivate::mkNode(const QString &filePath)
     const QFileInfo info(filePath);
     qCDebug(logDF, "The parent directory is \"%s\"", qPrintable(info.path()));
 
-    if (Node *parentNode = pathToNode.value(info.path())) {
+    if (Node *parentNode = findNode(info.path())) {
         if (parentNode->type != FILE_TYPE_DIR) {
             setErrorString(QString("The \"%1\" is not a directory").arg(info.path()));
             return nullptr;
@@ -279,11 +484,13 @@ DDciFilePrivate::Node *DDciFilePrivate::mkNode(const QString &filePath)
 
         Node *newNode = new Node;
         newNode->name = info.fileName();
-        newNode->parent = parentNode;
 
-        const int index = getOrderedIndexOfNodeName(parentNode->children, newNode->name);
-        parentNode->children.insert(index, newNode);
-        pathToNode[newNode->path()] = newNode;
+        if (deferSorting) {
+            parentNode->addChild(newNode);
+            unsortedDirectories << parentNode;
+        } else {
+            parentNode->addChild(newNode, getOrderedIndexOfNodeName(parentNode->children, newNode->name));
+        }
 
         return newNode;
     } else {
@@ -296,16 +503,8 @@ void DDciFilePrivate::removeNode(DDciFilePrivate::Node *node)
 {
     Q_ASSERT(node != root.data());
 
-    node->parent->children.removeOne(node);
-    auto removedNode = pathToNode.take(node->path());
-    Q_ASSERT(removedNode == node);
-
-    for (Node *child : node->children) {
-        Q_ASSERT(child->parent == node);
-        auto removedNode = pathToNode.take(child->path());
-        Q_ASSERT(removedNode == child);
-    }
-
+    // 子节点中只保存名称，无需逐个更新
+    node->parent->takeChild(node);
     delete node;
 }
 
@@ -320,90 +519,455 @@ void DDciFilePrivate::copyNode(const DDciFilePrivate::Node *from, DDciFilePrivat
 
         t->type = f->type;
         t->data = f->data;
+        t->compressed = f->compressed;
+        t->uncompressedData = f->uncompressedData;
 
         for (const auto child : f->children) {
             if (child == to)
                 continue;
 
             Node *newChild = new Node;
-            newChild->parent = t;
             newChild->name = child->name;
-            pathToNode[newChild->path()] = newChild;
 
-            const int index = getOrderedIndexOfNodeName(t->children, newChild->name);
-            t->children.insert(index, newChild);
+            // t 是新节点，按 f 中已排序的顺序追加即可
+            t->addChild(newChild);
             copyPendingList << qMakePair(child, newChild);
         }
     }
 }
 
-bool DDciFilePrivate::loadDirectory(DDciFilePrivate::Node *directory,
-                                    const QByteArray &data, qint64 &offset, qint64 end,
-                                    QHash<QString, DDciFilePrivate::Node *> &pathToNode)
+DDciFilePrivate::Node *DDciFilePrivate::readNode(Node *parent, const QByteArray &data, qint64 &offset, qint64 end, bool lazy)
 {
-    // load files
-    while (offset < end) {
-        Node *node = new Node;
-
-        node->parent = directory;
-        node->type = data.at(offset);
-        offset += FILE_TYPE_SIZE;
-        // 计算文件名的长度
-        const int nameLength = data.indexOf('\0', offset) - offset;
-        if (nameLength <= 0 || nameLength >= FILE_NAME_SIZE) {
-            setErrorString(QString("Invalid file name, the data offset: %1").arg(offset));
-            delete node;
-            return false;
-        }
-        node->name = QString::fromUtf8(data.constData() + offset, nameLength);
-        offset += FILE_NAME_SIZE;
+    if (offset + FILE_META_SIZE > end + 1) {
+        setErrorString(QString("Invalid file meta data, the data offset: %1").arg(offset));
+        return nullptr;
+    }
 
-        const qint64 dataSize = qFromLittleEndian<qint64>(data.constData() + offset);
-        offset += FILE_DATA_SIZE;
+    Node *node = new Node;
+
+    node->parent = parent;
+    const quint8 rawType = static_cast<quint8>(data.at(offset));
+    node->type = static_cast<qint8>(rawType & FILE_TYPE_MASK);
+    node->compressed = rawType & FILE_FLAG_COMPRESSED;
+    offset += FILE_TYPE_SIZE;
+    // 计算文件名的长度
+    const int nameLength = data.indexOf('\0', offset) - offset;
+    if (nameLength <= 0 || nameLength >= FILE_NAME_SIZE) {
+        setErrorString(QString("Invalid file name, the data offset: %1").arg(offset));
+        delete node;
+        return nullptr;
+    }
+    node->name = QString::fromUtf8(data.constData() + offset, nameLength);
+    offset += FILE_NAME_SIZE;
 
-        // 无失败时调用 break
-        do {
-            if (node->type == FILE_TYPE_DIR) {
-                if (loadDirectory(node, data, offset, offset + dataSize - 1, pathToNode)) {
-                    break;
-                }
-            } else if (node->type == FILE_TYPE_FILE
-                       || node->type == FILE_TYPE_SYMLINK) {
-                // 跳过文件内容
-                node->data = QByteArray::fromRawData(data.constData() + offset, dataSize);
+    const qint64 dataSize = qFromLittleEndian<qint64>(data.constData() + offset);
+    offset += FILE_DATA_SIZE;
 
-                if (node->data.size() == dataSize) {
+    if (dataSize < 0 || offset + dataSize > end + 1) {
+        setErrorString(QString("Invalid data size of \"%1\"").arg(node->path()));
+        delete node;
+        return nullptr;
+    }
+
+    // 无失败时调用 break
+    do {
+        if (node->compressed && (version < 3 || node->type != FILE_TYPE_FILE)) {
+            setErrorString(QString("Invalid compressed flag of \"%1\"").arg(node->path()));
+        } else if (node->type == FILE_TYPE_DIR) {
+            if (lazy) {
+                // 仅记录子节点数据的位置，在首次访问时再解析
+                node->lazyOffset = offset;
+                node->lazySize = dataSize;
+                offset += dataSize;
+                break;
+            } else if (loadDirectory(node, data, offset, offset + dataSize - 1)) {
+                break;
+            }
+        } else if (node->type == FILE_TYPE_FILE
+                   || node->type == FILE_TYPE_SYMLINK) {
+            // 跳过文件内容，版本 2 中数据前有对齐填充
+            const qint64 padding = version >= 2 ? alignPaddingV2(offset) : 0;
+            if (padding <= dataSize) {
+                node->data = QByteArray::fromRawData(data.constData() + offset + padding, dataSize - padding);
+
+                if (node->data.size() == dataSize - padding) {
                     offset += dataSize;
                     break;
-                } else {
-                    setErrorString(QString("Invalid data size of \"%1\" file").arg(node->path()));
                 }
-            } else {
-                setErrorString(QString("Invalid file type: %1").arg(node->type));
             }
+            setErrorString(QString("Invalid data size of \"%1\" file").arg(node->path()));
+        } else {
+            setErrorString(QString("Invalid file type: %1").arg(node->type));
+        }
 
-            delete node;
+        delete node;
+        return nullptr;
+    } while (false);
+
+    return node;
+}
+
+bool DDciFilePrivate::loadDirectory(DDciFilePrivate::Node *directory,
+                                    const QByteArray &data, qint64 &offset, qint64 end, bool lazy)
+{
+    // load files
+    while (offset < end) {
+        Node *node = readNode(directory, data, offset, end, lazy);
+        if (!node)
             return false;
-        } while (false);
 
-        directory->children << node;
-        pathToNode[node->path()] = node;
+        // 已通过索引加载的节点
+        if (Node *existing = lazy ? directory->child(node->name) : nullptr) {
+            delete node;
+            node = existing;
+        }
+
+        directory->addChild(node);
     }
 
     return true;
 }
 
+bool DDciFilePrivate::loadIndex(const QByteArray &data, bool verifyChecksum, qint64 &treeEnd)
+{
+    const qint64 size = data.size();
+    if (size < MAGIC_SIZE + VERSION_SIZE + FILE_COUNT_SIZE + INDEX_HEADER_SIZE + TRAILER_SIZE
+            || memcmp(data.constData() + size - 4, TRAILER_MAGIC, 4) != 0) {
+        setErrorString("Invalid trailer of the version 2 file");
+        return false;
+    }
+
+    const char *trailer = data.constData() + size - TRAILER_SIZE;
+    const qint64 indexOffset = qFromLittleEndian<qint64>(trailer);
+    if (verifyChecksum && dciChecksum(data.constData(), size - 8) != qFromLittleEndian<quint32>(trailer + 8)) {
+        setErrorString("Checksum mismatch, the file is corrupted");
+        return false;
+    }
+
+    if (indexOffset < MAGIC_SIZE + VERSION_SIZE + FILE_COUNT_SIZE || indexOffset > size - TRAILER_SIZE - INDEX_HEADER_SIZE
+            || memcmp(data.constData() + indexOffset, INDEX_MAGIC, 4) != 0) {
+        setErrorString(QString("Invalid index offset: %1").arg(indexOffset));
+        return false;
+    }
+
+    const quint32 entryCount = qFromLittleEndian<quint32>(data.constData() + indexOffset + 4);
+    const quint32 bucketCount = qFromLittleEndian<quint32>(data.constData() + indexOffset + 8);
+    const qint64 entriesOffset = indexOffset + INDEX_HEADER_SIZE;
+    const qint64 bucketsOffset = entriesOffset + qint64(entryCount) * INDEX_ENTRY_SIZE;
+    const qint64 stringsOffset = bucketsOffset + qint64(bucketCount) * 4;
+    if (bucketCount == 0 || (bucketCount & (bucketCount - 1)) != 0 || bucketCount < entryCount
+            || stringsOffset > size - TRAILER_SIZE) {
+        setErrorString("Invalid index of the version 2 file");
+        return false;
+    }
+
+    indexEntries = data.constData() + entriesOffset;
+    indexBuckets = data.constData() + bucketsOffset;
+    indexStrings = data.constData() + stringsOffset;
+    indexEntryCount = entryCount;
+    indexBucketCount = bucketCount;
+    indexStringsSize = size - TRAILER_SIZE - stringsOffset;
+    treeEnd = indexOffset - 1;
+    return true;
+}
+
+qint64 DDciFilePrivate::indexLookup(const QString &filePath) const
+{
+    const QByteArray &path = filePath.toUtf8();
+    const quint32 hash = pathHash(path);
+    for (quint32 i = 0; i < indexBucketCount; ++i) {
+        const quint32 bucket = (hash + i) & (indexBucketCount - 1);
+        const quint32 entryIndex = qFromLittleEndian<quint32>(indexBuckets + bucket * 4);
+        if (entryIndex >= indexEntryCount)
+            return -1;
+
+        const char *entry = indexEntries + qint64(entryIndex) * INDEX_ENTRY_SIZE;
+        const quint32 pathOffset = qFromLittleEndian<quint32>(entry + 8);
+        const quint32 pathSize = qFromLittleEndian<quint32>(entry + 12);
+        if (pathSize == static_cast<quint32>(path.size()) && qint64(pathOffset) + pathSize <= indexStringsSize
+                && memcmp(indexStrings + pathOffset, path.constData(), pathSize) == 0)
+            return qFromLittleEndian<qint64>(entry);
+    }
+
+    return -1;
+}
+
+DDciFilePrivate::Node *DDciFilePrivate::indexedNode(const QString &filePath) const
+{
+    qint64 offset = indexLookup(filePath);
+    if (offset < 0)
+        return nullptr;
+
+    const int slash = filePath.lastIndexOf(QLatin1Char('/'));
+    Node *parent = nodeLocked(slash > 0 ? filePath.left(slash) : QStringLiteral("/"));
+    if (!parent || parent->type != FILE_TYPE_DIR)
+        return nullptr;
+    // 父目录已完整加载时不会再通过索引查找
+    if (Node *node = parent->child(filePath.mid(slash + 1)))
+        return node;
+    if (parent->lazyOffset < 0)
+        return nullptr;
+
+    auto self = const_cast<DDciFilePrivate *>(this);
+    Node *node = self->readNode(parent, rawData, offset, treeEnd, true);
+    if (!node)
+        return nullptr;
+    if (node->path() != filePath) {
+        self->setErrorString(QString("The index of \"%1\" is not matched").arg(filePath));
+        delete node;
+        return nullptr;
+    }
+
+    parent->addChild(node);
+    return node;
+}
+
+void DDciFilePrivate::loadChildren(Node *directory) const
+{
+    QMutexLocker locker(&loadMutex);
+    loadChildrenLocked(directory);
+}
+
+void DDciFilePrivate::loadChildrenLocked(Node *directory) const
+{
+    if (directory->lazyOffset < 0 || !verifyPendingChecksum())
+        return;
+
+    auto self = const_cast<DDciFilePrivate *>(this);
+    qint64 offset = directory->lazyOffset;
+    directory->lazyOffset = -1;
+    // 重新按文件中的顺序排列已通过索引加载的子节点，childByName 中仍保留这些节点
+    const auto indexedChildren = directory->children;
+    directory->children.clear();
+    // 数据在加载文件时已校验过大小，此处失败时保留已解析的子节点
+    if (!self->loadDirectory(directory, rawData, offset, offset + directory->lazySize - 1, true)) {
+        qCWarning(logDF, "Failed on load the \"%s\" directory", qPrintable(directory->path()));
+        for (Node *child : indexedChildren) {
+            if (!directory->children.contains(child))
+                directory->children << child;
+        }
+    }
+}
+
+// 延迟加载时未校验数据，首次使用节点前校验一次，数据损坏时不再加载任何节点
+bool DDciFilePrivate::verifyPendingChecksum() const
+{
+    if (!checksumPending)
+        return !checksumMismatched;
+
+    checksumPending = false;
+    const qint64 size = rawData.size();
+    if (dciChecksum(rawData.constData(), size - 8) != qFromLittleEndian<quint32>(rawData.constData() + size - TRAILER_SIZE + 8)) {
+        checksumMismatched = true;
+        const_cast<DDciFilePrivate *>(this)->setErrorString("Checksum mismatch, the file is corrupted");
+        qCWarning(logDF, "Checksum mismatch, the file is corrupted");
+    }
+
+    return !checksumMismatched;
+}
+
+// 修改文件或写出全部数据前需确保所有节点均已加载
+void DDciFilePrivate::loadAll() const
+{
+    if (!root)
+        return;
+
+    QMutexLocker locker(&loadMutex);
+    QList<Node *> pendingList{root.data()};
+    while (!pendingList.isEmpty()) {
+        Node *directory = pendingList.takeLast();
+        loadChildrenLocked(directory);
+        for (Node *child : std::as_const(directory->children)) {
+            if (child->type == FILE_TYPE_DIR)
+                pendingList << child;
+        }
+    }
+
+    // 所有节点均已加载，后续的修改会使索引失效
+    const_cast<DDciFilePrivate *>(this)->indexEntryCount = 0;
+}
+
+DDciFilePrivate::Node *DDciFilePrivate::walk(const QString &filePath, bool load) const
+{
+    if (!root || !filePath.startsWith(QLatin1Char('/')))
+        return nullptr;
+
+    Node *current = root.data();
+    if (filePath.size() == 1)
+        return current;
+
+    for (int begin = 1; ; ) {
+        int end = filePath.indexOf(QLatin1Char('/'), begin);
+        if (end < 0)
+            end = filePath.size();
+        // 不接受空的路径片段，如 "//" 或末尾的 "/"
+        if (end == begin || current->type != FILE_TYPE_DIR)
+            return nullptr;
+
+        if (load)
+            loadChildrenLocked(current);
+        current = current->child(filePath.mid(begin, end - begin));
+        if (!current || end == filePath.size())
+            return current;
+        begin = end + 1;
+    }
+}
+
+DDciFilePrivate::Node *DDciFilePrivate::node(const QString &filePath) const
+{
+    QMutexLocker locker(&loadMutex);
+    return nodeLocked(filePath);
+}
+
+DDciFilePrivate::Node *DDciFilePrivate::nodeLocked(const QString &filePath) const
+{
+    if (!verifyPendingChecksum())
+        return nullptr;
+
+    if (indexEntryCount > 0) {
+        if (Node *node = findNode(filePath))
+            return node;
+        return filePath.startsWith(QLatin1Char('/')) ? indexedNode(filePath) : nullptr;
+    }
+
+    // 逐级加载父目录，仅解析路径上的目录
+    return walk(filePath, true);
+}
+
+void DDciFilePrivate::treeSize(int *nodeCount, qint64 *dataSize) const
+{
+    *nodeCount = 0;
+    *dataSize = 0;
+    QList<const Node *> pendingList{root.data()};
+    while (!pendingList.isEmpty()) {
+        const Node *directory = pendingList.takeLast();
+        *nodeCount += directory->children.count();
+        for (const Node *child : directory->children) {
+            if (child->type == FILE_TYPE_DIR)
+                pendingList << child;
+            else
+                *dataSize += child->data.size();
+        }
+    }
+}
+
+QCollator &DDciFilePrivate::nameCollator()
+{
+    // QCollator 的构造开销较大且不能在多个线程中同时使用
+    thread_local QCollator collator = [] {
+        QCollator collator(QLocale::English);
+        collator.setNumericMode(true);
+        return collator;
+    }();
+
+    return collator;
+}
+
 int DDciFilePrivate::getOrderedIndexOfNodeName(const decltype(Node::children) &list, const QString &name)
 {
-    QCollator collator(QLocale::English);
-    collator.setNumericMode(true);
-    for (int i = 0; i < list.count(); ++i) {
-        const Node *node = list.at(i);
-        if (collator.compare(name, node->name) < 0)
-            return i;
+    const QCollatorSortKey key = nameCollator().sortKey(name);
+    // 位于所有与之相等的节点之后
+    auto it = std::upper_bound(list.cbegin(), list.cend(), key, [](const QCollatorSortKey &key, const Node *node) {
+        return key.compare(node->nameSortKey()) < 0;
+    });
+
+    return int(it - list.cbegin());
+}
+
+void DDciFilePrivate::sortChildren(Node *directory)
+{
+    std::stable_sort(directory->children.begin(), directory->children.end(), [](const Node *n1, const Node *n2) {
+        return n1->nameSortKey().compare(n2->nameSortKey()) < 0;
+    });
+}
+
+// 缓存已解析的 dci 文件，以文件数据的大小作为开销
+class DDciFileCache
+{
+public:
+    static constexpr int DefaultLimit = 32 * 1024 * 1024;
+
+    QMutex mutex;
+    QCache<QByteArray, QSharedPointer<const DDciFile>> cache{DefaultLimit};
+};
+Q_GLOBAL_STATIC(DDciFileCache, globalDciFileCache)
+
+#ifndef DTK_NO_PROJECT
+static DPerfCounter dciCacheHits("dci.cache_hits");
+static DPerfCounter dciCacheMisses("dci.cache_misses");
+#define D_DCI_COUNT(counter) counter.add()
+#else
+#define D_DCI_COUNT(counter)
+#endif
+
+QSharedPointer<const DDciFile> DDciFile::shared(const QString &fileName, LoadModes mode)
+{
+    // 共享的对象可在多个线程中读取，因此总是完整地解析
+    mode &= ~LoadModes(LazyLoad);
+
+    const QString &canonicalPath = QFileInfo(fileName).canonicalFilePath();
+    struct stat info;
+    if (canonicalPath.isEmpty() || ::stat(QFile::encodeName(canonicalPath).constData(), &info) != 0)
+        return QSharedPointer<const DDciFile>(new DDciFile(fileName, mode));
+
+    // 文件被替换或修改后其 inode 或修改时间会变化，旧的缓存不会再被命中
+    const QByteArray key = QFile::encodeName(canonicalPath) + '\0'
+            + QByteArray::number(static_cast<quint64>(info.st_dev)) + ':'
+            + QByteArray::number(static_cast<quint64>(info.st_ino)) + ':'
+            + QByteArray::number(static_cast<qint64>(info.st_mtim.tv_sec)) + '.'
+            + QByteArray::number(static_cast<qint64>(info.st_mtim.tv_nsec)) + ':'
+            + QByteArray::number(static_cast<qint64>(info.st_size)) + ':'
+            + QByteArray::number(static_cast<int>(mode));
+
+    auto cache = globalDciFileCache();
+    {
+        QMutexLocker locker(&cache->mutex);
+        if (auto file = cache->cache.object(key)) {
+            D_DCI_COUNT(dciCacheHits);
+            return *file;
+        }
+    }
+    D_DCI_COUNT(dciCacheMisses);
+
+    QSharedPointer<const DDciFile> file(new DDciFile(canonicalPath, mode));
+    if (file->isValid()) {
+        const qint64 cost = static_cast<qint64>(info.st_size);
+        QMutexLocker locker(&cache->mutex);
+        // 超出缓存上限的文件不会被缓存
+        if (cost <= cache->cache.maxCost())
+            cache->cache.insert(key, new QSharedPointer<const DDciFile>(file), static_cast<int>(cost));
     }
 
-    return list.count();
+    return file;
+}
+
+void DDciFile::setSharedCacheLimit(qint64 bytes)
+{
+    auto cache = globalDciFileCache();
+    QMutexLocker locker(&cache->mutex);
+    cache->cache.setMaxCost(static_cast<int>(qBound<qint64>(0, bytes, std::numeric_limits<int>::max())));
+}
+
+qint64 DDciFile::sharedCacheLimit()
+{
+    auto cache = globalDciFileCache();
+    QMutexLocker locker(&cache->mutex);
+    return cache->cache.maxCost();
+}
+
+void dropSharedDciFile(const QString &fileName)
+{
+    const QString &canonicalPath = QFileInfo(fileName).canonicalFilePath();
+    if (canonicalPath.isEmpty())
+        return;
+
+    const QByteArray prefix = QFile::encodeName(canonicalPath) + '\0';
+    auto cache = globalDciFileCache();
+    QMutexLocker locker(&cache->mutex);
+    for (const QByteArray &key : cache->cache.keys()) {
+        if (key.startsWith(prefix))
+            cache->cache.remove(key);
+    }
 }
 
 void DDciFile::registerFileEngine()
@@ -427,6 +991,12 @@ DDciFile::DDciFile(const QString &fileName)
     d_func()->load(fileName);
 }
 
+DDciFile::DDciFile(const QString &fileName, LoadModes mode)
+    : DObject(*new DDciFilePrivate(this))
+{
+    d_func()->load(fileName, mode);
+}
+
 DDciFile::DDciFile(const QByteArray &data)
     : DObject(*new DDciFilePrivate(this))
 {
@@ -445,6 +1015,12 @@ DDciFile::DDciFile(const QString &fileName)
     d->load(fileName);
 }
 
+DDciFile::DDciFile(const QString &fileName, LoadModes mode)
+    : d(new DDciFilePrivate(this))
+{
+    d->load(fileName, mode);
+}
+
 DDciFile::DDciFile(const QByteArray &data)
     : d(new DDciFilePrivate(this))
 {
@@ -487,6 +1063,10 @@ bool DDciFile::writeToDevice(QIODevice *device) const
 {
     Q_ASSERT(isValid());
     D_DC(DDciFile);
+    d->loadAll();
+
+    if (d->version >= 2)
+        return d->writeVersion2(device);
 
     // magic
     device->write(QByteArrayLiteral("DCI\0"));
@@ -498,8 +1078,10 @@ bool DDciFile::writeToDevice(QIODevice *device) const
     device->write(fileCountData, FILE_COUNT_SIZE);
     d->writeDataForNode(device, d->root.data());
 
-    return device->size() >= metadataSizeV1()
-            + (d->pathToNode.count() - 1) * FILE_META_SIZE;
+    int nodeCount = 0;
+    qint64 dataSize = 0;
+    d->treeSize(&nodeCount, &dataSize);
+    return device->size() >= metadataSizeV1() + nodeCount * FILE_META_SIZE;
 }
 
 QByteArray DDciFile::toData() const
@@ -508,18 +1090,14 @@ QByteArray DDciFile::toData() const
         return QByteArray();
 
     D_DC(DDciFile);
+    d->loadAll();
 
+    int nodeCount = 0;
     qint64 allFilesContentSize = 0;
-    for (auto node : d->pathToNode) {
-        if (node->type == FILE_TYPE_FILE
-                || node->type == FILE_TYPE_SYMLINK)
-            allFilesContentSize += node->data.size();
-    }
+    d->treeSize(&nodeCount, &allFilesContentSize);
 
     QByteArray data;
-    // -1 是排除根目录
-    data.resize(metadataSizeV1() + (d->pathToNode.count() - 1) * FILE_META_SIZE
-                 + allFilesContentSize);
+    data.resize(metadataSizeV1() + nodeCount * FILE_META_SIZE + allFilesContentSize);
     QBuffer buffer(&data);
 
     if (!buffer.open(QIODevice::WriteOnly) || !writeToDevice(&buffer))
@@ -528,6 +1106,22 @@ QByteArray DDciFile::toData() const
     return data;
 }
 
+int DDciFile::version() const
+{
+    D_DC(DDciFile);
+    return d->version;
+}
+
+bool DDciFile::setVersion(int version)
+{
+    if (!isValid() || version < 1 || version > 3)
+        return false;
+
+    D_D(DDciFile);
+    d->version = static_cast<qint8>(version);
+    return true;
+}
+
 constexpr int DDciFile::metadataSizeV1()
 {
     return MAGIC_SIZE + VERSION_SIZE + FILE_COUNT_SIZE;
@@ -540,7 +1134,7 @@ QStringList DDciFile::list(const QString &dir, bool onlyFileName) const
 
     D_DC(DDciFile);
 
-    auto dirNode = d->pathToNode.value(dir);
+    auto dirNode = d->node(dir);
     if (!dirNode) {
         qCDebug(logDF, "The \"%s\" is not exists", qPrintable(dir));
         return {};
@@ -551,6 +1145,7 @@ QStringList DDciFile::list(const QString &dir, bool onlyFileName) const
         return {};
     }
 
+    d->loadChildren(dirNode);
     QStringList children;
     for (auto child : dirNode->children) {
         children << (onlyFileName ? child->name : QDir(dir).filePath(child->name));
@@ -566,21 +1161,44 @@ int DDciFile::childrenCount(const QString &dir) const
 
     D_DC(DDciFile);
 
-    auto dirNode = d->pathToNode.value(dir);
+    auto dirNode = d->node(dir);
     if (!dirNode) {
         return 0;
     }
 
+    d->loadChildren(dirNode);
     return dirNode->children.count();
 }
 
+QVector<DDciFile::FileType> DDciFile::childrenTypes(const QString &dir) const
+{
+    if (!isValid())
+        return {};
+
+    D_DC(DDciFile);
+
+    auto dirNode = d->node(dir);
+    if (!dirNode || dirNode->type != FILE_TYPE_DIR) {
+        return {};
+    }
+
+    d->loadChildren(dirNode);
+    QVector<FileType> types;
+    types.reserve(dirNode->children.count());
+    for (auto child : dirNode->children) {
+        types << static_cast<FileType>(child->type);
+    }
+
+    return types;
+}
+
 bool DDciFile::exists(const QString &filePath) const
 {
     if (!isValid())
         return false;
 
     D_DC(DDciFile);
-    return d->pathToNode.contains(filePath);
+    return d->node(filePath) != nullptr;
 }
 
 DDciFile::FileType DDciFile::type(const QString &filePath) const
@@ -590,7 +1208,7 @@ DDciFile::FileType DDciFile::type(const QString &filePath) const
 
     D_DC(DDciFile);
 
-    auto node = d->pathToNode.value(filePath);
+    auto node = d->node(filePath);
     if (!node) {
         qCDebug(logDF, "The \"%s\" is not exists", qPrintable(filePath));
         return DDciFile::UnknowFile;
@@ -606,7 +1224,7 @@ QByteArray DDciFile::dataRef(const QString &filePath) const
 
     D_DC(DDciFile);
 
-    auto node = d->pathToNode.value(filePath);
+    auto node = d->node(filePath);
     if (!node) {
         qCDebug(logDF, "The \"%s\" is not exists", qPrintable(filePath));
         return QByteArray();
@@ -616,7 +1234,17 @@ QByteArray DDciFile::dataRef(const QString &filePath) const
         return dataRef(node->linkPath());
     }
 
-    return node->data;
+    return d->fileData(node);
+}
+
+bool DDciFile::isCompressed(const QString &filePath) const
+{
+    if (!isValid())
+        return false;
+
+    D_DC(DDciFile);
+    auto node = d->node(filePath);
+    return node && node->compressed;
 }
 
 QString DDciFile::name(const QString &filePath) const
@@ -625,7 +1253,7 @@ QString DDciFile::name(const QString &filePath) const
         return QString();
 
     D_DC(DDciFile);
-    if (auto node = d->pathToNode.value(filePath)) {
+    if (auto node = d->node(filePath)) {
         return node->name;
     }
 
@@ -638,7 +1266,7 @@ QString DDciFile::symlinkTarget(const QString &filePath, bool originData) const
         return QString();
 
     D_DC(DDciFile);
-    if (auto node = d->pathToNode.value(filePath)) {
+    if (auto node = d->node(filePath)) {
         if (node->type != FILE_TYPE_SYMLINK)
             return QString();
 
@@ -647,7 +1275,7 @@ QString DDciFile::symlinkTarget(const QString &filePath, bool originData) const
         }
 
         const QString &linkPath = node->linkPath();
-        const auto targetNode = d->pathToNode.value(linkPath);
+        const auto targetNode = d->node(linkPath);
 
         // 链接的目标只能是“不存在的路径”、“文件”、“链接”，不可是目录
         if (!targetNode || targetNode->type == FILE_TYPE_FILE
@@ -662,6 +1290,7 @@ bool DDciFile::mkdir(const QString &filePath)
 {
     Q_ASSERT(isValid());
     D_D(DDciFile);
+    d->loadAll();
 
     qCDebug(logDF, "Request create the \"%s\" directory", qPrintable(filePath));
     auto node = d->mkNode(filePath);
@@ -675,16 +1304,17 @@ bool DDciFile::writeFile(const QString &filePath, const QByteArray &data, bool o
 {
     Q_ASSERT(isValid());
     D_D(DDciFile);
+    d->loadAll();
 
     qCDebug(logDF, "Request create the \"%s\" file", qPrintable(filePath));
     // 先删除旧的数据
-    if (auto node = d->pathToNode.value(filePath)) {
+    if (auto node = d->findNode(filePath)) {
         if (override) {
             if (node->type == FILE_TYPE_SYMLINK) {
                 const QString &linkPath = node->linkPath();
                 qCDebug(logDF(), "Follow the symlink to \"%s\"", qPrintable(linkPath));
 
-                if (!d->pathToNode.contains(linkPath)) {
+                if (!d->findNode(linkPath)) {
                     qCDebug(logDF(), "Can't write to a symlink target file if it is not existed");
                     return false;
                 }
@@ -698,8 +1328,7 @@ bool DDciFile::writeFile(const QString &filePath, const QByteArray &data, bool o
                 return false;
             }
 
-            node->data = data;
-            return true;
+            return d->setFileData(node, data);
         } else {
             d->setErrorString("No the \"override\" flag and the file is existed, can't write");
             return false;
@@ -715,16 +1344,72 @@ bool DDciFile::writeFile(const QString &filePath, const QByteArray &data, bool o
     return true;
 }
 
+// 新文件先追加到其所在目录，全部写入后每个目录只排序一次
+bool DDciFile::writeFiles(const QVector<QPair<QString, QByteArray>> &files, bool override)
+{
+    Q_ASSERT(isValid());
+    D_D(DDciFile);
+    d->loadAll();
+
+    d->deferSorting = true;
+    bool ok = true;
+    for (const auto &file : files) {
+        if (!writeFile(file.first, file.second, override)) {
+            ok = false;
+            break;
+        }
+    }
+    d->deferSorting = false;
+
+    for (auto directory : std::as_const(d->unsortedDirectories))
+        d->sortChildren(directory);
+    d->unsortedDirectories.clear();
+
+    return ok;
+}
+
+bool DDciFile::setCompressed(const QString &filePath, bool compressed)
+{
+    Q_ASSERT(isValid());
+    D_D(DDciFile);
+    d->loadAll();
+
+    auto node = d->findNode(filePath);
+    if (!node || node->type != FILE_TYPE_FILE) {
+        d->setErrorString(QString("The \"%1\" is not a file").arg(filePath));
+        return false;
+    }
+
+    if (node->compressed == compressed)
+        return true;
+
+    const QByteArray &data = d->fileData(node);
+    if (node->compressed && data.isNull()) {
+        d->setErrorString(QString("Failed on uncompress the \"%1\" file").arg(filePath));
+        return false;
+    }
+
+    node->compressed = compressed;
+    node->uncompressedData.clear();
+    if (!d->setFileData(node, data)) {
+        node->compressed = !compressed;
+        return false;
+    }
+
+    return true;
+}
+
 bool DDciFile::remove(const QString &filePath)
 {
     Q_ASSERT(isValid());
     D_D(DDciFile);
+    d->loadAll();
 
-    if (auto node = d->pathToNode.value(filePath)) {
+    if (auto node = d->findNode(filePath)) {
         if (node == d->root.data()) {
-            for (auto child : d->root->children)
-                d->removeNode(child);
+            qDeleteAll(d->root->children);
             d->root->children.clear();
+            d->root->childByName.clear();
         } else {
             d->removeNode(node);
         }
@@ -739,6 +1424,7 @@ bool DDciFile::rename(const QString &filePath, const QString &newFilePath, bool
 {
     Q_ASSERT(isValid());
     D_D(DDciFile);
+    d->loadAll();
 
     qCDebug(logDF, "Rename from \"%s\" to \"%s\"", qPrintable(filePath), qPrintable(newFilePath));
     if (filePath == newFilePath)
@@ -749,53 +1435,52 @@ bool DDciFile::rename(const QString &filePath, const QString &newFilePath, bool
         return false;
     }
 
-    if (!override && d->pathToNode.contains(newFilePath)) {
-        d->setErrorString("The target file is existed");
+    auto node = d->findNode(filePath);
+    if (!node || node == d->root.data()) {
+        d->setErrorString("The file is not exists");
         return false;
     }
-    auto overrideNode = override ? d->pathToNode.take(newFilePath) : nullptr;
 
-    if (auto node = d->pathToNode.take(filePath)) {
-        QFileInfo info(newFilePath);
-        if (auto parent = d->pathToNode.value(info.absolutePath())) {
-            node->name = info.fileName();
+    QFileInfo info(newFilePath);
+    auto parent = d->findNode(info.absolutePath());
+    if (!parent || parent->type != FILE_TYPE_DIR) {
+        d->setErrorString(QString("The \"%1\" directory is not exists").arg(info.absolutePath()));
+        return false;
+    }
+    if (node == parent || node->isAncestorOf(parent)) {
+        d->setErrorString(QString("Can't move the \"%1\" into itself").arg(filePath));
+        return false;
+    }
 
-            // 从旧节点删除添加到新的节点
-            if (node->parent != parent) {
-                bool ok = node->parent->children.removeOne(node);
-                Q_ASSERT(ok);
-                const int index = d->getOrderedIndexOfNodeName(parent->children, node->name);
-                parent->children.insert(index, node);
-                node->parent = parent;
-            }
+    auto overrideNode = parent->child(info.fileName());
+    if (overrideNode == node)
+        return false;
+    if (overrideNode && (!override || overrideNode->isAncestorOf(node))) {
+        d->setErrorString("The target file is existed");
+        return false;
+    }
 
-            d->pathToNode[info.absoluteFilePath()] = node;
-            Q_ASSERT(node->path() == info.absoluteFilePath());
+    // 子节点中只保存名称，移动目录时无需更新其中的节点
+    node->parent->takeChild(node);
+    if (overrideNode)
+        d->removeNode(overrideNode);
 
-            // 删除被覆盖的节点
-            if (overrideNode) {
-                Q_ASSERT(overrideNode->parent == parent);
-                overrideNode->parent->children.removeOne(overrideNode);
-                delete overrideNode;
-            }
+    node->name = info.fileName();
+    node->sortKey.reset();
+    // 在同一目录中也需按新的名称重新排序
+    parent->addChild(node, d->getOrderedIndexOfNodeName(parent->children, node->name));
+    Q_ASSERT(node->path() == info.absoluteFilePath());
 
-            return true;
-        } else {
-            d->setErrorString(QString("The \"%1\" directory is not exists").arg(info.absolutePath()));
-            return false;
-        }
-    } else {
-        d->setErrorString("The file is not exists");
-        return false;
-    }
+    return true;
 }
 
 bool DDciFile::copy(const QString &from, const QString &to)
 {
     Q_ASSERT(isValid());
     D_D(DDciFile);
+    d->loadAll();
 
-    const auto fromNode = d->pathToNode.value(from);
+    const auto fromNode = d->findNode(from);
     if (!fromNode) {
         d->setErrorString(QString("The \"%1\" is not exists").arg(from));
         return false;
@@ -814,6 +1499,7 @@ bool DDciFile::link(const QString &source, const QString &to)
 {
     Q_ASSERT(isValid());
     D_D(DDciFile);
+    d->loadAll();
 
     if (source == to || source.isEmpty())
         return false;
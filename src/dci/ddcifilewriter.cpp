@@ -0,0 +1,402 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "ddcifilewriter.h"
+#include "ddcifile.h"
+#include "private/ddcifileformat_p.h"
+
+#ifndef DTK_NO_PROJECT
+#include <DObjectPrivate>
+#else
+#define D_D(class)
+#define D_DC(class)
+#endif
+#include <QCollator>
+#include <QIODevice>
+
+DCORE_BEGIN_NAMESPACE
+
+// 复制文件数据时每次读取的大小
+#define COPY_BUFFER_SIZE (64 * 1024)
+
+class DDciFileWriterPrivate
+#ifndef DTK_NO_PROJECT
+    : public DObjectPrivate
+#endif
+{
+public:
+    DDciFileWriterPrivate(DDciFileWriter *qq)
+#ifndef DTK_NO_PROJECT
+        : DObjectPrivate(qq)
+    {
+#else
+    {
+    Q_UNUSED(qq)
+#endif
+        collator.setNumericMode(true);
+    }
+
+    void setErrorString(const QString &message);
+
+    bool checkWritable();
+    bool beginNode(qint8 type, const QString &name, qint64 dataSize);
+    bool patchDataSize(qint64 metaPos, qint64 dataSize);
+    bool writePadding();
+    bool finishVersion2();
+
+    struct Directory {
+        qint64 metaPos = -1;
+        QString path;
+        QString lastName;
+        int childCount = 0;
+    };
+
+    QIODevice *device = nullptr;
+    qint8 version = 1;
+    qint64 origin = 0;
+    bool finished = false;
+    QString errorMessage;
+    QVector<Directory> directories;
+    DDciIndexList index;
+    QCollator collator{QLocale::English};
+};
+
+void DDciFileWriterPrivate::setErrorString(const QString &message)
+{
+    errorMessage = message;
+}
+
+bool DDciFileWriterPrivate::checkWritable()
+{
+    if (!device) {
+        setErrorString("The device is invalid");
+        return false;
+    }
+
+    if (finished) {
+        setErrorString("The file is finished");
+        return false;
+    }
+
+    return errorMessage.isEmpty();
+}
+
+bool DDciFileWriterPrivate::beginNode(qint8 type, const QString &name, qint64 dataSize)
+{
+    if (!checkWritable())
+        return false;
+
+    const QByteArray &rawName = name.toUtf8();
+    if (rawName.isEmpty() || name.contains(QLatin1Char('/'))) {
+        setErrorString(QString("Invalid file name: \"%1\"").arg(name));
+        return false;
+    }
+    if (rawName.size() > FILE_NAME_SIZE - 1) {
+        setErrorString(QString("The file name size must less then %1 bytes").arg(FILE_NAME_SIZE));
+        return false;
+    }
+
+    // 按标准中规定的文件排序写入，与 DDciFile 中的顺序一致
+    Directory &parent = directories.last();
+    if (parent.childCount > 0 && collator.compare(name, parent.lastName) <= 0) {
+        setErrorString(QString("The \"%1\" must be written after \"%2\"").arg(name, parent.lastName));
+        return false;
+    }
+    parent.lastName = name;
+    ++parent.childCount;
+
+    const qint64 metaPos = device->pos();
+    index.append(qMakePair((parent.path + QLatin1Char('/') + name).toUtf8(), metaPos - origin));
+
+    char meta[FILE_META_SIZE] = {};
+    meta[0] = static_cast<char>(type);
+    memcpy(meta + FILE_TYPE_SIZE, rawName.constData(), rawName.size());
+    qToLittleEndian<qint64>(dataSize, meta + FILE_TYPE_SIZE + FILE_NAME_SIZE);
+    if (device->write(meta, FILE_META_SIZE) != FILE_META_SIZE) {
+        setErrorString(device->errorString());
+        return false;
+    }
+
+    return true;
+}
+
+bool DDciFileWriterPrivate::patchDataSize(qint64 metaPos, qint64 dataSize)
+{
+    const qint64 end = device->pos();
+    char size[FILE_DATA_SIZE];
+    qToLittleEndian<qint64>(dataSize, size);
+    if (!device->seek(metaPos + FILE_TYPE_SIZE + FILE_NAME_SIZE)
+            || device->write(size, FILE_DATA_SIZE) != FILE_DATA_SIZE
+            || !device->seek(end)) {
+        setErrorString(device->errorString());
+        return false;
+    }
+
+    return true;
+}
+
+bool DDciFileWriterPrivate::writePadding()
+{
+    if (version < 2)
+        return true;
+
+    const QByteArray padding(alignPaddingV2(device->pos() - origin), '\0');
+    if (device->write(padding) != padding.size()) {
+        setErrorString(device->errorString());
+        return false;
+    }
+
+    return true;
+}
+
+bool DDciFileWriterPrivate::finishVersion2()
+{
+    const qint64 indexOffset = device->pos() - origin;
+    const QByteArray &indexData = buildIndexV2(index);
+    char trailer[TRAILER_SIZE] = {};
+    qToLittleEndian<qint64>(indexOffset, trailer);
+    if (device->write(indexData) != indexData.size() || device->write(trailer, 8) != 8) {
+        setErrorString(device->errorString());
+        return false;
+    }
+
+    // 节点的元数据在其数据之后才确定，因此写入完成后读回全部数据计算校验和
+    const qint64 end = device->pos();
+    if (!device->seek(origin)) {
+        setErrorString(device->errorString());
+        return false;
+    }
+
+    QByteArray buffer(COPY_BUFFER_SIZE, Qt::Uninitialized);
+    quint32 checksum = 0;
+    for (qint64 remaining = end - origin; remaining > 0;) {
+        const qint64 size = device->read(buffer.data(), qMin<qint64>(remaining, buffer.size()));
+        if (size <= 0) {
+            setErrorString(device->errorString());
+            return false;
+        }
+        checksum = dciChecksum(buffer.constData(), size, checksum);
+        remaining -= size;
+    }
+
+    qToLittleEndian<quint32>(checksum, trailer + 8);
+    memcpy(trailer + 12, TRAILER_MAGIC, 4);
+    if (device->pos() != end || device->write(trailer + 8, 8) != 8) {
+        setErrorString(device->errorString());
+        return false;
+    }
+
+    return true;
+}
+
+DDciFileWriter::DDciFileWriter(QIODevice *device, int version)
+#ifndef DTK_NO_PROJECT
+    : DObject(*new DDciFileWriterPrivate(this))
+#else
+    : d(new DDciFileWriterPrivate(this))
+#endif
+{
+    D_D(DDciFileWriter);
+
+    if (!device || !device->isWritable() || device->isSequential()) {
+        d->setErrorString("The device must be writable and seekable");
+        return;
+    }
+    if (version < 1 || version > 3) {
+        d->setErrorString(QString("Not supported version: %1").arg(version));
+        return;
+    }
+    if (version >= 2 && !device->isReadable()) {
+        d->setErrorString(QString("The version %1 requires a readable device").arg(version));
+        return;
+    }
+
+    d->device = device;
+    d->version = static_cast<qint8>(version);
+    d->origin = device->pos();
+    d->directories.append(DDciFileWriterPrivate::Directory());
+
+    char header[MAGIC_SIZE + VERSION_SIZE + FILE_COUNT_SIZE] = {'D', 'C', 'I', '\0', static_cast<char>(version)};
+    if (device->write(header, sizeof(header)) != sizeof(header))
+        d->setErrorString(device->errorString());
+}
+
+DDciFileWriter::~DDciFileWriter()
+{
+#ifdef DTK_NO_PROJECT
+    delete d;
+#endif
+}
+
+bool DDciFileWriter::isValid() const
+{
+    D_DC(DDciFileWriter);
+    return d->device && d->errorMessage.isEmpty();
+}
+
+QString DDciFileWriter::lastErrorString() const
+{
+    D_DC(DDciFileWriter);
+    return d->errorMessage;
+}
+
+bool DDciFileWriter::beginDirectory(const QString &name)
+{
+    D_D(DDciFileWriter);
+
+    const qint64 metaPos = d->device ? d->device->pos() : -1;
+    if (!d->beginNode(FILE_TYPE_DIR, name, 0))
+        return false;
+
+    DDciFileWriterPrivate::Directory directory;
+    directory.metaPos = metaPos;
+    directory.path = d->directories.last().path + QLatin1Char('/') + name;
+    d->directories.append(directory);
+    return true;
+}
+
+bool DDciFileWriter::endDirectory()
+{
+    D_D(DDciFileWriter);
+
+    if (!d->checkWritable())
+        return false;
+    if (d->directories.size() < 2) {
+        d->setErrorString("No directory to end");
+        return false;
+    }
+
+    const auto directory = d->directories.takeLast();
+    return d->patchDataSize(directory.metaPos, d->device->pos() - directory.metaPos - FILE_META_SIZE);
+}
+
+bool DDciFileWriter::writeFile(const QString &name, const QByteArray &data)
+{
+    D_D(DDciFileWriter);
+
+    const qint64 metaPos = d->device ? d->device->pos() : -1;
+    const qint64 padding = d->version >= 2 ? alignPaddingV2(metaPos + FILE_META_SIZE - d->origin) : 0;
+    if (!d->beginNode(FILE_TYPE_FILE, name, padding + data.size()) || !d->writePadding())
+        return false;
+
+    if (d->device->write(data) != data.size()) {
+        d->setErrorString(d->device->errorString());
+        return false;
+    }
+
+    return true;
+}
+
+bool DDciFileWriter::writeCompressedFile(const QString &name, const QByteArray &data)
+{
+    D_D(DDciFileWriter);
+
+    if (d->version < 3) {
+        d->setErrorString(QString("The version %1 doesn't support the compressed file").arg(d->version));
+        return false;
+    }
+
+    const QByteArray &compressedData = dciCompress(data);
+    if (compressedData.isNull()) {
+        d->setErrorString(QString("Failed on compress the \"%1\" file").arg(name));
+        return false;
+    }
+
+    const qint64 metaPos = d->device ? d->device->pos() : -1;
+    const qint64 padding = alignPaddingV2(metaPos + FILE_META_SIZE - d->origin);
+    if (!d->beginNode(static_cast<qint8>(FILE_TYPE_FILE | FILE_FLAG_COMPRESSED), name, padding + compressedData.size())
+            || !d->writePadding())
+        return false;
+
+    if (d->device->write(compressedData) != compressedData.size()) {
+        d->setErrorString(d->device->errorString());
+        return false;
+    }
+
+    return true;
+}
+
+bool DDciFileWriter::writeFile(const QString &name, QIODevice *source)
+{
+    D_D(DDciFileWriter);
+
+    if (!source || !source->isReadable()) {
+        d->setErrorString("The source device is not readable");
+        return false;
+    }
+
+    const qint64 metaPos = d->device ? d->device->pos() : -1;
+    if (!d->beginNode(FILE_TYPE_FILE, name, 0) || !d->writePadding())
+        return false;
+
+    QByteArray buffer(COPY_BUFFER_SIZE, Qt::Uninitialized);
+    while (true) {
+        const qint64 size = source->read(buffer.data(), buffer.size());
+        if (size < 0) {
+            d->setErrorString(source->errorString());
+            return false;
+        }
+        if (size == 0 && (source->atEnd() || !source->waitForReadyRead(-1)))
+            break;
+        if (d->device->write(buffer.constData(), size) != size) {
+            d->setErrorString(d->device->errorString());
+            return false;
+        }
+    }
+
+    return d->patchDataSize(metaPos, d->device->pos() - metaPos - FILE_META_SIZE);
+}
+
+bool DDciFileWriter::link(const QString &name, const QString &source)
+{
+    D_D(DDciFileWriter);
+
+    if (source.isEmpty()) {
+        d->setErrorString("The link source is empty");
+        return false;
+    }
+
+    const QByteArray &data = source.toUtf8();
+    const qint64 metaPos = d->device ? d->device->pos() : -1;
+    const qint64 padding = d->version >= 2 ? alignPaddingV2(metaPos + FILE_META_SIZE - d->origin) : 0;
+    if (!d->beginNode(FILE_TYPE_SYMLINK, name, padding + data.size()) || !d->writePadding())
+        return false;
+
+    if (d->device->write(data) != data.size()) {
+        d->setErrorString(d->device->errorString());
+        return false;
+    }
+
+    return true;
+}
+
+bool DDciFileWriter::finish()
+{
+    D_D(DDciFileWriter);
+
+    if (!d->checkWritable())
+        return false;
+    if (d->directories.size() != 1) {
+        d->setErrorString(QString("The \"%1\" directory is not ended").arg(d->directories.last().path));
+        return false;
+    }
+
+    const qint64 end = d->device->pos();
+    char fileCount[sizeof(int)];
+    qToLittleEndian<int>(d->directories.first().childCount, fileCount);
+    if (!d->device->seek(d->origin + MAGIC_SIZE + VERSION_SIZE)
+            || d->device->write(fileCount, FILE_COUNT_SIZE) != FILE_COUNT_SIZE
+            || !d->device->seek(end)) {
+        d->setErrorString(d->device->errorString());
+        return false;
+    }
+
+    if (d->version >= 2 && !d->finishVersion2())
+        return false;
+
+    d->finished = true;
+    return true;
+}
+
+DCORE_END_NAMESPACE
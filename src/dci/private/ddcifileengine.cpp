@@ -76,6 +76,15 @@ static DDciFileShared getDciFile(const QString &dciFilePath, bool usePath = true
     return shared;
 }
 
+// 只读访问优先使用本线程内可写的 DDciFile（其可能包含未保存的修改），否则使用进程内的缓存
+static QSharedPointer<const DDciFile> getReadOnlyDciFile(const QString &dciFilePath)
+{
+    if (auto shared = sharedDciFile.value(dciFilePath).toStrongRef())
+        return shared;
+
+    return DDciFile::shared(dciFilePath);
+}
+
 #if QT_VERSION < QT_VERSION_CHECK(6, 8, 0)
 DDciFileEngineIterator::DDciFileEngineIterator(QDir::Filters filters, const QStringList &nameFilters)
     : QAbstractFileEngineIterator(filters, nameFilters)
@@ -111,8 +120,22 @@ bool DDciFileEngineIterator::advance()
                 || paths.second.isEmpty())
             return false;
 
-        file = getDciFile(paths.first);
-        list = file->list(paths.second);
+        file = getReadOnlyDciFile(paths.first);
+        // 子文件的名称与 DDciFile 中的数据共享，遍历时不再按路径查找节点
+        list = file->list(paths.second, true);
+        types = file->childrenTypes(paths.second);
+        Q_ASSERT(list.count() == types.count());
+
+        // 形如 "prefix*" 的过滤规则直接比较前缀，其余的规则仍使用 QDir::match
+        for (const QString &filter : nameFilters()) {
+            const QString &prefix = filter.left(filter.size() - 1);
+            if (filter.endsWith(QLatin1Char('*')) && !prefix.contains(QLatin1Char('*'))
+                    && !prefix.contains(QLatin1Char('?')) && !prefix.contains(QLatin1Char('['))) {
+                prefixFilters << prefix;
+            } else {
+                otherFilters << filter;
+            }
+        }
     }
 
     bool excludeDirs = false, excludeFiles = false, excludeSymlinks = false;
@@ -133,7 +156,7 @@ bool DDciFileEngineIterator::advance()
 
     for (int i = current + 1; i < list.count(); ++i) {
         // 先检查文件类型
-        const auto fileType = file->type(list.at(i));
+        const auto fileType = types.at(i);
         if (fileType == DDciFile::Directory) {
             if (excludeDirs)
                 continue;
@@ -148,7 +171,7 @@ bool DDciFileEngineIterator::advance()
         }
 
         // 按名称进行过滤
-        if (!nameFilters().isEmpty() && !QDir::match(nameFilters(), list.at(i)))
+        if (!nameFilters().isEmpty() && !matchNameFilters(list.at(i)))
             continue;
 
         nextValid = i;
@@ -163,7 +186,17 @@ bool DDciFileEngineIterator::advance()
 
 QString DDciFileEngineIterator::currentFileName() const
 {
-    return file->name(list.at(current));
+    return list.at(current);
+}
+
+bool DDciFileEngineIterator::matchNameFilters(const QString &name) const
+{
+    for (const QString &prefix : prefixFilters) {
+        if (name.startsWith(prefix, Qt::CaseInsensitive))
+            return true;
+    }
+
+    return !otherFilters.isEmpty() && QDir::match(otherFilters, name);
 }
 
 DDciFileEngine::DDciFileEngine(const QString &fullPath)
@@ -178,7 +211,7 @@ DDciFileEngine::~DDciFileEngine()
 
 bool DDciFileEngine::isValid() const
 {
-    return file && file->isValid();
+    return reader() && reader()->isValid();
 }
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
@@ -192,18 +225,18 @@ bool DDciFileEngine::open(QIODevice::OpenMode openMode)
         return false;
     }
 
-    if (!file->isValid()) {
+    if (!reader()->isValid()) {
         setError(QFile::OpenError, "The DCI file is invalid");
         return false;
     }
 
-    if (file->type(subfilePath) == DDciFile::Directory) {
+    if (reader()->type(subfilePath) == DDciFile::Directory) {
         setError(QFile::OpenError, "Can't open a directory");
         return false;
     }
 
-    if (file->type(subfilePath) == DDciFile::Symlink) {
-        if (!file->exists(file->symlinkTarget(subfilePath))) {
+    if (reader()->type(subfilePath) == DDciFile::Symlink) {
+        if (!reader()->exists(reader()->symlinkTarget(subfilePath))) {
             setError(QFile::OpenError, "The symlink target is not existed");
             return false;
         }
@@ -215,7 +248,7 @@ bool DDciFileEngine::open(QIODevice::OpenMode openMode)
     }
 
     if (openMode & QIODevice::NewOnly) {
-        if (file->exists(subfilePath)) {
+        if (reader()->exists(subfilePath)) {
             setError(QFile::OpenError, "The file is existed");
             return false;
         }
@@ -223,7 +256,7 @@ bool DDciFileEngine::open(QIODevice::OpenMode openMode)
 
     if ((openMode & QIODevice::ExistingOnly)
             || !(openMode & QIODevice::WriteOnly)) {
-        if (!file->exists(subfilePath)) {
+        if (!reader()->exists(subfilePath)) {
             setError(QFile::OpenError, "The file is not exists");
             return false;
         }
@@ -243,14 +276,14 @@ bool DDciFileEngine::open(QIODevice::OpenMode openMode)
 #endif
 
         // 不存在时尝试新建
-        if (!file->exists(subfilePath)
-                && !file->writeFile(subfilePath, QByteArray())) {
+        if (!writer()->exists(subfilePath)
+                && !writer()->writeFile(subfilePath, QByteArray())) {
             return false;
         }
     }
 
-    // 加载数据
-    fileData = file->dataRef(subfilePath);
+    // 加载数据，只读时 QBuffer 不会修改数据，与 DDciFile 中的数据共享而无需复制
+    fileData = reader()->dataRef(subfilePath);
     fileBuffer = new QBuffer(&fileData);
     bool ok = fileBuffer->open(openMode);
     Q_ASSERT(ok);
@@ -269,9 +302,14 @@ bool DDciFileEngine::close()
         return false;
     }
 
+    const bool readOnly = !fileBuffer->isWritable();
     fileBuffer->close();
     delete fileBuffer;
     fileBuffer = nullptr;
+    if (readOnly) {
+        fileData.clear();
+        return true;
+    }
 
     bool ok = flush();
     realDciFile.close();
@@ -281,11 +319,11 @@ bool DDciFileEngine::close()
 bool DDciFileEngine::flushToFile(QFile *target, bool writeFile) const
 {
     if (target->isWritable()) {
-        if (writeFile && !file->writeFile(subfilePath, fileData, true))
+        if (writeFile && !writer()->writeFile(subfilePath, fileData, true))
             return false;
         if (!target->resize(0))
             return false;
-        const QByteArray &data = file->toData();
+        const QByteArray &data = writer()->toData();
         if (target->write(data) != data.size())
             return false;
         return true;
@@ -299,7 +337,9 @@ bool DDciFileEngine::flush()
     if (!flushToFile(&realDciFile, true))
         return false;
 
-    return realDciFile.flush();
+    const bool ok = realDciFile.flush();
+    dropSharedDciFile(dciFilePath);
+    return ok;
 }
 
 bool DDciFileEngine::syncToDisk()
@@ -315,7 +355,7 @@ qint64 DDciFileEngine::size() const
         return fileData.size();
     }
 
-    return file->dataRef(subfilePath).size();
+    return reader()->dataRef(subfilePath).size();
 }
 
 qint64 DDciFileEngine::pos() const
@@ -335,55 +375,55 @@ bool DDciFileEngine::isSequential() const
 
 bool DDciFileEngine::remove()
 {
-    return file->isValid() && file->remove(subfilePath) && forceSave();
+    return writer()->isValid() && writer()->remove(subfilePath) && forceSave();
 }
 
 bool DDciFileEngine::copy(const QString &newName)
 {
-    if (!file->isValid())
+    if (!writer()->isValid())
         return false;
     // 解析出新的 dci 内部文件路径
     const auto paths = resolvePath(newName, dciFilePath);
     if (paths.second.isEmpty())
         return false;
 
-    return file->copy(subfilePath, paths.second) && forceSave();
+    return writer()->copy(subfilePath, paths.second) && forceSave();
 }
 
 bool DDciFileEngine::rename(const QString &newName)
 {
-    if (!file->isValid())
+    if (!writer()->isValid())
         return false;
     // 解析出新的 dci 内部文件路径
     const auto paths = resolvePath(newName, dciFilePath);
     if (paths.second.isEmpty())
         return false;
 
-    return file->rename(subfilePath, paths.second, false) && forceSave();
+    return writer()->rename(subfilePath, paths.second, false) && forceSave();
 }
 
 bool DDciFileEngine::renameOverwrite(const QString &newName)
 {
-    if (!file->isValid())
+    if (!writer()->isValid())
         return false;
     // 解析出新的 dci 内部文件路径
     const auto paths = resolvePath(newName, dciFilePath);
     if (paths.second.isEmpty())
         return false;
 
-    return file->rename(subfilePath, paths.second, true) && forceSave();
+    return writer()->rename(subfilePath, paths.second, true) && forceSave();
 }
 
 bool DDciFileEngine::link(const QString &newName)
 {
-    if (!file->isValid())
+    if (!writer()->isValid())
         return false;
 
     // 解析出新的 dci 内部文件路径
     const auto paths = resolvePath(newName, dciFilePath);
     const QString &linkPath = paths.second.isEmpty() ? newName : paths.second;
 
-    return file->link(subfilePath, linkPath) && forceSave();
+    return writer()->link(subfilePath, linkPath) && forceSave();
 }
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
@@ -396,7 +436,7 @@ bool DDciFileEngine::mkdir(const QString &dirName,
 bool DDciFileEngine::mkdir(const QString &dirName, bool createParentDirectories) const
 {
 #endif
-    if (!file->isValid())
+    if (!writer()->isValid())
         return false;
     // 解析出新的 dci 内部文件路径
     const auto paths = resolvePath(dirName, dciFilePath);
@@ -404,7 +444,7 @@ bool DDciFileEngine::mkdir(const QString &dirName, bool createParentDirectories)
         return false;
 
     if (!createParentDirectories)
-        return file->mkdir(paths.second) && forceSave();
+        return writer()->mkdir(paths.second) && forceSave();
 
     const QStringList dirItems = paths.second.split('/');
     QString currentPath;
@@ -412,11 +452,11 @@ bool DDciFileEngine::mkdir(const QString &dirName, bool createParentDirectories)
         if (newDir.isEmpty())
             continue;
         currentPath += ("/" + newDir);
-        if (file->exists(currentPath)) {
+        if (writer()->exists(currentPath)) {
             continue;
         }
         // 创建此路径
-        if (!file->mkdir(currentPath))
+        if (!writer()->mkdir(currentPath))
             return false;
     }
 
@@ -425,14 +465,14 @@ bool DDciFileEngine::mkdir(const QString &dirName, bool createParentDirectories)
 
 bool DDciFileEngine::rmdir(const QString &dirName, bool recurseParentDirectories) const
 {
-    if (!file->isValid())
+    if (!writer()->isValid())
         return false;
     // 解析出新的 dci 内部文件路径
     const auto paths = resolvePath(dirName, dciFilePath);
     if (paths.second.isEmpty())
         return false;
 
-    if (!file->remove(paths.second))
+    if (!writer()->remove(paths.second))
         return false;
     if (!recurseParentDirectories)
         return forceSave();
@@ -445,9 +485,9 @@ bool DDciFileEngine::rmdir(const QString &dirName, bool recurseParentDirectories
         if (dir.isRoot())
             break;
 
-        if (file->childrenCount(dir.absolutePath()) > 0)
+        if (writer()->childrenCount(dir.absolutePath()) > 0)
             continue;
-        if (!file->remove(dir.absolutePath()))
+        if (!writer()->remove(dir.absolutePath()))
             return false;
     }
 
@@ -457,7 +497,7 @@ bool DDciFileEngine::rmdir(const QString &dirName, bool recurseParentDirectories
 bool DDciFileEngine::setSize(qint64 size)
 {
     if (!fileBuffer) {
-        fileData = file->dataRef(subfilePath);
+        fileData = writer()->dataRef(subfilePath);
     }
 
     // 确保新数据填充为 0
@@ -501,11 +541,11 @@ QAbstractFileEngine::FileFlags DDciFileEngine::fileFlags(QAbstractFileEngine::Fi
 {
     auto flags = QAbstractFileEngine::FileFlags();
 
-    if (!file->isValid())
+    if (!reader()->isValid())
         return flags;
 
     if (type & TypesMask) {
-        const auto fileType = file->type(subfilePath);
+        const auto fileType = reader()->type(subfilePath);
 
         if (fileType == DDciFile::Directory) {
             flags |= DirectoryType;
@@ -517,14 +557,14 @@ QAbstractFileEngine::FileFlags DDciFileEngine::fileFlags(QAbstractFileEngine::Fi
     }
 
     if ((type & FlagsMask)) {
-        if (file->exists(subfilePath))
+        if (reader()->exists(subfilePath))
             flags |= ExistsFlag;
 
         if (subfilePath == QLatin1Char('/'))
             flags |= RootFlag;
     }
 
-    if ((type & PermsMask) && file->exists(subfilePath)) {
+    if ((type & PermsMask) && reader()->exists(subfilePath)) {
         flags |= static_cast<FileFlags>(static_cast<int>(QFileInfo(dciFilePath).permissions()));
     }
 
@@ -547,8 +587,8 @@ QString DDciFileEngine::fileName(QAbstractFileEngine::FileName file) const
 #else
     case LinkName:
 #endif
-        return this->file->type(subfilePath) == DDciFile::Symlink
-                ? this->file->symlinkTarget(subfilePath)
+        return reader()->type(subfilePath) == DDciFile::Symlink
+                ? reader()->symlinkTarget(subfilePath)
                 : QString();
     default:
         break;
@@ -562,6 +602,7 @@ void DDciFileEngine::setFileName(const QString &fullPath)
     // 销毁旧的内容
     close();
     file.reset(nullptr);
+    readOnlyFile.reset(nullptr);
     dciFilePath.clear();
     subfilePath.clear();
 
@@ -572,7 +613,11 @@ void DDciFileEngine::setFileName(const QString &fullPath)
 
     dciFilePath = paths.first;
     subfilePath = paths.second;
-    file = getDciFile(dciFilePath, QFile::exists(dciFilePath));
+    if (QFile::exists(dciFilePath)) {
+        readOnlyFile = getReadOnlyDciFile(dciFilePath);
+    } else {
+        file = getDciFile(dciFilePath, false);
+    }
 }
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 7, 1)
@@ -649,7 +694,7 @@ DDciFileEngine::TriStateResult DDciFileEngine::cloneTo(QAbstractFileEngine *targ
 bool DDciFileEngine::cloneTo(QAbstractFileEngine *target)
 #endif
 {
-    const QByteArray &data = file->dataRef(subfilePath);
+    const QByteArray &data = reader()->dataRef(subfilePath);
     auto ret = target->write(data.constData(), data.size()) == data.size();
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 10, 0)
@@ -659,6 +704,18 @@ bool DDciFileEngine::cloneTo(QAbstractFileEngine *target)
 #endif
 }
 
+const DDciFile *DDciFileEngine::reader() const
+{
+    return file ? file.data() : readOnlyFile.data();
+}
+
+DDciFile *DDciFileEngine::writer() const
+{
+    if (!file)
+        file = getDciFile(dciFilePath, QFile::exists(dciFilePath));
+    return file.data();
+}
+
 bool DDciFileEngine::forceSave(bool writeFile) const
 {
     QFile file(dciFilePath);
@@ -666,7 +723,10 @@ bool DDciFileEngine::forceSave(bool writeFile) const
         return false;
     }
 
-    return flushToFile(&file, writeFile);
+    const bool ok = flushToFile(&file, writeFile);
+    file.close();
+    dropSharedDciFile(dciFilePath);
+    return ok;
 }
 
 QPair<QString, QString> DDciFileEngine::resolvePath(const QString &fullPath,
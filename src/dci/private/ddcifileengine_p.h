@@ -12,6 +12,8 @@
 #endif
 #include <private/qabstractfileengine_p.h>
 
+#include "dci/ddcifile.h"
+
 #include <QSharedPointer>
 #include <QDateTime>
 
@@ -33,6 +35,9 @@ public:
 
 class DDciFile;
 using DDciFileShared = QSharedPointer<DDciFile>;
+// 文件被本进程修改后，从 DDciFile::shared 的缓存中移除它，修改时间的精度不足以区分连续的修改
+void dropSharedDciFile(const QString &fileName);
+
 class DDciFileEngineIterator : public QAbstractFileEngineIterator
 {
     friend class DDciFileEngine;
@@ -54,8 +59,13 @@ public:
     QString currentFileName() const override;
 
 private:
-    mutable DDciFileShared file;
+    bool matchNameFilters(const QString &name) const;
+
+    mutable QSharedPointer<const DDciFile> file;
     mutable QStringList list;
+    mutable QVector<DDciFile::FileType> types;
+    mutable QStringList prefixFilters;
+    mutable QStringList otherFilters;
     mutable int nextValid = -1;
     int current = -1;
 #if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
@@ -145,6 +155,8 @@ public:
 
 private:
     bool forceSave(bool writeFile = false) const;
+    const DDciFile *reader() const;
+    DDciFile *writer() const;
 
     /*
      * fullPath 格式："dci:" + "真实文件路径" + "DCI 内部文件的路径"
@@ -157,7 +169,9 @@ private:
                                                const QString &realFilePath = QString(),
                                                bool needRealFileExists = true);
 
-    DDciFileShared file;
+    // 只读时使用进程内共享的 DDciFile，需要修改时才创建可写的 file
+    QSharedPointer<const DDciFile> readOnlyFile;
+    mutable DDciFileShared file;
     QString dciFilePath;
     QFile realDciFile;
     QString subfilePath;
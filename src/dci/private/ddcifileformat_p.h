@@ -0,0 +1,207 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#ifndef DTK_NO_PROJECT
+#include <dtkcore_global.h>
+#else
+#define DCORE_BEGIN_NAMESPACE
+#define DCORE_END_NAMESPACE
+#endif
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QPair>
+#include <QVector>
+#include <QtEndian>
+
+#include <algorithm>
+#include <array>
+
+#include <zstd.h>
+
+DCORE_BEGIN_NAMESPACE
+
+#define MAGIC "DCI"
+
+#define MAGIC_SIZE 4
+#define VERSION_SIZE 1
+#define FILE_COUNT_SIZE 3
+#define FILE_META_SIZE 72
+
+#define FILE_TYPE_SIZE 1
+#define FILE_NAME_SIZE 63
+#define FILE_DATA_SIZE 8
+
+/*
+ * 版本 2 在版本 1 的基础上：
+ * 1. 文件和链接的数据起始位置按 DATA_ALIGNMENT_V2 对齐，节点中记录的数据大小包含对齐所填充的字节，
+ *    填充的大小可由数据的起始位置计算得出；
+ * 2. 在节点数据之后追加路径索引：
+ *    "DIDX" | 索引项数量(4) | 哈希桶数量(4) | 索引项 | 哈希桶 | 路径字符串
+ *    索引项按路径（UTF-8）排序，每项为：节点元数据的位置(8) | 路径在字符串区中的位置(4) | 路径的长度(4)，
+ *    哈希桶的数量为 2 的幂，使用 FNV-1a 哈希和线性探测，空桶的值为 0xffffffff；
+ * 3. 文件末尾为：索引的位置(8) | 校验和(4) | "DCIX"，校验和为除最后 8 字节外全部数据的 CRC-32。
+ */
+#define DATA_ALIGNMENT_V2 64
+#define INDEX_MAGIC "DIDX"
+#define INDEX_HEADER_SIZE 12
+#define INDEX_ENTRY_SIZE 16
+#define INDEX_EMPTY_BUCKET 0xffffffffu
+#define TRAILER_MAGIC "DCIX"
+#define TRAILER_SIZE 16
+
+/*
+ * 版本 3 在版本 2 的基础上，文件的数据可使用 zstd 压缩：
+ * 节点类型的最高位为 FILE_FLAG_COMPRESSED 时，文件数据（对齐填充之后的部分）为一个完整的 zstd 帧，
+ * 帧头中须包含解压后的大小，且不可超过 MAX_UNCOMPRESSED_SIZE。目录和链接不可压缩。
+ */
+#define FILE_FLAG_COMPRESSED 0x80
+#define FILE_TYPE_MASK 0x7f
+#define COMPRESSION_LEVEL 19
+// 解压前会按帧头中的大小分配内存，限制其大小以免损坏或恶意构造的文件申请过多的内存
+#define MAX_UNCOMPRESSED_SIZE (64 * 1024 * 1024)
+
+#define FILE_TYPE_FILE DDciFile::FileType::File
+#define FILE_TYPE_DIR DDciFile::FileType::Directory
+#define FILE_TYPE_SYMLINK DDciFile::FileType::Symlink
+
+// CRC-32，分段计算时传入上一段的结果
+inline quint32 dciChecksum(const char *data, qint64 size, quint32 crc = 0)
+{
+    static const auto table = [] {
+        std::array<quint32, 256> table {};
+        for (quint32 i = 0; i < table.size(); ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return table;
+    }();
+
+    crc ^= 0xffffffffu;
+    for (qint64 i = 0; i < size; ++i)
+        crc = table[(crc ^ static_cast<uchar>(data[i])) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffffu;
+}
+
+// 按顺序写出数据，同时计算已写出数据的校验和
+class DDciChecksumWriter
+{
+public:
+    explicit DDciChecksumWriter(QIODevice *device)
+        : device(device)
+    {
+    }
+
+    bool write(const char *data, qint64 size)
+    {
+        if (!ok)
+            return false;
+
+        crc = dciChecksum(data, size, crc);
+        offset += size;
+        ok = device->write(data, size) == size;
+        return ok;
+    }
+    inline bool write(const QByteArray &data) { return write(data.constData(), data.size()); }
+
+    // 相对于开始写入时的位置
+    inline qint64 pos() const { return offset; }
+    inline quint32 checksum() const { return crc; }
+
+private:
+    QIODevice *device;
+    quint32 crc = 0;
+    qint64 offset = 0;
+    bool ok = true;
+};
+
+inline quint32 pathHash(const QByteArray &path)
+{
+    quint32 hash = 2166136261u;
+    for (char ch : path) {
+        hash ^= static_cast<uchar>(ch);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+inline qint64 alignPaddingV2(qint64 offset)
+{
+    return (DATA_ALIGNMENT_V2 - offset % DATA_ALIGNMENT_V2) % DATA_ALIGNMENT_V2;
+}
+
+inline QByteArray dciCompress(const QByteArray &data)
+{
+    // 超出限制的数据在读取时无法解压
+    if (data.size() > MAX_UNCOMPRESSED_SIZE)
+        return QByteArray();
+
+    QByteArray compressed(static_cast<int>(ZSTD_compressBound(data.size())), Qt::Uninitialized);
+    const size_t size = ZSTD_compress(compressed.data(), compressed.size(), data.constData(), data.size(), COMPRESSION_LEVEL);
+    if (ZSTD_isError(size))
+        return QByteArray();
+
+    compressed.resize(static_cast<int>(size));
+    return compressed;
+}
+
+// 数据无效时返回 false，压缩帧中须记录解压后的大小
+inline bool dciDecompress(const QByteArray &data, QByteArray *out)
+{
+    const unsigned long long size = ZSTD_getFrameContentSize(data.constData(), data.size());
+    if (size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR || size > MAX_UNCOMPRESSED_SIZE)
+        return false;
+
+    QByteArray result(static_cast<int>(size), Qt::Uninitialized);
+    const size_t decompressed = ZSTD_decompress(result.data(), result.size(), data.constData(), data.size());
+    if (ZSTD_isError(decompressed) || decompressed != size)
+        return false;
+
+    *out = result;
+    return true;
+}
+
+using DDciIndexList = QVector<QPair<QByteArray, qint64>>;
+
+// 生成版本 2 的路径索引，index 中为节点的路径及其元数据的位置
+inline QByteArray buildIndexV2(DDciIndexList index)
+{
+    std::sort(index.begin(), index.end(), [](const QPair<QByteArray, qint64> &a, const QPair<QByteArray, qint64> &b) {
+        return a.first < b.first;
+    });
+
+    quint32 bucketCount = 1;
+    while (bucketCount < static_cast<quint32>(index.size()) * 2)
+        bucketCount <<= 1;
+
+    QByteArray entries(index.size() * INDEX_ENTRY_SIZE, '\0');
+    QByteArray buckets(bucketCount * 4, '\xff');
+    QByteArray strings;
+    for (int i = 0; i < index.size(); ++i) {
+        const QByteArray &path = index.at(i).first;
+        char *entry = entries.data() + i * INDEX_ENTRY_SIZE;
+        qToLittleEndian<qint64>(index.at(i).second, entry);
+        qToLittleEndian<quint32>(strings.size(), entry + 8);
+        qToLittleEndian<quint32>(path.size(), entry + 12);
+        strings.append(path);
+
+        quint32 bucket = pathHash(path) & (bucketCount - 1);
+        while (qFromLittleEndian<quint32>(buckets.constData() + bucket * 4) != INDEX_EMPTY_BUCKET)
+            bucket = (bucket + 1) & (bucketCount - 1);
+        qToLittleEndian<quint32>(i, buckets.data() + bucket * 4);
+    }
+
+    char header[INDEX_HEADER_SIZE];
+    memcpy(header, INDEX_MAGIC, 4);
+    qToLittleEndian<quint32>(index.size(), header + 4);
+    qToLittleEndian<quint32>(bucketCount, header + 8);
+
+    return QByteArray(header, INDEX_HEADER_SIZE) + entries + buckets + strings;
+}
+
+DCORE_END_NAMESPACE
@@ -5,6 +5,7 @@
 #include "dconfig.h"
 #ifndef D_DISABLE_DCONFIG
 #include "dconfigfile.h"
+#include "dfilesystemwatcher.h"
 #ifndef D_DISABLE_DBUS_CONFIG
 #include "configmanager_interface.h"
 #include "manager_interface.h"
@@ -13,11 +14,28 @@
 #include <QSettings>
 #endif
 #include "dobject_p.h"
+#include "dtracespan_p.h"
+#include "util/ddbuscalltrace_p.h"
+#include "util/dexportedinterface.h"
+#include "util/dperfcounters.h"
 #include <DSGApplication>
 
 #include <QLoggingCategory>
 #include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFutureInterface>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QTimer>
 #include <unistd.h>
+#include <atomic>
+#include <memory>
 
 // https://gitlabwh.uniontech.com/wuhan/se/deepin-specifications/-/issues/3
 
@@ -26,6 +44,23 @@ DCORE_BEGIN_NAMESPACE
 Q_DECLARE_LOGGING_CATEGORY(cfLog)
 static QString NoAppId;
 
+static DPerfCounter dconfigReads("dconfig.reads");
+static DPerfCounter dconfigWrites("dconfig.writes");
+// the calls to the config manager, and the microseconds the blocking ones take
+static DPerfCounter dconfigIpcCalls("dconfig.ipc_calls");
+static DPerfHistogram dconfigIpcLatency("dconfig.ipc_latency_us", {100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000});
+
+struct DConfigIpcCall
+{
+    DConfigIpcCall()
+        : timer(dconfigIpcLatency)
+    {
+        dconfigIpcCalls.add();
+    }
+
+    DPerfHistogram::ScopedTimer timer;
+};
+
 /*!
 @~english
     @class Dtk::Core::DConfigBackend
@@ -108,6 +143,66 @@ DConfigBackend::~DConfigBackend()
 {
 }
 
+// the base of the builtin backends for the calls which aren't in DConfigBackend, adding virtuals
+// to the exported class breaks the custom backends, DConfig falls back to the basic calls for them.
+class Q_DECL_HIDDEN BuiltinBackend : public DConfigBackend
+{
+public:
+    virtual void setValues(const QVariantMap &values)
+    {
+        for (auto iter = values.constBegin(); iter != values.constEnd(); ++iter)
+            setValue(iter.key(), iter.value());
+    }
+
+    virtual QVariantMap values(const QStringList &keys) const
+    {
+        return valuesOneByOne(this, keys);
+    }
+
+    // all items of keyList() are used if keys is empty.
+    static QVariantMap valuesOneByOne(const DConfigBackend *backend, const QStringList &keys)
+    {
+        QVariantMap result;
+        for (const auto &key : keys.isEmpty() ? backend->keyList() : keys)
+            result.insert(key, backend->value(key, QVariant()));
+        return result;
+    }
+
+    // whether isValid() waits for the backend to be ready, valueAsync() checks it itself if so.
+    virtual bool isPending() const
+    {
+        return false;
+    }
+
+    // a ready future with the result of value().
+    virtual QFuture<QVariant> valueAsync(const QString &key, const QVariant &fallback) const
+    {
+        return valueReady(this, key, fallback);
+    }
+
+    static QFuture<QVariant> valueReady(const DConfigBackend *backend, const QString &key, const QVariant &fallback)
+    {
+        QFutureInterface<QVariant> result(QFutureInterfaceBase::Started);
+        result.reportResult(backend->value(key, fallback));
+        result.reportFinished();
+        return result.future();
+    }
+
+    // a finished future after setValue().
+    virtual QFuture<void> setValueAsync(const QString &key, const QVariant &value)
+    {
+        return setValueReady(this, key, value);
+    }
+
+    static QFuture<void> setValueReady(DConfigBackend *backend, const QString &key, const QVariant &value)
+    {
+        backend->setValue(key, value);
+        QFutureInterface<void> result(QFutureInterfaceBase::Started);
+        result.reportFinished();
+        return result.future();
+    }
+};
+
 static QString _globalAppId;
 class Q_DECL_HIDDEN DConfigPrivate : public DObjectPrivate
 {
@@ -135,21 +230,255 @@ public:
         return !valid;
     }
 
+    inline QVariantMap values(const QStringList &keys) const
+    {
+        if (auto builtin = dynamic_cast<const BuiltinBackend *>(backend.data()))
+            return builtin->values(keys);
+        return BuiltinBackend::valuesOneByOne(backend.data(), keys);
+    }
+
     DConfigBackend *getOrCreateBackend();
     DConfigBackend *createBackendByEnv();
+    void updateSnapshot(const QString &key);
+
+    struct Subscription {
+        QStringList keys;
+        QString prefix;
+        std::function<void(const QStringList &)> callback;
+        QMetaObject::Connection contextConnection;
+        QStringList pending;
+    };
+    int addSubscription(Subscription subscription, QObject *context);
+    void removeSubscription(int id);
+    void dispatchChange(const QString &key);
+    void flushSubscriptions();
 
     QString appId;
     QString name;
     QString subpath;
     QScopedPointer<DConfigBackend> backend;
+    // it's replaced by the owner thread and is read by any thread through the atomic shared_ptr
+    // functions, which take a short lock in the common standard libraries.
+    std::shared_ptr<const QVariantHash> valueSnapshot;
+    QMetaObject::Connection snapshotConnection;
+    // the subscriptions are indexed by the key and by the prefix, the changes are flushed in batch.
+    QHash<int, Subscription> subscriptions;
+    QHash<QString, QVector<int>> keySubscriptions;
+    QHash<QString, QVector<int>> prefixSubscriptions;
+    QMetaObject::Connection subscriptionConnection;
+    int lastSubscriptionId = 0;
+    bool flushPending = false;
+
+    // the calls of the value and setValue functions aren't counted by default, they'd cost two atomic
+    // increments per call, it's enabled by `DSG_DCONFIG_STATISTICS=1`.
+    inline void countRead() const
+    {
+        if (!statisticsEnabled)
+            return;
+        reads.fetch_add(1, std::memory_order_relaxed);
+        dconfigReads.add();
+    }
+
+    inline void countWrite()
+    {
+        if (!statisticsEnabled)
+            return;
+        writes.fetch_add(1, std::memory_order_relaxed);
+        dconfigWrites.add();
+    }
+
+    // for DConfig::statistics(), the backend name and load time are set once by the constructor.
+    QString backendName;
+    qint64 loadNsecs = 0;
+    const bool statisticsEnabled = qEnvironmentVariableIntValue("DSG_DCONFIG_STATISTICS") == 1;
+    mutable std::atomic<quint64> reads {0};
+    std::atomic<quint64> writes {0};
 
     D_DECLARE_PUBLIC(DConfig)
 };
 
+// the live DConfig of the process, for DConfig::statistics().
+static QMutex *liveConfigsMutex()
+{
+    static QMutex mutex;
+    return &mutex;
+}
+
+static QSet<DConfigPrivate *> &liveConfigs()
+{
+    static QSet<DConfigPrivate *> configs;
+    return configs;
+}
+
 namespace {
 
 #ifndef D_DISABLE_DCONFIG
-class Q_DECL_HIDDEN FileBackend : public DConfigBackend
+// the size of a value in json, an estimation of the memory it holds.
+static qint64 jsonSize(const QVariant &value)
+{
+    return QJsonDocument(QJsonArray{QJsonValue::fromVariant(value)}).toJson(QJsonDocument::Compact).size() - 2;
+}
+
+/*
+ * The loaded configuration of a (appId, name, subpath), it's shared by all FileBackend
+ * of the process, so that the meta and overrides are parsed once for the same configuration.
+ * It's saved when the last owner releases it.
+ */
+class Q_DECL_HIDDEN SharedConfigFile
+{
+public:
+    SharedConfigFile(const QString &appId, const QString &name, const QString &subpath, const QString &prefix)
+        : file(appId, name, subpath)
+        , prefix(prefix)
+    {
+    }
+
+    ~SharedConfigFile()
+    {
+        if (cache)
+            cache->save(prefix);
+        file.save(prefix);
+    }
+
+    bool isValid()
+    {
+        QMutexLocker locker(&mutex);
+        return file.isValid();
+    }
+
+    QStringList keyList()
+    {
+        QMutexLocker locker(&mutex);
+        return file.meta()->keyList();
+    }
+
+    QVariant cacheValue(const QString &key)
+    {
+        QMutexLocker locker(&mutex);
+        return file.cacheValue(cache.data(), key);
+    }
+
+    QVariant value(const QString &key)
+    {
+        QMutexLocker locker(&mutex);
+        return file.value(key);
+    }
+
+    DConfigFile::Permissions permissions(const QString &key)
+    {
+        QMutexLocker locker(&mutex);
+        return file.meta()->permissions(key);
+    }
+
+    bool setValue(const QString &key, const QVariant &value, const QString &callerAppid)
+    {
+        QMutexLocker locker(&mutex);
+        return file.setValue(key, value, callerAppid, cache.data());
+    }
+
+    bool setValues(const QVariantMap &values, const QString &callerAppid, QStringList *changedKeys)
+    {
+        QMutexLocker locker(&mutex);
+        return file.setValues(values, callerAppid, cache.data(), changedKeys);
+    }
+
+    bool reloadOverrides(QStringList *changedKeys)
+    {
+        QMutexLocker locker(&mutex);
+        return file.reloadOverrides(prefix, changedKeys);
+    }
+
+    // the bytes of the meta and override files which are parsed, and of the cached values in json.
+    void footprint(qint64 *metaBytes, qint64 *cacheBytes)
+    {
+        QMutexLocker locker(&mutex);
+        bool useAppId = true;
+        *metaBytes = QFileInfo(file.meta()->metaPath(prefix, &useAppId)).size();
+        for (const auto &dir : file.meta()->allOverrideDirs(useAppId, prefix)) {
+            for (const auto &info : QDir(dir).entryInfoList({QStringLiteral("*.json")}, QDir::Files))
+                *metaBytes += info.size();
+        }
+
+        *cacheBytes = 0;
+        for (auto item : {cache.data(), file.globalCache()}) {
+            if (!item)
+                continue;
+            for (const auto &key : item->keyList())
+                *cacheBytes += key.size() + jsonSize(item->value(key));
+        }
+    }
+
+    void attach(DConfig *listener)
+    {
+        QMutexLocker locker(&listenersMutex);
+        listeners.append(listener);
+    }
+
+    void detach(DConfig *listener)
+    {
+        QMutexLocker locker(&listenersMutex);
+        listeners.removeOne(listener);
+    }
+
+    // notify the other DConfig sharing this configuration, it's queued to the listener's thread.
+    void notify(const QStringList &keys, DConfig *sender)
+    {
+        if (keys.isEmpty())
+            return;
+
+        QMutexLocker locker(&listenersMutex);
+        for (auto listener : std::as_const(listeners)) {
+            if (listener == sender)
+                continue;
+            QMetaObject::invokeMethod(listener, [listener, keys]() {
+                for (const auto &key : keys)
+                    Q_EMIT listener->valueChanged(key);
+            }, Qt::QueuedConnection);
+        }
+    }
+
+    static std::shared_ptr<SharedConfigFile> instance(const QString &appId, const QString &name,
+                                                      const QString &subpath, const QString &prefix)
+    {
+        static QHash<QString, std::weak_ptr<SharedConfigFile>> instances;
+
+        const QString &instanceKey = QString("%1\n%2\n%3\n%4").arg(prefix, appId, name, subpath);
+        QMutexLocker locker(instancesMutex());
+        if (auto config = instances.value(instanceKey).lock())
+            return config;
+
+        // The files are loaded with instancesMutex held, and the deleter saves the released
+        // instance with it held too, so a new instance never reads the files being saved.
+        std::unique_ptr<SharedConfigFile> loaded(new SharedConfigFile(appId, name, subpath, prefix));
+        loaded->cache.reset(loaded->file.createUserCache(getuid()));
+        // it's destroyed without the deleter, which would lock instancesMutex again.
+        if (!loaded->file.load(prefix) || !loaded->cache->load(prefix))
+            return nullptr;
+
+        std::shared_ptr<SharedConfigFile> config(loaded.release(), [](SharedConfigFile *config) {
+            QMutexLocker locker(instancesMutex());
+            delete config;
+        });
+        instances[instanceKey] = config;
+        return config;
+    }
+
+private:
+    static QMutex *instancesMutex()
+    {
+        static QMutex mutex;
+        return &mutex;
+    }
+
+    DConfigFile file;
+    QScopedPointer<DConfigCache> cache;
+    const QString prefix;
+    QMutex mutex;
+    QMutex listenersMutex;
+    QList<DConfig *> listeners;
+};
+
+class Q_DECL_HIDDEN FileBackend : public BuiltinBackend
 {
 public:
     explicit FileBackend(DConfigPrivate *o)
@@ -169,43 +498,34 @@ public:
         if (configFile)
             return true;
 
-        configFile.reset(new DConfigFile(owner->appId,owner->name, owner->subpath));
-        configCache.reset(configFile->createUserCache(getuid()));
         const QString &prefix = localPrefix();
-
-        if (!configFile->load(prefix) || !configCache->load(prefix))
+        configFile = SharedConfigFile::instance(owner->appId, owner->name, owner->subpath, prefix);
+        if (!configFile)
             return false;
 
-        // generic config doesn't need to fallback to generic configration.
-        if (owner->appId == NoAppId)
-            return true;
+        configFile->attach(owner->q_func());
+
+        if (qEnvironmentVariableIntValue("DSG_DCONFIG_WATCH_OVERRIDES") == 1)
+            watchOverrides(prefix);
 
-        std::unique_ptr<DConfigFile> file(new DConfigFile(NoAppId, owner->name, owner->subpath));
-        const bool canFallbackToGeneric = !file->meta()->metaPath(prefix).isEmpty();
-        if (canFallbackToGeneric) {
-            std::unique_ptr<DConfigCache> cache(file->createUserCache(getuid()));
-            if (file->load(prefix) && cache->load(prefix)) {
-                genericConfigFile.reset(file.release());
-                genericConfigCache.reset(cache.release());
-            }
-        }
         return true;
     }
 
     virtual QStringList keyList() const override
     {
-        return configFile->meta()->keyList();
+        return configFile->keyList();
     }
 
     virtual QVariant value(const QString &key, const QVariant &fallback) const override
     {
-        const QVariant &vc = configFile->cacheValue(configCache.get(), key);
+        const QVariant &vc = configFile->cacheValue(key);
         if (vc.isValid())
             return vc;
 
         // fallback to generic configuration, and use itself's configuration if generic isn't set.
-        if (genericConfigFile) {
-            const auto &tmp = genericConfigFile->cacheValue(genericConfigCache.get(), key);
+        const auto &generic = genericConfig();
+        if (generic) {
+            const auto &tmp = generic->cacheValue(key);
             if (tmp.isValid())
                 return tmp;
         }
@@ -213,25 +533,37 @@ public:
         if (v.isValid())
             return v;
         // fallback to default value of generic configuration.
-        const QVariant &vg = genericConfigFile->value(key);
+        const QVariant &vg = generic ? generic->value(key) : QVariant();
         return vg.isValid() ? vg : fallback;
     }
 
     virtual bool isDefaultValue(const QString &key) const override
     {
         // Don't fallback to generic configuration
-        const QVariant &vc = configFile->cacheValue(configCache.get(), key);
+        const QVariant &vc = configFile->cacheValue(key);
         return !vc.isValid();
     }
 
     virtual void setValue(const QString &key, const QVariant &value) override
     {
         // setValue's callerAppid is itself instead of config's appId.
-        if (configFile->setValue(key, value, DSGApplication::id(), configCache.get())) {
+        if (configFile->setValue(key, value, DSGApplication::id())) {
             Q_EMIT owner->q_func()->valueChanged(key);
+            configFile->notify({key}, owner->q_func());
         }
     }
 
+    virtual void setValues(const QVariantMap &values) override
+    {
+        QStringList changedKeys;
+        if (!configFile->setValues(values, DSGApplication::id(), &changedKeys))
+            return;
+
+        for (const auto &key : std::as_const(changedKeys))
+            Q_EMIT owner->q_func()->valueChanged(key);
+        configFile->notify(changedKeys, owner->q_func());
+    }
+
     virtual void reset(const QString &key) override
     {
         setValue(key, QVariant());
@@ -239,7 +571,7 @@ public:
 
     virtual bool isReadOnly(const QString &key) const override
     {
-        const auto vc = configFile->meta()->permissions(key);
+        const auto vc = configFile->permissions(key);
         return vc == DConfigFile::ReadOnly;
     }
 
@@ -248,6 +580,12 @@ public:
         return QString("FileBackend");
     }
 
+    void footprint(int *keyCount, qint64 *metaBytes, qint64 *cacheBytes) const
+    {
+        *keyCount = configFile->keyList().size();
+        configFile->footprint(metaBytes, cacheBytes);
+    }
+
 private:
     QString localPrefix() const
     {
@@ -257,34 +595,126 @@ private:
         return QString();
     }
 
+    // the directories which may contain the override files of the configuration, include the subpath's levels.
+    static QStringList overrideWatchDirs(const QString &appId, const QString &name, const QString &subpath,
+                                         const QString &prefix)
+    {
+        DConfigFile file(appId, name, subpath);
+        bool useAppId = true;
+        if (file.meta()->metaPath(prefix, &useAppId).isEmpty())
+            return QStringList();
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+        const QStringList &subdirs = subpath.split(QLatin1Char('/'), Qt::SkipEmptyParts);
+#else
+        const QStringList &subdirs = subpath.split(QLatin1Char('/'), QString::SkipEmptyParts);
+#endif
+        QStringList dirs;
+        for (const auto &dir : file.meta()->allOverrideDirs(useAppId, prefix)) {
+            QString path = QDir::cleanPath(dir);
+            if (QDir(path).exists())
+                dirs << path;
+            for (const auto &item : subdirs) {
+                path += QLatin1Char('/') + item;
+                if (QDir(path).exists())
+                    dirs << path;
+            }
+        }
+        return dirs;
+    }
+
+    /*
+     * Watch the override directories, the changed override files are merged again
+     * after a little delay, it doesn't watch the directories created later.
+     */
+    void watchOverrides(const QString &prefix)
+    {
+        QStringList dirs = overrideWatchDirs(owner->appId, owner->name, owner->subpath, prefix);
+        // watch the generic configuration's directories without loading it.
+        if (owner->appId != NoAppId)
+            dirs << overrideWatchDirs(NoAppId, owner->name, owner->subpath, prefix);
+        dirs.removeDuplicates();
+        if (dirs.isEmpty())
+            return;
+
+        reloadTimer.reset(new QTimer);
+        reloadTimer->setSingleShot(true);
+        reloadTimer->setInterval(100);
+        QObject::connect(reloadTimer.data(), &QTimer::timeout, reloadTimer.data(), [this]() {
+            reloadOverrides();
+        });
+
+        overrideWatcher.reset(new DFileSystemWatcher);
+        overrideWatcher->addPaths(dirs);
+        auto schedule = [this]() { reloadTimer->start(); };
+        QObject::connect(overrideWatcher.data(), &DFileSystemWatcher::fileCreated, reloadTimer.data(), schedule);
+        QObject::connect(overrideWatcher.data(), &DFileSystemWatcher::fileDeleted, reloadTimer.data(), schedule);
+        QObject::connect(overrideWatcher.data(), &DFileSystemWatcher::fileModified, reloadTimer.data(), schedule);
+        QObject::connect(overrideWatcher.data(), &DFileSystemWatcher::fileMoved, reloadTimer.data(), schedule);
+        QObject::connect(overrideWatcher.data(), &DFileSystemWatcher::fileClosed, reloadTimer.data(), schedule);
+    }
+
+    SharedConfigFile *genericConfig() const
+    {
+        // generic config doesn't need to fallback to generic configration.
+        if (!genericConfigLoaded && owner->appId != NoAppId) {
+            const QString &prefix = localPrefix();
+            const bool canFallbackToGeneric = !DConfigFile(NoAppId, owner->name, owner->subpath).meta()->metaPath(prefix).isEmpty();
+            if (canFallbackToGeneric)
+                genericConfigFile = SharedConfigFile::instance(NoAppId, owner->name, owner->subpath, prefix);
+        }
+        genericConfigLoaded = true;
+        return genericConfigFile.get();
+    }
+
+    void reloadOverrides()
+    {
+        QVariantHash oldValues;
+        for (const auto &key : keyList())
+            oldValues.insert(key, value(key, QVariant()));
+
+        QStringList changedKeys;
+        if (!configFile->reloadOverrides(&changedKeys))
+            return;
+        // the generic configuration isn't reloaded if it isn't used yet.
+        QStringList genericChangedKeys;
+        if (genericConfigLoaded && genericConfigFile && genericConfigFile->reloadOverrides(&genericChangedKeys)) {
+            genericConfigFile->notify(genericChangedKeys, owner->q_func());
+            changedKeys << genericChangedKeys;
+            changedKeys.removeDuplicates();
+        }
+
+        // notify the keys whose effective value changed only.
+        const QStringList &keys = keyList();
+        QStringList effectiveChangedKeys;
+        for (const auto &key : std::as_const(changedKeys)) {
+            const QVariant &newValue = keys.contains(key) ? value(key, QVariant()) : QVariant();
+            if (newValue != oldValues.value(key))
+                effectiveChangedKeys << key;
+        }
+        for (const auto &key : std::as_const(effectiveChangedKeys))
+            Q_EMIT owner->q_func()->valueChanged(key);
+        configFile->notify(effectiveChangedKeys, owner->q_func());
+    }
+
 private:
-    QScopedPointer<DConfigFile> configFile;
-    QScopedPointer<DConfigCache> configCache;
-    QScopedPointer<DConfigFile> genericConfigFile;
-    QScopedPointer<DConfigCache> genericConfigCache;
+    std::shared_ptr<SharedConfigFile> configFile;
+    mutable std::shared_ptr<SharedConfigFile> genericConfigFile;
+    mutable bool genericConfigLoaded = false;
+    QScopedPointer<QTimer> reloadTimer;
+    QScopedPointer<DFileSystemWatcher> overrideWatcher;
     DConfigPrivate* owner;
     const QByteArray envLocalPrefix = qgetenv("DSG_DCONFIG_FILE_BACKEND_LOCAL_PREFIX");
 };
 
 FileBackend::~FileBackend()
 {
-    const QString &prefix = localPrefix();
-    if (configCache) {
-        configCache->save(prefix);
-        configCache.reset();
-    }
+    // the shared configurations are saved when the last owner releases them.
     if (configFile) {
-        configFile->save(prefix);
+        configFile->detach(owner->q_func());
         configFile.reset();
     }
-    if (genericConfigCache) {
-        genericConfigCache->save(prefix);
-        genericConfigCache.reset();
-    }
-    if (genericConfigFile) {
-        genericConfigFile->save(prefix);
-        genericConfigFile.reset();
-    }
+    genericConfigFile.reset();
 }
 
 #ifndef D_DISABLE_DBUS_CONFIG
@@ -292,7 +722,7 @@ FileBackend::~FileBackend()
 #define DSG_CONFIG "org.desktopspec.ConfigManager"
 #define DSG_CONFIG_MANAGER "org.desktopspec.ConfigManager"
 
-class Q_DECL_HIDDEN DBusBackend : public DConfigBackend
+class Q_DECL_HIDDEN DBusBackend : public BuiltinBackend
 {
 public:
     explicit DBusBackend(DConfigPrivate* o):
@@ -310,6 +740,7 @@ public:
 
     static bool isServiceActivatable()
     {
+         DDBusCallSpan span(QDBusConnection::systemBus().interface(), "ListActivatableNames");
          const QDBusReply<QStringList> activatableNames = QDBusConnection::systemBus().interface()->
                  callWithArgumentList(QDBus::AutoDetect,
                  QLatin1String("ListActivatableNames"),
@@ -319,49 +750,108 @@ public:
          return activatableNames.value().contains(DSG_CONFIG);
     }
 
+    /*!
+    @~english
+      \internal
+
+        Whether the config service is registered or activatable, the result is shared in the process.
+        A positive result is kept, a negative one is checked again after a few seconds.
+     */
+    static bool isServiceAvailable()
+    {
+        static QMutex mutex;
+        static bool available = false;
+        static QElapsedTimer lastCheck;
+
+        QMutexLocker locker(&mutex);
+        if (available || (lastCheck.isValid() && lastCheck.elapsed() < 5000))
+            return available;
+
+        available = isServiceRegistered() || isServiceActivatable();
+        lastCheck.start();
+        return available;
+    }
+
     virtual bool isValid() const override
     {
-        return config && config->isValid();
+        return resolveConfig() && config->isValid();
     }
 
     /*!
     @~english
       \internal
 
-        Initialize the DBus connection, the call acquireManager dynamically obtains a configuration connection,
+        Request the DBus connection asynchronously, the call acquireManager dynamically obtains a configuration connection,
         The configuration file is then accessed through this configuration connection.
+        The reply is waited when the configuration connection is used firstly, so that creating
+        many configurations doesn't wait for the round trips one by one.
      */
     virtual bool load(const QString &/*appId*/) override
     {
-        if (config)
+        if (config || acquireCall)
             return true;
 
         qCDebug(cfLog, "Try acquire config manager object form DBus");
-        DSGConfig dsg_config(DSG_CONFIG, "/", QDBusConnection::systemBus());
-        QDBusPendingReply<QDBusObjectPath> dbus_reply = dsg_config.acquireManager(owner->appId, owner->name, owner->subpath);
+        QDBusMessage call = QDBusMessage::createMethodCall(DSG_CONFIG, "/", DSGConfig::staticInterfaceName(),
+                                                           QLatin1String("acquireManager"));
+        call << owner->appId << owner->name << owner->subpath;
+        acquireCall.reset(new QDBusPendingCall(DDBusCallSpan::trace(QDBusConnection::systemBus().asyncCall(call), call)));
+        return true;
+    }
+
+    bool resolveConfig() const
+    {
+        if (config || !acquireCall)
+            return config != nullptr;
+
+        QDBusPendingReply<QDBusObjectPath> dbus_reply = *acquireCall;
+        acquireCall.reset();
+        {
+            D_TRACE_SPAN("dconfig", "DBusBackend::acquireManager", owner->name);
+            DDBusCallSpan span(DSG_CONFIG, QStringLiteral("/"), DSGConfig::staticInterfaceName(), QStringLiteral("acquireManager"));
+            dbus_reply.waitForFinished();
+        }
         const QDBusObjectPath dbus_path = dbus_reply.value();
         const auto path = dbus_path.path(); // 显式拷贝，避免其它线程共用systemBus连接而修改dbus数据
         if (dbus_reply.isError() || path.isEmpty()) {
             qCWarning(cfLog, "Can't acquire config manager. error:\"%s\"", qPrintable(dbus_reply.error().message()));
             return false;
-        } else {
-            qCDebug(cfLog, "dbus path=\"%s\"", qPrintable(path));
-            config = new DSGConfigManager(DSG_CONFIG_MANAGER, path,
-                                           QDBusConnection::systemBus(), owner->q_func());
-            if (!config->isValid()) {
-                qCWarning(cfLog, "Can't acquire config path=\"%s\"", qPrintable(path));
-                config->deleteLater();
-                config = nullptr;
-                return false;
-            } else {
-                QObject::connect(config, &DSGConfigManager::valueChanged, owner->q_func(), &DConfig::valueChanged);
-            }
         }
+
+        qCDebug(cfLog, "dbus path=\"%s\"", qPrintable(path));
+        // use the unique name of the replier, it avoids the synchronous owner lookup of the well-known name.
+        const QString &replier = dbus_reply.reply().service();
+        config = new DSGConfigManager(replier.isEmpty() ? QString(DSG_CONFIG_MANAGER) : replier, path,
+                                      QDBusConnection::systemBus());
+        DConfig *q = owner->q_func();
+        if (config->thread() != q->thread())
+            config->moveToThread(q->thread());
+
+        if (!config->isValid()) {
+            qCWarning(cfLog, "Can't acquire config path=\"%s\"", qPrintable(path));
+            config->deleteLater();
+            config = nullptr;
+            return false;
+        }
+
+        if (cacheEnabled) {
+            // invalidate the cache before `DConfig::valueChanged` is emitted, it promises that receivers get the new value.
+            QObject::connect(config, &DSGConfigManager::valueChanged, q, [this](const QString &key) {
+                valueCache.remove(key);
+            });
+        }
+        QObject::connect(config, &DSGConfigManager::valueChanged, q, &DConfig::valueChanged);
+
+        // pre-warm the cache in one call.
+        if (cacheEnabled)
+            values(QStringList());
         return true;
     }
 
     virtual QStringList keyList() const override
     {
+        DDBusCallSpan span(config, "keyList");
+        DConfigIpcCall ipc;
         return config->keyList();
     }
 
@@ -401,17 +891,158 @@ public:
 
     virtual QVariant value(const QString &key, const QVariant &fallback) const override
     {
+        if (cacheEnabled) {
+            const auto iter = valueCache.constFind(key);
+            if (iter != valueCache.constEnd())
+                return iter.value();
+        }
+
+        DDBusCallSpan span(config, "value");
+        DConfigIpcCall ipc;
         auto reply = config->value(key);
         reply.waitForFinished();
         if (reply.isError()) {
             qWarning() << "value error key:" << key << ", error message:" << reply.error().message();
             return fallback;
         }
-        return decodeQDBusArgument(reply.value().variant());
+        const QVariant &result = decodeQDBusArgument(reply.value().variant());
+        if (cacheEnabled)
+            valueCache.insert(key, result);
+        return result;
+    }
+
+    virtual QVariantMap values(const QStringList &keys) const override
+    {
+        if (supportValues) {
+            DDBusCallSpan span(config, "values");
+            DConfigIpcCall ipc;
+            auto reply = config->values(keys);
+            reply.waitForFinished();
+            if (!reply.isError()) {
+                QVariantMap result = reply.value();
+                for (auto iter = result.begin(); iter != result.end(); ++iter) {
+                    iter.value() = decodeQDBusArgument(iter.value());
+                    if (cacheEnabled)
+                        valueCache.insert(iter.key(), iter.value());
+                }
+                return result;
+            }
+
+            if (reply.error().type() != QDBusError::UnknownMethod) {
+                qWarning() << "Failed to call `values`, keys:" << keys
+                           << ", error message:" << reply.error().message();
+                return QVariantMap();
+            }
+            // the config manager is older than the client, fallback to get them one by one.
+            qCDebug(cfLog, "The config manager doesn't support `values`.");
+            supportValues = false;
+        }
+        return BuiltinBackend::values(keys);
+    }
+
+    // The watcher is a child of the config manager, so it's deleted with the backend, and it's
+    // deleted when the thread stops. The future is canceled if the reply isn't delivered.
+    template<typename T>
+    QDBusPendingCallWatcher *watchCall(const QDBusPendingCall &call, QFutureInterface<T> result) const
+    {
+        auto watcher = new QDBusPendingCallWatcher(call, config);
+        QObject::connect(watcher, &QObject::destroyed, [result]() mutable {
+            if (!result.isFinished()) {
+                result.reportCanceled();
+                result.reportFinished();
+            }
+        });
+        QObject::connect(watcher->thread(), &QThread::finished, watcher, &QObject::deleteLater, Qt::DirectConnection);
+        return watcher;
+    }
+
+    virtual bool isPending() const override
+    {
+        return !config && acquireCall;
+    }
+
+    virtual QFuture<QVariant> valueAsync(const QString &key, const QVariant &fallback) const override
+    {
+        QFutureInterface<QVariant> result(QFutureInterfaceBase::Started);
+        if (!isPending()) {
+            requestValue(key, fallback, result);
+            return result.future();
+        }
+
+        // the first call doesn't wait for the config manager, the value is requested when it's acquired.
+        // The watcher is a child of the configuration, the future is canceled if it's destroyed before.
+        auto watcher = new QDBusPendingCallWatcher(*acquireCall, owner->q_func());
+        const auto cancel = QObject::connect(watcher, &QObject::destroyed, [result]() mutable {
+            result.reportCanceled();
+            result.reportFinished();
+        });
+        QObject::connect(watcher->thread(), &QThread::finished, watcher, &QObject::deleteLater, Qt::DirectConnection);
+        QObject::connect(watcher, &QDBusPendingCallWatcher::finished, watcher,
+                         [this, result, key, fallback, cancel](QDBusPendingCallWatcher *call) mutable {
+            QObject::disconnect(cancel);
+            call->deleteLater();
+            // the reply has arrived, it doesn't block.
+            if (!isValid()) {
+                qCWarning(cfLog, "DConfig is invalid of appid=%s name=%s, subpath=%s",
+                          qPrintable(owner->appId), qPrintable(owner->name), qPrintable(owner->subpath));
+                result.reportResult(fallback);
+                result.reportFinished();
+                return;
+            }
+            requestValue(key, fallback, result);
+        });
+        return result.future();
+    }
+
+    void requestValue(const QString &key, const QVariant &fallback, QFutureInterface<QVariant> result) const
+    {
+        if (cacheEnabled) {
+            const auto iter = valueCache.constFind(key);
+            if (iter != valueCache.constEnd()) {
+                result.reportResult(iter.value());
+                result.reportFinished();
+                return;
+            }
+        }
+
+        dconfigIpcCalls.add();
+        auto watcher = watchCall(config->value(key), result);
+        QObject::connect(watcher, &QDBusPendingCallWatcher::finished, watcher,
+                         [result, key, fallback](QDBusPendingCallWatcher *call) mutable {
+            QDBusPendingReply<QDBusVariant> reply = *call;
+            if (reply.isError()) {
+                qWarning() << "value error key:" << key << ", error message:" << reply.error().message();
+                result.reportResult(fallback);
+            } else {
+                result.reportResult(decodeQDBusArgument(reply.value().variant()));
+            }
+            result.reportFinished();
+            call->deleteLater();
+        });
+    }
+
+    virtual QFuture<void> setValueAsync(const QString &key, const QVariant &value) override
+    {
+        valueCache.remove(key);
+        QFutureInterface<void> result(QFutureInterfaceBase::Started);
+        dconfigIpcCalls.add();
+        auto watcher = watchCall(config->setValue(key, QDBusVariant(value)), result);
+        QObject::connect(watcher, &QDBusPendingCallWatcher::finished, watcher,
+                         [result, key](QDBusPendingCallWatcher *call) mutable {
+            QDBusPendingReply<> reply = *call;
+            if (reply.isError())
+                qCWarning(cfLog) << "Failed to setValue for the key:" << key
+                                 << ", error message:" << reply.error();
+            result.reportFinished();
+            call->deleteLater();
+        });
+        return result.future();
     }
 
     virtual bool isDefaultValue(const QString &key) const override
     {
+        DDBusCallSpan span(config, "isDefaultValue");
+        DConfigIpcCall ipc;
         auto reply = config->isDefaultValue(key);
         reply.waitForFinished();
         if (reply.isError()) {
@@ -424,6 +1055,9 @@ public:
 
     virtual void setValue(const QString &key, const QVariant &value) override
     {
+        valueCache.remove(key);
+        DDBusCallSpan span(config, "setValue");
+        DConfigIpcCall ipc;
         auto reply = config->setValue(key, QDBusVariant(value));
         reply.waitForFinished();
         if (reply.isError())
@@ -431,8 +1065,39 @@ public:
                              << ", error message:" << reply.error();
     }
 
+    virtual void setValues(const QVariantMap &values) override
+    {
+        if (values.isEmpty())
+            return;
+
+        for (auto iter = values.constBegin(); iter != values.constEnd(); ++iter)
+            valueCache.remove(iter.key());
+
+        if (supportSetValues) {
+            DDBusCallSpan span(config, "setValues");
+            DConfigIpcCall ipc;
+            auto reply = config->setValues(values);
+            reply.waitForFinished();
+            if (!reply.isError())
+                return;
+
+            if (reply.error().type() != QDBusError::UnknownMethod) {
+                qCWarning(cfLog) << "Failed to setValues for the keys:" << values.keys()
+                                 << ", error message:" << reply.error();
+                return;
+            }
+            // the config manager is older than the client, fallback to set them one by one.
+            qCDebug(cfLog, "The config manager doesn't support `setValues`.");
+            supportSetValues = false;
+        }
+        BuiltinBackend::setValues(values);
+    }
+
     virtual void reset(const QString &key) override
     {
+        valueCache.remove(key);
+        DDBusCallSpan span(config, "reset");
+        DConfigIpcCall ipc;
         auto reply = config->reset(key);
         reply.waitForFinished();
         if (reply.isError())
@@ -442,6 +1107,8 @@ public:
 
     virtual bool isReadOnly(const QString &key) const override
     {
+        DDBusCallSpan span(config, "permissions");
+        DConfigIpcCall ipc;
         auto reply = config->permissions(key);
         reply.waitForFinished();
         if (reply.isError()) {
@@ -458,14 +1125,37 @@ public:
     }
 
 private:
-    DSGConfigManager *config;
+    mutable DSGConfigManager *config;
+    mutable QScopedPointer<QDBusPendingCall> acquireCall;
     DConfigPrivate* owner;
+    bool supportSetValues = true;
+    mutable bool supportValues = true;
+    // the cache is filled on reading and invalidated by the config manager's `valueChanged`,
+    // it's enabled by `DSG_DCONFIG_DBUS_VALUE_CACHE=1`.
+    const bool cacheEnabled = qEnvironmentVariableIntValue("DSG_DCONFIG_DBUS_VALUE_CACHE") == 1;
+    mutable QHash<QString, QVariant> valueCache;
 };
 
 DBusBackend::~DBusBackend()
 {
+    if (acquireCall) {
+        // the manager object is acquired even if it isn't used.
+        QDBusPendingReply<QDBusObjectPath> reply = *acquireCall;
+        reply.waitForFinished();
+        if (!reply.isError() && !reply.value().path().isEmpty()) {
+            const QDBusMessage &release = QDBusMessage::createMethodCall(reply.reply().service(), reply.value().path(),
+                                                                         DSGConfigManager::staticInterfaceName(),
+                                                                         QLatin1String("release"));
+            QDBusConnection::systemBus().call(release, QDBus::NoBlock);
+        }
+    }
     if (config) {
         config->release();
+        if (config->thread() == QThread::currentThread()) {
+            delete config;
+        } else {
+            config->deleteLater();
+        }
     }
 }
 #endif //D_DISABLE_DBUS_CONFIG
@@ -532,9 +1222,115 @@ QSettingBackend::~QSettingBackend()
 
 DConfigPrivate::~DConfigPrivate()
 {
+    {
+        QMutexLocker locker(liveConfigsMutex());
+        liveConfigs().remove(this);
+    }
     backend.reset();
 }
 
+int DConfigPrivate::addSubscription(Subscription subscription, QObject *context)
+{
+    D_Q(DConfig);
+    const int id = ++lastSubscriptionId;
+    for (const auto &key : std::as_const(subscription.keys))
+        keySubscriptions[key].append(id);
+    if (!subscription.prefix.isNull())
+        prefixSubscriptions[subscription.prefix].append(id);
+
+    if (context) {
+        subscription.contextConnection = QObject::connect(context, &QObject::destroyed, q, [this, id]() {
+            removeSubscription(id);
+        });
+    }
+    subscriptions.insert(id, std::move(subscription));
+
+    if (!subscriptionConnection) {
+        subscriptionConnection = QObject::connect(q, &DConfig::valueChanged, q, [this](const QString &key) {
+            dispatchChange(key);
+        });
+    }
+    return id;
+}
+
+void DConfigPrivate::removeSubscription(int id)
+{
+    auto iter = subscriptions.find(id);
+    if (iter == subscriptions.end())
+        return;
+
+    auto unindex = [id](QHash<QString, QVector<int>> &index, const QString &key) {
+        auto item = index.find(key);
+        if (item == index.end())
+            return;
+        item.value().removeOne(id);
+        if (item.value().isEmpty())
+            index.erase(item);
+    };
+    for (const auto &key : std::as_const(iter.value().keys))
+        unindex(keySubscriptions, key);
+    if (!iter.value().prefix.isNull())
+        unindex(prefixSubscriptions, iter.value().prefix);
+
+    QObject::disconnect(iter.value().contextConnection);
+    subscriptions.erase(iter);
+
+    if (subscriptions.isEmpty()) {
+        QObject::disconnect(subscriptionConnection);
+        subscriptionConnection = {};
+    }
+}
+
+void DConfigPrivate::dispatchChange(const QString &key)
+{
+    D_Q(DConfig);
+    auto append = [this, &key](const QVector<int> &ids) {
+        for (int id : ids) {
+            auto &pending = subscriptions[id].pending;
+            if (!pending.contains(key))
+                pending.append(key);
+        }
+    };
+
+    bool matched = false;
+    const auto iter = keySubscriptions.constFind(key);
+    if (iter != keySubscriptions.constEnd()) {
+        append(iter.value());
+        matched = true;
+    }
+    for (auto prefix = prefixSubscriptions.constBegin(); prefix != prefixSubscriptions.constEnd(); ++prefix) {
+        if (key.startsWith(prefix.key())) {
+            append(prefix.value());
+            matched = true;
+        }
+    }
+
+    if (!matched || flushPending)
+        return;
+
+    flushPending = true;
+    QMetaObject::invokeMethod(q, [this]() {
+        flushSubscriptions();
+    }, Qt::QueuedConnection);
+}
+
+void DConfigPrivate::flushSubscriptions()
+{
+    flushPending = false;
+    // the callbacks may add or remove subscriptions.
+    const auto ids = subscriptions.keys();
+    for (int id : ids) {
+        auto iter = subscriptions.find(id);
+        if (iter == subscriptions.end() || iter.value().pending.isEmpty())
+            continue;
+
+        const QStringList keys = std::move(iter.value().pending);
+        iter.value().pending.clear();
+        const auto callback = iter.value().callback;
+        callback(keys);
+    }
+}
+
 /*!
 @~english
   \internal
@@ -546,6 +1342,7 @@ DConfigPrivate::~DConfigPrivate()
  */
 DConfigBackend *DConfigPrivate::getOrCreateBackend()
 {
+    D_TRACE_SPAN("dconfig", "DConfig::getOrCreateBackend", name);
     if (backend) {
         return backend.data();
     }
@@ -555,7 +1352,7 @@ DConfigBackend *DConfigPrivate::getOrCreateBackend()
     }
 #ifndef D_DISABLE_DCONFIG
 #ifndef D_DISABLE_DBUS_CONFIG
-    if (DBusBackend::isServiceRegistered() || DBusBackend::isServiceActivatable()) {
+    if (DBusBackend::isServiceAvailable()) {
         qCDebug(cfLog, "Fallback to DBus mode");
         backend.reset(new DBusBackend(this));
     }
@@ -569,6 +1366,27 @@ DConfigBackend *DConfigPrivate::getOrCreateBackend()
     return backend.data();
 }
 
+/*!
+@~english
+  \internal
+
+    @brief Replace the snapshot by a copy which contains the new value of \a key
+
+    The hash is copied for each change, the readers of the old snapshot keep it unchanged.
+ */
+void DConfigPrivate::updateSnapshot(const QString &key)
+{
+    const auto current = std::atomic_load(&valueSnapshot);
+    auto next = std::make_shared<QVariantHash>(current ? *current : QVariantHash());
+    const QVariant &value = backend->value(key, QVariant());
+    if (value.isValid()) {
+        next->insert(key, value);
+    } else {
+        next->remove(key);
+    }
+    std::atomic_store(&valueSnapshot, std::shared_ptr<const QVariantHash>(std::move(next)));
+}
+
 /*!
 @~english
   \internal
@@ -585,7 +1403,7 @@ DConfigBackend *DConfigPrivate::createBackendByEnv()
 
 #ifndef D_DISABLE_DCONFIG
 #ifndef D_DISABLE_DBUS_CONFIG
-            if (DBusBackend::isServiceRegistered() || DBusBackend::isServiceActivatable()) {
+            if (DBusBackend::isServiceAvailable()) {
                 qCDebug(cfLog, "Fallback to DBus mode");
                 return new DBusBackend(this);
             }
@@ -697,8 +1515,8 @@ void DConfig::setAppId(const QString &appId)
 class DConfigThread : public QThread
 {
 public:
-    DConfigThread() {
-        setObjectName("DConfigGlobalThread");
+    explicit DConfigThread(const QString &name = QStringLiteral("DConfigGlobalThread")) {
+        setObjectName(name);
         start();
     }
 
@@ -717,6 +1535,148 @@ QThread *DConfig::globalThread()
     return _globalThread;
 }
 
+// the threads of workerThread() after the global one, they're started when first handed out.
+class DConfigWorkerPool
+{
+public:
+    DConfigWorkerPool()
+    {
+        bool ok = false;
+        const int count = qEnvironmentVariableIntValue("DTK_DCONFIG_WORKER_THREADS", &ok);
+        if (ok)
+            setCount(count);
+    }
+
+    ~DConfigWorkerPool()
+    {
+        qDeleteAll(threads);
+    }
+
+    void setCount(int value)
+    {
+        QMutexLocker locker(&mutex);
+        count = qBound(1, value, MaxCount);
+    }
+
+    QThread *next()
+    {
+        QMutexLocker locker(&mutex);
+        const int index = cursor++ % count;
+        if (index == 0)
+            return _globalThread;
+
+        while (threads.size() < index)
+            threads << new DConfigThread(QStringLiteral("DConfigWorkerThread%1").arg(threads.size() + 1));
+        return threads.at(index - 1);
+    }
+
+    static constexpr int MaxCount = 16;
+    QMutex mutex;
+    int count = 1;
+    uint cursor = 0;
+    QList<DConfigThread *> threads;
+};
+
+Q_GLOBAL_STATIC(DConfigWorkerPool, _workerPool)
+
+/*!
+@~english
+ * @brief A thread of the DConfig worker pool, the threads are handed out in turn.
+
+ * The objects generated by dconfig2cpp are created in it by default, each object stays in the
+ * thread it's given, so the configurations are initialized in parallel by the threads of the pool.
+ * The first thread is globalThread(), with the default count of 1 it's always returned.
+ * @return A running thread, it's released when the application exits.
+ * @sa setWorkerThreadCount()
+ */
+QThread *DConfig::workerThread()
+{
+    return _workerPool->next();
+}
+
+/*!
+@~english
+ * @brief Set the number of the threads handed out by workerThread() to \a count, from 1 to 16.
+
+ * It's 1 by default, or the value of the environment variable `DTK_DCONFIG_WORKER_THREADS`.
+ * The threads already handed out keep running, the objects in them aren't moved.
+ */
+void DConfig::setWorkerThreadCount(int count)
+{
+    _workerPool->setCount(count);
+}
+
+/*!
+@~english
+ * @brief The number of the threads handed out by workerThread().
+ */
+int DConfig::workerThreadCount()
+{
+    QMutexLocker locker(&_workerPool->mutex);
+    return _workerPool->count;
+}
+
+/*!
+@~english
+ * @brief The statistics of the live DConfig objects of the process, one map for each of them.
+
+ * The maps contain "appId", "name", "subpath", "backend", "loadMsecs" which is the time the
+ * constructor spent in loading, and "reads" and "writes" which count the calls of the value
+ * and setValue functions if `DSG_DCONFIG_STATISTICS=1` is set when the object is created, otherwise
+ * they're 0, so are the counters "dconfig.reads" and "dconfig.writes" of DPerfCounters. For the file backend they also contain "keyCount", "metaBytes",
+ * the size of the meta and override files, and "cacheBytes", the size of the cached values
+ * in json, they're -1 for the other backends. The configurations loaded from the same files
+ * are shared, so their sizes are reported by each of them.
+ * @note It's safe to call from any thread.
+ * @sa exportStatistics()
+ */
+QList<QVariantMap> DConfig::statistics()
+{
+    QList<QVariantMap> result;
+    QMutexLocker locker(liveConfigsMutex());
+    result.reserve(liveConfigs().size());
+    for (const DConfigPrivate *d : std::as_const(liveConfigs())) {
+        int keyCount = -1;
+        qint64 metaBytes = -1;
+        qint64 cacheBytes = -1;
+#ifndef D_DISABLE_DCONFIG
+        if (auto backend = dynamic_cast<const FileBackend *>(d->backend.data())) {
+            if (backend->isValid())
+                backend->footprint(&keyCount, &metaBytes, &cacheBytes);
+        }
+#endif
+        result << QVariantMap {
+            {QStringLiteral("appId"), d->appId},
+            {QStringLiteral("name"), d->name},
+            {QStringLiteral("subpath"), d->subpath},
+            {QStringLiteral("backend"), d->backendName},
+            {QStringLiteral("loadMsecs"), d->loadNsecs / 1000000.0},
+            {QStringLiteral("reads"), d->reads.load(std::memory_order_relaxed)},
+            {QStringLiteral("writes"), d->writes.load(std::memory_order_relaxed)},
+            {QStringLiteral("keyCount"), keyCount},
+            {QStringLiteral("metaBytes"), metaBytes},
+            {QStringLiteral("cacheBytes"), cacheBytes},
+        };
+    }
+    return result;
+}
+
+/*!
+@~english
+ * @brief Register the action "dconfig-statistics" to \a interface, it returns statistics() in json.
+ */
+void DConfig::exportStatistics(DUtil::DExportedInterface *interface)
+{
+    interface->registerAction(QStringLiteral("dconfig-statistics"),
+                              QStringLiteral("The statistics of the live DConfig objects"),
+                              [](const QString &) -> QVariant {
+        QJsonArray array;
+        for (const auto &item : DConfig::statistics())
+            array << QJsonObject::fromVariantMap(item);
+        return QString::fromUtf8(QJsonDocument(array).toJson(QJsonDocument::Compact));
+    });
+}
+
 /*!
 @~english
  * @brief Use custom configuration policy backend to construct objects
@@ -740,9 +1700,16 @@ DConfig::DConfig(DConfigBackend *backend, const QString &appId, const QString &n
         d->backend.reset(backend);
     }
 
+    QElapsedTimer timer;
+    timer.start();
     if (auto backend = d->getOrCreateBackend()) {
         backend->load(d->appId);
+        d->backendName = backend->name();
     }
+    d->loadNsecs = timer.nsecsElapsed();
+
+    QMutexLocker locker(liveConfigsMutex());
+    liveConfigs().insert(d);
 }
 
 /*!
@@ -809,6 +1776,7 @@ bool DConfig::isDefaultValue(const QString &key) const
 QVariant DConfig::value(const QString &key, const QVariant &fallback) const
 {
     D_DC(DConfig);
+    d->countRead();
     if (d->invalid())
         return fallback;
 
@@ -824,12 +1792,107 @@ QVariant DConfig::value(const QString &key, const QVariant &fallback) const
 void DConfig::setValue(const QString &key, const QVariant &value)
 {
     D_D(DConfig);
+    d->countWrite();
     if (d->invalid())
         return;
 
     d->backend->setValue(key, value);
 }
 
+/*!
+@~english
+ * @brief Get the values of multiple configuration items at once
+ * @param keys Configuration item names, all configuration items are returned if it's empty
+ * @return Configuration item names and their values
+ * @note The DBus backend fetches all values in one call.
+ */
+QVariantMap DConfig::values(const QStringList &keys) const
+{
+    D_DC(DConfig);
+    d->countRead();
+    if (d->invalid())
+        return QVariantMap();
+
+    return d->values(keys);
+}
+
+/*!
+@~english
+ * @brief Get the corresponding value asynchronously according to the configuration item name
+ * @param key Configuration Item Name
+ * @param fallback The default value provided after the configuration item value is not obtained
+ * @return The future is ready immediately for the file backend, a custom backend and for a value cached by the DBus backend,
+ * otherwise it's finished when the reply arrives
+ * @note The DBus backend delivers the reply in the event loop of the thread of the configuration, the future
+ * is canceled if the configuration is destroyed or the thread stops before the reply arrives. The first call
+ * doesn't wait for the config manager to be acquired either, the value is requested after that.
+ */
+QFuture<QVariant> DConfig::valueAsync(const QString &key, const QVariant &fallback) const
+{
+    D_DC(DConfig);
+    d->countRead();
+    auto builtin = dynamic_cast<const BuiltinBackend *>(d->backend.data());
+    // a pending backend is checked when it's ready, e.g. the DBus backend acquires the config manager
+    if (builtin && builtin->isPending())
+        return builtin->valueAsync(key, fallback);
+
+    if (d->invalid()) {
+        QFutureInterface<QVariant> result(QFutureInterfaceBase::Started);
+        result.reportResult(fallback);
+        result.reportFinished();
+        return result.future();
+    }
+
+    if (builtin)
+        return builtin->valueAsync(key, fallback);
+    return BuiltinBackend::valueReady(d->backend.data(), key, fallback);
+}
+
+/*!
+@~english
+ * @brief Set the value asynchronously according to the configuration item name
+ * @param key Configuration Item Name
+ * @param value Values that need to be updated
+ * @return The future is finished when the value is written, it's canceled as the one of valueAsync()
+ * @sa DConfig::valueAsync()
+ */
+QFuture<void> DConfig::setValueAsync(const QString &key, const QVariant &value)
+{
+    D_D(DConfig);
+    d->countWrite();
+    if (d->invalid()) {
+        QFutureInterface<void> result(QFutureInterfaceBase::Started);
+        result.reportFinished();
+        return result.future();
+    }
+
+    if (auto backend = dynamic_cast<BuiltinBackend *>(d->backend.data()))
+        return backend->setValueAsync(key, value);
+    return BuiltinBackend::setValueReady(d->backend.data(), key, value);
+}
+
+/*!
+@~english
+ * @brief Set the values of multiple configuration items in one transaction
+ * @param values Configuration item names and the values that need to be updated
+ * @note `valueChanged` is emitted for each changed item after all values are written, a custom
+ * backend writes the values one by one.
+ */
+void DConfig::setValues(const QVariantMap &values)
+{
+    D_D(DConfig);
+    d->countWrite();
+    if (d->invalid())
+        return;
+
+    if (auto backend = dynamic_cast<BuiltinBackend *>(d->backend.data())) {
+        backend->setValues(values);
+        return;
+    }
+    for (auto iter = values.constBegin(); iter != values.constEnd(); ++iter)
+        d->backend->setValue(iter.key(), iter.value());
+}
+
 /*!
 @~english
  * @brief Set the default value corresponding to its configuration item. This value is overridden by the override mechanism. It is not necessarily the value defined in the meta in this configuration file
@@ -838,6 +1901,7 @@ void DConfig::setValue(const QString &key, const QVariant &value)
 void DConfig::reset(const QString &key)
 {
     D_D(DConfig);
+    d->countWrite();
     if (d->invalid())
         return;
 
@@ -859,6 +1923,130 @@ bool DConfig::isReadOnly(const QString &key) const
     return d->backend->isReadOnly(key);
 }
 
+/*!
+@~english
+ * @brief Enable the immutable snapshot of all values, which can be read by any thread
+ * @param enabled Whether to maintain the snapshot
+ * @note It should be called in the thread of DConfig. The snapshot is replaced by a copy with the new
+ * value after a value is changed, so a reader never sees a partial update. It isn't lock-free, the
+ * snapshot is loaded and replaced under a short lock of the standard library, and each change copies
+ * all values, so it suits the configurations whose values are read often and changed rarely.
+ * @sa DConfig::snapshot()
+ */
+void DConfig::setSnapshotEnabled(bool enabled)
+{
+    D_D(DConfig);
+    if (isSnapshotEnabled() == enabled)
+        return;
+
+    if (!enabled) {
+        disconnect(d->snapshotConnection);
+        std::atomic_store(&d->valueSnapshot, std::shared_ptr<const QVariantHash>());
+        return;
+    }
+
+    if (d->invalid())
+        return;
+
+    const QVariantMap &values = d->values(QStringList());
+    auto snapshot = std::make_shared<QVariantHash>();
+    snapshot->reserve(values.size());
+    for (auto iter = values.constBegin(); iter != values.constEnd(); ++iter)
+        snapshot->insert(iter.key(), iter.value());
+
+    std::atomic_store(&d->valueSnapshot, std::shared_ptr<const QVariantHash>(std::move(snapshot)));
+    d->snapshotConnection = connect(this, &DConfig::valueChanged, this, [d](const QString &key) {
+        d->updateSnapshot(key);
+    });
+}
+
+/*!
+@~english
+ * @brief Whether the snapshot is enabled
+ */
+bool DConfig::isSnapshotEnabled() const
+{
+    D_DC(DConfig);
+    return std::atomic_load(&d->valueSnapshot) != nullptr;
+}
+
+/*!
+@~english
+ * @brief Return the snapshot of all values, it's thread-safe
+ * @return An empty hash if the snapshot isn't enabled
+ * @sa DConfig::setSnapshotEnabled()
+ */
+QVariantHash DConfig::snapshot() const
+{
+    D_DC(DConfig);
+    const auto current = std::atomic_load(&d->valueSnapshot);
+    return current ? *current : QVariantHash();
+}
+
+/*!
+@~english
+ * @brief Get the value from the snapshot, it's thread-safe
+ * @param key Configuration Item Name
+ * @param fallback The default value if the snapshot isn't enabled or doesn't contain the \a key
+ */
+QVariant DConfig::snapshotValue(const QString &key, const QVariant &fallback) const
+{
+    D_DC(DConfig);
+    const auto current = std::atomic_load(&d->valueSnapshot);
+    return current ? current->value(key, fallback) : fallback;
+}
+
+/*!
+@~english
+ * @brief Subscribe the changes of the \a keys, the changed keys are delivered in batch
+ * @param keys The configuration items to subscribe
+ * @param context The subscription is removed when the \a context is destroyed, it can be nullptr
+ * @param callback It's called once per event loop iteration with all changed keys of the subscription
+ * @return The id of the subscription, it's used by DConfig::unsubscribe()
+ * @note The \a callback is called in the thread of the DConfig.
+ */
+int DConfig::subscribeKeys(const QStringList &keys, QObject *context,
+                           std::function<void(const QStringList &)> callback)
+{
+    D_D(DConfig);
+    DConfigPrivate::Subscription subscription;
+    subscription.keys = keys;
+    subscription.keys.removeDuplicates();
+    subscription.callback = std::move(callback);
+    return d->addSubscription(std::move(subscription), context);
+}
+
+/*!
+@~english
+ * @brief Subscribe the changes of the keys starting with \a prefix, the changed keys are delivered in batch
+ * @param prefix The prefix of the configuration items to subscribe, an empty prefix matches all keys
+ * @param context The subscription is removed when the \a context is destroyed, it can be nullptr
+ * @param callback It's called once per event loop iteration with all changed keys of the subscription
+ * @return The id of the subscription, it's used by DConfig::unsubscribe()
+ * @sa DConfig::subscribeKeys()
+ */
+int DConfig::subscribePrefix(const QString &prefix, QObject *context,
+                             std::function<void(const QStringList &)> callback)
+{
+    D_D(DConfig);
+    DConfigPrivate::Subscription subscription;
+    // an empty prefix is valid, it isn't null.
+    subscription.prefix = prefix.isNull() ? QString("") : prefix;
+    subscription.callback = std::move(callback);
+    return d->addSubscription(std::move(subscription), context);
+}
+
+/*!
+@~english
+ * @brief Remove the subscription, the pending changes of it are dropped
+ * @param id The id returned by DConfig::subscribeKeys() or DConfig::subscribePrefix()
+ */
+void DConfig::unsubscribe(int id)
+{
+    D_D(DConfig);
+    d->removeSubscription(id);
+}
+
 /*!
 @~english
  * @brief Return configuration file name
@@ -5,6 +5,7 @@
 #include "dconfigfile.h"
 
 #include "dobject_p.h"
+#include "dtracespan_p.h"
 #include "filesystem/dstandardpaths.h"
 
 #include <QFile>
@@ -20,9 +21,27 @@
 #include <QDirIterator>
 #include <QCollator>
 #include <QDateTime>
-
+#include <QDataStream>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QTimer>
+#include <QMutex>
+#include <QSet>
+#include <QAtomicInt>
+#include <QThread>
+
+#include <functional>
+#include <limits>
+#include <utility>
+
+#include <errno.h>
+#include <string.h>
 #include <unistd.h>
 #include <pwd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
 
 // https://gitlabwh.uniontech.com/wuhan/se/deepin-specifications/-/issues/3
 
@@ -62,6 +81,180 @@ inline static bool isValidAppId(const QString& appId)
     QRegularExpressionMatch match = regex.match(appId);
     return match.hasMatch();
 }
+/*!
+@~english
+  \internal
+
+    @brief Process-wide cache of the directory listings used by the path resolution.
+
+    The meta and override lookups of every configuration probe the same DSG directories,
+    the listing of a directory is read once and kept until inotify reports a change of it.
+    A missing directory is cached too, and it's invalidated by the changes of the nearest
+    existing ancestor. A directory which can't be watched isn't cached. The pending events
+    are drained before every lookup, so a lookup always sees the changes made before it.
+
+    It takes an inotify instance of the process, so it's only used if `DSG_DCONFIG_DIR_CACHE=1`.
+ */
+class Q_DECL_HIDDEN DConfigDirCache {
+public:
+    static DConfigDirCache *instance()
+    {
+        static DConfigDirCache cache;
+        return &cache;
+    }
+
+    bool fileExists(const QString &dir, const QString &name)
+    {
+        if (!isEnabled())
+            return QFile::exists(QDir(dir).filePath(name));
+
+        QMutexLocker locker(&mutex);
+        if (!ensureInotify())
+            return QFile::exists(QDir(dir).filePath(name));
+
+        drainEvents();
+        const Entry &item = entry(QDir::cleanPath(dir));
+        return item.exists && item.files.contains(name);
+    }
+
+    bool dirExists(const QString &dir)
+    {
+        if (!isEnabled())
+            return QDir(dir).exists();
+
+        QMutexLocker locker(&mutex);
+        if (!ensureInotify())
+            return QDir(dir).exists();
+
+        drainEvents();
+        return entry(QDir::cleanPath(dir)).exists;
+    }
+
+private:
+    struct Entry {
+        bool exists = false;
+        // the names of the entries which aren't directories.
+        QSet<QString> files;
+    };
+
+    DConfigDirCache() = default;
+
+    ~DConfigDirCache()
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+
+    static inline bool isEnabled()
+    {
+        return qEnvironmentVariableIntValue("DSG_DCONFIG_DIR_CACHE") == 1;
+    }
+
+    // the inotify instance is created at the first lookup, it's tried once.
+    bool ensureInotify()
+    {
+        if (fd < 0 && !inotifyFailed) {
+            fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            inotifyFailed = fd < 0;
+        }
+        return fd >= 0;
+    }
+
+    Entry entry(const QString &path)
+    {
+        auto iter = entries.constFind(path);
+        if (iter != entries.constEnd())
+            return iter.value();
+
+        Entry item;
+        bool watched = false;
+        const QByteArray &encoded = QFile::encodeName(path);
+        if (DIR *dir = opendir(encoded.constData())) {
+            // watched before it's read, so the changes in the meantime aren't missed.
+            watched = watch(path);
+            item.exists = true;
+            while (struct dirent *file = readdir(dir)) {
+                if (file->d_type == DT_DIR)
+                    continue;
+                if (file->d_type == DT_UNKNOWN || file->d_type == DT_LNK) {
+                    struct stat st;
+                    const QByteArray &filePath = encoded + '/' + file->d_name;
+                    // skip the broken links as QFile::exists does.
+                    if (::stat(filePath.constData(), &st) != 0 || S_ISDIR(st.st_mode))
+                        continue;
+                }
+                item.files.insert(QFile::decodeName(file->d_name));
+            }
+            closedir(dir);
+        } else {
+            // watch the nearest existing ancestor to know when it's created.
+            QString parent = path;
+            do {
+                parent = QFileInfo(parent).path();
+            } while (parent.size() > 1 && !QFileInfo(parent).isDir());
+            watched = watch(parent);
+        }
+
+        // the changes of it wouldn't be known, so it's read again at the next lookup.
+        if (watched)
+            entries.insert(path, item);
+        return item;
+    }
+
+    bool watch(const QString &path)
+    {
+        const int wd = inotify_add_watch(fd, QFile::encodeName(path).constData(),
+                                         IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                                         | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+        if (wd < 0)
+            return false;
+
+        watches.insert(wd, path);
+        return true;
+    }
+
+    void invalidate(const QString &path)
+    {
+        const QString &prefix = path.endsWith(QLatin1Char('/')) ? path : path + QLatin1Char('/');
+        for (auto iter = entries.begin(); iter != entries.end();) {
+            if (iter.key() == path || iter.key().startsWith(prefix)) {
+                iter = entries.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+
+    void drainEvents()
+    {
+        alignas(struct inotify_event) char buffer[4096];
+        ssize_t size;
+        while ((size = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char *ptr = buffer; ptr < buffer + size;) {
+                const auto event = reinterpret_cast<const struct inotify_event *>(ptr);
+                ptr += sizeof(struct inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    entries.clear();
+                    continue;
+                }
+                const auto iter = watches.constFind(event->wd);
+                if (iter == watches.constEnd())
+                    continue;
+                invalidate(iter.value());
+                if (event->mask & IN_IGNORED)
+                    watches.remove(event->wd);
+            }
+        }
+    }
+
+    int fd = -1;
+    bool inotifyFailed = false;
+    QMutex mutex;
+    QHash<QString, Entry> entries;
+    QHash<int, QString> watches;
+};
+
 /*!
 @~english
   \internal
@@ -90,7 +283,7 @@ inline QString getFile(const QString &baseDir, const QString &subpath, const QSt
     do {
         qCDebug(cfLog, "load json file from: \"%s\"", qPrintable(target_dir.path()));
 
-        if (QFile::exists(target_dir.filePath(name))) {
+        if (DConfigDirCache::instance()->fileExists(target_dir.path(), name)) {
             return target_dir.filePath(name);
         }
 
@@ -166,6 +359,7 @@ static DConfigFile::Version parseVersion(const QJsonObject &obj) {
 #define MAGIC_META QLatin1String("dsg.config.meta")
 #define MAGIC_OVERRIDE QLatin1String("dsg.config.override")
 #define MAGIC_CACHE QLatin1String("dsg.config.cache")
+#define MAGIC_PREFETCH QLatin1String("dsg.config.prefetch")
 
 static const uint InvalidUID = 0xFFFF;
 
@@ -221,6 +415,18 @@ inline static QString getUserName(const uint uid) {
     \value ReadWrite Overwrite the configuration item as readable and writable.
 */
 
+/*!
+@~english
+    @enum DConfigFile::Durability
+
+    How far a saved cache file is forced to the storage, it's always replaced atomically,
+    a crash leaves either the old or the new content.
+    \value NoSync The content is left to the page cache, it's the cheapest one for frequent writes.
+    \value DataSync The content is synchronized by fdatasync before the file is replaced, it's the default.
+    \value FullSync As DataSync, and the directory is synchronized after the file is replaced,
+    so that the new file survives a power loss.
+*/
+
 /*!
 @~english
     @enum DConfigFile::Visibility
@@ -300,6 +506,20 @@ struct DConfigKey {
     QString subpath;
 };
 
+// interned names of the attributes, it avoids constructing a QString for every access.
+namespace DConfigAttribute {
+static const QString Value = QStringLiteral("value");
+static const QString Serial = QStringLiteral("serial");
+static const QString Flags = QStringLiteral("flags");
+static const QString Permissions = QStringLiteral("permissions");
+static const QString Visibility = QStringLiteral("visibility");
+static const QString Name = QStringLiteral("name");
+static const QString Description = QStringLiteral("description");
+static const QString Time = QStringLiteral("time");
+static const QString User = QStringLiteral("user");
+static const QString AppId = QStringLiteral("appid");
+}
+
 class Q_DECL_HIDDEN DConfigInfo {
 public:
     DConfigInfo()
@@ -309,10 +529,12 @@ public:
     DConfigInfo(const DConfigInfo &other)
     {
         this->values = other.values;
+        this->writes = other.writes;
     }
     DConfigInfo operator = (const DConfigInfo &other)
     {
         this->values = other.values;
+        this->writes = other.writes;
         return *this;
     }
     inline static bool checkSerial(const int metaSerial, const int cacheSerial)
@@ -327,7 +549,7 @@ public:
     DConfigFile::Visibility visibility(const QString &key) const
     {
         DConfigFile::Visibility p = DConfigFile::Private;
-        const auto &tmp = values[key][QLatin1String("visibility")].toString();
+        const auto &tmp = attribute(key, DConfigAttribute::Visibility).toString();
         if (tmp == QLatin1String("public"))
             p = DConfigFile::Public;
 
@@ -337,7 +559,7 @@ public:
     DConfigFile::Permissions permissions(const QString &key) const
     {
         DConfigFile::Permissions p = DConfigFile::ReadOnly;
-        const auto &tmp = values[key][QLatin1String("permissions")].toString();
+        const auto &tmp = attribute(key, DConfigAttribute::Permissions).toString();
         if (tmp == QLatin1String("readwrite"))
             p = DConfigFile::ReadWrite;
 
@@ -347,7 +569,7 @@ public:
     DConfigFile::Flags flags(const QString &key) const
     {
         DConfigFile::Flags flags = {};
-        const auto &tmp = values[key][QLatin1String("flags")];
+        const auto &tmp = attribute(key, DConfigAttribute::Flags);
         Q_FOREACH(const QString &flag, tmp.toStringList()) {
             if (flag == QLatin1String("nooverride")) {
                 flags |= DConfigFile::NoOverride;
@@ -364,59 +586,85 @@ public:
     QString displayName(const QString &key, const QLocale &locale) const
     {
         if (locale == QLocale::AnyLanguage)
-            return values[key][QLatin1String("name")].toString();
+            return attribute(key, DConfigAttribute::Name).toString();
 
-        return values[key].value(QString("name[%1]")
-                                 .arg(locale.name())).toString();
+        return attribute(key, localizedAttribute(DConfigAttribute::Name, locale)).toString();
     }
 
     QString description(const QString &key, const QLocale &locale) const
     {
         if (locale == QLocale::AnyLanguage)
-            return values[key][QLatin1String("description")].toString();
+            return attribute(key, DConfigAttribute::Description).toString();
 
-        return values[key].value(QString("description[%1]")
-                                 .arg(locale.name())).toString();
+        return attribute(key, localizedAttribute(DConfigAttribute::Description, locale)).toString();
     }
 
-    inline QVariant value(const QString &key) const
+    // "name[zh_CN]" or "description[zh_CN]", formatted once for the last locale asked in the thread.
+    static const QString &localizedAttribute(const QString &attribute, const QLocale &locale)
     {
-        return values[key][QLatin1String("value")];
+        thread_local QLocale lastLocale(QLocale::AnyLanguage);
+        thread_local QString lastName;
+        thread_local QString lastDescription;
+        if (lastName.isEmpty() || locale != lastLocale) {
+            const QString &localeName = locale.name();
+            lastLocale = locale;
+            lastName = DConfigAttribute::Name + QLatin1Char('[') + localeName + QLatin1Char(']');
+            lastDescription = DConfigAttribute::Description + QLatin1Char('[') + localeName + QLatin1Char(']');
+        }
+        return attribute == DConfigAttribute::Name ? lastName : lastDescription;
     }
 
-    inline int serial(const QString &key) const
+    // drop the translated names and descriptions of the other locales, they're loaded on demand.
+    void dropLocalized(const QString &keptLocale)
     {
-        bool status = false;
-        const int tmp = values[key][QLatin1String("serial")].toInt(&status);
-        if (status) {
-            return tmp;
+        for (auto iter = values.begin(); iter != values.end(); ++iter) {
+            QVariantHash &attributes = iter.value().attributes;
+            for (auto attr = attributes.begin(); attr != attributes.end();) {
+                const QString &name = attr.key();
+                const int bracket = name.indexOf(QLatin1Char('['));
+                if (bracket > 0 && name.endsWith(QLatin1Char(']'))
+                        && name.mid(bracket + 1, name.size() - bracket - 2) != keptLocale
+                        && (name.left(bracket) == DConfigAttribute::Name
+                            || name.left(bracket) == DConfigAttribute::Description)) {
+                    attr = attributes.erase(attr);
+                } else {
+                    ++attr;
+                }
+            }
         }
-        return -1;
     }
 
-    inline void setValue(const QString &key, const QVariant &value)
+    inline QVariant value(const QString &key) const
     {
-        values[key]["value"] = value;
+        const auto iter = values.constFind(key);
+        return iter != values.constEnd() ? iter.value().value : QVariant();
     }
 
-    inline void setSerial(const QString &key, const int &value)
+    inline int serial(const QString &key) const
     {
-        values[key]["serial"] = value;
+        const auto iter = values.constFind(key);
+        return iter != values.constEnd() ? iter.value().serial : -1;
     }
 
-    inline void setTime(const QString &key, const QString &value)
+    inline void setValue(const QString &key, const QVariant &value)
     {
-        values[key]["time"] = value;
+        values[key].value = value;
     }
 
-    inline void setUser(const QString &key, const uint &value)
+    inline void setSerial(const QString &key, const int &value)
     {
-        values[key]["user"] = getUserName(value);
+        Item &item = values[key];
+        item.serial = value;
+        item.hasSerial = true;
     }
 
-    inline void setAppId(const QString &key, const QString &value)
+    // the time and user are formatted when it's serialized, so that writing doesn't allocate memory.
+    inline void setWriteInfo(const QString &key, const qint64 time, const uint uid, const QString &appid)
     {
-        values[key]["appid"] = value;
+        WriteInfo &info = writes[key];
+        info.time = time;
+        info.uid = uid;
+        info.appId = appid;
     }
 
     inline QStringList keyList() const
@@ -432,41 +680,184 @@ public:
     inline void remove(const QString &key)
     {
         values.remove(key);
+        writes.remove(key);
     }
 
     inline bool update(const QString &key, const QVariantHash &value)
     {
-        if (!value.contains("value")) {
+        if (!value.contains(DConfigAttribute::Value)) {
             return false;
         }
-        values[key] = value;
+        values[key] = Item::fromHash(value);
+        writes.remove(key);
         return true;
     }
 
     inline bool updateValue(const QString &key, const QJsonValue &value)
     {
-        return overrideValue(key, "value", value);
+        return overrideValue(key, DConfigAttribute::Value, value);
     }
 
     inline void updateSerial(const QString &key, const QJsonValue &value)
     {
-        overrideValue(key, "serial", value);
+        overrideValue(key, DConfigAttribute::Serial, value);
     }
 
     inline void updatePermissions(const QString &key, const QJsonValue &value)
     {
-        overrideValue(key, "permissions", value);
+        overrideValue(key, DConfigAttribute::Permissions, value);
     }
 
-    QJsonObject content() const
+    inline void serialize(QDataStream &stream) const
     {
-        QJsonObject contents;
-        for (auto i = values.constBegin(); i != values.constEnd(); ++i) {
-            contents[i.key()] = QJsonObject::fromVariantHash(i.value());
+        stream << materialized();
+    }
+
+    inline bool deserialize(QDataStream &stream)
+    {
+        QHash<QString, QVariantHash> tmp;
+        stream >> tmp;
+        if (stream.status() != QDataStream::Ok)
+            return false;
+        values.clear();
+        values.reserve(tmp.size());
+        for (auto iter = tmp.constBegin(); iter != tmp.constEnd(); ++iter)
+            values.insert(iter.key(), Item::fromHash(iter.value()));
+        writes.clear();
+        return true;
+    }
+
+    /*!
+    @~english
+      \internal
+
+        @brief Write the members of the "contents" object key by key, it doesn't build the whole document.
+     */
+    bool writeContent(QIODevice *device, QJsonDocument::JsonFormat format) const
+    {
+        const bool compact = format == QJsonDocument::Compact;
+        QStringList keys = values.keys();
+        std::sort(keys.begin(), keys.end());
+
+        bool first = true;
+        QHash<uint, QString> userNames;
+        for (const auto &key : std::as_const(keys)) {
+            QVariantHash item = values.value(key).toHash();
+            materialize(key, item, userNames);
+
+            // serialize an object with the single item, so that the key is escaped by Qt.
+            QByteArray json = QJsonDocument(QJsonObject{{key, QJsonObject::fromVariantHash(item)}}).toJson(format);
+            if (compact) {
+                json = json.mid(1, json.size() - 2);
+            } else {
+                // "{\n    \"key\": {...}\n}\n", and nested in "contents" with one more level of indentation.
+                json = json.mid(2, json.size() - 5);
+                json.replace('\n', "\n    ");
+                json.prepend("    ");
+            }
+            if (!first)
+                json.prepend(compact ? "," : ",\n");
+            first = false;
+
+            if (device->write(json) != json.size())
+                return false;
         }
-        return contents;
+        if (!compact && !keys.isEmpty())
+            return device->write("\n") == 1;
+        return true;
     }
 private:
+    struct WriteInfo {
+        qint64 time = 0;
+        uint uid = 0;
+        QString appId;
+    };
+
+    // the value and the serial are kept out of the attributes, they're read for every lookup.
+    struct Item {
+        QVariant value;
+        int serial = -1;
+        bool hasSerial = false;
+        QVariantHash attributes;
+
+        static Item fromHash(QVariantHash hash)
+        {
+            Item item;
+            item.value = hash.take(DConfigAttribute::Value);
+            const auto serial = hash.constFind(DConfigAttribute::Serial);
+            if (serial != hash.constEnd()) {
+                item.setSerial(serial.value());
+                hash.erase(serial);
+            }
+            item.attributes = std::move(hash);
+            return item;
+        }
+
+        QVariantHash toHash() const
+        {
+            QVariantHash hash(attributes);
+            hash.insert(DConfigAttribute::Value, value);
+            if (hasSerial)
+                hash.insert(DConfigAttribute::Serial, serial);
+            return hash;
+        }
+
+        void setAttribute(const QString &subkey, const QVariant &attribute)
+        {
+            if (subkey == DConfigAttribute::Value) {
+                value = attribute;
+            } else if (subkey == DConfigAttribute::Serial) {
+                setSerial(attribute);
+            } else {
+                attributes.insert(subkey, attribute);
+            }
+        }
+
+        void setSerial(const QVariant &attribute)
+        {
+            bool status = false;
+            const int tmp = attribute.toInt(&status);
+            serial = status ? tmp : -1;
+            hasSerial = true;
+        }
+    };
+
+    inline QVariant attribute(const QString &key, const QString &subkey) const
+    {
+        const auto iter = values.constFind(key);
+        if (iter == values.constEnd())
+            return QVariant();
+        return iter.value().attributes.value(subkey);
+    }
+
+    // merge the write information into the attributes.
+    QHash<QString, QVariantHash> materialized() const
+    {
+        QHash<QString, QVariantHash> result;
+        result.reserve(values.size());
+        QHash<uint, QString> userNames;
+        for (auto iter = values.constBegin(); iter != values.constEnd(); ++iter) {
+            auto target = result.insert(iter.key(), iter.value().toHash());
+            materialize(iter.key(), target.value(), userNames);
+        }
+        return result;
+    }
+
+    void materialize(const QString &key, QVariantHash &item, QHash<uint, QString> &userNames) const
+    {
+        const auto iter = writes.constFind(key);
+        if (iter == writes.constEnd())
+            return;
+
+        auto user = userNames.constFind(iter.value().uid);
+        if (user == userNames.constEnd())
+            user = userNames.insert(iter.value().uid, getUserName(iter.value().uid));
+
+        item[DConfigAttribute::Time] = QDateTime::fromSecsSinceEpoch(iter.value().time).toString(Qt::ISODate);
+        item[DConfigAttribute::User] = user.value();
+        item[DConfigAttribute::AppId] = iter.value().appId;
+    }
+
     bool overrideValue(const QString &key, const QString &subkey, const QJsonValue &from) {
         const QJsonValue &v = from[subkey];
 
@@ -474,11 +865,70 @@ private:
             return false;
         }
 
-        values[key][subkey] = v.toVariant();
+        values[key].setAttribute(subkey, v.toVariant());
         return true;
     }
 
-    QHash<QString, QVariantHash> values;
+    QHash<QString, Item> values;
+    QHash<QString, WriteInfo> writes;
+};
+
+/*!
+@~english
+  \internal
+
+    @brief Pre-parsed meta attributes of all configuration items.
+
+    DConfigInfo keeps the raw json attributes, and the accessors of it parse strings
+    like "readwrite" or "nooverride" every time. This table is built once after the
+    meta and overrides are loaded, so that the hot accessors only need one hash lookup.
+ */
+class Q_DECL_HIDDEN DConfigMetaTable {
+public:
+    struct Entry {
+        QVariant value;
+        DConfigFile::Flags flags;
+        DConfigFile::Permissions permissions;
+        DConfigFile::Visibility visibility;
+        int serial;
+    };
+
+    void build(const DConfigInfo &info)
+    {
+        const QStringList &keys = info.keyList();
+        entries.clear();
+        index.clear();
+        entries.reserve(keys.size());
+        index.reserve(keys.size());
+        for (const auto &key : keys) {
+            index.insert(key, entries.size());
+            entries.append(Entry{info.value(key), info.flags(key), info.permissions(key),
+                                 info.visibility(key), info.serial(key)});
+        }
+    }
+
+    inline const Entry *entry(const QString &key) const
+    {
+        const auto iter = index.constFind(key);
+        if (iter == index.constEnd())
+            return nullptr;
+        return &entries.at(iter.value());
+    }
+
+    inline void clear()
+    {
+        entries.clear();
+        index.clear();
+    }
+
+    inline QStringList keys() const
+    {
+        return index.keys();
+    }
+
+private:
+    QVector<Entry> entries;
+    QHash<QString, int> index;
 };
 
 
@@ -622,6 +1072,152 @@ private:
     @return
 */
 
+static void appendFileStamp(QByteArray &out, const QString &path)
+{
+    const QByteArray &name = QFile::encodeName(path);
+    out.append(name).append('\0');
+
+    struct stat st;
+    if (::stat(name.constData(), &st) != 0) {
+        out.append("-\n");
+        return;
+    }
+    out.append(QByteArray::number(qulonglong(st.st_ino))).append(':')
+       .append(QByteArray::number(qlonglong(st.st_mtim.tv_sec))).append('.')
+       .append(QByteArray::number(qlonglong(st.st_mtim.tv_nsec))).append(':')
+       .append(QByteArray::number(qlonglong(st.st_size))).append('\n');
+}
+
+/*!
+@~english
+  \internal
+
+    @brief Binary snapshot of the merged result of a meta file and all of it's overrides.
+
+    The snapshot is stored in `$XDG_CACHE_HOME/dsg/configs-snapshot`, it's validated by
+    the inode, mtime and size of the meta file, of every override directory that's
+    searched and of every override file that's applied. When nothing has changed,
+    DConfigMetaImpl restores the values from the mapped snapshot without parsing json
+    or iterating the override directories. It writes to the cache of the user, so it's
+    only used if `DSG_DCONFIG_META_SNAPSHOT=1`, e.g. by the session of a desktop user.
+ */
+class Q_DECL_HIDDEN DConfigMetaSnapshot {
+public:
+    explicit DConfigMetaSnapshot(const DConfigKey &configKey, const QString &localPrefix)
+    {
+        if (qEnvironmentVariableIntValue("DSG_DCONFIG_META_SNAPSHOT") != 1)
+            return;
+
+        const QString &cacheHome = DStandardPaths::path(DStandardPaths::XDG::CacheHome);
+        if (cacheHome.isEmpty())
+            return;
+
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(QStringList{configKey.appId, configKey.fileName, configKey.subpath, localPrefix}
+                     .join(QLatin1Char('\n')).toUtf8());
+        path = QString("%1/dsg/configs-snapshot/%2.bin").arg(cacheHome, QString::fromLatin1(hash.result().toHex()));
+    }
+
+    inline bool isEnabled() const
+    {
+        return !path.isEmpty();
+    }
+
+    bool restore(const QByteArray &stamp, DConfigInfo &values, DConfigFile::Version &version,
+                 QString &keptLocale) const
+    {
+        if (!isEnabled())
+            return false;
+
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        // read the snapshot through the mapped memory, it avoids copying the file content.
+        const qint64 size = file.size();
+        uchar *data = size > 0 ? file.map(0, size) : nullptr;
+        if (!data)
+            return false;
+
+        const QByteArray &buffer = QByteArray::fromRawData(reinterpret_cast<const char *>(data), int(size));
+        QDataStream stream(buffer);
+        stream.setVersion(StreamVersion);
+
+        quint32 magic = 0, formatVersion = 0;
+        stream >> magic >> formatVersion;
+        if (magic != Magic || formatVersion != FormatVersion)
+            return false;
+
+        QByteArray storedStamp;
+        QStringList overrideFiles;
+        stream >> storedStamp >> overrideFiles;
+        if (stream.status() != QDataStream::Ok)
+            return false;
+
+        QByteArray currentStamp(stamp);
+        for (const auto &item : std::as_const(overrideFiles))
+            appendFileStamp(currentStamp, item);
+
+        if (currentStamp != storedStamp)
+            return false;
+
+        DConfigInfo tmp;
+        DConfigFile::Version tmpVersion {0, 0};
+        QString tmpLocale;
+        stream >> tmpVersion.major >> tmpVersion.minor >> tmpLocale;
+        if (!tmp.deserialize(stream) || !versionIsValid(tmpVersion))
+            return false;
+
+        values = tmp;
+        version = tmpVersion;
+        keptLocale = tmpLocale;
+        qCDebug(cfLog, "Restore meta from snapshot: \"%s\"", qPrintable(path));
+        return true;
+    }
+
+    void store(const QByteArray &stamp, const QList<QIODevice *> &overrides,
+               const DConfigInfo &values, const DConfigFile::Version &version,
+               const QString &keptLocale) const
+    {
+        if (!isEnabled())
+            return;
+
+        QStringList overrideFiles;
+        overrideFiles.reserve(overrides.size());
+        QByteArray storedStamp(stamp);
+        for (auto item : overrides) {
+            const QString &fileName = static_cast<QFile *>(item)->fileName();
+            overrideFiles << fileName;
+            appendFileStamp(storedStamp, fileName);
+        }
+
+        QDir().mkpath(QFileInfo(path).path());
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCDebug(cfLog, "Failed on saving meta snapshot: \"%s\", error message: \"%s\"",
+                    qPrintable(path), qPrintable(file.errorString()));
+            return;
+        }
+
+        QDataStream stream(&file);
+        stream.setVersion(StreamVersion);
+        stream << Magic << FormatVersion << storedStamp << overrideFiles;
+        stream << version.major << version.minor << keptLocale;
+        values.serialize(stream);
+
+        if (stream.status() != QDataStream::Ok || !file.commit()) {
+            qCDebug(cfLog, "Failed on saving meta snapshot: \"%s\"", qPrintable(path));
+        }
+    }
+
+private:
+    // "DCMS", DConfig Meta Snapshot
+    static constexpr quint32 Magic = 0x44434d53;
+    static constexpr quint32 FormatVersion = 2;
+    static constexpr QDataStream::Version StreamVersion = QDataStream::Qt_5_11;
+    QString path;
+};
+
 class Q_DECL_HIDDEN DConfigMetaImpl : public DConfigMeta {
     // DConfigMeta interface
 public:
@@ -634,23 +1230,29 @@ public:
     }
     inline virtual DConfigFile::Flags flags(const QString &key) const override
     {
-        return values.flags(key);
+        const auto item = table.entry(key);
+        return item ? item->flags : DConfigFile::Flags();
     }
     inline virtual DConfigFile::Permissions permissions(const QString &key) const override
     {
-        return values.permissions(key);
+        const auto item = table.entry(key);
+        return item ? item->permissions : DConfigFile::ReadOnly;
     }
     inline virtual DConfigFile::Visibility visibility(const QString &key) const override
     {
-        return values.visibility(key);
+        const auto item = table.entry(key);
+        return item ? item->visibility : DConfigFile::Private;
     }
     inline virtual int serial(const QString &key) const override
     {
-        return values.serial(key);
+        const auto item = table.entry(key);
+        return item ? item->serial : -1;
     }
     inline virtual QString description(const QString &key, const QLocale &locale) override
     {
-        return values.description(key, locale);
+        if (!isLocaleDropped(locale))
+            return values.description(key, locale);
+        return localizedStrings(locale).descriptions.value(key);
     }
     virtual DConfigFile::Version version() const override
     {
@@ -663,11 +1265,14 @@ public:
     }
     inline virtual QString displayName(const QString &key, const QLocale &locale) override
     {
-        return values.displayName(key, locale);
+        if (!isLocaleDropped(locale))
+            return values.displayName(key, locale);
+        return localizedStrings(locale).names.value(key);
     }
     inline virtual QVariant value(const QString &key) const override
     {
-        return values.value(key);
+        const auto item = table.entry(key);
+        return item ? item->value : QVariant();
     }
 
     QString metaPath(const QString &localPrefix, bool *useAppId) const override
@@ -699,6 +1304,7 @@ public:
 
     bool load(const QString &localPrefix) override
     {
+        D_TRACE_SPAN("dconfig", "DConfigMeta::load", configKey.fileName);
         if (!isValidAppId(configKey.appId)) {
             qCWarning(cfLog, "AppId is invalid, appId=%s", qPrintable(configKey.appId));
             return false;
@@ -715,7 +1321,19 @@ public:
         }
         qCDebug(cfLog, "Load meta file: \"%s\"", qPrintable(path));
 
-        QScopedPointer<QFile> meta(new QFile(path));
+        const DConfigMetaSnapshot snapshot(configKey, localPrefix);
+        QByteArray stamp;
+        // the parsed overrides aren't in the snapshot, they're needed to reload the overrides.
+        if (snapshot.isEnabled() && !keepOverrides) {
+            stamp = metaStamp(path, localPrefix, useAppIdForOverride);
+            if (snapshot.restore(stamp, values, m_version, keptLocale)) {
+                table.build(values);
+                overridesCached = false;
+                localizedSource = keptLocale.isEmpty() ? QString() : path;
+                otherLocales.clear();
+                return true;
+            }
+        }
 
         struct _ScopedPointer {
             explicit _ScopedPointer(const QList<QIODevice*> &list)
@@ -726,87 +1344,256 @@ public:
         };
         _ScopedPointer overrides(loadOverrides(localPrefix, useAppIdForOverride));
 
-        return load(meta.data(), overrides.m_list);
+        if (!loadFiles(path, overrides.m_list))
+            return false;
+
+        snapshot.store(stamp, overrides.m_list, values, m_version, keptLocale);
+        return true;
     }
 
     bool load(QIODevice *meta, const QList<QIODevice*> &overrides) override
     {
-        {
-            const QJsonDocument &doc = loadJsonFile(meta);
-            if (!doc.isObject())
-                return false;
+        return loadDevice(meta, overrides, QString());
+    }
 
-            // 检查标识
-            const QJsonObject &root = doc.object();
-            if (!checkMagic(root, MAGIC_META)) {
-                qCWarning(cfLog, "The meta magic does not match");
-                return false;
-            }
+    // the localized strings of the other locales are dropped if they can be read again from localizedPath.
+    bool loadDevice(QIODevice *meta, const QList<QIODevice*> &overrides, const QString &localizedPath)
+    {
+        table.clear();
+        overridesCached = false;
+        localizedSource = localizedPath;
+        keptLocale = localizedPath.isEmpty() ? QString() : QLocale().name();
+        otherLocales.clear();
+        if (!loadValues(meta, overrides))
+            return false;
 
-            // 检查版本兼容性
-            const auto &v = parseVersion(root);
-            if (!versionIsValid(v) || v.major > DConfigFile::supportedVersion().major) {
-                qCWarning(cfLog, "The meta version number does not match, "
-                                 "the file major version=%i, supported major version<=%i",
-                          v.major, DConfigFile::supportedVersion().major);
-                return false;
-            }
+        table.build(values);
+        return true;
+    }
 
-            m_version = v;
+    bool reloadOverrides(const QString &localPrefix, QStringList *changedKeys)
+    {
+        bool useAppIdForOverride = true;
+        const QString &path = metaPath(localPrefix, &useAppIdForOverride);
+        if (path.isEmpty()) {
+            qCWarning(cfLog, "Can't load meta file from local prefix: \"%s\"", qPrintable(localPrefix));
+            return false;
+        }
 
-            const auto &contents = root[QLatin1String("contents")].toObject();
-            auto i = contents.constBegin();
+        const DConfigMetaTable previous = table;
+        QList<QIODevice*> overrides = loadOverrides(localPrefix, useAppIdForOverride);
+        bool status = true;
 
-            // 初始化原始值
-            for (; i != contents.constEnd(); ++i) {
-                if (!values.update(i.key(), i.value().toObject().toVariantHash())) {
-                    qWarning() << "key:" << i.key() << "has no value";
-                    return false;
+        QByteArray stamp;
+        appendFileStamp(stamp, path);
+        if (!overridesCached || stamp != metaFileStamp) {
+            // the meta file changed or it's restored from snapshot, need a full reload.
+            values = DConfigInfo();
+            status = loadFiles(path, overrides);
+        } else {
+            QVector<OverrideSource> sources;
+            sources.reserve(overrides.size());
+            for (auto override : overrides) {
+                const QString &fileName = static_cast<QFile *>(override)->fileName();
+                QByteArray fileStamp;
+                appendFileStamp(fileStamp, fileName);
+
+                auto cached = std::find_if(overrideSources.cbegin(), overrideSources.cend(),
+                                           [&](const OverrideSource &item) {
+                    return item.path == fileName && item.stamp == fileStamp;
+                });
+                if (cached != overrideSources.cend()) {
+                    sources << *cached;
+                } else {
+                    qCDebug(cfLog, "The override changed, file: \"%s\"", qPrintable(fileName));
+                    sources << parseOverride(override, fileName, fileStamp);
                 }
+
+                if (sources.last().status == OverrideSource::Stop)
+                    break;
             }
+            overrideSources = sources;
+            values = baseValues;
+            status = applyOverrides();
+            if (status)
+                table.build(values);
         }
-        // for override
-        Q_FOREACH(auto override, overrides) {
-            const QJsonDocument &doc = loadJsonFile(override);
-            if (doc.isObject()) {
-                const QJsonObject &root = doc.object();
-                if (!checkMagic(root, MAGIC_OVERRIDE)) {
-                    if (auto file = static_cast<QFile*>(override)) {
-                        qCWarning(cfLog, "The override magic does not match, file: \"%s\", error message: \"%s\"",
-                                  qPrintable(file->fileName()), qPrintable(file->errorString()));
-                    } else {
-                        qCWarning(cfLog, "The override magic does not match");
-                    }
-                    break; //TODO don't continue parse?
-                }
-                if (!checkVersion(root, m_version)) {
-                    qCWarning(cfLog, "The override version number does not match");
-                    break;
-                }
+        qDeleteAll(overrides);
 
-                if (auto file = static_cast<QFile*>(override)) {
-                    qCDebug(cfLog, "The override will be applied, file: \"%s\"", qPrintable(file->fileName()));
-                }
+        if (!status)
+            return false;
 
-                const auto &contents = root[QLatin1String("contents")].toObject();
-                auto i = contents.constBegin();
+        if (changedKeys) {
+            for (const auto &key : table.keys()) {
+                const auto item = table.entry(key);
+                const auto old = previous.entry(key);
+                if (!old || old->value != item->value || old->serial != item->serial
+                        || old->permissions != item->permissions) {
+                    changedKeys->append(key);
+                }
+            }
+            for (const auto &key : previous.keys()) {
+                if (!table.entry(key))
+                    changedKeys->append(key);
+            }
+        }
+        return true;
+    }
 
-                for (; i != contents.constEnd(); ++i) {
-                    if (!values.contains(i.key())) {
-                        qCWarning(cfLog, "The meta doesn't contain the override key: \"%s\".", qPrintable(i.key()));
-                        continue;
-                    }
-                    // 检查是否允许 override
-                    if (values.flags(i.key()) & DConfigFile::NoOverride)
-                        continue;
+    /*!
+    @~english
+      \internal
+
+        @brief The parsed content of an override file, it's kept to re-merge overrides without parsing unchanged files.
+     */
+    struct OverrideSource {
+        enum Status {
+            Applied,
+            Skipped,
+            Stop
+        };
+
+        QString path;
+        QByteArray stamp;
+        QJsonObject contents;
+        Status status = Skipped;
+    };
+
+    bool loadFiles(const QString &path, const QList<QIODevice*> &overrides)
+    {
+        QFile meta(path);
+        if (!loadDevice(&meta, overrides, path))
+            return false;
+
+        metaFileStamp.clear();
+        appendFileStamp(metaFileStamp, path);
+        overridesCached = keepOverrides;
+        return true;
+    }
+
+    bool loadValues(QIODevice *meta, const QList<QIODevice*> &overrides)
+    {
+        {
+            const QJsonDocument &doc = loadJsonFile(meta);
+            if (!doc.isObject())
+                return false;
+
+            // 检查标识
+            const QJsonObject &root = doc.object();
+            if (!checkMagic(root, MAGIC_META)) {
+                qCWarning(cfLog, "The meta magic does not match");
+                return false;
+            }
+
+            // 检查版本兼容性
+            const auto &v = parseVersion(root);
+            if (!versionIsValid(v) || v.major > DConfigFile::supportedVersion().major) {
+                qCWarning(cfLog, "The meta version number does not match, "
+                                 "the file major version=%i, supported major version<=%i",
+                          v.major, DConfigFile::supportedVersion().major);
+                return false;
+            }
+
+            m_version = v;
+
+            const auto &contents = root[QLatin1String("contents")].toObject();
+            auto i = contents.constBegin();
+
+            // 初始化原始值
+            for (; i != contents.constEnd(); ++i) {
+                if (!values.update(i.key(), i.value().toObject().toVariantHash())) {
+                    qWarning() << "key:" << i.key() << "has no value";
+                    return false;
+                }
+            }
+        }
+        if (!keptLocale.isEmpty())
+            values.dropLocalized(keptLocale);
+        if (keepOverrides)
+            baseValues = values;
+
+        // for override
+        overrideSources.clear();
+        overrideSources.reserve(overrides.size());
+        Q_FOREACH(auto override, overrides) {
+            QString fileName;
+            QByteArray fileStamp;
+            if (auto file = qobject_cast<QFile*>(override)) {
+                fileName = file->fileName();
+                appendFileStamp(fileStamp, fileName);
+            }
+            overrideSources << parseOverride(override, fileName, fileStamp);
+            if (overrideSources.last().status == OverrideSource::Stop)
+                break; //TODO don't continue parse?
+        }
+
+        const bool status = applyOverrides();
+        if (!keepOverrides)
+            overrideSources.clear();
+        return status;
+    }
+
+    OverrideSource parseOverride(QIODevice *override, const QString &fileName, const QByteArray &fileStamp) const
+    {
+        OverrideSource source;
+        source.path = fileName;
+        source.stamp = fileStamp;
+
+        const QJsonDocument &doc = loadJsonFile(override);
+        if (!doc.isObject())
+            return source;
+
+        const QJsonObject &root = doc.object();
+        if (!checkMagic(root, MAGIC_OVERRIDE)) {
+            if (auto file = static_cast<QFile*>(override)) {
+                qCWarning(cfLog, "The override magic does not match, file: \"%s\", error message: \"%s\"",
+                          qPrintable(file->fileName()), qPrintable(file->errorString()));
+            } else {
+                qCWarning(cfLog, "The override magic does not match");
+            }
+            source.status = OverrideSource::Stop;
+            return source;
+        }
+        if (!checkVersion(root, m_version)) {
+            qCWarning(cfLog, "The override version number does not match");
+            source.status = OverrideSource::Stop;
+            return source;
+        }
+
+        source.contents = root[QLatin1String("contents")].toObject();
+        source.status = OverrideSource::Applied;
+        return source;
+    }
+
+    // the overrides are applied to the current values, which are the values of the meta.
+    bool applyOverrides()
+    {
+        for (const auto &source : qAsConst(overrideSources)) {
+            if (source.status == OverrideSource::Stop)
+                break;
+            if (source.status == OverrideSource::Skipped)
+                continue;
+
+            if (!source.path.isEmpty()) {
+                qCDebug(cfLog, "The override will be applied, file: \"%s\"", qPrintable(source.path));
+            }
 
-                    if (!values.updateValue(i.key(), i.value())) {
-                        qWarning() << "key (override):" << i.key() << "has no value";
-                        return false;
-                    }
-                    values.updateSerial(i.key(), i.value());
-                    values.updatePermissions(i.key(), i.value());
+            auto i = source.contents.constBegin();
+            for (; i != source.contents.constEnd(); ++i) {
+                if (!values.contains(i.key())) {
+                    qCWarning(cfLog, "The meta doesn't contain the override key: \"%s\".", qPrintable(i.key()));
+                    continue;
                 }
+                // 检查是否允许 override
+                if (values.flags(i.key()) & DConfigFile::NoOverride)
+                    continue;
+
+                if (!values.updateValue(i.key(), i.value())) {
+                    qWarning() << "key (override):" << i.key() << "has no value";
+                    return false;
+                }
+                values.updateSerial(i.key(), i.value());
+                values.updatePermissions(i.key(), i.value());
             }
         }
 
@@ -858,63 +1645,153 @@ public:
      */
     QList<QIODevice *> loadOverrides(const QString &prefix, bool useAppId) const
     {
+        D_TRACE_SPAN("dconfig", "DConfigMeta::loadOverrides", configKey.fileName);
         auto filters = QDir::Files | QDir::NoDotAndDotDot | QDir::Readable;
         const QStringList nameFilters {"*" + FILE_SUFFIX};
 
-        QStringList dirs = allOverrideDirs(useAppId, prefix);
-
         QList<QIODevice*> list;
         list.reserve(50);
         QCollator collator(QLocale::English);
         collator.setNumericMode(true);
         collator.setIgnorePunctuation(true);
 
-        Q_FOREACH(const auto &dir, dirs) {
+        Q_FOREACH(const auto &dir, overrideSearchDirs(prefix, useAppId)) {
+            qCDebug(cfLog, "load override file from: \"%s\"", qPrintable(dir));
+
+            QDir target_dir(dir);
+            target_dir.setFilter(filters);
+            target_dir.setNameFilters(nameFilters);
+
+            QDirIterator iterator(target_dir);
+            QList<QIODevice*> sublist;
+            sublist.reserve(50);
+            while(iterator.hasNext()) {
+                sublist.append(new QFile(iterator.next()));
+            }
+
+            // 从小到大排序
+            std::sort(sublist.begin(), sublist.end(), [&collator](QIODevice *f1, QIODevice *f2){
+                if (collator.compare(static_cast<const QFile*>(f1)->fileName(),
+                                     static_cast<const QFile*>(f2)->fileName()) < 0)
+                    return true;
+                return false;
+            });
+
+            list = sublist + list;
+        }
+
+        return list;
+    }
+
+    /*!
+    @~english
+      \internal
+
+        @brief 按遍历顺序返回 loadOverrides 需要查找的所有目录,支持子目录查找机制
+     */
+    QStringList overrideSearchDirs(const QString &prefix, bool useAppId) const
+    {
+        QStringList result;
+        Q_FOREACH(const auto &dir, allOverrideDirs(useAppId, prefix)) {
             const QDir base_dir(QDir::cleanPath(dir));
 
-            if (!base_dir.exists())
+            if (!DConfigDirCache::instance()->dirExists(base_dir.path()))
                 continue;
 
             if (!subpathIsValid(configKey.subpath, base_dir))
                 continue;
 
             QDir target_dir = base_dir;
-            target_dir.setFilter(filters);
-            target_dir.setNameFilters(nameFilters);
-
             if (!configKey.subpath.isEmpty())
                 target_dir.cd(configKey.subpath.mid(1));
 
             do {
-                qCDebug(cfLog, "load override file from: \"%s\"", qPrintable(target_dir.path()));
-
-                QDirIterator iterator(target_dir);
-                QList<QIODevice*> sublist;
-                sublist.reserve(50);
-                while(iterator.hasNext()) {
-                    sublist.append(new QFile(iterator.next()));
-                }
-
-                // 从小到大排序
-                std::sort(sublist.begin(), sublist.end(), [&collator](QIODevice *f1, QIODevice *f2){
-                    if (collator.compare(static_cast<const QFile*>(f1)->fileName(),
-                                         static_cast<const QFile*>(f2)->fileName()) < 0)
-                        return true;
-                    return false;
-                });
-
-                list = sublist + list;
+                result << target_dir.path();
 
                 if (base_dir.path() == target_dir.path())
                     break;
             } while (target_dir.cdUp());
         }
+        return result;
+    }
 
-        return list;
+    /*!
+    @~english
+      \internal
+
+        @brief 生成 meta 文件及所有可能影响覆盖结果的目录的状态标识,用于校验快照
+     */
+    QByteArray metaStamp(const QString &metaFile, const QString &prefix, bool useAppId) const
+    {
+        QByteArray stamp;
+        appendFileStamp(stamp, metaFile);
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+        const QStringList &subdirs = configKey.subpath.split(QLatin1Char('/'), Qt::SkipEmptyParts);
+#else
+        const QStringList &subdirs = configKey.subpath.split(QLatin1Char('/'), QString::SkipEmptyParts);
+#endif
+        Q_FOREACH(const auto &dir, allOverrideDirs(useAppId, prefix)) {
+            QString path = QDir::cleanPath(dir);
+            appendFileStamp(stamp, path);
+            for (const auto &item : subdirs) {
+                path += QLatin1Char('/') + item;
+                appendFileStamp(stamp, path);
+            }
+        }
+        return stamp;
+    }
+
+    struct LocalizedStrings {
+        QHash<QString, QString> names;
+        QHash<QString, QString> descriptions;
+    };
+
+    inline bool isLocaleDropped(const QLocale &locale) const
+    {
+        return !localizedSource.isEmpty() && locale != QLocale::AnyLanguage && locale.name() != keptLocale;
+    }
+
+    // the names and descriptions of a locale other than the kept one, read from the meta file when first asked.
+    const LocalizedStrings &localizedStrings(const QLocale &locale)
+    {
+        const QString &localeName = locale.name();
+        auto iter = otherLocales.constFind(localeName);
+        if (iter != otherLocales.constEnd())
+            return iter.value();
+
+        LocalizedStrings strings;
+        QFile meta(localizedSource);
+        const QJsonDocument &doc = loadJsonFile(&meta);
+        const QString &nameKey = DConfigInfo::localizedAttribute(DConfigAttribute::Name, locale);
+        const QString &descriptionKey = DConfigInfo::localizedAttribute(DConfigAttribute::Description, locale);
+        const auto &contents = doc.object()[QLatin1String("contents")].toObject();
+        for (auto i = contents.constBegin(); i != contents.constEnd(); ++i) {
+            const QJsonObject &item = i.value().toObject();
+            const QJsonValue &name = item[nameKey];
+            if (name.isString())
+                strings.names.insert(i.key(), name.toString());
+            const QJsonValue &description = item[descriptionKey];
+            if (description.isString())
+                strings.descriptions.insert(i.key(), description.toString());
+        }
+        return otherLocales.insert(localeName, strings).value();
     }
 
     DConfigKey configKey;
     DConfigInfo values;
+    DConfigMetaTable table;
+    // the meta values before overriding and the parsed overrides, for reloadOverrides. They're
+    // kept only if the overrides are watched, or else every reload parses all files again.
+    const bool keepOverrides = qEnvironmentVariableIntValue("DSG_DCONFIG_WATCH_OVERRIDES") == 1;
+    DConfigInfo baseValues;
+    QVector<OverrideSource> overrideSources;
+    QByteArray metaFileStamp;
+    bool overridesCached = false;
+    // the meta file of the dropped localized strings, and the locale kept in values.
+    QString localizedSource;
+    QString keptLocale;
+    QHash<QString, LocalizedStrings> otherLocales;
     DConfigFile::Version m_version = {0, 0};
     char padding [4] = {};
 };
@@ -1011,6 +1888,25 @@ DConfigMetaImpl::~DConfigMetaImpl()
     @return
 */
 
+/*!
+@~english
+    @fn void DConfigCache::setSaveDelay(int msec)
+    @brief Enable the write-behind mode of save(), a value of 0 disables it
+    \a msec The delay in milliseconds, the modifications in this window are coalesced into one write
+    @note The pending modifications are written when the cache is destroyed, when the application
+    is about to quit or when save() is called with sync, the write needs the event loop of the thread
+    which calls this function.
+    @note Only the caches created by DConfigFile support it, it does nothing for other implementations.
+*/
+
+/*!
+@~english
+    @fn void DConfigCache::setDurability(DConfigFile::Durability durability)
+    @brief Set how far save() forces the cache file to the storage, DConfigFile::DataSync by default
+    \a durability The synchronization of the written file
+    @note Only the caches created by DConfigFile support it, it does nothing for other implementations.
+*/
+
 /*!
 @~english
     @fn void setCachePathPrefix(const QString &prefix) = 0;
@@ -1019,6 +1915,268 @@ and it needs to distinguish the paths of different caches by caller.
     @param prefix cache's prefix path.
 */
 
+/*!
+@~english
+  \internal
+
+    @brief Read-only image of a global cache which is shared by all processes.
+
+    The writer of the global cache publishes the image to "<cache file>.image" after the json
+    file is written, and the readers map the image instead of parsing the json file. The image
+    begins with a header, it's generation is odd while the payload is being written, so readers
+    detect the updating and changing by comparing the generation. The image file is never shrunk,
+    it promises that the mapped memory of readers is always valid. A reader backs off while the
+    image is being written, and keeps the values it has if the writer is still busy, they're read
+    again at the next access. Only one writer is supported, and it's enabled by
+    `DSG_DCONFIG_SHARED_GLOBAL_CACHE=1`.
+
+    The mapping isn't locked, the owner serializes the calls.
+ */
+class Q_DECL_HIDDEN DConfigSharedImage {
+public:
+    struct Header {
+        quint32 magic;
+        quint32 version;
+        quint64 generation;
+        quint64 size;
+    };
+
+    enum ReadResult {
+        Loaded,
+        // the writer is publishing, or the image isn't published for the json file yet.
+        Busy,
+        Invalid
+    };
+
+    static bool isEnabled()
+    {
+        return qEnvironmentVariableIntValue("DSG_DCONFIG_SHARED_GLOBAL_CACHE") == 1;
+    }
+
+    static QString imagePath(const QString &cachePath)
+    {
+        return cachePath + QLatin1String(".image");
+    }
+
+    static bool publish(const QString &cachePath, const DConfigInfo &values)
+    {
+        QByteArray payload;
+        {
+            QDataStream stream(&payload, QIODevice::WriteOnly);
+            stream.setVersion(StreamVersion);
+            QByteArray stamp;
+            appendFileStamp(stamp, cachePath);
+            stream << stamp;
+            values.serialize(stream);
+        }
+
+        QFile file(imagePath(cachePath));
+        if (!file.open(QIODevice::ReadWrite)) {
+            qCDebug(cfLog, "Failed on publishing the shared image: \"%s\", error message: \"%s\"",
+                    qPrintable(file.fileName()), qPrintable(file.errorString()));
+            return false;
+        }
+        const qint64 required = qint64(sizeof(Header)) + payload.size();
+        if (file.size() < required && !file.resize(required))
+            return false;
+
+        uchar *data = file.map(0, required);
+        if (!data)
+            return false;
+
+        auto header = reinterpret_cast<Header *>(data);
+        const quint64 generation = __atomic_load_n(&header->generation, __ATOMIC_ACQUIRE) & ~quint64(1);
+        __atomic_store_n(&header->generation, generation + 1, __ATOMIC_RELAXED);
+        // the odd generation is visible before any store of the header fields and the payload.
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        __atomic_store_n(&header->magic, Magic, __ATOMIC_RELAXED);
+        __atomic_store_n(&header->version, FormatVersion, __ATOMIC_RELAXED);
+        __atomic_store_n(&header->size, quint64(payload.size()), __ATOMIC_RELAXED);
+        memcpy(data + sizeof(Header), payload.constData(), size_t(payload.size()));
+        // the even generation is visible after all of them.
+        __atomic_store_n(&header->generation, generation + 2, __ATOMIC_RELEASE);
+
+        file.unmap(data);
+        return true;
+    }
+
+    bool attach(const QString &cachePath)
+    {
+        detach();
+        file.setFileName(imagePath(cachePath));
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        return remap();
+    }
+
+    void detach()
+    {
+        if (data)
+            file.unmap(data);
+        data = nullptr;
+        mappedSize = 0;
+        file.close();
+    }
+
+    inline bool isAttached() const
+    {
+        return data;
+    }
+
+    inline quint64 generation() const
+    {
+        return __atomic_load_n(&reinterpret_cast<const Header *>(data)->generation, __ATOMIC_ACQUIRE);
+    }
+
+    inline bool isChanged() const
+    {
+        return data && generation() != loadedGeneration;
+    }
+
+    ReadResult read(const QString &cachePath, DConfigInfo &values)
+    {
+        if (!data)
+            return Invalid;
+
+        for (int i = 0; i < MaxReadAttempts; ++i) {
+            // back off while the writer is publishing, it's a memcpy of the payload.
+            if (i > 0) {
+                if (i < 3)
+                    QThread::yieldCurrentThread();
+                else
+                    QThread::usleep(50UL << (i - 3));
+            }
+
+            const quint64 begin = generation();
+            if (begin & 1)
+                continue;
+
+            auto header = reinterpret_cast<const Header *>(data);
+            const quint32 magic = __atomic_load_n(&header->magic, __ATOMIC_RELAXED);
+            const quint32 version = __atomic_load_n(&header->version, __ATOMIC_RELAXED);
+            const qint64 size = qint64(__atomic_load_n(&header->size, __ATOMIC_RELAXED));
+            if (size < 0 || size > std::numeric_limits<int>::max())
+                continue;
+            if (qint64(sizeof(Header)) + size > mappedSize && (!remap() || qint64(sizeof(Header)) + size > mappedSize))
+                continue;
+
+            const QByteArray payload(reinterpret_cast<const char *>(data + sizeof(Header)), int(size));
+            // the loads of the header fields and the payload complete before the generation is checked again.
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (generation() != begin)
+                continue;
+
+            if (magic != Magic || version != FormatVersion)
+                return Invalid;
+
+            QDataStream stream(payload);
+            stream.setVersion(StreamVersion);
+            QByteArray stamp, currentStamp;
+            stream >> stamp;
+            appendFileStamp(currentStamp, cachePath);
+            // the json file is written before the image, wait for the next generation.
+            if (stamp != currentStamp) {
+                loadedGeneration = begin;
+                return Busy;
+            }
+
+            DConfigInfo tmp;
+            if (!tmp.deserialize(stream))
+                return Invalid;
+
+            values = tmp;
+            loadedGeneration = begin;
+            return Loaded;
+        }
+        return Busy;
+    }
+
+private:
+    bool remap()
+    {
+        if (data)
+            file.unmap(data);
+        data = nullptr;
+        mappedSize = file.size();
+        if (mappedSize < qint64(sizeof(Header)))
+            return false;
+        data = file.map(0, mappedSize);
+        return data;
+    }
+
+    // "DCSI", DConfig Shared Image
+    static constexpr quint32 Magic = 0x44435349;
+    static constexpr quint32 FormatVersion = 2;
+    // about 3ms of sleeping in total
+    static constexpr int MaxReadAttempts = 9;
+    static constexpr QDataStream::Version StreamVersion = QDataStream::Qt_5_11;
+    QFile file;
+    uchar *data = nullptr;
+    qint64 mappedSize = 0;
+    quint64 loadedGeneration = 0;
+};
+
+/*!
+@~english
+  \internal
+
+    @brief Write the file by \a writer to a temporary file beside \a path and rename it over the old one.
+
+    The temporary file is created with the mode of the old file, or 0666 masked by umask. It's synchronized
+    by fdatasync unless \a durability is NoSync, and the directory is synchronized by FullSync. If the
+    directory isn't writable but the file is, the file is written in place as QSaveFile does.
+ */
+static bool replaceFile(const QString &path, DConfigFile::Durability durability,
+                        const std::function<bool(QIODevice *)> &writer)
+{
+    static QAtomicInt serial;
+    const QByteArray &target = QFile::encodeName(path);
+    QByteArray temporary = target + ".tmp" + QByteArray::number(getpid()) + '.' + QByteArray::number(serial.fetchAndAddRelaxed(1));
+
+    bool direct = false;
+    int fd = ::open(temporary.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (fd < 0 && (errno == EACCES || errno == EROFS) && ::access(target.constData(), W_OK) == 0) {
+        direct = true;
+        fd = ::open(target.constData(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+    }
+    if (fd < 0) {
+        qCWarning(cfLog, "Falied on saveing data when open file: \"%s\", error message: \"%s\"",
+                  qPrintable(path), strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (!direct && ::stat(target.constData(), &st) == 0)
+        ::fchmod(fd, st.st_mode & 07777);
+
+    QFile file;
+    bool ok = file.open(fd, QIODevice::WriteOnly, QFileDevice::DontCloseHandle) && writer(&file) && file.flush();
+    file.close();
+    if (ok && durability != DConfigFile::NoSync)
+        ok = ::fdatasync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+
+    if (direct)
+        return ok;
+
+    if (!ok || ::rename(temporary.constData(), target.constData()) != 0) {
+        qCWarning(cfLog, "Falied on saveing data to file: \"%s\", error message: \"%s\"",
+                  qPrintable(path), strerror(errno));
+        ::unlink(temporary.constData());
+        return false;
+    }
+
+    if (durability == DConfigFile::FullSync) {
+        const int dirFd = ::open(QFile::encodeName(QFileInfo(path).path()).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            ::fsync(dirFd);
+            ::close(dirFd);
+        }
+    }
+    return true;
+}
+
 class Q_DECL_HIDDEN DConfigCacheImpl : public DConfigCache {
 public:
     DConfigCacheImpl(const DConfigKey &configKey, const uint uid, bool global);
@@ -1028,7 +2186,9 @@ public:
 public:
     inline virtual int serial(const QString &key) const override
     {
-        return values.serial(key);
+        return readValues([&key] (const DConfigInfo &info) {
+            return info.serial(key);
+        });
     }
 
     inline virtual uint uid() const override
@@ -1038,7 +2198,26 @@ public:
 
     inline virtual QStringList keyList() const override
     {
-        return values.keyList();
+        return readValues([] (const DConfigInfo &info) {
+            return info.keyList();
+        });
+    }
+
+    // the values are reloaded if the shared image is updated by the writer, the const readers
+    // may be called by the threads concurrently, so they're serialized with the reloading.
+    template<typename Reader>
+    inline auto readValues(Reader reader) const -> decltype(reader(std::declval<const DConfigInfo &>()))
+    {
+        if (Q_LIKELY(sharedImagePath.isEmpty()))
+            return reader(values);
+
+        QMutexLocker locker(&sharedImageMutex);
+        if (sharedImage.isChanged() && !cacheChanged) {
+            // the values are kept if the writer is busy, it's tried again by the next access.
+            if (sharedImage.read(sharedImagePath, values) == DConfigSharedImage::Invalid)
+                sharedImage.detach();
+        }
+        return reader(values);
     }
 
     inline QString applicationCacheDir(const QString &localPrefix, const QString &suffix) const
@@ -1129,16 +2308,16 @@ public:
         }
         values.setValue(key, value);
         values.setSerial(key, serial);
-        values.setTime(key, QDateTime::currentDateTime().toString(Qt::ISODate));
-        values.setUser(key, uid);
-        values.setAppId(key, appid.isEmpty() ? configKey.appId : appid);
+        values.setWriteInfo(key, QDateTime::currentSecsSinceEpoch(), uid, appid.isEmpty() ? configKey.appId : appid);
         cacheChanged = true;
         return true;
     }
 
     inline QVariant value(const QString &key) const override
     {
-        return values.value(key);
+        return readValues([&key] (const DConfigInfo &info) {
+            return info.value(key);
+        });
     }
 
     bool save(const QString &localPrefix, QJsonDocument::JsonFormat format, bool sync) override;
@@ -1148,12 +2327,30 @@ public:
         cachePrefix = prefix;
     }
 
+    void setSaveDelay(int msec);
+    void setDurability(DConfigFile::Durability level)
+    {
+        durability = level;
+    }
+    bool write(const QString &localPrefix, QJsonDocument::JsonFormat format);
+    bool writeContent(QIODevice *device, QJsonDocument::JsonFormat format) const;
+    void flush();
+    bool publishSharedImage(const QString &localPrefix);
+
     DConfigKey configKey;
-    DConfigInfo values;
+    mutable DConfigInfo values;
+    mutable DConfigSharedImage sharedImage;
+    mutable QMutex sharedImageMutex;
+    QString sharedImagePath;
     QString cachePrefix;
     uint userid;
     bool global;
     bool cacheChanged = false;
+    bool savePending = false;
+    DConfigFile::Durability durability = DConfigFile::DataSync;
+    QJsonDocument::JsonFormat pendingFormat = QJsonDocument::Indented;
+    QString pendingPrefix;
+    QScopedPointer<QTimer> saveTimer;
 };
 
 DConfigCacheImpl::DConfigCacheImpl(const DConfigKey &configKey, const uint uid, bool global)
@@ -1166,10 +2363,56 @@ DConfigCacheImpl::DConfigCacheImpl(const DConfigKey &configKey, const uint uid,
 
 DConfigCacheImpl::~DConfigCacheImpl()
 {
+    flush();
+}
+
+void DConfigCacheImpl::setSaveDelay(int msec)
+{
+    if (msec <= 0) {
+        saveTimer.reset();
+        flush();
+        return;
+    }
+
+    if (!saveTimer) {
+        saveTimer.reset(new QTimer);
+        saveTimer->setSingleShot(true);
+        QObject::connect(saveTimer.data(), &QTimer::timeout, [this] {
+            flush();
+        });
+        if (auto app = QCoreApplication::instance()) {
+            QObject::connect(app, &QCoreApplication::aboutToQuit, saveTimer.data(), [this] {
+                flush();
+            });
+        }
+    }
+    saveTimer->setInterval(msec);
+}
+
+void DConfigCache::setSaveDelay(int msec)
+{
+    // not virtual to keep the vtable of the exported interface.
+    if (auto impl = dynamic_cast<DConfigCacheImpl *>(this))
+        impl->setSaveDelay(msec);
+}
+
+void DConfigCache::setDurability(DConfigFile::Durability durability)
+{
+    if (auto impl = dynamic_cast<DConfigCacheImpl *>(this))
+        impl->setDurability(durability);
+}
+
+void DConfigCacheImpl::flush()
+{
+    if (!savePending)
+        return;
+
+    write(pendingPrefix, pendingFormat);
 }
 
 bool DConfigCacheImpl::load(const QString &localPrefix)
 {
+    D_TRACE_SPAN("dconfig", "DConfigCache::load", configKey.fileName);
     // cache 文件要严格匹配 subpath
     const QString &dir = getCacheDir(localPrefix);
     if (dir.isEmpty()) {
@@ -1183,6 +2426,16 @@ bool DConfigCacheImpl::load(const QString &localPrefix)
         return true;
     }
 
+    if (isGlobal() && DConfigSharedImage::isEnabled()) {
+        if (sharedImage.attach(cache->fileName())
+            && sharedImage.read(cache->fileName(), values) == DConfigSharedImage::Loaded) {
+            sharedImagePath = cache->fileName();
+            qCDebug(cfLog, "Load global cache from the shared image: \"%s\"", qPrintable(sharedImagePath));
+            return true;
+        }
+        sharedImage.detach();
+    }
+
     const QJsonDocument &doc = loadJsonFile(cache.data());
 
     if (doc.isObject()) {
@@ -1208,7 +2461,26 @@ bool DConfigCacheImpl::save(const QString &localPrefix, QJsonDocument::JsonForma
     if (!cacheChanged)
         return true;
 
+    if (saveTimer && !sync) {
+        // coalesce the modifications, the timer isn't restarted to bound the latency of writing.
+        savePending = true;
+        pendingPrefix = localPrefix;
+        pendingFormat = format;
+        if (!saveTimer->isActive())
+            saveTimer->start();
+        return true;
+    }
+
+    return write(localPrefix, format);
+}
+
+bool DConfigCacheImpl::write(const QString &localPrefix, QJsonDocument::JsonFormat format)
+{
     cacheChanged = false;
+    savePending = false;
+    if (saveTimer)
+        saveTimer->stop();
+
     const QString &dir = getCacheDir(localPrefix);
     if (dir.isEmpty()) {
         qCWarning(cfLog, "Falied on saveing, the config cache directory is empty for the user[%d], "
@@ -1216,37 +2488,58 @@ bool DConfigCacheImpl::save(const QString &localPrefix, QJsonDocument::JsonForma
         return false;
     }
     QString path = cacheDir(dir);
-
-    QFile cache(path);
-    if (!QFile::exists(QFileInfo(cache.fileName()).path())) {
-        QDir().mkpath(QFileInfo(cache.fileName()).path());
+    if (!QFile::exists(QFileInfo(path).path())) {
+        QDir().mkpath(QFileInfo(path).path());
     }
 
-    if (!cache.open(QIODevice::WriteOnly)) {
-        qCWarning(cfLog, "Falied on saveing data when open file: \"%s\", error message: \"%s\"",
-                  qPrintable(cache.fileName()), qPrintable(cache.errorString()));
+    qCDebug(cfLog, "Save cache file \"%s\".", qPrintable(path));
+    if (!replaceFile(path, durability, [this, format](QIODevice *device) {
+        return writeContent(device, format);
+    })) {
         return false;
     }
 
-    qCDebug(cfLog, "Save cache file \"%s\".", qPrintable(cache.fileName()));
+    if (isGlobal() && DConfigSharedImage::isEnabled())
+        DConfigSharedImage::publish(path, values);
 
-    QJsonObject root;
+    return true;
+}
 
-    root[QLatin1String("magic")] = MAGIC_CACHE;
-    const DConfigFile::Version version = DConfigFile::supportedVersion();
-    root[QLatin1String("version")] = QString("%1.%2").arg(version.major)
-            .arg(version.minor);
+// Publishes the image of the values loaded from the json file, e.g. the image is lost or outdated,
+// it's done only if the cache directory is writable.
+bool DConfigCacheImpl::publishSharedImage(const QString &localPrefix)
+{
+    if (!isGlobal() || !DConfigSharedImage::isEnabled() || !sharedImagePath.isEmpty())
+        return false;
+
+    const QString &dir = getCacheDir(localPrefix);
+    if (dir.isEmpty())
+        return false;
 
-    root[QLatin1String("contents")] = values.content();
-    QJsonDocument doc;
-    doc.setObject(root);
-    const QByteArray &json = doc.toJson(format);
+    const QFileInfo info(cacheDir(dir));
+    if (!info.isFile() || !QFileInfo(info.path()).isWritable())
+        return false;
 
-    bool status = cache.write(json) == json.size();
-    if (status && sync) {
-        cache.flush();
-    }
-    return status;
+    if (!DConfigSharedImage::publish(info.filePath(), values))
+        return false;
+
+    qCDebug(cfLog, "Publish the shared image of the global cache: \"%s\"", qPrintable(info.filePath()));
+    sharedImagePath = info.filePath();
+    return true;
+}
+
+bool DConfigCacheImpl::writeContent(QIODevice *device, QJsonDocument::JsonFormat format) const
+{
+    // it's streamed in the same layout as QJsonDocument, the keys of the root are sorted.
+    const bool compact = format == QJsonDocument::Compact;
+    const DConfigFile::Version version = DConfigFile::supportedVersion();
+    const QByteArray &head = compact ? QByteArray("{\"contents\":{") : QByteArray("{\n    \"contents\": {\n");
+    const QByteArray &tail = QString(compact ? "},\"magic\":\"%1\",\"version\":\"%2.%3\"}"
+                                             : "    },\n    \"magic\": \"%1\",\n    \"version\": \"%2.%3\"\n}\n")
+            .arg(MAGIC_CACHE).arg(version.major).arg(version.minor).toUtf8();
+
+    return device->write(head) == head.size() && values.writeContent(device, format)
+            && device->write(tail) == tail.size();
 }
 
 class Q_DECL_HIDDEN DConfigFilePrivate : public DObjectPrivate {
@@ -1285,52 +2578,95 @@ public:
                 cache->remove(key);
                 return true;
             } else {
-                const auto &metaValue = configMeta->value(key);
-                // sample judgement to reduce a copy of convert.
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-                if (metaValue.typeId() == value.typeId())
-                    return cache->setValue(key, value, configMeta->serial(key), cache->uid(), appid);
-
-                // convert copy to meta's type, it promises `setValue` don't change meta's type.
-                // canConvert isn't explicit, e.g: QString is also can convert to double.
-                auto copy = value;
-                if (!copy.convert(metaValue.metaType())) {
-                    qCWarning(cfLog) << "check type error, meta type is " << metaValue.metaType().name()
-                                     << ", and now type is " << value.metaType().name();
+                QVariant copy;
+                if (!convertValue(key, value, copy))
                     return false;
-                }
 
-                 // TODO it's a bug of qt, MetaType of 1.0 is qlonglong instead of double in json file.
-                static const QVector<QMetaType> filterConvertType {
-                    QMetaType{QMetaType::Double}
-                };
-                // reset to origin value.
-                if (filterConvertType.contains(value.metaType())) {
-                    copy = value;
-                }
-#else
-                if (metaValue.type() == value.type())
-                    return cache->setValue(key, value, configMeta->serial(key), cache->uid(), appid);
+                return cache->setValue(key, copy, configMeta->serial(key), cache->uid(), appid);
+            }
+        }
+        return false;
+    }
+    bool setValues(const QVariantMap &values, DConfigCache *userCache,
+                   const QString &appid, QStringList *changedKeys)
+    {
+        // check all values before writing, it promises that nothing is written if any value is invalid.
+        QVector<QPair<QString, QVariant>> checkedValues;
+        checkedValues.reserve(values.size());
+        for (auto iter = values.constBegin(); iter != values.constEnd(); ++iter) {
+            if (!getCache(iter.key(), userCache))
+                continue;
 
-                auto copy = value;
-                if (!copy.convert(metaValue.userType())) {
-                    qCWarning(cfLog) << "check type error, meta type is " << metaValue.type()
-                                     << ", and now type is " << value.type();
-                    return false;
-                }
+            QVariant copy;
+            if (iter.value().isValid() && !convertValue(iter.key(), iter.value(), copy))
+                return false;
 
-                static const QVector<QVariant::Type> filterConvertType {
-                    QVariant::Double
-                };
-                if (filterConvertType.contains(value.type())) {
-                    copy = value;
-                }
-#endif
+            checkedValues.append(qMakePair(iter.key(), copy));
+        }
 
-                return cache->setValue(key, copy, configMeta->serial(key), cache->uid(), appid);
+        for (const auto &item : std::as_const(checkedValues)) {
+            auto cache = getCache(item.first, userCache);
+            bool changed = true;
+            if (!item.second.isValid()) {
+                cache->remove(item.first);
+            } else {
+                changed = cache->setValue(item.first, item.second, configMeta->serial(item.first),
+                                          cache->uid(), appid);
             }
+            if (changed && changedKeys)
+                changedKeys->append(item.first);
         }
-        return false;
+        return true;
+    }
+    bool convertValue(const QString &key, const QVariant &value, QVariant &result) const
+    {
+        const auto &metaValue = configMeta->value(key);
+        // sample judgement to reduce a copy of convert.
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        if (metaValue.typeId() == value.typeId()) {
+            result = value;
+            return true;
+        }
+
+        // convert copy to meta's type, it promises `setValue` don't change meta's type.
+        // canConvert isn't explicit, e.g: QString is also can convert to double.
+        auto copy = value;
+        if (!copy.convert(metaValue.metaType())) {
+            qCWarning(cfLog) << "check type error, meta type is " << metaValue.metaType().name()
+                             << ", and now type is " << value.metaType().name();
+            return false;
+        }
+
+         // TODO it's a bug of qt, MetaType of 1.0 is qlonglong instead of double in json file.
+        static const QVector<QMetaType> filterConvertType {
+            QMetaType{QMetaType::Double}
+        };
+        // reset to origin value.
+        if (filterConvertType.contains(value.metaType())) {
+            copy = value;
+        }
+#else
+        if (metaValue.type() == value.type()) {
+            result = value;
+            return true;
+        }
+
+        auto copy = value;
+        if (!copy.convert(metaValue.userType())) {
+            qCWarning(cfLog) << "check type error, meta type is " << metaValue.type()
+                             << ", and now type is " << value.type();
+            return false;
+        }
+
+        static const QVector<QVariant::Type> filterConvertType {
+            QVariant::Double
+        };
+        if (filterConvertType.contains(value.type())) {
+            copy = value;
+        }
+#endif
+        result = copy;
+        return true;
     }
     DConfigCache* getCache(const QString &key, DConfigCache *userCache) const
     {
@@ -1366,7 +2702,7 @@ public:
 private:
     DConfigCacheImpl* globalCache;
     DConfigKey configKey;
-    DConfigMeta *configMeta;
+    DConfigMetaImpl *configMeta;
 };
 
 DConfigFilePrivate::~DConfigFilePrivate()
@@ -1439,6 +2775,21 @@ bool DConfigFile::load(QIODevice *meta, const QList<QIODevice *> &overrides)
     return this->meta()->load(meta, overrides);
 }
 
+/*!
+@~english
+    @brief Reload the override files of the meta
+    \a localPrefix Directory prefix
+    \a changedKeys Output the keys whose value, serial or permissions changed
+    @return
+    @note The parsed files are kept if `DSG_DCONFIG_WATCH_OVERRIDES=1`, then the unchanged override
+    files aren't parsed again, or else the meta and all override files are loaded again.
+*/
+bool DConfigFile::reloadOverrides(const QString &localPrefix, QStringList *changedKeys)
+{
+    D_D(DConfigFile);
+    return d->configMeta->reloadOverrides(localPrefix, changedKeys);
+}
+
 /*!
 @~english
     @brief Save the cached value to disk
@@ -1495,6 +2846,22 @@ bool DConfigFile::setValue(const QString &key, const QVariant &value, const QStr
     return d->setValue(key, value, userCache, callerAppid);
 }
 
+/*!
+@~english
+    @brief Sets multiple values in the cache in one transaction
+    \a values Configuration names and the values to set, an invalid value resets the configuration item
+    \a callerAppid Application id at setup time
+    \a userCache Specific user cache at setup time
+    \a changedKeys Receives the configuration names whose cached value changed, a reset name is always received
+    @return A value of false indicates that a value can't be converted to the meta's type, and nothing is written
+    @note All values are checked before writing, so it's either fully applied or not applied at all.
+ */
+bool DConfigFile::setValues(const QVariantMap &values, const QString &callerAppid, DConfigCache *userCache, QStringList *changedKeys)
+{
+    D_D(DConfigFile);
+    return d->setValues(values, userCache, callerAppid, changedKeys);
+}
+
 DConfigCache *DConfigFile::createUserCache(const uint uid)
 {
     D_D(DConfigFile);
@@ -1535,4 +2902,92 @@ bool DConfigFile::isValid() const
     return versionIsValid(d->configMeta->version());
 }
 
+/*!
+@~english
+    @brief Read the prefetch lists installed in the "prefetch" directory of the meta directories
+    \a localPrefix Directory prefix
+    @return The configurations listed, without duplicates
+
+    A prefetch list is a json file which lists the configurations read by many processes
+    at the start of the session, e.g.
+    @code
+    {
+        "magic": "dsg.config.prefetch",
+        "version": "1.0",
+        "contents": [
+            { "appid": "org.deepin.dde.control-center", "name": "org.deepin.dde.appearance", "subpath": "" },
+            { "name": "org.deepin.dde.dock" }
+        ]
+    }
+    @endcode
+    A configuration without "appid" is a generic configuration.
+    @sa prefetch()
+ */
+QList<DConfigFile::PrefetchEntry> DConfigFile::prefetchEntries(const QString &localPrefix)
+{
+    QList<PrefetchEntry> entries;
+    QSet<QString> listed;
+    for (const QString &dir : DConfigMeta::genericMetaDirs(localPrefix)) {
+        const QFileInfoList &files = QDir(dir + QLatin1String("/prefetch")).entryInfoList({QStringLiteral("*.json")}, QDir::Files, QDir::Name);
+        for (const QFileInfo &info : files) {
+            QFile file(info.filePath());
+            const QJsonDocument &doc = loadJsonFile(&file);
+            const QJsonObject &root = doc.object();
+            if (!checkMagic(root, MAGIC_PREFETCH) || !checkVersion(root, supportedVersion())) {
+                qCWarning(cfLog, "Invalid prefetch list: \"%s\"", qPrintable(info.filePath()));
+                continue;
+            }
+
+            const QJsonArray &contents = root[QLatin1String("contents")].toArray();
+            for (const QJsonValue &item : contents) {
+                const QJsonObject &object = item.toObject();
+                const PrefetchEntry entry {
+                    object[QLatin1String("appid")].toString(),
+                    object[QLatin1String("name")].toString(),
+                    object[QLatin1String("subpath")].toString()
+                };
+                if (entry.name.isEmpty())
+                    continue;
+
+                const QString &key = entry.appId + QLatin1Char('\0') + entry.name + QLatin1Char('\0') + entry.subpath;
+                if (!listed.contains(key)) {
+                    listed.insert(key);
+                    entries << entry;
+                }
+            }
+        }
+    }
+    return entries;
+}
+
+/*!
+@~english
+    @brief Load the configurations of \a entries to warm the caches shared by the processes
+    \a entries The configurations, usually the ones of prefetchEntries()
+    \a localPrefix Directory prefix
+    @return The number of configurations loaded
+
+    Loading a configuration refreshes its meta snapshot in `$XDG_CACHE_HOME/dsg/configs-snapshot`
+    if `DSG_DCONFIG_META_SNAPSHOT=1` and the meta or overrides are changed, and publishes the shared image of the global cache
+    if `DSG_DCONFIG_SHARED_GLOBAL_CACHE=1` and the image is missing or outdated. So the processes
+    started later don't parse the json files for their first values. It's called at the start
+    of the session, before the applications start.
+ */
+int DConfigFile::prefetch(const QList<PrefetchEntry> &entries, const QString &localPrefix)
+{
+    D_TRACE_SPAN("dconfig", "DConfigFile::prefetch");
+    int count = 0;
+    for (const PrefetchEntry &entry : entries) {
+        DConfigFile file(entry.appId, entry.name, entry.subpath);
+        if (!file.load(localPrefix)) {
+            qCDebug(cfLog, "Falied on prefetching the config: appId=%s, name=%s, subpath=%s",
+                    qPrintable(entry.appId), qPrintable(entry.name), qPrintable(entry.subpath));
+            continue;
+        }
+        file.d_func()->globalCache->publishSharedImage(localPrefix);
+        ++count;
+    }
+    return count;
+}
+
 DCORE_END_NAMESPACE
@@ -10,6 +10,25 @@
 #include <QTemporaryFile>
 #include <QDebug>
 #include <QSaveFile>
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QtAlgorithms>
+#include <QByteArrayList>
+#include <QHash>
+#include <QLocale>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 DCORE_BEGIN_NAMESPACE
 
@@ -39,6 +58,53 @@ static const char charTraits[256] = {
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
 };
 
+// Returns the position of the first character in [from, dataLen) which readLineFromData() needs
+// to handle, or dataLen if there is none. '=' is skipped if \a withEquals is false, and ';' is
+// always skipped by the vectorized scanners because readLineFromData() does nothing for it.
+static inline int findSpecialChar(const char *data, int from, int dataLen, bool withEquals)
+{
+    int i = from;
+#if defined(__SSE2__)
+    const __m128i newLine = _mm_set1_epi8('\n');
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i hash = _mm_set1_epi8('#');
+    // compare with '\n' again instead of '=' to avoid branching in the loop
+    const __m128i equals = _mm_set1_epi8(withEquals ? '=' : '\n');
+    for (; i + 16 <= dataLen; i += 16) {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const __m128i matched = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, newLine), _mm_cmpeq_epi8(chars, carriageReturn)),
+                                             _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, backslash), _mm_cmpeq_epi8(chars, hash)),
+                                                          _mm_cmpeq_epi8(chars, equals)));
+        const uint mask = uint(_mm_movemask_epi8(matched));
+        if (mask)
+            return i + int(qCountTrailingZeroBits(mask));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t newLine = vdupq_n_u8('\n');
+    const uint8x16_t carriageReturn = vdupq_n_u8('\r');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t hash = vdupq_n_u8('#');
+    const uint8x16_t equals = vdupq_n_u8(withEquals ? '=' : '\n');
+    for (; i + 16 <= dataLen; i += 16) {
+        const uint8x16_t chars = vld1q_u8(reinterpret_cast<const uint8_t *>(data + i));
+        const uint8x16_t matched = vorrq_u8(vorrq_u8(vceqq_u8(chars, newLine), vceqq_u8(chars, carriageReturn)),
+                                            vorrq_u8(vorrq_u8(vceqq_u8(chars, backslash), vceqq_u8(chars, hash)),
+                                                     vceqq_u8(chars, equals)));
+        // narrow every matched byte to a nibble, the 16 nibbles fit in a 64 bits integer
+        const quint64 mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matched), 4)), 0);
+        if (mask)
+            return i + int(qCountTrailingZeroBits(mask) / 4);
+    }
+#endif
+    for (; i < dataLen; ++i) {
+        const char ch = data[i];
+        if ((charTraits[uint(uchar(ch))] & Special) && (withEquals || ch != '='))
+            return i;
+    }
+    return dataLen;
+}
+
 bool readLineFromData(const QByteArray &data, int &dataPos, int &lineStart, int &lineLen, int &equalsPos)
 {
     int dataLen = data.length();
@@ -49,12 +115,13 @@ bool readLineFromData(const QByteArray &data, int &dataPos, int &lineStart, int
     while (lineStart < dataLen && (charTraits[uint(uchar(data.at(lineStart)))] & Space))
         ++lineStart;
 
+    const char *chars = data.constData();
     int i = lineStart;
     while (i < dataLen) {
-        while (!(charTraits[uint(uchar(data.at(i)))] & Special)) {
-            if (++i == dataLen)
-                goto break_out_of_outer_loop;
-        }
+        // only the first '=' of a line is interesting, the others are part of the value.
+        i = findSpecialChar(chars, i, dataLen, equalsPos == -1);
+        if (i == dataLen)
+            break;
 
         char ch = data.at(i++);
         if (ch == '=') {
@@ -101,39 +168,221 @@ break_out_of_outer_loop:
     return lineLen > 0;
 }
 
-QString &doEscape(QString& str, const QHash<QChar,QChar> &repl)
+/*! \internal */
+class DDesktopEntryEscapeTable
 {
-    // First we replace slash.
-    str.replace(QLatin1Char('\\'), QLatin1String("\\\\"));
+public:
+    DDesktopEntryEscapeTable(std::initializer_list<std::pair<char, char>> replacements)
+    {
+        std::fill(std::begin(table), std::end(table), '\0');
+        for (const auto &replacement : replacements)
+            table[uchar(replacement.first)] = replacement.second;
+    }
 
-    QHashIterator<QChar,QChar> i(repl);
-    while (i.hasNext()) {
-        i.next();
-        if (i.key() != QLatin1Char('\\'))
-            str.replace(i.key(), QString::fromLatin1("\\\\%1").arg(i.value()));
+    // returns the replacement of ch, or 0 if it isn't replaced
+    inline char replacement(QChar ch) const
+    {
+        return ch.unicode() < 128 ? table[ch.unicode()] : '\0';
     }
 
-    return str;
-}
+private:
+    char table[128];
+};
 
-QString &doUnescape(QString& str, const QHash<QChar,QChar> &repl)
+// Every backslash is doubled, and the characters in the table are replaced by two backslashes
+// and their replacements. Returns false if nothing needs to be escaped.
+static bool doEscape(QStringView str, const DDesktopEntryEscapeTable &table, QString *result)
 {
-    int n = 0;
-    while (1) {
-        n=str.indexOf(QLatin1String("\\"), n);
-        if (n < 0 || n > str.length() - 2)
-            break;
+    // count the output first, so that it's allocated once
+    qsizetype extra = 0;
+    for (QChar ch : str) {
+        if (ch == QLatin1Char('\\'))
+            extra += 1;
+        else if (table.replacement(ch))
+            extra += 2;
+    }
+    if (extra == 0)
+        return false;
 
-        if (repl.contains(str.at(n+1))) {
-            str.replace(n, 2, repl.value(str.at(n+1)));
+    *result = QString(int(str.size() + extra), Qt::Uninitialized);
+    QChar *out = result->data();
+    for (QChar ch : str) {
+        if (ch == QLatin1Char('\\')) {
+            *out++ = QLatin1Char('\\');
+            *out++ = QLatin1Char('\\');
+        } else if (const char replacement = table.replacement(ch)) {
+            *out++ = QLatin1Char('\\');
+            *out++ = QLatin1Char('\\');
+            *out++ = QLatin1Char(replacement);
+        } else {
+            *out++ = ch;
         }
+    }
 
-        n++;
+    return true;
+}
+
+// A backslash and the following character in the table are replaced by its replacement, the
+// other backslashes are kept. Returns false if there isn't any backslash.
+static bool doUnescape(QStringView str, const DDesktopEntryEscapeTable &table, QString *result)
+{
+    qsizetype i = 0;
+    while (i < str.size() && str[i] != QLatin1Char('\\'))
+        ++i;
+    if (i == str.size())
+        return false;
+
+    result->reserve(int(str.size()));
+    result->append(str.data(), int(i));
+    for (; i < str.size(); ++i) {
+        const QChar ch = str[i];
+        if (ch == QLatin1Char('\\') && i + 1 < str.size()) {
+            if (const char replacement = table.replacement(str[i + 1])) {
+                result->append(QLatin1Char(replacement));
+                ++i;
+                continue;
+            }
+        }
+        result->append(ch);
     }
 
+    return true;
+}
+
+static inline QString &escapeInPlace(QString &str, const DDesktopEntryEscapeTable &table)
+{
+    QString result;
+    if (doEscape(str, table, &result))
+        str = result;
     return str;
 }
 
+static inline QString &unescapeInPlace(QString &str, const DDesktopEntryEscapeTable &table)
+{
+    QString result;
+    if (doUnescape(str, table, &result))
+        str = result;
+    return str;
+}
+
+static inline QString escaped(QStringView str, const DDesktopEntryEscapeTable &table)
+{
+    QString result;
+    return doEscape(str, table, &result) ? result : str.toString();
+}
+
+static inline QString unescaped(QStringView str, const DDesktopEntryEscapeTable &table)
+{
+    QString result;
+    return doUnescape(str, table, &result) ? result : str.toString();
+}
+
+static const DDesktopEntryEscapeTable &stringEscapes()
+{
+    static const DDesktopEntryEscapeTable table {
+        {'\n', 'n'},
+        {'\t', 't'},
+        {'\r', 'r'},
+    };
+    return table;
+}
+
+static const DDesktopEntryEscapeTable &execEscapes()
+{
+    // The parseCombinedArgString() splits the string by the space symbols,
+    // we temporarily replace them on the special characters.
+    // Replacement will reverse after the splitting.
+    static const DDesktopEntryEscapeTable table {
+        {'"', '"'},     // double quote,
+        {'\'', '\''},   // single quote ("'"),
+        {'\\', '\\'},   // backslash character ("\"),
+        {'$', '$'},     // dollar sign ("$"),
+    };
+    return table;
+}
+
+static const DDesktopEntryEscapeTable &stringUnescapes(bool unescapeSemicolons)
+{
+    static const DDesktopEntryEscapeTable table {
+        {'\\', '\\'},
+        {'s', ' '},
+        {'n', '\n'},
+        {'t', '\t'},
+        {'r', '\r'},
+    };
+    static const DDesktopEntryEscapeTable tableWithSemicolons {
+        {'\\', '\\'},
+        {'s', ' '},
+        {'n', '\n'},
+        {'t', '\t'},
+        {'r', '\r'},
+        {';', ';'},
+    };
+    return unescapeSemicolons ? tableWithSemicolons : table;
+}
+
+static const DDesktopEntryEscapeTable &execUnescapes()
+{
+    // The parseCombinedArgString() splits the string by the space symbols,
+    // we temporarily replace them on the special characters.
+    // Replacement will reverse after the splitting.
+    static const DDesktopEntryEscapeTable table {
+        {' ', '\01'},          // space
+        {'\t', '\02'},         // tab
+        {'\n', '\03'},         // newline,
+
+        {'"', '"'},     // double quote,
+        {'\'', '\''},   // single quote ("'"),
+        {'\\', '\\'},   // backslash character ("\"),
+        {'>', '>'},     // greater-than sign (">"),
+        {'<', '<'},     // less-than sign ("<"),
+        {'~', '~'},     // tilde ("~"),
+        {'|', '|'},     // vertical bar ("|"),
+        {'&', '&'},     // ampersand ("&"),
+        {';', ';'},     // semicolon (";"),
+        {'$', '$'},     // dollar sign ("$"),
+        {'*', '*'},     // asterisk ("*"),
+        {'?', '?'},     // question mark ("?"),
+        {'#', '#'},     // hash mark ("#"),
+        {'(', '('},     // parenthesis ("(")
+        {')', ')'},     // parenthesis (")")
+        {'`', '`'},     // backtick character ("`").
+    };
+    return table;
+}
+
+static inline bool isAsciiSpace(char ch)
+{
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
+}
+
+// the range of data.mid(start, length).trimmed()
+static inline void trimRange(const QByteArray &data, int &start, int &length)
+{
+    while (length > 0 && isAsciiSpace(data.at(start))) {
+        ++start;
+        --length;
+    }
+    while (length > 0 && isAsciiSpace(data.at(start + length - 1)))
+        --length;
+}
+
+/*! \internal */
+struct DDesktopEntryKeyIndex
+{
+    // offsets of the trimmed key and raw value in DDesktopEntrySection::unparsedDatas
+    int keyStart;
+    int keyLength;
+    int valueStart;
+    int valueLength;
+};
+
+static inline int compareKey(const QByteArray &data, const DDesktopEntryKeyIndex &index, const char *key, int keyLength)
+{
+    const int ret = memcmp(data.constData() + index.keyStart, key, qMin(index.keyLength, keyLength));
+    return ret != 0 ? ret : index.keyLength - keyLength;
+}
+
 /*! \internal */
 class DDesktopEntrySection
 {
@@ -142,8 +391,18 @@ public:
 
     QString name;
     QMap<QString, QString> valuesMap;
+    // the original bytes of the section, they're kept until the section is modified.
     QByteArray unparsedDatas;
+    // the keys of unparsedDatas sorted by key, only the value of a requested key will be decoded.
+    QVector<DDesktopEntryKeyIndex> keyIndex;
+    // the offset of unparsedDatas in DDesktopEntryPrivate::fileData, -1 if it isn't from the file.
+    int fileDataOffset = -1;
     int sectionPos = 99;
+    // valuesMap is valid
+    bool parsed = false;
+    // the result of allKeys(), it's cleared when a key is added or removed.
+    mutable QStringList cachedKeys;
+    mutable bool keysCached = false;
 
     inline operator QString() const {
         return QLatin1String("DDesktopEntrySection(") + name + QLatin1String(")");
@@ -168,7 +427,7 @@ public:
     }
 
     bool ensureSectionDataParsed() {
-        if (unparsedDatas.isEmpty()) return true;
+        if (parsed) return true;
 
         valuesMap.clear();
 
@@ -189,22 +448,88 @@ public:
             }
         }
 
-        unparsedDatas.clear();
+        parsed = true;
+        keyIndex.clear();
 
         return true;
     }
 
+    // the original bytes are dropped, the section will be serialized from valuesMap.
+    void setModified() {
+        unparsedDatas.clear();
+        fileDataOffset = -1;
+    }
+
+    void setKeyIndex(QVector<DDesktopEntryKeyIndex> &&index) {
+        // keep the order of the same keys, the last one overrides the others as valuesMap does
+        std::stable_sort(index.begin(), index.end(), [this](const DDesktopEntryKeyIndex &a, const DDesktopEntryKeyIndex &b) {
+            return compareKey(unparsedDatas, a, unparsedDatas.constData() + b.keyStart, b.keyLength) < 0;
+        });
+        keyIndex = std::move(index);
+    }
+
+    const DDesktopEntryKeyIndex *findUnparsed(const QString &key) const {
+        return findUnparsed(key.toUtf8());
+    }
+
+    const DDesktopEntryKeyIndex *findUnparsed(const QByteArray &rawKey) const {
+        auto it = std::upper_bound(keyIndex.cbegin(), keyIndex.cend(), rawKey, [this](const QByteArray &key, const DDesktopEntryKeyIndex &index) {
+            return compareKey(unparsedDatas, index, key.constData(), key.size()) > 0;
+        });
+        if (it == keyIndex.cbegin())
+            return nullptr;
+        --it;
+        return compareKey(unparsedDatas, *it, rawKey.constData(), rawKey.size()) == 0 ? &*it : nullptr;
+    }
+
+    QString unparsedValue(const DDesktopEntryKeyIndex &index) const {
+        int valueStart = index.valueStart;
+        int valueLength = index.valueLength;
+        trimRange(unparsedDatas, valueStart, valueLength);
+        return QString::fromUtf8(unparsedDatas.constData() + valueStart, valueLength);
+    }
+
     bool contains(const QString &key) const {
-        const_cast<DDesktopEntrySection*>(this)->ensureSectionDataParsed();
+        if (!parsed)
+            return findUnparsed(key);
         return valuesMap.contains(key);
     }
 
+    // the keys are taken from keyIndex if the section isn't parsed, so that it's kept unparsed.
     QStringList allKeys() const {
-        const_cast<DDesktopEntrySection*>(this)->ensureSectionDataParsed();
-        return valuesMap.keys();
+        if (keysCached)
+            return cachedKeys;
+
+        cachedKeys.clear();
+        if (parsed) {
+            cachedKeys = valuesMap.keys();
+        } else {
+            cachedKeys.reserve(keyIndex.size());
+            for (int i = 0; i < keyIndex.size(); ++i) {
+                const DDesktopEntryKeyIndex &index = keyIndex.at(i);
+                // the same keys are adjacent in keyIndex
+                if (i > 0 && compareKey(unparsedDatas, keyIndex.at(i - 1), unparsedDatas.constData() + index.keyStart, index.keyLength) == 0)
+                    continue;
+                cachedKeys << QString::fromUtf8(unparsedDatas.constData() + index.keyStart, index.keyLength);
+            }
+            // in the same order as valuesMap.keys()
+            std::sort(cachedKeys.begin(), cachedKeys.end());
+        }
+        keysCached = true;
+        return cachedKeys;
+    }
+
+    void clearKeysCache() {
+        keysCached = false;
+        cachedKeys.clear();
     }
 
     QString get(const QString &key, QString &defaultValue) {
+        if (!parsed) {
+            const auto index = findUnparsed(key);
+            return index ? unparsedValue(*index) : defaultValue;
+        }
+
         if (this->contains(key)) {
             return valuesMap[key];
         } else {
@@ -212,17 +537,49 @@ public:
         }
     }
 
+    // looks up \a key with the \a suffixes in order, the keys are built in one buffer.
+    bool getLocalized(const QString &key, const QByteArrayList &suffixes, QString *value) const {
+        if (!parsed) {
+            QByteArray localizedKey = key.toUtf8();
+            const int keyLength = localizedKey.size();
+            for (const QByteArray &suffix : suffixes) {
+                localizedKey.resize(keyLength);
+                localizedKey.append(suffix);
+                if (const auto index = findUnparsed(localizedKey)) {
+                    *value = unparsedValue(*index);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        for (const QByteArray &suffix : suffixes) {
+            auto it = valuesMap.constFind(key + QString::fromUtf8(suffix));
+            if (it != valuesMap.constEnd()) {
+                *value = it.value();
+                return true;
+            }
+        }
+        return false;
+    }
+
     bool set(const QString &key, const QString &value) {
+        ensureSectionDataParsed();
         if (this->contains(key)) {
             valuesMap.remove(key);
         }
         valuesMap[key] = value;
+        setModified();
+        clearKeysCache();
         return true;
     }
 
     bool remove(const QString &key) {
+        ensureSectionDataParsed();
         if (this->contains(key)) {
             valuesMap.remove(key);
+            setModified();
+            clearKeysCache();
             return true;
         }
         return false;
@@ -231,6 +588,95 @@ public:
 
 typedef QMap<QString, DDesktopEntrySection> SectionMap;
 
+/*! \internal */
+struct DDesktopEntryLocaleChains
+{
+    QMutex mutex;
+    QHash<QString, QByteArrayList> byLocaleKey;
+    QHash<QLocale, QByteArrayList> byLocale;
+};
+
+Q_GLOBAL_STATIC(DDesktopEntryLocaleChains, localeChains)
+
+// the locales are tried in order, an empty locale name stands for the key without a locale.
+static QByteArrayList buildLocaleChain(const QStringList &localeNames)
+{
+    QByteArrayList chain;
+    for (const QString &localeName : localeNames) {
+        QByteArray suffix;
+        if (!localeName.isEmpty())
+            suffix.append('[').append(localeName.toUtf8()).append(']');
+        if (!chain.contains(suffix))
+            chain.append(suffix);
+    }
+    return chain;
+}
+
+// 此处添加 bcp47Name() 是为了兼容 desktop 文件中的语言长短名解析。
+// 比如芬兰语，有 [fi] 和 [fi_FI] 两种情况，QLocale::name() 对应 fi_FI，QLocale::bcp47Name() 对应 fi。
+static QByteArrayList buildLocaleChain(const QLocale &locale)
+{
+    return buildLocaleChain(QStringList{locale.name(), locale.bcp47Name(), QStringLiteral("C"), QString()});
+}
+
+static QByteArrayList buildLocaleChain(const QString &localeKey)
+{
+    if (localeKey.isEmpty())
+        return buildLocaleChain(QStringList{QStringLiteral("C"), QString()});
+    if (localeKey == QLatin1String("empty"))
+        return buildLocaleChain(QStringList{QString(), QStringLiteral("C")});
+    return buildLocaleChain(QStringList{localeKey, QStringLiteral("C"), QString()});
+}
+
+// returns the "[locale]" suffixes of the keys which localizedValue() tries, they're computed once
+// for every locale key in the process.
+static QByteArrayList localeChain(const QString &localeKey)
+{
+    // the cache limit, the locale keys passed by one application are usually a few.
+    constexpr int MaxCachedChains = 64;
+    const bool isDefault = localeKey == QLatin1String("default");
+    const bool isSystem = !isDefault && localeKey == QLatin1String("system");
+
+    if (localeChains.isDestroyed()) {
+        if (isDefault || isSystem)
+            return buildLocaleChain(isDefault ? QLocale() : QLocale::system());
+        return buildLocaleChain(localeKey);
+    }
+
+    DDesktopEntryLocaleChains *chains = localeChains;
+    QMutexLocker locker(&chains->mutex);
+    if (isDefault || isSystem) {
+        // QLocale::setDefault() may be called at any time, so the chain is cached by the locale.
+        const QLocale &locale = isDefault ? QLocale() : QLocale::system();
+        auto it = chains->byLocale.constFind(locale);
+        if (it != chains->byLocale.constEnd())
+            return it.value();
+        if (chains->byLocale.size() >= MaxCachedChains)
+            chains->byLocale.clear();
+        return chains->byLocale.insert(locale, buildLocaleChain(locale)).value();
+    }
+
+    auto it = chains->byLocaleKey.constFind(localeKey);
+    if (it != chains->byLocaleKey.constEnd())
+        return it.value();
+    if (chains->byLocaleKey.size() >= MaxCachedChains)
+        chains->byLocaleKey.clear();
+    return chains->byLocaleKey.insert(localeKey, buildLocaleChain(localeKey)).value();
+}
+
+/*! \internal */
+class DDesktopEntryLoader : public QRunnable
+{
+public:
+    explicit DDesktopEntryLoader(const std::function<void()> &load)
+        : load(load) {}
+
+    void run() override { load(); }
+
+private:
+    std::function<void()> load;
+};
+
 class DDesktopEntryPrivate
 {
 public:
@@ -249,12 +695,20 @@ public:
     bool get(const QString &sectionName, const QString &key, QString *value);
     bool set(const QString &sectionName, const QString &key, const QString &value);
     bool remove(const QString &sectionName, const QString &key);
+    QStringList groups(bool sorted) const;
+    void clearGroupsCache();
 
 protected:
     QString filePath;
     QMutex fileMutex;
+    // the content of the file, the unparsed sections refer to it without copying.
+    QByteArray fileData;
     SectionMap sectionsMap;
     mutable DDesktopEntry::Status status;
+    // the results of DDesktopEntry::allGroups(), they're cleared when a section is added or the file is reloaded.
+    mutable QStringList groupsCache;
+    mutable QStringList sortedGroupsCache;
+    mutable bool groupsCached = false;
 
 private:
     bool __padding[4];
@@ -311,9 +765,9 @@ bool DDesktopEntryPrivate::fuzzyLoad()
 
     if (file.isReadable() && file.size() != 0) {
         bool ok = false;
-        QByteArray data = file.readAll();
+        fileData = file.readAll();
 
-        ok = initSectionsFromData(data);
+        ok = initSectionsFromData(fileData);
 
         if (!ok) {
             setStatus(DDesktopEntry::FormatError);
@@ -328,6 +782,7 @@ bool DDesktopEntryPrivate::fuzzyLoad()
 bool DDesktopEntryPrivate::initSectionsFromData(const QByteArray &data)
 {
     sectionsMap.clear();
+    clearGroupsCache();
 
     QString lastSectionName;
     int lastSectionStart = 0;
@@ -339,16 +794,19 @@ bool DDesktopEntryPrivate::initSectionsFromData(const QByteArray &data)
     int lineLen;
     int equalsPos;
 
-    auto commitSection = [=](const QString &name, int sectionStartPos, int sectionLength, int sectionIndex) {
+    QVector<DDesktopEntryKeyIndex> keyIndex;
+    auto commitSection = [&](const QString &name, int sectionStartPos, int sectionLength, int sectionIndex) {
         DDesktopEntrySection lastSection;
         lastSection.name = name;
-        lastSection.unparsedDatas = data.mid(sectionStartPos, sectionLength);
+        // data is fileData, which lives as long as the sections
+        lastSection.unparsedDatas = QByteArray::fromRawData(data.constData() + sectionStartPos, sectionLength);
+        lastSection.fileDataOffset = sectionStartPos;
+        lastSection.setKeyIndex(std::move(keyIndex));
         lastSection.sectionPos = sectionIndex;
         sectionsMap[name] = lastSection;
+        keyIndex.clear();
     };
 
-    // TODO: here we only need to find the section start, so things like equalsPos are useless here.
-    //       maybe we can do some optimization here via adding extra argument to readLineFromData().
     while(readLineFromData(data, dataPos, lineStart, lineLen, equalsPos)) {
         // qDebug() << "CurrentLine:" << data.mid(lineStart, lineLen);
         if (data.at(lineStart) == '[') {
@@ -369,6 +827,18 @@ bool DDesktopEntryPrivate::initSectionsFromData(const QByteArray &data)
             }
             lastSectionName = sectionName;
             lastSectionStart = lineStart;
+        } else if (equalsPos != -1 && !lastSectionName.isEmpty()) {
+            // only the offsets are recorded, the keys and values are decoded when they're requested.
+            int keyStart = lineStart;
+            int keyLength = equalsPos - lineStart;
+            trimRange(data, keyStart, keyLength);
+
+            DDesktopEntryKeyIndex index;
+            index.keyStart = keyStart - lastSectionStart;
+            index.keyLength = keyLength;
+            index.valueStart = equalsPos + 1 - lastSectionStart;
+            index.valueLength = lineStart + lineLen - equalsPos - 1;
+            keyIndex.append(index);
         }
     }
 
@@ -394,12 +864,35 @@ bool DDesktopEntryPrivate::write(QIODevice &device) const
 
     QStringList sortedKeys = q->allGroups(true);
 
+    // the untouched sections adjacent in the file are written as one piece of fileData
+    int pendingStart = -1;
+    int pendingEnd = -1;
+    auto writePending = [&]() {
+        if (pendingStart == -1)
+            return true;
+        qint64 ret = device.write(fileData.constData() + pendingStart, pendingEnd - pendingStart);
+        pendingStart = -1;
+        return ret != -1;
+    };
+
     for (const QString &key : sortedKeys) {
-        qint64 ret = device.write(sectionsMap[key].sectionData());
+        const DDesktopEntrySection &section = sectionsMap.constFind(key).value();
+        if (section.fileDataOffset != -1) {
+            if (section.fileDataOffset != pendingEnd && !writePending())
+                return false;
+            if (pendingStart == -1)
+                pendingStart = section.fileDataOffset;
+            pendingEnd = section.fileDataOffset + section.unparsedDatas.size();
+            continue;
+        }
+
+        if (!writePending())
+            return false;
+        qint64 ret = device.write(section.sectionData());
         if (ret == -1) return false;
     }
 
-    return true;
+    return writePending();
 }
 
 int DDesktopEntryPrivate::sectionPos(const QString &sectionName) const
@@ -417,8 +910,9 @@ bool DDesktopEntryPrivate::contains(const QString &sectionName, const QString &k
         return false;
     }
 
-    if (sectionsMap.contains(sectionName)) {
-        return sectionsMap[sectionName].contains(key);
+    auto it = sectionsMap.constFind(sectionName);
+    if (it != sectionsMap.constEnd()) {
+        return it->contains(key);
     }
 
     return false;
@@ -464,6 +958,7 @@ bool DDesktopEntryPrivate::set(const QString &sectionName, const QString &key, c
         newSection.name = sectionName;
         newSection.set(key, value);
         sectionsMap[sectionName] = newSection;
+        clearGroupsCache();
         return true;
     }
 
@@ -478,6 +973,28 @@ bool DDesktopEntryPrivate::remove(const QString &sectionName, const QString &key
     return false;
 }
 
+QStringList DDesktopEntryPrivate::groups(bool sorted) const
+{
+    if (!groupsCached) {
+        groupsCache = sectionsMap.keys();
+        // the order of the sections in the file, the new sections are at the end
+        sortedGroupsCache = groupsCache;
+        std::stable_sort(sortedGroupsCache.begin(), sortedGroupsCache.end(), [this](const QString &a, const QString &b) {
+            return sectionsMap.constFind(a)->sectionPos < sectionsMap.constFind(b)->sectionPos;
+        });
+        groupsCached = true;
+    }
+
+    return sorted ? sortedGroupsCache : groupsCache;
+}
+
+void DDesktopEntryPrivate::clearGroupsCache()
+{
+    groupsCached = false;
+    groupsCache.clear();
+    sortedGroupsCache.clear();
+}
+
 /*!
 @~english
   @class Dtk::Core::DDesktopEntry
@@ -502,6 +1019,61 @@ DDesktopEntry::~DDesktopEntry()
 
 }
 
+/*!
+@~english
+  @brief Loads the desktop entry files of \a paths in a thread pool of \a maxThreadCount threads.
+
+  The files are read and parsed concurrently, so the time of loading many files is bounded by the
+  I/O concurrency instead of the latency of each file. If \a maxThreadCount is less than 1, twice
+  the number of the CPU cores is used, because the threads mostly wait for the I/O.
+
+  @return Returns the entries in the same order as \a paths, check status() of each entry for
+  the errors.
+ */
+QList<QSharedPointer<DDesktopEntry>> DDesktopEntry::loadMany(const QStringList &paths, int maxThreadCount)
+{
+    QVector<QSharedPointer<DDesktopEntry>> entries(paths.size());
+    if (maxThreadCount < 1)
+        maxThreadCount = QThread::idealThreadCount() * 2;
+    maxThreadCount = qBound(1, maxThreadCount, qMax(1, paths.size()));
+
+    // every worker takes the next file until all files are loaded
+    QSharedPointer<DDesktopEntry> *results = entries.data();
+    QAtomicInt next(0);
+    auto load = [&paths, results, &next] {
+        for (int i = next.fetchAndAddRelaxed(1); i < paths.size(); i = next.fetchAndAddRelaxed(1))
+            results[i].reset(new DDesktopEntry(paths.at(i)));
+    };
+
+    // don't use the global pool, the caller may be running in it
+    QThreadPool pool;
+    pool.setMaxThreadCount(maxThreadCount);
+    for (int i = 1; i < maxThreadCount; ++i)
+        pool.start(new DDesktopEntryLoader(load));
+    load();
+    pool.waitForDone();
+
+    return QList<QSharedPointer<DDesktopEntry>>(entries.cbegin(), entries.cend());
+}
+
+/*!
+@~english
+  @brief Discards the in-memory state, including the unsaved modifications, and reads the file again.
+  @return true if the file is read successfully; otherwise returns false, check status() for the error.
+ */
+bool DDesktopEntry::reload()
+{
+    Q_D(DDesktopEntry);
+
+    // the sections refer to fileData, so they must be released first
+    d->sectionsMap.clear();
+    d->clearGroupsCache();
+    d->fileData.clear();
+    d->setStatus(DDesktopEntry::NoError);
+
+    return d->fuzzyLoad();
+}
+
 /*!
 @~english
   @brief Write back data to the desktop entry file.
@@ -570,7 +1142,10 @@ DDesktopEntry::Status DDesktopEntry::status() const
 /*!
 @~english
   @brief Get a list of all section keys inside the given \a section.
-  
+
+  The keys of a section which isn't parsed yet are taken from its index, without parsing the values.
+  The list is cached until a key of the section is added or removed.
+
   @return all available section keys.
  */
 QStringList DDesktopEntry::keys(const QString &section) const
@@ -590,37 +1165,14 @@ QStringList DDesktopEntry::keys(const QString &section) const
   @brief Get a list of all section groups inside the desktop entry.
   
   If \a sorted is set to true, the returned result will keep the order as-is when reading the entry file.
+  The lists are cached until a section is added or the file is reloaded.
   
   @return all available section groups.
  */
 QStringList DDesktopEntry::allGroups(bool sorted) const
 {
     Q_D(const DDesktopEntry);
-
-    if (!sorted) {
-        return d->sectionsMap.keys();
-    } else {
-        using StrIntPair = QPair<QString, int>;
-
-        QStringList keys = d->sectionsMap.keys();
-        QList<StrIntPair> result;
-
-        for (const QString & key : keys) {
-            result << StrIntPair(key, d->sectionPos(key));
-        }
-
-        std::sort(result.begin(), result.end(), [](const StrIntPair& a, const StrIntPair& b) -> bool {
-            return a.second < b.second;
-        });
-
-        keys.clear();
-
-        for (const StrIntPair& pair : result) {
-            keys << pair.first;
-        }
-
-        return keys;
-    }
+    return d->groups(sorted);
 }
 
 /*!
@@ -765,42 +1317,14 @@ QString DDesktopEntry::localizedValue(const QString &key, const QString &localeK
 {
     Q_D(const DDesktopEntry);
     QString result = defaultValue;
-    QString actualLocaleKey = QLatin1String("C");
     if (key.isEmpty() || section.isEmpty()) {
         qWarning("DDesktopEntry::localizedValue: Empty key or section passed");
         return result;
     }
 
-    QStringList possibleKeys;
-
-    // 此处添加 bcp47Name() 是为了兼容 desktop 文件中的语言长短名解析。
-    // 比如芬兰语，有 [fi] 和 [fi_FI] 两种情况，QLocale::name() 对应 fi_FI，QLocale::bcp47Name() 对应 fi。
-    if (!localeKey.isEmpty()) {
-        if (localeKey == "empty") {
-            possibleKeys << key;
-        } else if (localeKey == "default") {
-            possibleKeys << QString("%1[%2]").arg(key, QLocale().name());
-            possibleKeys << QString("%1[%2]").arg(key, QLocale().bcp47Name());
-        } else if (localeKey == "system") {
-            possibleKeys << QString("%1[%2]").arg(key, QLocale::system().name());
-            possibleKeys << QString("%1[%2]").arg(key, QLocale::system().bcp47Name());
-        } else {
-            possibleKeys << QString("%1[%2]").arg(key, localeKey);
-        }
-    }
-
-    if (!actualLocaleKey.isEmpty()) {
-        possibleKeys << QString("%1[%2]").arg(key, actualLocaleKey);
-    }
-    possibleKeys << QString("%1[%2]").arg(key, "C");
-    possibleKeys << key;
-
-    for (const QString &oneKey : possibleKeys) {
-        if (d->contains(section, oneKey)) {
-            const_cast<DDesktopEntryPrivate *>(d)->get(section, oneKey, &result);
-            break;
-        }
-    }
+    auto it = d->sectionsMap.constFind(section);
+    if (it != d->sectionsMap.constEnd())
+        it->getLocalized(key, localeChain(localeKey), &result);
 
     return result;
 }
@@ -915,12 +1439,17 @@ bool DDesktopEntry::removeEntry(const QString &key, const QString &section)
  ************************************************/
 QString &DDesktopEntry::escape(QString &str)
 {
-    QHash<QChar,QChar> repl;
-    repl.insert(QLatin1Char('\n'),  QLatin1Char('n'));
-    repl.insert(QLatin1Char('\t'),  QLatin1Char('t'));
-    repl.insert(QLatin1Char('\r'),  QLatin1Char('r'));
+    return escapeInPlace(str, stringEscapes());
+}
 
-    return doEscape(str, repl);
+/*!
+@~english
+  @brief Returns a copy of \a str escaped as escape() does, it scans \a str once and allocates
+  the result at most once.
+ */
+QString DDesktopEntry::escape(QStringView str)
+{
+    return escaped(str, stringEscapes());
 }
 
 /************************************************
@@ -944,16 +1473,17 @@ is unambiguously represented with ("\\$").
  ************************************************/
 QString &DDesktopEntry::escapeExec(QString &str)
 {
-    QHash<QChar,QChar> repl;
-    // The parseCombinedArgString() splits the string by the space symbols,
-    // we temporarily replace them on the special characters.
-    // Replacement will reverse after the splitting.
-    repl.insert(QLatin1Char('"'), QLatin1Char('"'));    // double quote,
-    repl.insert(QLatin1Char('\''), QLatin1Char('\''));  // single quote ("'"),
-    repl.insert(QLatin1Char('\\'), QLatin1Char('\\'));  // backslash character ("\"),
-    repl.insert(QLatin1Char('$'), QLatin1Char('$'));    // dollar sign ("$"),
+    return escapeInPlace(str, execEscapes());
+}
 
-    return doEscape(str, repl);
+/*!
+@~english
+  @brief Returns a copy of \a str escaped as escapeExec() does, it scans \a str once and
+  allocates the result at most once.
+ */
+QString DDesktopEntry::escapeExec(QStringView str)
+{
+    return escaped(str, execEscapes());
 }
 
 /*
@@ -969,18 +1499,17 @@ QString &DDesktopEntry::escapeExec(QString &str)
 */
 QString &DDesktopEntry::unescape(QString &str, bool unescapeSemicolons)
 {
-    QHash<QChar,QChar> repl;
-    repl.insert(QLatin1Char('\\'), QLatin1Char('\\'));
-    repl.insert(QLatin1Char('s'),  QLatin1Char(' '));
-    repl.insert(QLatin1Char('n'),  QLatin1Char('\n'));
-    repl.insert(QLatin1Char('t'),  QLatin1Char('\t'));
-    repl.insert(QLatin1Char('r'),  QLatin1Char('\r'));
-
-    if (unescapeSemicolons) {
-        repl.insert(QLatin1Char(';'),  QLatin1Char(';'));
-    }
+    return unescapeInPlace(str, stringUnescapes(unescapeSemicolons));
+}
 
-    return doUnescape(str, repl);
+/*!
+@~english
+  @brief Returns a copy of \a str unescaped as unescape() does, it scans \a str once and
+  allocates the result at most once.
+ */
+QString DDesktopEntry::unescape(QStringView str, bool unescapeSemicolons)
+{
+    return unescaped(str, stringUnescapes(unescapeSemicolons));
 }
 
 /************************************************
@@ -1025,32 +1554,17 @@ is unambiguously represented with ("\\$").
 QString &DDesktopEntry::unescapeExec(QString &str)
 {
     unescape(str);
-    QHash<QChar,QChar> repl;
-    // The parseCombinedArgString() splits the string by the space symbols,
-    // we temporarily replace them on the special characters.
-    // Replacement will reverse after the splitting.
-    repl.insert(QLatin1Char(' '), QChar::fromLatin1(01));   // space
-    repl.insert(QLatin1Char('\t'), QChar::fromLatin1(02));  // tab
-    repl.insert(QLatin1Char('\n'), QChar::fromLatin1(03));  // newline,
-
-    repl.insert(QLatin1Char('"'), QLatin1Char('"'));    // double quote,
-    repl.insert(QLatin1Char('\''), QLatin1Char('\''));  // single quote ("'"),
-    repl.insert(QLatin1Char('\\'), QLatin1Char('\\'));  // backslash character ("\"),
-    repl.insert(QLatin1Char('>'), QLatin1Char('>'));    // greater-than sign (">"),
-    repl.insert(QLatin1Char('<'), QLatin1Char('<'));    // less-than sign ("<"),
-    repl.insert(QLatin1Char('~'), QLatin1Char('~'));    // tilde ("~"),
-    repl.insert(QLatin1Char('|'), QLatin1Char('|'));    // vertical bar ("|"),
-    repl.insert(QLatin1Char('&'), QLatin1Char('&'));    // ampersand ("&"),
-    repl.insert(QLatin1Char(';'), QLatin1Char(';'));    // semicolon (";"),
-    repl.insert(QLatin1Char('$'), QLatin1Char('$'));    // dollar sign ("$"),
-    repl.insert(QLatin1Char('*'), QLatin1Char('*'));    // asterisk ("*"),
-    repl.insert(QLatin1Char('?'), QLatin1Char('?'));    // question mark ("?"),
-    repl.insert(QLatin1Char('#'), QLatin1Char('#'));    // hash mark ("#"),
-    repl.insert(QLatin1Char('('), QLatin1Char('('));    // parenthesis ("(")
-    repl.insert(QLatin1Char(')'), QLatin1Char(')'));    // parenthesis (")")
-    repl.insert(QLatin1Char('`'), QLatin1Char('`'));    // backtick character ("`").
-
-    return doUnescape(str, repl);
+    return unescapeInPlace(str, execUnescapes());
+}
+
+/*!
+@~english
+  @brief Returns a copy of \a str unescaped as unescapeExec() does.
+ */
+QString DDesktopEntry::unescapeExec(QStringView str)
+{
+    QString result = unescape(str);
+    return unescapeInPlace(result, execUnescapes());
 }
 
 bool DDesktopEntry::setStatus(const DDesktopEntry::Status &status)
@@ -0,0 +1,915 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "ddesktopentryindex.h"
+#include "ddesktopentry.h"
+#include "dfilesystemwatcher.h"
+
+#include <DObjectPrivate>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+DCORE_BEGIN_NAMESPACE
+
+#ifdef QT_DEBUG
+Q_LOGGING_CATEGORY(logDEI, "dtk.core.desktopentryindex")
+#else
+Q_LOGGING_CATEGORY(logDEI, "dtk.core.desktopentryindex", QtInfoMsg)
+#endif
+
+/*
+ * The index file (little endian), it's mapped and read in place:
+ *   header:      "DDEI" | version(4) | directory count(4) | entry count(4) | directories offset(4) | entries offset(4)
+ *   directories: string refs of the application directories, in order of precedence
+ *   entries:     records of RECORD_SIZE bytes sorted by the desktop id (UTF-8)
+ *   strings:     UTF-8 data referred by string refs: offset from the file start(4) | size(4)
+ * The string lists are joined by '\0', the localized names are stored as "locale\0name\0...".
+ */
+#define INDEX_MAGIC "DDEI"
+#define INDEX_VERSION 1
+#define HEADER_SIZE 24
+#define STRING_REF_SIZE 8
+#define RECORD_SIZE 88
+#define RECORD_MTIME_OFFSET (StringFieldCount * STRING_REF_SIZE)
+#define RECORD_SIZE_OFFSET (RECORD_MTIME_OFFSET + 8)
+#define RECORD_FLAGS_OFFSET (RECORD_SIZE_OFFSET + 8)
+#define UPDATE_DELAY 500
+
+enum StringField {
+    IdField,
+    PathField,
+    NameField,
+    LocalizedNamesField,
+    IconField,
+    ExecField,
+    CategoriesField,
+    MimeTypesField,
+    StringFieldCount
+};
+
+enum RecordFlag {
+    NoDisplayFlag = 0x1,
+    // Hidden, not an application or failed to parse, it's kept to hide the same id in the
+    // directories of lower precedence and to avoid parsing it again.
+    IgnoredFlag = 0x2
+};
+
+struct IndexRecord
+{
+    QByteArray strings[StringFieldCount];
+    qint64 mtime = 0;
+    qint64 size = 0;
+    quint32 flags = 0;
+};
+
+static QByteArray joinList(const QStringList &list)
+{
+    QByteArray data;
+    for (int i = 0; i < list.size(); ++i) {
+        if (i > 0)
+            data.append('\0');
+        data.append(list.at(i).toUtf8());
+    }
+
+    return data;
+}
+
+static QStringList splitList(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return {};
+
+    QStringList list;
+    for (const QByteArray &item : data.split('\0'))
+        list << QString::fromUtf8(item);
+    return list;
+}
+
+class DDesktopEntryIndexPrivate : public DObjectPrivate
+{
+public:
+    DDesktopEntryIndexPrivate(DDesktopEntryIndex *qq, const QStringList &directories, const QString &indexFilePath)
+        : DObjectPrivate(qq)
+        , directories(directories)
+        , indexFilePath(indexFilePath)
+    {
+    }
+
+    bool load();
+    void unload();
+    bool save(QVector<IndexRecord> &records) const;
+
+    const uchar *record(int index) const { return data + entriesOffset + index * RECORD_SIZE; }
+    bool stringRef(const uchar *ref, const char **string, int *size) const;
+    QByteArray string(const uchar *record, StringField field) const;
+    int find(const QByteArray &desktopId) const;
+    IndexRecord readRecord(int index) const;
+    DDesktopEntryIndex::Entry entry(int index) const;
+
+    void watchDirectories();
+    void scheduleUpdate();
+
+    QStringList directories;
+    QString indexFilePath;
+    QFile file;
+    const uchar *data = nullptr;
+    qint64 dataSize = 0;
+    quint32 entryCount = 0;
+    quint32 entriesOffset = 0;
+    int visibleCount = 0;
+
+    DFileSystemWatcher *watcher = nullptr;
+    QTimer *updateTimer = nullptr;
+
+    D_DECLARE_PUBLIC(DDesktopEntryIndex)
+};
+
+bool DDesktopEntryIndexPrivate::load()
+{
+    unload();
+
+    file.setFileName(indexFilePath);
+    if (!file.exists())
+        return false;
+    if (!file.open(QIODevice::ReadOnly) || file.size() < HEADER_SIZE) {
+        qCDebug(logDEI, "Can't open the index file \"%s\"", qPrintable(indexFilePath));
+        file.close();
+        return false;
+    }
+
+    dataSize = file.size();
+    data = file.map(0, dataSize);
+    if (!data) {
+        file.close();
+        return false;
+    }
+
+    const quint32 version = qFromLittleEndian<quint32>(data + 4);
+    const quint32 dirCount = qFromLittleEndian<quint32>(data + 8);
+    const quint32 count = qFromLittleEndian<quint32>(data + 12);
+    const quint32 dirsOffset = qFromLittleEndian<quint32>(data + 16);
+    const quint32 offset = qFromLittleEndian<quint32>(data + 20);
+    bool ok = memcmp(data, INDEX_MAGIC, 4) == 0 && version == INDEX_VERSION
+            && static_cast<qint64>(dirsOffset) + static_cast<qint64>(dirCount) * STRING_REF_SIZE <= dataSize
+            && static_cast<qint64>(offset) + static_cast<qint64>(count) * RECORD_SIZE <= dataSize;
+
+    // the index of other directories is outdated
+    ok = ok && static_cast<int>(dirCount) == directories.size();
+    for (int i = 0; ok && i < directories.size(); ++i) {
+        const char *dir;
+        int size;
+        ok = stringRef(data + dirsOffset + i * STRING_REF_SIZE, &dir, &size)
+                && QByteArray::fromRawData(dir, size) == directories.at(i).toUtf8();
+    }
+
+    if (!ok) {
+        qCDebug(logDEI, "The index file \"%s\" is invalid or outdated", qPrintable(indexFilePath));
+        unload();
+        return false;
+    }
+
+    entryCount = count;
+    entriesOffset = offset;
+    visibleCount = 0;
+    for (quint32 i = 0; i < entryCount; ++i) {
+        if (!(qFromLittleEndian<quint32>(record(i) + RECORD_FLAGS_OFFSET) & IgnoredFlag))
+            ++visibleCount;
+    }
+
+    return true;
+}
+
+void DDesktopEntryIndexPrivate::unload()
+{
+    if (data)
+        file.unmap(const_cast<uchar *>(data));
+    file.close();
+    data = nullptr;
+    dataSize = 0;
+    entryCount = 0;
+    entriesOffset = 0;
+    visibleCount = 0;
+}
+
+bool DDesktopEntryIndexPrivate::save(QVector<IndexRecord> &records) const
+{
+    std::sort(records.begin(), records.end(), [](const IndexRecord &a, const IndexRecord &b) {
+        return a.strings[IdField] < b.strings[IdField];
+    });
+
+    const quint32 dirsOffset = HEADER_SIZE;
+    const quint32 offset = dirsOffset + directories.size() * STRING_REF_SIZE;
+    const quint32 stringsOffset = offset + records.size() * RECORD_SIZE;
+
+    QByteArray index(stringsOffset, '\0');
+    char *header = index.data();
+    memcpy(header, INDEX_MAGIC, 4);
+    qToLittleEndian<quint32>(INDEX_VERSION, header + 4);
+    qToLittleEndian<quint32>(directories.size(), header + 8);
+    qToLittleEndian<quint32>(records.size(), header + 12);
+    qToLittleEndian<quint32>(dirsOffset, header + 16);
+    qToLittleEndian<quint32>(offset, header + 20);
+
+    auto appendString = [&index](const QByteArray &string, qint64 refPos) {
+        qToLittleEndian<quint32>(index.size(), index.data() + refPos);
+        qToLittleEndian<quint32>(string.size(), index.data() + refPos + 4);
+        index.append(string);
+    };
+
+    for (int i = 0; i < directories.size(); ++i)
+        appendString(directories.at(i).toUtf8(), dirsOffset + i * STRING_REF_SIZE);
+
+    for (int i = 0; i < records.size(); ++i) {
+        const IndexRecord &record = records.at(i);
+        const qint64 pos = offset + static_cast<qint64>(i) * RECORD_SIZE;
+        for (int field = 0; field < StringFieldCount; ++field)
+            appendString(record.strings[field], pos + field * STRING_REF_SIZE);
+        qToLittleEndian<qint64>(record.mtime, index.data() + pos + RECORD_MTIME_OFFSET);
+        qToLittleEndian<qint64>(record.size, index.data() + pos + RECORD_SIZE_OFFSET);
+        qToLittleEndian<quint32>(record.flags, index.data() + pos + RECORD_FLAGS_OFFSET);
+    }
+
+    if (!QDir().mkpath(QFileInfo(indexFilePath).absolutePath())) {
+        qCWarning(logDEI, "Can't create the directory of \"%s\"", qPrintable(indexFilePath));
+        return false;
+    }
+
+    // the clients which mapped the old file are not affected
+    QSaveFile saveFile(indexFilePath);
+    if (!saveFile.open(QIODevice::WriteOnly) || saveFile.write(index) != index.size() || !saveFile.commit()) {
+        qCWarning(logDEI, "Failed to write the index file \"%s\": %s", qPrintable(indexFilePath),
+                  qPrintable(saveFile.errorString()));
+        return false;
+    }
+
+    return true;
+}
+
+bool DDesktopEntryIndexPrivate::stringRef(const uchar *ref, const char **string, int *size) const
+{
+    const quint32 offset = qFromLittleEndian<quint32>(ref);
+    const quint32 length = qFromLittleEndian<quint32>(ref + 4);
+    if (static_cast<qint64>(offset) + length > dataSize)
+        return false;
+
+    *string = reinterpret_cast<const char *>(data) + offset;
+    *size = static_cast<int>(length);
+    return true;
+}
+
+QByteArray DDesktopEntryIndexPrivate::string(const uchar *record, StringField field) const
+{
+    const char *string;
+    int size;
+    if (!stringRef(record + field * STRING_REF_SIZE, &string, &size))
+        return QByteArray();
+    return QByteArray(string, size);
+}
+
+int DDesktopEntryIndexPrivate::find(const QByteArray &desktopId) const
+{
+    int begin = 0;
+    int end = static_cast<int>(entryCount);
+    while (begin < end) {
+        const int middle = begin + (end - begin) / 2;
+        const char *id;
+        int size;
+        if (!stringRef(record(middle) + IdField * STRING_REF_SIZE, &id, &size))
+            return -1;
+
+        int ret = memcmp(id, desktopId.constData(), qMin(size, desktopId.size()));
+        if (ret == 0)
+            ret = size - desktopId.size();
+        if (ret == 0)
+            return middle;
+        if (ret < 0)
+            begin = middle + 1;
+        else
+            end = middle;
+    }
+
+    return -1;
+}
+
+IndexRecord DDesktopEntryIndexPrivate::readRecord(int index) const
+{
+    const uchar *raw = record(index);
+    IndexRecord result;
+    for (int field = 0; field < StringFieldCount; ++field)
+        result.strings[field] = string(raw, static_cast<StringField>(field));
+    result.mtime = qFromLittleEndian<qint64>(raw + RECORD_MTIME_OFFSET);
+    result.size = qFromLittleEndian<qint64>(raw + RECORD_SIZE_OFFSET);
+    result.flags = qFromLittleEndian<quint32>(raw + RECORD_FLAGS_OFFSET);
+    return result;
+}
+
+DDesktopEntryIndex::Entry DDesktopEntryIndexPrivate::entry(int index) const
+{
+    const uchar *raw = record(index);
+    DDesktopEntryIndex::Entry entry;
+    entry.desktopId = QString::fromUtf8(string(raw, IdField));
+    entry.filePath = QString::fromUtf8(string(raw, PathField));
+    entry.name = QString::fromUtf8(string(raw, NameField));
+    entry.icon = QString::fromUtf8(string(raw, IconField));
+    entry.exec = QString::fromUtf8(string(raw, ExecField));
+    entry.categories = splitList(string(raw, CategoriesField));
+    entry.mimeTypes = splitList(string(raw, MimeTypesField));
+    entry.noDisplay = qFromLittleEndian<quint32>(raw + RECORD_FLAGS_OFFSET) & NoDisplayFlag;
+
+    const QStringList &localizedNames = splitList(string(raw, LocalizedNamesField));
+    for (int i = 0; i + 1 < localizedNames.size(); i += 2)
+        entry.localizedNames.insert(localizedNames.at(i), localizedNames.at(i + 1));
+
+    return entry;
+}
+
+void DDesktopEntryIndexPrivate::watchDirectories()
+{
+    if (!watcher)
+        return;
+
+    QStringList paths;
+    for (const QString &dir : directories) {
+        if (!QFileInfo(dir).isDir())
+            continue;
+        paths << dir;
+        QDirIterator it(dir, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (it.hasNext())
+            paths << it.next();
+    }
+
+    QSet<QString> watched;
+    for (const QString &path : watcher->directories())
+        watched.insert(path);
+    paths.erase(std::remove_if(paths.begin(), paths.end(), [&watched](const QString &path) {
+        return watched.contains(path);
+    }), paths.end());
+    if (!paths.isEmpty())
+        watcher->addPaths(paths);
+}
+
+void DDesktopEntryIndexPrivate::scheduleUpdate()
+{
+    // a package installation changes a lot of files in a short time
+    updateTimer->start();
+}
+
+/*
+ * The desktop file IDs of the application directories, used for the conversion between the IDs
+ * and the file paths. The directories are scanned once, and again only after inotify reports a
+ * change, which is checked by a non-blocking read on every lookup, so no event loop is needed.
+ * The directories are probed as before if inotify isn't available.
+ */
+class DesktopIdMap
+{
+public:
+    DesktopIdMap()
+    {
+#ifdef Q_OS_LINUX
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    }
+
+    ~DesktopIdMap()
+    {
+#ifdef Q_OS_LINUX
+        if (inotifyFd >= 0)
+            close(inotifyFd);
+#endif
+    }
+
+    QStringList filePaths(const QString &desktopId)
+    {
+        QMutexLocker locker(&mutex);
+        if (!update())
+            return probeFilePaths(desktopId);
+        return pathsOfId.value(desktopId);
+    }
+
+    QString desktopId(const QString &filePath)
+    {
+        QMutexLocker locker(&mutex);
+        if (!update())
+            return QString();
+        return idOfPath.value(filePath);
+    }
+
+private:
+    // returns false if the map can't be kept up to date
+    bool update()
+    {
+#ifdef Q_OS_LINUX
+        if (inotifyFd < 0)
+            return false;
+
+        alignas(struct inotify_event) char buffer[4096];
+        bool changed = !loaded;
+        ssize_t size;
+        while ((size = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (char *ptr = buffer; !changed && ptr < buffer + size;) {
+                const auto event = reinterpret_cast<const struct inotify_event *>(ptr);
+                ptr += sizeof(struct inotify_event) + event->len;
+                changed = isChange(event);
+            }
+        }
+
+        if (changed)
+            rebuild();
+        return watched;
+#else
+        return false;
+#endif
+    }
+
+#ifdef Q_OS_LINUX
+    bool isChange(const struct inotify_event *event) const
+    {
+        // the watches removed by rebuild()
+        if (event->mask & IN_IGNORED)
+            return false;
+        if (event->mask & IN_Q_OVERFLOW)
+            return true;
+        if (watches.contains(event->wd))
+            return true;
+
+        // only the creation of the missing directory matters in its parent
+        const QString &name = event->len > 0 ? QFile::decodeName(event->name) : QString();
+        return parentWatches.contains(event->wd, name);
+    }
+#endif
+
+    void rebuild()
+    {
+#ifdef Q_OS_LINUX
+        for (int wd : std::as_const(watches))
+            inotify_rm_watch(inotifyFd, wd);
+        for (int wd : parentWatches.uniqueKeys())
+            inotify_rm_watch(inotifyFd, wd);
+        watches.clear();
+        parentWatches.clear();
+        pathsOfId.clear();
+        idOfPath.clear();
+        loaded = true;
+        watched = true;
+
+        directories = DDesktopEntryIndex::applicationDirectories();
+        for (const QString &dir : std::as_const(directories)) {
+            if (!QFileInfo(dir).isDir()) {
+                // the directory may be created later
+                QString parent = dir;
+                do {
+                    parent = QFileInfo(parent).path();
+                } while (!QFileInfo(parent).isDir() && parent != QLatin1String("/"));
+                // the parent may be another application directory, so its mask is kept
+                const int wd = addWatch(parent, IN_CREATE | IN_MOVED_TO | IN_MASK_ADD);
+                if (wd >= 0)
+                    parentWatches.insert(wd, QDir(parent).relativeFilePath(dir).section(QLatin1Char('/'), 0, 0));
+                continue;
+            }
+
+            watch(dir, IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+            QDirIterator subdirs(dir, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+            while (subdirs.hasNext())
+                watch(subdirs.next(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+
+            // the shallower files first, in the same order as probeFilePaths()
+            QVector<QPair<int, QString>> files;
+            QDirIterator it(dir, {QStringLiteral("*.desktop")}, QDir::Files,
+                            QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+            const QDir baseDir(dir);
+            while (it.hasNext()) {
+                const QString &filePath = it.next();
+                files << qMakePair(int(baseDir.relativeFilePath(filePath).count(QLatin1Char('/'))), filePath);
+            }
+            std::stable_sort(files.begin(), files.end(), [](const QPair<int, QString> &f1, const QPair<int, QString> &f2) {
+                return f1.first < f2.first;
+            });
+
+            for (const auto &file : std::as_const(files)) {
+                QString id = baseDir.relativeFilePath(file.second);
+                id.replace(QLatin1Char('/'), QLatin1Char('-'));
+                pathsOfId[id].append(file.second);
+                idOfPath.insert(file.second, id);
+            }
+        }
+#endif
+    }
+
+    void watch(const QString &path, quint32 mask)
+    {
+        const int wd = addWatch(path, mask);
+        if (wd >= 0)
+            watches << wd;
+    }
+
+    int addWatch(const QString &path, quint32 mask)
+    {
+#ifdef Q_OS_LINUX
+        const int wd = inotify_add_watch(inotifyFd, QFile::encodeName(path).constData(), mask);
+        if (wd < 0) {
+            // e.g. out of the inotify watches, the changes may be missed
+            qCWarning(logDEI, "Failed to watch \"%s\": %s", qPrintable(path), strerror(errno));
+            watched = false;
+        }
+        return wd;
+#else
+        Q_UNUSED(path);
+        Q_UNUSED(mask);
+        return -1;
+#endif
+    }
+
+    static QStringList probeFilePaths(const QString &desktopId)
+    {
+        static const QString desktopSuffix = QStringLiteral(".desktop");
+        if (!desktopId.endsWith(desktopSuffix))
+            return {};
+        const QStringList &components = desktopId.chopped(desktopSuffix.size()).split(QLatin1Char('-'), Qt::SkipEmptyParts);
+
+        QStringList ret;
+        for (const QString &dirPath : DDesktopEntryIndex::applicationDirectories()) {
+            QString currentDir = dirPath;
+            for (auto it = components.cbegin(); it != components.cend(); ++it) {
+                const QString &currentName = QStringList{it, components.cend()}.join(QLatin1Char('-')) + desktopSuffix;
+                const QDir dir{currentDir};
+                if (dir.exists(currentName))
+                    ret.append(dir.filePath(currentName));
+
+                currentDir.append(QDir::separator() + *it);
+            }
+        }
+
+        return ret;
+    }
+
+    QMutex mutex;
+    int inotifyFd = -1;
+    bool loaded = false;
+    bool watched = false;
+    QVector<int> watches;
+    // the parents of the missing directories and the names of the missing directories in them
+    QMultiHash<int, QString> parentWatches;
+    QStringList directories;
+    QHash<QString, QStringList> pathsOfId;
+    QHash<QString, QString> idOfPath;
+};
+
+Q_GLOBAL_STATIC(DesktopIdMap, desktopIdMap)
+
+/*!
+@~english
+  @class Dtk::Core::DDesktopEntryIndex
+  \inmodule dtkcore
+  @brief An on-disk index of the application desktop entries.
+
+  DDesktopEntryIndex keeps the frequently used keys (Name and its localized values, Icon, Exec,
+  Categories, NoDisplay and MimeType) of all desktop files in the application directories in a
+  single file, the file is mapped and queried in place, so the clients don't need to parse every
+  desktop file. The index is updated incrementally, only the added or modified files are parsed.
+
+  The entries are identified by the desktop file ID, an entry in a directory of higher precedence
+  hides the entries of the same ID in the others. The entries which are hidden, not applications
+  or can't be parsed are not listed.
+
+  @sa DDesktopEntry
+ */
+
+/*!
+@~english
+  @brief Constructs an index of the applicationDirectories() stored in defaultIndexFile().
+  @sa DDesktopEntryIndex(const QStringList &, const QString &, QObject *)
+ */
+DDesktopEntryIndex::DDesktopEntryIndex(QObject *parent)
+    : DDesktopEntryIndex(applicationDirectories(), defaultIndexFile(applicationDirectories()), parent)
+{
+}
+
+/*!
+@~english
+  @brief Constructs an index of the desktop files in \a directories stored in \a indexFile.
+
+  The existing index file is loaded without scanning the directories, and the index is updated
+  in the event loop later, the updated() signal is emitted if something is changed. Call update()
+  to update it at once.
+ */
+DDesktopEntryIndex::DDesktopEntryIndex(const QStringList &directories, const QString &indexFile, QObject *parent)
+    : QObject(parent)
+    , DObject(*new DDesktopEntryIndexPrivate(this, directories, indexFile))
+{
+    D_D(DDesktopEntryIndex);
+
+    d->updateTimer = new QTimer(this);
+    d->updateTimer->setSingleShot(true);
+    d->updateTimer->setInterval(UPDATE_DELAY);
+    connect(d->updateTimer, &QTimer::timeout, this, &DDesktopEntryIndex::update);
+
+    d->load();
+    QMetaObject::invokeMethod(this, [this] { update(); }, Qt::QueuedConnection);
+}
+
+DDesktopEntryIndex::~DDesktopEntryIndex()
+{
+    D_D(DDesktopEntryIndex);
+    d->unload();
+}
+
+/*!
+@~english
+  @brief Returns the XDG application directories in order of precedence.
+ */
+QStringList DDesktopEntryIndex::applicationDirectories()
+{
+    return QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
+}
+
+/*!
+@~english
+  @brief Returns the paths of the desktop files whose ID is \a desktopId, e.g. "org.foo.desktop",
+  in all the applicationDirectories(), in order of precedence.
+
+  The IDs of the directories are kept in memory and rescanned after they're changed, so it's a
+  hash lookup in most cases.
+  @sa desktopIdOfFile()
+ */
+QStringList DDesktopEntryIndex::desktopFilePaths(const QString &desktopId)
+{
+    return desktopIdMap->filePaths(desktopId);
+}
+
+/*!
+@~english
+  @brief Returns the desktop file ID of the desktop file \a filePath in the
+  applicationDirectories(), or an empty string if it's not an existing desktop file of them.
+  @sa desktopFilePaths()
+ */
+QString DDesktopEntryIndex::desktopIdOfFile(const QString &filePath)
+{
+    return desktopIdMap->desktopId(filePath);
+}
+
+/*!
+@~english
+  @brief Returns the index file of \a directories in the cache directory, the processes with
+  different XDG directories use different index files.
+ */
+QString DDesktopEntryIndex::defaultIndexFile(const QStringList &directories)
+{
+    const QByteArray &key = QCryptographicHash::hash(directories.join(QLatin1Char('\0')).toUtf8(),
+                                                     QCryptographicHash::Sha1).toHex().left(16);
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QStringLiteral("/deepin/dtkcore/desktop-entry-%1.index").arg(QString::fromLatin1(key));
+}
+
+QStringList DDesktopEntryIndex::directories() const
+{
+    D_DC(DDesktopEntryIndex);
+    return d->directories;
+}
+
+QString DDesktopEntryIndex::indexFile() const
+{
+    D_DC(DDesktopEntryIndex);
+    return d->indexFilePath;
+}
+
+/*!
+@~english
+  @brief Returns true if the index file is loaded.
+ */
+bool DDesktopEntryIndex::isValid() const
+{
+    D_DC(DDesktopEntryIndex);
+    return d->data;
+}
+
+/*!
+@~english
+  @brief Scans the directories and parses the desktop files which are added or modified since
+  the last update, the index file is rewritten only when something is changed.
+
+  The updated() signal is emitted if the index is changed.
+  @return Returns false if the index file can't be written.
+ */
+bool DDesktopEntryIndex::update()
+{
+    D_D(DDesktopEntryIndex);
+
+    QVector<IndexRecord> records;
+    QSet<QString> ids;
+    bool changed = !d->data;
+    const QStringList directories = d->directories;
+    for (const QString &dir : directories) {
+        const QDir baseDir(dir);
+        QDirIterator it(dir, {QStringLiteral("*.desktop")}, QDir::Files,
+                        QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+        while (it.hasNext()) {
+            const QString &filePath = it.next();
+            QString desktopId = baseDir.relativeFilePath(filePath);
+            desktopId.replace(QLatin1Char('/'), QLatin1Char('-'));
+            if (ids.contains(desktopId))
+                continue;
+            ids.insert(desktopId);
+
+            const QFileInfo &info = it.fileInfo();
+            const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+            const qint64 size = info.size();
+            const QByteArray &rawId = desktopId.toUtf8();
+            const QByteArray &rawPath = filePath.toUtf8();
+
+            const int old = d->find(rawId);
+            if (old >= 0) {
+                IndexRecord record = d->readRecord(old);
+                if (record.strings[PathField] == rawPath && record.mtime == mtime && record.size == size) {
+                    records.append(std::move(record));
+                    continue;
+                }
+            }
+
+            changed = true;
+            IndexRecord record;
+            record.strings[IdField] = rawId;
+            record.strings[PathField] = rawPath;
+            record.mtime = mtime;
+            record.size = size;
+
+            DDesktopEntry entry(filePath);
+            if (entry.status() != DDesktopEntry::NoError
+                    || entry.stringValue(QStringLiteral("Type")) != QLatin1String("Application")
+                    || entry.stringValue(QStringLiteral("Hidden")) == QLatin1String("true")) {
+                record.flags |= IgnoredFlag;
+                records.append(std::move(record));
+                continue;
+            }
+
+            QStringList localizedNames;
+            for (const QString &key : entry.keys()) {
+                if (key.startsWith(QLatin1String("Name[")) && key.endsWith(QLatin1Char(']')))
+                    localizedNames << key.mid(5, key.size() - 6) << entry.stringValue(key);
+            }
+
+            record.strings[NameField] = entry.stringValue(QStringLiteral("Name")).toUtf8();
+            record.strings[LocalizedNamesField] = joinList(localizedNames);
+            record.strings[IconField] = entry.stringValue(QStringLiteral("Icon")).toUtf8();
+            record.strings[ExecField] = entry.stringValue(QStringLiteral("Exec")).toUtf8();
+            record.strings[CategoriesField] = joinList(entry.stringListValue(QStringLiteral("Categories")));
+            record.strings[MimeTypesField] = joinList(entry.stringListValue(QStringLiteral("MimeType")));
+            if (entry.stringValue(QStringLiteral("NoDisplay")) == QLatin1String("true"))
+                record.flags |= NoDisplayFlag;
+            records.append(std::move(record));
+        }
+    }
+
+    // new subdirectories need to be watched
+    d->watchDirectories();
+
+    // the removed files
+    if (!changed && records.size() == static_cast<int>(d->entryCount))
+        return true;
+
+    if (!d->save(records))
+        return false;
+
+    d->load();
+    Q_EMIT updated();
+    return true;
+}
+
+bool DDesktopEntryIndex::isWatchEnabled() const
+{
+    D_DC(DDesktopEntryIndex);
+    return d->watcher;
+}
+
+/*!
+@~english
+  @brief Watches the directories with DFileSystemWatcher if \a enabled is true, the index is
+  updated automatically after the desktop files are changed.
+ */
+void DDesktopEntryIndex::setWatchEnabled(bool enabled)
+{
+    D_D(DDesktopEntryIndex);
+
+    if (enabled == isWatchEnabled())
+        return;
+
+    if (!enabled) {
+        delete d->watcher;
+        d->watcher = nullptr;
+        d->updateTimer->stop();
+        return;
+    }
+
+    d->watcher = new DFileSystemWatcher(this);
+    auto scheduleUpdate = [d] {
+        d->scheduleUpdate();
+    };
+    connect(d->watcher, &DFileSystemWatcher::fileCreated, this, scheduleUpdate);
+    connect(d->watcher, &DFileSystemWatcher::fileDeleted, this, scheduleUpdate);
+    connect(d->watcher, &DFileSystemWatcher::fileModified, this, scheduleUpdate);
+    connect(d->watcher, &DFileSystemWatcher::fileMoved, this, scheduleUpdate);
+    connect(d->watcher, &DFileSystemWatcher::fileAttributeChanged, this, scheduleUpdate);
+    d->watchDirectories();
+}
+
+int DDesktopEntryIndex::count() const
+{
+    D_DC(DDesktopEntryIndex);
+    return d->visibleCount;
+}
+
+/*!
+@~english
+  @brief Returns the desktop file IDs of all entries, they're sorted by their UTF-8 bytes.
+ */
+QStringList DDesktopEntryIndex::desktopIds() const
+{
+    D_DC(DDesktopEntryIndex);
+
+    QStringList ids;
+    ids.reserve(d->visibleCount);
+    for (quint32 i = 0; i < d->entryCount; ++i) {
+        const uchar *record = d->record(i);
+        if (!(qFromLittleEndian<quint32>(record + RECORD_FLAGS_OFFSET) & IgnoredFlag))
+            ids << QString::fromUtf8(d->string(record, IdField));
+    }
+
+    return ids;
+}
+
+bool DDesktopEntryIndex::contains(const QString &desktopId) const
+{
+    D_DC(DDesktopEntryIndex);
+
+    const int index = d->find(desktopId.toUtf8());
+    return index >= 0 && !(qFromLittleEndian<quint32>(d->record(index) + RECORD_FLAGS_OFFSET) & IgnoredFlag);
+}
+
+/*!
+@~english
+  @brief Returns the entry of \a desktopId, a default-constructed entry is returned if it's not
+  existed.
+ */
+DDesktopEntryIndex::Entry DDesktopEntryIndex::entry(const QString &desktopId) const
+{
+    D_DC(DDesktopEntryIndex);
+
+    if (!contains(desktopId))
+        return Entry();
+    return d->entry(d->find(desktopId.toUtf8()));
+}
+
+QList<DDesktopEntryIndex::Entry> DDesktopEntryIndex::entries() const
+{
+    D_DC(DDesktopEntryIndex);
+
+    QList<Entry> entries;
+    entries.reserve(d->visibleCount);
+    for (quint32 i = 0; i < d->entryCount; ++i) {
+        if (!(qFromLittleEndian<quint32>(d->record(i) + RECORD_FLAGS_OFFSET) & IgnoredFlag))
+            entries << d->entry(i);
+    }
+
+    return entries;
+}
+
+/*!
+@~english
+  @brief Returns the name localized for \a locale.
+
+  The names of QLocale::name() and QLocale::bcp47Name() of \a locale are tried, then the one of
+  "C", and it falls back to the unlocalized name. It's the same as DDesktopEntry::name() when
+  \a locale is the default locale.
+ */
+QString DDesktopEntryIndex::Entry::localizedName(const QLocale &locale) const
+{
+    for (const QString &key : {locale.name(), locale.bcp47Name(), QStringLiteral("C")}) {
+        auto it = localizedNames.constFind(key);
+        if (it != localizedNames.constEnd())
+            return it.value();
+    }
+
+    return name;
+}
+
+DCORE_END_NAMESPACE
@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "ddesktopentrywatcher.h"
+#include "dfilewatchermanager.h"
+
+#include <DObjectPrivate>
+
+#include <QFileInfo>
+#include <QMap>
+#include <QSet>
+#include <QTimer>
+
+#include <algorithm>
+
+DCORE_BEGIN_NAMESPACE
+
+// an editor writes a file in several steps
+#define REFRESH_DELAY 200
+
+// the raw values of the keys in every section
+typedef QMap<QString, QMap<QString, QString>> DesktopEntryValues;
+
+class DDesktopEntryWatcherPrivate : public DObjectPrivate
+{
+public:
+    DDesktopEntryWatcherPrivate(DDesktopEntryWatcher *qq, const QString &filePath)
+        : DObjectPrivate(qq)
+        , filePath(QFileInfo(filePath).absoluteFilePath())
+        , entry(new DDesktopEntry(this->filePath))
+    {
+    }
+
+    DesktopEntryValues values() const;
+    void onFileChanged(const QString &path);
+
+    QString filePath;
+    QSharedPointer<DDesktopEntry> entry;
+    DFileWatcherManager *watcherManager = nullptr;
+    QTimer *refreshTimer = nullptr;
+
+    D_DECLARE_PUBLIC(DDesktopEntryWatcher)
+};
+
+DesktopEntryValues DDesktopEntryWatcherPrivate::values() const
+{
+    DesktopEntryValues values;
+    for (const QString &section : entry->allGroups()) {
+        QMap<QString, QString> &sectionValues = values[section];
+        for (const QString &key : entry->keys(section))
+            sectionValues.insert(key, entry->rawValue(key, section));
+    }
+    return values;
+}
+
+void DDesktopEntryWatcherPrivate::onFileChanged(const QString &path)
+{
+    if (path == filePath)
+        refreshTimer->start();
+}
+
+/*!
+@~english
+  @class Dtk::Core::DDesktopEntryWatcher
+  \inmodule dtkcore
+  @brief Keeps a DDesktopEntry in sync with its file.
+
+  DDesktopEntryWatcher watches the directory of the desktop file with DFileWatcherManager, so the
+  file is also followed when it is replaced by a rename, as the editors and QSaveFile do. After
+  the file is changed, only this file is read again, entry() is refreshed in place and keysChanged()
+  is emitted for every section whose keys are added, removed or changed. The clients don't need to
+  poll the file or recreate the entry.
+
+  @sa DDesktopEntry, DFileWatcherManager
+ */
+
+/*!
+@~english
+  @fn void DDesktopEntryWatcher::keysChanged(const QString &section, const QStringList &keys)
+  @brief The signal is emitted after the \a keys of \a section are added, removed or changed in
+  the file, the keys are sorted. If a section is added or removed, all of its keys are reported.
+ */
+
+/*!
+@~english
+  @brief Constructs a watcher of the desktop file \a filePath, the file is loaded before it returns.
+ */
+DDesktopEntryWatcher::DDesktopEntryWatcher(const QString &filePath, QObject *parent)
+    : QObject(parent)
+    , DObject(*new DDesktopEntryWatcherPrivate(this, filePath))
+{
+    D_D(DDesktopEntryWatcher);
+
+    d->refreshTimer = new QTimer(this);
+    d->refreshTimer->setSingleShot(true);
+    d->refreshTimer->setInterval(REFRESH_DELAY);
+    connect(d->refreshTimer, &QTimer::timeout, this, &DDesktopEntryWatcher::refresh);
+
+    d->watcherManager = new DFileWatcherManager(this);
+    auto onFileChanged = [d](const QString &path) {
+        d->onFileChanged(path);
+    };
+    connect(d->watcherManager, &DFileWatcherManager::fileModified, this, onFileChanged);
+    connect(d->watcherManager, &DFileWatcherManager::fileDeleted, this, onFileChanged);
+    connect(d->watcherManager, &DFileWatcherManager::subfileCreated, this, onFileChanged);
+    connect(d->watcherManager, &DFileWatcherManager::fileMoved, this, [d](const QString &from, const QString &to) {
+        d->onFileChanged(from);
+        d->onFileChanged(to);
+    });
+    d->watcherManager->add(QFileInfo(d->filePath).absolutePath());
+}
+
+DDesktopEntryWatcher::~DDesktopEntryWatcher()
+{
+}
+
+/*!
+@~english
+  @brief Returns the absolute path of the watched desktop file.
+ */
+QString DDesktopEntryWatcher::filePath() const
+{
+    D_DC(DDesktopEntryWatcher);
+    return d->filePath;
+}
+
+/*!
+@~english
+  @brief Returns the entry of the desktop file, the same object is kept up to date for the
+  lifetime of the watcher.
+
+  @note The unsaved modifications of the entry are discarded when the file is changed.
+ */
+QSharedPointer<DDesktopEntry> DDesktopEntryWatcher::entry() const
+{
+    D_DC(DDesktopEntryWatcher);
+    return d->entry;
+}
+
+/*!
+@~english
+  @brief Reads the file again and emits keysChanged() for the changed sections.
+
+  It's called automatically after the file is changed, calling it directly is only needed to
+  pick up the changes immediately.
+ */
+void DDesktopEntryWatcher::refresh()
+{
+    D_D(DDesktopEntryWatcher);
+
+    d->refreshTimer->stop();
+    const DesktopEntryValues &oldValues = d->values();
+    d->entry->reload();
+    const DesktopEntryValues &newValues = d->values();
+
+    QSet<QString> sections;
+    for (auto it = oldValues.cbegin(); it != oldValues.cend(); ++it)
+        sections.insert(it.key());
+    for (auto it = newValues.cbegin(); it != newValues.cend(); ++it)
+        sections.insert(it.key());
+
+    QStringList sortedSections = sections.values();
+    std::sort(sortedSections.begin(), sortedSections.end());
+
+    for (const QString &section : sortedSections) {
+        const QMap<QString, QString> &oldSection = oldValues.value(section);
+        const QMap<QString, QString> &newSection = newValues.value(section);
+        if (oldSection == newSection && oldValues.contains(section) == newValues.contains(section))
+            continue;
+
+        QStringList keys;
+        for (auto it = oldSection.cbegin(); it != oldSection.cend(); ++it) {
+            auto newIt = newSection.constFind(it.key());
+            if (newIt == newSection.cend() || newIt.value() != it.value())
+                keys << it.key();
+        }
+        for (auto it = newSection.cbegin(); it != newSection.cend(); ++it) {
+            if (!oldSection.contains(it.key()))
+                keys << it.key();
+        }
+        std::sort(keys.begin(), keys.end());
+
+        Q_EMIT keysChanged(section, keys);
+    }
+}
+
+DCORE_END_NAMESPACE
@@ -6,7 +6,11 @@
 
 #include <DObjectPrivate>
 
+#include <QCache>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
+#include <QMutex>
 #include <QJsonParseError>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -21,6 +25,7 @@ public:
     QString version;
     QString copyRight;
     QString licenseName;
+    DLicenseInfoPrivate *owner = nullptr;
 
 protected:
     explicit DComponentInfoPrivate(DLicenseInfo::DComponentInfo *qq)
@@ -63,6 +68,53 @@ QString DLicenseInfo::DComponentInfo::licenseName() const
     return d_func()->licenseName;
 }
 
+// the license texts shared by all the DLicenseInfo in the process, the same file is read
+// once until it's modified, and the least recently used texts are dropped over the budget
+class Q_DECL_HIDDEN LicenseContentCache
+{
+public:
+    static constexpr int Budget = 8 * 1024 * 1024;
+
+    QByteArray content(const QString &path)
+    {
+        const QFileInfo info(path);
+        if (!info.isFile())
+            return QByteArray();
+
+        QMutexLocker locker(&mutex);
+        if (Entry *entry = cache.object(path)) {
+            if (entry->modified == info.lastModified() && entry->size == info.size())
+                return entry->content;
+        }
+        locker.unlock();
+
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+            return QByteArray();
+
+        Entry *entry = new Entry{file.readAll(), info.lastModified(), info.size()};
+        const QByteArray content = entry->content;
+
+        locker.relock();
+        // the texts over the budget aren't cached, QCache deletes them
+        cache.insert(path, entry, content.size());
+        return content;
+    }
+
+private:
+    struct Entry
+    {
+        QByteArray content;
+        QDateTime modified;
+        qint64 size;
+    };
+
+    QMutex mutex;
+    QCache<QString, Entry> cache{Budget};
+};
+
+Q_GLOBAL_STATIC(LicenseContentCache, licenseContentCache)
+
 class Q_DECL_HIDDEN DLicenseInfoPrivate : public DObjectPrivate
 {
 public:
@@ -134,6 +186,7 @@ bool DLicenseInfoPrivate::loadContent(const QByteArray &content)
         componentInfo->d_func()->version = version.toString();
         componentInfo->d_func()->copyRight = copyright.toString();
         componentInfo->d_func()->licenseName = license.toString();
+        componentInfo->d_func()->owner = this;
         componentInfos.append(componentInfo);
     }
     return true;
@@ -146,14 +199,9 @@ QByteArray DLicenseInfoPrivate::licenseContent(const QString &licenseName)
     if (!licenseSearchPath.isEmpty())
         dirs.prepend(licenseSearchPath);
     for (const QString &dir : dirs) {
-        QFile file(QString("%1/%2.txt").arg(dir).arg(licenseName));
-        if (!file.exists())
-            continue;
-        if (file.open(QIODevice::ReadOnly)) {
-            content = file.readAll();
-            file.close();
+        content = licenseContentCache->content(QString("%1/%2.txt").arg(dir).arg(licenseName));
+        if (!content.isEmpty())
             break;
-        }
     }
     if (content.isEmpty()) {
         qWarning() << QString("License content is empty when getting license content!");
@@ -167,6 +215,22 @@ void DLicenseInfoPrivate::clear()
     componentInfos.clear();
 }
 
+/*!
+  @~english
+  @brief Get the license text of this component.
+
+  The text is read when it's requested for the first time, e.g. when the component is displayed,
+  and shared with all the other components using the same license.
+  @sa DLicenseInfo::licenseContent
+ */
+QByteArray DLicenseInfo::DComponentInfo::licenseContent() const
+{
+    D_DC(DComponentInfo);
+    if (!d->owner)
+        return QByteArray();
+    return d->owner->licenseContent(d->licenseName);
+}
+
 DLicenseInfo::DLicenseInfo(DObject *parent)
     : DObject(*new DLicenseInfoPrivate(this), parent)
 {
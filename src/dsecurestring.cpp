@@ -4,10 +4,26 @@
 
 #include "dsecurestring.h"
 #include "dutil.h"
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QVector>
+#include <cerrno>
 #include <cstring>
+#include <cstdlib>
+#include <new>
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 DCORE_BEGIN_NAMESPACE
 
+#ifdef QT_DEBUG
+Q_LOGGING_CATEGORY(logSecure, "dtk.dsecurestring")
+#else
+Q_LOGGING_CATEGORY(logSecure, "dtk.dsecurestring", QtInfoMsg)
+#endif
+
 DSecureString::DSecureString(const QString &other) noexcept
     : QString(other)
 {
@@ -15,7 +31,289 @@ DSecureString::DSecureString(const QString &other) noexcept
 
 DSecureString::~DSecureString()
 {
-    DUtil::SecureErase(*this);
+    // erasing a shared string only erases a detached copy, the last owner erases it
+    if (isDetached())
+        DUtil::SecureErase(*this);
+}
+
+static void secureZero(void *ptr, size_t size)
+{
+    volatile char *p = static_cast<volatile char *>(ptr);
+    while (size--)
+        *p++ = 0;
+}
+
+/*
+ * The memory of DSecureBuffer, the chunks are locked in RAM(never swapped), excluded from
+ * the core dumps and surrounded by the inaccessible guard pages. The blocks are bump allocated
+ * from the chunks in the power of two sizes, and recycled by the free lists after erased, so
+ * the secrets don't pay for a mmap and a mlock each. The large blocks are mapped alone.
+ */
+class SecureArena
+{
+public:
+    static constexpr size_t MinBlockSize = 32;
+    static constexpr size_t MaxBlockSize = 16 * 1024;
+    static constexpr size_t ChunkSize = 64 * 1024;
+
+    static SecureArena &instance()
+    {
+        // never destroyed, the buffers may be freed by the other global objects at exit
+        static SecureArena *arena = new SecureArena;
+        return *arena;
+    }
+
+    static size_t blockSize(size_t size)
+    {
+        size_t block = MinBlockSize;
+        while (block < size)
+            block <<= 1;
+        return block;
+    }
+
+    void *allocate(size_t size)
+    {
+        if (size > MaxBlockSize)
+            return mapRegion(size);
+
+        QMutexLocker locker(&mutex);
+        FreeBlock *&list = freeLists[sizeClass(size)];
+        if (list) {
+            FreeBlock *block = list;
+            list = block->next;
+            return block;
+        }
+
+        if (!current || currentUsed + size > ChunkSize) {
+            current = static_cast<char *>(mapRegion(ChunkSize));
+            currentUsed = 0;
+        }
+
+        void *block = current + currentUsed;
+        currentUsed += size;
+        return block;
+    }
+
+    void deallocate(void *ptr, size_t size)
+    {
+        secureZero(ptr, size);
+        if (size > MaxBlockSize) {
+            unmapRegion(ptr, size);
+            return;
+        }
+
+        QMutexLocker locker(&mutex);
+        FreeBlock *block = static_cast<FreeBlock *>(ptr);
+        block->next = freeLists[sizeClass(size)];
+        freeLists[sizeClass(size)] = block;
+    }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    static int sizeClass(size_t size)
+    {
+        int index = 0;
+        for (size_t block = MinBlockSize; block < size; block <<= 1)
+            ++index;
+        return index;
+    }
+
+    static size_t pageSize()
+    {
+#ifdef Q_OS_LINUX
+        static const size_t size = size_t(sysconf(_SC_PAGESIZE));
+        return size;
+#else
+        return 4096;
+#endif
+    }
+
+    void *mapRegion(size_t size)
+    {
+#ifdef Q_OS_LINUX
+        const size_t page = pageSize();
+        const size_t length = (size + page - 1) / page * page;
+        // a guard page before and after the region
+        char *base = static_cast<char *>(mmap(nullptr, length + 2 * page, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (base == MAP_FAILED)
+            throw std::bad_alloc();
+
+        char *region = base + page;
+        if (mprotect(region, length, PROT_READ | PROT_WRITE) != 0) {
+            munmap(base, length + 2 * page);
+            throw std::bad_alloc();
+        }
+
+        if (mlock(region, length) != 0 && !lockFailed) {
+            lockFailed = true;
+            qCWarning(logSecure, "Failed to lock the secure memory, it may be swapped: %s", strerror(errno));
+        }
+#ifdef MADV_DONTDUMP
+        madvise(region, length, MADV_DONTDUMP);
+#endif
+        return region;
+#else
+        void *region = std::malloc(size);
+        if (!region)
+            throw std::bad_alloc();
+        return region;
+#endif
+    }
+
+    void unmapRegion(void *ptr, size_t size)
+    {
+#ifdef Q_OS_LINUX
+        const size_t page = pageSize();
+        const size_t length = (size + page - 1) / page * page;
+        munlock(ptr, length);
+        munmap(static_cast<char *>(ptr) - page, length + 2 * page);
+#else
+        Q_UNUSED(size);
+        std::free(ptr);
+#endif
+    }
+
+    QMutex mutex;
+    FreeBlock *freeLists[10] = {};
+    char *current = nullptr;
+    size_t currentUsed = 0;
+    bool lockFailed = false;
+};
+
+/*!
+  \class Dtk::Core::DSecureBuffer
+  \inmodule dtkcore
+  \brief 保存敏感文本(例如密码)的缓冲区.
+
+  与 DSecureString 不同, DSecureBuffer 的数据保存在锁定的内存中: 不会被交换到磁盘, 不会写入
+  core dump, 且前后有不可访问的保护页. 它不使用隐式共享, 复制时复制数据, 扩容时旧的数据会被清除,
+  所有数据都不会离开锁定的内存. 释放时数据被清零.
+  \note toRawString 返回的 QString 直接引用缓冲区中的数据, 修改它会将数据复制到普通的内存中.
+ */
+
+DSecureBuffer::DSecureBuffer() noexcept
+{
+}
+
+DSecureBuffer::DSecureBuffer(QStringView text)
+{
+    append(text);
+}
+
+DSecureBuffer::DSecureBuffer(const DSecureBuffer &other)
+{
+    append(other.view());
+}
+
+DSecureBuffer::DSecureBuffer(DSecureBuffer &&other) noexcept
+    : m_data(other.m_data)
+    , m_size(other.m_size)
+    , m_capacity(other.m_capacity)
+{
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_capacity = 0;
+}
+
+DSecureBuffer::~DSecureBuffer()
+{
+    if (m_data)
+        SecureArena::instance().deallocate(m_data, size_t(m_capacity) * sizeof(QChar));
+}
+
+DSecureBuffer &DSecureBuffer::operator=(const DSecureBuffer &other)
+{
+    if (this != &other) {
+        clear();
+        append(other.view());
+    }
+    return *this;
+}
+
+DSecureBuffer &DSecureBuffer::operator=(DSecureBuffer &&other) noexcept
+{
+    if (this != &other) {
+        this->~DSecureBuffer();
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_capacity = other.m_capacity;
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_capacity = 0;
+    }
+    return *this;
+}
+
+/*!
+  \brief 返回引用缓冲区数据的 QString, 不复制数据, 在缓冲区被修改或销毁之前有效.
+ */
+QString DSecureBuffer::toRawString() const
+{
+    return QString::fromRawData(m_data, m_size);
+}
+
+/*!
+  \brief 预先分配至少可以保存 \a size 个字符的内存.
+ */
+void DSecureBuffer::reserve(int size)
+{
+    if (size > m_capacity)
+        reallocate(size);
+}
+
+void DSecureBuffer::append(QChar ch)
+{
+    append(QStringView(&ch, 1));
+}
+
+void DSecureBuffer::append(QStringView text)
+{
+    if (text.isEmpty())
+        return;
+
+    const int size = m_size + int(text.size());
+    if (size > m_capacity)
+        reallocate(qMax(size, m_capacity * 2));
+
+    memcpy(m_data + m_size, text.data(), size_t(text.size()) * sizeof(QChar));
+    m_size = size;
+}
+
+/*!
+  \brief 删除末尾的 \a n 个字符, 被删除的数据会被清零.
+ */
+void DSecureBuffer::chop(int n)
+{
+    n = qBound(0, n, m_size);
+    m_size -= n;
+    secureZero(m_data + m_size, size_t(n) * sizeof(QChar));
+}
+
+/*!
+  \brief 清除所有的数据, 保留已分配的内存.
+ */
+void DSecureBuffer::clear()
+{
+    chop(m_size);
+}
+
+void DSecureBuffer::reallocate(int capacity)
+{
+    SecureArena &arena = SecureArena::instance();
+    const size_t bytes = SecureArena::blockSize(size_t(capacity) * sizeof(QChar));
+    QChar *data = static_cast<QChar *>(arena.allocate(bytes));
+    if (m_data) {
+        memcpy(data, m_data, size_t(m_size) * sizeof(QChar));
+        // the old block is erased when it's freed
+        arena.deallocate(m_data, size_t(m_capacity) * sizeof(QChar));
+    }
+
+    m_data = data;
+    m_capacity = int(bytes / sizeof(QChar));
 }
 
 DCORE_END_NAMESPACE
@@ -3,8 +3,10 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "dsgapplication.h"
+#include "util/ddbuscalltrace_p.h"
 
 #include <sys/syscall.h>
+#include <poll.h>
 #include <unistd.h>
 
 #include <QDir>
@@ -14,6 +16,16 @@
 #include <QDebug>
 #include <QRegularExpression>
 #include <QLoggingCategory>
+#include <QElapsedTimer>
+#include <QFutureInterface>
+#include <QHash>
+#include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <functional>
+#include <memory>
+#include <utility>
 
 #include <dbus/dbus.h>
 
@@ -39,22 +51,53 @@ static void dbusMessageDeleter(DBusMessage *msg) {
 }
 
 // D-Bus utility functions using libdbus-1
+
+/*
+ * The connection to the session bus shared by the calls below. It's a private connection
+ * opened on the first use, so it works before QCoreApplication is created, it doesn't make
+ * the process exit when the bus is gone like the one of dbus_bus_get(), and it's opened
+ * again if it's disconnected.
+ */
+static QMutex connectionMutex;
+static DBusConnection *sessionConnection = nullptr;
+
+using DBusConnectionPtr = std::unique_ptr<DBusConnection, void(*)(DBusConnection*)>;
+
+static DBusConnectionPtr getSessionConnection(DBusError *error)
+{
+    QMutexLocker locker(&connectionMutex);
+    if (sessionConnection && !dbus_connection_get_is_connected(sessionConnection)) {
+        dbus_connection_close(sessionConnection);
+        dbus_connection_unref(sessionConnection);
+        sessionConnection = nullptr;
+    }
+
+    if (!sessionConnection) {
+        dbus_threads_init_default();
+        sessionConnection = dbus_bus_get_private(DBUS_BUS_SESSION, error);
+        if (!sessionConnection)
+            return DBusConnectionPtr(nullptr, dbusConnectionDeleter);
+        dbus_connection_set_exit_on_disconnect(sessionConnection, FALSE);
+    }
+
+    return DBusConnectionPtr(dbus_connection_ref(sessionConnection), dbusConnectionDeleter);
+}
 static bool checkDBusServiceActivatable(const QByteArray &service)
 {
     auto error = std::unique_ptr<DBusError, void(*)(DBusError*)>(new DBusError, dbusErrorDeleter);
     dbus_error_init(error.get());
 
-    DBusConnection *connection = dbus_bus_get(DBUS_BUS_SESSION, error.get());
+    auto connGuard = getSessionConnection(error.get());
     if (dbus_error_is_set(error.get())) {
         qCWarning(dsgApp) << "Failed to connect to session bus:" << error->message;
         return false;
     }
 
-    if (!connection) {
+    if (!connGuard) {
         qCWarning(dsgApp) << "Failed to get session bus connection";
         return false;
     }
-    auto connGuard = std::unique_ptr<DBusConnection, void(*)(DBusConnection*)>(connection, dbusConnectionDeleter);
+    DBusConnection *connection = connGuard.get();
 
     // Create method call to check if service is registered
     DBusMessage *msg = dbus_message_new_method_call(
@@ -158,17 +201,17 @@ static QByteArray callDBusIdentifyMethod(const QByteArray &serviceName, const QB
     auto error = std::unique_ptr<DBusError, void(*)(DBusError*)>(new DBusError, dbusErrorDeleter);
     dbus_error_init(error.get());
 
-    DBusConnection *connection = dbus_bus_get(DBUS_BUS_SESSION, error.get());
+    auto connGuard = getSessionConnection(error.get());
     if (dbus_error_is_set(error.get())) {
         qCWarning(dsgApp) << "Failed to connect to session bus:" << error->message;
         return QByteArray();
     }
 
-    if (!connection) {
+    if (!connGuard) {
         qCWarning(dsgApp) << "Failed to get session bus connection";
         return QByteArray();
     }
-    auto connGuard = std::unique_ptr<DBusConnection, void(*)(DBusConnection*)>(connection, dbusConnectionDeleter);
+    DBusConnection *connection = connGuard.get();
 
     // Create method call - string data is now managed by caller
     DBusMessage *msg = dbus_message_new_method_call(
@@ -191,7 +234,12 @@ static QByteArray callDBusIdentifyMethod(const QByteArray &serviceName, const QB
     }
 
     // Send message and get reply
-    DBusMessage *reply = dbus_connection_send_with_reply_and_block(connection, msg, 5000, error.get());
+    DBusMessage *reply = nullptr;
+    {
+        DDBusCallSpan span(QString::fromLatin1(serviceName), QString::fromLatin1(path),
+                           QString::fromLatin1(interface), QStringLiteral("Identify"));
+        reply = dbus_connection_send_with_reply_and_block(connection, msg, 5000, error.get());
+    }
     msgGuard.reset(); // msg is consumed by the call
 
     if (dbus_error_is_set(error.get())) {
@@ -225,11 +273,136 @@ static inline QByteArray getSelfAppId() {
     return DSGApplication::getId(QCoreApplication::applicationPid());
 }
 
+// the unavailability is rechecked after a while, the AM may be started later
+static const qint64 ServiceRecheckInterval = 5000;
+
+struct ServiceState
+{
+    bool activatable = false;
+    QElapsedTimer checked;
+};
+
+static QMutex serviceMutex;
+static QHash<QByteArray, ServiceState> serviceStates;
+
 static bool isServiceActivatable(const QByteArray &service)
 {
-    return checkDBusServiceActivatable(service);
+    {
+        QMutexLocker locker(&serviceMutex);
+        auto it = serviceStates.constFind(service);
+        if (it != serviceStates.constEnd() && (it->activatable || it->checked.elapsed() < ServiceRecheckInterval))
+            return it->activatable;
+    }
+
+    ServiceState state;
+    state.activatable = checkDBusServiceActivatable(service);
+    state.checked.start();
+    QMutexLocker locker(&serviceMutex);
+    serviceStates.insert(service, state);
+    return state.activatable;
+}
+
+// the next call checks the service again, e.g. it's failed
+static void invalidateService(const QByteArray &service)
+{
+    QMutexLocker locker(&serviceMutex);
+    serviceStates.remove(service);
 }
 
+/*
+ * The app ids of the processes, every entry holds a pidfd of the process, which becomes
+ * readable when the process exits, so an entry is never used for another process which
+ * reuses the pid later.
+ */
+class Q_DECL_HIDDEN AppIdCache
+{
+public:
+    ~AppIdCache()
+    {
+        for (const Entry &entry : std::as_const(m_entries))
+            close(entry.pidfd);
+    }
+
+    QByteArray find(qint64 pid)
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(pid);
+        if (it == m_entries.end())
+            return QByteArray();
+        if (isExited(it->pidfd)) {
+            close(it->pidfd);
+            m_entries.erase(it);
+            return QByteArray();
+        }
+        return it->appId;
+    }
+
+    // takes the pidfd
+    void insert(qint64 pid, int pidfd, const QByteArray &appId)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_entries.size() >= MaxEntries)
+            evict();
+
+        auto it = m_entries.find(pid);
+        if (it != m_entries.end())
+            close(it->pidfd);
+        m_entries.insert(pid, {pidfd, appId, ++m_serial});
+    }
+
+private:
+    struct Entry
+    {
+        int pidfd;
+        QByteArray appId;
+        quint64 serial;
+    };
+
+    static bool isExited(int pidfd)
+    {
+        pollfd fd{pidfd, POLLIN, 0};
+        return poll(&fd, 1, 0) != 0;
+    }
+
+    // drops the exited processes, or the oldest entry if none exits
+    void evict()
+    {
+        auto oldest = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (isExited(it->pidfd)) {
+                close(it->pidfd);
+                it = m_entries.erase(it);
+                continue;
+            }
+            if (oldest == m_entries.end() || it->serial < oldest->serial)
+                oldest = it;
+            ++it;
+        }
+        if (m_entries.size() >= MaxEntries && oldest != m_entries.end()) {
+            close(oldest->pidfd);
+            m_entries.erase(oldest);
+        }
+    }
+
+    static const int MaxEntries = 256;
+    QMutex m_mutex;
+    QHash<qint64, Entry> m_entries;
+    quint64 m_serial = 0;
+};
+Q_GLOBAL_STATIC(AppIdCache, appIdCache)
+
+class Q_DECL_HIDDEN DSGApplicationRunner : public QRunnable
+{
+public:
+    explicit DSGApplicationRunner(std::function<void()> function)
+        : function(std::move(function)) {}
+
+    void run() override { function(); }
+
+private:
+    std::function<void()> function;
+};
+
 // Format appId to valid.
 static QByteArray formatAppId(const QByteArray &appId)
 {
@@ -243,11 +416,25 @@ static QByteArray formatAppId(const QByteArray &appId)
     return format.toLocal8Bit();
 }
 
+// the resolved id, it's reset if the application name is changed
+static QAtomicPointer<const QByteArray> resolvedId;
+
+static void resetResolvedId()
+{
+    // the old one may be being read by another thread, it's leaked, the name rarely changes.
+    resolvedId.storeRelease(nullptr);
+}
+
 QByteArray DSGApplication::id()
 {
+    if (const QByteArray *id = resolvedId.loadAcquire())
+        return *id;
+
     static QByteArray selfId = getSelfAppId();
-    if (!selfId.isEmpty())
+    if (!selfId.isEmpty()) {
+        resolvedId.testAndSetRelease(nullptr, &selfId);
         return selfId;
+    }
     QByteArray result = selfId;
     if (!qEnvironmentVariableIsSet("DTK_DISABLED_FALLBACK_APPID")) {
         result = QCoreApplication::applicationName().toLocal8Bit();
@@ -269,6 +456,19 @@ QByteArray DSGApplication::id()
     if (result.isEmpty())
         qCWarning(dsgApp) << "The application ID is empty.";
 
+    // the name isn't final until the application is created
+    if (QCoreApplication *app = QCoreApplication::instance()) {
+        static const bool watched = [app] {
+            QObject::connect(app, &QCoreApplication::applicationNameChanged, app, resetResolvedId, Qt::DirectConnection);
+            return true;
+        }();
+        Q_UNUSED(watched)
+
+        const QByteArray *id = new QByteArray(result);
+        if (!resolvedId.testAndSetRelease(nullptr, id))
+            delete id;
+    }
+
     return result;
 }
 
@@ -281,12 +481,20 @@ QByteArray DSGApplication::id()
  * is being started by D-Bus activation and DSGApplication::id() is called
  * during early startup.
  *
+ * The IDs are cached until the processes exit, and whether the AM is available
+ * is cached too, so identifying a known process again costs a lookup.
+ *
  * @param pid Process ID to get the application ID for
  * @return Application ID as QByteArray, or empty array on failure
  */
 QByteArray DSGApplication::getId(qint64 pid)
 {
-    if (!isServiceActivatable("org.desktopspec.ApplicationManager1")) {
+    const QByteArray &cached = appIdCache->find(pid);
+    if (!cached.isEmpty())
+        return cached;
+
+    static const QByteArray service("org.desktopspec.ApplicationManager1");
+    if (!isServiceActivatable(service)) {
         qCInfo(dsgApp) << "Can't getId from AM for the " << pid << ", because AM is unavailable.";
         return QByteArray();
     }
@@ -297,14 +505,47 @@ QByteArray DSGApplication::getId(qint64 pid)
         return QByteArray();
     }
 
-    QByteArray appId = callDBusIdentifyMethod("org.desktopspec.ApplicationManager1",
+    QByteArray appId = callDBusIdentifyMethod(service,
                                               "/org/desktopspec/ApplicationManager1",
                                               "org.desktopspec.ApplicationManager1",
                                               pidfd);
     // see QDBusUnixFileDescriptor: The original file descriptor is not touched and must be closed by the user.
-    close(pidfd);
+    // the cache keeps it to know when the process exits.
+    if (appId.isEmpty()) {
+        close(pidfd);
+        invalidateService(service);
+        return appId;
+    }
 
+    appIdCache->insert(pid, pidfd, appId);
     return appId;
 }
 
+/**
+ * Get application ID for a given process ID in the global thread pool
+ *
+ * The future is finished already if the ID is cached.
+ *
+ * @param pid Process ID to get the application ID for
+ * @return The future of the application ID, which is empty on failure
+ */
+QFuture<QByteArray> DSGApplication::getIdAsync(qint64 pid)
+{
+    auto result = std::make_shared<QFutureInterface<QByteArray>>(QFutureInterfaceBase::Started);
+    QFuture<QByteArray> future = result->future();
+
+    const QByteArray &cached = appIdCache->find(pid);
+    if (!cached.isEmpty()) {
+        result->reportResult(cached);
+        result->reportFinished();
+        return future;
+    }
+
+    QThreadPool::globalInstance()->start(new DSGApplicationRunner([result, pid]() {
+        result->reportResult(getId(pid));
+        result->reportFinished();
+    }));
+    return future;
+}
+
 DCORE_END_NAMESPACE
@@ -6,13 +6,11 @@
 #include "ddesktopentry.h"
 
 #include <QFile>
+#include <QFileInfo>
+#include <QDir>
 #include <QLocale>
 #include <QStorageInfo>
-#include <QProcess>
 #include <QDebug>
-#include <QJsonObject>
-#include <QJsonDocument>
-#include <QJsonArray>
 #include <QSettings>
 #include <QStandardPaths>
 #include <QDateTime>
@@ -21,13 +19,32 @@
 #include <qmath.h>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QHash>
+#include <QVector>
+#include <QSharedPointer>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QFutureInterface>
+#include <QtEndian>
 
 #ifdef Q_OS_LINUX
 #include <sys/sysinfo.h>
 #include <sys/utsname.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
 #include <unistd.h>
+#include <utmpx.h>
+#include <paths.h>
+#include <time.h>
+#include <errno.h>
 #endif
 
+#include <cstring>
+#include <functional>
+#include <memory>
+
 #define OS_VERSION_FILE     DSYSINFO_PREFIX"/etc/os-version"
 #define LSB_RELEASE_FILE    DSYSINFO_PREFIX"/etc/lsb-release"
 #define OS_RELEASE_FILE     DSYSINFO_PREFIX"/etc/os-release"
@@ -46,6 +63,45 @@ Q_LOGGING_CATEGORY(logSysInfo, "dtk.dsysinfo")
 Q_LOGGING_CATEGORY(logSysInfo, "dtk.dsysinfo", QtInfoMsg)
 #endif
 
+// the "key=value" lines of a file, e.g. os-release, and the "[Section]" lines of the ini files,
+// e.g. os-version, the file is read once, and the entries refer to the content without copying
+class Q_DECL_HIDDEN DInfoFile
+{
+public:
+    struct Entry {
+        QByteArray section;
+        QByteArray key;
+        QByteArray value;
+    };
+
+    bool load(const char *fileName, char separator = '=');
+    inline bool isValid() const { return valid; }
+    inline const QVector<Entry> &entries() const { return fileEntries; }
+
+    // any section if section is null
+    const Entry *find(const QByteArray &key, const QByteArray &section = QByteArray()) const;
+    inline bool contains(const QByteArray &key, const QByteArray &section = QByteArray()) const
+    {
+        return find(key, section);
+    }
+    QString stringValue(const QByteArray &key, const QByteArray &section = QByteArray(),
+                        const QString &defaultValue = QString()) const;
+
+private:
+    QByteArray content;
+    QVector<Entry> fileEntries;
+    bool valid = false;
+};
+
+// the files which are read once and shared by the accessors, they're immutable after loaded
+struct DSysInfoFiles
+{
+    DInfoFile osVersion;
+    DInfoFile osRelease;
+    DInfoFile lsbRelease;
+    DInfoFile deepinVersion;
+};
+
 class Q_DECL_HIDDEN DSysInfoPrivate
 {
 public:
@@ -61,8 +117,12 @@ public:
 #endif
     void ensureReleaseInfo();
     void ensureComputerInfo();
-    QMap<QString, QString> parseInfoFile(QFile &file);
-    QMap<QString, QString> parseInfoContent(const QString &content);
+#ifdef Q_OS_LINUX
+    // the persistent cache, it's used with the mutex locked
+    QString cachedValue(const QString &name);
+    void cacheValues(const QHash<QString, QString> &values);
+#endif
+    QSharedPointer<const DSysInfoFiles> files();
 #ifdef Q_OS_LINUX
     DSysInfo::DeepinType deepinType = DSysInfo::DeepinType(-1);
     QMap<QString, QString> deepinTypeMap; //Type Name with Language
@@ -111,6 +171,8 @@ public:
     OSBuild osBuild;
 #endif
 
+    QMutex filesMutex;
+    QSharedPointer<const DSysInfoFiles> infoFiles;
     QScopedPointer<DDesktopEntry> distributionInfo;
 
     DSysInfo::ProductType productType = DSysInfo::ProductType(-1);
@@ -123,6 +185,12 @@ public:
     qint64 memoryAvailableSize = -1;
     qint64 memoryInstalledSize = -1;
     qint64 diskSize = 0;
+
+#ifdef Q_OS_LINUX
+    bool cacheLoaded = false;
+    QByteArray cacheKey;
+    QHash<QString, QString> cache;
+#endif
 };
 
 DSysInfoPrivate::DSysInfoPrivate()
@@ -130,9 +198,222 @@ DSysInfoPrivate::DSysInfoPrivate()
 
 }
 
+static inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static QByteArray rawTrimmed(const char *begin, const char *end)
+{
+    while (begin < end && isBlank(*begin))
+        ++begin;
+    while (end > begin && isBlank(end[-1]))
+        --end;
+
+    return QByteArray::fromRawData(begin, static_cast<int>(end - begin));
+}
+
+bool DInfoFile::load(const char *fileName, char separator)
+{
+    // 因为此类文件一般不会超过1M大小，超过1M大小大概率出现异常情况
+    // 避免文件内容异常导致出现问题，对文件大小做了限制
+    constexpr qint64 MaxFileSize = 1024000;
+
+    fileEntries.clear();
+    content.clear();
+    valid = false;
+
+    QFile file(QString::fromLocal8Bit(fileName));
+    if (!file.open(QFile::ReadOnly))
+        return false;
+
+    // the files of /proc have no size, so the size is checked after reading
+    content = file.read(MaxFileSize + 1);
+    if (content.size() > MaxFileSize) {
+        qCWarning(logSysInfo) << "Size is too big, is it broken? File :" << file.fileName();
+        content.clear();
+        return false;
+    }
+    valid = true;
+
+    QByteArray section;
+    const char *begin = content.constData();
+    const char *const end = begin + content.size();
+    while (begin < end) {
+        const char *lineEnd = static_cast<const char *>(memchr(begin, '\n', size_t(end - begin)));
+        if (!lineEnd)
+            lineEnd = end;
+        const QByteArray &line = rawTrimmed(begin, lineEnd);
+        begin = lineEnd + 1;
+
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        if (line.startsWith('[') && line.endsWith(']')) {
+            section = QByteArray::fromRawData(line.constData() + 1, line.size() - 2);
+            continue;
+        }
+
+        const int index = line.indexOf(separator);
+        if (index <= 0)
+            continue;
+
+        fileEntries.append({section,
+                            rawTrimmed(line.constData(), line.constData() + index),
+                            rawTrimmed(line.constData() + index + 1, line.constData() + line.size())});
+    }
+
+    return true;
+}
+
+const DInfoFile::Entry *DInfoFile::find(const QByteArray &key, const QByteArray &section) const
+{
+    for (const Entry &entry : fileEntries) {
+        if (entry.key == key && (section.isNull() || entry.section == section))
+            return &entry;
+    }
+
+    return nullptr;
+}
+
+QString DInfoFile::stringValue(const QByteArray &key, const QByteArray &section, const QString &defaultValue) const
+{
+    const Entry *entry = find(key, section);
+    return entry ? QString::fromUtf8(entry->value) : defaultValue;
+}
+
+QSharedPointer<const DSysInfoFiles> DSysInfoPrivate::files()
+{
+    QMutexLocker locker(&filesMutex);
+    // Always re-read the files when testing
+    if (infoFiles && !inTest())
+        return infoFiles;
+
+    auto files = QSharedPointer<DSysInfoFiles>::create();
+#ifdef Q_OS_LINUX
+    files->osVersion.load(OS_VERSION_FILE);
+    if (!files->osRelease.load(OS_RELEASE_FILE) || files->osRelease.entries().isEmpty())
+        files->osRelease.load(DSYSINFO_PREFIX"/usr/lib/os-release");
+    files->lsbRelease.load(LSB_RELEASE_FILE);
+    files->deepinVersion.load(DEEPIN_VERSION_FILE);
+#endif
+    infoFiles = files;
+
+    return infoFiles;
+}
+
 #ifdef Q_OS_LINUX
+/*!
+@~english
+  \internal
+
+    @brief The facts of the system which don't change in a boot, e.g. the parsed release files
+    and the cpu model name, are cached in "$XDG_RUNTIME_DIR/dtk-sysinfo.cache", so that the
+    processes started at login don't each parse and probe them again. The cache is keyed by the
+    boot ID and the stamps of the release files, it's enabled by `DTK_SYSINFO_CACHE=1`.
+ */
+static const quint32 SysInfoCacheMagic = 0x44534943; // "DSIC"
+
+static bool sysInfoCacheEnabled()
+{
+    static const bool enabled = qEnvironmentVariableIntValue("DTK_SYSINFO_CACHE") == 1;
+    return enabled && !inTest();
+}
+
+static QString sysInfoCachePath()
+{
+    const QString &runtimeDir = qEnvironmentVariable("XDG_RUNTIME_DIR");
+    return runtimeDir.isEmpty() ? QString() : runtimeDir + QLatin1String("/dtk-sysinfo.cache");
+}
+
+static QByteArray fileStamp(const char *fileName)
+{
+    const QFileInfo info(QString::fromLatin1(fileName));
+    if (!info.exists())
+        return QByteArray();
+
+    return QByteArray::number(info.lastModified().toMSecsSinceEpoch()) + ':' + QByteArray::number(info.size());
+}
+
+static QByteArray sysInfoCacheKey()
+{
+    QFile file("/proc/sys/kernel/random/boot_id");
+    if (!file.open(QFile::ReadOnly))
+        return QByteArray();
+
+    const QByteArray &bootId = file.readAll().trimmed();
+    if (bootId.isEmpty())
+        return QByteArray();
+
+    return bootId + ';' + fileStamp(OS_RELEASE_FILE) + ';' + fileStamp(DSYSINFO_PREFIX"/usr/lib/os-release")
+            + ';' + fileStamp(LSB_RELEASE_FILE) + ';' + fileStamp(DEEPIN_VERSION_FILE);
+}
+
+static QHash<QString, QString> readSysInfoCache(const QString &path, const QByteArray &key)
+{
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly))
+        return {};
+
+    QDataStream stream(&file);
+    // the cache is shared by the processes of Qt5 and Qt6
+    stream.setVersion(QDataStream::Qt_5_6);
+    quint32 magic = 0;
+    QByteArray cacheKey;
+    QHash<QString, QString> values;
+    stream >> magic >> cacheKey >> values;
+    if (stream.status() != QDataStream::Ok || magic != SysInfoCacheMagic || cacheKey != key)
+        return {};
+
+    return values;
+}
+
+QString DSysInfoPrivate::cachedValue(const QString &name)
+{
+    if (!sysInfoCacheEnabled())
+        return QString();
+
+    if (!cacheLoaded) {
+        cacheLoaded = true;
+        cacheKey = sysInfoCacheKey();
+        if (!cacheKey.isEmpty())
+            cache = readSysInfoCache(sysInfoCachePath(), cacheKey);
+    }
+
+    return cache.value(name);
+}
+
+void DSysInfoPrivate::cacheValues(const QHash<QString, QString> &values)
+{
+    // loads the cache
+    cachedValue(QString());
+    const QString &path = sysInfoCachePath();
+    if (!sysInfoCacheEnabled() || cacheKey.isEmpty() || path.isEmpty())
+        return;
+
+    // keeps the values which are cached by the other processes meanwhile
+    const QHash<QString, QString> &current = readSysInfoCache(path, cacheKey);
+    for (auto it = current.cbegin(); it != current.cend(); ++it)
+        cache.insert(it.key(), it.value());
+    for (auto it = values.cbegin(); it != values.cend(); ++it)
+        cache.insert(it.key(), it.value());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCDebug(logSysInfo) << "failed to open the cache:" << path << file.errorString();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+    stream << SysInfoCacheMagic << cacheKey << cache;
+    if (!file.commit())
+        qCDebug(logSysInfo) << "failed to write the cache:" << path << file.errorString();
+}
+
 void DSysInfoPrivate::ensureDistributionInfo()
 {
+    QMutexLocker locker(&mutex);
     if (distributionInfo)
         return;
 
@@ -178,58 +459,52 @@ void DSysInfoPrivate::ensureDeepinInfo()
     if (inTest())
         deepinTypeMap.clear(); // clear cache for test
 
-    QFile file(DEEPIN_VERSION_FILE);
-
-    if (!file.open(QFile::ReadOnly)) {
-        deepinType = DSysInfo::UnknownDeepin;
-
+    const QString &cachedType = cachedValue("deepinType");
+    if (!cachedType.isEmpty()) {
+        deepinType = static_cast<DSysInfo::DeepinType>(cachedType.toInt());
+        deepinVersion = cachedValue("deepinVersion");
+        deepinEdition = cachedValue("deepinEdition");
+        deepinCopyright = cachedValue("deepinCopyright");
+        // "deepinTypeName[<language>]"
+        for (auto it = cache.cbegin(); it != cache.cend(); ++it) {
+            if (it.key().startsWith("deepinTypeName["))
+                deepinTypeMap.insert(it.key().mid(15, it.key().size() - 16), it.value());
+        }
         return;
     }
 
-    char buf[1024];
-    int buf_length = 0;
-
-    Q_FOREVER {
-        buf_length = file.readLine(buf, sizeof(buf));
-
-        if (buf_length < 0)
-            break;
+    const auto files = this->files();
+    const DInfoFile &file = files->deepinVersion;
 
-        const QByteArray line(buf, buf_length);
-        const QByteArrayList &list = line.split('=');
+    if (!file.isValid()) {
+        deepinType = DSysInfo::UnknownDeepin;
+        cacheValues({{"deepinType", QString::number(deepinType)}});
 
-        if (list.count() != 2) {
-            continue;
-        }
+        return;
+    }
 
-        const auto key_value = qMakePair(list.first().trimmed(), list.last().trimmed());
+    for (const DInfoFile::Entry &entry : file.entries()) {
+        const QByteArray &key = entry.key;
 
-        if (key_value.first == "Version") {
-            deepinVersion = key_value.second;
-        } else if (line.startsWith("Type")) {
-            if (key_value.first == "Type") {
-                deepinTypeMap[QString()] = QString::fromLatin1(key_value.second);
-            } else if (key_value.first.at(4) == '[' && key_value.first.at(key_value.first.size() - 1) == ']') {
-                const QByteArray &language = key_value.first.mid(5, key_value.first.size() - 6);
+        if (key == "Version") {
+            deepinVersion = QString::fromUtf8(entry.value);
+        } else if (key.startsWith("Type")) {
+            if (key == "Type") {
+                deepinTypeMap[QString()] = QString::fromUtf8(entry.value);
+            } else if (key.at(4) == '[' && key.endsWith(']')) {
+                const QByteArray &language = key.mid(5, key.size() - 6);
 
                 if (!language.isEmpty()) {
-                    deepinTypeMap[QString::fromLatin1(language)] = QString::fromUtf8(key_value.second);
+                    deepinTypeMap[QString::fromLatin1(language)] = QString::fromUtf8(entry.value);
                 }
             }
-        } else if (key_value.first == "Edition") {
-            deepinEdition = QString::fromUtf8(key_value.second);
-        } else if (key_value.first == "Copyright") {
-            deepinCopyright = QString::fromUtf8(key_value.second);
+        } else if (key == "Edition") {
+            deepinEdition = QString::fromUtf8(entry.value);
+        } else if (key == "Copyright") {
+            deepinCopyright = QString::fromUtf8(entry.value);
         }
-
-        // deepinTypeMap may not parse finished(multi language) but !deepinTypeMap.isEmpty()
-//        if (!deepinTypeMap.isEmpty() && !deepinEdition.isEmpty() && !deepinCopyright.isEmpty()) {
-//            break;
-//        }
     }
 
-    file.close();
-
     const QString &deepin_type = deepinTypeMap[QString()];
 
     if (deepin_type.isEmpty()) {
@@ -247,6 +522,16 @@ void DSysInfoPrivate::ensureDeepinInfo()
     } else {
         deepinType = DSysInfo::UnknownDeepin;
     }
+
+    QHash<QString, QString> values {
+        {"deepinType", QString::number(deepinType)},
+        {"deepinVersion", deepinVersion},
+        {"deepinEdition", deepinEdition},
+        {"deepinCopyright", deepinCopyright},
+    };
+    for (auto it = deepinTypeMap.cbegin(); it != deepinTypeMap.cend(); ++it)
+        values.insert(QString("deepinTypeName[%1]").arg(it.key()), it.value());
+    cacheValues(values);
 }
 
 bool DSysInfoPrivate::ensureOsVersion()
@@ -257,7 +542,8 @@ bool DSysInfoPrivate::ensureOsVersion()
         return true;
 #endif
 
-    DDesktopEntry entry(OS_VERSION_FILE);
+    const auto files = this->files();
+    const DInfoFile &entry = files->osVersion;
     bool ok = false;
 
 #define D_ASSET_EXIT(con, msg) do { \
@@ -267,7 +553,7 @@ bool DSysInfoPrivate::ensureOsVersion()
     } \
 } while (false)
 
-    D_ASSET_EXIT(entry.status() == DDesktopEntry::NoError, entry.status());
+    D_ASSET_EXIT(entry.isValid(), "failed to read " OS_VERSION_FILE);
 
     // 先获取版本信息
     // ABCDE.xyz.abc
@@ -377,79 +663,27 @@ bool DSysInfoPrivate::ensureOsVersion()
 
 static QString unquote(const QByteArray &value)
 {
-    if (value.at(0) == '"' || value.at(0) == '\'') {
-        return QString::fromLatin1(value.mid(1, value.size() - 2));
+    if (value.size() >= 2 && (value.at(0) == '"' || value.at(0) == '\'')) {
+        return QString::fromUtf8(value.mid(1, value.size() - 2));
     }
 
-    return QString::fromLatin1(value);
+    return QString::fromUtf8(value);
 }
 
-static bool readEtcFile(DSysInfoPrivate *info, const char *filename,
-                        const QByteArray &idKey, const QByteArray &versionKey, const QByteArray &prettyNameKey)
+// the fields which aren't set by the previous file
+static void readReleaseFile(DSysInfoPrivate *info, const DInfoFile &file,
+                            const QByteArray &idKey, const QByteArray &versionKey, const QByteArray &prettyNameKey)
 {
+    const auto read = [&file](QString &field, const QByteArray &key) {
+        if (!field.isEmpty())
+            return;
+        if (const DInfoFile::Entry *entry = file.find(key))
+            field = unquote(entry->value);
+    };
 
-    QFile file(QString::fromLatin1(filename));
-
-    if (!file.open(QIODevice::ReadOnly)) {
-        return false;
-    }
-
-    quint8 valid_data_count = 0;
-    char buf[1024];
-
-
-    if (inTest()) {
-        // for test clear cache
-        info->productTypeString.clear();
-        info->productType = DSysInfo::UnknownType;
-    }
-
-    while (valid_data_count < 3) {
-        int buf_length = file.readLine(buf, sizeof(buf));
-
-        if (buf_length < 0)
-            break;
-
-        const QByteArray line(buf, buf_length - 1);
-
-        if (info->productTypeString.isEmpty() && line.startsWith(idKey)) {
-            const QByteArray value(line.constData() + idKey.size());
-            info->productTypeString = unquote(value);
-            ++valid_data_count;
-            continue;
-        }
-
-        if (info->prettyName.isEmpty() && line.startsWith(prettyNameKey)) {
-            const QByteArray value(line.constData() + prettyNameKey.size());
-            info->prettyName = unquote(value);
-            ++valid_data_count;
-            continue;
-        }
-
-        if (info->productVersion.isEmpty() && line.startsWith(versionKey)) {
-            const QByteArray value(line.constData() + versionKey.size());
-            info->productVersion = unquote(value);
-            ++valid_data_count;
-            continue;
-        }
-    }
-
-    file.close();
-
-    return valid_data_count != 0;
-}
-
-static bool readOsRelease(DSysInfoPrivate *info)
-{
-    if (!readEtcFile(info, OS_RELEASE_FILE, "ID=", "VERSION_ID=", "PRETTY_NAME="))
-        return readEtcFile(info, DSYSINFO_PREFIX"/usr/lib/os-release", "ID=", "VERSION_ID=", "PRETTY_NAME=");
-
-    return true;
-}
-
-static bool readLsbRelease(DSysInfoPrivate *info)
-{
-    return readEtcFile(info, LSB_RELEASE_FILE, "DISTRIB_ID=", "DISTRIB_RELEASE=", "DISTRIB_DESCRIPTION=");
+    read(info->productTypeString, idKey);
+    read(info->productVersion, versionKey);
+    read(info->prettyName, prettyNameKey);
 }
 #endif
 
@@ -461,8 +695,22 @@ void DSysInfoPrivate::ensureReleaseInfo()
     }
 
 #ifdef Q_OS_LINUX
-    readOsRelease(this);
-    readLsbRelease(this);
+    const QString &cachedType = cachedValue("productType");
+    if (!cachedType.isEmpty()) {
+        productType = static_cast<DSysInfo::ProductType>(cachedType.toInt());
+        productTypeString = cachedValue("productTypeString");
+        productVersion = cachedValue("productVersion");
+        prettyName = cachedValue("prettyName");
+        return;
+    }
+
+    const auto files = this->files();
+    productType = DSysInfo::UnknownType;
+    productTypeString.clear();
+    productVersion.clear();
+    prettyName.clear();
+    readReleaseFile(this, files->osRelease, "ID", "VERSION_ID", "PRETTY_NAME");
+    readReleaseFile(this, files->lsbRelease, "DISTRIB_ID", "DISTRIB_RELEASE", "DISTRIB_DESCRIPTION");
 
     if (productTypeString.isEmpty()) {
         productType = DSysInfo::UnknownType;
@@ -534,6 +782,13 @@ void DSysInfoPrivate::ensureReleaseInfo()
             break;
         }
     }
+
+    cacheValues({
+        {"productType", QString::number(productType)},
+        {"productTypeString", productTypeString},
+        {"productVersion", productVersion},
+        {"prettyName", prettyName},
+    });
 #endif
 }
 
@@ -544,41 +799,6 @@ void DSysInfoPrivate::ensureComputerInfo()
 #endif
 }
 
-QMap<QString, QString> DSysInfoPrivate::parseInfoFile(QFile &file)
-{
-    QMap<QString, QString> map;
-
-    qint64 fileSize = file.size();
-    // 因为此类文件一般不会超过1M大小，超过1M大小大概率出现异常情况
-    // 避免文件内容异常导致出现问题，对文件大小做了限制
-    if (fileSize < 1024000) {
-        QByteArray buff = file.readAll();
-        map = parseInfoContent(QString::fromLocal8Bit(buff));
-    } else {
-        qCWarning(logSysInfo) << "Size is too big, is it broken? File :"
-                              << file.fileName()
-                              << ", size :"
-                              << fileSize;
-    }
-
-    return map;
-}
-
-QMap<QString, QString> DSysInfoPrivate::parseInfoContent(const QString &content)
-{
-    QMap<QString, QString> map;
-    QStringList lineContents = content.split("\n");
-    for (auto lineContent : lineContents) {
-        const int index = lineContent.indexOf(':');
-        if (index != -1) {
-            const QString key = lineContent.left(index);
-            const QString value = lineContent.mid(index + 1);
-            map.insert(key.trimmed(), value.trimmed());
-        }
-    }
-    return map;
-}
-
 Q_GLOBAL_STATIC(DSysInfoPrivate, siGlobal)
 
 QString DSysInfo::operatingSystemName()
@@ -741,10 +961,11 @@ DSysInfo::UosArch DSysInfo::uosArch()
 
 static QString getUosVersionValue(const QString &key, const QLocale &locale)
 {
-    DDesktopEntry entry(OS_VERSION_FILE);
-    QString localKey = QString("%1[%2]").arg(key, locale.name());
+    const auto files = siGlobal->files();
+    const DInfoFile &entry = files->osVersion;
+    const QByteArray &localKey = QString("%1[%2]").arg(key, locale.name()).toUtf8();
 
-    return entry.stringValue(localKey, "Version", entry.stringValue(key, "Version"));
+    return entry.stringValue(localKey, "Version", entry.stringValue(key.toUtf8(), "Version"));
 }
 
 /*!
@@ -893,8 +1114,8 @@ QString DSysInfo::minorVersion()
  */
 QString DSysInfo::buildVersion()
 {
-    DDesktopEntry entry(OS_VERSION_FILE);
-    QString osb = entry.stringValue("OsBuild", "Version");
+    const auto files = siGlobal->files();
+    QString osb = files->osVersion.stringValue("OsBuild", "Version");
     return osb.mid(6).trimmed();
 }
 #endif
@@ -1076,6 +1297,7 @@ bool DSysInfo::isCommunityEdition()
 QString DSysInfo::computerName()
 {
 #ifdef Q_OS_LINUX
+    QMutexLocker locker(&siGlobal->mutex);
     struct utsname u;
     if (uname(&u) == 0)
         siGlobal->computerName = QString::fromLatin1(u.nodename);
@@ -1085,56 +1307,200 @@ QString DSysInfo::computerName()
     return QString();
 }
 
+#ifdef Q_OS_LINUX
+// the names of the ARM processors by "CPU implementer" and "CPU part" of /proc/cpuinfo,
+// which are the same as lscpu
+static QString armCpuModelName(const DInfoFile &cpuInfo)
+{
+    static const struct {
+        uint implementer;
+        uint part;
+        const char *name;
+    } parts[] = {
+        {0x41, 0xd03, "Cortex-A53"},
+        {0x41, 0xd04, "Cortex-A35"},
+        {0x41, 0xd05, "Cortex-A55"},
+        {0x41, 0xd07, "Cortex-A57"},
+        {0x41, 0xd08, "Cortex-A72"},
+        {0x41, 0xd09, "Cortex-A73"},
+        {0x41, 0xd0a, "Cortex-A75"},
+        {0x41, 0xd0b, "Cortex-A76"},
+        {0x41, 0xd0c, "Neoverse-N1"},
+        {0x41, 0xd0d, "Cortex-A77"},
+        {0x41, 0xd40, "Neoverse-V1"},
+        {0x41, 0xd41, "Cortex-A78"},
+        {0x41, 0xd44, "Cortex-X1"},
+        {0x41, 0xd46, "Cortex-A510"},
+        {0x41, 0xd47, "Cortex-A710"},
+        {0x41, 0xd48, "Cortex-X2"},
+        {0x41, 0xd49, "Neoverse-N2"},
+        {0x48, 0xd01, "Kunpeng-920"},
+        {0x70, 0x303, "FTC310"},
+        {0x70, 0x660, "FTC660"},
+        {0x70, 0x661, "FTC661"},
+        {0x70, 0x662, "FTC662"},
+        {0x70, 0x663, "FTC663"},
+        {0x70, 0x664, "FTC664"},
+        {0x70, 0x862, "FTC862"},
+    };
+
+    bool implementerOk = false;
+    bool partOk = false;
+    const uint implementer = cpuInfo.stringValue("CPU implementer").toUInt(&implementerOk, 0);
+    const uint part = cpuInfo.stringValue("CPU part").toUInt(&partOk, 0);
+    if (!implementerOk || !partOk)
+        return QString();
+
+    for (const auto &item : parts) {
+        if (item.implementer == implementer && item.part == part)
+            return QString::fromLatin1(item.name);
+    }
+
+    return QString();
+}
+
+// the sum of the memory devices (type 17) of the SMBIOS table, which is readable by root only
+static qint64 dmiMemoryInstalledSize()
+{
+    QFile file("/sys/firmware/dmi/tables/DMI");
+    if (!file.open(QFile::ReadOnly))
+        return -1;
+
+    const QByteArray &table = file.readAll();
+    const uchar *data = reinterpret_cast<const uchar *>(table.constData());
+    qint64 size = 0;
+    int pos = 0;
+    while (pos + 4 <= table.size()) {
+        const uchar type = data[pos];
+        const int length = data[pos + 1];
+        // the end of table
+        if (type == 127 || length < 4 || pos + length > table.size())
+            break;
+
+        if (type == 17 && length >= 0x0E) {
+            const quint16 deviceSize = qFromLittleEndian<quint16>(data + pos + 0x0C);
+            if (deviceSize == 0x7FFF && length >= 0x20) {
+                // the extended size in MB
+                size += qint64(qFromLittleEndian<quint32>(data + pos + 0x1C) & 0x7FFFFFFF) << 20;
+            } else if (deviceSize != 0 && deviceSize != 0xFFFF) {
+                // in KB if the bit 15 is set, otherwise in MB
+                size += (deviceSize & 0x8000) ? qint64(deviceSize & 0x7FFF) << 10 : qint64(deviceSize) << 20;
+            }
+        }
+
+        // the strings follow the formatted area, and end with two NULs
+        int next = pos + length;
+        while (next + 1 < table.size() && (data[next] || data[next + 1]))
+            ++next;
+        pos = next + 2;
+    }
+
+    return size > 0 ? size : -1;
+}
+
+// the memory blocks which are present, the size is rounded to the block size
+static qint64 sysfsMemoryInstalledSize()
+{
+    QFile file("/sys/devices/system/memory/block_size_bytes");
+    if (!file.open(QFile::ReadOnly))
+        return -1;
+
+    bool ok = false;
+    const qint64 blockSize = file.readAll().trimmed().toLongLong(&ok, 16);
+    if (!ok || blockSize <= 0)
+        return -1;
+
+    const QStringList &blocks = QDir("/sys/devices/system/memory").entryList({"memory*"}, QDir::Dirs | QDir::NoDotAndDotDot);
+    return blocks.isEmpty() ? -1 : blocks.size() * blockSize;
+}
+
+// the sysfs directory of the block device which is mounted at "/"
+static QString rootBlockDevice()
+{
+    struct stat st;
+    if (stat("/", &st) == 0 && major(st.st_dev) != 0) {
+        const QString &path = QFileInfo(QString("/sys/dev/block/%1:%2").arg(major(st.st_dev)).arg(minor(st.st_dev))).canonicalFilePath();
+        if (!path.isEmpty())
+            return path;
+    }
+
+    // e.g. btrfs, whose device number isn't the block device
+    const QString &device = QFileInfo(QString::fromLocal8Bit(QStorageInfo::root().device())).canonicalFilePath();
+    if (!device.startsWith("/dev/"))
+        return QString();
+
+    return QFileInfo("/sys/class/block/" + QFileInfo(device).fileName()).canonicalFilePath();
+}
+
+// the size of the disk which the block device is on
+static qint64 diskSizeOf(QString path)
+{
+    // a partition is in the directory of its disk, and the slaves of a device mapper (LVM, LUKS)
+    // are the devices which it's built on, the depth is limited in case of a loop
+    for (int depth = 0; depth < 16 && !path.isEmpty(); ++depth) {
+        if (QFile::exists(path + "/partition")) {
+            path = QFileInfo(path).path();
+            continue;
+        }
+
+        const QStringList &slaves = QDir(path + "/slaves").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        if (slaves.isEmpty())
+            break;
+        path = QFileInfo("/sys/class/block/" + slaves.first()).canonicalFilePath();
+    }
+
+    if (path.isEmpty())
+        return -1;
+
+    QFile file(path + "/size");
+    if (!file.open(QFile::ReadOnly))
+        return -1;
+
+    // in 512 bytes sectors whatever the sector size of the device is
+    bool ok = false;
+    const qint64 sectors = file.readAll().trimmed().toLongLong(&ok);
+    return ok ? sectors * 512 : -1;
+}
+#endif
+
 QString DSysInfo::cpuModelName()
 {
+    QMutexLocker locker(&siGlobal->mutex);
     if (!siGlobal->cpuModelName.isEmpty())
         return siGlobal->cpuModelName;
 
 #ifdef Q_OS_LINUX
-    static QFile file("/proc/cpuinfo");
+    siGlobal->cpuModelName = siGlobal->cachedValue("cpuModelName");
+    if (!siGlobal->cpuModelName.isEmpty())
+        return siGlobal->cpuModelName;
 
-    if (file.open(QFile::ReadOnly)) {
-        QMap<QString, QString> map = siGlobal->parseInfoFile(file);
-        if (map.contains("Processor")) {
+    DInfoFile file;
+
+    if (file.load("/proc/cpuinfo", ':')) {
+        if (file.contains("Processor")) {
             // arm-cpuinfo hw_kirin-cpuinfo
-            siGlobal->cpuModelName = map.value("Processor");
-        } else if (map.contains("model name")) {
+            siGlobal->cpuModelName = file.stringValue("Processor");
+        } else if (file.contains("model name")) {
             // cpuinfo
-            siGlobal->cpuModelName = map.value("model name");
-        } else if (map.contains("cpu model")) {
+            siGlobal->cpuModelName = file.stringValue("model name");
+        } else if (file.contains("Model Name")) {
+            // loongarch-cpuinfo
+            siGlobal->cpuModelName = file.stringValue("Model Name");
+        } else if (file.contains("cpu model")) {
             // loonson3-cpuinfo sw-cpuinfo
-            siGlobal->cpuModelName = map.value("cpu model");
-        } else if (map.contains("Hardware")) {
+            siGlobal->cpuModelName = file.stringValue("cpu model");
+        } else if (file.contains("Hardware")) {
             // "HardWare" field contains cpu info on huawei kirin machine (e.g. klv or klu)
-            siGlobal->cpuModelName = map.value("Hardware");
-        }
-
-        file.close();
-    }
-
-    // Get the cpu info by executing lscpu command
-    if (siGlobal->cpuModelName.isEmpty()) {
-        const auto &lscpu_command = QStandardPaths::findExecutable("lscpu");
-        if (lscpu_command.isEmpty()) {
-            qWarning() << "lscpu not found";
-            return QString();
-        }
-        QProcess lscpu;
-        QStringList env = QProcess::systemEnvironment();
-        env << "LC_ALL=C"; // Add an environment variable
-        lscpu.setEnvironment(env);
-        lscpu.setProgram(lscpu_command);
-        lscpu.start();
-        if (lscpu.waitForFinished(3000)) {
-            const QMap<QString, QString> map = siGlobal->parseInfoContent(lscpu.readAll());
-            if (map.contains("Model name")) {
-                siGlobal->cpuModelName = map.value("Model name");
-            }
+            siGlobal->cpuModelName = file.stringValue("Hardware");
         } else {
-            qWarning() << "lscpu:" << lscpu.errorString();
+            // arm64-cpuinfo, the name is looked up like lscpu
+            siGlobal->cpuModelName = armCpuModelName(file);
         }
     }
 
+    if (!siGlobal->cpuModelName.isEmpty())
+        siGlobal->cacheValues({{"cpuModelName", siGlobal->cpuModelName}});
+
     return siGlobal->cpuModelName;
 #endif
     return QString();
@@ -1148,44 +1514,27 @@ qint64 DSysInfo::memoryInstalledSize()
 {
 #ifdef Q_OS_LINUX
     // Getting Memory Installed Size
-    // TODO: way to not dept on lshw?
+    QMutexLocker locker(&siGlobal->mutex);
     if (siGlobal->memoryInstalledSize >= 0) {
         return siGlobal->memoryInstalledSize;
     }
-    if (!QStandardPaths::findExecutable("lshw").isEmpty()) {
-        QProcess lshw;
 
-        lshw.start("lshw", {"-c", "memory", "-json", "-sanitize"}, QIODevice::ReadOnly);
-
-        if (!lshw.waitForFinished()) {
-            return -1;
-        }
-
-        const QByteArray &lshwInfoJson = lshw.readAllStandardOutput();
-
-        QJsonParseError error;
-        auto doc = QJsonDocument::fromJson(lshwInfoJson, &error);
-        if (error.error != QJsonParseError::NoError) {
-            qCWarning(logSysInfo(), "parse failed, expect json doc from lshw command");
-            return -1;
-        }
-
-        if (!doc.isArray()) {
-            qCWarning(logSysInfo(), "parse failed, expect array");
-            return -1;
-        }
-
-        QJsonArray lshwResultArray = doc.array();
-        for (const QJsonValue value : lshwResultArray) {
-            QJsonObject obj = value.toObject();
-            if (obj.contains("id") && obj.value("id").toString() == "memory") {
-                siGlobal->memoryInstalledSize = obj.value("size").toDouble(); // TODO: check "units" is "bytes" ?
-                break;
-            }
-        }
+    bool ok = false;
+    const qint64 cachedSize = siGlobal->cachedValue("memoryInstalledSize").toLongLong(&ok);
+    if (ok && cachedSize > 0) {
+        siGlobal->memoryInstalledSize = cachedSize;
+        return siGlobal->memoryInstalledSize;
     }
 
-    Q_ASSERT(siGlobal->memoryInstalledSize > 0);
+    qint64 size = dmiMemoryInstalledSize();
+    if (size < 0)
+        size = sysfsMemoryInstalledSize();
+    if (size < 0) {
+        qCWarning(logSysInfo(), "failed to get the installed memory size");
+        return -1;
+    }
+    siGlobal->memoryInstalledSize = size;
+    siGlobal->cacheValues({{"memoryInstalledSize", QString::number(size)}});
 
     return siGlobal->memoryInstalledSize;
 #else
@@ -1200,6 +1549,7 @@ qint64 DSysInfo::memoryInstalledSize()
 qint64 DSysInfo::memoryTotalSize()
 {
 #ifdef Q_OS_LINUX
+    QMutexLocker locker(&siGlobal->mutex);
     siGlobal->memoryAvailableSize = get_phys_pages() * sysconf(_SC_PAGESIZE);
     return siGlobal->memoryAvailableSize;
 #endif
@@ -1210,49 +1560,23 @@ qint64 DSysInfo::systemDiskSize()
 {
 #ifdef Q_OS_LINUX
     // Getting Disk Size
-    QString deviceName;
-    QProcess lsblk;
-
-    lsblk.start("lsblk", {"-Jlpb", "-oNAME,KNAME,PKNAME,SIZE,MOUNTPOINT"}, QIODevice::ReadOnly);
+    QMutexLocker locker(&siGlobal->mutex);
+    if (siGlobal->diskSize > 0)
+        return siGlobal->diskSize;
 
-    if (!lsblk.waitForFinished()) {
-        return -1;
+    bool ok = false;
+    const qint64 cachedSize = siGlobal->cachedValue("systemDiskSize").toLongLong(&ok);
+    if (ok && cachedSize > 0) {
+        siGlobal->diskSize = cachedSize;
+        return siGlobal->diskSize;
     }
 
-    const QByteArray &diskStatusJson = lsblk.readAllStandardOutput();
-    QJsonDocument diskStatus = QJsonDocument::fromJson(diskStatusJson);
-    QJsonValue diskStatusJsonValue = diskStatus.object().value("blockdevices");
-    QMap<QString, QPair<QString, qulonglong>> deviceParentAndSizeMap;
-
-    if (!diskStatusJsonValue.isUndefined()) {
-        QJsonArray diskStatusArray = diskStatusJsonValue.toArray();
-        QString keyName;
-
-        for (const QJsonValue oneValue : diskStatusArray) {
-            QString name = oneValue.toObject().value("name").toString();
-            QString kname = oneValue.toObject().value("kname").toString();
-            QString pkname = oneValue.toObject().value("pkname").toString();
-            qulonglong size = oneValue.toObject().value("size").toVariant().toULongLong();
-            QString deviceNameMP = oneValue.toObject().value("mountpoint").toString();
-
-            if ("/" ==  deviceNameMP){
-                deviceName = name;
-            }
-
-            if (keyName.isNull() && deviceName == name) {
-                keyName = kname;
-            }
-
-            deviceParentAndSizeMap[kname] = QPair<QString, qulonglong>(pkname, size);
-        }
-
-        while (!deviceParentAndSizeMap[keyName].first.isNull()) {
-            keyName = deviceParentAndSizeMap[keyName].first;
-        }
-
-        siGlobal->diskSize = deviceParentAndSizeMap[keyName].second;
-    }
+    const qint64 size = diskSizeOf(rootBlockDevice());
+    if (size <= 0)
+        return -1;
 
+    siGlobal->diskSize = size;
+    siGlobal->cacheValues({{"systemDiskSize", QString::number(size)}});
     return siGlobal->diskSize;
 
 #endif
@@ -1266,6 +1590,31 @@ qint64 DSysInfo::systemDiskSize()
 */
 QDateTime DSysInfo::bootTime()
 {
+#if defined Q_OS_LINUX
+    // "btime" of /proc/stat doesn't change until reboot, it's read once.
+    static const qint64 btime = [] {
+        QFile file("/proc/stat");
+        if (!file.open(QFile::ReadOnly)) {
+            qCWarning(logSysInfo(), "failed to open /proc/stat: %s", qPrintable(file.errorString()));
+            return qint64(-1);
+        }
+
+        // it's a sequential file, the lines are read until btime
+        while (!file.atEnd()) {
+            const QByteArray &line = file.readLine();
+            if (line.startsWith("btime ")) {
+                bool ok = false;
+                const qint64 seconds = line.mid(6).trimmed().toLongLong(&ok);
+                return ok ? seconds : qint64(-1);
+            }
+        }
+        return qint64(-1);
+    }();
+
+    if (btime > 0)
+        return QDateTime::fromSecsSinceEpoch(btime);
+#endif
+
     qint64 ut = uptime();
     return ut > 0 ? QDateTime::currentDateTime().addSecs(-ut) : QDateTime();
 }
@@ -1277,26 +1626,35 @@ QDateTime DSysInfo::shutdownTime()
 {
     QDateTime dt;
 #if defined Q_OS_LINUX
-    QProcess lastx;
-    lastx.start("last", {"-x", "-F" }, QIODevice::ReadOnly);
-    if (!lastx.waitForFinished()) {
-        qWarning() << lastx.errorString();
+    // the utmpx functions work on a global file of the process
+    static QMutex utmpMutex;
+    QMutexLocker locker(&utmpMutex);
+
+    // the last shutdown is before the boot, it doesn't change until reboot, so wtmp is read once.
+    static bool cached = false;
+    static QDateTime cachedTime;
+    if (cached)
+        return cachedTime;
+
+    if (utmpxname(_PATH_WTMP) != 0) {
+        qCWarning(logSysInfo(), "failed to open %s", _PATH_WTMP);
         return QDateTime();
     }
 
-    while (lastx.canReadLine()) {
-        const QByteArray data = lastx.readLine(1024);
-        //shutdown system down  4.19.0-amd64-des Fri Sep 30 17:53:17 2022 - Sat Oct  8 08:32:47 2022 (7+14:39)
-        if (data.startsWith("shutdown")) {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-            QString timeFmt = QString(data).split(' ', Qt::SkipEmptyParts).mid(4, 5).join(' ');
-#else
-            QString timeFmt = QString(data).split(' ', QString::SkipEmptyParts).mid(4, 5).join(' ');
-#endif
-            dt = QDateTime::fromString(timeFmt);
-            break;
-        }
+    // the "shutdown" records which are listed by `last -x`, the latest one is at the end
+    qint64 seconds = -1;
+    setutxent();
+    while (const struct utmpx *entry = getutxent()) {
+        if (entry->ut_type == RUN_LVL && strncmp(entry->ut_user, "shutdown", sizeof(entry->ut_user)) == 0)
+            seconds = qMax<qint64>(seconds, entry->ut_tv.tv_sec);
     }
+    endutxent();
+    utmpxname(_PATH_UTMP);
+
+    if (seconds >= 0)
+        dt = QDateTime::fromSecsSinceEpoch(seconds);
+    cachedTime = dt;
+    cached = true;
 #else
 
 #endif
@@ -1304,22 +1662,19 @@ QDateTime DSysInfo::shutdownTime()
 }
 
 /*! @~english DSysInfo::uptime
- * @~english \return the up time (/proc/uptime)
+ * @~english \return the up time in seconds, including the time suspended (CLOCK_BOOTTIME, the same as /proc/uptime)
 */
 qint64 DSysInfo::uptime()
 {
 #if defined Q_OS_LINUX
-    QFile file("/proc/uptime");
-    if (!file.open(QFile::ReadOnly)) {
-        qWarning() << file.errorString();
+    struct timespec ts;
+    if (clock_gettime(CLOCK_BOOTTIME, &ts) != 0) {
+        qCWarning(logSysInfo(), "clock_gettime(CLOCK_BOOTTIME) failed: %s", strerror(errno));
         return -1;
     }
 
-    QByteArray upTime = file.readAll();
-    bool ok = false;
-    qint64 sec = qCeil(upTime.split(' ').value(0).toDouble(&ok)); // [0]: uptime [1]: idletime
-
-    return ok ? sec : -1;
+    // rounded up as the value of /proc/uptime was
+    return qint64(ts.tv_sec) + (ts.tv_nsec > 0 ? 1 : 0);
 #elif defined Q_OS_WIN64
      return GetTickCount64();
 #elif defined Q_OS_WIN32
@@ -1329,6 +1684,85 @@ qint64 DSysInfo::uptime()
 #endif
 }
 
+struct DSysInfoQuery
+{
+    explicit DSysInfoQuery(int count)
+        : remaining(count) {}
+
+    QFutureInterface<DSysInfo::Info> result {QFutureInterfaceBase::Started};
+    QMutex mutex;
+    DSysInfo::Info info;
+    QAtomicInt remaining;
+};
+
+class DSysInfoQueryRunner : public QRunnable
+{
+public:
+    explicit DSysInfoQueryRunner(std::function<void()> function)
+        : function(std::move(function)) {}
+
+    void run() override { function(); }
+
+private:
+    std::function<void()> function;
+};
+
+template<typename T>
+static std::function<void(DSysInfoQuery &)> queryTask(T (*getter)(), T DSysInfo::Info::*member)
+{
+    return [getter, member](DSysInfoQuery &query) {
+        const T &value = getter();
+        QMutexLocker locker(&query.mutex);
+        query.info.*member = value;
+    };
+}
+
+/*! @~english DSysInfo::queryAsync
+ * @~english \return the future of the info of \a fields, which are gathered concurrently in the global thread pool,
+ * the fields which aren't queried keep their default values
+*/
+QFuture<DSysInfo::Info> DSysInfo::queryAsync(InfoFields fields)
+{
+    QVector<std::function<void(DSysInfoQuery &)>> tasks;
+    if (fields.testFlag(ComputerNameField))
+        tasks << queryTask(&DSysInfo::computerName, &Info::computerName);
+    if (fields.testFlag(CpuModelNameField))
+        tasks << queryTask(&DSysInfo::cpuModelName, &Info::cpuModelName);
+    if (fields.testFlag(MemoryInstalledSizeField))
+        tasks << queryTask(&DSysInfo::memoryInstalledSize, &Info::memoryInstalledSize);
+    if (fields.testFlag(MemoryTotalSizeField))
+        tasks << queryTask(&DSysInfo::memoryTotalSize, &Info::memoryTotalSize);
+    if (fields.testFlag(SystemDiskSizeField))
+        tasks << queryTask(&DSysInfo::systemDiskSize, &Info::systemDiskSize);
+    if (fields.testFlag(BootTimeField))
+        tasks << queryTask(&DSysInfo::bootTime, &Info::bootTime);
+    if (fields.testFlag(ShutdownTimeField))
+        tasks << queryTask(&DSysInfo::shutdownTime, &Info::shutdownTime);
+    if (fields.testFlag(UptimeField))
+        tasks << queryTask(&DSysInfo::uptime, &Info::uptime);
+
+    const auto query = std::make_shared<DSysInfoQuery>(tasks.size());
+    QFuture<Info> future = query->result.future();
+    if (tasks.isEmpty()) {
+        query->result.reportResult(query->info);
+        query->result.reportFinished();
+        return future;
+    }
+
+    for (const auto &task : std::as_const(tasks)) {
+        QThreadPool::globalInstance()->start(new DSysInfoQueryRunner([query, task]() {
+            task(*query);
+            // the last one reports the result
+            if (!query->remaining.deref()) {
+                query->result.reportResult(query->info);
+                query->result.reportFinished();
+            }
+        }));
+    }
+
+    return future;
+}
+
 /*! @~english DSysInfo::arch
  * @~english \return the architecture of processor
 */
@@ -0,0 +1,451 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dsysinfosampler.h"
+
+#include <DObjectPrivate>
+
+#include <QDir>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+DCORE_BEGIN_NAMESPACE
+
+#define DEFAULT_INTERVAL 1000
+// the sectors of /proc/diskstats are always of 512 bytes
+#define SECTOR_SIZE 512
+
+static inline bool equals(const char *data, size_t size, const char *literal)
+{
+    return size == strlen(literal) && memcmp(data, literal, size) == 0;
+}
+
+static inline const char *nextLine(const char *p)
+{
+    p = strchr(p, '\n');
+    return p ? p + 1 : nullptr;
+}
+
+// strtod() depends on the locale of the process, the files of /proc always use '.'
+static qreal parseDecimal(const char *&p)
+{
+    while (*p == ' ' || *p == '\t')
+        ++p;
+
+    qreal value = 0;
+    for (; *p >= '0' && *p <= '9'; ++p)
+        value = value * 10 + (*p - '0');
+    if (*p == '.') {
+        qreal scale = 0.1;
+        for (++p; *p >= '0' && *p <= '9'; ++p, scale /= 10)
+            value += (*p - '0') * scale;
+    }
+
+    return value;
+}
+
+class DSysInfoSamplerPrivate : public DObjectPrivate
+{
+public:
+    explicit DSysInfoSamplerPrivate(DSysInfoSampler *qq);
+    ~DSysInfoSamplerPrivate() override;
+
+    static int openFile(const QString &fileName);
+    const char *read(int fd);
+
+    bool sampleCpu();
+    void sampleMemory();
+    void sampleLoadAverage();
+    void sampleDisks();
+    void sampleTemperatures();
+
+    int statFd = -1;
+    int meminfoFd = -1;
+    int loadavgFd = -1;
+    int diskstatsFd = -1;
+    QVector<int> thermalFds;
+    // the whole disks of /sys/block, so that the partitions aren't counted twice
+    QVector<QByteArray> disks;
+
+    // the files are read into it, it grows only if a file doesn't fit in
+    QByteArray buffer;
+    // the jiffies of the previous sample, of all cores and each core
+    QVector<quint64> previousBusy;
+    QVector<quint64> previousTotal;
+    quint64 previousSectorsRead = 0;
+    quint64 previousSectorsWritten = 0;
+    bool sampledBefore = false;
+    QElapsedTimer elapsed;
+
+    QTimer *timer = nullptr;
+    DSysInfoSampler::Sample lastSample;
+
+    D_DECLARE_PUBLIC(DSysInfoSampler)
+};
+
+DSysInfoSamplerPrivate::DSysInfoSamplerPrivate(DSysInfoSampler *qq)
+    : DObjectPrivate(qq)
+    , buffer(16384, Qt::Uninitialized)
+{
+    statFd = openFile("/proc/stat");
+    meminfoFd = openFile("/proc/meminfo");
+    loadavgFd = openFile("/proc/loadavg");
+    diskstatsFd = openFile("/proc/diskstats");
+
+    const QDir thermal("/sys/class/thermal");
+    for (const QString &zone : thermal.entryList({"thermal_zone*"}, QDir::Dirs | QDir::NoDotAndDotDot)) {
+        const int fd = openFile(thermal.filePath(zone + "/temp"));
+        if (fd >= 0)
+            thermalFds << fd;
+    }
+    lastSample.temperatures.fill(qQNaN(), thermalFds.size());
+
+    for (const QString &disk : QDir("/sys/block").entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        // the virtual devices which aren't disks
+        if (disk.startsWith("loop") || disk.startsWith("ram"))
+            continue;
+        // e.g. cciss!c0d0 of sysfs is cciss/c0d0 of /proc/diskstats
+        disks << disk.toLatin1().replace('!', '/');
+    }
+}
+
+DSysInfoSamplerPrivate::~DSysInfoSamplerPrivate()
+{
+#ifdef Q_OS_LINUX
+    for (int fd : {statFd, meminfoFd, loadavgFd, diskstatsFd}) {
+        if (fd >= 0)
+            close(fd);
+    }
+    for (int fd : std::as_const(thermalFds))
+        close(fd);
+#endif
+}
+
+int DSysInfoSamplerPrivate::openFile(const QString &fileName)
+{
+#ifdef Q_OS_LINUX
+    return open(QFile::encodeName(fileName).constData(), O_RDONLY | O_CLOEXEC);
+#else
+    Q_UNUSED(fileName)
+    return -1;
+#endif
+}
+
+// reads the whole file from the beginning, the content is terminated with '\0'
+const char *DSysInfoSamplerPrivate::read(int fd)
+{
+#ifdef Q_OS_LINUX
+    if (fd < 0)
+        return nullptr;
+
+    Q_FOREVER {
+        const ssize_t size = pread(fd, buffer.data(), size_t(buffer.size() - 1), 0);
+        if (size < 0)
+            return nullptr;
+
+        if (size < buffer.size() - 1) {
+            buffer.data()[size] = '\0';
+            return buffer.constData();
+        }
+        buffer.resize(buffer.size() * 2);
+    }
+#else
+    Q_UNUSED(fd)
+    return nullptr;
+#endif
+}
+
+// the "cpu" lines of /proc/stat: user nice system idle iowait irq softirq steal ...
+bool DSysInfoSamplerPrivate::sampleCpu()
+{
+    const char *p = read(statFd);
+    int index = 0;
+    while (p && strncmp(p, "cpu", 3) == 0) {
+        p += 3;
+        // the number of the core, "cpu" is of all cores
+        while (*p >= '0' && *p <= '9')
+            ++p;
+
+        quint64 total = 0;
+        quint64 idle = 0;
+        for (int field = 0; field < 8; ++field) {
+            char *end = nullptr;
+            const quint64 value = strtoull(p, &end, 10);
+            if (end == p)
+                break;
+            p = end;
+            total += value;
+            // idle and iowait
+            if (field == 3 || field == 4)
+                idle += value;
+        }
+        const quint64 busy = total - idle;
+
+        // the cores are added once, or after they're online
+        if (index >= previousTotal.size()) {
+            previousTotal.append(total);
+            previousBusy.append(busy);
+            lastSample.cpuUsage.append(0);
+        }
+
+        const quint64 totalDelta = total > previousTotal.at(index) ? total - previousTotal.at(index) : 0;
+        const quint64 busyDelta = busy > previousBusy.at(index) ? busy - previousBusy.at(index) : 0;
+        lastSample.cpuUsage[index] = sampledBefore && totalDelta > 0
+                ? qBound<qreal>(0, qreal(busyDelta) / totalDelta, 1) : 0;
+        previousTotal[index] = total;
+        previousBusy[index] = busy;
+
+        ++index;
+        p = nextLine(p);
+    }
+
+    // the cores are offline
+    if (index < lastSample.cpuUsage.size()) {
+        lastSample.cpuUsage.resize(index);
+        previousTotal.resize(index);
+        previousBusy.resize(index);
+    }
+
+    return index > 0;
+}
+
+// the "Key:    value kB" lines of /proc/meminfo
+void DSysInfoSamplerPrivate::sampleMemory()
+{
+    for (const char *p = read(meminfoFd); p && *p; p = nextLine(p)) {
+        const char *colon = strchr(p, ':');
+        if (!colon)
+            break;
+
+        const size_t size = size_t(colon - p);
+        qint64 *field = nullptr;
+        if (equals(p, size, "MemTotal"))
+            field = &lastSample.memoryTotal;
+        else if (equals(p, size, "MemAvailable"))
+            field = &lastSample.memoryAvailable;
+        else if (equals(p, size, "SwapTotal"))
+            field = &lastSample.swapTotal;
+        else if (equals(p, size, "SwapFree"))
+            field = &lastSample.swapFree;
+
+        if (field)
+            *field = qint64(strtoull(colon + 1, nullptr, 10)) * 1024;
+    }
+}
+
+// "0.52 0.58 0.59 1/1234 5678"
+void DSysInfoSamplerPrivate::sampleLoadAverage()
+{
+    const char *p = read(loadavgFd);
+    if (!p)
+        return;
+
+    for (qreal &value : lastSample.loadAverage)
+        value = parseDecimal(p);
+}
+
+// "major minor name reads merged sectors ms writes merged sectors ms ..." of /proc/diskstats
+void DSysInfoSamplerPrivate::sampleDisks()
+{
+    quint64 sectorsRead = 0;
+    quint64 sectorsWritten = 0;
+    const char *p = read(diskstatsFd);
+    if (!p)
+        return;
+
+    for (; p && *p; p = nextLine(p)) {
+        char *end = nullptr;
+        strtoul(p, &end, 10);
+        strtoul(end, &end, 10);
+        const char *name = end;
+        while (*name == ' ')
+            ++name;
+        const char *nameEnd = name;
+        while (*nameEnd && *nameEnd != ' ' && *nameEnd != '\n')
+            ++nameEnd;
+
+        const size_t size = size_t(nameEnd - name);
+        const bool isDisk = std::any_of(disks.cbegin(), disks.cend(), [name, size](const QByteArray &disk) {
+            return size_t(disk.size()) == size && memcmp(disk.constData(), name, size) == 0;
+        });
+        if (!isDisk)
+            continue;
+
+        quint64 values[7] = {0};
+        const char *field = nameEnd;
+        for (quint64 &value : values) {
+            value = strtoull(field, &end, 10);
+            field = end;
+        }
+        sectorsRead += values[2];
+        sectorsWritten += values[6];
+    }
+
+    lastSample.diskReadBytes = sampledBefore && sectorsRead >= previousSectorsRead
+            ? qint64(sectorsRead - previousSectorsRead) * SECTOR_SIZE : 0;
+    lastSample.diskWrittenBytes = sampledBefore && sectorsWritten >= previousSectorsWritten
+            ? qint64(sectorsWritten - previousSectorsWritten) * SECTOR_SIZE : 0;
+    previousSectorsRead = sectorsRead;
+    previousSectorsWritten = sectorsWritten;
+}
+
+// in millidegrees Celsius
+void DSysInfoSamplerPrivate::sampleTemperatures()
+{
+    for (int i = 0; i < thermalFds.size(); ++i) {
+        const char *p = read(thermalFds.at(i));
+        lastSample.temperatures[i] = p ? strtol(p, nullptr, 10) / 1000.0 : qQNaN();
+    }
+}
+
+/*!
+@~english
+  @class Dtk::Core::DSysInfoSampler
+  \inmodule dtkcore
+  @brief Samples the usage of the system resources periodically.
+
+  DSysInfoSampler opens /proc/stat, /proc/meminfo, /proc/loadavg, /proc/diskstats and the
+  temperatures of /sys/class/thermal once, and reads them again from the beginning with pread()
+  into a reused buffer for every sample. The sample is updated in place, so sampling doesn't
+  allocate memory unless the number of cores is changed, or a copy of lastSample() is kept.
+
+  \code
+  DSysInfoSampler sampler;
+  sampler.setInterval(2000);
+  QObject::connect(&sampler, &DSysInfoSampler::sampled, [&sampler] {
+      qDebug() << sampler.lastSample().cpuUsage.value(0);
+  });
+  sampler.start();
+  \endcode
+
+  @sa DSysInfo
+ */
+
+/*!
+@~english
+  @fn void DSysInfoSampler::sampled()
+  @brief The signal is emitted after lastSample() is updated.
+ */
+
+/*!
+@~english
+  @brief Constructs a sampler, the files are opened before it returns, the interval is 1000 milliseconds.
+ */
+DSysInfoSampler::DSysInfoSampler(QObject *parent)
+    : QObject(parent)
+    , DObject(*new DSysInfoSamplerPrivate(this))
+{
+    D_D(DSysInfoSampler);
+
+    d->timer = new QTimer(this);
+    d->timer->setInterval(DEFAULT_INTERVAL);
+    connect(d->timer, &QTimer::timeout, this, &DSysInfoSampler::sample);
+}
+
+DSysInfoSampler::~DSysInfoSampler()
+{
+}
+
+/*!
+@~english
+  @brief Returns the interval of sampling in milliseconds.
+ */
+int DSysInfoSampler::interval() const
+{
+    D_DC(DSysInfoSampler);
+    return d->timer->interval();
+}
+
+/*!
+@~english
+  @brief Sets the interval of sampling to \a msec milliseconds, it's applied immediately if the sampler is active.
+ */
+void DSysInfoSampler::setInterval(int msec)
+{
+    D_D(DSysInfoSampler);
+    d->timer->setInterval(msec);
+}
+
+/*!
+@~english
+  @brief Returns whether the sampler samples periodically.
+ */
+bool DSysInfoSampler::isActive() const
+{
+    D_DC(DSysInfoSampler);
+    return d->timer->isActive();
+}
+
+/*!
+@~english
+  @brief Returns the latest sample, the deltas are of the interval between the latest two samples,
+  they're 0 in the first sample.
+ */
+const DSysInfoSampler::Sample &DSysInfoSampler::lastSample() const
+{
+    D_DC(DSysInfoSampler);
+    return d->lastSample;
+}
+
+/*!
+@~english
+  @brief Starts sampling periodically, a sample is taken immediately as the base of the deltas.
+ */
+void DSysInfoSampler::start()
+{
+    D_D(DSysInfoSampler);
+    sample();
+    d->timer->start();
+}
+
+/*!
+@~english
+  @brief Stops sampling periodically.
+ */
+void DSysInfoSampler::stop()
+{
+    D_D(DSysInfoSampler);
+    d->timer->stop();
+}
+
+/*!
+@~english
+  @brief Takes a sample now and emits sampled().
+  @return false if /proc/stat can't be read, e.g. it's not Linux
+ */
+bool DSysInfoSampler::sample()
+{
+    D_D(DSysInfoSampler);
+
+    const bool ok = d->sampleCpu();
+    d->sampleMemory();
+    d->sampleLoadAverage();
+    d->sampleDisks();
+    d->sampleTemperatures();
+
+    if (d->sampledBefore) {
+        d->lastSample.interval = d->elapsed.restart();
+    } else {
+        d->lastSample.interval = 0;
+        d->elapsed.start();
+    }
+    d->sampledBefore = true;
+
+    if (ok)
+        Q_EMIT sampled();
+
+    return ok;
+}
+
+DCORE_END_NAMESPACE
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dtracespan_p.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+
+#include <chrono>
+
+DCORE_BEGIN_NAMESPACE
+
+std::atomic<int> DTraceSpan::s_state {DTraceSpan::Unknown};
+
+static QMutex *traceMutex()
+{
+    static QMutex mutex;
+    return &mutex;
+}
+
+// it's never deleted, the spans may finish in the destructors of static objects.
+static QFile *traceFile = nullptr;
+
+bool DTraceSpan::initialize()
+{
+    QMutexLocker locker(traceMutex());
+    if (s_state.load() != Unknown)
+        return s_state.load() == Enabled;
+
+    QString path = qEnvironmentVariable("DTK_TRACE_FILE");
+    if (path.isEmpty()) {
+        s_state.store(Disabled);
+        return false;
+    }
+    path.replace(QLatin1String("%p"), QString::number(QCoreApplication::applicationPid()));
+
+    auto file = new QFile(path);
+    if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Can't open the trace file \"%s\": %s", qPrintable(path), qPrintable(file->errorString()));
+        delete file;
+        s_state.store(Disabled);
+        return false;
+    }
+    // the JSON array format, the closing bracket is optional, so that it's still valid if the process crashes.
+    file->write("[\n");
+    file->flush();
+    traceFile = file;
+    s_state.store(Enabled);
+    return true;
+}
+
+qint64 DTraceSpan::timestamp()
+{
+    // the monotonic clock, so that the spans of different processes are comparable.
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void DTraceSpan::finish()
+{
+    record(m_category, m_name, m_detail, m_start, timestamp());
+}
+
+void DTraceSpan::record(const char *category, const char *name, const QString &detail, qint64 start, qint64 end)
+{
+    QJsonObject event {
+        {"name", QLatin1String(name)},
+        {"cat", QLatin1String(category)},
+        {"ph", "X"},
+        {"ts", start},
+        {"dur", end - start},
+        {"pid", QCoreApplication::applicationPid()},
+        {"tid", qint64(reinterpret_cast<quintptr>(QThread::currentThreadId()))}
+    };
+    if (!detail.isEmpty())
+        event.insert("args", QJsonObject{{"detail", detail}});
+
+    const QByteArray &line = QJsonDocument(event).toJson(QJsonDocument::Compact) + ",\n";
+    QMutexLocker locker(traceMutex());
+    traceFile->write(line);
+    traceFile->flush();
+}
+
+DCORE_END_NAMESPACE
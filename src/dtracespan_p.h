@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <dtkcore_global.h>
+
+#include <QString>
+
+#include <atomic>
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * A scoped span of the startup tracing, it's written as a complete event of the
+ * Chrome trace event format, the output can be opened by chrome://tracing or Perfetto.
+ *
+ * The tracing is enabled by `DTK_TRACE_FILE=<path>`, "%p" in the path is replaced by the pid.
+ * When it's disabled, a span only reads an atomic flag.
+ */
+class Q_DECL_HIDDEN DTraceSpan
+{
+public:
+    inline DTraceSpan(const char *category, const char *name, const QString &detail = QString())
+        : m_category(category)
+        , m_name(name)
+    {
+        if (Q_LIKELY(!isEnabled()))
+            return;
+
+        m_detail = detail;
+        m_start = timestamp();
+    }
+
+    inline ~DTraceSpan()
+    {
+        if (Q_UNLIKELY(m_start >= 0))
+            finish();
+    }
+
+    static inline bool isEnabled()
+    {
+        const int state = s_state.load(std::memory_order_relaxed);
+        if (Q_LIKELY(state == Disabled))
+            return false;
+        return state == Enabled || initialize();
+    }
+
+    static qint64 timestamp();
+    // writes a span measured elsewhere, e.g. an asynchronous call, the tracing must be enabled.
+    static void record(const char *category, const char *name, const QString &detail, qint64 start, qint64 end);
+
+private:
+    Q_DISABLE_COPY(DTraceSpan)
+
+    enum State {
+        Unknown,
+        Disabled,
+        Enabled
+    };
+
+    static bool initialize();
+    void finish();
+
+    const char *m_category;
+    const char *m_name;
+    QString m_detail;
+    qint64 m_start = -1;
+    static std::atomic<int> s_state;
+};
+
+#define D_TRACE_SPAN_CONCAT_(a, b) a##b
+#define D_TRACE_SPAN_CONCAT(a, b) D_TRACE_SPAN_CONCAT_(a, b)
+#define D_TRACE_SPAN(category, name, ...) \
+    DTK_CORE_NAMESPACE::DTraceSpan D_TRACE_SPAN_CONCAT(_d_trace_span_, __LINE__)(category, name, ##__VA_ARGS__)
+
+DCORE_END_NAMESPACE
@@ -4,19 +4,134 @@
 
 #include "dbasefilewatcher.h"
 #include "private/dbasefilewatcher_p.h"
+#include "dperfcounters.h"
 
 #include <QEvent>
+#include <QTimer>
 #include <QDebug>
 
 DCORE_BEGIN_NAMESPACE
 
-QList<DBaseFileWatcher*> DBaseFileWatcherPrivate::watcherList;
+// the notifications merged into or cancelled by the pending ones of the coalescing window
+static DPerfCounter notificationsCoalesced("watcher.notifications_coalesced");
+
+QHash<QUrl, QList<DBaseFileWatcher *>> DBaseFileWatcherPrivate::watchersByUrl;
+QHash<QUrl, QList<DBaseFileWatcher *>> DBaseFileWatcherPrivate::watchersByParentUrl;
 DBaseFileWatcherPrivate::DBaseFileWatcherPrivate(DBaseFileWatcher *qq)
     : DObjectPrivate(qq)
 {
 
 }
 
+QUrl DBaseFileWatcherPrivate::parentUrl(const QUrl &url)
+{
+    const QUrl parent = url.adjusted(QUrl::StripTrailingSlash).adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash);
+    // the root has no parent
+    return parent == url.adjusted(QUrl::StripTrailingSlash) ? QUrl() : parent;
+}
+
+static void removeWatcher(QHash<QUrl, QList<DBaseFileWatcher *>> &index, const QUrl &url, DBaseFileWatcher *watcher)
+{
+    auto it = index.find(url);
+    if (it == index.end())
+        return;
+
+    it->removeOne(watcher);
+    if (it->isEmpty())
+        index.erase(it);
+}
+
+void DBaseFileWatcherPrivate::notify(NotificationType type, const QUrl &url)
+{
+    Q_Q(DBaseFileWatcher);
+
+    if (coalescingInterval <= 0)
+        return emitNotification(type, url);
+
+    int &types = pendingTypes[url];
+    if (types & type) {
+        notificationsCoalesced.add();
+        return;
+    }
+
+    if (type == FileDeleted) {
+        const bool created = types & SubfileCreated;
+        // the changes of a file are useless after it's deleted
+        for (int i = pendingNotifications.size() - 1; i >= 0; --i) {
+            if (pendingNotifications.at(i).second == url)
+                pendingNotifications.removeAt(i);
+        }
+
+        // the file is created and deleted in the window, nothing is notified
+        if (created) {
+            notificationsCoalesced.add();
+            pendingTypes.remove(url);
+            return;
+        }
+        types = 0;
+    }
+
+    types |= type;
+    pendingNotifications.append(qMakePair(type, url));
+
+    if (!coalescingTimer) {
+        coalescingTimer = new QTimer(q);
+        coalescingTimer->setSingleShot(true);
+        QObject::connect(coalescingTimer, &QTimer::timeout, q, [this] {
+            flushNotifications();
+        });
+    }
+
+    if (!coalescingTimer->isActive())
+        coalescingTimer->start(coalescingInterval);
+}
+
+void DBaseFileWatcherPrivate::notifyMoved(const QUrl &fromUrl, const QUrl &toUrl)
+{
+    Q_Q(DBaseFileWatcher);
+
+    // a move isn't merged, the notifications before it are emitted first to keep the order
+    flushNotifications();
+    Q_EMIT q->fileMoved(fromUrl, toUrl);
+}
+
+void DBaseFileWatcherPrivate::flushNotifications()
+{
+    if (coalescingTimer)
+        coalescingTimer->stop();
+
+    // a slot may cause more notifications, they are emitted in the next window
+    const auto notifications = std::move(pendingNotifications);
+    pendingNotifications.clear();
+    pendingTypes.clear();
+
+    for (const auto &notification : notifications)
+        emitNotification(notification.first, notification.second);
+}
+
+void DBaseFileWatcherPrivate::emitNotification(NotificationType type, const QUrl &url)
+{
+    Q_Q(DBaseFileWatcher);
+
+    switch (type) {
+    case FileDeleted:
+        Q_EMIT q->fileDeleted(url);
+        break;
+    case FileAttributeChanged:
+        Q_EMIT q->fileAttributeChanged(url);
+        break;
+    case SubfileCreated:
+        Q_EMIT q->subfileCreated(url);
+        break;
+    case FileModified:
+        Q_EMIT q->fileModified(url);
+        break;
+    case FileClosed:
+        Q_EMIT q->fileClosed(url);
+        break;
+    }
+}
+
 /*!
 @~english
     @class Dtk::Core::DBaseFileWatcher
@@ -27,8 +142,14 @@ DBaseFileWatcherPrivate::DBaseFileWatcherPrivate(DBaseFileWatcher *qq)
 
 DBaseFileWatcher::~DBaseFileWatcher()
 {
+    Q_D(DBaseFileWatcher);
+
+    // the notifications aren't emitted by a watcher which is being destroyed
+    d->pendingNotifications.clear();
+    d->pendingTypes.clear();
     stopWatcher();
-    DBaseFileWatcherPrivate::watcherList.removeOne(this);
+    removeWatcher(DBaseFileWatcherPrivate::watchersByUrl, d->url, this);
+    removeWatcher(DBaseFileWatcherPrivate::watchersByParentUrl, DBaseFileWatcherPrivate::parentUrl(d->url), this);
 }
 
 QUrl DBaseFileWatcher::fileUrl() const
@@ -73,6 +194,7 @@ bool DBaseFileWatcher::stopWatcher()
 
     if (d->stop()) {
         d->started = false;
+        d->flushNotifications();
 
         return true;
     }
@@ -91,6 +213,42 @@ bool DBaseFileWatcher::restartWatcher()
     return ok && startWatcher();
 }
 
+/*!
+@~english
+  @brief Returns the coalescing window of the notifications in milliseconds, 0 by default.
+  @sa setCoalescingInterval()
+ */
+int DBaseFileWatcher::coalescingInterval() const
+{
+    Q_D(const DBaseFileWatcher);
+
+    return d->coalescingInterval;
+}
+
+/*!
+@~english
+  @brief Merges the notifications in a window of \a msec milliseconds.
+
+  The repeated fileModified(), fileAttributeChanged() and fileClosed() of an url in the window
+  are emitted once at the end of it, e.g. a log file which is written in small chunks. If a file
+  is created and deleted in the window, neither subfileCreated() nor fileDeleted() is emitted.
+  fileMoved() isn't merged, the notifications before it are emitted first. The notifications
+  are emitted at once if \a msec is 0, which is the default.
+
+  @sa coalescingInterval()
+ */
+void DBaseFileWatcher::setCoalescingInterval(int msec)
+{
+    Q_D(DBaseFileWatcher);
+
+    if (d->coalescingInterval == msec)
+        return;
+
+    d->coalescingInterval = qMax(0, msec);
+    if (d->coalescingInterval == 0)
+        d->flushNotifications();
+}
+
 /*!
 @~english
   @brief Set enable file watcher for \a subfileUrl or not
@@ -119,16 +277,12 @@ bool DBaseFileWatcher::ghostSignal(const QUrl &targetUrl, DBaseFileWatcher::Sign
     if (!signal)
         return false;
 
-    bool ok = false;
+    // a copy, the slots may create or destroy the watchers
+    const QList<DBaseFileWatcher *> watchers = DBaseFileWatcherPrivate::watchersByUrl.value(targetUrl);
+    for (DBaseFileWatcher *watcher : watchers)
+        (watcher->*signal)(arg1);
 
-    for (DBaseFileWatcher *watcher : DBaseFileWatcherPrivate::watcherList) {
-        if (watcher->fileUrl() == targetUrl) {
-            ok = true;
-            (watcher->*signal)(arg1);
-        }
-    }
-
-    return ok;
+    return !watchers.isEmpty();
 }
 
 /*!
@@ -144,16 +298,35 @@ bool DBaseFileWatcher::ghostSignal(const QUrl &targetUrl, DBaseFileWatcher::Sign
     if (!signal)
         return false;
 
-    bool ok = false;
+    // a copy, the slots may create or destroy the watchers
+    const QList<DBaseFileWatcher *> watchers = DBaseFileWatcherPrivate::watchersByUrl.value(targetUrl);
+    for (DBaseFileWatcher *watcher : watchers)
+        (watcher->*signal)(arg1, arg2);
 
-    for (DBaseFileWatcher *watcher : DBaseFileWatcherPrivate::watcherList) {
-        if (watcher->fileUrl() == targetUrl) {
-            ok = true;
-            (watcher->*signal)(arg1, arg2);
-        }
-    }
+    return !watchers.isEmpty();
+}
+
+/*!
+@~english
+  @brief Emit a \a signal with \a arg1 by the watchers of all the direct children of \a parentUrl
+  Example usage:
+
+  @code
+  DBaseFileWatcher::ghostSignalToChildren(QUrl("bookmark:///"), &DBaseFileWatcher::fileAttributeChanged, QUrl("bookmark:///"));
+  @endcode
+
+  @return the count of the watchers which emitted the signal.
+ */
+int DBaseFileWatcher::ghostSignalToChildren(const QUrl &parentUrl, DBaseFileWatcher::SignalType1 signal, const QUrl &arg1)
+{
+    if (!signal)
+        return 0;
+
+    const QList<DBaseFileWatcher *> watchers = DBaseFileWatcherPrivate::watchersByParentUrl.value(parentUrl.adjusted(QUrl::StripTrailingSlash));
+    for (DBaseFileWatcher *watcher : watchers)
+        (watcher->*signal)(arg1);
 
-    return ok;
+    return watchers.size();
 }
 
 DBaseFileWatcher::DBaseFileWatcher(DBaseFileWatcherPrivate &dd,
@@ -164,7 +337,10 @@ DBaseFileWatcher::DBaseFileWatcher(DBaseFileWatcherPrivate &dd,
     Q_ASSERT(url.isValid());
 
     d_func()->url = url;
-    DBaseFileWatcherPrivate::watcherList << this;
+    DBaseFileWatcherPrivate::watchersByUrl[url].append(this);
+    const QUrl parentUrl = DBaseFileWatcherPrivate::parentUrl(url);
+    if (parentUrl.isValid())
+        DBaseFileWatcherPrivate::watchersByParentUrl[parentUrl].append(this);
 }
 
 DCORE_END_NAMESPACE
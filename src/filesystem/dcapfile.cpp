@@ -8,10 +8,12 @@
 
 #include <private/qdir_p.h>
 
+#include <QFileInfo>
+
 DCORE_BEGIN_NAMESPACE
 
-extern QString _d_cleanPath(const QString &path);
-extern bool _d_isSubFileOf(const QString &filePath, const QString &directoryPath);
+extern bool _d_canReadWrite(const QString &path);
+extern bool _d_copyFile(const QString &fileName, const QString &newName);
 
 class DCapFilePrivate : public DObjectPrivate
 {
@@ -31,8 +33,7 @@ DCapFilePrivate::DCapFilePrivate(DCapFile *qq, const QString &fileName)
 
 bool DCapFilePrivate::canReadWrite(const QString &path)
 {
-    DCapFSFileEngine engine(path);
-    return engine.canReadWrite(path);
+    return _d_canReadWrite(path);
 }
 
 DCapFile::DCapFile(QObject *parent)
@@ -168,6 +169,13 @@ bool DCapFile::copy(const QString &newName)
     if (!d->canReadWrite(newName))
         return false;
 
+    // QFile::copy() copies through a buffer if the engine can't, the errors are reported by it
+    if (!isOpen() && !fileName().isEmpty() && !QFileInfo::exists(newName)
+            && _d_copyFile(fileName(), newName)) {
+        unsetError();
+        return true;
+    }
+
     return QFile::copy(newName);
 }
 
@@ -371,6 +379,99 @@ bool DCapDir::remove(const QString &fileName)
     return DCapFile::remove(filePath(fileName));
 }
 
+class DCapDirIteratorPrivate
+{
+public:
+    DCapDirIteratorPrivate(QDirIterator *iterator);
+
+    bool fetchNext();
+
+    QScopedPointer<QDirIterator> iterator;
+    // the next permitted entry, which is found by hasNext()
+    bool hasPending = false;
+    QString pendingPath;
+    QString currentPath;
+};
+
+DCapDirIteratorPrivate::DCapDirIteratorPrivate(QDirIterator *iterator)
+    : iterator(iterator)
+{
+}
+
+bool DCapDirIteratorPrivate::fetchNext()
+{
+    if (hasPending)
+        return true;
+
+    // the entries are checked one by one, the denied entries are skipped, so that the
+    // allowed subdirectories of a denied directory can be found by the recursive iteration
+    while (iterator->hasNext()) {
+        const QString &path = iterator->next();
+        if (DCapFilePrivate::canReadWrite(path)) {
+            pendingPath = path;
+            hasPending = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+DCapDirIterator::DCapDirIterator(const DCapDir &dir, QDirIterator::IteratorFlags flags)
+    : d(new DCapDirIteratorPrivate(new QDirIterator(dir, flags)))
+{
+}
+
+DCapDirIterator::DCapDirIterator(const QString &path, QDir::Filters filters, QDirIterator::IteratorFlags flags)
+    : d(new DCapDirIteratorPrivate(new QDirIterator(path, filters, flags)))
+{
+}
+
+DCapDirIterator::DCapDirIterator(const QString &path, const QStringList &nameFilters,
+                                 QDir::Filters filters, QDirIterator::IteratorFlags flags)
+    : d(new DCapDirIteratorPrivate(new QDirIterator(path, nameFilters, filters, flags)))
+{
+}
+
+DCapDirIterator::~DCapDirIterator()
+{
+}
+
+QString DCapDirIterator::next()
+{
+    if (!d->fetchNext())
+        return QString();
+
+    d->hasPending = false;
+    d->currentPath = d->pendingPath;
+    return d->currentPath;
+}
+
+bool DCapDirIterator::hasNext() const
+{
+    return d->fetchNext();
+}
+
+QString DCapDirIterator::fileName() const
+{
+    return QFileInfo(d->currentPath).fileName();
+}
+
+QString DCapDirIterator::filePath() const
+{
+    return d->currentPath;
+}
+
+QFileInfo DCapDirIterator::fileInfo() const
+{
+    return d->currentPath.isEmpty() ? QFileInfo() : QFileInfo(d->currentPath);
+}
+
+QString DCapDirIterator::path() const
+{
+    return d->iterator->path();
+}
+
 bool DCapDir::rename(const QString &oldName, const QString &newName)
 {
     if (oldName.isEmpty() || newName.isEmpty()) {
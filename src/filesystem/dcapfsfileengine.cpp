@@ -9,21 +9,196 @@
 #include "dcapmanager.h"
 #include <QDebug>
 
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
 DCORE_BEGIN_NAMESPACE
 
-extern QString _d_cleanPath(const QString &path);
-extern bool _d_isSubFileOf(const QString &filePath, const QString &directoryPath);
+extern bool _d_isAllowedPath(const QString &path);
+extern quint64 _d_allowedPathsVersion();
+
+// A sandboxed application usually opens a lot of files in a few directories, so the canonical
+// paths of the recent parent directories are cached by every thread. The cache is dropped when
+// the allowed paths of DCapManager are changed, a link which is changed later isn't seen until then.
+static constexpr int CanonicalCacheSize = 16;
+
+struct DCapCanonicalCache
+{
+    quint64 version = 0;
+    // the most recently used is the first one
+    QVector<QPair<QString, QString>> entries;
+};
+
+static QString canonicalDirectory(const QString &dirPath)
+{
+    static thread_local DCapCanonicalCache cache;
+
+    const quint64 version = _d_allowedPathsVersion();
+    if (cache.version != version) {
+        cache.entries.clear();
+        cache.version = version;
+    }
+
+    for (int i = 0; i < cache.entries.size(); ++i) {
+        if (cache.entries.at(i).first != dirPath)
+            continue;
+        if (i > 0)
+            cache.entries.move(i, 0);
+        return cache.entries.first().second;
+    }
+
+    QString canonicalPath = QFileInfo(dirPath).canonicalFilePath();
+    // the directory doesn't exist, e.g. mkpath()
+    if (canonicalPath.isEmpty())
+        canonicalPath = dirPath;
+    if (cache.entries.size() >= CanonicalCacheSize)
+        cache.entries.removeLast();
+    cache.entries.prepend(qMakePair(dirPath, canonicalPath));
+    return canonicalPath;
+}
+
+// The links in the parent directories are resolved before the path is checked, so a link in an
+// allowed directory which points to another directory doesn't give access to the files in it, and
+// a link outside which points to an allowed directory does. The last component isn't resolved, so
+// that a link can be operated itself.
+bool _d_canReadWrite(const QString &path)
+{
+    if (path.isEmpty())
+        return false;
+
+    QString target = QDir::isRelativePath(path) ? QDir::currentPath() + QLatin1Char('/') + path : path;
+    target = QDir::cleanPath(target);
+    const int index = target.lastIndexOf(QLatin1Char('/'));
+    if (index > 0)
+        target = canonicalDirectory(target.left(index)) + target.mid(index);
+
+    return _d_isAllowedPath(target);
+}
+
+#ifdef Q_OS_LINUX
+// the errors of copy_file_range() and sendfile() which mean the files aren't supported by them
+static bool isCopyUnsupported(int error)
+{
+    return error == ENOSYS || error == EXDEV || error == EINVAL || error == EOPNOTSUPP
+            || error == ENOTSUP || error == EPERM || error == EBADF;
+}
+
+static bool writeAll(int out, const char *data, ssize_t size)
+{
+    while (size > 0) {
+        const ssize_t written = ::write(out, data, static_cast<size_t>(size));
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+// The data doesn't pass through the userspace unless neither of the system calls supports the
+// files. The size of a file of procfs or sysfs is 0, it's read until the end.
+static bool copyFileData(int in, int out, qint64 size)
+{
+    // shares the extents on btrfs, xfs and so on, it's done at once
+    if (size > 0 && ::ioctl(out, FICLONE, in) == 0)
+        return true;
+
+    // the offsets of the files move on, so the next way continues where the previous stops
+    qint64 copied = 0;
+    constexpr size_t MaxChunk = 1 << 30;
+    while (copied < size) {
+        const ssize_t n = ::copy_file_range(in, nullptr, out, nullptr, qMin<qint64>(size - copied, MaxChunk), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && !isCopyUnsupported(errno))
+            return false;
+        if (n <= 0)
+            break;
+        copied += n;
+    }
+
+    while (copied < size) {
+        const ssize_t n = ::sendfile(out, in, nullptr, qMin<qint64>(size - copied, MaxChunk));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && !isCopyUnsupported(errno))
+            return false;
+        if (n <= 0)
+            break;
+        copied += n;
+    }
+
+    if (size > 0 && copied >= size)
+        return true;
+
+    char buffer[64 * 1024];
+    while (true) {
+        const ssize_t n = ::read(in, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return false;
+        if (n == 0)
+            return true;
+        if (!writeAll(out, buffer, n))
+            return false;
+    }
+}
+#endif
+
+// Copies a regular file to newName, which must not exist, with the permissions of the file.
+// It returns false without a trace if it's not done, so that QFile can fall back to its own way.
+bool _d_copyFile(const QString &fileName, const QString &newName)
+{
+#ifdef Q_OS_LINUX
+    const int in = ::open(QFile::encodeName(fileName).constData(), O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+        return false;
+
+    struct stat info;
+    if (::fstat(in, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(in);
+        return false;
+    }
+
+    const QByteArray target = QFile::encodeName(newName);
+    const int out = ::open(target.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+
+    bool ok = copyFileData(in, out, info.st_size) && ::fchmod(out, info.st_mode & 07777) == 0;
+    ok = ::close(out) == 0 && ok;
+    ::close(in);
+    if (!ok)
+        ::unlink(target.constData());
+    return ok;
+#else
+    Q_UNUSED(fileName)
+    Q_UNUSED(newName)
+    return false;
+#endif
+}
 
 #if QT_VERSION < QT_VERSION_CHECK(6, 8, 0)
 static bool capDirIteraterHasNext(QAbstractFileEngineIterator *it)
 {
-    const QStringList &paths = DCapManager::instance()->paths();
     QString path = it->path();
     QFileInfo info(path);
     if (info.isSymLink())
         info = QFileInfo{info.symLinkTarget()};
 
-    bool ret = std::any_of(paths.cbegin(), paths.cend(), std::bind(_d_isSubFileOf, path, std::placeholders::_1));
+    bool ret = _d_isAllowedPath(path);
 
     if (!ret)
         return ret;
@@ -49,6 +224,7 @@ class DCapFSFileEnginePrivate : public DObjectPrivate
 {
     D_DECLARE_PUBLIC(DCapFSFileEngine)
 public:
+    D_DECLARE_POOLED_PRIVATE(DCapFSFileEnginePrivate)
     DCapFSFileEnginePrivate(const QString &file, DCapFSFileEngine *qq);
 
     bool canReadWrite(const QString &path) const;
@@ -68,18 +244,12 @@ bool DCapFSFileEnginePrivate::canReadWrite(const QString &path) const
     if (path.isEmpty())
         return false;
 
-    QString target = path;
     if (path == this->file) {
         D_QC(DCapFSFileEngine);
-        target = q->fileName(DCapFSFileEngine::AbsoluteName);
-    } else {
-        QFSFileEngine engine(path);
-        target = engine.fileName(DCapFSFileEngine::AbsoluteName);
+        return _d_canReadWrite(q->fileName(DCapFSFileEngine::AbsoluteName));
     }
 
-    auto paths = DCapManager::instance()->paths();
-    return std::any_of(paths.cbegin(), paths.cend(),
-                       std::bind(_d_isSubFileOf, target, std::placeholders::_1));
+    return _d_canReadWrite(path);
 }
 
 DCapFSFileEngine::DCapFSFileEngine(const QString &file)
@@ -129,6 +299,8 @@ bool DCapFSFileEngine::copy(const QString &newName)
         qWarning() << "DCapFSFileEngine: " << QStringLiteral("The file [%1] has no permission to copy!").arg(newName);
         return true;
     }
+    if (_d_copyFile(fileName(DCapFSFileEngine::AbsoluteName), newName))
+        return true;
     return QFSFileEngine::copy(newName);
 }
 
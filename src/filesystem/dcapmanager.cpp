@@ -5,11 +5,19 @@
 #include "dcapmanager.h"
 #include "dobject_p.h"
 #include "dstandardpaths.h"
+#include "dsingleton.h"
 #include "private/dcapfsfileengine_p.h"
 
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
 #include <QStandardPaths>
+#include <QMutexLocker>
+#include <QVector>
 #include <QDebug>
 
+#include <atomic>
+
 DCORE_BEGIN_NAMESPACE
 
 QString _d_cleanPath(const QString &path) {
@@ -23,6 +31,121 @@ bool _d_isSubFileOf(const QString &filePath, const QString &directoryPath)
     return ret;
 }
 
+// The allowed paths in a tree of the path components, a lookup walks the components
+// of the path once, instead of matching every allowed path. The allowed paths are cleaned
+// when the tree is built, and a lookup of a cleaned path doesn't allocate.
+class DCapPathTrie
+{
+public:
+    explicit DCapPathTrie(const QStringList &paths);
+
+    bool contains(const QString &path) const;
+
+private:
+    using HashValue = decltype(qHash(QStringView()));
+
+    struct Node
+    {
+        QString name;
+        // the children by the hash of their names
+        QMultiHash<HashValue, int> children;
+        bool allowed = false;
+    };
+
+    template<typename Visitor>
+    static void forEachComponent(QStringView path, Visitor visitor);
+    static bool isClean(QStringView path);
+    int child(int node, QStringView name) const;
+    bool lookup(QStringView path) const;
+
+    QVector<Node> nodes;
+};
+
+// the empty components are skipped, "//" is the same as "/"
+template<typename Visitor>
+void DCapPathTrie::forEachComponent(QStringView path, Visitor visitor)
+{
+    qsizetype from = 0;
+    while (from < path.size()) {
+        qsizetype to = path.indexOf(QLatin1Char('/'), from);
+        if (to < 0)
+            to = path.size();
+        if (to > from && !visitor(path.mid(from, to - from)))
+            return;
+        from = to + 1;
+    }
+}
+
+bool DCapPathTrie::isClean(QStringView path)
+{
+    bool clean = true;
+    forEachComponent(path, [&clean](QStringView name) {
+        clean = name != QLatin1String(".") && name != QLatin1String("..");
+        return clean;
+    });
+    return clean;
+}
+
+int DCapPathTrie::child(int node, QStringView name) const
+{
+    const auto &children = nodes[node].children;
+    const HashValue hash = qHash(name);
+    for (auto it = children.constFind(hash); it != children.cend() && it.key() == hash; ++it) {
+        if (QStringView(nodes[it.value()].name) == name)
+            return it.value();
+    }
+    return -1;
+}
+
+DCapPathTrie::DCapPathTrie(const QStringList &paths)
+    : nodes(1)
+{
+    for (const QString &path : paths) {
+        if (path.isEmpty())
+            continue;
+
+        int node = 0;
+        forEachComponent(QDir::cleanPath(path), [this, &node](QStringView name) {
+            int next = child(node, name);
+            if (next < 0) {
+                next = nodes.size();
+                nodes[node].children.insert(qHash(name), next);
+                nodes.append(Node());
+                nodes[next].name = name.toString();
+            }
+            node = next;
+            return true;
+        });
+        nodes[node].allowed = true;
+    }
+}
+
+bool DCapPathTrie::lookup(QStringView path) const
+{
+    int node = 0;
+    bool allowed = nodes[node].allowed;
+    forEachComponent(path, [this, &node, &allowed](QStringView name) {
+        node = child(node, name);
+        if (node < 0)
+            return false;
+        allowed = nodes[node].allowed;
+        return !allowed;
+    });
+    return allowed;
+}
+
+bool DCapPathTrie::contains(const QString &path) const
+{
+    if (path.isEmpty())
+        return false;
+
+    // the paths of the file engines are cleaned, ".." can't be walked by the tree
+    if (!isClean(path))
+        return lookup(QDir::cleanPath(path));
+
+    return lookup(path);
+}
+
 static QStringList defaultWriteablePaths() {
     QStringList paths;
     int list[] = {QStandardPaths::AppConfigLocation,
@@ -71,22 +194,133 @@ static QStringList defaultWriteablePaths() {
     return paths;
 }
 
+// the allowed paths and their canonical paths, the file engines check the canonical parent directory
+static QStringList canonicalPaths(const QStringList &paths)
+{
+    QStringList result = paths;
+    for (const QString &path : paths) {
+        const QString &canonicalPath = QFileInfo(path).canonicalFilePath();
+        if (!canonicalPath.isEmpty() && canonicalPath != path)
+            result.append(canonicalPath);
+    }
+    return result;
+}
+
+// An immutable snapshot of the allowed paths, it's never changed after published.
+struct DCapPathSnapshot
+{
+    DCapPathSnapshot(const QStringList &paths, quint64 version)
+        : paths(paths)
+        , trie(canonicalPaths(paths))
+        , version(version)
+    {
+    }
+
+    const QStringList paths;
+    const DCapPathTrie trie;
+    const quint64 version;
+};
+
+// The snapshot is published atomically, so that the file engines read it without a lock
+// from any thread. The readers are counted while they use a snapshot, the old snapshots
+// are deleted by the next update which finds no reader, the paths are rarely changed.
+class DCapPathRegistry
+{
+public:
+    ~DCapPathRegistry()
+    {
+        delete current.load();
+        qDeleteAll(retired);
+    }
+
+    // the snapshot is valid until the reader is destroyed
+    class Reader
+    {
+    public:
+        explicit Reader(DCapPathRegistry *registry)
+            : registry(registry)
+        {
+            // it's ordered with the store of the updater, see update()
+            ++registry->readers;
+            snapshot = registry->current.load();
+        }
+        ~Reader() { --registry->readers; }
+
+        const DCapPathSnapshot *operator->() const { return snapshot; }
+        explicit operator bool() const { return snapshot; }
+
+    private:
+        Q_DISABLE_COPY(Reader)
+        DCapPathRegistry *registry;
+        const DCapPathSnapshot *snapshot;
+    };
+
+    template<typename Updater>
+    void update(Updater updater)
+    {
+        QMutexLocker locker(&mutex);
+        const DCapPathSnapshot *old = current.load();
+        QStringList paths = old ? old->paths : QStringList();
+        if (!updater(paths))
+            return;
+
+        current.store(new DCapPathSnapshot(paths, old ? old->version + 1 : 1));
+        if (old)
+            retired.append(old);
+
+        // the readers which come after the store read the new one, so the retired ones
+        // aren't used by anyone if there is no reader now.
+        if (readers.load() == 0) {
+            qDeleteAll(retired);
+            retired.clear();
+        }
+    }
+
+private:
+    QMutex mutex;
+    std::atomic<const DCapPathSnapshot *> current { nullptr };
+    std::atomic<int> readers { 0 };
+    QVector<const DCapPathSnapshot *> retired;
+};
+Q_GLOBAL_STATIC(DCapPathRegistry, capPathRegistry)
+
 class DCapManagerPrivate : public DObjectPrivate
 {
     D_DECLARE_PUBLIC(DCapManager)
 public:
     DCapManagerPrivate(DCapManager *qq);
-
-    QStringList pathList;
 };
 
 class DCapManager_ : public DCapManager {};
-Q_GLOBAL_STATIC(DCapManager_, capManager)
 
 DCapManagerPrivate::DCapManagerPrivate(DCapManager *qq)
     : DObjectPrivate(qq)
 {
-    pathList = defaultWriteablePaths();
+    capPathRegistry->update([](QStringList &paths) {
+        paths = defaultWriteablePaths();
+        return true;
+    });
+}
+
+// the path should be absolute, it's checked by the path components after cleaned
+bool _d_isAllowedPath(const QString &path)
+{
+    // the default paths are published by the manager
+    if (!DCapManager::instance() || !capPathRegistry.exists())
+        return false;
+
+    const DCapPathRegistry::Reader snapshot(capPathRegistry);
+    return snapshot && snapshot->trie.contains(path);
+}
+
+// it's increased when the paths are changed, 0 if there is no path
+quint64 _d_allowedPathsVersion()
+{
+    if (!DCapManager::instance() || !capPathRegistry.exists())
+        return 0;
+
+    const DCapPathRegistry::Reader snapshot(capPathRegistry);
+    return snapshot ? snapshot->version : 0;
 }
 
 DCapManager::DCapManager()
@@ -97,7 +331,8 @@ DCapManager::DCapManager()
 
 DCapManager *DCapManager::instance()
 {
-    return capManager;
+    // it's called by the file engine for every path, it's a single load after created
+    return DFastSingleton<DCapManager_>::instance();
 }
 
 #if DTK_VERSION < DTK_VERSION_CHECK(6, 0, 0, 0)
@@ -112,40 +347,45 @@ void DCapManager::unregisterFileEngine()
 
 void DCapManager::appendPath(const QString &path)
 {
-    D_D(DCapManager);
-    const QString &targetPath = _d_cleanPath(path);
-    bool exist = std::any_of(d->pathList.cbegin(), d->pathList.cend(),
-                             std::bind(_d_isSubFileOf, targetPath, std::placeholders::_1));
-    if (exist)
-        return;
-    d->pathList.append(targetPath);
+    appendPaths({path});
 }
 
 void DCapManager::appendPaths(const QStringList &pathList)
 {
-    for (auto path : pathList)
-        appendPath(path);
+    capPathRegistry->update([&pathList](QStringList &paths) {
+        bool changed = false;
+        for (const QString &path : pathList) {
+            const QString &targetPath = _d_cleanPath(path);
+            bool exist = std::any_of(paths.cbegin(), paths.cend(),
+                                     std::bind(_d_isSubFileOf, targetPath, std::placeholders::_1));
+            if (exist)
+                continue;
+            paths.append(targetPath);
+            changed = true;
+        }
+        return changed;
+    });
 }
 
 void DCapManager::removePath(const QString &path)
 {
-    D_D(DCapManager);
-    const QString &targetPath = _d_cleanPath(path);
-    if (!d->pathList.contains(targetPath))
-        return;
-    d->pathList.removeOne(targetPath);
+    removePaths({path});
 }
 
-void DCapManager::removePaths(const QStringList &paths)
+void DCapManager::removePaths(const QStringList &pathList)
 {
-    for (auto path : paths)
-        removePath(path);
+    capPathRegistry->update([&pathList](QStringList &paths) {
+        bool changed = false;
+        for (const QString &path : pathList)
+            changed = paths.removeOne(_d_cleanPath(path)) || changed;
+        return changed;
+    });
 }
 
 QStringList DCapManager::paths() const
 {
-    D_DC(DCapManager);
-    return d->pathList;
+    const DCapPathRegistry::Reader snapshot(capPathRegistry);
+    return snapshot ? snapshot->paths : QStringList();
 }
 
 DCORE_END_NAMESPACE
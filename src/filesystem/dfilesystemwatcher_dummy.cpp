@@ -236,6 +236,59 @@ QStringList DFileSystemWatcher::files() const
     return QStringList();
 }
 
+bool DFileSystemWatcher::addPath(const QString &path, EventTypes types, const QStringList &excludes)
+{
+    Q_UNUSED(types)
+    Q_UNUSED(excludes)
+    return addPath(path);
+}
+
+DFileSystemWatcher::EventTypes DFileSystemWatcher::eventTypes(const QString &path) const
+{
+    Q_UNUSED(path)
+    return AllEvents;
+}
+
+QStringList DFileSystemWatcher::excludePatterns(const QString &path) const
+{
+    Q_UNUSED(path)
+    return QStringList();
+}
+
+bool DFileSystemWatcher::addRecursive(const QString &path, const QStringList &filters)
+{
+    Q_UNUSED(path)
+    Q_UNUSED(filters)
+    return false;
+}
+
+bool DFileSystemWatcher::removeRecursive(const QString &path)
+{
+    Q_UNUSED(path)
+    return false;
+}
+
+bool DFileSystemWatcher::addFilesystem(const QString &path)
+{
+    Q_UNUSED(path)
+    return false;
+}
+
+bool DFileSystemWatcher::removeFilesystem(const QString &path)
+{
+    Q_UNUSED(path)
+    return false;
+}
+
+DFileSystemWatcher::Statistics DFileSystemWatcher::statistics() const
+{
+    return Statistics();
+}
+
+void DFileSystemWatcher::resetStatistics()
+{
+}
+
 DCORE_END_NAMESPACE
 
 #include "moc_dfilesystemwatcher.cpp"
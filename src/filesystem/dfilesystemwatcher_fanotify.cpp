@@ -0,0 +1,346 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dfilesystemwatcher.h"
+#include "private/dfilesystemwatcher_linux_p.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+DCORE_BEGIN_NAMESPACE
+
+// The directory and the name of the events are reported since Linux 5.9, the older kernel and
+// C library fall back to the recursive inotify watches.
+#ifdef FAN_REPORT_DFID_NAME
+
+static constexpr uint64_t FanotifyMask = FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_MODIFY
+        | FAN_ATTRIB | FAN_CLOSE_WRITE | FAN_ONDIR;
+#ifdef FAN_RENAME
+// both names of a rename are reported by one event since Linux 5.17
+static constexpr uint64_t FanotifyRenameMask = (FanotifyMask & ~uint64_t(FAN_MOVED_FROM | FAN_MOVED_TO)) | FAN_RENAME;
+#endif
+static constexpr int FanotifyReadBufferSize = 64 * 1024;
+// the directories are resolved by the handles again if there are more of them
+static constexpr int MaxCachedDirectories = 4096;
+
+static QByteArray filesystemId(const QString &path)
+{
+    struct statfs buf;
+    if (statfs(QFile::encodeName(path).constData(), &buf) != 0)
+        return QByteArray();
+
+    return QByteArray(reinterpret_cast<const char *>(&buf.f_fsid), sizeof(buf.f_fsid));
+}
+
+bool DFileSystemWatcherPrivate::addFilesystem(const QString &path)
+{
+    Q_Q(DFileSystemWatcher);
+
+    if (fanotifyMarks.contains(path))
+        return true;
+
+    if (fanotifyFd == -1) {
+        if (fanotifyUnavailable)
+            return false;
+
+        fanotifyFd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME, O_RDONLY | O_CLOEXEC);
+        if (fanotifyFd == -1) {
+            // EPERM without CAP_SYS_ADMIN, EINVAL if the kernel doesn't support FAN_REPORT_DFID_NAME
+            qCDebug(logFSW) << "fanotify is unavailable:" << strerror(errno);
+            fanotifyUnavailable = true;
+            return false;
+        }
+
+        fanotifyNotifier = new QSocketNotifier(fanotifyFd, QSocketNotifier::Read, q);
+        QObject::connect(fanotifyNotifier, &QSocketNotifier::activated, q, [this] {
+            readFromFanotify();
+        });
+    }
+
+    const QByteArray &fsid = filesystemId(path);
+    if (fsid.isEmpty())
+        return false;
+
+    // one mark covers the whole filesystem, the other paths of it share the mark
+    if (!fanotifyMountFds.contains(fsid)) {
+        const int mountFd = open(QFile::encodeName(path).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (mountFd == -1)
+            return false;
+
+        auto mark = [&] (uint64_t mask) {
+            return fanotify_mark(fanotifyFd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask, AT_FDCWD,
+                                 QFile::encodeName(path).constData()) == 0;
+        };
+
+        bool marked = false;
+        if (!fanotifyMask) {
+#ifdef FAN_RENAME
+            // EINVAL if the kernel doesn't support FAN_RENAME
+            if (mark(FanotifyRenameMask)) {
+                fanotifyMask = FanotifyRenameMask;
+                marked = true;
+            } else if (errno == EINVAL)
+#endif
+            {
+                if (mark(FanotifyMask)) {
+                    fanotifyMask = FanotifyMask;
+                    marked = true;
+                }
+            }
+        } else {
+            marked = mark(fanotifyMask);
+        }
+
+        if (!marked) {
+            qCWarning(logFSW) << "fanotify_mark failed:" << path << strerror(errno);
+            ::close(mountFd);
+            return false;
+        }
+
+        fanotifyMountFds.insert(fsid, mountFd);
+    }
+
+    fanotifyMarks.insert(path, fsid);
+    // the paths of the events are resolved by the file handles
+    const QString &canonicalPath = QFileInfo(path).canonicalFilePath();
+    fanotifyRoots.insert(path, canonicalPath.isEmpty() ? path : canonicalPath);
+    return true;
+}
+
+bool DFileSystemWatcherPrivate::removeFilesystem(const QString &path)
+{
+    const auto it = fanotifyMarks.find(path);
+    if (it == fanotifyMarks.end())
+        return false;
+
+    const QByteArray fsid = it.value();
+    fanotifyMarks.erase(it);
+    fanotifyRoots.remove(path);
+    for (const QByteArray &other : std::as_const(fanotifyMarks)) {
+        if (other == fsid)
+            return true;
+    }
+
+    fanotify_mark(fanotifyFd, FAN_MARK_REMOVE | FAN_MARK_FILESYSTEM, fanotifyMask, AT_FDCWD,
+                  QFile::encodeName(path).constData());
+    ::close(fanotifyMountFds.take(fsid));
+    // the handles of the other filesystems may be cached too, they are cached again in need
+    fanotifyDirCache.clear();
+
+    return true;
+}
+
+QString DFileSystemWatcherPrivate::fanotifyDirectoryPath(const QByteArray &fsid, const char *handle, int handleSize)
+{
+    QByteArray key = fsid;
+    key.append(handle, handleSize);
+
+    const auto it = fanotifyDirCache.constFind(key);
+    if (it != fanotifyDirCache.cend())
+        return it.value();
+
+    const int mountFd = fanotifyMountFds.value(fsid, -1);
+    if (mountFd == -1)
+        return QString();
+
+    // the handle is copied, it isn't aligned in the buffer
+    QByteArray handleData(handle, handleSize);
+    const int fd = open_by_handle_at(mountFd, reinterpret_cast<file_handle *>(handleData.data()), O_PATH | O_CLOEXEC);
+    if (fd == -1)
+        return QString();
+
+    char target[PATH_MAX];
+    const ssize_t size = readlink(QByteArray("/proc/self/fd/").append(QByteArray::number(fd)).constData(), target, sizeof(target));
+    ::close(fd);
+    if (size <= 0)
+        return QString();
+
+    const QString &path = QFile::decodeName(QByteArray(target, int(size)));
+    if (fanotifyDirCache.size() >= MaxCachedDirectories)
+        fanotifyDirCache.clear();
+    fanotifyDirCache.insert(key, path);
+    return path;
+}
+
+bool DFileSystemWatcherPrivate::isUnderFilesystemMark(const QString &path) const
+{
+    for (const QString &root : fanotifyRoots) {
+        if (path == root || root == QLatin1String("/")
+            || (path.startsWith(root) && path.at(root.size()) == QLatin1Char('/')))
+            return true;
+    }
+
+    return false;
+}
+
+void DFileSystemWatcherPrivate::readFromFanotify()
+{
+    Q_Q(DFileSystemWatcher);
+
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+    int batchEventCount = 0;
+    bool overflowed = false;
+
+    QByteArray buffer(FanotifyReadBufferSize, Qt::Uninitialized);
+    const ssize_t size = read(fanotifyFd, buffer.data(), buffer.size());
+    if (size <= 0)
+        return;
+
+    // the directory of a record, it's empty if the directory is removed before the event is read
+    auto readRecord = [this] (const char *info, const fanotify_event_info_header &header, QString *path, QString *name) {
+        const char *fsid = info + offsetof(fanotify_event_info_fid, fsid);
+        const char *handle = info + offsetof(fanotify_event_info_fid, handle);
+        file_handle handleHeader;
+        memcpy(&handleHeader, handle, sizeof(handleHeader));
+        const int handleSize = int(sizeof(file_handle) + handleHeader.handle_bytes);
+
+        *path = fanotifyDirectoryPath(QByteArray(fsid, sizeof(fanotify_event_info_fid::fsid)), handle, handleSize);
+        const char *fileName = handle + handleSize;
+        *name = QFile::decodeName(QByteArray(fileName, int(qstrnlen(fileName, int(info + header.len - fileName)))));
+    };
+
+    const fanotify_event_metadata *event = reinterpret_cast<const fanotify_event_metadata *>(buffer.constData());
+    int length = int(size);
+    for (; FAN_EVENT_OK(event, length); event = FAN_EVENT_NEXT(event, length)) {
+        if (event->vers != FANOTIFY_METADATA_VERSION) {
+            qCWarning(logFSW) << "the version of fanotify metadata is mismatched";
+            break;
+        }
+
+        ++batchEventCount;
+        if (event->mask & FAN_Q_OVERFLOW) {
+            overflowed = true;
+            continue;
+        }
+
+        const char *info = reinterpret_cast<const char *>(event) + event->metadata_len;
+        const char * const infoEnd = reinterpret_cast<const char *>(event) + event->event_len;
+        QString path, name, fromPath, fromName;
+        while (info + sizeof(fanotify_event_info_header) <= infoEnd) {
+            fanotify_event_info_header header;
+            memcpy(&header, info, sizeof(header));
+            if (header.len == 0 || info + header.len > infoEnd)
+                break;
+
+            switch (header.info_type) {
+            case FAN_EVENT_INFO_TYPE_DFID_NAME:
+#ifdef FAN_RENAME
+            case FAN_EVENT_INFO_TYPE_NEW_DFID_NAME:
+#endif
+                readRecord(info, header, &path, &name);
+                break;
+#ifdef FAN_RENAME
+            case FAN_EVENT_INFO_TYPE_OLD_DFID_NAME:
+                readRecord(info, header, &fromPath, &fromName);
+                break;
+#endif
+            default:
+                break;
+            }
+
+            info += header.len;
+        }
+
+        // a directory is moved or removed, the cached paths under it are stale
+        if ((event->mask & FAN_ONDIR) && (event->mask & (FAN_MOVED_FROM | FAN_MOVED_TO | FAN_DELETE)))
+            fanotifyDirCache.clear();
+
+        // the events of the filesystem out of the watched directories
+        const bool watched = !path.isEmpty() && isUnderFilesystemMark(path);
+
+#ifdef FAN_RENAME
+        if (event->mask & FAN_RENAME) {
+            if (event->mask & FAN_ONDIR)
+                fanotifyDirCache.clear();
+
+            const bool fromWatched = !fromPath.isEmpty() && isUnderFilesystemMark(fromPath);
+            if (fromWatched && watched)
+                Q_EMIT q->fileMoved(fromPath, fromName, path, name, DFileSystemWatcher::QPrivateSignal());
+            else if (fromWatched)
+                Q_EMIT q->fileDeleted(fromPath, fromName, DFileSystemWatcher::QPrivateSignal());
+            else if (watched)
+                Q_EMIT q->fileCreated(path, name, DFileSystemWatcher::QPrivateSignal());
+        }
+#endif
+
+        if (!watched)
+            continue;
+
+        // the events of a file may be merged into one, all of them are emitted. fanotify doesn't
+        // report the cookie of a move, the halves are emitted as the deletion and the creation
+        if (event->mask & (FAN_CREATE | FAN_MOVED_TO))
+            Q_EMIT q->fileCreated(path, name, DFileSystemWatcher::QPrivateSignal());
+        if (event->mask & FAN_MODIFY)
+            Q_EMIT q->fileModified(path, name, DFileSystemWatcher::QPrivateSignal());
+        if (event->mask & FAN_ATTRIB)
+            Q_EMIT q->fileAttributeChanged(path, name, DFileSystemWatcher::QPrivateSignal());
+        if (event->mask & FAN_CLOSE_WRITE)
+            Q_EMIT q->fileClosed(path, name, DFileSystemWatcher::QPrivateSignal());
+        if (event->mask & (FAN_DELETE | FAN_MOVED_FROM))
+            Q_EMIT q->fileDeleted(path, name, DFileSystemWatcher::QPrivateSignal());
+    }
+
+    recordBatch(batchEventCount, batchTimer.nsecsElapsed() / 1000);
+    if (overflowed)
+        notifyOverflowed("fanotify");
+}
+
+#else
+
+bool DFileSystemWatcherPrivate::addFilesystem(const QString &path)
+{
+    Q_UNUSED(path)
+    return false;
+}
+
+bool DFileSystemWatcherPrivate::removeFilesystem(const QString &path)
+{
+    Q_UNUSED(path)
+    return false;
+}
+
+void DFileSystemWatcherPrivate::readFromFanotify()
+{
+}
+
+QString DFileSystemWatcherPrivate::fanotifyDirectoryPath(const QByteArray &fsid, const char *handle, int handleSize)
+{
+    Q_UNUSED(fsid)
+    Q_UNUSED(handle)
+    Q_UNUSED(handleSize)
+    return QString();
+}
+
+#endif
+
+void DFileSystemWatcherPrivate::closeFanotify()
+{
+    if (fanotifyFd == -1)
+        return;
+
+    delete fanotifyNotifier;
+    fanotifyNotifier = nullptr;
+    for (int mountFd : std::as_const(fanotifyMountFds))
+        ::close(mountFd);
+    fanotifyMountFds.clear();
+    fanotifyMarks.clear();
+    fanotifyRoots.clear();
+    fanotifyDirCache.clear();
+    ::close(fanotifyFd);
+    fanotifyFd = -1;
+}
+
+DCORE_END_NAMESPACE
@@ -4,40 +4,365 @@
 
 #include "dfilesystemwatcher.h"
 #include "private/dfilesystemwatcher_linux_p.h"
+#include "dperfcounters.h"
 
 #include <QFileInfo>
 #include <QDir>
 #include <QSocketNotifier>
 #include <QDebug>
 #include <QMultiMap>
+#include <QSet>
+#include <QTimer>
+#include <QLoggingCategory>
 
+#include <algorithm>
+#include <cstring>
+
+#include <sys/eventfd.h>
 #include <sys/inotify.h>
 #include <sys/fcntl.h>
-#include <sys/ioctl.h>
+#include <fnmatch.h>
+#include <poll.h>
+#include <limits.h>
 #include <unistd.h>
 
 DCORE_BEGIN_NAMESPACE
 
-DFileSystemWatcherPrivate::DFileSystemWatcherPrivate(int fd, DFileSystemWatcher *qq)
-    : DObjectPrivate(qq)
-    , inotifyFd(fd)
-    , notifier(fd, QSocketNotifier::Read, qq)
+#ifdef QT_DEBUG
+Q_LOGGING_CATEGORY(logFSW, "dtk.core.filesystemwatcher")
+#else
+Q_LOGGING_CATEGORY(logFSW, "dtk.core.filesystemwatcher", QtInfoMsg)
+#endif
+
+// it holds hundreds of events, and at least one event of the longest name
+static constexpr int InotifyReadBufferSize = 64 * 1024;
+static_assert(InotifyReadBufferSize >= int(sizeof(inotify_event)) + NAME_MAX + 1, "too small to read an event");
+
+// the events dropped by the filters of addPath(), merged with the same ones of a read, and the overflows of the queue
+static DPerfCounter watcherEventsFiltered("watcher.events_filtered");
+static DPerfCounter watcherEventsCoalesced("watcher.events_coalesced");
+static DPerfCounter watcherQueueOverflows("watcher.queue_overflows");
+
+// the events of a directory in addPaths(), the symbolic links aren't followed to avoid the loops
+static constexpr uint32_t RecursiveWatchMask = IN_ATTRIB | IN_MOVE | IN_MOVE_SELF | IN_CREATE | IN_DELETE
+        | IN_DELETE_SELF | IN_MODIFY | IN_ONLYDIR | IN_DONT_FOLLOW;
+
+// the events of the signals, IN_MOVE_SELF and IN_UNMOUNT of a watched path are notified as deleted
+static quint32 eventTypesMask(DFileSystemWatcher::EventTypes types)
 {
-    fcntl(inotifyFd, F_SETFD, FD_CLOEXEC);
-    qq->connect(&notifier, SIGNAL(activated(int)), qq, SLOT(_q_readFromInotify()));
+    quint32 mask = 0;
+    if (types & DFileSystemWatcher::FileDeletedEvent)
+        mask |= IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT;
+    if (types & DFileSystemWatcher::FileAttributeChangedEvent)
+        mask |= IN_ATTRIB;
+    if (types & DFileSystemWatcher::FileClosedEvent)
+        mask |= IN_CLOSE_WRITE;
+    if (types & DFileSystemWatcher::FileMovedEvent)
+        mask |= IN_MOVE;
+    if (types & DFileSystemWatcher::FileCreatedEvent)
+        mask |= IN_CREATE;
+    if (types & DFileSystemWatcher::FileModifiedEvent)
+        mask |= IN_MODIFY;
+
+    return mask;
 }
 
-DFileSystemWatcherPrivate::~DFileSystemWatcherPrivate()
+// It's called before the name is decoded, the patterns are matched with the bytes of it.
+static bool acceptsEvent(const DFileSystemWatcherPrivate::WatchFilter &filter, const inotify_event *event)
 {
-    notifier.setEnabled(false);
-    Q_FOREACH (int id, pathToID)
-        inotify_rm_watch(inotifyFd, id < 0 ? -id : id);
+    if (!(event->mask & filter.mask))
+        return false;
+
+    if (event->len == 0)
+        return true;
 
+    for (const QByteArray &pattern : filter.encodedExcludes) {
+        if (fnmatch(pattern.constData(), event->name, 0) == 0)
+            return false;
+    }
+
+    return true;
+}
+
+// the IN_MOVED_FROM waits for the IN_MOVED_TO of the next reads for a while, at most MaxPendingMoves of them
+static constexpr int MoveCorrelationTimeout = 50;
+static constexpr int MaxPendingMoves = 256;
+
+// the chunks kept for a subscriber whose queue is full, about as many as its queue holds
+static constexpr int MaxPendingChunks = 64;
+
+static QMutex sharedInotifyMutex;
+static DInotifyInstance *sharedInotify = nullptr;
+
+DInotifyInstance::DInotifyInstance(int inotifyFd, int wakeupFd)
+    : inotifyFd(inotifyFd)
+    , wakeupFd(wakeupFd)
+{
+}
+
+DInotifyInstance::~DInotifyInstance()
+{
+    const quint64 value = 1;
+    if (::write(wakeupFd, &value, sizeof(value)) != sizeof(value))
+        qCWarning(logFSW) << "failed to wake up the inotify reader thread:" << strerror(errno);
+    wait();
+
+    ::close(wakeupFd);
     ::close(inotifyFd);
 }
 
-QStringList DFileSystemWatcherPrivate::addPaths(const QStringList &paths, QStringList *files, QStringList *directories)
+DInotifyInstance *DInotifyInstance::acquire()
+{
+    QMutexLocker locker(&sharedInotifyMutex);
+
+    if (!sharedInotify) {
+        int fd = -1;
+#ifdef IN_CLOEXEC
+        fd = inotify_init1(IN_CLOEXEC | O_NONBLOCK);
+#endif
+        if (fd == -1) {
+            fd = inotify_init1(O_NONBLOCK);
+            if (fd == -1)
+                return nullptr;
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+
+        const int wakeupFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (wakeupFd == -1) {
+            ::close(fd);
+            return nullptr;
+        }
+
+        sharedInotify = new DInotifyInstance(fd, wakeupFd);
+        sharedInotify->start();
+    }
+
+    ++sharedInotify->refCount;
+    return sharedInotify;
+}
+
+void DInotifyInstance::release(DInotifyInstance *instance)
+{
+    QMutexLocker locker(&sharedInotifyMutex);
+
+    Q_ASSERT(instance == sharedInotify);
+    if (--instance->refCount > 0)
+        return;
+
+    sharedInotify = nullptr;
+    delete instance;
+}
+
+int DInotifyInstance::addWatch(const QString &path, quint32 mask, DFileSystemWatcherPrivate *subscriber)
+{
+    // the wd is subscribed before the events of it are dispatched
+    QMutexLocker locker(&mutex);
+
+    // the inode may be watched by the other subscribers, the events of them are kept, and the
+    // events which a subscriber doesn't ask for are dropped by it
+    const int wd = inotify_add_watch(inotifyFd, QFile::encodeName(path), mask | IN_MASK_ADD);
+    if (wd < 0)
+        return wd;
+
+    QVector<DFileSystemWatcherPrivate *> &list = subscribers[wd];
+    if (!list.contains(subscriber))
+        list.append(subscriber);
+
+    return wd;
+}
+
+void DInotifyInstance::removeWatch(int wd, DFileSystemWatcherPrivate *subscriber)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = subscribers.find(wd);
+    if (it == subscribers.end())
+        return;
+
+    it->removeOne(subscriber);
+    if (it->isEmpty()) {
+        subscribers.erase(it);
+        inotify_rm_watch(inotifyFd, wd);
+    }
+}
+
+void DInotifyInstance::unsubscribe(DFileSystemWatcherPrivate *subscriber)
+{
+    QMutexLocker locker(&mutex);
+
+    for (auto it = subscribers.begin(); it != subscribers.end();) {
+        it->removeOne(subscriber);
+        if (it->isEmpty()) {
+            inotify_rm_watch(inotifyFd, it.key());
+            it = subscribers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    pending.remove(subscriber);
+}
+
+// Splits the events by the subscribers of the wds, it's called with the mutex locked.
+void DInotifyInstance::dispatch(const char *data, qsizetype size)
+{
+    QVector<QPair<DFileSystemWatcherPrivate *, QByteArray>> chunks;
+
+    const char *at = data;
+    const char * const end = at + size;
+    while (at < end) {
+        const inotify_event *event = reinterpret_cast<const inotify_event *>(at);
+        const int eventSize = int(sizeof(inotify_event) + event->len);
+        at += eventSize;
+
+        auto append = [&chunks, event, eventSize](DFileSystemWatcherPrivate *subscriber) {
+            auto chunk = std::find_if(chunks.begin(), chunks.end(), [subscriber](const QPair<DFileSystemWatcherPrivate *, QByteArray> &chunk) {
+                return chunk.first == subscriber;
+            });
+            if (chunk == chunks.end())
+                chunk = chunks.insert(chunks.end(), qMakePair(subscriber, QByteArray()));
+            chunk->second.append(reinterpret_cast<const char *>(event), eventSize);
+        };
+
+        // the events of all of the watchers may be lost
+        if (event->mask & IN_Q_OVERFLOW) {
+            QSet<DFileSystemWatcherPrivate *> all;
+            for (const auto &list : std::as_const(subscribers)) {
+                for (DFileSystemWatcherPrivate *subscriber : list) {
+                    if (!all.contains(subscriber)) {
+                        all.insert(subscriber);
+                        append(subscriber);
+                    }
+                }
+            }
+            continue;
+        }
+
+        const auto it = subscribers.constFind(event->wd);
+        if (it == subscribers.cend())
+            continue;
+
+        for (DFileSystemWatcherPrivate *subscriber : *it)
+            append(subscriber);
+
+        // the watch is removed by the kernel, e.g. the file is deleted, the wd may be reused later
+        if (event->mask & IN_IGNORED)
+            subscribers.remove(event->wd);
+    }
+
+    for (const auto &chunk : chunks) {
+        // the chunks are kept in order after the pending ones of the subscriber
+        auto it = pending.find(chunk.first);
+        if (it == pending.end() && chunk.first->queueEvents(chunk.second))
+            continue;
+
+        if (it == pending.end())
+            it = pending.insert(chunk.first, PendingChunks());
+        if (it->chunks.size() >= MaxPendingChunks) {
+            it->chunks.clear();
+            it->dropped = true;
+        }
+        it->chunks.append(chunk.second);
+    }
+}
+
+// Queues the pending chunks of the subscribers whose queue has room, it's called with the mutex locked.
+void DInotifyInstance::queuePending()
+{
+    for (auto it = pending.begin(); it != pending.end();) {
+        DFileSystemWatcherPrivate *subscriber = it.key();
+        PendingChunks &chunks = it.value();
+
+        // the subscriber rescans as the events were lost
+        if (chunks.dropped) {
+            inotify_event overflow;
+            memset(&overflow, 0, sizeof(overflow));
+            overflow.wd = -1;
+            overflow.mask = IN_Q_OVERFLOW;
+            if (!subscriber->queueEvents(QByteArray(reinterpret_cast<const char *>(&overflow), sizeof(overflow)))) {
+                ++it;
+                continue;
+            }
+            chunks.dropped = false;
+        }
+
+        while (!chunks.chunks.isEmpty() && subscriber->queueEvents(chunks.chunks.first()))
+            chunks.chunks.removeFirst();
+
+        if (chunks.chunks.isEmpty())
+            it = pending.erase(it);
+        else
+            ++it;
+    }
+}
+
+void DInotifyInstance::run()
+{
+    pollfd fds[2] = {{wakeupFd, POLLIN, 0}, {inotifyFd, POLLIN, 0}};
+    QByteArray buffer(InotifyReadBufferSize, Qt::Uninitialized);
+
+    Q_FOREVER {
+        bool hasPending = false;
+        {
+            QMutexLocker locker(&mutex);
+            queuePending();
+            hasPending = !pending.isEmpty();
+        }
+
+        // If a queue is full, the chunks of it are queued again after a while, the events of the
+        // other subscribers are still read meanwhile.
+        const int ret = poll(fds, 2, hasPending ? 10 : -1);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            qCWarning(logFSW) << "poll of the inotify reader thread failed:" << strerror(errno);
+            return;
+        }
+
+        if (fds[0].revents & POLLIN)
+            return;
+
+        if (!(fds[1].revents & POLLIN))
+            continue;
+
+        const ssize_t size = read(inotifyFd, buffer.data(), buffer.size());
+        if (size <= 0)
+            continue;
+
+        QMutexLocker locker(&mutex);
+        dispatch(buffer.constData(), size);
+    }
+}
+
+DFileSystemWatcherPrivate::DFileSystemWatcherPrivate(DInotifyInstance *inotify, DFileSystemWatcher *qq)
+    : DObjectPrivate(qq)
+    , inotify(inotify)
+{
+    moveClock.start();
+    statsClock.start();
+}
+
+DFileSystemWatcherPrivate::~DFileSystemWatcherPrivate()
 {
+    // the events aren't queued for it after that
+    inotify->unsubscribe(this);
+    DInotifyInstance::release(inotify);
+    closeFanotify();
+}
+
+QStringList DFileSystemWatcherPrivate::addPaths(const QStringList &paths, QStringList *files, QStringList *directories,
+                                                DFileSystemWatcher::EventTypes types, const QStringList &excludes)
+{
+    const bool filtered = types != DFileSystemWatcher::AllEvents || !excludes.isEmpty();
+    WatchFilter filter;
+    if (filtered) {
+        filter.types = types;
+        filter.mask = eventTypesMask(types);
+        filter.excludes = excludes;
+        for (const QString &pattern : excludes)
+            filter.encodedExcludes << QFile::encodeName(pattern);
+    }
+
     QStringList p = paths;
     QMutableListIterator<QString> it(p);
     while (it.hasNext()) {
@@ -52,26 +377,33 @@ QStringList DFileSystemWatcherPrivate::addPaths(const QStringList &paths, QStrin
                 continue;
         }
 
-        int wd = inotify_add_watch(inotifyFd,
-                                   QFile::encodeName(path),
-                                   (isDir
-                                    ? (0
-                                       | IN_ATTRIB
-                                       | IN_MOVE
-                                       | IN_MOVE_SELF
-                                       | IN_CREATE
-                                       | IN_DELETE
-                                       | IN_DELETE_SELF
-                                       | IN_MODIFY
-                                       )
-                                    : (0
-                                       | IN_ATTRIB
-                                       | IN_CLOSE_WRITE
-                                       | IN_MODIFY
-                                       | IN_MOVE
-                                       | IN_MOVE_SELF
-                                       | IN_DELETE_SELF
-                                       )));
+        quint32 mask = isDir
+                ? (0
+                   | IN_ATTRIB
+                   | IN_MOVE
+                   | IN_MOVE_SELF
+                   | IN_CREATE
+                   | IN_DELETE
+                   | IN_DELETE_SELF
+                   | IN_MODIFY
+                   )
+                : (0
+                   | IN_ATTRIB
+                   | IN_CLOSE_WRITE
+                   | IN_MODIFY
+                   | IN_MOVE
+                   | IN_MOVE_SELF
+                   | IN_DELETE_SELF
+                   );
+        if (filtered) {
+            // the events out of the filter aren't read from the kernel at all
+            mask &= filter.mask;
+            // inotify_add_watch() fails without any event
+            if (!mask)
+                mask = IN_DELETE_SELF;
+        }
+
+        int wd = inotify->addWatch(path, mask, this);
         if (wd < 0) {
             perror("DFileSystemWatcherPrivate::addPaths: inotify_add_watch failed");
             continue;
@@ -86,6 +418,27 @@ QStringList DFileSystemWatcherPrivate::addPaths(const QStringList &paths, QStrin
             files->append(path);
         }
 
+        // the paths of the same inode share the id, the filter of them accepts the events of both
+        const bool shared = idToPath.contains(id);
+        if (!shared) {
+            if (filtered)
+                watchFilters.insert(id, filter);
+        } else if (watchFilters.contains(id)) {
+            if (!filtered) {
+                watchFilters.remove(id);
+            } else {
+                WatchFilter &sharedFilter = watchFilters[id];
+                sharedFilter.types |= filter.types;
+                sharedFilter.mask |= filter.mask;
+                for (int i = sharedFilter.excludes.size() - 1; i >= 0; --i) {
+                    if (!excludes.contains(sharedFilter.excludes.at(i))) {
+                        sharedFilter.excludes.removeAt(i);
+                        sharedFilter.encodedExcludes.removeAt(i);
+                    }
+                }
+            }
+        }
+
         pathToID.insert(path, id);
         idToPath.insert(id, path);
     }
@@ -109,10 +462,13 @@ QStringList DFileSystemWatcherPrivate::removePaths(const QStringList &paths, QSt
 
         it.remove();
 
-        if (!idToPath.contains(id)) {
+        if (!idToPath.contains(id))
+            watchFilters.remove(id);
+
+        if (!idToPath.contains(id) && !recursiveNodes.contains(id < 0 ? -id : id)) {
             int wd = id < 0 ? -id : id;
             //qDebug() << "removing watch for path" << path << "wd" << wd;
-            inotify_rm_watch(inotifyFd, wd);
+            inotify->removeWatch(wd, this);
         }
 
         if (id < 0) {
@@ -125,24 +481,307 @@ QStringList DFileSystemWatcherPrivate::removePaths(const QStringList &paths, QSt
     return p;
 }
 
-void DFileSystemWatcherPrivate::_q_readFromInotify()
+static inline QString joinPath(const QString &dir, const QString &name)
+{
+    return dir.endsWith(QLatin1Char('/')) ? dir + name : dir + QLatin1Char('/') + name;
+}
+
+int DFileSystemWatcherPrivate::watchRecursive(int parent, const QString &path, const QString &name, const QStringList &filters)
+{
+    const int wd = inotify->addWatch(path, RecursiveWatchMask, this);
+    if (wd < 0) {
+        perror("DFileSystemWatcherPrivate::watchRecursive: inotify_add_watch failed");
+        return -1;
+    }
+
+    // a directory which is in the tree already, e.g. a bind mount of a parent
+    if (recursiveNodes.contains(wd))
+        return wd;
+
+    RecursiveNode &node = recursiveNodes[wd];
+    node.parent = parent;
+    node.name = name;
+    if (parent)
+        recursiveNodes[parent].children.append(wd);
+
+    // the subdirectories are watched after the directory, so that the new ones aren't missed
+    const QStringList &subdirs = QDir(path).entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden | QDir::NoSymLinks);
+    for (const QString &subdir : subdirs) {
+        if (!filters.isEmpty() && QDir::match(filters, subdir))
+            continue;
+        watchRecursive(wd, joinPath(path, subdir), subdir, filters);
+    }
+
+    return wd;
+}
+
+void DFileSystemWatcherPrivate::unwatchRecursive(int wd)
+{
+    auto it = recursiveNodes.find(wd);
+    if (it == recursiveNodes.end())
+        return;
+
+    const RecursiveNode node = it.value();
+    recursiveNodes.erase(it);
+
+    for (int child : node.children)
+        unwatchRecursive(child);
+
+    if (node.parent) {
+        auto parent = recursiveNodes.find(node.parent);
+        if (parent != recursiveNodes.end())
+            parent->children.removeOne(wd);
+    } else {
+        recursiveRoots.remove(node.name);
+        recursiveFilters.remove(wd);
+    }
+
+    // the wd is shared with addPaths() if the directory is watched by it too
+    if (!idToPath.contains(-wd))
+        inotify->removeWatch(wd, this);
+}
+
+QString DFileSystemWatcherPrivate::recursivePath(int wd) const
+{
+    QVector<const QString *> names;
+    for (auto it = recursiveNodes.constFind(wd); it != recursiveNodes.cend(); it = recursiveNodes.constFind(it->parent)) {
+        names.append(&it->name);
+        if (!it->parent)
+            break;
+    }
+
+    QString path;
+    for (auto it = names.crbegin(); it != names.crend(); ++it)
+        path = path.isEmpty() ? **it : joinPath(path, **it);
+
+    return path;
+}
+
+int DFileSystemWatcherPrivate::recursiveRoot(int wd) const
+{
+    for (auto it = recursiveNodes.constFind(wd); it != recursiveNodes.cend(); it = recursiveNodes.constFind(it->parent)) {
+        if (!it->parent)
+            return it.key();
+    }
+
+    return 0;
+}
+
+int DFileSystemWatcherPrivate::recursiveChild(int parent, const QString &name) const
+{
+    const auto node = recursiveNodes.constFind(parent);
+    if (node == recursiveNodes.cend())
+        return 0;
+
+    for (int child : node->children) {
+        const auto it = recursiveNodes.constFind(child);
+        if (it != recursiveNodes.cend() && it->name == name)
+            return child;
+    }
+
+    return 0;
+}
+
+// Keeps the recursive watches in sync with the directories, it's called after the signals of the
+// events are emitted.
+void DFileSystemWatcherPrivate::updateRecursiveWatches(const char *data, qsizetype size)
+{
+    // the cookie of a directory which is moved from a watched directory, to its wd
+    QHash<uint32_t, int> movedFrom;
+
+    const char *at = data;
+    const char * const end = at + size;
+    while (at < end) {
+        const inotify_event *event = reinterpret_cast<const inotify_event *>(at);
+        at += sizeof(inotify_event) + event->len;
+
+        if (!recursiveNodes.contains(event->wd))
+            continue;
+
+        // the directory is removed, or the filesystem is unmounted
+        if (event->mask & IN_IGNORED) {
+            unwatchRecursive(event->wd);
+            continue;
+        }
+
+        if (!(event->mask & IN_ISDIR) || event->len == 0)
+            continue;
+
+        const QString &name = QString::fromUtf8(event->name);
+        if (event->mask & IN_MOVED_FROM) {
+            const int child = recursiveChild(event->wd, name);
+            if (child) {
+                recursiveNodes[event->wd].children.removeOne(child);
+                movedFrom.insert(event->cookie, child);
+            }
+            continue;
+        }
+
+        if (!(event->mask & (IN_CREATE | IN_MOVED_TO)) || recursiveChild(event->wd, name))
+            continue;
+
+        const int root = recursiveRoot(event->wd);
+        const QStringList &filters = recursiveFilters.value(root);
+        const bool filtered = !filters.isEmpty() && QDir::match(filters, name);
+        int moved = 0;
+        if (event->mask & IN_MOVED_TO) {
+            moved = movedFrom.take(event->cookie);
+            // moved from a directory in the previous reads
+            if (!moved) {
+                const auto pending = pendingRecursiveMoves.find(event->cookie);
+                if (pending != pendingRecursiveMoves.end()) {
+                    moved = pending->first;
+                    pendingRecursiveMoves.erase(pending);
+                }
+            }
+            if (!recursiveNodes.contains(moved))
+                moved = 0;
+        }
+
+        if (moved) {
+            // moved in the tree, the nodes under it are kept as they are
+            if (filtered) {
+                unwatchRecursive(moved);
+            } else {
+                RecursiveNode &node = recursiveNodes[moved];
+                node.parent = event->wd;
+                node.name = name;
+                recursiveNodes[event->wd].children.append(moved);
+            }
+        } else if (!filtered) {
+            watchRecursive(event->wd, joinPath(recursivePath(event->wd), name), name, filters);
+        }
+    }
+
+    // Moved out of the tree, or the IN_MOVED_TO isn't read yet. They are detached from the parents
+    // already, and unwatched if the IN_MOVED_TO isn't read in time.
+    for (auto it = movedFrom.cbegin(); it != movedFrom.cend(); ++it) {
+        if (pendingRecursiveMoves.size() >= MaxPendingMoves)
+            flushPendingMoves(true);
+        pendingRecursiveMoves.insert(it.key(), qMakePair(it.value(), moveClock.elapsed() + MoveCorrelationTimeout));
+    }
+
+    if (!movedFrom.isEmpty())
+        schedulePendingMoves();
+}
+
+void DFileSystemWatcherPrivate::schedulePendingMoves()
+{
+    Q_Q(DFileSystemWatcher);
+
+    qint64 expireAt = -1;
+    for (const PendingMove &move : std::as_const(pendingMoves))
+        expireAt = expireAt < 0 ? move.expireAt : qMin(expireAt, move.expireAt);
+    for (const auto &move : std::as_const(pendingRecursiveMoves))
+        expireAt = expireAt < 0 ? move.second : qMin(expireAt, move.second);
+
+    if (expireAt < 0)
+        return;
+
+    if (!moveTimer) {
+        moveTimer = new QTimer(q);
+        moveTimer->setSingleShot(true);
+        QObject::connect(moveTimer, &QTimer::timeout, q, [this] {
+            flushPendingMoves(false);
+        });
+    }
+
+    moveTimer->start(int(qMax<qint64>(0, expireAt - moveClock.elapsed())));
+}
+
+// Notifies the moves whose IN_MOVED_TO isn't read in time as moved out, or all of them if all is true.
+void DFileSystemWatcherPrivate::flushPendingMoves(bool all)
 {
     Q_Q(DFileSystemWatcher);
+
+    const qint64 now = moveClock.elapsed();
+    QList<PendingMove> expiredMoves;
+    for (auto it = pendingMoves.begin(); it != pendingMoves.end();) {
+        if (all || it->expireAt <= now) {
+            expiredMoves << it.value();
+            it = pendingMoves.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = pendingRecursiveMoves.begin(); it != pendingRecursiveMoves.end();) {
+        if (all || it->second <= now) {
+            unwatchRecursive(it->first);
+            it = pendingRecursiveMoves.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (!all)
+        schedulePendingMoves();
+
+    // the slots may change the watcher, the signals are emitted at last
+    for (const PendingMove &move : std::as_const(expiredMoves)) {
+        for (const QString &path : move.paths)
+            Q_EMIT q->fileMoved(path, move.name, QString(), QString(), DFileSystemWatcher::QPrivateSignal());
+    }
+}
+
+void DFileSystemWatcherPrivate::_q_readFromInotify()
+{
 //    qDebug() << "QInotifyFileSystemWatcherEngine::readFromInotify";
+    Q_Q(DFileSystemWatcher);
 
-    int buffSize = 0;
-    ioctl(inotifyFd, FIONREAD, (char *) &buffSize);
-    QVarLengthArray<char, 4096> buffer(buffSize);
-    buffSize = read(inotifyFd, buffer.data(), buffSize);
-    char *at = buffer.data();
-    char * const end = at + buffSize;
+    // one chunk per call, the other events of the thread are handled between the chunks of a burst
+    QByteArray chunk;
+    if (eventQueue.pop(&chunk))
+        handleEvents(chunk.data(), chunk.size());
+
+    if (!eventQueue.isEmpty()) {
+        QMetaObject::invokeMethod(q, "_q_readFromInotify", Qt::QueuedConnection);
+        return;
+    }
+
+    deliveryPending.storeRelease(0);
+    // a chunk queued before the reset didn't post a call
+    if (!eventQueue.isEmpty() && deliveryPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(q, "_q_readFromInotify", Qt::QueuedConnection);
+}
+
+// It's called on the thread of the inotify instance.
+bool DFileSystemWatcherPrivate::queueEvents(const QByteArray &chunk)
+{
+    Q_Q(DFileSystemWatcher);
+
+    if (!eventQueue.push(chunk))
+        return false;
+
+    // only one delivery is queued at a time, it posts itself again until the queue is empty
+    if (deliveryPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(q, "_q_readFromInotify", Qt::QueuedConnection);
+
+    return true;
+}
+
+void DFileSystemWatcherPrivate::handleEvents(char *data, qsizetype size)
+{
+    Q_Q(DFileSystemWatcher);
+
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+    int batchEventCount = 0;
+    bool overflowed = false;
+
+    char *at = data;
+    char * const end = at + size;
 
     QList<inotify_event *> eventList;
-    QMultiHash<int, QString> batch_pathmap;
+    // the header and name of the events in eventList, to drop the duplicate events
+    QSet<QByteArray> eventKeys;
+    // the watched paths of the events in eventList
+    QHash<int, QStringList> batch_pathmap;
     /// only save event: IN_MOVE_TO
     QMultiMap<int, QString> cookieToFilePath;
     QMultiMap<int, QString> cookieToFileName;
     QSet<int> hasMoveFromByCookie;
+    bool hasPendingMoves = false;
 #ifdef QT_DEBUG
     int exist_count = 0;
 #endif
@@ -151,6 +790,13 @@ void DFileSystemWatcherPrivate::_q_readFromInotify()
         QStringList paths;
 
         at += sizeof(inotify_event) + event->len;
+        ++batchEventCount;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            watcherQueueOverflows.add();
+            overflowed = true;
+            continue;
+        }
 
         int id = event->wd;
         paths = idToPath.values(id);
@@ -158,34 +804,41 @@ void DFileSystemWatcherPrivate::_q_readFromInotify()
             // perhaps a directory?
             id = -id;
             paths = idToPath.values(id);
-            if (paths.empty())
-                continue;
+            if (paths.empty()) {
+                // or a directory of a recursive watch
+                if (!recursiveNodes.contains(event->wd))
+                    continue;
+                paths << recursivePath(event->wd);
+            }
+        }
+
+        // the events which aren't asked for by addPath() are dropped before the name is decoded
+        const auto filter = watchFilters.constFind(id);
+        if (filter != watchFilters.cend() && !acceptsEvent(*filter, event)) {
+            watcherEventsFiltered.add();
+            continue;
         }
 
         if (!(event->mask & IN_MOVED_TO) || !hasMoveFromByCookie.contains(event->cookie)) {
-            auto it = std::find_if(eventList.begin(), eventList.end(), [event](inotify_event *e){
-                    return event->wd == e->wd && event->mask == e->mask &&
-                           event->cookie == e->cookie &&
-                           event->len == e->len &&
-                           !strcmp(event->name, e->name);
-            });
+            // wd, mask, cookie and len, followed by the name without the padding
+            QByteArray key(reinterpret_cast<const char *>(event), sizeof(inotify_event));
+            if (event->len > 0)
+                key.append(event->name);
 
-            if (it==eventList.end()) {
+            if (!eventKeys.contains(key)) {
+                eventKeys.insert(key);
                 eventList.append(event);
-            }
+            } else {
+                watcherEventsCoalesced.add();
 #ifdef QT_DEBUG
-            else {
                 qDebug() << "exist event:" << "event->wd" << event->wd <<
                             "event->mask" << event->mask <<
                             "event->cookie" << event->cookie << "exist counts " << ++exist_count;
-            }
 #endif
-            const QList<QString> bps = batch_pathmap.values(id);
-            for (auto &path : paths) {
-                if (!bps.contains(path)) {
-                    batch_pathmap.insert(id, path);
-                }
             }
+            // the paths of an id don't change while the events are read
+            if (!batch_pathmap.contains(id))
+                batch_pathmap.insert(id, paths);
         }
 
         if (event->mask & IN_MOVED_TO) {
@@ -209,11 +862,11 @@ void DFileSystemWatcherPrivate::_q_readFromInotify()
 //        qDebug() << "inotify event, wd" << event.wd << "cookie" << event.cookie << "mask" << hex << event.mask;
 
         int id = event.wd;
-        QStringList paths = batch_pathmap.values(id);
+        QStringList paths = batch_pathmap.value(id);
 
         if (paths.empty()) {
             id = -id;
-            paths = batch_pathmap.values(id);
+            paths = batch_pathmap.value(id);
 
             if (paths.empty())
                 continue;
@@ -286,13 +939,10 @@ void DFileSystemWatcherPrivate::_q_readFromInotify()
 //                qDebug() << "IN_CREATE" << filePath << name;
 
                 if (name.isEmpty()) {
-                    if (pathToID.contains(path)) {
-                        q->removePath(path);
-                        q->addPath(path);
-                    }
+                    if (pathToID.contains(path))
+                        rewatchPath(path);
                 } else if (pathToID.contains(filePath)) {
-                    q->removePath(filePath);
-                    q->addPath(filePath);
+                    rewatchPath(filePath);
                 }
 
                 Q_EMIT q->fileCreated(path, name, DFileSystemWatcher::QPrivateSignal());
@@ -308,7 +958,14 @@ void DFileSystemWatcherPrivate::_q_readFromInotify()
                 const QString toName = cookieToFileName.value(event.cookie);
 
                 if (cookieToFilePath.values(event.cookie).empty()) {
-                    Q_EMIT q->fileMoved(path, name, QString(), QString(), DFileSystemWatcher::QPrivateSignal());
+                    // the IN_MOVED_TO may be in the next read, it's notified as moved out if it isn't read in time
+                    if (!pendingMoves.contains(event.cookie) && pendingMoves.size() >= MaxPendingMoves)
+                        flushPendingMoves(true);
+                    PendingMove &move = pendingMoves[event.cookie];
+                    move.paths << path;
+                    move.name = name;
+                    move.expireAt = moveClock.elapsed() + MoveCorrelationTimeout;
+                    hasPendingMoves = true;
                 } else {
                     for (QString &toPath : cookieToFilePath.values(event.cookie)) {
 //                        qDebug() << "IN_MOVED_FROM" << filePath << "to path:" << toPath << "to name:" << toName;
@@ -321,8 +978,16 @@ void DFileSystemWatcherPrivate::_q_readFromInotify()
             if (event.mask & IN_MOVED_TO) {
 //                qDebug() << "IN_MOVED_TO" << filePath;
 
-                if (!hasMoveFromByCookie.contains(event.cookie))
-                    Q_EMIT q->fileMoved(QString(), QString(), path, name, DFileSystemWatcher::QPrivateSignal());
+                if (!hasMoveFromByCookie.contains(event.cookie)) {
+                    const auto move = pendingMoves.constFind(event.cookie);
+                    if (move == pendingMoves.cend()) {
+                        Q_EMIT q->fileMoved(QString(), QString(), path, name, DFileSystemWatcher::QPrivateSignal());
+                    } else {
+                        // the IN_MOVED_FROM is in a previous read
+                        for (const QString &fromPath : move->paths)
+                            Q_EMIT q->fileMoved(fromPath, move->name, path, name, DFileSystemWatcher::QPrivateSignal());
+                    }
+                }
             }
 
             if (event.mask & IN_ATTRIB) {
@@ -344,7 +1009,53 @@ void DFileSystemWatcherPrivate::_q_readFromInotify()
                 Q_EMIT q->fileModified(path, name, DFileSystemWatcher::QPrivateSignal());
             }
         }
+
+        if (event.mask & IN_MOVED_TO)
+            pendingMoves.remove(event.cookie);
     }
+
+    if (hasPendingMoves)
+        schedulePendingMoves();
+
+    if (!recursiveNodes.isEmpty())
+        updateRecursiveWatches(data, size);
+
+    recordBatch(batchEventCount, batchTimer.nsecsElapsed() / 1000);
+    if (overflowed)
+        notifyOverflowed("inotify");
+}
+
+// Watches the path again with its filter, e.g. it's created again.
+void DFileSystemWatcherPrivate::rewatchPath(const QString &path)
+{
+    Q_Q(DFileSystemWatcher);
+
+    const WatchFilter filter = watchFilters.value(pathToID.value(path));
+    q->removePath(path);
+    if (filter.mask)
+        q->addPath(path, filter.types, filter.excludes);
+    else
+        q->addPath(path);
+}
+
+void DFileSystemWatcherPrivate::recordBatch(int eventCount, qint64 usecs)
+{
+    stats.eventCount += quint64(eventCount);
+    ++stats.batchCount;
+    stats.lastBatchTime = usecs;
+    stats.maxBatchTime = qMax(stats.maxBatchTime, usecs);
+    stats.totalBatchTime += usecs;
+
+    qCDebug(logFSW) << "handled a batch of" << eventCount << "events in" << usecs << "us";
+}
+
+void DFileSystemWatcherPrivate::notifyOverflowed(const char *engine)
+{
+    Q_Q(DFileSystemWatcher);
+
+    ++stats.overflowCount;
+    qCWarning(logFSW) << "the" << engine << "event queue overflowed, some changes are lost";
+    Q_EMIT q->overflowed(DFileSystemWatcher::QPrivateSignal());
 }
 
 void DFileSystemWatcherPrivate::onFileChanged(const QString &path, bool removed)
@@ -389,6 +1100,10 @@ void DFileSystemWatcherPrivate::onDirectoryChanged(const QString &path, bool rem
     been added to the DFileSystemWatcher can be accessed using the
     files() function, and directories using the directories() function.
 
+    On Linux, all of the watchers of the process share one inotify instance, which is read
+    on its own thread. The events are handled and the signals are emitted on the thread of
+    the watcher, which needs an event loop.
+
     \note On systems running a Linux kernel without inotify support,
     file systems that contain watched paths cannot be unmounted.
 
@@ -418,16 +1133,9 @@ DFileSystemWatcher::DFileSystemWatcher(QObject *parent)
     : QObject(parent)
     , DObject()
 {
-    int fd = -1;
-#ifdef IN_CLOEXEC
-    fd = inotify_init1(IN_CLOEXEC | O_NONBLOCK);
-#endif
-    if (fd == -1) {
-        fd = inotify_init1(O_NONBLOCK);
-    }
-
-    if (fd != -1) {
-        d_d_ptr.reset(new DFileSystemWatcherPrivate(fd, this));
+    // the inotify instance is shared by all of the watchers of the process
+    if (DInotifyInstance *inotify = DInotifyInstance::acquire()) {
+        d_d_ptr.reset(new DFileSystemWatcherPrivate(inotify, this));
     } else {
         qCritical() << "inotify_init1 failed, and the DFileSystemWatcher is invalid." << strerror(errno);
     }
@@ -478,6 +1186,33 @@ bool DFileSystemWatcher::addPath(const QString &path)
     return paths.isEmpty();
 }
 
+/*!
+    Adds \a path to the file system watcher as addPath() does, only the signals of the event
+    \a types are emitted for it. The events of the files in a directory whose name matches one of
+    the wildcard \a excludes, e.g. "*.o", are skipped.
+
+    The events are filtered as they are read, before the names are decoded to QString, and the
+    inotify watch doesn't ask the kernel for the events out of \a types, unless the file is
+    watched by another watcher for them. A path which is watched already is not added again,
+    remove it first to change the filter.
+
+    \sa eventTypes(), excludePatterns()
+*/
+bool DFileSystemWatcher::addPath(const QString &path, EventTypes types, const QStringList &excludes)
+{
+    Q_D(DFileSystemWatcher);
+
+    if (!d)
+        return false;
+
+    if (path.isEmpty()) {
+        qWarning() << Q_FUNC_INFO << "the path is empty and it is not be watched";
+        return false;
+    }
+
+    return d->addPaths(QStringList(path), &d->files, &d->directories, types, excludes).isEmpty();
+}
+
 /*!
     Adds each path in \a paths to the file system watcher. Paths are
     not added if they not exist, or if they are already being
@@ -584,6 +1319,126 @@ QStringList DFileSystemWatcher::removePaths(const QStringList &paths)
     return p;
 }
 
+/*!
+    Watches the directory \a path and all of the subdirectories of it, the subdirectories which
+    are created or moved in later are watched too. The subdirectories whose name matches one of
+    the wildcard \a filters, e.g. ".git", are skipped with their subdirectories. The symbolic
+    links aren't followed.
+
+    The signals of a subdirectory are emitted with the path of it, as if it's added by addPath().
+    The watched directories of it are not in directories(), use removeRecursive() to remove them.
+
+    Returns true if \a path is watched.
+
+    \note Every directory takes an inotify watch, the tree is limited by
+    /proc/sys/fs/inotify/max_user_watches.
+
+    \sa removeRecursive(), addPath()
+*/
+bool DFileSystemWatcher::addRecursive(const QString &path, const QStringList &filters)
+{
+    Q_D(DFileSystemWatcher);
+
+    if (!d)
+        return false;
+
+    const QFileInfo info(path);
+    if (path.isEmpty() || !info.isDir()) {
+        qWarning() << Q_FUNC_INFO << "the path is not a directory and it is not be watched:" << path;
+        return false;
+    }
+
+    const QString &root = QDir::cleanPath(info.absoluteFilePath());
+    if (d->recursiveRoots.contains(root))
+        return true;
+
+    const int wd = d->watchRecursive(0, root, root, filters);
+    if (wd < 0)
+        return false;
+
+    // the root is in the tree of another recursive watch
+    if (d->recursiveNodes.value(wd).parent)
+        return true;
+
+    d->recursiveRoots.insert(root, wd);
+    if (!filters.isEmpty())
+        d->recursiveFilters.insert(wd, filters);
+
+    return true;
+}
+
+/*!
+    Removes the recursive watch of \a path, which is added by addRecursive().
+
+    Returns true if the watch is removed.
+
+    \sa addRecursive()
+*/
+bool DFileSystemWatcher::removeRecursive(const QString &path)
+{
+    Q_D(DFileSystemWatcher);
+
+    if (!d || path.isEmpty())
+        return false;
+
+    const int wd = d->recursiveRoots.value(QDir::cleanPath(QFileInfo(path).absoluteFilePath()));
+    if (!wd)
+        return false;
+
+    d->unwatchRecursive(wd);
+    return true;
+}
+
+/*!
+    Watches the whole filesystem which the directory \a path is on.
+
+    A fanotify mark of the filesystem is used if it's possible, which needs CAP_SYS_ADMIN and
+    Linux 5.9, so that millions of files are watched without an inotify watch for every directory.
+    The events are emitted with the path of the directory and the name of the file, as the ones
+    of a directory added by addPath(), and the events of the filesystem out of \a path are dropped.
+    A move is emitted by fileMoved() since Linux 5.17, the older kernel doesn't pair the two halves
+    of it, and they are emitted by fileDeleted() and fileCreated(). Otherwise the directory tree of
+    \a path is watched by addRecursive().
+
+    Returns true if \a path is watched.
+
+    \sa removeFilesystem(), addRecursive()
+*/
+bool DFileSystemWatcher::addFilesystem(const QString &path)
+{
+    Q_D(DFileSystemWatcher);
+
+    if (!d)
+        return false;
+
+    const QFileInfo info(path);
+    if (path.isEmpty() || !info.isDir()) {
+        qWarning() << Q_FUNC_INFO << "the path is not a directory and it is not be watched:" << path;
+        return false;
+    }
+
+    const QString &dirPath = QDir::cleanPath(info.absoluteFilePath());
+    return d->addFilesystem(dirPath) || addRecursive(dirPath);
+}
+
+/*!
+    Removes the watch of \a path, which is added by addFilesystem().
+
+    Returns true if the watch is removed.
+
+    \sa addFilesystem()
+*/
+bool DFileSystemWatcher::removeFilesystem(const QString &path)
+{
+    Q_D(DFileSystemWatcher);
+
+    if (!d || path.isEmpty())
+        return false;
+
+    const QString &dirPath = QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+    return d->removeFilesystem(dirPath) || removeRecursive(dirPath);
+}
+
 /*!
     \fn QStringList DFileSystemWatcher::directories() const
 
@@ -620,6 +1475,86 @@ QStringList DFileSystemWatcher::files() const
     return d->files;
 }
 
+/*!
+    Returns the event types which are emitted for \a path, AllEvents if it's added without a
+    filter, or 0 if it isn't watched.
+
+    \sa addPath(), excludePatterns()
+*/
+DFileSystemWatcher::EventTypes DFileSystemWatcher::eventTypes(const QString &path) const
+{
+    Q_D(const DFileSystemWatcher);
+
+    if (!d || !d->pathToID.contains(path))
+        return EventTypes();
+
+    const auto filter = d->watchFilters.constFind(d->pathToID.value(path));
+    return filter == d->watchFilters.cend() ? AllEvents : filter->types;
+}
+
+/*!
+    Returns the wildcard patterns of the names which are skipped in the directory \a path.
+
+    \sa addPath(), eventTypes()
+*/
+QStringList DFileSystemWatcher::excludePatterns(const QString &path) const
+{
+    Q_D(const DFileSystemWatcher);
+
+    if (!d)
+        return QStringList();
+
+    return d->watchFilters.value(d->pathToID.value(path)).excludes;
+}
+
+/*!
+    Returns the statistics of the watcher since it's created or resetStatistics() is called.
+
+    The counters are reported by the logging category "dtk.core.filesystemwatcher" too, a
+    warning is logged if the kernel queue overflowed.
+
+    \sa resetStatistics(), overflowed()
+*/
+DFileSystemWatcher::Statistics DFileSystemWatcher::statistics() const
+{
+    Q_D(const DFileSystemWatcher);
+
+    if (!d)
+        return Statistics();
+
+    Statistics stats = d->stats;
+    stats.watchCount = d->idToPath.uniqueKeys().size() + d->recursiveNodes.size();
+    const qint64 elapsed = d->statsClock.elapsed();
+    stats.eventsPerSecond = elapsed > 0 ? double(stats.eventCount) * 1000 / elapsed : 0;
+
+    return stats;
+}
+
+/*!
+    Resets the counters of statistics().
+
+    \sa statistics()
+*/
+void DFileSystemWatcher::resetStatistics()
+{
+    Q_D(DFileSystemWatcher);
+
+    if (!d)
+        return;
+
+    d->stats = Statistics();
+    d->statsClock.restart();
+}
+
+/*!
+    \fn void DFileSystemWatcher::overflowed()
+
+    This signal is emitted when the kernel event queue overflowed, the changes in the meantime are
+    lost, so that the watched files and directories should be scanned again.
+
+    \sa statistics()
+*/
+
 DCORE_END_NAMESPACE
 
 #include "moc_dfilesystemwatcher.cpp"
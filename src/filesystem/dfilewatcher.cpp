@@ -8,8 +8,16 @@
 #include "dfilesystemwatcher.h"
 
 #include <QDir>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QTimer>
 #include <QDebug>
 
+#include <sys/stat.h>
+#ifdef Q_OS_LINUX
+#include <sys/statfs.h>
+#endif
+
 DCORE_BEGIN_NAMESPACE
 
 static QString joinFilePath(const QString &path, const QString &name)
@@ -20,6 +28,7 @@ static QString joinFilePath(const QString &path, const QString &name)
     return path + QDir::separator() + name;
 }
 
+class DFilePoller;
 class DFileWatcherPrivate : DBaseFileWatcherPrivate
 {
 public:
@@ -36,10 +45,16 @@ public:
     void _q_handleFileModified(const QString &path, const QString &parentPath);
     void _q_handleFileClose(const QString &path, const QString &parentPath);
 
+    bool startPolling();
+    void stopPolling();
+
     static QString formatPath(const QString &path);
+    static bool isRemoteFilesystem(const QString &path);
 
     QString path;
     QStringList watchFileList;
+    DFileWatcher::WatchMode watchMode = DFileWatcher::AutoMode;
+    DFilePoller *poller = nullptr;
 
     static QMap<QString, int> filePathToWatcherCount;
 
@@ -49,6 +64,241 @@ public:
 QMap<QString, int> DFileWatcherPrivate::filePathToWatcherCount;
 Q_GLOBAL_STATIC(DFileSystemWatcher, watcher_file_private)
 
+// The stat of a polled file, the changes are found by comparing two of them.
+struct DPollStat
+{
+    bool exists = false;
+    bool isDir = false;
+    quint64 inode = 0;
+    qint64 size = 0;
+    qint64 mtime = 0;
+    qint64 ctime = 0;
+    uint mode = 0;
+};
+
+static DPollStat pollStat(const QString &path)
+{
+    DPollStat result;
+#ifdef Q_OS_UNIX
+    struct stat buf;
+    if (::lstat(QFile::encodeName(path).constData(), &buf) != 0)
+        return result;
+
+    result.isDir = S_ISDIR(buf.st_mode);
+    result.inode = buf.st_ino;
+    result.size = buf.st_size;
+#ifdef Q_OS_LINUX
+    result.mtime = buf.st_mtim.tv_sec * Q_INT64_C(1000000000) + buf.st_mtim.tv_nsec;
+    result.ctime = buf.st_ctim.tv_sec * Q_INT64_C(1000000000) + buf.st_ctim.tv_nsec;
+#else
+    result.mtime = buf.st_mtime;
+    result.ctime = buf.st_ctime;
+#endif
+    result.mode = buf.st_mode;
+#else
+    const QFileInfo info(path);
+    if (!info.exists())
+        return result;
+
+    result.isDir = info.isDir();
+    result.size = info.size();
+    result.mtime = info.lastModified().toMSecsSinceEpoch();
+    result.ctime = info.metadataChangeTime().toMSecsSinceEpoch();
+    result.mode = info.permissions();
+#endif
+    result.exists = true;
+
+    return result;
+}
+
+// A directory or a file polled by the watchers of it, for the filesystems which don't notify the
+// changes made by the other hosts. The watchers of a path share one snapshot of it.
+class DFilePoller
+{
+public:
+    explicit DFilePoller(const QString &path);
+    ~DFilePoller();
+
+    void poll();
+    void schedule(bool changed);
+    int cost() const { return 1 + entries.size(); }
+
+    QString path;
+    DPollStat stat;
+    // the children by name if the path is a directory
+    QHash<QString, DPollStat> entries;
+    QList<DFileWatcherPrivate *> watchers;
+    QTimer *timer;
+    int interval = 0;
+    bool overflowed = false;
+    bool *destroyed = nullptr;
+};
+
+struct DFilePollerRegistry
+{
+    QHash<QString, DFilePoller *> pollers;
+    int minimumInterval = 1000;
+    int maximumInterval = 30000;
+    int maximumEntries = 20000;
+    // the entries stat by all the pollers in a round
+    int entries = 0;
+};
+Q_GLOBAL_STATIC(DFilePollerRegistry, pollerRegistry)
+
+static QHash<QString, DPollStat> pollEntries(const QString &path)
+{
+    QHash<QString, DPollStat> entries;
+    const QStringList names = QDir(path).entryList(QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    entries.reserve(names.size());
+    for (const QString &name : names) {
+        const DPollStat stat = pollStat(joinFilePath(path, name));
+        // the file is deleted after it's listed
+        if (stat.exists)
+            entries.insert(name, stat);
+    }
+
+    return entries;
+}
+
+DFilePoller::DFilePoller(const QString &path)
+    : path(path)
+    , stat(pollStat(path))
+{
+    if (stat.isDir)
+        entries = pollEntries(path);
+
+    timer = new QTimer;
+    timer->setSingleShot(true);
+    QObject::connect(timer, &QTimer::timeout, [this] {
+        poll();
+    });
+}
+
+DFilePoller::~DFilePoller()
+{
+    // the poller may be destroyed by a slot in the timeout of the timer
+    timer->stop();
+    timer->deleteLater();
+    if (destroyed)
+        *destroyed = true;
+}
+
+void DFilePoller::poll()
+{
+    enum EventType { Deleted, AttributeChanged, Created, Modified, Moved };
+    struct Event
+    {
+        EventType type;
+        QString path;
+        QString parentPath;
+        QString toPath;
+    };
+
+    QVector<Event> events;
+    const DPollStat now = pollStat(path);
+    const QHash<QString, DPollStat> nowEntries = now.isDir ? pollEntries(path) : QHash<QString, DPollStat>();
+
+    // the children of a directory which is gone are deleted before it
+    QHash<quint64, QString> deletedByInode;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        const auto found = nowEntries.constFind(it.key());
+        if (found != nowEntries.constEnd() && found->inode == it->inode && found->isDir == it->isDir)
+            continue;
+        if (it->inode != 0)
+            deletedByInode.insert(it->inode, it.key());
+        else
+            events.append({Deleted, joinFilePath(path, it.key()), path, QString()});
+    }
+
+    for (auto it = nowEntries.constBegin(); it != nowEntries.constEnd(); ++it) {
+        const auto old = entries.constFind(it.key());
+        if (old != entries.constEnd() && old->inode == it->inode && old->isDir == it->isDir) {
+            if (!it->isDir && (old->size != it->size || old->mtime != it->mtime))
+                events.append({Modified, joinFilePath(path, it.key()), path, QString()});
+            else if (old->mode != it->mode || (!it->isDir && old->ctime != it->ctime))
+                events.append({AttributeChanged, joinFilePath(path, it.key()), path, QString()});
+            continue;
+        }
+
+        // a file which keeps its inode under a new name is moved in the directory
+        const QString from = it->inode != 0 ? deletedByInode.take(it->inode) : QString();
+        if (!from.isEmpty())
+            events.append({Moved, joinFilePath(path, from), path, joinFilePath(path, it.key())});
+        else
+            events.append({Created, joinFilePath(path, it.key()), path, QString()});
+    }
+
+    for (const QString &name : qAsConst(deletedByInode))
+        events.append({Deleted, joinFilePath(path, name), path, QString()});
+
+    if (stat.exists && (!now.exists || now.inode != stat.inode || now.isDir != stat.isDir))
+        events.append({Deleted, path, QString(), QString()});
+    if (now.exists && (!stat.exists || now.inode != stat.inode || now.isDir != stat.isDir)) {
+        events.append({Created, path, QString(), QString()});
+    } else if (now.exists) {
+        // the times of a directory change with its children, which are notified already
+        if (!now.isDir && (now.size != stat.size || now.mtime != stat.mtime))
+            events.append({Modified, path, QString(), QString()});
+        else if (now.mode != stat.mode || (!now.isDir && now.ctime != stat.ctime))
+            events.append({AttributeChanged, path, QString(), QString()});
+    }
+
+    const int oldCost = cost();
+    stat = now;
+    entries = nowEntries;
+    pollerRegistry->entries += cost() - oldCost;
+    if (pollerRegistry->entries > pollerRegistry->maximumEntries && !overflowed)
+        qWarning() << Q_FUNC_INFO << "the polled entries are more than" << pollerRegistry->maximumEntries << ", path =" << path;
+    overflowed = pollerRegistry->entries > pollerRegistry->maximumEntries;
+
+    schedule(!events.isEmpty());
+    if (events.isEmpty())
+        return;
+
+    // the slots may stop the watchers or destroy this poller
+    bool isDestroyed = false;
+    destroyed = &isDestroyed;
+    const QList<DFileWatcherPrivate *> targets = watchers;
+    for (DFileWatcherPrivate *watcher : targets) {
+        for (const Event &event : qAsConst(events)) {
+            if (isDestroyed)
+                return;
+            if (!watchers.contains(watcher))
+                break;
+
+            switch (event.type) {
+            case Deleted:
+                watcher->_q_handleFileDeleted(event.path, event.parentPath);
+                break;
+            case AttributeChanged:
+                watcher->_q_handleFileAttributeChanged(event.path, event.parentPath);
+                break;
+            case Created:
+                watcher->_q_handleFileCreated(event.path, event.parentPath);
+                break;
+            case Modified:
+                watcher->_q_handleFileModified(event.path, event.parentPath);
+                break;
+            case Moved:
+                watcher->_q_handleFileMoved(event.path, event.parentPath, event.toPath, event.parentPath);
+                break;
+            }
+        }
+    }
+    destroyed = nullptr;
+}
+
+void DFilePoller::schedule(bool changed)
+{
+    const int minimum = pollerRegistry->minimumInterval;
+    const int maximum = pollerRegistry->maximumInterval;
+
+    // polls often while the path is changing, and backs off exponentially while it's idle
+    interval = changed || interval <= 0 ? minimum : qMin(interval * 2, maximum);
+    interval = qBound(minimum, interval, maximum);
+    timer->start(interval);
+}
+
 QStringList parentPathList(const QString &path)
 {
     QStringList list;
@@ -67,6 +317,10 @@ bool DFileWatcherPrivate::start()
 {
     Q_Q(DFileWatcher);
 
+    if (watchMode == DFileWatcher::PollingMode
+            || (watchMode == DFileWatcher::AutoMode && isRemoteFilesystem(this->path)))
+        return startPolling();
+
     started = true;
 
     Q_FOREACH (const QString &path, parentPathList(this->path)) {
@@ -106,6 +360,11 @@ bool DFileWatcherPrivate::stop()
 {
     Q_Q(DFileWatcher);
 
+    if (poller) {
+        stopPolling();
+        return true;
+    }
+
     q->disconnect(watcher_file_private, 0, q, 0);
 
     bool ok = true;
@@ -127,14 +386,46 @@ bool DFileWatcherPrivate::stop()
     return ok;
 }
 
+bool DFileWatcherPrivate::startPolling()
+{
+    DFilePoller *poller = pollerRegistry->pollers.value(path);
+    if (!poller) {
+        poller = new DFilePoller(path);
+        if (pollerRegistry->entries + poller->cost() > pollerRegistry->maximumEntries) {
+            qWarning() << Q_FUNC_INFO << "start polling failed, too many entries, file path =" << path;
+            delete poller;
+            return false;
+        }
+
+        pollerRegistry->entries += poller->cost();
+        pollerRegistry->pollers.insert(path, poller);
+        poller->schedule(true);
+    }
+
+    poller->watchers.append(this);
+    this->poller = poller;
+
+    return true;
+}
+
+void DFileWatcherPrivate::stopPolling()
+{
+    poller->watchers.removeOne(this);
+    if (poller->watchers.isEmpty()) {
+        pollerRegistry->entries -= poller->cost();
+        pollerRegistry->pollers.remove(path);
+        delete poller;
+    }
+
+    poller = nullptr;
+}
+
 void DFileWatcherPrivate::_q_handleFileDeleted(const QString &path, const QString &parentPath)
 {
     if (path != this->path && parentPath != this->path)
         return;
 
-    Q_Q(DFileWatcher);
-
-    Q_EMIT q->fileDeleted(QUrl::fromLocalFile(path));
+    notify(FileDeleted, QUrl::fromLocalFile(path));
 }
 
 void DFileWatcherPrivate::_q_handleFileAttributeChanged(const QString &path, const QString &parentPath)
@@ -142,23 +433,19 @@ void DFileWatcherPrivate::_q_handleFileAttributeChanged(const QString &path, con
     if (path != this->path && parentPath != this->path)
         return;
 
-    Q_Q(DFileWatcher);
-
-    Q_EMIT q->fileAttributeChanged(QUrl::fromLocalFile(path));
+    notify(FileAttributeChanged, QUrl::fromLocalFile(path));
 }
 
 void DFileWatcherPrivate::_q_handleFileMoved(const QString &from, const QString &fromParent, const QString &to, const QString &toParent)
 {
-    Q_Q(DFileWatcher);
-
     if ((fromParent == this->path && toParent == this->path) || from == this->path) {
-        Q_EMIT q->fileMoved(QUrl::fromLocalFile(from), QUrl::fromLocalFile(to));
+        notifyMoved(QUrl::fromLocalFile(from), QUrl::fromLocalFile(to));
     } else if (fromParent == this->path) {
-        Q_EMIT q->fileDeleted(QUrl::fromLocalFile(from));
+        notify(FileDeleted, QUrl::fromLocalFile(from));
     } else if (watchFileList.contains(from)) {
-        Q_EMIT q->fileDeleted(url);
+        notify(FileDeleted, url);
     } else if (toParent == this->path) {
-        Q_EMIT q->subfileCreated(QUrl::fromLocalFile(to));
+        notify(SubfileCreated, QUrl::fromLocalFile(to));
     }
 }
 
@@ -167,9 +454,7 @@ void DFileWatcherPrivate::_q_handleFileCreated(const QString &path, const QStrin
     if (path != this->path && parentPath != this->path)
         return;
 
-    Q_Q(DFileWatcher);
-
-    Q_EMIT q->subfileCreated(QUrl::fromLocalFile(path));
+    notify(SubfileCreated, QUrl::fromLocalFile(path));
 }
 
 void DFileWatcherPrivate::_q_handleFileModified(const QString &path, const QString &parentPath)
@@ -177,9 +462,7 @@ void DFileWatcherPrivate::_q_handleFileModified(const QString &path, const QStri
     if (path != this->path && parentPath != this->path)
         return;
 
-    Q_Q(DFileWatcher);
-
-    Q_EMIT q->fileModified(QUrl::fromLocalFile(path));
+    notify(FileModified, QUrl::fromLocalFile(path));
 }
 
 void DFileWatcherPrivate::_q_handleFileClose(const QString &path, const QString &parentPath)
@@ -187,9 +470,7 @@ void DFileWatcherPrivate::_q_handleFileClose(const QString &path, const QString
     if (path != this->path && parentPath != this->path)
         return;
 
-    Q_Q(DFileWatcher);
-
-    Q_EMIT q->fileClosed(QUrl::fromLocalFile(path));
+    notify(FileClosed, QUrl::fromLocalFile(path));
 }
 
 QString DFileWatcherPrivate::formatPath(const QString &path)
@@ -202,6 +483,39 @@ QString DFileWatcherPrivate::formatPath(const QString &path)
     return p.isEmpty() ? path : p;
 }
 
+bool DFileWatcherPrivate::isRemoteFilesystem(const QString &path)
+{
+#ifdef Q_OS_LINUX
+    struct statfs buf;
+    QString p = path;
+    // a file which doesn't exist yet is on the filesystem of its parent
+    while (statfs(QFile::encodeName(p).constData(), &buf) != 0) {
+        const QString parent = QFileInfo(p).absolutePath();
+        if (parent == p)
+            return false;
+        p = parent;
+    }
+
+    switch (static_cast<quint32>(buf.f_type)) {
+    case 0x6969:        // NFS
+    case 0x517b:        // SMB
+    case 0xfe534d42:    // SMB2
+    case 0xff534d42:    // CIFS
+    case 0x65735546:    // FUSE
+    case 0x73757245:    // CODA
+    case 0x5346414f:    // AFS
+    case 0x00c36400:    // CEPH
+    case 0x01021997:    // 9P
+        return true;
+    default:
+        return false;
+    }
+#else
+    Q_UNUSED(path)
+    return false;
+#endif
+}
+
 /*!
 @~english
     \class Dtk::Core::DFileWatcher
@@ -216,6 +530,97 @@ DFileWatcher::DFileWatcher(const QString &filePath, QObject *parent)
     d_func()->path = DFileWatcherPrivate::formatPath(filePath);
 }
 
+/*!
+@~english
+  @enum Dtk::Core::DFileWatcher::WatchMode
+  @brief How the changes of the file are found.
+  @var Dtk::Core::DFileWatcher::WatchMode Dtk::Core::DFileWatcher::AutoMode
+  The file is polled if it's on a remote filesystem, e.g. NFS, SMB or FUSE, otherwise it's notified by the system.
+  @var Dtk::Core::DFileWatcher::WatchMode Dtk::Core::DFileWatcher::NotifyMode
+  The changes are notified by the system, the changes made by the other hosts of a remote filesystem are missed.
+  @var Dtk::Core::DFileWatcher::WatchMode Dtk::Core::DFileWatcher::PollingMode
+  The file, and the children of it if it's a directory, are polled.
+ */
+
+/*!
+@~english
+  @brief Returns the watch mode, AutoMode by default.
+  @sa setWatchMode(), isPolling()
+ */
+DFileWatcher::WatchMode DFileWatcher::watchMode() const
+{
+    Q_D(const DFileWatcher);
+
+    return d->watchMode;
+}
+
+/*!
+@~english
+  @brief Sets the watch mode to \a mode, it takes effect when the watcher is started next time.
+  @sa watchMode(), restartWatcher()
+ */
+void DFileWatcher::setWatchMode(WatchMode mode)
+{
+    Q_D(DFileWatcher);
+
+    d->watchMode = mode;
+}
+
+/*!
+@~english
+  @brief Returns true if the watcher is started and polls the file.
+
+  The watchers of a path share one snapshot of it, it's polled at the minimum interval after a change,
+  and the interval is doubled in each round without any change up to the maximum interval. The
+  moves are found by the inodes in a directory, a file which is moved out of it is deleted.
+  @sa setPollingInterval(), setMaximumPolledEntries()
+ */
+bool DFileWatcher::isPolling() const
+{
+    Q_D(const DFileWatcher);
+
+    return d->poller;
+}
+
+/*!
+@~english
+  @brief Sets the polling interval between \a minMsec and \a maxMsec milliseconds, 1000 and 30000 by default.
+  @sa minimumPollingInterval(), maximumPollingInterval()
+ */
+void DFileWatcher::setPollingInterval(int minMsec, int maxMsec)
+{
+    pollerRegistry->minimumInterval = qMax(1, minMsec);
+    pollerRegistry->maximumInterval = qMax(pollerRegistry->minimumInterval, maxMsec);
+}
+
+int DFileWatcher::minimumPollingInterval()
+{
+    return pollerRegistry->minimumInterval;
+}
+
+int DFileWatcher::maximumPollingInterval()
+{
+    return pollerRegistry->maximumInterval;
+}
+
+/*!
+@~english
+  @brief Limits the files which are polled in a round by all the watchers to \a count, 20000 by default.
+
+  A watcher fails to start if its path and the children of it are more than the rest, a polled
+  directory which grows over the limit is still polled, with a warning.
+  @sa maximumPolledEntries()
+ */
+void DFileWatcher::setMaximumPolledEntries(int count)
+{
+    pollerRegistry->maximumEntries = qMax(0, count);
+}
+
+int DFileWatcher::maximumPolledEntries()
+{
+    return pollerRegistry->maximumEntries;
+}
+
 void DFileWatcher::onFileDeleted(const QString &path, const QString &name)
 {
     if (name.isEmpty())
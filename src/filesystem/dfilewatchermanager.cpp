@@ -4,19 +4,39 @@
 
 #include "dfilewatchermanager.h"
 #include "dfilewatcher.h"
+#include "dfilesystemwatcher.h"
 #include "base/private/dobject_p.h"
 
+#include <QDir>
 #include <QMap>
+#include <QSet>
 #include <QUrl>
 
 DCORE_BEGIN_NAMESPACE
 
+static QString joinFilePath(const QString &path, const QString &name)
+{
+    if (name.isEmpty())
+        return path;
+
+    if (path.endsWith(QDir::separator()))
+        return path + name;
+
+    return path + QDir::separator() + name;
+}
+
 class DFileWatcherManagerPrivate : public DObjectPrivate
 {
 public:
     DFileWatcherManagerPrivate(DFileWatcherManager *qq);
 
+    DFileSystemWatcher *ensureSharedWatcher();
+
     QMap<QString, DFileWatcher *> watchersMap;
+    // the paths of addMany() and addPrefix() are watched by one watcher, without a DFileWatcher for every path
+    DFileSystemWatcher *sharedWatcher = nullptr;
+    QSet<QString> sharedFiles;
+    QStringList prefixes;
 
     D_DECLARE_PUBLIC(DFileWatcherManager)
 };
@@ -26,6 +46,39 @@ DFileWatcherManagerPrivate::DFileWatcherManagerPrivate(DFileWatcherManager *qq)
 {
 }
 
+DFileSystemWatcher *DFileWatcherManagerPrivate::ensureSharedWatcher()
+{
+    Q_Q(DFileWatcherManager);
+
+    if (sharedWatcher)
+        return sharedWatcher;
+
+    sharedWatcher = new DFileSystemWatcher(q);
+
+    // the events of a directory are notified with the path of the file in it, as DFileWatcher
+    QObject::connect(sharedWatcher, &DFileSystemWatcher::fileAttributeChanged, q, [q](const QString &path, const QString &name) {
+        Q_EMIT q->fileAttributeChanged(joinFilePath(path, name));
+    });
+    QObject::connect(sharedWatcher, &DFileSystemWatcher::fileClosed, q, [q](const QString &path, const QString &name) {
+        Q_EMIT q->fileClosed(joinFilePath(path, name));
+    });
+    QObject::connect(sharedWatcher, &DFileSystemWatcher::fileDeleted, q, [q](const QString &path, const QString &name) {
+        Q_EMIT q->fileDeleted(joinFilePath(path, name));
+    });
+    QObject::connect(sharedWatcher, &DFileSystemWatcher::fileModified, q, [q](const QString &path, const QString &name) {
+        Q_EMIT q->fileModified(joinFilePath(path, name));
+    });
+    QObject::connect(sharedWatcher, &DFileSystemWatcher::fileMoved, q,
+                     [q](const QString &fromPath, const QString &fromName, const QString &toPath, const QString &toName) {
+        Q_EMIT q->fileMoved(joinFilePath(fromPath, fromName), joinFilePath(toPath, toName));
+    });
+    QObject::connect(sharedWatcher, &DFileSystemWatcher::fileCreated, q, [q](const QString &path, const QString &name) {
+        Q_EMIT q->subfileCreated(joinFilePath(path, name));
+    });
+
+    return sharedWatcher;
+}
+
 /*!
 @~english
     \class Dtk::Core::DFileWatcherManager
@@ -88,6 +141,9 @@ void DFileWatcherManager::remove(const QString &filePath)
     if (watcher) {
         watcher->deleteLater();
     }
+
+    if (d->sharedFiles.remove(filePath))
+        d->sharedWatcher->removePath(filePath);
 }
 
 /*!
@@ -101,6 +157,13 @@ void DFileWatcherManager::removeAll()
         it->deleteLater();
     }
     d->watchersMap.clear();
+
+    if (d->sharedWatcher) {
+        d->sharedWatcher->deleteLater();
+        d->sharedWatcher = nullptr;
+    }
+    d->sharedFiles.clear();
+    d->prefixes.clear();
 }
 
 /*!
@@ -110,7 +173,120 @@ void DFileWatcherManager::removeAll()
 QStringList DFileWatcherManager::watchedFiles() const
 {
     Q_D(const DFileWatcherManager);
-    return d->watchersMap.keys();
+    QStringList files = d->watchersMap.keys();
+    files.reserve(files.size() + d->sharedFiles.size());
+    for (const QString &filePath : d->sharedFiles)
+        files << filePath;
+    return files;
+}
+
+/*!
+@~english
+  @brief Add the files of \a filePaths to the file watcher manager in one pass.
+
+  The files are watched by one shared watcher instead of a DFileWatcher for every file, it's
+  cheaper for thousands of files, e.g. the recent files. The signals of the manager are emitted
+  for them, there is no DFileWatcher of them. If a path is a directory, the signals are emitted
+  for the files in it. The paths which are watched already are skipped.
+
+  @return The paths which can't be watched.
+  @sa removeMany(), add()
+*/
+QStringList DFileWatcherManager::addMany(const QStringList &filePaths)
+{
+    Q_D(DFileWatcherManager);
+
+    QStringList paths;
+    paths.reserve(filePaths.size());
+    for (const QString &filePath : filePaths) {
+        if (!d->watchersMap.contains(filePath) && !d->sharedFiles.contains(filePath))
+            paths << filePath;
+    }
+
+    if (paths.isEmpty())
+        return QStringList();
+
+    const QStringList &failedPaths = d->ensureSharedWatcher()->addPaths(paths);
+    QSet<QString> failed;
+    for (const QString &path : failedPaths)
+        failed.insert(path);
+
+    d->sharedFiles.reserve(d->sharedFiles.size() + paths.size());
+    for (const QString &path : std::as_const(paths)) {
+        if (!failed.contains(path))
+            d->sharedFiles.insert(path);
+    }
+
+    return failedPaths;
+}
+
+/*!
+@~english
+  @brief Remove the files of \a filePaths from the file watcher manager in one pass.
+  @sa addMany(), remove()
+*/
+void DFileWatcherManager::removeMany(const QStringList &filePaths)
+{
+    Q_D(DFileWatcherManager);
+
+    QStringList sharedPaths;
+    for (const QString &filePath : filePaths) {
+        if (DFileWatcher *watcher = d->watchersMap.take(filePath))
+            watcher->deleteLater();
+        if (d->sharedFiles.remove(filePath))
+            sharedPaths << filePath;
+    }
+
+    if (!sharedPaths.isEmpty())
+        d->sharedWatcher->removePaths(sharedPaths);
+}
+
+/*!
+@~english
+  @brief Subscribe the changes of all of the files under the directory \a pathPrefix.
+
+  The directory tree is watched by one shared watcher with DFileSystemWatcher::addRecursive(),
+  the subdirectories created later are watched too. The signals of the manager are emitted with
+  the paths of the changed files.
+
+  @return true if \a pathPrefix is watched.
+  @sa removePrefix(), watchedPrefixes()
+*/
+bool DFileWatcherManager::addPrefix(const QString &pathPrefix)
+{
+    Q_D(DFileWatcherManager);
+
+    if (d->prefixes.contains(pathPrefix))
+        return true;
+
+    if (!d->ensureSharedWatcher()->addRecursive(pathPrefix))
+        return false;
+
+    d->prefixes << pathPrefix;
+    return true;
+}
+
+/*!
+@~english
+  @brief Unsubscribe the changes of the files under \a pathPrefix.
+  @sa addPrefix()
+*/
+void DFileWatcherManager::removePrefix(const QString &pathPrefix)
+{
+    Q_D(DFileWatcherManager);
+
+    if (d->prefixes.removeOne(pathPrefix))
+        d->sharedWatcher->removeRecursive(pathPrefix);
+}
+
+/*!
+@~english
+  @brief The directories which are subscribed by addPrefix().
+*/
+QStringList DFileWatcherManager::watchedPrefixes() const
+{
+    Q_D(const DFileWatcherManager);
+    return d->prefixes;
 }
 
 DCORE_END_NAMESPACE
@@ -77,4 +77,79 @@ DPathBuf::DPathBuf()
 
 }
 
+/*!
+  \class Dtk::Core::DPathBuilder
+  \inmodule dtkcore
+  \brief Dtk::Core::DPathBuilder 累积路径的各个部分, 只在 toString() 时规范化一次.
+
+  与 DPathBuf 的每次拼接都构造新的字符串并规范化不同, DPathBuilder 直接追加到同一个缓冲区中,
+  适合在循环中拼接路径, 使用 QLatin1String 或 QStringView 的部分不会产生临时的 QString。
+  \code
+  const QString &path = DPathBuilder(cacheHome, 128).append(QLatin1String("deepin")).append(appId)
+          .append(QLatin1String("configs")).toString();
+  \endcode
+  \sa Dtk::Core::DPathBuf
+ */
+
+/*!
+  \fn DPathBuilder::DPathBuilder(QStringView root, int reserveSize)
+  \brief Create a builder starts with \a root, and reserves \a reserveSize characters.
+ */
+
+/*!
+  \fn DPathBuilder &DPathBuilder::append(QStringView segment)
+  \brief Appends \a segment, a separator is added if it's needed.
+  \return self object
+ */
+
+/*!
+  \fn DPathBuilder &DPathBuilder::reserve(int size)
+  \brief Reserves \a size characters for the path, so that the appending doesn't allocate.
+  \return self object
+ */
+
+// the path should be cleaned if it has the empty, "." or ".." segments, or a trailing separator
+static bool needsCleaning(const QString &path)
+{
+    const int size = path.size();
+    for (int i = 0; i < size; ++i) {
+        const QChar ch = path.at(i);
+#ifdef Q_OS_WIN
+        if (ch == QLatin1Char('\\'))
+            return true;
+#endif
+        if (ch != QLatin1Char('/') || (i == 0 && size == 1))
+            continue;
+        if (i + 1 == size)
+            return true;
+
+        const QChar next = path.at(i + 1);
+        if (next == QLatin1Char('/'))
+            return true;
+        if (next == QLatin1Char('.')) {
+            if (i + 2 == size || path.at(i + 2) == QLatin1Char('/'))
+                return true;
+            if (path.at(i + 2) == QLatin1Char('.') && (i + 3 == size || path.at(i + 3) == QLatin1Char('/')))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+  \brief Returns the absolute and cleaned path like DPathBuf::toString(), the path is normalized only once.
+  The accumulated path is returned without copying if it's normalized already.
+ */
+QString DPathBuilder::toString() const
+{
+    if (QDir::isRelativePath(m_path))
+        return QDir::toNativeSeparators(QDir::cleanPath(QDir::currentPath() + QLatin1Char('/') + m_path));
+
+    if (!needsCleaning(m_path))
+        return QDir::toNativeSeparators(m_path);
+
+    return QDir::toNativeSeparators(QDir::cleanPath(m_path));
+}
+
 DCORE_END_NAMESPACE
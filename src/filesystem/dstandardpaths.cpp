@@ -5,6 +5,8 @@
 #include "dstandardpaths.h"
 
 #include <QProcessEnvironment>
+#include <QReadWriteLock>
+#include <QHash>
 #include <unistd.h>
 #include <pwd.h>
 
@@ -107,40 +109,43 @@ void DStandardPaths::setMode(DStandardPaths::Mode mode)
 {
     s_mode = mode;
     QStandardPaths::setTestModeEnabled(mode == Test);
+    invalidateCache();
 }
 
 // https://gitlabwh.uniontech.com/wuhan/se/deepin-specifications/-/issues/21
 
-QString DStandardPaths::homePath()
+static QString computeHomePath()
 {
     const QByteArray &home = qgetenv("HOME");
 
     if (!home.isEmpty())
         return QString::fromLocal8Bit(home);
 
-    return homePath(getuid());
+    return DStandardPaths::homePath(getuid());
 }
 
-QString DStandardPaths::path(DStandardPaths::XDG type)
+static QString computePath(DStandardPaths::XDG type)
 {
+    using XDG = DStandardPaths::XDG;
+
     switch (type) {
     case XDG::DataHome: {
         const QByteArray &path = qgetenv("XDG_DATA_HOME");
         if (!path.isEmpty())
             return QString::fromLocal8Bit(path);
-        return homePath() + QStringLiteral("/.local/share");
+        return DStandardPaths::homePath() + QStringLiteral("/.local/share");
     }
     case XDG::CacheHome: {
         const QByteArray &path = qgetenv("XDG_CACHE_HOME");
         if (!path.isEmpty())
             return QString::fromLocal8Bit(path);
-        return homePath() + QStringLiteral("/.cache");
+        return DStandardPaths::homePath() + QStringLiteral("/.cache");
     }
     case XDG::ConfigHome: {
         const QByteArray &path = qgetenv("XDG_CONFIG_HOME");
         if (!path.isEmpty())
             return QString::fromLocal8Bit(path);
-        return homePath() + QStringLiteral("/.config");
+        return DStandardPaths::homePath() + QStringLiteral("/.config");
     }
     case XDG::RuntimeDir: {
         const QByteArray &path = qgetenv("XDG_RUNTIME_DIR");
@@ -153,7 +158,7 @@ QString DStandardPaths::path(DStandardPaths::XDG type)
         if (!path.isEmpty())
             return QString::fromLocal8Bit(path);
 #ifdef Q_OS_LINUX
-        return homePath() + QStringLiteral("/.local/state");
+        return DStandardPaths::homePath() + QStringLiteral("/.local/state");
 #else
         // TODO: handle it on mac
         return QString();
@@ -163,14 +168,10 @@ QString DStandardPaths::path(DStandardPaths::XDG type)
     return QString();
 }
 
-QString DStandardPaths::path(DStandardPaths::DSG type)
+static QStringList computePaths(DStandardPaths::DSG type)
 {
-    const auto list = paths(type);
-    return list.isEmpty() ? nullptr : list.first();
-}
+    using DSG = DStandardPaths::DSG;
 
-QStringList DStandardPaths::paths(DSG type)
-{
     QStringList paths;
 
     if (type == DSG::DataDir) {
@@ -191,6 +192,74 @@ QStringList DStandardPaths::paths(DSG type)
     return paths;
 }
 
+static QString computeHomePath(const uint uid)
+{
+    struct passwd *pw = getpwuid(uid);
+
+    if (!pw)
+        return QString();
+
+    const char *homedir = pw->pw_dir;
+    return QString::fromLocal8Bit(homedir);
+}
+
+// The paths are memoized, so that the environment variables and the password database aren't
+// read at every time, invalidateCache() should be called after the environment is changed.
+struct DStandardPathsCache
+{
+    QReadWriteLock lock;
+    QHash<quint64, QStringList> values;
+};
+Q_GLOBAL_STATIC(DStandardPathsCache, standardPathsCache)
+
+// the kind of the value is in the high 32 bits, the uid or the type is in the low 32 bits
+static constexpr quint64 HomeKey = quint64(1) << 32;
+static constexpr quint64 UserHomeKey = quint64(2) << 32;
+static constexpr quint64 XdgKey = quint64(3) << 32;
+static constexpr quint64 DsgKey = quint64(4) << 32;
+
+template<typename Compute>
+static QStringList cachedValue(quint64 key, Compute compute)
+{
+    {
+        QReadLocker locker(&standardPathsCache->lock);
+        auto it = standardPathsCache->values.constFind(key);
+        if (it != standardPathsCache->values.cend())
+            return it.value();
+    }
+
+    const QStringList &value = compute();
+    QWriteLocker locker(&standardPathsCache->lock);
+    standardPathsCache->values.insert(key, value);
+    return value;
+}
+
+QString DStandardPaths::homePath()
+{
+    return cachedValue(HomeKey, [] { return QStringList(computeHomePath()); }).first();
+}
+
+QString DStandardPaths::homePath(const uint uid)
+{
+    return cachedValue(UserHomeKey | uid, [uid] { return QStringList(computeHomePath(uid)); }).first();
+}
+
+QString DStandardPaths::path(DStandardPaths::XDG type)
+{
+    return cachedValue(XdgKey | quint64(type), [type] { return QStringList(computePath(type)); }).first();
+}
+
+QString DStandardPaths::path(DStandardPaths::DSG type)
+{
+    const auto list = paths(type);
+    return list.isEmpty() ? nullptr : list.first();
+}
+
+QStringList DStandardPaths::paths(DSG type)
+{
+    return cachedValue(DsgKey | quint64(type), [type] { return computePaths(type); });
+}
+
 QString DStandardPaths::filePath(DStandardPaths::XDG type, QString fileName)
 {
     const QString &dir = path(type);
@@ -211,15 +280,13 @@ QString DStandardPaths::filePath(DStandardPaths::DSG type, const QString fileNam
     return dir + QLatin1Char('/') + fileName;
 }
 
-QString DStandardPaths::homePath(const uint uid)
+void DStandardPaths::invalidateCache()
 {
-    struct passwd *pw = getpwuid(uid);
+    if (!standardPathsCache.exists())
+        return;
 
-    if (!pw)
-        return QString();
-
-    const char *homedir = pw->pw_dir;
-    return QString::fromLocal8Bit(homedir);
+    QWriteLocker locker(&standardPathsCache->lock);
+    standardPathsCache->values.clear();
 }
 
 DCORE_END_NAMESPACE
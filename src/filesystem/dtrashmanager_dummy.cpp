@@ -104,6 +104,64 @@ static bool renameFile(const QFileInfo &fileInfo, const QString &target, QString
     return true;
 }
 
+class DTrashJobPrivate : public DObjectPrivate
+{
+public:
+    DTrashJobPrivate(DTrashJob *qq)
+        : DObjectPrivate(qq) {}
+
+    QStringList filePaths;
+
+    D_DECLARE_PUBLIC(DTrashJob)
+};
+
+DTrashJob::DTrashJob(QObject *parent)
+    : QObject(parent)
+    , DObject(*new DTrashJobPrivate(this))
+{
+}
+
+DTrashJob::~DTrashJob()
+{
+}
+
+int DTrashJob::totalCount() const
+{
+    D_DC(DTrashJob);
+    return d->filePaths.size();
+}
+
+int DTrashJob::finishedCount() const
+{
+    return totalCount();
+}
+
+QStringList DTrashJob::failedFiles() const
+{
+    D_DC(DTrashJob);
+    return d->filePaths;
+}
+
+bool DTrashJob::isFinished() const
+{
+    return true;
+}
+
+bool DTrashJob::isCanceled() const
+{
+    return false;
+}
+
+void DTrashJob::cancel()
+{
+}
+
+bool DTrashJob::waitForFinished(int msecs)
+{
+    Q_UNUSED(msecs)
+    return true;
+}
+
 class DTrashManagerPrivate : public DTK_CORE_NAMESPACE::DObjectPrivate
 {
 public:
@@ -123,6 +181,34 @@ bool DTrashManager::trashIsEmpty() const
     return false;
 }
 
+int DTrashManager::trashItemCount() const
+{
+    return 0;
+}
+
+qint64 DTrashManager::trashSize() const
+{
+    return 0;
+}
+
+QList<DTrashItem> DTrashManager::trashItems() const
+{
+    return {};
+}
+
+DTrashItem DTrashManager::trashItem(const QString &id) const
+{
+    Q_UNUSED(id)
+    return DTrashItem();
+}
+
+bool DTrashManager::restoreFromTrash(const QString &id, const QString &targetPath)
+{
+    Q_UNUSED(id)
+    Q_UNUSED(targetPath)
+    return false;
+}
+
 bool DTrashManager::cleanTrash()
 {
     return false;
@@ -133,6 +219,26 @@ bool DTrashManager::moveToTrash(const QString &filePath, bool followSymlink)
     return false;
 }
 
+DTrashJob *DTrashManager::moveToTrashAsync(const QStringList &filePaths, bool followSymlink, int maxThreadCount)
+{
+    Q_UNUSED(followSymlink)
+    Q_UNUSED(maxThreadCount)
+
+    DTrashJob *job = new DTrashJob();
+    static_cast<DTrashJobPrivate *>(job->d_func())->filePaths = filePaths;
+    QMetaObject::invokeMethod(job, "finished", Qt::QueuedConnection);
+    return job;
+}
+
+DTrashJob *DTrashManager::cleanTrashAsync(int maxThreadCount)
+{
+    Q_UNUSED(maxThreadCount)
+
+    DTrashJob *job = new DTrashJob();
+    QMetaObject::invokeMethod(job, "finished", Qt::QueuedConnection);
+    return job;
+}
+
 DTrashManager::DTrashManager()
     : QObject()
     , DObject(*new DTrashManagerPrivate(this))
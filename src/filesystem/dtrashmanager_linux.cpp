@@ -4,14 +4,38 @@
 
 #include "dtrashmanager.h"
 #include "dstandardpaths.h"
+#include "dfilesystemwatcher.h"
 #include "base/private/dobject_p.h"
 
+#include <QCoreApplication>
 #include <QDirIterator>
 #include <QStorageInfo>
 #include <QCryptographicHash>
 #include <QDateTime>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QWaitCondition>
 #include <QDebug>
 
+#include <algorithm>
+#include <cerrno>
+#include <functional>
+#include <memory>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef RENAME_NOREPLACE
+#define RENAME_NOREPLACE (1 << 0)
+#endif
+
 #define TRASH_PATH \
     DStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/Trash"
 #define TRASH_INFO_PATH TRASH_PATH"/info"
@@ -22,23 +46,31 @@ DCORE_BEGIN_NAMESPACE
 class DTrashManager_ : public DTrashManager {};
 Q_GLOBAL_STATIC(DTrashManager_, globalTrashManager)
 
-static QString getNotExistsFileName(const QString &fileName, const QString &targetPath)
+// the name is limited to 200 bytes, and the suffix is kept
+static void splitTrashFileName(const QString &fileName, QByteArray *name, QByteArray *suffix)
 {
-    QByteArray name = fileName.toUtf8();
+    *name = fileName.toUtf8();
 
-    int index = name.lastIndexOf('.');
-    QByteArray suffix;
+    int index = name->lastIndexOf('.');
+    suffix->clear();
 
     if (index >= 0) {
-        suffix = name.mid(index);
+        *suffix = name->mid(index);
     }
 
-    if (suffix.size() > 200) {
-        suffix = suffix.left(200);
+    if (suffix->size() > 200) {
+        *suffix = suffix->left(200);
     }
 
-    name.chop(suffix.size());
-    name = name.left(200 - suffix.size());
+    name->chop(suffix->size());
+    *name = name->left(200 - suffix->size());
+}
+
+static QString getNotExistsFileName(const QString &fileName, const QString &targetPath)
+{
+    QByteArray name;
+    QByteArray suffix;
+    splitTrashFileName(fileName, &name, &suffix);
 
     while (QFile::exists(targetPath + "/" + name + suffix)) {
         name = QCryptographicHash::hash(name, QCryptographicHash::Md5).toHex();
@@ -47,6 +79,17 @@ static QString getNotExistsFileName(const QString &fileName, const QString &targ
     return QString::fromUtf8(name + suffix);
 }
 
+static QByteArray trashInfoData(const QString &sourceFilePath, const QDateTime &datetime)
+{
+    QByteArray data;
+
+    data.append("[Trash Info]\n");
+    data.append("Path=").append(sourceFilePath.toUtf8().toPercentEncoding("/")).append("\n");
+    data.append("DeletionDate=").append(datetime.toString(Qt::ISODate).toLatin1()).append("\n");
+
+    return data;
+}
+
 static bool writeTrashInfo(const QString &fileBaseName, const QString &sourceFilePath, const QDateTime &datetime, QString *errorString = NULL)
 {
     QFile metadata(TRASH_INFO_PATH"/" + fileBaseName + ".trashinfo");
@@ -67,12 +110,7 @@ static bool writeTrashInfo(const QString &fileBaseName, const QString &sourceFil
         return false;
     }
 
-    QByteArray data;
-
-    data.append("[Trash Info]\n");
-    data.append("Path=").append(sourceFilePath.toUtf8().toPercentEncoding("/")).append("\n");
-    data.append("DeletionDate=").append(datetime.toString(Qt::ISODate).toLatin1()).append("\n");
-
+    const QByteArray &data = trashInfoData(sourceFilePath, datetime);
     qint64 size = metadata.write(data);
     metadata.close();
 
@@ -135,18 +173,1025 @@ static bool renameFile(const QFileInfo &fileInfo, const QString &target, QString
     return true;
 }
 
+// it fails with EEXIST instead of replacing the target, if the kernel supports it
+static int renameNoReplace(const QByteArray &source, const QByteArray &target)
+{
+#ifdef SYS_renameat2
+    int ret = ::syscall(SYS_renameat2, AT_FDCWD, source.constData(), AT_FDCWD, target.constData(), RENAME_NOREPLACE);
+    if (ret == 0 || (errno != ENOSYS && errno != EINVAL))
+        return ret;
+#endif
+
+    if (::access(target.constData(), F_OK) == 0) {
+        errno = EEXIST;
+        return -1;
+    }
+
+    return ::rename(source.constData(), target.constData());
+}
+
+// The trash directories of a file, the home trash is used if the topdir is empty.
+struct DTrashLocation
+{
+    QString topdir;
+    QString infoPath;
+    QString filesPath;
+};
+
+// The mount points of the devices, the topdir of a device is the highest directory of the same
+// device, it's validated when it's used, and found by walking up the parents if it's changed.
+struct DTrashTopdirCache
+{
+    QMutex mutex;
+    QHash<dev_t, QString> topdirs;
+};
+Q_GLOBAL_STATIC(DTrashTopdirCache, trashTopdirCache)
+
+static bool isTopdirOf(const QString &path, dev_t device)
+{
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) != 0 || st.st_dev != device)
+        return false;
+    if (path == QLatin1String("/"))
+        return true;
+    return ::stat(QFile::encodeName(QFileInfo(path).path()).constData(), &st) == 0 && st.st_dev != device;
+}
+
+static QString topdirOf(const QString &dirPath, dev_t device)
+{
+    QMutexLocker locker(&trashTopdirCache->mutex);
+    const QString &cached = trashTopdirCache->topdirs.value(device);
+    if (!cached.isEmpty() && isTopdirOf(cached, device))
+        return cached;
+
+    QString topdir = dirPath;
+    struct stat st;
+    while (topdir != QLatin1String("/")) {
+        const QString &parent = QFileInfo(topdir).path();
+        if (::stat(QFile::encodeName(parent).constData(), &st) != 0 || st.st_dev != device)
+            break;
+        topdir = parent;
+    }
+
+    trashTopdirCache->topdirs.insert(device, topdir);
+    return topdir;
+}
+
+static bool makeTrashDirectory(const QByteArray &path)
+{
+    struct stat st;
+    if (::mkdir(path.constData(), 0700) != 0 && errno != EEXIST)
+        return false;
+    return ::lstat(path.constData(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == ::getuid();
+}
+
+// See the trash specification, $topdir/.Trash/$uid is used if $topdir/.Trash is a sticky directory
+// which is created by the administrator, otherwise $topdir/.Trash-$uid is used.
+static bool topdirTrash(const QString &topdir, DTrashLocation *location)
+{
+    const QByteArray &uid = QByteArray::number(::getuid());
+    const QByteArray &top = QFile::encodeName(topdir == QLatin1String("/") ? QString() : topdir);
+
+    QByteArray trash;
+    struct stat st;
+    const QByteArray &adminTrash = top + "/.Trash";
+    if (::lstat(adminTrash.constData(), &st) == 0 && S_ISDIR(st.st_mode) && (st.st_mode & S_ISVTX)
+            && makeTrashDirectory(adminTrash + '/' + uid)) {
+        trash = adminTrash + '/' + uid;
+    } else if (makeTrashDirectory(top + "/.Trash-" + uid)) {
+        trash = top + "/.Trash-" + uid;
+    } else {
+        return false;
+    }
+
+    if (!makeTrashDirectory(trash + "/info") || !makeTrashDirectory(trash + "/files"))
+        return false;
+
+    location->topdir = topdir;
+    location->infoPath = QFile::decodeName(trash + "/info");
+    location->filesPath = QFile::decodeName(trash + "/files");
+    return true;
+}
+
+// an existing trash directory of the user, it isn't created as the trash is only read
+static bool isUserTrash(const QByteArray &trash)
+{
+    struct stat st;
+    return ::lstat(trash.constData(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == ::getuid()
+            && ::lstat((trash + "/info").constData(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// The home trash and the existing topdir trashes of the mounted filesystems and of the topdirs used
+// by this process, the topdirs of the device of the home trash are skipped as the home trash is used.
+static QVector<DTrashLocation> trashLocations()
+{
+    QVector<DTrashLocation> locations{{QString(), TRASH_INFO_PATH, TRASH_FILES_PATH}};
+
+    struct stat st;
+    const bool homeExists = ::stat(QFile::encodeName(DStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)).constData(), &st) == 0;
+    const dev_t homeDevice = homeExists ? st.st_dev : 0;
+
+    QStringList topdirs;
+    for (const QStorageInfo &volume : QStorageInfo::mountedVolumes()) {
+        if (volume.isValid())
+            topdirs << volume.rootPath();
+    }
+    {
+        QMutexLocker locker(&trashTopdirCache->mutex);
+        topdirs += trashTopdirCache->topdirs.values();
+    }
+
+    // a filesystem may be mounted more than once
+    QSet<QPair<dev_t, ino_t>> found;
+    const QByteArray &uid = QByteArray::number(::getuid());
+    for (const QString &topdir : std::as_const(topdirs)) {
+        if (::stat(QFile::encodeName(topdir).constData(), &st) != 0 || (homeExists && st.st_dev == homeDevice))
+            continue;
+
+        const QByteArray &top = QFile::encodeName(topdir == QLatin1String("/") ? QString() : topdir);
+        QByteArrayList trashes;
+        if (::lstat((top + "/.Trash").constData(), &st) == 0 && S_ISDIR(st.st_mode) && (st.st_mode & S_ISVTX))
+            trashes << top + "/.Trash/" + uid;
+        trashes << top + "/.Trash-" + uid;
+
+        for (const QByteArray &trash : std::as_const(trashes)) {
+            if (!isUserTrash(trash) || ::stat(trash.constData(), &st) != 0)
+                continue;
+            if (found.contains(qMakePair(st.st_dev, st.st_ino)))
+                continue;
+
+            found.insert(qMakePair(st.st_dev, st.st_ino));
+            locations.append({topdir, QFile::decodeName(trash + "/info"), QFile::decodeName(trash + "/files")});
+        }
+    }
+
+    return locations;
+}
+
+// the trash in the same device of the file, so that the file is renamed instead of copied
+static DTrashLocation trashLocation(const QFileInfo &fileInfo, const QString &infoPath, const QString &filesPath)
+{
+    DTrashLocation location{QString(), infoPath, filesPath};
+
+    struct stat fileStat;
+    struct stat trashStat;
+    const QString &dirPath = fileInfo.absolutePath();
+    if (::stat(QFile::encodeName(dirPath).constData(), &fileStat) != 0
+            || ::stat(QFile::encodeName(filesPath).constData(), &trashStat) != 0
+            || fileStat.st_dev == trashStat.st_dev) {
+        return location;
+    }
+
+    topdirTrash(topdirOf(dirPath, fileStat.st_dev), &location);
+    return location;
+}
+
+// the path is relative to the topdir in the trash of the topdir
+static QString trashInfoPath(const DTrashLocation &location, const QString &filePath)
+{
+    if (location.topdir.isEmpty())
+        return filePath;
+    return QDir(location.topdir).relativeFilePath(filePath);
+}
+
+// The name is tried at first, then the names derived from the source path, so that the files of
+// the same name don't probe each other. The trash info is created exclusively before the file is
+// moved, it reserves the name as the trash specification requires.
+static bool moveFileToTrash(const QString &filePath, bool followSymlink, const QString &homeInfoPath,
+                            const QString &homeFilesPath, QString *errorString, QString *trashedPath = nullptr)
+{
+    QFileInfo fileInfo(filePath);
+
+    if (!fileInfo.exists() && (followSymlink || !fileInfo.isSymLink())) {
+        *errorString = QString("The %1 file is not exists").arg(filePath);
+        return false;
+    }
+
+    if (followSymlink && fileInfo.isSymLink())
+        fileInfo.setFile(fileInfo.symLinkTarget());
+
+    const DTrashLocation &location = trashLocation(fileInfo, homeInfoPath, homeFilesPath);
+    const QString &infoPath = location.infoPath;
+    const QString &filesPath = location.filesPath;
+
+    // the target isn't copied to the home trash
+    if (followSymlink && location.topdir.isEmpty()
+            && QStorageInfo(fileInfo.filePath()) != QStorageInfo(filesPath)) {
+        *errorString = QString("The target of %1 is not in the storage of the trash").arg(filePath);
+        return false;
+    }
+
+    QByteArray name;
+    QByteArray suffix;
+    splitTrashFileName(fileInfo.fileName(), &name, &suffix);
+
+    const QByteArray &source = QFile::encodeName(fileInfo.absoluteFilePath());
+    const QByteArray &data = trashInfoData(trashInfoPath(location, fileInfo.absoluteFilePath()),
+                                           QDateTime::currentDateTime());
+
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        QByteArray fileName = name;
+        if (attempt > 0) {
+            const QByteArray &key = source + QByteArray::number(attempt);
+            fileName += '.' + QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex().left(8);
+        }
+        fileName += suffix;
+
+        const QByteArray &info = QFile::encodeName(infoPath) + '/' + fileName + ".trashinfo";
+        int fd = ::open(info.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd < 0) {
+            if (errno == EEXIST)
+                continue;
+            *errorString = QString::fromLocal8Bit(strerror(errno));
+            return false;
+        }
+
+        const bool written = ::write(fd, data.constData(), size_t(data.size())) == data.size();
+        ::close(fd);
+        if (!written) {
+            *errorString = QString("Failed to write %1").arg(QFile::decodeName(info));
+            ::unlink(info.constData());
+            return false;
+        }
+
+        const QByteArray &target = QFile::encodeName(filesPath) + '/' + fileName;
+        if (trashedPath)
+            *trashedPath = QFile::decodeName(target);
+        if (renameNoReplace(source, target) == 0)
+            return true;
+
+        const int error = errno;
+        if (error == EEXIST) {
+            ::unlink(info.constData());
+            continue;
+        }
+
+        // the file is copied if it's in another filesystem
+        if (error == EXDEV && renameFile(fileInfo, QFile::decodeName(target), errorString))
+            return true;
+
+        if (error != EXDEV)
+            *errorString = QString::fromLocal8Bit(strerror(error));
+        ::unlink(info.constData());
+        if (trashedPath)
+            trashedPath->clear();
+        return false;
+    }
+
+    *errorString = QString("No available name in the trash for %1").arg(filePath);
+    return false;
+}
+
+class DTrashJobPrivate : public DObjectPrivate
+{
+public:
+    enum Mode {
+        MoveMode,
+        CleanMode
+    };
+
+    DTrashJobPrivate(DTrashJob *qq)
+        : DObjectPrivate(qq) {}
+
+    // A directory being cleaned. It's opened relative to the fd of its parent, which is kept open
+    // until all of the subdirectories are removed, so a renamed or replaced path is never followed.
+    struct Directory
+    {
+        ~Directory();
+
+        std::shared_ptr<Directory> parent;
+        QByteArray name;
+        QByteArray path;
+        // the info directory of a trash, the removed trash infos are reported
+        bool isInfo = false;
+        int fd = -1;
+        // the subdirectories not removed yet, and the scanning of the directory itself
+        QAtomicInt pending = 1;
+    };
+    using DirectoryPtr = std::shared_ptr<Directory>;
+
+    void run();
+    void runMove();
+    void runClean();
+    void cleanDirectory(const DirectoryPtr &directory);
+    void finishDirectory(DirectoryPtr directory);
+    void addRemovedCount(int count);
+    void addFailedFile(const QString &filePath, const QString &errorString);
+    void start(int maxThreadCount, int workCount);
+
+    Mode mode = MoveMode;
+    QStringList filePaths;
+    // it's -1 if the count is unknown
+    int totalCount = 0;
+    bool followSymlink = false;
+    QString infoPath;
+    QString filesPath;
+    int progressStep = 1;
+    // called by the workers with the path of a file moved into a trash
+    std::function<void(const QString &)> movedToTrash;
+    // called by the workers with the info directory and the name of a trash info removed from it
+    std::function<void(const QString &, const QString &)> removedFromTrash;
+
+    // the directories to be cleaned
+    QMutex queueMutex;
+    QWaitCondition queueCondition;
+    QVector<DirectoryPtr> directoryQueue;
+    int busyCount = 0;
+
+    QThreadPool pool;
+    QAtomicInt next;
+    QAtomicInt finishedCount;
+    QAtomicInt runningCount;
+    QAtomicInt canceled;
+
+    mutable QMutex mutex;
+    QStringList failedFiles;
+
+    D_DECLARE_PUBLIC(DTrashJob)
+};
+
+class DTrashJobRunner : public QRunnable
+{
+public:
+    explicit DTrashJobRunner(DTrashJobPrivate *d)
+        : d(d) {}
+
+    void run() override { d->run(); }
+
+private:
+    DTrashJobPrivate *d;
+};
+
+void DTrashJobPrivate::run()
+{
+    D_Q(DTrashJob);
+
+    if (mode == MoveMode)
+        runMove();
+    else
+        runClean();
+
+    if (runningCount.deref())
+        return;
+
+    // the last worker finishes the job
+    Q_EMIT q->finished();
+}
+
+// every worker takes the next file until all files are moved or the job is canceled
+void DTrashJobPrivate::runMove()
+{
+    D_Q(DTrashJob);
+
+    const int total = filePaths.size();
+    for (int i = next.fetchAndAddRelaxed(1); i < total && !canceled.loadAcquire(); i = next.fetchAndAddRelaxed(1)) {
+        QString errorString;
+        QString trashedPath;
+        if (!moveFileToTrash(filePaths.at(i), followSymlink, infoPath, filesPath, &errorString, &trashedPath))
+            addFailedFile(filePaths.at(i), errorString);
+        else if (movedToTrash && !trashedPath.isEmpty())
+            movedToTrash(trashedPath);
+
+        const int count = finishedCount.fetchAndAddOrdered(1) + 1;
+        if (count % progressStep == 0 || count == total)
+            Q_EMIT q->progressChanged(count, total);
+    }
+}
+
+// every worker takes a directory from the queue, the subdirectories are put into the queue,
+// so that a large subtree is shared by all of the workers
+void DTrashJobPrivate::runClean()
+{
+    forever {
+        DirectoryPtr directory;
+        {
+            QMutexLocker locker(&queueMutex);
+            while (directoryQueue.isEmpty() && busyCount > 0 && !canceled.loadAcquire())
+                queueCondition.wait(&queueMutex);
+
+            if (directoryQueue.isEmpty() || canceled.loadAcquire()) {
+                queueCondition.wakeAll();
+                return;
+            }
+
+            directory = directoryQueue.takeLast();
+            ++busyCount;
+        }
+
+        cleanDirectory(directory);
+        directory.reset();
+
+        QMutexLocker locker(&queueMutex);
+        if (--busyCount == 0 && directoryQueue.isEmpty())
+            queueCondition.wakeAll();
+    }
+}
+
+DTrashJobPrivate::Directory::~Directory()
+{
+    if (fd >= 0)
+        ::close(fd);
+}
+
+// the files are unlinked relative to the directory fd, the subdirectories are queued
+void DTrashJobPrivate::cleanDirectory(const DirectoryPtr &directory)
+{
+    constexpr int flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+    directory->fd = directory->parent ? ::openat(directory->parent->fd, directory->name.constData(), flags)
+                                      : ::open(directory->path.constData(), flags);
+    // the fd is kept for the subdirectories, the stream reads a duplicate of it
+    const int streamFd = directory->fd < 0 ? -1 : ::fcntl(directory->fd, F_DUPFD_CLOEXEC, 0);
+    DIR *dir = streamFd < 0 ? nullptr : ::fdopendir(streamFd);
+    if (!dir) {
+        // it isn't empty, so the parent isn't removed either
+        addFailedFile(QFile::decodeName(directory->path), QString::fromLocal8Bit(strerror(errno)));
+        if (streamFd >= 0)
+            ::close(streamFd);
+        return;
+    }
+
+    QVector<DirectoryPtr> subdirectories;
+    int removed = 0;
+    while (dirent *entry = ::readdir(dir)) {
+        if (qstrcmp(entry->d_name, ".") == 0 || qstrcmp(entry->d_name, "..") == 0)
+            continue;
+
+        bool isDirectory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN) {
+            struct stat st;
+            isDirectory = ::fstatat(directory->fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
+        }
+
+        if (isDirectory) {
+            auto subdirectory = std::make_shared<Directory>();
+            subdirectory->parent = directory;
+            subdirectory->name = entry->d_name;
+            subdirectory->path = directory->path + '/' + entry->d_name;
+            subdirectories.append(subdirectory);
+        } else if (::unlinkat(directory->fd, entry->d_name, 0) == 0) {
+            ++removed;
+            if (directory->isInfo && removedFromTrash)
+                removedFromTrash(QFile::decodeName(directory->path), QFile::decodeName(entry->d_name));
+        } else {
+            addFailedFile(QFile::decodeName(directory->path + '/' + entry->d_name), QString::fromLocal8Bit(strerror(errno)));
+        }
+    }
+    ::closedir(dir);
+
+    addRemovedCount(removed);
+    if (!subdirectories.isEmpty()) {
+        directory->pending.fetchAndAddOrdered(subdirectories.size());
+        QMutexLocker locker(&queueMutex);
+        directoryQueue += subdirectories;
+        queueCondition.wakeAll();
+    }
+
+    finishDirectory(directory);
+}
+
+// The directory is removed when it's scanned and all of its subdirectories are removed, then the
+// parent is checked in the same way. The info and files directories have no parent and are kept.
+void DTrashJobPrivate::finishDirectory(DirectoryPtr directory)
+{
+    while (directory && !directory->pending.deref()) {
+        ::close(directory->fd);
+        directory->fd = -1;
+
+        DirectoryPtr parent = directory->parent;
+        if (!parent)
+            return;
+
+        if (::unlinkat(parent->fd, directory->name.constData(), AT_REMOVEDIR) != 0) {
+            addFailedFile(QFile::decodeName(directory->path), QString::fromLocal8Bit(strerror(errno)));
+            return;
+        }
+
+        addRemovedCount(1);
+        directory = parent;
+    }
+}
+
+void DTrashJobPrivate::addRemovedCount(int count)
+{
+    D_Q(DTrashJob);
+
+    if (count == 0)
+        return;
+
+    // it's reported every 1000 entries, the total count is unknown
+    const int total = finishedCount.fetchAndAddOrdered(count) + count;
+    if (total / 1000 != (total - count) / 1000)
+        Q_EMIT q->progressChanged(total, totalCount);
+}
+
+void DTrashJobPrivate::start(int maxThreadCount, int workCount)
+{
+    if (maxThreadCount < 1)
+        maxThreadCount = QThread::idealThreadCount();
+    maxThreadCount = qBound(1, maxThreadCount, qMax(1, workCount));
+
+    pool.setMaxThreadCount(maxThreadCount);
+    runningCount.storeRelease(maxThreadCount);
+    for (int i = 0; i < maxThreadCount; ++i)
+        pool.start(new DTrashJobRunner(this));
+}
+
+void DTrashJobPrivate::addFailedFile(const QString &filePath, const QString &errorString)
+{
+    qWarning() << "DTrashJob: Failed to move" << filePath << "to the trash:" << errorString;
+
+    QMutexLocker locker(&mutex);
+    failedFiles << filePath;
+}
+
+DTrashJob::DTrashJob(QObject *parent)
+    : QObject(parent)
+    , DObject(*new DTrashJobPrivate(this))
+{
+}
+
+DTrashJob::~DTrashJob()
+{
+    D_D(DTrashJob);
+    cancel();
+    d->pool.waitForDone();
+}
+
+int DTrashJob::totalCount() const
+{
+    D_DC(DTrashJob);
+    return d->totalCount;
+}
+
+int DTrashJob::finishedCount() const
+{
+    D_DC(DTrashJob);
+    return d->finishedCount.loadAcquire();
+}
+
+QStringList DTrashJob::failedFiles() const
+{
+    D_DC(DTrashJob);
+    QMutexLocker locker(&d->mutex);
+    return d->failedFiles;
+}
+
+bool DTrashJob::isFinished() const
+{
+    D_DC(DTrashJob);
+    return d->runningCount.loadAcquire() == 0;
+}
+
+bool DTrashJob::isCanceled() const
+{
+    D_DC(DTrashJob);
+    return d->canceled.loadAcquire();
+}
+
+void DTrashJob::cancel()
+{
+    D_D(DTrashJob);
+    d->canceled.storeRelease(1);
+
+    QMutexLocker locker(&d->queueMutex);
+    d->queueCondition.wakeAll();
+}
+
+bool DTrashJob::waitForFinished(int msecs)
+{
+    D_D(DTrashJob);
+    return d->pool.waitForDone(msecs);
+}
+
 class DTrashManagerPrivate : public DTK_CORE_NAMESPACE::DObjectPrivate
 {
 public:
     DTrashManagerPrivate(DTrashManager *q_ptr)
         : DObjectPrivate(q_ptr) {}
+    ~DTrashManagerPrivate() override;
 
     static bool removeFileOrDir(const QString &path);
     static bool removeFromIterator(QDirIterator &iter);
 
+    // the trash info of an item, which is read when the items are queried at first
+    struct Record
+    {
+        // the index in the trashes, the home trash is the first one
+        int trash = 0;
+        QString name;
+        QString originalPath;
+        QDateTime deletionDate;
+        qint64 size = -1;
+    };
+
+    void ensureCache() const;
+    void invalidateCache();
+    bool mountsChanged() const;
+    void deliverWatcherEvents() const;
+    void resolveSizes() const;
+    void resolveInfos() const;
+    bool resolveInfo(Record *record) const;
+    QString idOf(int trash, const QString &name) const;
+    int trashOfInfoPath(const QString &infoPath) const;
+    QString infoFileOf(const QString &id) const;
+    DTrashItem itemOf(const QString &id, const Record &record) const;
+    void addItem(int trash, const QString &name);
+    void addTrashedFile(const QString &filePath);
+    void removeItem(const QString &id);
+    void removeInfo(const QString &infoPath, const QString &infoName);
+    bool startWatcher() const;
+    void stopWatcher() const;
+    void onInfoAdded(const QString &path, const QString &name);
+    void onInfoRemoved(const QString &path, const QString &name);
+
+    // The index of the items of the home trash and of the topdir trashes, it's updated by the changes
+    // of the manager itself and by the changes of the info directories which are reported by inotify.
+    // The trashes are found again when the mounts are changed. The trash info and the size of an item
+    // are read when they're queried at first.
+    mutable QMutex cacheMutex;
+    mutable bool cacheValid = false;
+    mutable QVector<DTrashLocation> trashes;
+    mutable QHash<QString, Record> items;
+    mutable QSet<QString> unknownSizes;
+    mutable QSet<QString> unreadInfos;
+    mutable qint64 knownSize = 0;
+    // it lives in the thread of the manager, it's guarded by the cache lock
+    mutable DFileSystemWatcher *watcher = nullptr;
+    // polled for the changes of the mounts
+    mutable int mountsFd = -1;
+
     D_DECLARE_PUBLIC(DTrashManager)
 };
 
+static constexpr char TrashInfoSuffix[] = ".trashinfo";
+
+DTrashManagerPrivate::~DTrashManagerPrivate()
+{
+    delete watcher;
+    if (mountsFd >= 0)
+        ::close(mountsFd);
+}
+
+// the cache lock is held
+void DTrashManagerPrivate::ensureCache() const
+{
+    if (mountsChanged())
+        cacheValid = false;
+    if (cacheValid)
+        return;
+
+    if (mountsFd < 0)
+        mountsFd = ::open("/proc/self/mounts", O_RDONLY | O_CLOEXEC);
+    trashes = trashLocations();
+
+    // The directories are watched before they're scanned, so that the changes in the meantime are not
+    // lost. They're reported again after the scanning, adding or removing an item twice is a no-op.
+    stopWatcher();
+    const bool watched = startWatcher();
+
+    items.clear();
+    unknownSizes.clear();
+    unreadInfos.clear();
+    knownSize = 0;
+
+    cacheValid = true;
+    for (int i = 0; i < trashes.size(); ++i) {
+        QDirIterator iterator(trashes.at(i).infoPath, {QString("*") + TrashInfoSuffix}, QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden);
+        while (iterator.hasNext()) {
+            iterator.next();
+            const_cast<DTrashManagerPrivate *>(this)->addItem(i, iterator.fileName().chopped(int(qstrlen(TrashInfoSuffix))));
+        }
+    }
+
+    // it's scanned again at the next time if it can't be watched
+    cacheValid = watched;
+}
+
+void DTrashManagerPrivate::invalidateCache()
+{
+    QMutexLocker locker(&cacheMutex);
+    cacheValid = false;
+}
+
+// The mount table is ready to be read again when a filesystem is mounted or unmounted, the poll
+// resets it, see proc(5).
+bool DTrashManagerPrivate::mountsChanged() const
+{
+    if (mountsFd < 0)
+        return false;
+
+    pollfd fd = {mountsFd, POLLPRI, 0};
+    return ::poll(&fd, 1, 0) > 0 && (fd.revents & (POLLERR | POLLPRI));
+}
+
+// The events of the watcher are queued to the thread of the manager. They're delivered before the
+// cache is read in that thread, so the cache is kept up to date even without an event loop.
+void DTrashManagerPrivate::deliverWatcherEvents() const
+{
+    if (QThread::currentThread() != q_func()->thread())
+        return;
+
+    // it's only deleted in this thread
+    DFileSystemWatcher *currentWatcher = nullptr;
+    {
+        QMutexLocker locker(&cacheMutex);
+        currentWatcher = watcher;
+    }
+
+    if (currentWatcher)
+        QCoreApplication::sendPostedEvents(currentWatcher, QEvent::MetaCall);
+}
+
+// reads the sizes of the directories from the directorysizes file of the trash specification
+static QHash<QString, qint64> readDirectorySizes(const DTrashLocation &location)
+{
+    QHash<QString, qint64> sizes;
+    QFile file(QFileInfo(location.infoPath).path() + "/directorysizes");
+    if (!file.open(QIODevice::ReadOnly))
+        return sizes;
+
+    while (!file.atEnd()) {
+        const QList<QByteArray> &fields = file.readLine().trimmed().split(' ');
+        if (fields.size() != 3)
+            continue;
+
+        // the entry is outdated if the mtime of the trash info is changed
+        const QString &name = QString::fromUtf8(QByteArray::fromPercentEncoding(fields.at(2)));
+        const QFileInfo info(location.infoPath + "/" + name + TrashInfoSuffix);
+        if (info.lastModified().toMSecsSinceEpoch() / 1000 == fields.at(1).toLongLong())
+            sizes.insert(name, fields.at(0).toLongLong());
+    }
+
+    return sizes;
+}
+
+static qint64 itemSize(const DTrashLocation &location, const QString &name, QHash<QString, qint64> *directorySizes, bool *directorySizesRead)
+{
+    const QString &filePath = location.filesPath + "/" + name;
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.isDir() || fileInfo.isSymLink())
+        return fileInfo.exists() || fileInfo.isSymLink() ? fileInfo.size() : -1;
+
+    if (!*directorySizesRead) {
+        *directorySizes = readDirectorySizes(location);
+        *directorySizesRead = true;
+    }
+
+    auto it = directorySizes->constFind(name);
+    if (it != directorySizes->cend())
+        return it.value();
+
+    qint64 size = 0;
+    QDirIterator iterator(filePath, QDir::Files | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
+                          QDirIterator::Subdirectories);
+    while (iterator.hasNext()) {
+        iterator.next();
+        size += iterator.fileInfo().size();
+    }
+
+    return size;
+}
+
+// the file may not be moved to the trash yet when its trash info is created, so it's resolved later
+void DTrashManagerPrivate::resolveSizes() const
+{
+    if (unknownSizes.isEmpty())
+        return;
+
+    // the directorysizes file of each trash is read once
+    QVector<QHash<QString, qint64>> directorySizes(trashes.size());
+    QVector<bool> directorySizesRead(trashes.size(), false);
+
+    for (auto it = unknownSizes.begin(); it != unknownSizes.end();) {
+        Record &record = items[*it];
+        const qint64 size = itemSize(trashes.at(record.trash), record.name,
+                                     &directorySizes[record.trash], &directorySizesRead[record.trash]);
+        if (size < 0) {
+            ++it;
+            continue;
+        }
+
+        record.size = size;
+        knownSize += size;
+        it = unknownSizes.erase(it);
+    }
+}
+
+// See the trash specification, the path is percent encoded, the date is in the local time.
+static bool readTrashInfo(const QString &fileName, QString *originalPath, QDateTime *deletionDate)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    bool inGroup = false;
+    while (!file.atEnd()) {
+        const QByteArray &line = file.readLine().trimmed();
+        if (line.startsWith('[')) {
+            inGroup = line == "[Trash Info]";
+        } else if (!inGroup) {
+            continue;
+        } else if (line.startsWith("Path=")) {
+            *originalPath = QString::fromUtf8(QByteArray::fromPercentEncoding(line.mid(5)));
+        } else if (line.startsWith("DeletionDate=")) {
+            *deletionDate = QDateTime::fromString(QString::fromLatin1(line.mid(13)), Qt::ISODate);
+        }
+    }
+
+    // the info is created before it's written
+    return !originalPath->isEmpty();
+}
+
+// the path in the trash info of a topdir trash may be relative to the topdir
+bool DTrashManagerPrivate::resolveInfo(Record *record) const
+{
+    const DTrashLocation &location = trashes.at(record->trash);
+    if (!readTrashInfo(location.infoPath + "/" + record->name + TrashInfoSuffix, &record->originalPath, &record->deletionDate))
+        return false;
+
+    if (!location.topdir.isEmpty() && QDir::isRelativePath(record->originalPath))
+        record->originalPath = QDir::cleanPath(location.topdir + "/" + record->originalPath);
+    return true;
+}
+
+void DTrashManagerPrivate::resolveInfos() const
+{
+    if (unreadInfos.isEmpty())
+        return;
+
+    for (auto it = unreadInfos.begin(); it != unreadInfos.end();) {
+        if (!resolveInfo(&items[*it])) {
+            ++it;
+            continue;
+        }
+        it = unreadInfos.erase(it);
+    }
+}
+
+// the id of an item of the home trash is its name, the path in the trash otherwise
+QString DTrashManagerPrivate::idOf(int trash, const QString &name) const
+{
+    return trash == 0 ? name : trashes.at(trash).filesPath + "/" + name;
+}
+
+int DTrashManagerPrivate::trashOfInfoPath(const QString &infoPath) const
+{
+    for (int i = 0; i < trashes.size(); ++i) {
+        if (trashes.at(i).infoPath == infoPath)
+            return i;
+    }
+
+    return -1;
+}
+
+// the cache lock is held
+QString DTrashManagerPrivate::infoFileOf(const QString &id) const
+{
+    auto it = items.constFind(id);
+    if (it == items.cend())
+        return QString();
+
+    return trashes.at(it->trash).infoPath + "/" + it->name + TrashInfoSuffix;
+}
+
+DTrashItem DTrashManagerPrivate::itemOf(const QString &id, const Record &record) const
+{
+    DTrashItem item;
+    item.id = id;
+    item.filePath = trashes.at(record.trash).filesPath + "/" + record.name;
+    item.originalPath = record.originalPath;
+    item.deletionDate = record.deletionDate;
+    item.size = record.size;
+    return item;
+}
+
+// the cache lock is held
+void DTrashManagerPrivate::addItem(int trash, const QString &name)
+{
+    if (!cacheValid)
+        return;
+
+    const QString &id = idOf(trash, name);
+    if (items.contains(id))
+        return;
+
+    Record record;
+    record.trash = trash;
+    record.name = name;
+    items.insert(id, record);
+    unknownSizes.insert(id);
+    unreadInfos.insert(id);
+}
+
+// the cache lock is held, the file is in the files directory of a trash
+void DTrashManagerPrivate::addTrashedFile(const QString &filePath)
+{
+    if (!cacheValid)
+        return;
+
+    const QFileInfo fileInfo(filePath);
+    const int trash = trashOfInfoPath(QFileInfo(fileInfo.path()).path() + "/info");
+    // the topdir trash is just created, it's found and watched at the next scanning
+    if (trash < 0) {
+        cacheValid = false;
+        return;
+    }
+
+    addItem(trash, fileInfo.fileName());
+}
+
+// the cache lock is held
+void DTrashManagerPrivate::removeItem(const QString &id)
+{
+    auto it = items.find(id);
+    if (it == items.end())
+        return;
+
+    if (it->size > 0)
+        knownSize -= it->size;
+    unknownSizes.remove(id);
+    unreadInfos.remove(id);
+    items.erase(it);
+}
+
+// the cache lock is held
+void DTrashManagerPrivate::removeInfo(const QString &infoPath, const QString &infoName)
+{
+    const int trash = trashOfInfoPath(infoPath);
+    if (trash >= 0 && infoName.endsWith(TrashInfoSuffix))
+        removeItem(idOf(trash, infoName.chopped(int(qstrlen(TrashInfoSuffix)))));
+}
+
+// the cache lock is held, it's called in any thread, the watcher is moved to the thread of the manager
+bool DTrashManagerPrivate::startWatcher() const
+{
+    auto d = const_cast<DTrashManagerPrivate *>(this);
+    const DTrashManager *q = q_func();
+
+    std::unique_ptr<DFileSystemWatcher> newWatcher(new DFileSystemWatcher);
+    for (const DTrashLocation &location : std::as_const(trashes)) {
+        if (!QFileInfo(location.infoPath).isDir() || !newWatcher->addPath(location.infoPath))
+            return false;
+    }
+
+    QObject::connect(newWatcher.get(), &DFileSystemWatcher::fileCreated, q,
+                     [d](const QString &path, const QString &name) { d->onInfoAdded(path, name); });
+    QObject::connect(newWatcher.get(), &DFileSystemWatcher::fileDeleted, q,
+                     [d](const QString &path, const QString &name) { d->onInfoRemoved(path, name); });
+    QObject::connect(newWatcher.get(), &DFileSystemWatcher::fileMoved, q,
+                     [d](const QString &fromPath, const QString &fromName, const QString &toPath, const QString &toName) {
+        d->onInfoRemoved(fromPath, fromName);
+        d->onInfoAdded(toPath, toName);
+    });
+    QObject::connect(newWatcher.get(), &DFileSystemWatcher::overflowed, q, [d] { d->invalidateCache(); });
+
+    newWatcher->moveToThread(q->thread());
+    watcher = newWatcher.release();
+    return true;
+}
+
+// the cache lock is held
+void DTrashManagerPrivate::stopWatcher() const
+{
+    if (!watcher)
+        return;
+
+    if (watcher->thread() == QThread::currentThread())
+        delete watcher;
+    else
+        watcher->deleteLater();
+    watcher = nullptr;
+}
+
+void DTrashManagerPrivate::onInfoAdded(const QString &path, const QString &name)
+{
+    if (name.isEmpty() || !name.endsWith(TrashInfoSuffix))
+        return;
+
+    QMutexLocker locker(&cacheMutex);
+    const int trash = trashOfInfoPath(path);
+    if (trash >= 0)
+        addItem(trash, name.chopped(int(qstrlen(TrashInfoSuffix))));
+}
+
+void DTrashManagerPrivate::onInfoRemoved(const QString &path, const QString &name)
+{
+    QMutexLocker locker(&cacheMutex);
+    if (trashOfInfoPath(path) < 0)
+        return;
+
+    // an info directory itself is removed or unmounted, it's watched again at the next scanning
+    if (name.isEmpty()) {
+        if (watcher)
+            watcher->deleteLater();
+        watcher = nullptr;
+        cacheValid = false;
+        return;
+    }
+
+    removeInfo(path, name);
+}
+
 DTrashManager *DTrashManager::instance()
 {
     return globalTrashManager;
@@ -154,24 +1199,138 @@ DTrashManager *DTrashManager::instance()
 
 bool DTrashManager::trashIsEmpty() const
 {
-    QDirIterator iterator(TRASH_INFO_PATH,
-//                          QStringList() << "*.trashinfo",
-                          QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden);
+    return trashItemCount() == 0;
+}
+
+int DTrashManager::trashItemCount() const
+{
+    D_DC(DTrashManager);
+    d->deliverWatcherEvents();
+    QMutexLocker locker(&d->cacheMutex);
+    d->ensureCache();
+    return d->items.size();
+}
+
+qint64 DTrashManager::trashSize() const
+{
+    D_DC(DTrashManager);
+    d->deliverWatcherEvents();
+    QMutexLocker locker(&d->cacheMutex);
+    d->ensureCache();
+    d->resolveSizes();
+    return d->knownSize;
+}
+
+QList<DTrashItem> DTrashManager::trashItems() const
+{
+    D_DC(DTrashManager);
+    d->deliverWatcherEvents();
+    QMutexLocker locker(&d->cacheMutex);
+    d->ensureCache();
+    d->resolveInfos();
+    d->resolveSizes();
+
+    QList<DTrashItem> result;
+    result.reserve(d->items.size());
+    for (auto it = d->items.cbegin(); it != d->items.cend(); ++it)
+        result << d->itemOf(it.key(), it.value());
+
+    std::sort(result.begin(), result.end(), [](const DTrashItem &left, const DTrashItem &right) {
+        if (left.deletionDate != right.deletionDate)
+            return left.deletionDate < right.deletionDate;
+        return left.id < right.id;
+    });
+    return result;
+}
+
+DTrashItem DTrashManager::trashItem(const QString &id) const
+{
+    D_DC(DTrashManager);
+    d->deliverWatcherEvents();
+    QMutexLocker locker(&d->cacheMutex);
+    d->ensureCache();
+    auto it = d->items.find(id);
+    if (it == d->items.end())
+        return DTrashItem();
 
-    return !iterator.hasNext();
+    if (d->unreadInfos.contains(id) && d->resolveInfo(&*it))
+        d->unreadInfos.remove(id);
+
+    if (d->unknownSizes.contains(id)) {
+        QHash<QString, qint64> directorySizes;
+        bool directorySizesRead = false;
+        const qint64 size = itemSize(d->trashes.at(it->trash), it->name, &directorySizes, &directorySizesRead);
+        if (size >= 0) {
+            it->size = size;
+            d->knownSize += size;
+            d->unknownSizes.remove(id);
+        }
+    }
+
+    return d->itemOf(id, *it);
+}
+
+bool DTrashManager::restoreFromTrash(const QString &id, const QString &targetPath)
+{
+    D_D(DTrashManager);
+    const DTrashItem &item = trashItem(id);
+    const QString &target = targetPath.isEmpty() ? item.originalPath : targetPath;
+    if (!item.isValid() || target.isEmpty())
+        return false;
+
+    const QFileInfo targetInfo(target);
+    if (targetInfo.exists() || targetInfo.isSymLink() || !QDir().mkpath(targetInfo.absolutePath()))
+        return false;
+
+    // the file is copied if the target is in another filesystem
+    if (renameNoReplace(QFile::encodeName(item.filePath), QFile::encodeName(target)) != 0) {
+        const int error = errno;
+        QString errorString = QString::fromLocal8Bit(strerror(error));
+        if (error != EXDEV || !renameFile(QFileInfo(item.filePath), target, &errorString)) {
+            qWarning() << "DTrashManager: Failed to restore" << item.filePath << "to" << target << ":" << errorString;
+            return false;
+        }
+    }
+
+    QMutexLocker locker(&d->cacheMutex);
+    QFile::remove(d->infoFileOf(id));
+    d->removeItem(id);
+    return true;
 }
 
 bool DTrashManager::cleanTrash()
 {
-    QDirIterator iterator_info(TRASH_INFO_PATH,
-                               QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden);
+    D_D(DTrashManager);
+
+    bool ok = true;
+    for (const DTrashLocation &location : trashLocations()) {
+        // the items are removed from the cache with their trash infos
+        bool infosRemoved = true;
+        QDirIterator iterator_info(location.infoPath,
+                                   QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden);
+        while (iterator_info.hasNext()) {
+            if (!DTrashManagerPrivate::removeFileOrDir(iterator_info.next())) {
+                infosRemoved = false;
+                continue;
+            }
+
+            QMutexLocker locker(&d->cacheMutex);
+            d->removeInfo(location.infoPath, iterator_info.fileName());
+        }
 
-    QDirIterator iterator_files(TRASH_FILES_PATH,
-                                QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System,
-                                QDirIterator::Subdirectories);
+        if (!infosRemoved) {
+            ok = false;
+            continue;
+        }
 
-    return DTrashManagerPrivate::removeFromIterator(iterator_info) &&
-           DTrashManagerPrivate::removeFromIterator(iterator_files);
+        QDirIterator iterator_files(location.filesPath,
+                                    QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System,
+                                    QDirIterator::Subdirectories);
+        if (!DTrashManagerPrivate::removeFromIterator(iterator_files))
+            ok = false;
+    }
+
+    return ok;
 }
 
 bool DTrashManager::moveToTrash(const QString &filePath, bool followSymlink)
@@ -183,6 +1342,31 @@ bool DTrashManager::moveToTrash(const QString &filePath, bool followSymlink)
     }
 
     QDir trashDir(TRASH_FILES_PATH);
+    if (!trashDir.mkpath(TRASH_INFO_PATH)) {
+        return false;
+    }
+
+    if (!trashDir.mkpath(TRASH_FILES_PATH)) {
+        return false;
+    }
+
+    D_D(DTrashManager);
+
+    // the file in another device is moved to the trash of its topdir, it isn't copied
+    const QFileInfo targetInfo(followSymlink && fileInfo.isSymLink() ? fileInfo.symLinkTarget() : fileInfo.filePath());
+    if (!trashLocation(targetInfo, TRASH_INFO_PATH, TRASH_FILES_PATH).topdir.isEmpty()) {
+        QString errorString;
+        QString trashedPath;
+        if (moveFileToTrash(filePath, followSymlink, TRASH_INFO_PATH, TRASH_FILES_PATH, &errorString, &trashedPath)) {
+            QMutexLocker locker(&d->cacheMutex);
+            d->addTrashedFile(trashedPath);
+            return true;
+        }
+
+        qWarning() << "DTrashManager: Failed to move" << filePath << "to the trash:" << errorString;
+        return false;
+    }
+
     if (followSymlink && fileInfo.isSymLink()) {
         QStorageInfo storageInfo(fileInfo.filePath());
         QStorageInfo trashStorageInfo(trashDir);
@@ -192,14 +1376,6 @@ bool DTrashManager::moveToTrash(const QString &filePath, bool followSymlink)
         }
     }
 
-    if (!trashDir.mkpath(TRASH_INFO_PATH)) {
-        return false;
-    }
-
-    if (!trashDir.mkpath(TRASH_FILES_PATH)) {
-        return false;
-    }
-
     if (followSymlink && fileInfo.isSymLink()) {
         fileInfo.setFile(fileInfo.symLinkTarget());
     }
@@ -211,8 +1387,79 @@ bool DTrashManager::moveToTrash(const QString &filePath, bool followSymlink)
     }
 
     const QString &newFilePath = TRASH_FILES_PATH"/" + fileName;
+    const bool moved = renameFile(fileInfo, newFilePath);
+
+    // the trash info is added even if the file isn't moved, as the info directory is indexed
+    QMutexLocker locker(&d->cacheMutex);
+    d->addItem(0, fileName);
+    return moved;
+}
+
+DTrashJob *DTrashManager::moveToTrashAsync(const QStringList &filePaths, bool followSymlink, int maxThreadCount)
+{
+    DTrashJob *job = new DTrashJob();
+    DTrashJobPrivate *d = static_cast<DTrashJobPrivate *>(job->d_func());
+
+    d->filePaths = filePaths;
+    d->totalCount = filePaths.size();
+    d->followSymlink = followSymlink;
+    d->infoPath = TRASH_INFO_PATH;
+    d->filesPath = TRASH_FILES_PATH;
+    d->progressStep = qMax(1, filePaths.size() / 100);
+
+    if (!QDir().mkpath(d->infoPath) || !QDir().mkpath(d->filesPath)) {
+        d->failedFiles = filePaths;
+        d->finishedCount.storeRelease(filePaths.size());
+        QMetaObject::invokeMethod(job, "finished", Qt::QueuedConnection);
+        return job;
+    }
+
+    if (filePaths.isEmpty()) {
+        QMetaObject::invokeMethod(job, "finished", Qt::QueuedConnection);
+        return job;
+    }
+
+    DTrashManagerPrivate *manager = d_func();
+    d->movedToTrash = [manager](const QString &filePath) {
+        QMutexLocker locker(&manager->cacheMutex);
+        manager->addTrashedFile(filePath);
+    };
+    d->start(maxThreadCount, filePaths.size());
+    return job;
+}
+
+DTrashJob *DTrashManager::cleanTrashAsync(int maxThreadCount)
+{
+    DTrashJob *job = new DTrashJob();
+    DTrashJobPrivate *d = static_cast<DTrashJobPrivate *>(job->d_func());
+
+    d->mode = DTrashJobPrivate::CleanMode;
+    d->totalCount = -1;
+
+    // the info and files directories of the home trash and the topdir trashes themselves are kept
+    for (const DTrashLocation &location : trashLocations()) {
+        for (const QString &path : {location.infoPath, location.filesPath}) {
+            if (QFileInfo(path).isDir()) {
+                auto directory = std::make_shared<DTrashJobPrivate::Directory>();
+                directory->path = QFile::encodeName(path);
+                directory->isInfo = path == location.infoPath;
+                d->directoryQueue.append(directory);
+            }
+        }
+    }
+
+    if (d->directoryQueue.isEmpty()) {
+        QMetaObject::invokeMethod(job, "finished", Qt::QueuedConnection);
+        return job;
+    }
 
-    return renameFile(fileInfo, newFilePath);
+    DTrashManagerPrivate *manager = d_func();
+    d->removedFromTrash = [manager](const QString &infoPath, const QString &infoName) {
+        QMutexLocker locker(&manager->cacheMutex);
+        manager->removeInfo(infoPath, infoName);
+    };
+    d->start(maxThreadCount, QThread::idealThreadCount());
+    return job;
 }
 
 DTrashManager::DTrashManager()
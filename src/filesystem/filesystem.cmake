@@ -37,6 +37,7 @@ else()
     ${CMAKE_CURRENT_LIST_DIR}/private/dcapfsfileengine_p.h
     ${CMAKE_CURRENT_LIST_DIR}/dbasefilewatcher.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dfilesystemwatcher_linux.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/dfilesystemwatcher_fanotify.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dfilewatcher.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dfilewatchermanager.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dpathbuf.cpp
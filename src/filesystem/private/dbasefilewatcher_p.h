@@ -8,6 +8,12 @@
 #include "base/private/dobject_p.h"
 
 #include <QUrl>
+#include <QHash>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
 
 DCORE_BEGIN_NAMESPACE
 
@@ -20,9 +26,33 @@ public:
     virtual bool start() = 0;
     virtual bool stop() = 0;
 
+    // The notifications of the subclasses, they are emitted at once, or merged in a coalescing
+    // window if coalescingInterval is greater than 0.
+    enum NotificationType {
+        FileDeleted = 0x01,
+        FileAttributeChanged = 0x02,
+        SubfileCreated = 0x04,
+        FileModified = 0x08,
+        FileClosed = 0x10
+    };
+
+    void notify(NotificationType type, const QUrl &url);
+    void notifyMoved(const QUrl &fromUrl, const QUrl &toUrl);
+    void flushNotifications();
+    void emitNotification(NotificationType type, const QUrl &url);
+
     QUrl url;
     bool started = false;
-    static QList<DBaseFileWatcher *> watcherList;
+    // all the watchers in the order of creation, indexed by url and by the url of the parent
+    static QHash<QUrl, QList<DBaseFileWatcher *>> watchersByUrl;
+    static QHash<QUrl, QList<DBaseFileWatcher *>> watchersByParentUrl;
+    static QUrl parentUrl(const QUrl &url);
+
+    int coalescingInterval = 0;
+    QTimer *coalescingTimer = nullptr;
+    // the notifications in the window in order, and the types of them by url
+    QVector<QPair<NotificationType, QUrl>> pendingNotifications;
+    QHash<QUrl, int> pendingTypes;
 
     D_DECLARE_PUBLIC(DBaseFileWatcher)
 };
@@ -6,30 +6,217 @@
 #define DFILESYSTEMWATCHER_P_H
 
 #include "dobject_p.h"
+#include "dfilesystemwatcher.h"
 
 #include <QSocketNotifier>
+#include <QByteArray>
 #include <QHash>
 #include <QMap>
+#include <QAtomicInt>
+#include <QThread>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+#include <utility>
 
 DCORE_BEGIN_NAMESPACE
 
+Q_DECLARE_LOGGING_CATEGORY(logFSW)
+
+// A queue of one producer and one consumer, it doesn't lock, the producer only writes tail and
+// the consumer only writes head.
+template<typename T, int Capacity>
+class DSpscQueue
+{
+public:
+    bool push(const T &value)
+    {
+        const int tail = m_tail.loadAcquire();
+        const int next = (tail + 1) % Capacity;
+        if (next == m_head.loadAcquire())
+            return false;
+
+        m_items[tail] = value;
+        m_tail.storeRelease(next);
+        return true;
+    }
+
+    bool pop(T *value)
+    {
+        const int head = m_head.loadAcquire();
+        if (head == m_tail.loadAcquire())
+            return false;
+
+        *value = std::move(m_items[head]);
+        m_items[head] = T();
+        m_head.storeRelease((head + 1) % Capacity);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return m_head.loadAcquire() == m_tail.loadAcquire();
+    }
+
+private:
+    T m_items[Capacity];
+    QAtomicInt m_head = 0;
+    QAtomicInt m_tail = 0;
+};
+
 class DFileSystemWatcher;
+class DFileSystemWatcherPrivate;
+// The inotify instance of the process, which is shared by all of the DFileSystemWatcher, so that
+// the watchers don't hit the limit of the inotify instances of a user. The events are read on the
+// thread of it, and dispatched to the subscribers of the wd.
+class DInotifyInstance : public QThread
+{
+public:
+    static DInotifyInstance *acquire();
+    static void release(DInotifyInstance *instance);
+
+    int addWatch(const QString &path, quint32 mask, DFileSystemWatcherPrivate *subscriber);
+    void removeWatch(int wd, DFileSystemWatcherPrivate *subscriber);
+    void unsubscribe(DFileSystemWatcherPrivate *subscriber);
+
+protected:
+    void run() override;
+
+private:
+    DInotifyInstance(int inotifyFd, int wakeupFd);
+    ~DInotifyInstance() override;
+
+    void dispatch(const char *data, qsizetype size);
+    void queuePending();
+
+    int inotifyFd;
+    int wakeupFd;
+    int refCount = 0;
+    QMutex mutex;
+    // the subscribers of the wds, a wd is removed if it has no subscriber
+    QHash<int, QVector<DFileSystemWatcherPrivate *>> subscribers;
+
+    // The chunks which aren't queued because the queue of the subscriber is full, they're queued
+    // in order before the later ones. If too many are kept, they're dropped and an overflow is
+    // queued instead, so a slow subscriber doesn't hold the events of the others.
+    struct PendingChunks
+    {
+        QVector<QByteArray> chunks;
+        bool dropped = false;
+    };
+    QHash<DFileSystemWatcherPrivate *, PendingChunks> pending;
+};
+
 class DFileSystemWatcherPrivate : public DObjectPrivate
 {
     Q_DECLARE_PUBLIC(DFileSystemWatcher)
 
 public:
-    DFileSystemWatcherPrivate(int fd, DFileSystemWatcher *qq);
+    DFileSystemWatcherPrivate(DInotifyInstance *inotify, DFileSystemWatcher *qq);
     ~DFileSystemWatcherPrivate();
 
-    QStringList addPaths(const QStringList &paths, QStringList *files, QStringList *directories);
+    QStringList addPaths(const QStringList &paths, QStringList *files, QStringList *directories,
+                         DFileSystemWatcher::EventTypes types = DFileSystemWatcher::AllEvents,
+                         const QStringList &excludes = QStringList());
     QStringList removePaths(const QStringList &paths, QStringList *files, QStringList *directories);
 
+    // A directory of a recursive watch, the path is built from the names of the nodes up to the
+    // root, so a tree of a lot of directories doesn't hold the full path of every one.
+    struct RecursiveNode
+    {
+        int parent = 0; // the wd of the parent, 0 for a root
+        QString name; // the name in the parent, or the path of a root
+        QVector<int> children;
+    };
+
+    int watchRecursive(int parent, const QString &path, const QString &name, const QStringList &filters);
+    void unwatchRecursive(int wd);
+    QString recursivePath(int wd) const;
+    int recursiveRoot(int wd) const;
+    int recursiveChild(int parent, const QString &name) const;
+    void updateRecursiveWatches(const char *data, qsizetype size);
+
+    // the fanotify engine, in dfilesystemwatcher_fanotify.cpp
+    bool addFilesystem(const QString &path);
+    bool removeFilesystem(const QString &path);
+    void closeFanotify();
+    void readFromFanotify();
+    QString fanotifyDirectoryPath(const QByteArray &fsid, const char *handle, int handleSize);
+    bool isUnderFilesystemMark(const QString &path) const;
+
     QStringList files, directories;
-    int inotifyFd;
+    DInotifyInstance *inotify;
     QHash<QString, int> pathToID;
     QMultiHash<int, QString> idToPath;
-    QSocketNotifier notifier;
+
+    // The events and the names which are emitted of a path added by addPath(), the events out of
+    // it are dropped before the names are decoded. The paths of all events aren't in it.
+    struct WatchFilter
+    {
+        DFileSystemWatcher::EventTypes types;
+        quint32 mask = 0; // the inotify events of types
+        QStringList excludes;
+        QVector<QByteArray> encodedExcludes; // the wildcard patterns of the names, in the local 8-bit encoding
+    };
+    // by id, the paths which share an id share the filter
+    QHash<int, WatchFilter> watchFilters;
+    // the recursive watches, by wd
+    QHash<int, RecursiveNode> recursiveNodes;
+    QHash<QString, int> recursiveRoots;
+    // the name filters of the skipped subdirectories, by the wd of a root
+    QHash<int, QStringList> recursiveFilters;
+    int fanotifyFd = -1;
+    // fanotify_init() failed, e.g. the process is unprivileged
+    bool fanotifyUnavailable = false;
+    QSocketNotifier *fanotifyNotifier = nullptr;
+    // the fsid of the marked filesystems, by the paths passed to addFilesystem()
+    QHash<QString, QByteArray> fanotifyMarks;
+    // the resolved paths passed to addFilesystem(), the events out of them are dropped
+    QHash<QString, QString> fanotifyRoots;
+    // the events of the marks, FAN_RENAME is used in place of the move events if it's supported
+    quint64 fanotifyMask = 0;
+    // a directory of the filesystems, which is passed to open_by_handle_at(), by fsid
+    QHash<QByteArray, int> fanotifyMountFds;
+    // the path of the directories, by fsid and file handle
+    QHash<QByteArray, QString> fanotifyDirCache;
+    // the chunks of events dispatched by the inotify instance
+    DSpscQueue<QByteArray, 64> eventQueue;
+    // whether a call of _q_readFromInotify() is queued, it's kept until the queue is empty
+    QAtomicInt deliveryPending = 0;
+
+    // A move whose IN_MOVED_TO isn't read yet, the two events may be split by the reads.
+    struct PendingMove
+    {
+        QStringList paths;
+        QString name;
+        qint64 expireAt = 0;
+    };
+
+    QHash<quint32, PendingMove> pendingMoves;
+    // the moved directories of the recursive watches and the expired time, by cookie
+    QHash<quint32, QPair<int, qint64>> pendingRecursiveMoves;
+    QTimer *moveTimer = nullptr;
+    QElapsedTimer moveClock;
+
+    void schedulePendingMoves();
+    void flushPendingMoves(bool all);
+
+    DFileSystemWatcher::Statistics stats;
+    QElapsedTimer statsClock;
+
+    void recordBatch(int eventCount, qint64 usecs);
+    void notifyOverflowed(const char *engine);
+
+    void rewatchPath(const QString &path);
+
+    bool queueEvents(const QByteArray &chunk);
+    void handleEvents(char *data, qsizetype size);
 
     // private slots
     void _q_readFromInotify();
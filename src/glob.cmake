@@ -2,9 +2,14 @@ set(OUTER_SOURCE
   ${CMAKE_CURRENT_LIST_DIR}/dconfig.cpp
   ${CMAKE_CURRENT_LIST_DIR}/dsgapplication.cpp
   ${CMAKE_CURRENT_LIST_DIR}/dsysinfo.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/dsysinfosampler.cpp
   ${CMAKE_CURRENT_LIST_DIR}/dlicenseinfo.cpp
   ${CMAKE_CURRENT_LIST_DIR}/dsecurestring.cpp
   ${CMAKE_CURRENT_LIST_DIR}/ddesktopentry.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/ddesktopentryindex.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/ddesktopentrywatcher.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/dtracespan_p.h
+  ${CMAKE_CURRENT_LIST_DIR}/dtracespan.cpp
 )
 
 if (DTK5)
@@ -16,9 +21,12 @@ set(OUTER_HEADER
   ${CMAKE_CURRENT_LIST_DIR}/../include/global/dconfig.h
   ${CMAKE_CURRENT_LIST_DIR}/../include/global/dsgapplication.h
   ${CMAKE_CURRENT_LIST_DIR}/../include/global/dsysinfo.h
+  ${CMAKE_CURRENT_LIST_DIR}/../include/global/dsysinfosampler.h
   ${CMAKE_CURRENT_LIST_DIR}/../include/global/dlicenseinfo.h
   ${CMAKE_CURRENT_LIST_DIR}/../include/global/dsecurestring.h
   ${CMAKE_CURRENT_LIST_DIR}/../include/global/ddesktopentry.h
+  ${CMAKE_CURRENT_LIST_DIR}/../include/global/ddesktopentryindex.h
+  ${CMAKE_CURRENT_LIST_DIR}/../include/global/ddesktopentrywatcher.h
 )
 
 if(LINUX)
@@ -6,9 +6,21 @@
 #include "LogManager.h"
 #include <DSGApplication>
 #include <Logger.h>
+#include <AbstractAppender.h>
 #include <ConsoleAppender.h>
 #include <RollingFileAppender.h>
-#include <JournalAppender.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #ifdef Q_OS_LINUX
 #include <sys/stat.h>
@@ -16,10 +28,19 @@
 #endif
 
 #include "dstandardpaths.h"
+#include "dperfcounters.h"
 #include "dconfig_org_deepin_dtk_preference.hpp"
+#include "dbinarylog_p.h"
+#if (defined BUILD_WITH_SYSTEMD && defined Q_OS_LINUX)
+#include "djournalappender_p.h"
+#endif
 
 DCORE_BEGIN_NAMESPACE
 
+// the records dropped by the full queue of the async logging, and the ones merged by the rate limit
+static DPerfCounter logDroppedRecords("log.dropped_records");
+static DPerfCounter logSuppressedRecords("log.suppressed_records");
+
 #define RULES_KEY ("rules")
 // Courtesy qstandardpaths_unix.cpp
 static void appendOrganizationAndApp(QString &path)
@@ -38,6 +59,477 @@ static void appendOrganizationAndApp(QString &path)
 
 #define DEFAULT_FMT "%{time}{yyyy-MM-dd, HH:mm:ss.zzz} [%{type:-7}] [%{file:-20} %{function:-35} %{line}] %{message}"
 
+/*
+ * The appender of the async logging, the records are queued by the logging threads and
+ * written to the real appenders in batches by a background thread.
+ *
+ * The queue is a bounded ring buffer, every slot has a sequence number, a producer claims
+ * a slot by a CAS on the tail. The producers are still serialized by the mutex of
+ * AbstractAppender::write(), but it's only held for copying the record into the queue, the
+ * appenders are written without it.
+ *
+ * A producer which waits for the writer holds that mutex, and a record logged by an appender in
+ * the writer thread needs it, so the producer gives up if the writer makes no progress in
+ * StallTimeout, see waitForWriter().
+ */
+class Q_DECL_HIDDEN AsyncAppender : public AbstractAppender
+{
+public:
+    AsyncAppender(int capacity, DLogManager::OverflowPolicy policy)
+        : m_slots(roundUpCapacity(capacity))
+        , m_mask(m_slots.size() - 1)
+        , m_policy(policy)
+    {
+        for (size_t i = 0; i < m_slots.size(); ++i)
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        m_thread = std::thread(&AsyncAppender::run, this);
+    }
+
+    ~AsyncAppender() override
+    {
+        {
+            std::lock_guard<std::mutex> locker(m_wakeMutex);
+            m_stopping = true;
+        }
+        m_wakeCondition.notify_all();
+        m_thread.join();
+    }
+
+    void addAppender(AbstractAppender *appender)
+    {
+        std::lock_guard<std::mutex> locker(m_appendersMutex);
+        m_appenders.push_back(appender);
+    }
+
+    void removeAppender(AbstractAppender *appender)
+    {
+        flush();
+        std::lock_guard<std::mutex> locker(m_appendersMutex);
+        m_appenders.erase(std::remove(m_appenders.begin(), m_appenders.end(), appender), m_appenders.end());
+    }
+
+    std::vector<AbstractAppender *> takeAppenders()
+    {
+        flush();
+        std::lock_guard<std::mutex> locker(m_appendersMutex);
+        return std::move(m_appenders);
+    }
+
+    // waits until the records queued before are written
+    void flush()
+    {
+        if (std::this_thread::get_id() == m_thread.get_id())
+            return;
+
+        std::unique_lock<std::mutex> locker(m_wakeMutex);
+        const size_t target = m_tail.load(std::memory_order_acquire);
+        m_sleeping.store(false);
+        m_wakeCondition.notify_all();
+        m_flushCondition.wait(locker, [this, target] {
+            return m_stopping || m_head.load(std::memory_order_acquire) >= target;
+        });
+    }
+
+    // as flush(), but it's called in append(), see waitForWriter()
+    bool flushInAppend()
+    {
+        const size_t target = m_tail.load(std::memory_order_acquire);
+        return waitForWriter([this, target] {
+            return m_stopping || m_head.load(std::memory_order_acquire) >= target;
+        });
+    }
+
+protected:
+    void append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                const char *func, const QString &category, const QString &msg) override
+    {
+        // logged by an appender in the writer thread, which holds the lock of the appenders.
+        if (Q_UNLIKELY(std::this_thread::get_id() == m_thread.get_id())) {
+            for (AbstractAppender *appender : m_appenders)
+                appender->write(time, level, file, line, func, category, msg);
+            return;
+        }
+
+        // the process is going to abort, write it and everything before it at once.
+        if (Q_UNLIKELY(level >= Logger::Fatal)) {
+            if (flushInAppend())
+                writeRecord({time, level, file, line, func, category, msg});
+            else // the writer is blocked by this thread and holds the lock of the appenders
+                std::fprintf(stderr, "%s\n", qUtf8Printable(msg));
+            return;
+        }
+
+        while (!tryPush(time, level, file, line, func, category, msg)) {
+            // the backpressure, wait for the writer to make room
+            if (m_policy == DLogManager::DropWhenFull || !waitForWriter([this] { return m_stopping || !isFull(); })) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                logDroppedRecords.add();
+                return;
+            }
+        }
+        wake();
+    }
+
+private:
+    struct Record
+    {
+        QDateTime time;
+        Logger::LogLevel level = Logger::Debug;
+        const char *file = nullptr;
+        int line = 0;
+        const char *function = nullptr;
+        QString category;
+        QString message;
+    };
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence{0};
+        Record record;
+    };
+
+    // the writer is blocked by this thread if it makes no progress in the time
+    static constexpr std::chrono::milliseconds StallTimeout{1000};
+
+    // Waits until done() returns true, it returns false if the writer doesn't write a record in
+    // StallTimeout, e.g. an appender in the writer thread logs a record, which waits for the mutex
+    // of AbstractAppender::write() held by this thread, then this thread gives up and releases it.
+    template<typename Done>
+    bool waitForWriter(Done done)
+    {
+        std::unique_lock<std::mutex> locker(m_wakeMutex);
+        size_t head = m_head.load(std::memory_order_acquire);
+        auto progressTime = std::chrono::steady_clock::now();
+        while (!done()) {
+            m_sleeping.store(false);
+            m_wakeCondition.notify_all();
+            if (m_flushCondition.wait_for(locker, std::chrono::milliseconds(10), done))
+                return true;
+
+            const size_t current = m_head.load(std::memory_order_acquire);
+            const auto now = std::chrono::steady_clock::now();
+            if (current != head) {
+                head = current;
+                progressTime = now;
+            } else if (now - progressTime >= StallTimeout) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool isFull() const
+    {
+        const size_t position = m_tail.load(std::memory_order_acquire);
+        const size_t sequence = m_slots[position & m_mask].sequence.load(std::memory_order_acquire);
+        return static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position) < 0;
+    }
+
+    static size_t roundUpCapacity(int capacity)
+    {
+        size_t size = 2;
+        while (size < static_cast<size_t>(qMax(capacity, 2)))
+            size <<= 1;
+        return size;
+    }
+
+    bool tryPush(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                 const char *func, const QString &category, const QString &msg)
+    {
+        size_t position = m_tail.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &m_slots[position & m_mask];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (diff == 0) {
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->record = {time, level, file, line, func, category, msg};
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(Record &record)
+    {
+        const size_t position = m_head.load(std::memory_order_relaxed);
+        Slot &slot = m_slots[position & m_mask];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+            return false;
+
+        record = std::move(slot.record);
+        slot.sequence.store(position + m_slots.size(), std::memory_order_release);
+        m_head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    void wake()
+    {
+        // only the first record after the writer sleeps takes the lock
+        if (m_sleeping.exchange(false)) {
+            { std::lock_guard<std::mutex> locker(m_wakeMutex); }
+            m_wakeCondition.notify_one();
+        }
+    }
+
+    void writeRecord(const Record &record)
+    {
+        std::lock_guard<std::mutex> locker(m_appendersMutex);
+        for (AbstractAppender *appender : m_appenders)
+            appender->write(record.time, record.level, record.file, record.line, record.function,
+                            record.category, record.message);
+    }
+
+    void run()
+    {
+        Record record;
+        while (true) {
+            int count = 0;
+            {
+                std::lock_guard<std::mutex> locker(m_appendersMutex);
+                while (tryPop(record)) {
+                    for (AbstractAppender *appender : m_appenders)
+                        appender->write(record.time, record.level, record.file, record.line, record.function,
+                                        record.category, record.message);
+                    ++count;
+                }
+            }
+
+            const int dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+            if (Q_UNLIKELY(dropped > 0)) {
+                writeRecord({QDateTime::currentDateTime(), Logger::Warning, __FILE__, __LINE__, Q_FUNC_INFO, QString(),
+                             QStringLiteral("%1 log records are dropped, the async logging queue is full").arg(dropped)});
+            }
+
+            std::unique_lock<std::mutex> locker(m_wakeMutex);
+            m_flushCondition.notify_all();
+            if (count > 0)
+                continue;
+            if (m_stopping)
+                break;
+
+            m_sleeping.store(true);
+            // a record pushed between the drain and here isn't missed, see wake()
+            m_wakeCondition.wait(locker, [this] {
+                return m_stopping || !m_sleeping.load() || hasRecord();
+            });
+            m_sleeping.store(false);
+        }
+    }
+
+    bool hasRecord() const
+    {
+        const size_t position = m_head.load(std::memory_order_relaxed);
+        return m_slots[position & m_mask].sequence.load(std::memory_order_acquire) == position + 1;
+    }
+
+    std::vector<Slot> m_slots;
+    const size_t m_mask;
+    const DLogManager::OverflowPolicy m_policy;
+    std::atomic<size_t> m_tail{0};
+    std::atomic<size_t> m_head{0};
+    std::atomic<int> m_dropped{0};
+
+    std::mutex m_appendersMutex;
+    std::vector<AbstractAppender *> m_appenders;
+
+    std::atomic<bool> m_sleeping{false};
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_flushCondition;
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+
+/*
+ * The appender of the rate limiting, it's put in front of the other appenders.
+ *
+ * The records are grouped by (category, file, line), a group passes `burst` records in
+ * every window of `interval` ms and the rest are counted only. The last dropped record is
+ * written with the count when the window ends, which is checked by the next record of any
+ * group or by flush(), so a silent group's count isn't lost.
+ */
+class Q_DECL_HIDDEN RateLimitAppender : public AbstractAppender
+{
+public:
+    struct Limit
+    {
+        int burst = 0;
+        int interval = 1000;
+    };
+
+    RateLimitAppender()
+    {
+        m_clock.start();
+    }
+
+    ~RateLimitAppender() override
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        expire(std::numeric_limits<qint64>::max());
+    }
+
+    void setLimit(const QString &category, Limit limit)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        if (category.isEmpty())
+            m_defaultLimit = limit;
+        else if (limit.burst > 0)
+            m_limits.insert(category, limit);
+        else
+            m_limits.remove(category);
+        expire(std::numeric_limits<qint64>::max());
+    }
+
+    bool isLimited()
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        return m_defaultLimit.burst > 0 || !m_limits.isEmpty();
+    }
+
+    void addAppender(AbstractAppender *appender)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_appenders.push_back(appender);
+    }
+
+    void removeAppender(AbstractAppender *appender)
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        m_appenders.erase(std::remove(m_appenders.begin(), m_appenders.end(), appender), m_appenders.end());
+    }
+
+    std::vector<AbstractAppender *> takeAppenders()
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        expire(std::numeric_limits<qint64>::max());
+        return std::move(m_appenders);
+    }
+
+    // writes the counts of the windows which have ended
+    void flush()
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        expire(m_clock.elapsed());
+    }
+
+protected:
+    void append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                const char *func, const QString &category, const QString &msg) override
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        const qint64 now = m_clock.elapsed();
+        if (now >= m_nextExpire)
+            expire(now);
+
+        const Limit limit = m_limits.value(category, m_defaultLimit);
+        if (limit.burst <= 0 || level >= Logger::Fatal) {
+            write(time, level, file, line, func, category, msg);
+            return;
+        }
+
+        Group &group = m_groups[Key{category, file, line}];
+        if (group.count == 0) {
+            group.start = now;
+            group.burst = limit.burst;
+            group.interval = limit.interval;
+            m_nextExpire = qMin(m_nextExpire, now + limit.interval);
+        }
+        if (++group.count <= group.burst) {
+            write(time, level, file, line, func, category, msg);
+            return;
+        }
+
+        group.last = {time, level, file, line, func, category, msg};
+    }
+
+private:
+    struct Key
+    {
+        QString category;
+        const char *file;
+        int line;
+
+        bool operator==(const Key &other) const
+        {
+            return file == other.file && line == other.line && category == other.category;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            return size_t(qHash(key.category)) ^ std::hash<const void *>()(key.file) ^ (size_t(key.line) << 16);
+        }
+    };
+
+    struct Record
+    {
+        QDateTime time;
+        Logger::LogLevel level = Logger::Debug;
+        const char *file = nullptr;
+        int line = 0;
+        const char *function = nullptr;
+        QString category;
+        QString message;
+    };
+
+    struct Group
+    {
+        qint64 start = 0;
+        int burst = 0;
+        int interval = 0;
+        int count = 0;
+        Record last;
+    };
+
+    void write(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+               const char *func, const QString &category, const QString &msg)
+    {
+        for (AbstractAppender *appender : m_appenders)
+            appender->write(time, level, file, line, func, category, msg);
+    }
+
+    // ends the windows before now and writes the dropped records
+    void expire(qint64 now)
+    {
+        m_nextExpire = std::numeric_limits<qint64>::max();
+        for (auto it = m_groups.begin(); it != m_groups.end();) {
+            Group &group = it->second;
+            if (now - group.start < group.interval) {
+                m_nextExpire = qMin(m_nextExpire, group.start + group.interval);
+                ++it;
+                continue;
+            }
+
+            const int dropped = group.count - group.burst;
+            if (dropped > 0) {
+                logSuppressedRecords.add(dropped);
+                const Record &last = group.last;
+                write(last.time, last.level, last.file, last.line, last.function, last.category,
+                      QStringLiteral("%1 (repeated %2 more times in %3 ms)").arg(last.message).arg(dropped).arg(group.interval));
+            }
+            it = m_groups.erase(it);
+        }
+    }
+
+    std::mutex m_mutex;
+    std::vector<AbstractAppender *> m_appenders;
+    QElapsedTimer m_clock;
+    Limit m_defaultLimit;
+    QHash<QString, Limit> m_limits;
+    std::unordered_map<Key, Group, KeyHash> m_groups;
+    qint64 m_nextExpire = std::numeric_limits<qint64>::max();
+};
+
 class DLogManagerPrivate {
 public:
     explicit DLogManagerPrivate(DLogManager *q)
@@ -51,14 +543,25 @@ public:
     void updateLoggingRules();
 
     bool shouldSkipConsoleAppender() const;
+    void registerAppender(AbstractAppender *appender);
+    void unregisterAppender(AbstractAppender *appender);
+    void setAsyncLogging(bool enabled, int queueSize, DLogManager::OverflowPolicy policy);
+    void setLogRateLimit(int burst, int interval, const QString &category);
+    std::vector<AbstractAppender *> topAppenders() const;
+    void registerStage(AbstractAppender *stage);
+    void unregisterStage(AbstractAppender *stage);
 
     QString m_format;
     QString m_logPath;
     ConsoleAppender* m_consoleAppender = nullptr;
     RollingFileAppender* m_rollingFileAppender = nullptr;
-    JournalAppender* m_journalAppender = nullptr;
+    DBinaryFileAppender* m_binaryFileAppender = nullptr;
+    bool m_binaryFormat = false;
+    AbstractAppender* m_journalAppender = nullptr;
     QScopedPointer<dconfig_org_deepin_dtk_preference> m_dsgConfig;
     QScopedPointer<dconfig_org_deepin_dtk_preference> m_fallbackConfig;
+    std::unique_ptr<AsyncAppender> m_asyncAppender;
+    std::unique_ptr<RateLimitAppender> m_rateLimitAppender;
 
     DLogManager *q_ptr = nullptr;
     Q_DECLARE_PUBLIC(DLogManager)
@@ -155,6 +658,81 @@ bool DLogManagerPrivate::shouldSkipConsoleAppender() const
     return ok1 && ok2 && st.st_dev == dev && st.st_ino == ino;
 }
 
+// the records go through the rate limiting, the async queue and then the appenders
+void DLogManagerPrivate::registerAppender(AbstractAppender *appender)
+{
+    if (m_asyncAppender)
+        m_asyncAppender->addAppender(appender);
+    else
+        registerStage(appender);
+}
+
+void DLogManagerPrivate::unregisterAppender(AbstractAppender *appender)
+{
+    if (m_asyncAppender)
+        m_asyncAppender->removeAppender(appender);
+    unregisterStage(appender);
+}
+
+// the appenders registered to the logger directly
+std::vector<AbstractAppender *> DLogManagerPrivate::topAppenders() const
+{
+    if (m_asyncAppender)
+        return {m_asyncAppender.get()};
+
+    std::vector<AbstractAppender *> appenders;
+    for (AbstractAppender *appender : std::initializer_list<AbstractAppender *>{m_consoleAppender, m_rollingFileAppender,
+                                                                                 m_binaryFileAppender, m_journalAppender}) {
+        if (appender)
+            appenders.push_back(appender);
+    }
+    return appenders;
+}
+
+void DLogManagerPrivate::registerStage(AbstractAppender *stage)
+{
+    if (m_rateLimitAppender)
+        m_rateLimitAppender->addAppender(stage);
+    else
+        dlogger->registerAppender(stage);
+}
+
+void DLogManagerPrivate::unregisterStage(AbstractAppender *stage)
+{
+    if (m_rateLimitAppender)
+        m_rateLimitAppender->removeAppender(stage);
+    dlogger->unregisterAppender(stage);
+}
+
+static void flushLogs()
+{
+    DLogManager::flush();
+}
+
+// the enabled levels of the default category (qDebug() and the like), a bit per QtMsgType.
+// Qt checks a named category before the message is built, but the default one only after.
+static std::atomic<int> defaultLevels{~0};
+static QLoggingCategory::CategoryFilter previousFilter = nullptr;
+
+static int enabledLevels(const QLoggingCategory *category)
+{
+    int levels = 1 << QtFatalMsg;
+    for (QtMsgType type : {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg}) {
+        if (category->isEnabled(type))
+            levels |= 1 << type;
+    }
+    return levels;
+}
+
+// it's called for every category after the rules are changed, whoever changes them.
+static void trackLevelsFilter(QLoggingCategory *category)
+{
+    if (previousFilter)
+        previousFilter(category);
+    if (qstrcmp(category->categoryName(), "default") == 0)
+        defaultLevels.store(enabledLevels(category), std::memory_order_relaxed);
+}
+
 /*!
 @~english
   \class Dtk::Core::DLogManager
@@ -166,7 +744,19 @@ bool DLogManagerPrivate::shouldSkipConsoleAppender() const
 DLogManager::DLogManager()
     :d_ptr(new DLogManagerPrivate(this))
 {
+    previousFilter = QLoggingCategory::installFilter(trackLevelsFilter);
+    defaultLevels.store(enabledLevels(QLoggingCategory::defaultCategory()), std::memory_order_relaxed);
     d_ptr->initLoggingRules();
+
+    // instance() isn't ready here, go through the private directly
+    if (qEnvironmentVariableIntValue("DTK_LOG_ASYNC") == 1)
+        d_ptr->setAsyncLogging(true, 8192, BlockWhenFull);
+
+    const QByteArray &rateLimit = qgetenv("DTK_LOG_RATE_LIMIT");
+    if (!rateLimit.isEmpty()) {
+        const QList<QByteArray> &parts = rateLimit.split('/');
+        d_ptr->setLogRateLimit(parts.first().toInt(), parts.size() > 1 ? parts.at(1).toInt() : 1000, QString());
+    }
 }
 
 void DLogManager::initConsoleAppender(){
@@ -180,29 +770,35 @@ void DLogManager::initConsoleAppender(){
     
     d->m_consoleAppender = new ConsoleAppender;
     d->m_consoleAppender->setFormat(d->m_format);
-    dlogger->registerAppender(d->m_consoleAppender);
+    d->registerAppender(d->m_consoleAppender);
 }
 
 void DLogManager::initRollingFileAppender(){
     Q_D(DLogManager);
+    if (d->m_binaryFormat) {
+        d->m_binaryFileAppender = new DBinaryFileAppender(getlogFilePath());
+        d->m_binaryFileAppender->setFilesLimit(5);
+        d->registerAppender(d->m_binaryFileAppender);
+        return;
+    }
     d->m_rollingFileAppender = new RollingFileAppender(getlogFilePath());
     d->m_rollingFileAppender->setFormat(d->m_format);
     d->m_rollingFileAppender->setLogFilesLimit(5);
     d->m_rollingFileAppender->setDatePattern(RollingFileAppender::DailyRollover);
-    dlogger->registerAppender(d->m_rollingFileAppender);
+    d->registerAppender(d->m_rollingFileAppender);
 }
 
 void DLogManager::initJournalAppender()
 {
 #if (defined BUILD_WITH_SYSTEMD && defined Q_OS_LINUX)
     Q_D(DLogManager);
-    d->m_journalAppender = new JournalAppender();
-    dlogger->registerAppender(d->m_journalAppender);
+    d->m_journalAppender = new DJournalAppender();
+    d->registerAppender(d->m_journalAppender);
     
     // Unregister ConsoleAppender if already registered under systemd to avoid duplicate logging
     if (d->shouldSkipConsoleAppender() && d->m_consoleAppender) {
         qDebug() << "Unregistered ConsoleAppender to avoid duplicate logging with JournalAppender under systemd";
-        dlogger->unregisterAppender(d->m_consoleAppender);
+        d->unregisterAppender(d->m_consoleAppender);
         delete d->m_consoleAppender;
         d->m_consoleAppender = nullptr;
     }
@@ -295,8 +891,170 @@ QString DLogManager::joinPath(const QString &path, const QString &fileName){
     return QString("%1%2%3").arg(path, separator, fileName);
 }
 
+void DLogManagerPrivate::setAsyncLogging(bool enabled, int queueSize, DLogManager::OverflowPolicy policy)
+{
+    if (enabled == bool(m_asyncAppender))
+        return;
+
+    if (enabled) {
+        m_asyncAppender.reset(new AsyncAppender(queueSize, policy));
+        registerStage(m_asyncAppender.get());
+        static bool routineAdded = false;
+        if (!routineAdded && QCoreApplication::instance()) {
+            qAddPostRoutine(flushLogs);
+            routineAdded = true;
+        }
+        return;
+    }
+
+    // the appenders go back to the logger
+    unregisterStage(m_asyncAppender.get());
+    for (AbstractAppender *appender : m_asyncAppender->takeAppenders())
+        registerStage(appender);
+    m_asyncAppender.reset();
+}
+
+/*!
+@~english
+  \brief Write the log records in a background thread, it affects the appenders registered later.
+
+  The records are queued in a ring buffer of \a queueSize records, and written to the
+  appenders in batches. When the queue is full, the logging thread waits for room or the
+  record is dropped according to \a policy, the number of the dropped records is logged.
+  With BlockWhenFull, the record is dropped too if the background thread doesn't write any
+  record in a second, e.g. an appender logs a record itself and waits for the blocked thread.
+  The queue is flushed when the application quits and before a fatal record is written.
+  It's enabled by `DTK_LOG_ASYNC=1` too.
+
+  \sa flush
+ */
+void DLogManager::setAsyncLogging(bool enabled, int queueSize, OverflowPolicy policy)
+{
+    instance()->d_func()->setAsyncLogging(enabled, queueSize, policy);
+}
+
+bool DLogManager::isAsyncLogging()
+{
+    return bool(instance()->d_func()->m_asyncAppender);
+}
+
+/*!
+@~english
+  \brief Wait until the queued log records are written, and write the counts of the ended rate limiting intervals.
+ */
+void DLogManager::flush()
+{
+    DLogManagerPrivate *d = instance()->d_func();
+    if (RateLimitAppender *appender = d->m_rateLimitAppender.get())
+        appender->flush();
+    if (AsyncAppender *appender = d->m_asyncAppender.get())
+        appender->flush();
+    if (d->m_binaryFileAppender)
+        d->m_binaryFileAppender->flush();
+}
+
+void DLogManagerPrivate::setLogRateLimit(int burst, int interval, const QString &category)
+{
+    if (!m_rateLimitAppender) {
+        if (burst <= 0)
+            return;
+
+        // it's put in front of the appenders registered before
+        m_rateLimitAppender.reset(new RateLimitAppender);
+        for (AbstractAppender *appender : topAppenders()) {
+            dlogger->unregisterAppender(appender);
+            m_rateLimitAppender->addAppender(appender);
+        }
+        dlogger->registerAppender(m_rateLimitAppender.get());
+    }
+
+    m_rateLimitAppender->setLimit(category, {burst, qMax(interval, 1)});
+    if (m_rateLimitAppender->isLimited())
+        return;
+
+    dlogger->unregisterAppender(m_rateLimitAppender.get());
+    for (AbstractAppender *appender : m_rateLimitAppender->takeAppenders())
+        dlogger->registerAppender(appender);
+    m_rateLimitAppender.reset();
+}
+
+/*!
+@~english
+  \brief Limit the records of \a category to \a burst in every \a interval ms, the empty \a category is for all the categories.
+
+  The records are counted by the category and the source location, the records over the
+  limit aren't written, the last of them is written with the count when the interval ends.
+  A \a burst of 0 removes the limit, the fatal records are never limited. It affects all the
+  appenders registered by DLogManager, the limit for all the categories is set by
+  `DTK_LOG_RATE_LIMIT=<burst>[/<interval>]` too.
+ */
+void DLogManager::setLogRateLimit(int burst, int interval, const QString &category)
+{
+    instance()->d_func()->setLogRateLimit(burst, interval, category);
+}
+
+/*!
+@~english
+  \brief Return whether the messages of \a type are enabled for the default category by the logging rules.
+
+  It's a single load, check it before building an expensive message with qDebug(), the
+  messages of a named category are short-circuited by qCDebug() already. The levels follow
+  the rules of the DConfig preference and QLoggingCategory::setFilterRules() once DLogManager
+  is used, all the levels are reported as enabled before.
+ */
+bool DLogManager::isLevelEnabled(QtMsgType type)
+{
+    return defaultLevels.load(std::memory_order_relaxed) & (1 << type);
+}
+
+/*!
+@~english
+  \brief Write the log file of registerFileAppender in a compact binary format, call it before registerFileAppender.
+
+  The records aren't formatted, the category, file and function names are written once
+  per file and referred by id, and the records are buffered until a warning comes or
+  flush() is called. The file is rotated by size instead of by day, and it's turned back
+  to text by decodeBinaryLog() or the `dtk-log-decode` tool.
+
+  \sa decodeBinaryLog
+ */
+void DLogManager::setBinaryLogFormat(bool enabled)
+{
+    instance()->d_func()->m_binaryFormat = enabled;
+}
+
+bool DLogManager::isBinaryLogFormat()
+{
+    return instance()->d_func()->m_binaryFormat;
+}
+
+/*!
+@~english
+  \brief Decode the binary log file \a path and write the records to \a output as text formatted by \a format.
+
+  The format of setLogFormat() is used if \a format is empty. Returns false if the file
+  can't be read or it's broken, the records before the broken one are still written.
+
+  \sa setBinaryLogFormat
+ */
+bool DLogManager::decodeBinaryLog(const QString &path, QIODevice *output, const QString &format)
+{
+    return DBinaryLog::decode(path, output, format.isEmpty() ? instance()->d_func()->m_format : format);
+}
+
 DLogManager::~DLogManager()
 {
+    Q_D(DLogManager);
+    if (d->m_rateLimitAppender) {
+        dlogger->unregisterAppender(d->m_rateLimitAppender.get());
+        d->m_rateLimitAppender->flush();
+    }
+    if (d->m_asyncAppender) {
+        d->m_asyncAppender->flush();
+        d->unregisterStage(d->m_asyncAppender.get());
+    }
+    if (d->m_binaryFileAppender)
+        d->m_binaryFileAppender->flush();
 }
 
 DCORE_END_NAMESPACE
@@ -0,0 +1,248 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dbinarylog_p.h"
+
+#include <AbstractStringAppender.h>
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QVector>
+
+DCORE_BEGIN_NAMESPACE
+
+// flushed when it's full or a warning comes, the latter are likely read soon.
+static const int BufferSize = 64 * 1024;
+
+static void writeVarint(QByteArray &buffer, quint64 value)
+{
+    while (value >= 0x80) {
+        buffer.append(char(value | 0x80));
+        value >>= 7;
+    }
+    buffer.append(char(value));
+}
+
+static bool readVarint(const char *&data, const char *end, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; data < end && shift < 64; shift += 7) {
+        const quint8 byte = quint8(*data++);
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+DBinaryFileAppender::DBinaryFileAppender(const QString &fileName)
+{
+    m_file.setFileName(fileName);
+}
+
+DBinaryFileAppender::~DBinaryFileAppender()
+{
+    flush();
+}
+
+bool DBinaryFileAppender::open()
+{
+    if (m_file.isOpen())
+        return true;
+
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        fprintf(stderr, "Can't open the log file %s: %s\n", qPrintable(m_file.fileName()), qPrintable(m_file.errorString()));
+        return false;
+    }
+
+    // the names are interned again in every file, a file is decoded alone.
+    m_literals.clear();
+    m_categories.clear();
+    m_nextId = 1;
+    m_lastTime = 0;
+    if (m_file.size() > 0) {
+        // appending to an old file would mix the tables, start a new one.
+        m_file.close();
+        rotate();
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+    }
+    m_buffer.append(DBinaryLog::Magic, sizeof(DBinaryLog::Magic));
+    m_buffer.append(DBinaryLog::Version);
+    return true;
+}
+
+// name.dlog is moved to name.dlog.1, name.dlog.1 to name.dlog.2 and so on.
+void DBinaryFileAppender::rotate()
+{
+    const QString &name = m_file.fileName();
+    QFile::remove(QStringLiteral("%1.%2").arg(name).arg(m_filesLimit));
+    for (int i = m_filesLimit - 1; i > 0; --i)
+        QFile::rename(QStringLiteral("%1.%2").arg(name).arg(i), QStringLiteral("%1.%2").arg(name).arg(i + 1));
+    QFile::rename(name, name + QStringLiteral(".1"));
+}
+
+void DBinaryFileAppender::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    flushBuffer();
+}
+
+void DBinaryFileAppender::flushBuffer()
+{
+    if (m_buffer.isEmpty() || !m_file.isOpen())
+        return;
+
+    m_file.write(m_buffer);
+    m_file.flush();
+    m_buffer.clear();
+
+    if (m_file.size() >= m_sizeLimit) {
+        m_file.close();
+        rotate();
+    }
+}
+
+void DBinaryFileAppender::writeDefine(quint32 id, const QByteArray &name)
+{
+    m_buffer.append(DBinaryLog::Define);
+    writeVarint(m_buffer, id);
+    writeVarint(m_buffer, quint64(name.size()));
+    m_buffer.append(name);
+}
+
+quint32 DBinaryFileAppender::intern(const char *name)
+{
+    if (!name)
+        return 0;
+
+    auto it = m_literals.constFind(name);
+    if (it != m_literals.constEnd())
+        return it.value();
+
+    const quint32 id = m_nextId++;
+    m_literals.insert(name, id);
+    writeDefine(id, QByteArray(name));
+    return id;
+}
+
+quint32 DBinaryFileAppender::intern(const QString &name)
+{
+    if (name.isEmpty())
+        return 0;
+
+    auto it = m_categories.constFind(name);
+    if (it != m_categories.constEnd())
+        return it.value();
+
+    const quint32 id = m_nextId++;
+    m_categories.insert(name, id);
+    writeDefine(id, name.toUtf8());
+    return id;
+}
+
+void DBinaryFileAppender::append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                                 const char *func, const QString &category, const QString &msg)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!open())
+        return;
+
+    const quint32 categoryId = intern(category);
+    const quint32 fileId = intern(file);
+    const quint32 functionId = intern(func);
+
+    const qint64 msecs = time.toMSecsSinceEpoch();
+    const qint64 delta = msecs - m_lastTime;
+    m_lastTime = msecs;
+
+    const QByteArray &message = msg.toUtf8();
+    m_buffer.append(DBinaryLog::Record);
+    writeVarint(m_buffer, quint64((delta << 1) ^ (delta >> 63)));
+    m_buffer.append(char(level));
+    writeVarint(m_buffer, categoryId);
+    writeVarint(m_buffer, fileId);
+    writeVarint(m_buffer, functionId);
+    writeVarint(m_buffer, quint64(qMax(line, 0)));
+    writeVarint(m_buffer, quint64(message.size()));
+    m_buffer.append(message);
+
+    if (m_buffer.size() >= BufferSize || level >= Logger::Warning)
+        flushBuffer();
+}
+
+// formats the records as the text appenders do
+class Q_DECL_HIDDEN BinaryLogFormatter : public AbstractStringAppender
+{
+public:
+    using AbstractStringAppender::formattedString;
+
+protected:
+    void append(const QDateTime &, Logger::LogLevel, const char *, int, const char *, const QString &, const QString &) override {}
+};
+
+bool DBinaryLog::decode(const QString &path, QIODevice *output, const QString &format)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Can't open the binary log" << path << file.errorString();
+        return false;
+    }
+
+    const QByteArray &content = file.readAll();
+    const char *data = content.constData();
+    const char *end = data + content.size();
+    if (content.size() < int(sizeof(DBinaryLog::Magic)) + 1
+        || memcmp(data, DBinaryLog::Magic, sizeof(DBinaryLog::Magic)) != 0
+        || data[sizeof(DBinaryLog::Magic)] != DBinaryLog::Version) {
+        qWarning() << path << "is not a binary log";
+        return false;
+    }
+    data += sizeof(DBinaryLog::Magic) + 1;
+
+    BinaryLogFormatter formatter;
+    formatter.setFormat(format);
+
+    QVector<QByteArray> names(1);
+    qint64 time = 0;
+    while (data < end) {
+        const char tag = *data++;
+        quint64 id = 0, size = 0;
+        if (tag == DBinaryLog::Define) {
+            if (!readVarint(data, end, id) || !readVarint(data, end, size) || size > quint64(end - data) || id > 0xffffff)
+                return false;
+            if (names.size() <= int(id))
+                names.resize(int(id) + 1);
+            names[int(id)] = QByteArray(data, int(size));
+            data += size;
+            continue;
+        }
+        if (tag != DBinaryLog::Record || end - data < 1)
+            return false;
+
+        quint64 delta = 0, category = 0, fileId = 0, function = 0, line = 0;
+        if (!readVarint(data, end, delta) || data >= end)
+            return false;
+        const auto level = static_cast<Logger::LogLevel>(*data++);
+        if (!readVarint(data, end, category) || !readVarint(data, end, fileId) || !readVarint(data, end, function)
+            || !readVarint(data, end, line) || !readVarint(data, end, size) || size > quint64(end - data))
+            return false;
+        time += qint64(delta >> 1) ^ -qint64(delta & 1);
+        const QString message = QString::fromUtf8(data, int(size));
+        data += size;
+
+        auto name = [&names](quint64 id) {
+            return id < quint64(names.size()) ? names.at(int(id)) : QByteArray();
+        };
+        const QByteArray &fileName = name(fileId);
+        const QByteArray &functionName = name(function);
+        output->write(formatter.formattedString(QDateTime::fromMSecsSinceEpoch(time), level,
+                                                fileName.isEmpty() ? nullptr : fileName.constData(), int(line),
+                                                functionName.isEmpty() ? nullptr : functionName.constData(),
+                                                QString::fromUtf8(name(category)), message).toUtf8());
+    }
+    return true;
+}
+
+DCORE_END_NAMESPACE
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <dtkcore_global.h>
+#include <AbstractAppender.h>
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * The binary log file, it's written without formatting and decoded offline.
+ *
+ *   file:    "DLOG" version(u8) entry*
+ *   entry:   Define id(varint) size(varint) utf8       -- a category, file or function name
+ *          | Record time(zigzag varint, ms to the previous record) level(u8)
+ *                   category(varint) file(varint) function(varint) line(varint) size(varint) utf8
+ *
+ * The names are interned per file, the first record's time is relative to 0.
+ */
+namespace DBinaryLog {
+enum Tag : char {
+    Define = 1,
+    Record = 2
+};
+static const char Magic[] = {'D', 'L', 'O', 'G'};
+static const char Version = 1;
+
+bool decode(const QString &path, QIODevice *output, const QString &format);
+}
+
+class Q_DECL_HIDDEN DBinaryFileAppender : public AbstractAppender
+{
+public:
+    explicit DBinaryFileAppender(const QString &fileName);
+    ~DBinaryFileAppender() override;
+
+    void setFileSizeLimit(qint64 size) { m_sizeLimit = size; }
+    void setFilesLimit(int count) { m_filesLimit = count; }
+    void flush();
+
+protected:
+    void append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                const char *func, const QString &category, const QString &msg) override;
+
+private:
+    bool open();
+    void rotate();
+    void flushBuffer();
+    quint32 intern(const char *name);
+    quint32 intern(const QString &name);
+    void writeDefine(quint32 id, const QByteArray &name);
+
+    QMutex m_mutex;
+    QFile m_file;
+    QByteArray m_buffer;
+    qint64 m_lastTime = 0;
+    qint64 m_sizeLimit = 16 * 1024 * 1024;
+    int m_filesLimit = 5;
+    quint32 m_nextId = 1;
+    // the file and function names are literals, they're interned by address
+    QHash<const char *, quint32> m_literals;
+    QHash<QString, quint32> m_categories;
+};
+
+DCORE_END_NAMESPACE
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "djournalappender_p.h"
+
+#include <QCoreApplication>
+
+#define SD_JOURNAL_SUPPRESS_LOCATION
+#include <systemd/sd-journal.h>
+#include <sys/uio.h>
+#include <errno.h>
+
+DCORE_BEGIN_NAMESPACE
+
+// the call sites are literals, the cache is bounded for the generated ones only
+static const size_t MaxCachedSites = 4096;
+static const int MessagePrefixSize = int(sizeof("MESSAGE=") - 1);
+
+static inline iovec field(const QByteArray &data)
+{
+    return {const_cast<char *>(data.constData()), size_t(data.size())};
+}
+
+DJournalAppender::DJournalAppender()
+    : m_message(QByteArrayLiteral("MESSAGE="))
+{
+    QString name = QCoreApplication::applicationName();
+    if (name.isEmpty())
+        name = QString::fromLocal8Bit(program_invocation_short_name);
+    m_identifier = QByteArrayLiteral("SYSLOG_IDENTIFIER=") + name.toUtf8();
+
+    // syslog(3): the debug, info, warning, err and crit priorities
+    static const int priorities[] = {7, 7, 6, 4, 3, 2};
+    for (int level = Logger::Trace; level <= Logger::Fatal; ++level)
+        m_priorities[level] = QByteArrayLiteral("PRIORITY=") + QByteArray::number(priorities[level]);
+}
+
+const DJournalAppender::SiteFields &DJournalAppender::siteFields(const char *file, int line, const char *func)
+{
+    const Site site{file, line, func};
+    auto it = m_sites.find(site);
+    if (it != m_sites.end())
+        return it->second;
+
+    if (m_sites.size() >= MaxCachedSites)
+        m_sites.clear();
+
+    SiteFields fields{QByteArrayLiteral("CODE_FILE=") + (file ? file : ""),
+                      QByteArrayLiteral("CODE_LINE=") + QByteArray::number(line),
+                      QByteArrayLiteral("CODE_FUNC=") + (func ? func : "")};
+    return m_sites.emplace(site, std::move(fields)).first->second;
+}
+
+const QByteArray &DJournalAppender::categoryField(const QString &category)
+{
+    auto it = m_categories.constFind(category);
+    if (it != m_categories.constEnd())
+        return it.value();
+
+    return m_categories.insert(category, QByteArrayLiteral("QT_CATEGORY=") + category.toUtf8()).value();
+}
+
+// it's called with the lock of the appender held, the buffers are reused
+void DJournalAppender::append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                              const char *func, const QString &category, const QString &msg)
+{
+    Q_UNUSED(time)
+
+    m_message.truncate(MessagePrefixSize);
+    m_message.append(msg.toUtf8());
+
+    const SiteFields &site = siteFields(file, line, func);
+    iovec fields[7] = {
+        field(m_message),
+        field(m_priorities[qBound(int(Logger::Trace), int(level), int(Logger::Fatal))]),
+        field(m_identifier),
+        field(site.file),
+        field(site.line),
+        field(site.function),
+    };
+    int count = 6;
+    if (!category.isEmpty())
+        fields[count++] = field(categoryField(category));
+
+    sd_journal_sendv(fields, count);
+}
+
+DCORE_END_NAMESPACE
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <dtkcore_global.h>
+#include <AbstractAppender.h>
+
+#include <QByteArray>
+#include <QHash>
+
+#include <unordered_map>
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * Writes the records to journald by sd_journal_sendv(), the fields of a call site
+ * (CODE_FILE, CODE_LINE, CODE_FUNC) and of a category are built once and cached, so
+ * a record costs the UTF-8 encoding of its message only.
+ */
+class Q_DECL_HIDDEN DJournalAppender : public AbstractAppender
+{
+public:
+    DJournalAppender();
+
+protected:
+    void append(const QDateTime &time, Logger::LogLevel level, const char *file, int line,
+                const char *func, const QString &category, const QString &msg) override;
+
+private:
+    struct Site
+    {
+        const char *file;
+        int line;
+        const char *function;
+
+        bool operator==(const Site &other) const
+        {
+            return file == other.file && line == other.line && function == other.function;
+        }
+    };
+
+    struct SiteHash
+    {
+        size_t operator()(const Site &site) const
+        {
+            return std::hash<const void *>()(site.file) ^ std::hash<const void *>()(site.function) ^ (size_t(site.line) << 16);
+        }
+    };
+
+    struct SiteFields
+    {
+        QByteArray file;
+        QByteArray line;
+        QByteArray function;
+    };
+
+    const SiteFields &siteFields(const char *file, int line, const char *func);
+    const QByteArray &categoryField(const QString &category);
+
+    QByteArray m_identifier;
+    QByteArray m_priorities[Logger::Fatal + 1];
+    QByteArray m_message;
+    std::unordered_map<Site, SiteFields, SiteHash> m_sites;
+    QHash<QString, QByteArray> m_categories;
+};
+
+DCORE_END_NAMESPACE
@@ -3,9 +3,18 @@ file(GLOB LOG_HEADER
 )
 set(LOG_SOURCE
   ${CMAKE_CURRENT_LIST_DIR}/LogManager.cpp
+  ${CMAKE_CURRENT_LIST_DIR}/dbinarylog_p.h
+  ${CMAKE_CURRENT_LIST_DIR}/dbinarylog.cpp
   ${CMAKE_CURRENT_LIST_DIR}/dconfig_org_deepin_dtk_preference.hpp
 )
 
+if(BUILD_WITH_SYSTEMD)
+  list(APPEND LOG_SOURCE
+    ${CMAKE_CURRENT_LIST_DIR}/djournalappender_p.h
+    ${CMAKE_CURRENT_LIST_DIR}/djournalappender.cpp
+  )
+endif()
+
 set(log_SRCS
 ${LOG_HEADER}
 ${LOG_SOURCE}
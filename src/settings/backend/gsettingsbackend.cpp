@@ -6,6 +6,7 @@
 
 //#include <QDebug>
 #include <QFile>
+#include <QHash>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QVariant>
@@ -18,6 +19,12 @@
 
 #include <DSettings>
 
+// gio names a struct member signals
+#pragma push_macro("signals")
+#undef signals
+#include <gio/gio.h>
+#pragma pop_macro("signals")
+
 DCORE_BEGIN_NAMESPACE
 
 QString unqtifyName(const QString &name)
@@ -40,14 +47,81 @@ QString qtifyName(const QString &key)
     return QString(key).replace(".", "-").replace("_", "-");
 }
 
+// the name QGSettings reports in changed() for the gsettings key
+static QString changedName(const QString &gsettingsKey)
+{
+    QString ret;
+    bool upper = false;
+    for (const QChar c : gsettingsKey) {
+        if (c == QLatin1Char('-')) {
+            upper = true;
+        } else {
+            ret.append(upper ? c.toUpper() : c);
+            upper = false;
+        }
+    }
+    return ret;
+}
+
+static GVariant *toGVariant(const QVariant &value, const QByteArray &type)
+{
+    if (type == "b")
+        return g_variant_new_boolean(value.toBool());
+    if (type == "y")
+        return g_variant_new_byte(static_cast<guchar>(value.toUInt()));
+    if (type == "n")
+        return g_variant_new_int16(static_cast<gint16>(value.toInt()));
+    if (type == "q")
+        return g_variant_new_uint16(static_cast<guint16>(value.toUInt()));
+    if (type == "i")
+        return g_variant_new_int32(value.toInt());
+    if (type == "u")
+        return g_variant_new_uint32(value.toUInt());
+    if (type == "x")
+        return g_variant_new_int64(value.toLongLong());
+    if (type == "t")
+        return g_variant_new_uint64(value.toULongLong());
+    if (type == "d")
+        return g_variant_new_double(value.toDouble());
+    if (type == "s")
+        return g_variant_new_string(value.toString().toUtf8().constData());
+    if (type == "as") {
+        GVariantBuilder builder;
+        g_variant_builder_init(&builder, G_VARIANT_TYPE_STRING_ARRAY);
+        for (const QString &item : value.toStringList())
+            g_variant_builder_add(&builder, "s", item.toUtf8().constData());
+        return g_variant_builder_end(&builder);
+    }
+
+    return nullptr;
+}
 
 class GSettingsBackendPrivate
 {
 public:
     GSettingsBackendPrivate(GSettingsBackend *parent) : q_ptr(parent) {}
+    ~GSettingsBackendPrivate()
+    {
+        if (delayed) {
+            g_settings_apply(delayed);
+            g_object_unref(delayed);
+        }
+    }
+
+    struct KeyInfo {
+        // the key given to QGSettings, and the one of the schema
+        QString qtKey;
+        QByteArray gsettingsKey;
+        QByteArray type;
+    };
 
     QGSettings *gsettings;
-    QMap<QString, QString> keyMap;
+    // a second handle in delay-apply mode, the writes of a sync go to dconf as one change set
+    GSettings *delayed = nullptr;
+    // resolved once from DSettings::keys()
+    QHash<QString, KeyInfo> keyInfos;
+    // the names reported by QGSettings::changed() to the DSettings keys
+    QHash<QString, QString> keyMap;
 
     GSettingsBackend *q_ptr;
     Q_DECLARE_PUBLIC(GSettingsBackend)
@@ -74,15 +148,33 @@ GSettingsBackend::GSettingsBackend(DSettings *settings, QObject *parent) :
     auto id = gsettingsMeta.value("id").toString();
     auto path = gsettingsMeta.value("path").toString();
 
-    for (QString key : settings->keys()) {
-        auto gsettingsKey = QString(key).replace(".", "-").replace("_", "-");
-        d->keyMap.insert(gsettingsKey, key);
+    GSettingsSchemaSource *source = g_settings_schema_source_get_default();
+    GSettingsSchema *schema = source ? g_settings_schema_source_lookup(source, id.toUtf8().constData(), TRUE) : nullptr;
+
+    for (const QString &key : settings->keys()) {
+        GSettingsBackendPrivate::KeyInfo info;
+        info.qtKey = qtifyName(key);
+        info.gsettingsKey = unqtifyName(info.qtKey).toUtf8();
+        if (schema && g_settings_schema_has_key(schema, info.gsettingsKey.constData())) {
+            GSettingsSchemaKey *schemaKey = g_settings_schema_get_key(schema, info.gsettingsKey.constData());
+            const GVariantType *type = g_settings_schema_key_get_value_type(schemaKey);
+            info.type = QByteArray(g_variant_type_peek_string(type), static_cast<int>(g_variant_type_get_string_length(type)));
+            g_settings_schema_key_unref(schemaKey);
+        }
+        d->keyInfos.insert(key, info);
+        d->keyMap.insert(changedName(QString::fromUtf8(info.gsettingsKey)), key);
+    }
+
+    if (schema) {
+        d->delayed = g_settings_new_full(schema, nullptr, path.isEmpty() ? nullptr : path.toUtf8().constData());
+        g_settings_delay(d->delayed);
+        g_settings_schema_unref(schema);
     }
 
     d->gsettings = new QGSettings(id.toUtf8(), path.toUtf8(), this);
 
     connect(d->gsettings, &QGSettings::changed, this, [ = ](const QString & key) {
-        auto dk = d->keyMap.value(unqtifyName(key));
+        auto dk = d->keyMap.value(key);
 //        qDebug() << "gsetting change" << key << d->gsettings->get(key);
         Q_EMIT optionChanged(dk, d->gsettings->get(key));
     });
@@ -113,7 +205,8 @@ QStringList GSettingsBackend::keys() const
 QVariant GSettingsBackend::getOption(const QString &key) const
 {
     Q_D(const GSettingsBackend);
-    return d->gsettings->get(qtifyName(key));
+    auto it = d->keyInfos.constFind(key);
+    return d->gsettings->get(it != d->keyInfos.constEnd() ? it->qtKey : qtifyName(key));
 }
 
 /*!
@@ -124,9 +217,18 @@ QVariant GSettingsBackend::getOption(const QString &key) const
 void GSettingsBackend::doSetOption(const QString &key, const QVariant &value)
 {
     Q_D(GSettingsBackend);
-    if (value != d->gsettings->get(qtifyName(key))) {
-//        qDebug() << "doSetOption" << key << d->gsettings->get(qtifyName(key));
-        d->gsettings->set(qtifyName(key), value);
+    auto it = d->keyInfos.constFind(key);
+    const QString qtKey = it != d->keyInfos.constEnd() ? it->qtKey : qtifyName(key);
+    if (value == d->gsettings->get(qtKey))
+        return;
+
+//    qDebug() << "doSetOption" << key << d->gsettings->get(qtKey);
+    GVariant *variant = d->delayed && it != d->keyInfos.constEnd() ? toGVariant(value, it->type) : nullptr;
+    if (variant) {
+        // written by doSync(), DSettingsBackend calls it after the queued options
+        g_settings_set_value(d->delayed, it->gsettingsKey.constData(), variant);
+    } else {
+        d->gsettings->set(qtKey, value);
     }
 }
 
@@ -136,7 +238,10 @@ void GSettingsBackend::doSetOption(const QString &key, const QVariant &value)
  */
 void GSettingsBackend::doSync()
 {
-    Q_EMIT sync();
+    Q_D(GSettingsBackend);
+    // one dconf change set for all the options written since the last sync
+    if (d->delayed && g_settings_get_has_unapplied(d->delayed))
+        g_settings_apply(d->delayed);
 }
 
 DCORE_END_NAMESPACE
@@ -5,7 +5,8 @@
 #include "settings/backend/qsettingbackend.h"
 
 #include <QDebug>
-#include <QMutex>
+#include <QHash>
+#include <QReadWriteLock>
 #include <QSettings>
 
 DCORE_BEGIN_NAMESPACE
@@ -15,8 +16,16 @@ class QSettingBackendPrivate
 public:
     QSettingBackendPrivate(QSettingBackend *parent) : q_ptr(parent) {}
 
+    // only touched in the thread of the backend, when loading and by doSync()
     QSettings       *settings   = nullptr;
-    QMutex          writeLock;
+
+    // the values by key, the reads of any thread are served from here
+    mutable QReadWriteLock lock;
+    QHash<QString, QVariant> values;
+    QStringList     dirtyKeys;
+    // sorted like QSettings::childGroups(), rebuilt after a new key is written
+    mutable QStringList keysCache;
+    mutable bool    keysCacheValid = false;
 
     QSettingBackend *q_ptr;
     Q_DECLARE_PUBLIC(QSettingBackend)
@@ -41,7 +50,15 @@ QSettingBackend::QSettingBackend(const QString &filepath, QObject *parent) :
     Q_D(QSettingBackend);
 
     d->settings = new QSettings(filepath, QSettings::NativeFormat, this);
+    // written to a temporary file and renamed over the old one
+    d->settings->setAtomicSyncRequired(true);
     qDebug() << "create config" <<  d->settings->fileName();
+
+    for (const QString &key : d->settings->childGroups()) {
+        d->settings->beginGroup(key);
+        d->values.insert(key, d->settings->value("value"));
+        d->settings->endGroup();
+    }
 }
 
 QSettingBackend::~QSettingBackend()
@@ -57,7 +74,19 @@ QSettingBackend::~QSettingBackend()
 QStringList QSettingBackend::keys() const
 {
     Q_D(const QSettingBackend);
-    return d->settings->childGroups();
+    {
+        QReadLocker locker(&d->lock);
+        if (d->keysCacheValid)
+            return d->keysCache;
+    }
+
+    QWriteLocker locker(&d->lock);
+    if (!d->keysCacheValid) {
+        d->keysCache = d->values.keys();
+        d->keysCache.sort();
+        d->keysCacheValid = true;
+    }
+    return d->keysCache;
 }
 
 /*!
@@ -69,10 +98,8 @@ QStringList QSettingBackend::keys() const
 QVariant QSettingBackend::getOption(const QString &key) const
 {
     Q_D(const QSettingBackend);
-    d->settings->beginGroup(key);
-    auto value = d->settings->value("value");
-    d->settings->endGroup();
-    return value;
+    QReadLocker locker(&d->lock);
+    return d->values.value(key);
 }
 
 /*!
@@ -84,15 +111,19 @@ QVariant QSettingBackend::getOption(const QString &key) const
 void QSettingBackend::doSetOption(const QString &key, const QVariant &value)
 {
     Q_D(QSettingBackend);
-    d->writeLock.lock();
-    d->settings->beginGroup(key);
-    auto oldValue = d->settings->value("value");
-    if (oldValue != value) {
-        d->settings->setValue("value", value);
+    QWriteLocker locker(&d->lock);
+    auto it = d->values.find(key);
+    if (it == d->values.end()) {
+        d->values.insert(key, value);
+        d->keysCacheValid = false;
+    } else if (*it != value) {
+        *it = value;
+    } else {
+        return;
     }
-    d->settings->endGroup();
-    d->settings->sync();
-    d->writeLock.unlock();
+
+    if (!d->dirtyKeys.contains(key))
+        d->dirtyKeys << key;
 }
 
 /*!
@@ -102,6 +133,21 @@ void QSettingBackend::doSetOption(const QString &key, const QVariant &value)
 void QSettingBackend::doSync()
 {
     Q_D(QSettingBackend);
+    QStringList keys;
+    QVariantList values;
+    {
+        QWriteLocker locker(&d->lock);
+        keys.swap(d->dirtyKeys);
+        for (const QString &key : keys)
+            values << d->values.value(key);
+    }
+
+    // runs in the thread of the backend, the readers only wait for the copy above
+    for (int i = 0; i < keys.size(); ++i) {
+        d->settings->beginGroup(keys.at(i));
+        d->settings->setValue("value", values.at(i));
+        d->settings->endGroup();
+    }
     d->settings->sync();
 }
 
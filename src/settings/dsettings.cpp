@@ -6,11 +6,17 @@
 
 #include <QMap>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutex>
+#include <QSharedData>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QHash>
 #include <QThread>
 #include <QDebug>
+#include <QPointer>
 
 #include "dsettingsoption.h"
 #include "dsettingsgroup.h"
@@ -18,140 +24,250 @@
 
 DCORE_BEGIN_NAMESPACE
 
+// the parsed description, shared by all the DSettings loaded from the same file
+class DSettingsSchema : public QSharedData
+{
+public:
+    struct Option {
+        QVariant defaultValue;
+        bool canReset = true;
+    };
+
+    QStringList             keys;
+    QHash<QString, Option>  options;
+
+    QJsonObject meta() const;
+    void parseGroup(const QString &prefixKey, const QJsonObject &group);
+
+    static QExplicitlySharedDataPointer<DSettingsSchema> fromJson(const QByteArray &json);
+    static QExplicitlySharedDataPointer<DSettingsSchema> fromJsonFile(const QString &filepath);
+    static QExplicitlySharedDataPointer<DSettingsSchema> fromCompiled(const DSettingsCompiledSchema &compiled);
+
+private:
+    // a compiled schema keeps the json unparsed until the meta is asked for
+    mutable const char      *compiledJson = nullptr;
+    mutable QMutex          metaLock;
+    mutable QJsonObject     jsonMeta;
+};
+
+typedef QExplicitlySharedDataPointer<DSettingsSchema> SchemaPtr;
+
+void DSettingsSchema::parseGroup(const QString &prefixKey, const QJsonObject &group)
+{
+    // the same keys as DSettingsGroup and DSettingsOption
+    auto key = group.value("key").toString();
+    key = prefixKey.isEmpty() ? key : prefixKey + "." + key;
+
+    for (auto optionJson : group.value("options").toArray()) {
+        auto optionObject = optionJson.toObject();
+        Option option;
+        option.defaultValue = optionObject.value("default").toVariant();
+        option.canReset = !optionObject.contains("reset") ? true : optionObject.value("reset").toBool();
+
+        const QString optionKey = key + "." + optionObject.value("key").toString();
+        if (!options.contains(optionKey))
+            keys << optionKey;
+        options.insert(optionKey, option);
+    }
+
+    for (auto subGroup : group.value("groups").toArray())
+        parseGroup(key, subGroup.toObject());
+}
+
+QJsonObject DSettingsSchema::meta() const
+{
+    QMutexLocker locker(&metaLock);
+    if (compiledJson) {
+        jsonMeta = QJsonDocument::fromJson(compiledJson).object();
+        compiledJson = nullptr;
+    }
+    return jsonMeta;
+}
+
+SchemaPtr DSettingsSchema::fromJson(const QByteArray &json)
+{
+    auto schema = new DSettingsSchema;
+    schema->jsonMeta = QJsonDocument::fromJson(json).object();
+    for (auto groupJson : schema->jsonMeta.value("groups").toArray())
+        schema->parseGroup("", groupJson.toObject());
+    schema->keys.sort();
+    return SchemaPtr(schema);
+}
+
+SchemaPtr DSettingsSchema::fromJsonFile(const QString &filepath)
+{
+    struct CachedSchema {
+        QDateTime lastModified;
+        qint64 size = -1;
+        SchemaPtr schema;
+    };
+    static QMutex cacheLock;
+    static QHash<QString, CachedSchema> cache;
+
+    QFileInfo info(filepath);
+    const QString path = info.absoluteFilePath();
+    {
+        QMutexLocker locker(&cacheLock);
+        auto cached = cache.constFind(path);
+        if (cached != cache.constEnd() && cached->lastModified == info.lastModified()
+                && cached->size == info.size())
+            return cached->schema;
+    }
+
+    QFile jsonFile(filepath);
+    jsonFile.open(QIODevice::ReadOnly);
+    auto schema = fromJson(jsonFile.readAll());
+    jsonFile.close();
+
+    QMutexLocker locker(&cacheLock);
+    cache.insert(path, {info.lastModified(), info.size(), schema});
+    return schema;
+}
+
+static QVariant compiledDefaultValue(const DSettingsCompiledOption &option)
+{
+    if (option.valueType == QMetaType::UnknownType)
+        return QVariant();
+
+    // the lists and the maps are kept as json text
+    if (option.valueType == QMetaType::QVariantList || option.valueType == QMetaType::QStringList
+            || option.valueType == QMetaType::QVariantMap)
+        return QJsonDocument::fromJson(option.defaultValue).toVariant();
+
+    QVariant value(QString::fromUtf8(option.defaultValue));
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    value.convert(QMetaType(option.valueType));
+#else
+    value.convert(option.valueType);
+#endif
+    return value;
+}
+
+SchemaPtr DSettingsSchema::fromCompiled(const DSettingsCompiledSchema &compiled)
+{
+    // the compiled schemas are static data, the address identifies them
+    static QMutex cacheLock;
+    static QHash<const DSettingsCompiledSchema *, SchemaPtr> cache;
+
+    QMutexLocker locker(&cacheLock);
+    auto cached = cache.constFind(&compiled);
+    if (cached != cache.constEnd())
+        return *cached;
+
+    auto schema = new DSettingsSchema;
+    schema->compiledJson = compiled.json;
+    schema->options.reserve(compiled.optionCount);
+    for (int i = 0; i < compiled.optionCount; ++i) {
+        const auto &compiledOption = compiled.options[i];
+        const QString key = QString::fromUtf8(compiledOption.key);
+        Option option;
+        option.defaultValue = compiledDefaultValue(compiledOption);
+        option.canReset = compiledOption.canReset;
+        if (!schema->options.contains(key))
+            schema->keys << key;
+        schema->options.insert(key, option);
+    }
+    schema->keys.sort();
+
+    cache.insert(&compiled, SchemaPtr(schema));
+    return cache.value(&compiled);
+}
+
 class DSettingsPrivate
 {
 public:
     DSettingsPrivate(DSettings *parent) : q_ptr(parent) {}
 
-    DSettingsBackend            *backend = nullptr;
-    QJsonObject                 meta;
+    // the application owns the backend and may delete it first
+    QPointer<DSettingsBackend>  backend;
+    SchemaPtr                   schema;
+    // the values set or loaded by this instance, the default of the schema otherwise
+    QHash<QString, QVariant>    values;
+
+    // the QObject tree of the options, only built when asked for
+    bool                        treeBuilt = false;
     QMap <QString, OptionPtr>   options;
 
     QMap<QString, GroupPtr>     childGroups;
     QList<QString>              childGroupKeys;
 
+    // the options and the groups at any depth by their full keys, e.g. "base.open_action"
+    QHash<QString, OptionPtr>   optionIndex;
+    QHash<QString, GroupPtr>    groupIndex;
+
+    QVariant value(const QString &key) const;
+    void updateValue(const QString &key, const QVariant &value);
+    void ensureTree();
+    void indexGroup(const GroupPtr &group);
+
     DSettings *q_ptr;
     Q_DECLARE_PUBLIC(DSettings)
 };
 
-
-/*!
-@~english
-   @class Dtk::Core::DSettingsBackend
-   \inmodule dtkcore
-   @brief DSettingsBackend is interface of DSettings storage class.
-
-   Simaple example:
-
-@code
+QVariant DSettingsPrivate::value(const QString &key) const
 {
-    "groups": [{
-        "key": "base",
-        "name": "Basic settings",
-        "groups": [{
-                "key": "open_action",
-                "name": "Open Action",
-                "options": [{
-                        "key": "alway_open_on_new",
-                        "type": "checkbox",
-                        "text": "Always Open On New Windows",
-                        "default": true
-                    },
-                    {
-                        "key": "open_file_action",
-                        "name": "Open File:",
-                        "type": "combobox",
-                        "default": ""
-                    }
-                ]
-            },
-            {
-                "key": "new_tab_windows",
-                "name": "New Tab & Window",
-                "options": [{
-                        "key": "new_window_path",
-                        "name": "New Window Open:",
-                        "type": "combobox",
-                        "default": ""
-                    },
-                    {
-                        "key": "new_tab_path",
-                        "name": "New Tab Open:",
-                        "type": "combobox",
-                        "default": ""
-                    }
-                ]
-            }
-        ]
-    }]
+    // the same fallback as DSettingsOption::value()
+    auto value = values.value(key);
+    if (!value.isValid() || value.isNull())
+        return schema ? schema->options.value(key).defaultValue : QVariant();
+    return value;
 }
-@endcode
 
-    How to read/write key and value:
+void DSettingsPrivate::updateValue(const QString &key, const QVariant &value)
+{
+    Q_Q(DSettings);
+    values.insert(key, value);
+    if (backend) {
+        Q_EMIT backend->setOption(key, value);
+    } else {
+        qWarning() << "backend was not setted..!";
+    }
+    Q_EMIT q->valueChanged(key, value);
+}
 
-    @code
-    // init a storage backend
-    QTemporaryFile tmpFile;
-    tmpFile.open();
-    auto backend = new Dtk::Core::QSettingBackend(tmpFile.fileName());
+void DSettingsPrivate::ensureTree()
+{
+    Q_Q(DSettings);
+    if (treeBuilt || !schema)
+        return;
+    treeBuilt = true;
 
-    // read settings from json
-    auto settings = Dtk::Core::DSettings::fromJsonFile(":/resources/data/dfm-settings.json");
-    settings->setBackend(backend);
+    for (auto groupJson : schema->meta().value("groups").toArray()) {
+        auto group = DSettingsGroup::fromJson("", groupJson.toObject());
+        group->setParent(q);
+        for (auto option : group->options()) {
+            options.insert(option->key(), option);
+        }
+        childGroupKeys << group->key();
+        childGroups.insert(group->key(), group);
+        indexGroup(group);
+    }
 
-    // read value
-    auto opt = settings->option("base.new_tab_windows.new_window_path");
-    qDebug() << opt->value();
+    optionIndex.reserve(options.size());
+    for (auto option : options.values()) {
+        const QString key = option->key();
+        optionIndex.insert(key, option);
 
-    // modify value
-    opt->setValue("Test")
-    qDebug() << opt->value();
-   @endcode
-   @sa Dtk::Core::DSettingsOption
-   @sa Dtk::Core::DSettingsGroup
-   @sa Dtk::Core::DSettingsBackend
-   @sa Dtk::Widget::DSettingsWidgetFactory
-   @sa Dtk::Widget::DSettingsDialog
- */
+        auto value = values.value(key);
+        if (value.isValid()) {
+            option->blockSignals(true);
+            option->setValue(value);
+            option->blockSignals(false);
+        }
 
-/*!
-@~english
-  @fn virtual QStringList DSettingsBackend::keys() const = 0;
-  @brief return all key of storage.
- */
-/*!
-@~english
-  @fn virtual QVariant DSettingsBackend::getOption(const QString &key) const = 0;
-  @brief get value by \a key.
- */
-/*!
-@~english
-  @fn virtual void DSettingsBackend::doSync() = 0;
-  @brief do the real sync action.
- */
-/*!
-@~english
-  @fn virtual void DSettingsBackend::doSetOption(const QString &key, const QVariant &value) = 0;
-  @brief write \a key / \a value to storage.
- */
-/*!
-@~english
-  @fn void DSettingsBackend::optionChanged(const QString &key, const QVariant &value);
-  @brief emitted when option \a value changed.
- */
-/*!
-@~english
-  @fn void DSettingsBackend::sync();
-  @brief private signal, please do not use it.
- */
-/*!
-@~english
-  @fn void DSettingsBackend::setOption(const QString &key, const QVariant &value);
-  @brief private signal, please do not use it.
+        QObject::connect(option.data(), &DSettingsOption::valueChanged,
+        q, [this, key](QVariant value) {
+            updateValue(key, value);
+        });
+    }
+}
 
-  \internal
-  \a key \a value
- */
+void DSettingsPrivate::indexGroup(const GroupPtr &group)
+{
+    groupIndex.insert(group->key(), group);
+    for (const GroupPtr &child : group->childGroups())
+        indexGroup(child);
+}
 
 /*!
 @~english
@@ -245,7 +361,10 @@ DSettings::DSettings(QObject *parent) :
 
 DSettings::~DSettings()
 {
-
+    Q_D(DSettings);
+    // write the changes still queued in the backend
+    if (d->backend)
+        d->backend->flush();
 }
 
 void DSettings::setBackend(DSettingsBackend *backend)
@@ -256,7 +375,7 @@ void DSettings::setBackend(DSettingsBackend *backend)
     }
 
     if (d->backend != nullptr) {
-        qWarning() << "set backend to exist " << d->backend;
+        qWarning() << "set backend to exist " << d->backend.data();
     }
 
     d->backend = backend;
@@ -267,7 +386,7 @@ void DSettings::setBackend(DSettingsBackend *backend)
 
     connect(d->backend, &DSettingsBackend::optionChanged,
     this, [ = ](const QString & key, const QVariant & value) {
-        option(key)->setValue(value);
+        setOption(key, value);
     });
     // exit and delete thread
     connect(this, &DSettings::destroyed, this, [backendWriteThread](){
@@ -295,56 +414,78 @@ QPointer<DSettings> DSettings::fromJson(const QByteArray &json)
     return settingsPtr;
 }
 
+/*!
+@~english
+   @brief Get DSettings from the json file at \a filepath. The returned data needs to be manually released after use.
+
+   The file is parsed once and the result is shared by all the DSettings
+   loaded from it, until the file changes.
+ */
 QPointer<DSettings> DSettings::fromJsonFile(const QString &filepath)
 {
-    QFile jsonFile(filepath);
-    jsonFile.open(QIODevice::ReadOnly);
-    auto jsonData = jsonFile.readAll();
-    jsonFile.close();
+    auto settingsPtr = QPointer<DSettings>(new DSettings);
+    settingsPtr->d_func()->schema = DSettingsSchema::fromJsonFile(filepath);
+    return settingsPtr;
+}
+
+/*!
+@~english
+   @brief Get DSettings from the \a schema generated by dtk-settings-tools --schema.
+   The returned data needs to be manually released after use.
 
-    return DSettings::fromJson(jsonData);
+   The keys and the default values are read from the static data, the json
+   description is only parsed when meta() or the option objects are needed.
+@code
+    extern const Dtk::Core::DSettingsCompiledSchema dfm_settings;
+    auto settings = Dtk::Core::DSettings::fromCompiled(dfm_settings);
+@endcode
+ */
+QPointer<DSettings> DSettings::fromCompiled(const DSettingsCompiledSchema &schema)
+{
+    auto settingsPtr = QPointer<DSettings>(new DSettings);
+    settingsPtr->d_func()->schema = DSettingsSchema::fromCompiled(schema);
+    return settingsPtr;
 }
 
 QJsonObject DSettings::meta() const
 {
     Q_D(const DSettings);
-    return d->meta;
+    return d->schema ? d->schema->meta() : QJsonObject();
 }
 
 QStringList DSettings::keys() const
 {
     Q_D(const DSettings);
-    return d->options.keys();
+    return d->schema ? d->schema->keys : QStringList();
 }
 
 QPointer<DSettingsOption> DSettings::option(const QString &key) const
 {
     Q_D(const DSettings);
-    return d->options.value(key);
+    const_cast<DSettingsPrivate *>(d)->ensureTree();
+    return d->optionIndex.value(key);
 }
 
 QVariant DSettings::value(const QString &key) const
 {
     Q_D(const DSettings);
-    auto opt = d->options.value(key);
-    if (opt.isNull()) {
-        return QVariant();
-    }
-
-    return opt->value();
+    return d->value(key);
 }
 
 QStringList DSettings::groupKeys() const
 {
     Q_D(const DSettings);
+    const_cast<DSettingsPrivate *>(d)->ensureTree();
     return d->childGroupKeys;
 }
 
 QList<QPointer<DSettingsGroup> > DSettings::groups() const
 {
     Q_D(const DSettings);
+    const_cast<DSettingsPrivate *>(d)->ensureTree();
     return d->childGroups.values();
 }
+
 /*!
 @~english
   @brief DSettings::group will recurrence find childGroup
@@ -354,37 +495,42 @@ QList<QPointer<DSettingsGroup> > DSettings::groups() const
 QPointer<DSettingsGroup> DSettings::group(const QString &key) const
 {
     Q_D(const DSettings);
-    auto childKeylist = key.split(".");
-    if (0 >= childKeylist.length()) {
-        return nullptr;
-    }
-
-    auto mainGroupKey = childKeylist.value(0);
-    if (1 >= childKeylist.length()) {
-        return d->childGroups.value(mainGroupKey);
-    }
-
-    return d->childGroups.value(mainGroupKey)->childGroup(key);
+    const_cast<DSettingsPrivate *>(d)->ensureTree();
+    return d->groupIndex.value(key);
 }
 
 QList<QPointer<DSettingsOption> > DSettings::options() const
 {
     Q_D(const DSettings);
+    const_cast<DSettingsPrivate *>(d)->ensureTree();
     return d->options.values();
 }
 
 QVariant DSettings::getOption(const QString &key) const
 {
-    QPointer<DSettingsOption> optionPointer = option(key);
-    if (optionPointer) {
-        return optionPointer->value();
-    }
-    return QVariant();
+    Q_D(const DSettings);
+    return d->value(key);
 }
 
 void DSettings::setOption(const QString &key, const QVariant &value)
 {
-    option(key)->setValue(value);
+    Q_D(DSettings);
+    if (!d->schema || !d->schema->options.contains(key)) {
+        qWarning() << "no such option:" << key;
+        return;
+    }
+
+    if (d->treeBuilt) {
+        // the option forwards the change through its valueChanged
+        d->optionIndex.value(key)->setValue(value);
+        return;
+    }
+
+    if (d->value(key) == value) {
+        return;
+    }
+
+    d->updateValue(key, value);
 }
 
 void DSettings::sync()
@@ -395,16 +541,19 @@ void DSettings::sync()
         return;
     }
 
-    d->backend->doSync();
+    d->backend->flush();
 }
 
 void DSettings::reset()
 {
     Q_D(DSettings);
 
-    for (auto option : d->options) {
-        if (option->canReset()) {
-            setOption(option->key(), option->defaultValue());
+    if (d->schema) {
+        for (const QString &key : d->schema->keys) {
+            const auto option = d->schema->options.value(key);
+            if (option.canReset) {
+                setOption(key, option.defaultValue);
+            }
         }
     }
 
@@ -419,32 +568,7 @@ void DSettings::reset()
 void DSettings::parseJson(const QByteArray &json)
 {
     Q_D(DSettings);
-
-    auto jsonDoc = QJsonDocument::fromJson(json);
-    d->meta = jsonDoc.object();
-    auto mainGroups = d->meta.value("groups");
-    for (auto groupJson : mainGroups.toArray()) {
-        auto group = DSettingsGroup::fromJson("", groupJson.toObject());
-        group->setParent(this);
-        for (auto option : group->options()) {
-            d->options.insert(option->key(), option);
-        }
-        d->childGroupKeys << group->key();
-        d->childGroups.insert(group->key(), group);
-    }
-
-    for (auto option :  d->options.values()) {
-        d->options.insert(option->key(), option);
-        connect(option.data(), &DSettingsOption::valueChanged,
-        this, [ = ](QVariant value) {
-            if (d->backend) {
-                Q_EMIT d->backend->setOption(option->key(), value);
-            } else {
-                qWarning() << "backend was not setted..!";
-            }
-            Q_EMIT valueChanged(option->key(), value);
-        });
-    }
+    d->schema = DSettingsSchema::fromJson(json);
 }
 
 void DSettings::loadValue()
@@ -457,15 +581,16 @@ void DSettings::loadValue()
 
     for (auto key : d->backend->keys()) {
         auto value = d->backend->getOption(key);
-        auto opt = option(key);
-        if (!value.isValid() || opt.isNull()) {
+        if (!value.isValid() || !d->schema || !d->schema->options.contains(key)) {
             continue;
         }
 
-        opt->blockSignals(true);
-        opt->setValue(value);
-        opt->blockSignals(false);
+        d->values.insert(key, value);
+        if (auto opt = d->optionIndex.value(key)) {
+            opt->blockSignals(true);
+            opt->setValue(value);
+            opt->blockSignals(false);
+        }
     }
 }
 
-DCORE_END_NAMESPACE
@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: 2016 - 2022 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dsettingsbackend.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QTimer>
+#include <QVariant>
+
+DCORE_BEGIN_NAMESPACE
+
+class DSettingsBackendQueue;
+
+// DSettingsBackend has no d-pointer, the queue of each backend is found here
+struct DSettingsBackendQueues
+{
+    QMutex mutex;
+    QHash<const DSettingsBackend *, DSettingsBackendQueue *> queues;
+};
+Q_GLOBAL_STATIC(DSettingsBackendQueues, backendQueues)
+
+class DSettingsBackendQueue : public QObject
+{
+public:
+    explicit DSettingsBackendQueue(DSettingsBackend *backend);
+    ~DSettingsBackendQueue() override;
+
+    static DSettingsBackendQueue *of(const DSettingsBackend *backend);
+
+    void enqueue(const QString &key, const QVariant &value);
+    void writePending(bool sync);
+
+    DSettingsBackend    *backend;
+    // the timer is a child, so it follows the backend in moveToThread
+    QTimer              *writeTimer;
+
+    // filled by the thread emitting setOption, drained in the thread of the backend
+    QMutex              pendingMutex;
+    QStringList         pendingKeys;
+    QHash<QString, QVariant> pendingValues;
+};
+
+DSettingsBackendQueue::DSettingsBackendQueue(DSettingsBackend *backend)
+    : QObject(backend)
+    , backend(backend)
+    , writeTimer(new QTimer(this))
+{
+    writeTimer->setSingleShot(true);
+    writeTimer->setInterval(200);
+    connect(writeTimer, &QTimer::timeout, this, [this]() {
+        writePending(false);
+    });
+
+    QMutexLocker locker(&backendQueues->mutex);
+    backendQueues->queues.insert(backend, this);
+}
+
+DSettingsBackendQueue::~DSettingsBackendQueue()
+{
+    if (backendQueues.isDestroyed())
+        return;
+
+    QMutexLocker locker(&backendQueues->mutex);
+    backendQueues->queues.remove(backend);
+}
+
+DSettingsBackendQueue *DSettingsBackendQueue::of(const DSettingsBackend *backend)
+{
+    if (backendQueues.isDestroyed())
+        return nullptr;
+
+    QMutexLocker locker(&backendQueues->mutex);
+    return backendQueues->queues.value(backend);
+}
+
+void DSettingsBackendQueue::enqueue(const QString &key, const QVariant &value)
+{
+    QMutexLocker locker(&pendingMutex);
+    const bool schedule = pendingKeys.isEmpty();
+    if (!pendingValues.contains(key))
+        pendingKeys << key;
+    pendingValues.insert(key, value);
+    locker.unlock();
+
+    // the timer can only be started in its own thread
+    if (schedule) {
+        QMetaObject::invokeMethod(writeTimer, [this]() {
+            if (!writeTimer->isActive())
+                writeTimer->start();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void DSettingsBackendQueue::writePending(bool sync)
+{
+    if (writeTimer->thread() == QThread::currentThread())
+        writeTimer->stop();
+
+    QMutexLocker locker(&pendingMutex);
+    const QStringList keys = pendingKeys;
+    const QHash<QString, QVariant> values = pendingValues;
+    pendingKeys.clear();
+    pendingValues.clear();
+    locker.unlock();
+
+    if (keys.isEmpty() && !sync)
+        return;
+
+    for (const QString &key : keys)
+        backend->doSetOption(key, values.value(key));
+
+    backend->doSync();
+}
+
+void DSettingsBackend::initWriteQueue()
+{
+    auto queue = new DSettingsBackendQueue(this);
+
+    connect(this, &DSettingsBackend::sync, queue, [queue]() {
+        queue->writePending(true);
+    }, Qt::QueuedConnection);
+    // queued under a lock in the emitting thread, so flush() can drain it
+    // even when the thread of the backend has stopped
+    connect(this, &DSettingsBackend::setOption, queue, [queue](const QString &key, const QVariant &value) {
+        queue->enqueue(key, value);
+    }, Qt::DirectConnection);
+}
+
+/*!
+@~english
+  @brief Milliseconds the queued changes wait before being written, 200 by default.
+ */
+int DSettingsBackend::writeDelay() const
+{
+    auto queue = DSettingsBackendQueue::of(this);
+    return queue ? queue->writeTimer->interval() : 0;
+}
+
+/*!
+@~english
+  @brief Set the delay of the queued changes to \a msec milliseconds.
+
+  With 0 the changes are written once the thread of the backend is idle.
+  Call it before DSettings::setBackend().
+ */
+void DSettingsBackend::setWriteDelay(int msec)
+{
+    if (auto queue = DSettingsBackendQueue::of(this))
+        queue->writeTimer->setInterval(qMax(0, msec));
+}
+
+/*!
+@~english
+  @brief Write the queued changes and sync the storage, blocks until done.
+
+  The changes sent by DSettings are queued for the thread of the backend,
+  only the last value of each key is kept. They are written after
+  writeDelay() milliseconds, or by flush().
+
+  Call it before shutdown so no change is lost. It is safe to call from
+  any thread; when the thread of the backend has stopped the changes are
+  written in the calling thread.
+ */
+void DSettingsBackend::flush()
+{
+    auto queue = DSettingsBackendQueue::of(this);
+    if (thread() == QThread::currentThread() || !thread()->isRunning()) {
+        if (queue) {
+            queue->writePending(true);
+        } else {
+            // built against the old header, setOption() is posted to doSetOption()
+            if (thread() == QThread::currentThread())
+                QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+            doSync();
+        }
+        return;
+    }
+
+    QMetaObject::invokeMethod(this, [this]() {
+        flush();
+    }, Qt::BlockingQueuedConnection);
+}
+
+DCORE_END_NAMESPACE
@@ -4,6 +4,9 @@
 
 #include "dabstractunitformatter.h"
 
+#include <QString>
+#include <QVarLengthArray>
+
 DCORE_BEGIN_NAMESPACE
 
 /*!
@@ -103,15 +106,28 @@ qreal DAbstractUnitFormatter::formatAs(qreal value, int currentUnit,
  */
 QPair<qreal, int> DAbstractUnitFormatter::format(const qreal value,
                                                  const int unit) const {
+  const int minUnit = unitMin();
+  const int maxUnit = unitMax();
+  qreal v = value;
+  int u = unit;
+
   // can convert to smaller unit
-  if (unit > unitMin() && value < unitValueMin(unit))
-    return format(value * unitConvertRate(unit - 1), unit - 1);
+  if (u > minUnit && v < unitValueMin(u)) {
+    do {
+      v *= unitConvertRate(u - 1);
+      --u;
+    } while (u > minUnit && v < unitValueMin(u));
+
+    return QPair<qreal, int>(v, u);
+  }
 
   // can convert to bigger unit
-  if (unit < unitMax() && value > unitValueMax(unit))
-    return format(value / unitConvertRate(unit), unit + 1);
+  while (u < maxUnit && v > unitValueMax(u)) {
+    v /= unitConvertRate(u);
+    ++u;
+  }
 
-  return QPair<qreal, int>(value, unit);
+  return QPair<qreal, int>(v, u);
 }
 
 /*!
@@ -124,34 +140,125 @@ QPair<qreal, int> DAbstractUnitFormatter::format(const qreal value,
  */
 QList<QPair<qreal, int>>
 DAbstractUnitFormatter::formatAsUnitList(const qreal value, int unit) const {
-  if (qFuzzyIsNull(value))
-    return QList<QPair<qreal, int>>();
+  const int minUnit = unitMin();
+  const int maxUnit = unitMax();
+  QList<QPair<qreal, int>> ret;
+  QVarLengthArray<QPair<qreal, int>, 8> parts;
+  qreal v = value;
 
-  if (value < unitValueMin(unit) || unit == unitMin()) {
-    if (unit != unitMin())
-      return formatAsUnitList(value * unitConvertRate(unit - 1), unit - 1);
-    else
-      return std::move(QList<QPair<qreal, int>>()
-                       << QPair<qreal, int>(value, unit));
+  while (!qFuzzyIsNull(v)) {
+    if (unit == minUnit) {
+      ret.append(QPair<qreal, int>(v, unit));
+      break;
+    }
+
+    if (v < unitValueMin(unit)) {
+      v *= unitConvertRate(unit - 1);
+      --unit;
+      continue;
+    }
+
+    // split the integral part from unit up to the biggest unit, the fraction
+    // is converted to the smaller units in the next rounds
+    ulong _value = ulong(v);
+    v -= _value;
+
+    int u = unit;
+    parts.clear();
+    while (_value && u != maxUnit) {
+      const ulong rate = unitConvertRate(u);
+      const ulong r = _value % rate;
+      if (r)
+        parts.append(QPair<qreal, int>(r, u));
+
+      u += 1;
+      _value /= rate;
+    }
+
+    if (_value)
+      parts.append(QPair<qreal, int>(_value, u));
+
+    for (int i = parts.size() - 1; i >= 0; --i)
+      ret.append(parts.at(i));
   }
 
-  ulong _value = ulong(value);
-  QList<QPair<qreal, int>> ret = formatAsUnitList(value - _value, unit);
+  return ret;
+}
+
+/*!
+  @~english
+  @brief Format \a count values in the unit \a unit at once.
+
+  Every value is converted by format() and written as "value unit" into the
+  string at the same index of \a results, which must hold at least \a count
+  strings. The strings are truncated but not released, so reusing the same
+  results keeps their memory, and unitStr() is called once for each unit.
+  @param[in] values the values to format
+  @param[in] count the count of values
+  @param[in] unit the unit of all the values
+  @param[out] results the strings to write to
+  @param[in] precision the count of decimals, or -1 for at most 6 significant digits
+ */
+void DAbstractUnitFormatter::formatMany(const qreal *values, int count, int unit,
+                                        QString *results, int precision) const {
+  Q_ASSERT(count >= 0);
+  const int minUnit = unitMin();
+  QVarLengthArray<QString, 8> unitStrs(unitMax() - minUnit + 1);
+
+  for (int i = 0; i < count; ++i) {
+    const QPair<qreal, int> pair = format(values[i], unit);
+    QString &out = results[i];
+    out.truncate(0);
+
+    if (precision < 0)
+      out.append(QString::number(pair.first, 'g', 6));
+    else
+      appendNumber(out, pair.first, precision);
+
+    QString &str = unitStrs[pair.second - minUnit];
+    if (str.isNull())
+      str = unitStr(pair.second);
+
+    out.append(QLatin1Char(' '));
+    out.append(str);
+  }
+}
 
-  while (_value && unit != unitMax()) {
-    const ulong rate = unitConvertRate(unit);
-    const ulong r = _value % rate;
-    if (r)
-      ret.push_front(QPair<qreal, int>(r, unit));
+/*!
+  @~english
+  @brief Append \a value with \a precision decimals to \a out without
+  creating any temporary string, the number is rounded half away from zero.
+ */
+void DAbstractUnitFormatter::appendNumber(QString &out, qreal value,
+                                          int precision) {
+  static const quint64 Scales[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+  precision = qBound(0, precision, 6);
 
-    unit += 1;
-    _value /= rate;
+  if (value < 0) {
+    out.append(QLatin1Char('-'));
+    value = -value;
   }
 
-  if (_value)
-    ret.push_front(QPair<qreal, int>(_value, unit));
+  const quint64 scale = Scales[precision];
+  const quint64 n = quint64(value * scale + 0.5);
+  quint64 integral = n / scale;
+  quint64 fraction = n % scale;
 
-  return ret;
+  // 20 digits for the integral part, the point and 6 decimals
+  QChar buffer[27];
+  int pos = 27;
+  for (int i = 0; i < precision; ++i) {
+    buffer[--pos] = QLatin1Char(char('0' + fraction % 10));
+    fraction /= 10;
+  }
+  if (precision > 0)
+    buffer[--pos] = QLatin1Char('.');
+  do {
+    buffer[--pos] = QLatin1Char(char('0' + integral % 10));
+    integral /= 10;
+  } while (integral);
+
+  out.append(buffer + pos, 27 - pos);
 }
 
 DCORE_END_NAMESPACE
@@ -0,0 +1,240 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "ddbuscalltrace.h"
+#include "ddbuscalltrace_p.h"
+#include "../dtracespan_p.h"
+
+#include <QCoreApplication>
+#include <QDBusPendingCallWatcher>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QThread>
+
+#include <algorithm>
+
+DCORE_BEGIN_NAMESPACE
+
+#ifdef QT_DEBUG
+Q_LOGGING_CATEGORY(logDBusTrace, "dtk.core.dbus.trace")
+#else
+Q_LOGGING_CATEGORY(logDBusTrace, "dtk.core.dbus.trace", QtInfoMsg)
+#endif
+
+std::atomic<int> DDBusCallSpan::s_state {DDBusCallSpan::Unknown};
+
+// the upper bounds of the histogram buckets in milliseconds, the last one is unbounded.
+static const int BucketBounds[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+static const int BucketCount = sizeof(BucketBounds) / sizeof(BucketBounds[0]) + 1;
+
+struct CallStatistics
+{
+    quint64 count = 0;
+    quint64 blocking = 0;
+    qint64 totalUs = 0;
+    qint64 maxUs = 0;
+    quint64 buckets[BucketCount] = {};
+};
+
+struct CallTraceData
+{
+    QMutex mutex;
+    // keyed by "<service> <interface>.<method>", the paths differ by the objects.
+    QHash<QString, CallStatistics> statistics;
+    std::atomic<int> blockingThreshold {50};
+};
+
+static CallTraceData *traceData()
+{
+    // it's never deleted, the calls may finish in the destructors of static objects.
+    static CallTraceData *data = new CallTraceData;
+    return data;
+}
+
+static void printSummary()
+{
+    qCInfo(logDBusTrace).noquote() << DDBusCallTrace::summary();
+}
+
+bool DDBusCallSpan::initialize()
+{
+    static QBasicMutex mutex;
+    QMutexLocker locker(&mutex);
+    if (s_state.load() != Unknown)
+        return s_state.load() == Enabled;
+
+    if (qEnvironmentVariableIsSet("DTK_DBUS_TRACE_BLOCKING_MS"))
+        traceData()->blockingThreshold.store(qEnvironmentVariableIntValue("DTK_DBUS_TRACE_BLOCKING_MS"));
+
+    if (qEnvironmentVariableIntValue("DTK_DBUS_TRACE") != 1) {
+        s_state.store(Disabled);
+        return false;
+    }
+
+    // the summary of the whole run is printed when the application quits.
+    qAddPostRoutine(printSummary);
+    s_state.store(Enabled);
+    return true;
+}
+
+static void recordCall(const QString &service, const QString &path, const QString &method,
+                       bool blocking, qint64 start, qint64 end)
+{
+    const qint64 duration = end - start;
+
+    if (DTraceSpan::isEnabled()) {
+        DTraceSpan::record("dbus", blocking ? "blocking call" : "async call",
+                           QStringLiteral("%1 %2 %3").arg(service, path, method), start, end);
+    }
+
+    CallTraceData *data = traceData();
+    int bucket = 0;
+    while (bucket < BucketCount - 1 && duration >= BucketBounds[bucket] * 1000)
+        ++bucket;
+    {
+        QMutexLocker locker(&data->mutex);
+        CallStatistics &statistics = data->statistics[service + QLatin1Char(' ') + method];
+        ++statistics.count;
+        if (blocking)
+            ++statistics.blocking;
+        statistics.totalUs += duration;
+        statistics.maxUs = qMax(statistics.maxUs, duration);
+        ++statistics.buckets[bucket];
+    }
+
+    // a blocking call on the main thread freezes the UI.
+    if (!blocking)
+        return;
+    const int threshold = data->blockingThreshold.load(std::memory_order_relaxed);
+    if (threshold < 0 || duration < threshold * 1000)
+        return;
+    const QCoreApplication *app = QCoreApplication::instance();
+    if (app && app->thread() == QThread::currentThread()) {
+        qCWarning(logDBusTrace, "The blocking D-Bus call %s %s %s took %lld ms on the main thread",
+                  qPrintable(service), qPrintable(path), qPrintable(method), duration / 1000);
+    }
+}
+
+void DDBusCallSpan::start(const QString &service, const QString &path, const QString &interface, const QString &method)
+{
+    m_service = service;
+    m_path = path;
+    m_method = interface.isEmpty() ? method : interface + QLatin1Char('.') + method;
+    m_start = DTraceSpan::timestamp();
+}
+
+void DDBusCallSpan::finish()
+{
+    recordCall(m_service, m_path, m_method, true, m_start, DTraceSpan::timestamp());
+}
+
+void DDBusCallSpan::traceAsync(const QDBusPendingCall &call, const QDBusMessage &message)
+{
+    const qint64 start = DTraceSpan::timestamp();
+    const QString service = message.service();
+    const QString path = message.path();
+    const QString method = message.interface().isEmpty() ? message.member()
+                                                         : message.interface() + QLatin1Char('.') + message.member();
+
+    // the duration includes the time until the reply is delivered by the event loop.
+    auto watcher = new QDBusPendingCallWatcher(call);
+    QObject::connect(watcher, &QDBusPendingCallWatcher::finished, watcher,
+                     [service, path, method, start](QDBusPendingCallWatcher *watcher) {
+        recordCall(service, path, method, false, start, DTraceSpan::timestamp());
+        watcher->deleteLater();
+    });
+}
+
+/*!
+@~english
+  @class Dtk::Core::DDBusCallTrace
+  @brief The latency tracing of the D-Bus calls made by dtkcore.
+
+  It's disabled by default, and it's enabled by `DTK_DBUS_TRACE=1` or setEnabled().
+  Every call is recorded in a histogram of its method, the spans are also written
+  to the trace file when `DTK_TRACE_FILE` is set. A blocking call on the main thread
+  which takes longer than blockingThreshold() is warned in the `dtk.core.dbus.trace` category.
+ */
+
+bool DDBusCallTrace::isEnabled()
+{
+    return DDBusCallSpan::isEnabled();
+}
+
+void DDBusCallTrace::setEnabled(bool enabled)
+{
+    // read the environment first, so that it doesn't override this later.
+    DDBusCallSpan::isEnabled();
+    DDBusCallSpan::s_state.store(enabled ? DDBusCallSpan::Enabled : DDBusCallSpan::Disabled);
+}
+
+/*!
+@~english
+  @brief The duration in milliseconds a blocking call on the main thread is warned from, 50 by default.
+
+  It's set by `DTK_DBUS_TRACE_BLOCKING_MS` too, a negative value disables the warning.
+ */
+int DDBusCallTrace::blockingThreshold()
+{
+    DDBusCallSpan::isEnabled();
+    return traceData()->blockingThreshold.load();
+}
+
+void DDBusCallTrace::setBlockingThreshold(int msec)
+{
+    DDBusCallSpan::isEnabled();
+    traceData()->blockingThreshold.store(msec);
+}
+
+/*!
+@~english
+  @brief The histogram of the recorded calls, one line for each method sorted by the total time.
+ */
+QString DDBusCallTrace::summary()
+{
+    CallTraceData *data = traceData();
+    QList<QPair<QString, CallStatistics>> methods;
+    {
+        QMutexLocker locker(&data->mutex);
+        for (auto it = data->statistics.constBegin(); it != data->statistics.constEnd(); ++it)
+            methods.append({it.key(), it.value()});
+    }
+    std::sort(methods.begin(), methods.end(), [](const QPair<QString, CallStatistics> &a,
+                                                 const QPair<QString, CallStatistics> &b) {
+        return a.second.totalUs > b.second.totalUs;
+    });
+
+    QStringList lines;
+    lines << QStringLiteral("D-Bus calls: %1 methods").arg(methods.size());
+    for (const auto &method : std::as_const(methods)) {
+        const CallStatistics &statistics = method.second;
+        QStringList buckets;
+        for (int i = 0; i < BucketCount; ++i) {
+            if (!statistics.buckets[i])
+                continue;
+            const QString bound = i < BucketCount - 1 ? QStringLiteral("<%1ms").arg(BucketBounds[i])
+                                                      : QStringLiteral(">=%1ms").arg(BucketBounds[i - 1]);
+            buckets << QStringLiteral("%1:%2").arg(bound).arg(statistics.buckets[i]);
+        }
+        lines << QStringLiteral("  %1: %2 calls (%3 blocking), total %4 ms, avg %5 ms, max %6 ms, %7")
+                     .arg(method.first)
+                     .arg(statistics.count)
+                     .arg(statistics.blocking)
+                     .arg(statistics.totalUs / 1000.0, 0, 'f', 1)
+                     .arg(statistics.totalUs / 1000.0 / statistics.count, 0, 'f', 2)
+                     .arg(statistics.maxUs / 1000.0, 0, 'f', 1)
+                     .arg(buckets.join(QLatin1Char(' ')));
+    }
+    return lines.join(QLatin1Char('\n'));
+}
+
+void DDBusCallTrace::reset()
+{
+    CallTraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+    data->statistics.clear();
+}
+
+DCORE_END_NAMESPACE
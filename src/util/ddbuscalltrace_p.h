@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <dtkcore_global.h>
+
+#include <QDBusAbstractInterface>
+#include <QDBusMessage>
+#include <QDBusPendingCall>
+#include <QString>
+
+#include <atomic>
+
+DCORE_BEGIN_NAMESPACE
+
+/*
+ * A scoped span of a blocking D-Bus call, it measures the time until it's destroyed.
+ * When the tracing is disabled, a span only reads an atomic flag.
+ */
+class Q_DECL_HIDDEN DDBusCallSpan
+{
+public:
+    inline DDBusCallSpan(const QString &service, const QString &path, const QString &interface, const QString &method)
+    {
+        if (Q_LIKELY(!isEnabled()))
+            return;
+        start(service, path, interface, method);
+    }
+
+    inline explicit DDBusCallSpan(const QDBusMessage &call)
+    {
+        if (Q_LIKELY(!isEnabled()))
+            return;
+        start(call.service(), call.path(), call.interface(), call.member());
+    }
+
+    inline DDBusCallSpan(const QDBusAbstractInterface *interface, const char *method)
+    {
+        if (Q_LIKELY(!isEnabled()))
+            return;
+        start(interface->service(), interface->path(), interface->interface(), QLatin1String(method));
+    }
+
+    inline ~DDBusCallSpan()
+    {
+        if (Q_UNLIKELY(m_start >= 0))
+            finish();
+    }
+
+    static inline bool isEnabled()
+    {
+        const int state = s_state.load(std::memory_order_relaxed);
+        if (Q_LIKELY(state == Disabled))
+            return false;
+        return state == Enabled || initialize();
+    }
+
+    // records the asynchronous \a call when its reply is delivered to the current thread.
+    static inline QDBusPendingCall trace(const QDBusPendingCall &call, const QDBusMessage &message)
+    {
+        if (Q_UNLIKELY(isEnabled()))
+            traceAsync(call, message);
+        return call;
+    }
+
+    enum State {
+        Unknown,
+        Disabled,
+        Enabled
+    };
+    static std::atomic<int> s_state;
+
+private:
+    Q_DISABLE_COPY(DDBusCallSpan)
+
+    static bool initialize();
+    static void traceAsync(const QDBusPendingCall &call, const QDBusMessage &message);
+    void start(const QString &service, const QString &path, const QString &interface, const QString &method);
+    void finish();
+
+    QString m_service;
+    QString m_path;
+    QString m_method;
+    qint64 m_start = -1;
+};
+
+DCORE_END_NAMESPACE
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: LGPL-2.1-or-later
 
 #include "ddbusextendedpendingcallwatcher_p.h"
+#include "ddbuscalltrace_p.h"
 
 #include <DDBusExtendedAbstractInterface>
 
@@ -12,8 +13,14 @@
 #include <QtDBus/QDBusPendingCallWatcher>
 #include <QtDBus/QDBusPendingReply>
 
+#include <QtCore/QBitArray>
 #include <QtCore/QDebug>
+#include <QtCore/QHash>
 #include <QtCore/QMetaProperty>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+
+#include <atomic>
 
 DCORE_BEGIN_NAMESPACE
 
@@ -23,6 +30,207 @@ Q_GLOBAL_STATIC_WITH_ARGS(QByteArray, dBusPropertiesChangedSignal, ("PropertiesC
 Q_GLOBAL_STATIC_WITH_ARGS(QByteArray, propertyChangedSignature, ("propertyChanged(QString,QVariant)"))
 Q_GLOBAL_STATIC_WITH_ARGS(QByteArray, propertyInvalidatedSignature, ("propertyInvalidated(QString)"))
 
+// what demarshalling needs of a property, resolved once by its type
+class DDBusPropertyInfo
+{
+public:
+    explicit DDBusPropertyInfo(const QMetaProperty &property = QMetaProperty())
+        : metaProperty(property)
+        , userType(property.userType())
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        , expectedSignature(property.isValid() ? QDBusMetaType::typeToSignature(property.metaType()) : nullptr)
+#else
+        , expectedSignature(property.isValid() ? QDBusMetaType::typeToSignature(property.userType()) : nullptr)
+#endif
+    {
+    }
+
+    QMetaProperty metaProperty;
+    int userType;
+    QByteArray expectedSignature;
+};
+
+// the properties of a meta object by name and by index, shared by all its instances
+class DDBusPropertyTable
+{
+public:
+    QHash<QString, int> indexes;
+    QVector<DDBusPropertyInfo> properties;
+};
+
+// the tables are built once for every meta object, the last one is cached by every thread
+static const DDBusPropertyTable *propertyTable(const QMetaObject *meta)
+{
+    static thread_local const QMetaObject *lastMeta = nullptr;
+    static thread_local const DDBusPropertyTable *lastTable = nullptr;
+    if (meta == lastMeta)
+        return lastTable;
+
+    static QMutex tablesLock;
+    static QHash<const QMetaObject *, DDBusPropertyTable *> tables;
+
+    QMutexLocker locker(&tablesLock);
+    auto table = tables.value(meta);
+    if (!table) {
+        // meta objects are static, so are their tables
+        table = new DDBusPropertyTable;
+        table->properties.reserve(meta->propertyCount());
+        for (int i = 0; i < meta->propertyCount(); ++i) {
+            table->indexes.insert(QString::fromLatin1(meta->property(i).name()), i);
+            table->properties << DDBusPropertyInfo(meta->property(i));
+        }
+        tables.insert(meta, table);
+    }
+
+    lastMeta = meta;
+    lastTable = table;
+    return table;
+}
+
+static int propertyIndexOf(const QMetaObject *meta, const QString &propertyName)
+{
+    return propertyTable(meta)->indexes.value(propertyName, -1);
+}
+
+/*
+ * The properties fetched by GetAll or PropertiesChanged of the interfaces in prefetch mode, by
+ * property index. It's kept out of the class to keep the layout of the exported class, which is
+ * subclassed by the generated proxies, an interface is in it only while prefetching.
+ */
+class DDBusPrefetchStates
+{
+public:
+    QMutex mutex;
+    QHash<const DDBusExtendedAbstractInterface *, QBitArray> fetched;
+};
+
+Q_GLOBAL_STATIC(DDBusPrefetchStates, prefetchStates)
+// the lookup is skipped if no interface is prefetching
+static std::atomic<int> prefetchingCount{0};
+
+static bool isPrefetching(const DDBusExtendedAbstractInterface *interface)
+{
+    if (prefetchingCount.load(std::memory_order_relaxed) == 0)
+        return false;
+
+    QMutexLocker locker(&prefetchStates->mutex);
+    return prefetchStates->fetched.contains(interface);
+}
+
+static bool isFetched(const DDBusExtendedAbstractInterface *interface, int index)
+{
+    if (index < 0 || prefetchingCount.load(std::memory_order_relaxed) == 0)
+        return false;
+
+    QMutexLocker locker(&prefetchStates->mutex);
+    const auto it = prefetchStates->fetched.constFind(interface);
+    return it != prefetchStates->fetched.constEnd() && index < it->size() && it->testBit(index);
+}
+
+static void setFetched(const DDBusExtendedAbstractInterface *interface, int index, bool fetched)
+{
+    if (prefetchingCount.load(std::memory_order_relaxed) == 0)
+        return;
+
+    QMutexLocker locker(&prefetchStates->mutex);
+    const auto it = prefetchStates->fetched.find(interface);
+    if (it == prefetchStates->fetched.end())
+        return;
+
+    if (index < 0) {
+        it->fill(false);
+        return;
+    }
+    if (it->size() <= index)
+        it->resize(interface->metaObject()->propertyCount());
+    it->setBit(index, fetched);
+}
+
+static QVariant demarshallProperty(const QString &interface,
+                                   const DDBusPropertyInfo &info,
+                                   const QVariant &value,
+                                   QDBusError *error)
+{
+    Q_ASSERT(error != 0);
+    const QMetaProperty &metaProperty = info.metaProperty;
+
+    if (value.userType() == info.userType) {
+        // No need demarshalling. Passing back straight away ...
+        *error = QDBusError();
+        return value;
+    }
+
+    QString errorMessage;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QVariant result = QVariant{metaProperty.metaType()};
+#else
+    QVariant result = QVariant(info.userType, (void *)0);
+#endif
+    // a type registered with Qt D-Bus after the table was built
+    const QByteArray signature = !info.expectedSignature.isEmpty() ? info.expectedSignature
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+                                                                   : QByteArray(QDBusMetaType::typeToSignature(metaProperty.metaType()));
+#else
+                                                                   : QByteArray(QDBusMetaType::typeToSignature(info.userType));
+#endif
+    const char *expectedSignature = signature.constData();
+    if (value.userType() == qMetaTypeId<QDBusArgument>()) {
+        // demarshalling a DBus argument ...
+        QDBusArgument dbusArg = value.value<QDBusArgument>();
+
+        if (signature == dbusArg.currentSignature().toLatin1()) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+            QDBusMetaType::demarshall(dbusArg, metaProperty.metaType(), result.data());
+#else
+            QDBusMetaType::demarshall(dbusArg, info.userType, result.data());
+#endif
+            if (!result.isValid()) {
+                errorMessage = QStringLiteral("Unexpected failure demarshalling "
+                                              "upon PropertiesChanged signal arrival "
+                                              "for property `%3.%4' (expected type `%5' (%6))")
+                                   .arg(interface,
+                                        QString::fromLatin1(metaProperty.name()),
+                                        QString::fromLatin1(metaProperty.typeName()),
+                                        expectedSignature);
+            }
+        } else {
+            errorMessage = QStringLiteral("Unexpected `user type' (%2) "
+                                          "upon PropertiesChanged signal arrival "
+                                          "for property `%3.%4' (expected type `%5' (%6))")
+                               .arg(dbusArg.currentSignature(),
+                                    interface,
+                                    QString::fromLatin1(metaProperty.name()),
+                                    QString::fromLatin1(metaProperty.typeName()),
+                                    QString::fromLatin1(expectedSignature));
+        }
+    } else {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        const char *actualSignature = QDBusMetaType::typeToSignature(value.metaType());
+#else
+        const char *actualSignature = QDBusMetaType::typeToSignature(value.userType());
+#endif
+
+        errorMessage = QStringLiteral("Unexpected `%1' (%2) "
+                                      "upon PropertiesChanged signal arrival "
+                                      "for property `%3.%4' (expected type `%5' (%6))")
+                           .arg(QString::fromLatin1(value.typeName()),
+                                QString::fromLatin1(actualSignature),
+                                interface,
+                                QString::fromLatin1(metaProperty.name()),
+                                QString::fromLatin1(metaProperty.typeName()),
+                                QString::fromLatin1(expectedSignature));
+    }
+
+    if (errorMessage.isEmpty()) {
+        *error = QDBusError();
+    } else {
+        *error = QDBusMessage::createError(QDBusError::InvalidSignature, errorMessage);
+        qDebug() << Q_FUNC_INFO << errorMessage;
+    }
+
+    return result;
+}
+
 DDBusExtendedAbstractInterface::DDBusExtendedAbstractInterface(
     const QString &service, const QString &path, const char *interface, const QDBusConnection &connection, QObject *parent)
     : QDBusAbstractInterface(service, path, interface, connection, parent)
@@ -40,7 +248,11 @@ DDBusExtendedAbstractInterface::DDBusExtendedAbstractInterface(
                  SLOT(onDBusNameOwnerChanged(QString, QString, QString)));
 }
 
-DDBusExtendedAbstractInterface::~DDBusExtendedAbstractInterface() {}
+DDBusExtendedAbstractInterface::~DDBusExtendedAbstractInterface()
+{
+    if (prefetchingCount.load(std::memory_order_relaxed) > 0 && !prefetchStates.isDestroyed())
+        setPrefetch(false);
+}
 
 void DDBusExtendedAbstractInterface::setSync(bool sync)
 {
@@ -63,6 +275,42 @@ void DDBusExtendedAbstractInterface::setSync(bool sync, bool autoStart)
         startServiceProcess();
 }
 
+/*
+ * @~english
+ * @note With prefetch, all the properties are fetched by one GetAll when
+ * it is set and whenever the service starts, and kept fresh by the
+ * PropertiesChanged signal. The getters of the fetched properties return
+ * the stored values without any D-Bus call, in sync mode as well.
+ */
+void DDBusExtendedAbstractInterface::setPrefetch(bool prefetch)
+{
+    {
+        QMutexLocker locker(&prefetchStates->mutex);
+        auto &fetched = prefetchStates->fetched;
+        if (fetched.contains(this) == prefetch)
+            return;
+
+        if (prefetch) {
+            fetched.insert(this, QBitArray(metaObject()->propertyCount()));
+            prefetchingCount.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            fetched.remove(this);
+            prefetchingCount.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // keep the fetched values fresh
+    connectPropertiesChanged();
+    if (isValid())
+        getAllProperties();
+}
+
+bool DDBusExtendedAbstractInterface::prefetch() const
+{
+    return isPrefetching(this);
+}
+
 void DDBusExtendedAbstractInterface::getAllProperties()
 {
     m_lastExtendedError = QDBusError();
@@ -83,7 +331,11 @@ void DDBusExtendedAbstractInterface::getAllProperties()
     msg << interface();
 
     if (m_sync) {
-        QDBusMessage reply = connection().call(msg);
+        QDBusMessage reply;
+        {
+            DDBusCallSpan span(msg);
+            reply = connection().call(msg);
+        }
 
         if (reply.type() != QDBusMessage::ReplyMessage) {
             m_lastExtendedError = QDBusError(reply);
@@ -102,7 +354,7 @@ void DDBusExtendedAbstractInterface::getAllProperties()
         QVariantMap value = reply.arguments().at(0).toMap();
         onPropertiesChanged(interface(), value, QStringList());
     } else {
-        QDBusPendingReply<QVariantMap> async = connection().asyncCall(msg);
+        QDBusPendingReply<QVariantMap> async = DDBusCallSpan::trace(connection().asyncCall(msg), msg);
         m_getAllPendingCallWatcher = new QDBusPendingCallWatcher(async, this);
 
         connect(m_getAllPendingCallWatcher,
@@ -118,18 +370,7 @@ void DDBusExtendedAbstractInterface::connectNotify(const QMetaMethod &signal)
     if (signal.methodType() == QMetaMethod::Signal && (signal.methodSignature() == *propertyChangedSignature() ||
                                                        signal.methodSignature() == *propertyInvalidatedSignature())) {
         if (!m_propertiesChangedConnected) {
-            QStringList argumentMatch;
-            argumentMatch << interface();
-            connection().connect(service(),
-                                 path(),
-                                 *dBusPropertiesInterface(),
-                                 *dBusPropertiesChangedSignal(),
-                                 argumentMatch,
-                                 QString(),
-                                 this,
-                                 SLOT(onPropertiesChanged(QString, QVariantMap, QStringList)));
-
-            m_propertiesChangedConnected = true;
+            connectPropertiesChanged();
             return;
         }
     } else {
@@ -137,11 +378,30 @@ void DDBusExtendedAbstractInterface::connectNotify(const QMetaMethod &signal)
     }
 }
 
+void DDBusExtendedAbstractInterface::connectPropertiesChanged()
+{
+    if (m_propertiesChangedConnected)
+        return;
+
+    QStringList argumentMatch;
+    argumentMatch << interface();
+    connection().connect(service(),
+                         path(),
+                         *dBusPropertiesInterface(),
+                         *dBusPropertiesChangedSignal(),
+                         argumentMatch,
+                         QString(),
+                         this,
+                         SLOT(onPropertiesChanged(QString, QVariantMap, QStringList)));
+
+    m_propertiesChangedConnected = true;
+}
+
 void DDBusExtendedAbstractInterface::disconnectNotify(const QMetaMethod &signal)
 {
     if (signal.methodType() == QMetaMethod::Signal && (signal.methodSignature() == *propertyChangedSignature() ||
                                                        signal.methodSignature() == *propertyInvalidatedSignature())) {
-        if (m_propertiesChangedConnected && 0 == receivers(propertyChangedSignature()->constData()) &&
+        if (m_propertiesChangedConnected && !prefetch() && 0 == receivers(propertyChangedSignature()->constData()) &&
             0 == receivers(propertyInvalidatedSignature()->constData())) {
             QStringList argumentMatch;
             argumentMatch << interface();
@@ -166,9 +426,9 @@ QVariant DDBusExtendedAbstractInterface::internalPropGet(const char *propname, v
 {
     m_lastExtendedError = QDBusError();
 
-    if (m_useCache) {
-        int propertyIndex = metaObject()->indexOfProperty(propname);
-        QMetaProperty metaProperty = metaObject()->property(propertyIndex);
+    const int index = propertyIndexOf(metaObject(), QString::fromLatin1(propname));
+    if (m_useCache || isFetched(this, index)) {
+        QMetaProperty metaProperty = metaObject()->property(index);
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
         return QVariant{metaProperty.metaType(), propertyPtr};
 #else
@@ -194,16 +454,14 @@ QVariant DDBusExtendedAbstractInterface::internalPropGet(const char *propname, v
             return QVariant();
         }
 
-        int propertyIndex = metaObject()->indexOfProperty(propname);
-
-        if (-1 == propertyIndex) {
+        if (-1 == index) {
             QString errorMessage = QStringLiteral("Got unknown property \"%1\" to read").arg(QString::fromLatin1(propname));
             m_lastExtendedError = QDBusMessage::createError(QDBusError::Failed, errorMessage);
             qWarning() << Q_FUNC_INFO << errorMessage;
             return QVariant();
         }
 
-        QMetaProperty metaProperty = metaObject()->property(propertyIndex);
+        QMetaProperty metaProperty = metaObject()->property(index);
 
         if (!metaProperty.isReadable()) {
             QString errorMessage = QStringLiteral("Property \"%1\" is NOT readable").arg(QString::fromLatin1(propname));
@@ -255,7 +513,7 @@ void DDBusExtendedAbstractInterface::internalPropSet(const char *propname, const
             return;
         }
 
-        int propertyIndex = metaObject()->indexOfProperty(propname);
+        int propertyIndex = propertyIndexOf(metaObject(), QString::fromLatin1(propname));
 
         if (-1 == propertyIndex) {
             QString errorMessage = QStringLiteral("Got unknown property \"%1\" to write").arg(QString::fromLatin1(propname));
@@ -286,10 +544,15 @@ void DDBusExtendedAbstractInterface::internalPropSet(const char *propname, const
 
 QVariant DDBusExtendedAbstractInterface::asyncProperty(const QString &propertyName)
 {
+    // a refresh at a high rate joins the Get on the way, no watcher per request
+    if (DDBusExtendedPendingCallWatcher::pendingGet(this, propertyName))
+        return QVariant();
+
     QDBusMessage msg = QDBusMessage::createMethodCall(service(), path(), *dBusPropertiesInterface(), QStringLiteral("Get"));
     msg << interface() << propertyName;
-    QDBusPendingReply<QVariant> async = connection().asyncCall(msg);
-    DDBusExtendedPendingCallWatcher *watcher = new DDBusExtendedPendingCallWatcher(async, propertyName, QVariant(), this);
+    QDBusPendingReply<QVariant> async = DDBusCallSpan::trace(connection().asyncCall(msg), msg);
+    DDBusExtendedPendingCallWatcher *watcher =
+        new DDBusExtendedPendingCallWatcher(async, propertyName, QVariant(), this, DDBusExtendedPendingCallWatcher::GetCall);
 
     connect(watcher, SIGNAL(finished(QDBusPendingCallWatcher *)), this, SLOT(onAsyncPropertyFinished(QDBusPendingCallWatcher *)));
 
@@ -301,7 +564,7 @@ void DDBusExtendedAbstractInterface::asyncSetProperty(const QString &propertyNam
     QDBusMessage msg = QDBusMessage::createMethodCall(service(), path(), *dBusPropertiesInterface(), QStringLiteral("Set"));
 
     msg << interface() << propertyName << QVariant::fromValue(QDBusVariant(value));
-    QDBusPendingReply<> async = connection().asyncCall(msg);
+    QDBusPendingReply<> async = DDBusCallSpan::trace(connection().asyncCall(msg), msg);
     DDBusExtendedPendingCallWatcher *watcher = new DDBusExtendedPendingCallWatcher(async, propertyName, value, this);
 
     connect(
@@ -320,7 +583,7 @@ void DDBusExtendedAbstractInterface::startServiceProcess()
     QDBusMessage msg =
         QDBusMessage::createMethodCall("org.freedesktop.DBus", "/", *dBusInterface(), QStringLiteral("StartServiceByName"));
     msg << servName << quint32(0);
-    QDBusPendingReply<quint32> async = connection().asyncCall(msg);
+    QDBusPendingReply<quint32> async = DDBusCallSpan::trace(connection().asyncCall(msg), msg);
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(async, this);
 
     connect(watcher, &QDBusPendingCallWatcher::finished, this, &DDBusExtendedAbstractInterface::onStartServiceProcessFinished);
@@ -351,8 +614,8 @@ void DDBusExtendedAbstractInterface::onAsyncPropertyFinished(QDBusPendingCallWat
     if (reply.isError()) {
         m_lastExtendedError = reply.error();
     } else {
-        int propertyIndex = metaObject()->indexOfProperty(watcher->asyncProperty().toLatin1().constData());
-        QVariant value = demarshall(interface(), metaObject()->property(propertyIndex), reply.value(), &m_lastExtendedError);
+        int propertyIndex = propertyIndexOf(metaObject(), watcher->asyncProperty());
+        QVariant value = demarshallProperty(interface(), propertyTable(metaObject())->properties.at(propertyIndex), reply.value(), &m_lastExtendedError);
 
         if (m_lastExtendedError.isValid()) {
             Q_EMIT propertyInvalidated(watcher->asyncProperty());
@@ -418,17 +681,20 @@ void DDBusExtendedAbstractInterface::onPropertiesChanged(const QString &interfac
     if (interfaceName == interface()) {
         QVariantMap::const_iterator i = changedProperties.constBegin();
         while (i != changedProperties.constEnd()) {
-            int propertyIndex = metaObject()->indexOfProperty(i.key().toLatin1().constData());
+            int propertyIndex = propertyIndexOf(metaObject(), i.key());
 
             if (-1 == propertyIndex) {
                 qDebug() << Q_FUNC_INFO << "Got unknown changed property" << i.key();
             } else {
-                QVariant value = demarshall(interface(), metaObject()->property(propertyIndex), i.value(), &m_lastExtendedError);
+                QVariant value = demarshallProperty(interface(), propertyTable(metaObject())->properties.at(propertyIndex), i.value(), &m_lastExtendedError);
 
                 if (m_lastExtendedError.isValid()) {
+                    setFetched(this, propertyIndex, false);
                     Q_EMIT propertyInvalidated(i.key());
                 } else {
                     Q_EMIT propertyChanged(i.key(), value);
+                    // the receivers of propertyChanged have stored the value
+                    setFetched(this, propertyIndex, true);
                 }
             }
 
@@ -437,9 +703,11 @@ void DDBusExtendedAbstractInterface::onPropertiesChanged(const QString &interfac
 
         QStringList::const_iterator j = invalidatedProperties.constBegin();
         while (j != invalidatedProperties.constEnd()) {
-            if (-1 == metaObject()->indexOfProperty(j->toLatin1().constData())) {
+            int propertyIndex = propertyIndexOf(metaObject(), *j);
+            if (-1 == propertyIndex) {
                 qDebug() << Q_FUNC_INFO << "Got unknown invalidated property" << *j;
             } else {
+                setFetched(this, propertyIndex, false);
                 m_lastExtendedError = QDBusError();
                 Q_EMIT propertyInvalidated(*j);
             }
@@ -454,8 +722,11 @@ void DDBusExtendedAbstractInterface::onDBusNameOwnerChanged(const QString &name,
     if (name == service() && oldOwner.isEmpty()) {
         m_dbusOwner = newOwner;
         Q_EMIT serviceValidChanged(true);
+        if (prefetch())
+            getAllProperties();
     } else if (name == m_dbusOwner && newOwner.isEmpty()) {
         m_dbusOwner.clear();
+        setFetched(this, -1, false);
         Q_EMIT serviceValidChanged(false);
     }
 }
@@ -466,77 +737,7 @@ QVariant DDBusExtendedAbstractInterface::demarshall(const QString &interface,
                                                     QDBusError *error)
 {
     Q_ASSERT(metaProperty.isValid());
-    Q_ASSERT(error != 0);
-
-    if (value.userType() == metaProperty.userType()) {
-        // No need demarshalling. Passing back straight away ...
-        *error = QDBusError();
-        return value;
-    }
-
-    QString errorMessage;
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    QVariant result = QVariant{metaProperty.metaType()};
-    const char *expectedSignature = QDBusMetaType::typeToSignature(metaProperty.metaType());
-
-#else
-    QVariant result = QVariant(metaProperty.userType(), (void *)0);
-    const char *expectedSignature = QDBusMetaType::typeToSignature(metaProperty.userType());
-#endif
-    if (value.userType() == qMetaTypeId<QDBusArgument>()) {
-        // demarshalling a DBus argument ...
-        QDBusArgument dbusArg = value.value<QDBusArgument>();
-
-        if (expectedSignature == dbusArg.currentSignature().toLatin1()) {
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-            QDBusMetaType::demarshall(dbusArg, metaProperty.metaType(), result.data());
-#else
-            QDBusMetaType::demarshall(dbusArg, metaProperty.userType(), result.data());
-#endif
-            if (!result.isValid()) {
-                errorMessage = QStringLiteral("Unexpected failure demarshalling "
-                                              "upon PropertiesChanged signal arrival "
-                                              "for property `%3.%4' (expected type `%5' (%6))")
-                                   .arg(interface,
-                                        QString::fromLatin1(metaProperty.name()),
-                                        QString::fromLatin1(metaProperty.typeName()),
-                                        expectedSignature);
-            }
-        } else {
-            errorMessage = QStringLiteral("Unexpected `user type' (%2) "
-                                          "upon PropertiesChanged signal arrival "
-                                          "for property `%3.%4' (expected type `%5' (%6))")
-                               .arg(dbusArg.currentSignature(),
-                                    interface,
-                                    QString::fromLatin1(metaProperty.name()),
-                                    QString::fromLatin1(metaProperty.typeName()),
-                                    QString::fromLatin1(expectedSignature));
-        }
-    } else {
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-        const char *actualSignature = QDBusMetaType::typeToSignature(value.metaType());
-#else
-        const char *actualSignature = QDBusMetaType::typeToSignature(value.userType());
-#endif
-
-        errorMessage = QStringLiteral("Unexpected `%1' (%2) "
-                                      "upon PropertiesChanged signal arrival "
-                                      "for property `%3.%4' (expected type `%5' (%6))")
-                           .arg(QString::fromLatin1(value.typeName()),
-                                QString::fromLatin1(actualSignature),
-                                interface,
-                                QString::fromLatin1(metaProperty.name()),
-                                QString::fromLatin1(metaProperty.typeName()),
-                                QString::fromLatin1(expectedSignature));
-    }
-
-    if (errorMessage.isEmpty()) {
-        *error = QDBusError();
-    } else {
-        *error = QDBusMessage::createError(QDBusError::InvalidSignature, errorMessage);
-        qDebug() << Q_FUNC_INFO << errorMessage;
-    }
-
-    return result;
+    return demarshallProperty(interface, DDBusPropertyInfo(metaProperty), value, error);
 }
+
 DCORE_END_NAMESPACE
@@ -8,12 +8,26 @@ DCORE_BEGIN_NAMESPACE
 DDBusExtendedPendingCallWatcher::DDBusExtendedPendingCallWatcher(const QDBusPendingCall &call,
                                                                  const QString &asyncProperty,
                                                                  const QVariant &previousValue,
-                                                                 QObject *parent)
+                                                                 QObject *parent,
+                                                                 CallKind kind)
     : QDBusPendingCallWatcher(call, parent)
     , m_asyncProperty(asyncProperty)
     , m_previousValue(previousValue)
+    , m_kind(kind)
 {
 }
 
 DDBusExtendedPendingCallWatcher::~DDBusExtendedPendingCallWatcher() {}
+
+// the Get of the property still on the way, the ones asking meanwhile wait for its reply instead of sending another
+DDBusExtendedPendingCallWatcher *DDBusExtendedPendingCallWatcher::pendingGet(const QObject *owner, const QString &asyncProperty)
+{
+    for (QObject *child : owner->children()) {
+        DDBusExtendedPendingCallWatcher *watcher = qobject_cast<DDBusExtendedPendingCallWatcher *>(child);
+        if (watcher && watcher->m_kind == GetCall && !watcher->isFinished() && watcher->m_asyncProperty == asyncProperty)
+            return watcher;
+    }
+
+    return nullptr;
+}
 DCORE_END_NAMESPACE
@@ -26,21 +26,29 @@ class DDBusExtendedPendingCallWatcher : public QDBusPendingCallWatcher
     Q_OBJECT
 
 public:
+    enum CallKind { GetCall, SetCall };
+
     explicit DDBusExtendedPendingCallWatcher(const QDBusPendingCall &call,
                                              const QString &asyncProperty,
                                              const QVariant &previousValue,
-                                             QObject *parent = 0);
+                                             QObject *parent = 0,
+                                             CallKind kind = SetCall);
     ~DDBusExtendedPendingCallWatcher();
 
+    static DDBusExtendedPendingCallWatcher *pendingGet(const QObject *owner, const QString &asyncProperty);
+
     Q_PROPERTY(QString AsyncProperty READ asyncProperty)
     inline QString asyncProperty() const { return m_asyncProperty; }
 
     Q_PROPERTY(QVariant PreviousValue READ previousValue)
     inline QVariant previousValue() const { return m_previousValue; }
 
+    inline CallKind kind() const { return m_kind; }
+
 private:
     QString m_asyncProperty;
     QVariant m_previousValue;
+    CallKind m_kind;
 };
 DCORE_END_NAMESPACE
 
@@ -4,6 +4,7 @@
 
 #include "ddbusinterface.h"
 #include "ddbusinterface_p.h"
+#include "ddbuscalltrace_p.h"
 
 #include <QMetaObject>
 #include <qmetaobject.h>
@@ -12,6 +13,11 @@
 #include <QDBusMetaType>
 #include <QDBusPendingReply>
 #include <QDebug>
+#include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+#include <QPointer>
+#include <QThread>
 
 DCORE_BEGIN_NAMESPACE
 
@@ -22,7 +28,6 @@ static const QString &NameOwnerChanged = QStringLiteral("NameOwnerChanged");
 
 static const QString &PropertiesInterface = QStringLiteral("org.freedesktop.DBus.Properties");
 static const QString &PropertiesChanged = QStringLiteral("PropertiesChanged");
-static const char *PropertyName = "propname";
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     #define PropType(metaProperty) metaProperty.metaType()
@@ -30,6 +35,26 @@ static const char *PropertyName = "propname";
     #define PropType(metaProperty) metaProperty.userType()
 #endif
 
+enum MetaMemberKind { MetaProperty, MetaSignal };
+
+// indexOfProperty/indexOfSignal resolved once per meta object, the updates arrive at a high rate
+static int cachedIndexOf(const QMetaObject *metaObj, MetaMemberKind kind, const QByteArray &name)
+{
+    static QMutex cacheLock;
+    static QHash<QPair<const QMetaObject *, QByteArray>, int> cache[2];
+
+    const auto key = qMakePair(metaObj, name);
+    QMutexLocker locker(&cacheLock);
+    auto it = cache[kind].constFind(key);
+    if (it != cache[kind].constEnd())
+        return *it;
+
+    int index = kind == MetaProperty ? metaObj->indexOfProperty(name.constData())
+                                     : metaObj->indexOfSignal(name.constData());
+    cache[kind].insert(key, index);
+    return index;
+}
+
 static QVariant demarshall(const QMetaProperty &metaProperty, const QVariant &value)
 {
     // if the value is the same with parent one, return value
@@ -55,24 +80,200 @@ static QVariant demarshall(const QMetaProperty &metaProperty, const QVariant &va
     return result;
 }
 
-DDBusInterfacePrivate::DDBusInterfacePrivate(DDBusInterface *interface, QObject *parent)
-    : QObject(interface)
-    , m_parent(parent)
-    , m_serviceValid(false)
-    , q_ptr(interface)
+inline QString originalPropname(const char *propname, QString suffix)
+{
+    QString propStr(propname);
+    return propStr.left(propStr.length() - suffix.length());
+}
+
+typedef QPair<QString, QString> TrackerKey;
+typedef QHash<TrackerKey, DDBusServiceTracker *> TrackerHash;
+static QMutex trackersLock;
+Q_GLOBAL_STATIC(TrackerHash, trackers)
+
+DDBusServiceTracker::DDBusServiceTracker(const QDBusConnection &connection, const QString &service)
+    : m_connection(connection)
+    , m_service(service)
+    , m_ref(1)
+    , m_state(Querying)
+{
+}
+
+DDBusServiceTracker *DDBusServiceTracker::ref(const QDBusConnection &connection, const QString &service)
+{
+    QMutexLocker locker(&trackersLock);
+    const TrackerKey key(connection.name(), service);
+    DDBusServiceTracker *tracker = trackers->value(key);
+    if (tracker) {
+        ++tracker->m_ref;
+        return tracker;
+    }
+
+    tracker = new DDBusServiceTracker(connection, service);
+    // outlive the thread of the first interface, the later ones may be in any thread
+    if (QCoreApplication::instance() && tracker->thread() != QCoreApplication::instance()->thread())
+        tracker->moveToThread(QCoreApplication::instance()->thread());
+    trackers->insert(key, tracker);
+    tracker->start();
+    return tracker;
+}
+
+void DDBusServiceTracker::deref()
+{
+    QMutexLocker locker(&trackersLock);
+    if (--m_ref > 0)
+        return;
+
+    if (!trackers.isDestroyed())
+        trackers->remove(TrackerKey(m_connection.name(), m_service));
+    // the match rules are removed together with the receiver
+    deleteLater();
+}
+
+void DDBusServiceTracker::start()
 {
+    // watch before asking, an owner coming in between is not missed
+    m_connection.connect(FreedesktopService,
+                         FreedesktopPath,
+                         FreedesktopInterface,
+                         NameOwnerChanged,
+                         {m_service},
+                         QString(),
+                         this,
+                         SLOT(onNameOwnerChanged(QString, QString, QString)));
+
     QDBusMessage message = QDBusMessage::createMethodCall(FreedesktopService, FreedesktopPath, FreedesktopInterface, "NameHasOwner");
-    message << interface->service();
-    interface->connection().callWithCallback(message, this, SLOT(onDBusNameHasOwner(bool)));
+    message << m_service;
+    m_connection.callWithCallback(message, this, SLOT(onNameHasOwner(bool)), SLOT(onNameHasOwnerError()));
+}
+
+void DDBusServiceTracker::subscribe(DDBusInterfacePrivate *d, const QString &path, const QString &interface)
+{
+    QMutexLocker locker(&m_lock);
+    m_subscribers.append(d);
+
+    const TrackerKey key(path, interface);
+    auto it = m_propertySubscribers.find(key);
+    if (it == m_propertySubscribers.end()) {
+        it = m_propertySubscribers.insert(key, {});
+        m_connection.connect(m_service,
+                             path,
+                             PropertiesInterface,
+                             PropertiesChanged,
+                             {interface},
+                             QString(),
+                             this,
+                             SLOT(onPropertiesChanged(QString, QVariantMap, QStringList, QDBusMessage)));
+    }
+    it->append(d);
 
-    interface->connection().connect(interface->service(),
-                                    interface->path(),
+    // answer the late comers from what is known, still asynchronously as the query would
+    if (m_state != Querying) {
+        const bool valid = m_state == HasOwner;
+        QMetaObject::invokeMethod(d, [d, valid] { d->onDBusNameHasOwner(valid); }, Qt::QueuedConnection);
+    }
+}
+
+void DDBusServiceTracker::unsubscribe(DDBusInterfacePrivate *d)
+{
+    QMutexLocker locker(&m_lock);
+    m_subscribers.removeOne(d);
+
+    for (auto it = m_propertySubscribers.begin(); it != m_propertySubscribers.end(); ++it) {
+        if (!it->removeOne(d))
+            continue;
+
+        if (it->isEmpty()) {
+            m_connection.disconnect(m_service,
+                                    it.key().first,
                                     PropertiesInterface,
                                     PropertiesChanged,
-                                    {interface->interface()},
+                                    {it.key().second},
                                     QString(),
                                     this,
-                                    SLOT(onPropertiesChanged(QString, QVariantMap, QStringList)));
+                                    SLOT(onPropertiesChanged(QString, QVariantMap, QStringList, QDBusMessage)));
+            m_propertySubscribers.erase(it);
+        }
+        break;
+    }
+}
+
+// the subscribers unsubscribe under the lock before they are destroyed, so the ones of other threads
+// are queued while it is held, and the ones of this thread are called after, they may subscribe again
+void DDBusServiceTracker::dispatch(const TrackerKey *propertyKey, const std::function<void(DDBusInterfacePrivate *)> &func)
+{
+    QList<QPointer<DDBusInterfacePrivate>> local;
+    {
+        QMutexLocker locker(&m_lock);
+        const QList<DDBusInterfacePrivate *> targets = propertyKey ? m_propertySubscribers.value(*propertyKey) : m_subscribers;
+        for (DDBusInterfacePrivate *d : targets) {
+            if (d->thread() == QThread::currentThread())
+                local.append(d);
+            else
+                QMetaObject::invokeMethod(d, [d, func] { func(d); }, Qt::QueuedConnection);
+        }
+    }
+
+    for (const QPointer<DDBusInterfacePrivate> &d : local) {
+        if (d)
+            func(d);
+    }
+}
+
+void DDBusServiceTracker::onNameHasOwner(bool valid)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_state = valid ? HasOwner : NoOwner;
+    }
+    dispatch(nullptr, [valid](DDBusInterfacePrivate *d) { d->onDBusNameHasOwner(valid); });
+}
+
+void DDBusServiceTracker::onNameHasOwnerError()
+{
+    onNameHasOwner(false);
+}
+
+void DDBusServiceTracker::onNameOwnerChanged(const QString &name, const QString &oldOwner, const QString &newOwner)
+{
+    if (name != m_service)
+        return;
+
+    {
+        QMutexLocker locker(&m_lock);
+        m_state = newOwner.isEmpty() ? NoOwner : HasOwner;
+    }
+    dispatch(nullptr, [name, oldOwner, newOwner](DDBusInterfacePrivate *d) {
+        d->onDBusNameOwnerChanged(name, oldOwner, newOwner);
+    });
+}
+
+void DDBusServiceTracker::onPropertiesChanged(const QString &interfaceName,
+                                              const QVariantMap &changedProperties,
+                                              const QStringList &invalidatedProperties,
+                                              const QDBusMessage &message)
+{
+    const TrackerKey key(message.path(), interfaceName);
+    dispatch(&key, [interfaceName, changedProperties, invalidatedProperties](DDBusInterfacePrivate *d) {
+        d->onPropertiesChanged(interfaceName, changedProperties, invalidatedProperties);
+    });
+}
+
+DDBusInterfacePrivate::DDBusInterfacePrivate(DDBusInterface *interface, QObject *parent)
+    : QObject(interface)
+    , m_parent(parent)
+    , m_tracker(DDBusServiceTracker::ref(interface->connection(), interface->service()))
+    , m_serviceValid(false)
+    , m_pendingGetAll(QDBusPendingCall::fromCompletedCall(QDBusMessage()))
+    , q_ptr(interface)
+{
+    m_tracker->subscribe(this, interface->path(), interface->interface());
+}
+
+DDBusInterfacePrivate::~DDBusInterfacePrivate()
+{
+    m_tracker->unsubscribe(this);
+    m_tracker->deref();
 }
 
 void DDBusInterfacePrivate::updateProp(const char *propName, const QVariant &value)
@@ -83,7 +284,7 @@ void DDBusInterfacePrivate::updateProp(const char *propName, const QVariant &val
     const QMetaObject *metaObj = m_parent->metaObject();
     const char *typeName(value.typeName());
     void *data = const_cast<void *>(value.data());
-    int propertyIndex = metaObj->indexOfProperty(propName);
+    int propertyIndex = cachedIndexOf(metaObj, MetaProperty, propName);
     QVariant result = value;
 
     // TODO: it now cannot convert right, Like QMap
@@ -120,8 +321,8 @@ void DDBusInterfacePrivate::updateProp(const char *propName, const QVariant &val
         }, Qt::QueuedConnection);
 #endif
     }
-    QByteArray baSignal = QStringLiteral("%1Changed(%2)").arg(propName).arg(typeName).toLatin1();
-    int i = metaObj->indexOfSignal(baSignal.data());
+    QByteArray baSignal = QByteArray(propName) + "Changed(" + typeName + ")";
+    int i = cachedIndexOf(metaObj, MetaSignal, baSignal);
     if (i != -1) {
         auto method = metaObj->method(i);
         if (method.parameterCount() == 1) {
@@ -136,6 +337,9 @@ void DDBusInterfacePrivate::updateProp(const char *propName, const QVariant &val
 
 void DDBusInterfacePrivate::initDBusConnection()
 {
+    // one GetAll fills the cache of the property getters
+    refreshProperties();
+
     if (!m_parent)
         return;
 
@@ -170,16 +374,44 @@ void DDBusInterfacePrivate::onPropertiesChanged(const QString &interfaceName,
                                                 const QStringList &invalidatedProperties)
 {
     Q_UNUSED(interfaceName)
-    Q_UNUSED(invalidatedProperties)
-    for (QVariantMap::const_iterator it = changedProperties.cbegin(); it != changedProperties.cend(); ++it)
+    for (const QString &propName : invalidatedProperties)
+        m_propertyCache.remove(propName);
+    for (QVariantMap::const_iterator it = changedProperties.cbegin(); it != changedProperties.cend(); ++it) {
+        m_propertyCache.insert(it.key(), it.value());
         updateProp((it.key() + m_suffix).toLatin1(), it.value());
+    }
+}
+
+QDBusPendingCall DDBusInterfacePrivate::refreshProperties()
+{
+    Q_Q(DDBusInterface);
+    // the refreshes asked while one is on the way share its reply and watcher
+    if (!m_pendingGetAll.isFinished())
+        return m_pendingGetAll;
+
+    QDBusMessage msg = QDBusMessage::createMethodCall(q->service(), q->path(), PropertiesInterface, QStringLiteral("GetAll"));
+    msg << q->interface();
+    m_pendingGetAll = DDBusCallSpan::trace(q->connection().asyncCall(msg), msg);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(m_pendingGetAll, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, &DDBusInterfacePrivate::onGetAllPropertiesFinished);
+    return m_pendingGetAll;
 }
 
-void DDBusInterfacePrivate::onAsyncPropertyFinished(QDBusPendingCallWatcher *w)
+void DDBusInterfacePrivate::onGetAllPropertiesFinished(QDBusPendingCallWatcher *w)
 {
-    QDBusPendingReply<QVariant> reply = *w;
-    if (!reply.isError()) {
-        updateProp(w->property(PropertyName).toString().toLatin1(), reply.value());
+    QDBusPendingReply<QVariantMap> reply = *w;
+    if (reply.isError()) {
+        qDebug() << "Failed to get the properties of" << q_ptr->interface() << reply.error().message();
+    } else {
+        const QVariantMap properties = reply.value();
+        for (QVariantMap::const_iterator it = properties.cbegin(); it != properties.cend(); ++it) {
+            // notify only the values that the cache did not know yet
+            auto cached = m_propertyCache.constFind(it.key());
+            const bool changed = cached == m_propertyCache.constEnd() || *cached != it.value();
+            m_propertyCache.insert(it.key(), it.value());
+            if (changed)
+                updateProp((it.key() + m_suffix).toLatin1(), it.value());
+        }
     }
     w->deleteLater();
 }
@@ -189,23 +421,17 @@ void DDBusInterfacePrivate::setServiceValid(bool valid)
     if (m_serviceValid != valid) {
         Q_Q(DDBusInterface);
         m_serviceValid = valid;
+        if (!valid)
+            m_propertyCache.clear();
         Q_EMIT q->serviceValidChanged(m_serviceValid);
     }
 }
 
 void DDBusInterfacePrivate::onDBusNameHasOwner(bool valid)
 {
-    Q_Q(DDBusInterface);
     setServiceValid(valid);
     if (valid)
         initDBusConnection();
-    else
-        q->connection().connect(FreedesktopService,
-                                FreedesktopPath,
-                                FreedesktopInterface,
-                                NameOwnerChanged,
-                                this,
-                                SLOT(onDBusNameOwnerChanged(QString, QString, QString)));
 }
 
 void DDBusInterfacePrivate::onDBusNameOwnerChanged(const QString &name, const QString &oldOwner, const QString &newOwner)
@@ -213,12 +439,6 @@ void DDBusInterfacePrivate::onDBusNameOwnerChanged(const QString &name, const QS
     Q_Q(DDBusInterface);
     if (name == q->service() && oldOwner.isEmpty()) {
         initDBusConnection();
-        q->connection().disconnect(FreedesktopService,
-                                   FreedesktopPath,
-                                   FreedesktopInterface,
-                                   NameOwnerChanged,
-                                   this,
-                                   SLOT(onDBusNameOwnerChanged(QString, QString, QString)));
         setServiceValid(true);
     } else if (name == q->service() && newOwner.isEmpty())
         setServiceValid(false);
@@ -254,20 +474,29 @@ void DDBusInterface::setSuffix(const QString &suffix)
     d->m_suffix = suffix;
 }
 
-inline QString originalPropname(const char *propname, QString suffix)
-{
-    QString propStr(propname);
-    return propStr.left(propStr.length() - suffix.length());
-}
-
 QVariant DDBusInterface::property(const char *propName)
 {
     Q_D(DDBusInterface);
 
+    const QString originalName = originalPropname(propName, d->m_suffix);
+    auto cached = d->m_propertyCache.constFind(originalName);
+    if (cached != d->m_propertyCache.constEnd()) {
+        int i = parent() ? cachedIndexOf(parent()->metaObject(), MetaProperty, propName) : -1;
+        if (i == -1)
+            return *cached;
+        return demarshall(parent()->metaObject()->property(i), *cached);
+    }
+
+    // not fetched by GetAll yet
     QDBusMessage msg = QDBusMessage::createMethodCall(service(), path(), PropertiesInterface, QStringLiteral("Get"));
-    msg << interface() << originalPropname(propName, d->m_suffix);
+    msg << interface() << originalName;
     QDBusPendingReply<QVariant> prop = connection().asyncCall(msg);
+    {
+        DDBusCallSpan span(msg);
+        prop.waitForFinished();
+    }
     if (prop.value().isValid()) {
+        d->m_propertyCache.insert(originalName, prop.value());
         // if there is no parent, return value
         if (!parent()) {
             qWarning() << "you use it without parent, and if the value is not valid, you may get nothing";
@@ -275,7 +504,7 @@ QVariant DDBusInterface::property(const char *propName)
         }
         auto metaObject = parent()->metaObject();
         QVariant propresult = prop.value();
-        int i = metaObject->indexOfProperty(propName);
+        int i = cachedIndexOf(metaObject, MetaProperty, propName);
         if (i != -1) {
             QMetaProperty metaProperty = metaObject->property(i);
             // try to use property in parent to unwrap the value
@@ -284,23 +513,56 @@ QVariant DDBusInterface::property(const char *propName)
         return propresult;
     }
 
-    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(prop, this);
-    watcher->setProperty(PropertyName, propName);
-    connect(watcher, &QDBusPendingCallWatcher::finished, d, &DDBusInterfacePrivate::onAsyncPropertyFinished);
-
     return QVariant();
 }
 
+// fetch all the properties again without blocking, the changed ones are notified to the parent
+QDBusPendingCall DDBusInterface::refreshProperties()
+{
+    Q_D(DDBusInterface);
+    return d->refreshProperties();
+}
+
 void DDBusInterface::setProperty(const char *propName, const QVariant &value)
 {
-    Q_D(const DDBusInterface);
-    QDBusMessage msg = QDBusMessage::createMethodCall(service(), path(), PropertiesInterface, QStringLiteral("Set"));
-    msg << interface() << originalPropname(propName, d->m_suffix) << QVariant::fromValue(QDBusVariant(value));
+    QDBusPendingCall call = asyncSetProperty(propName, value);
+    DDBusCallSpan span(this, "Set");
+    call.waitForFinished();
+}
 
-    QDBusPendingReply<void> reply = connection().asyncCall(msg);
-    reply.waitForFinished();
-    if (!reply.isValid()) {
-        qWarning() << reply.error().message();
+// the cache and the parent see the value at once, and get the old one back if the call fails
+QDBusPendingCall DDBusInterface::asyncSetProperty(const char *propName, const QVariant &value)
+{
+    Q_D(DDBusInterface);
+    const QString originalName = originalPropname(propName, d->m_suffix);
+    QDBusMessage msg = QDBusMessage::createMethodCall(service(), path(), PropertiesInterface, QStringLiteral("Set"));
+    msg << interface() << originalName << QVariant::fromValue(QDBusVariant(value));
+    QDBusPendingCall call = DDBusCallSpan::trace(connection().asyncCall(msg), msg);
+
+    const bool cached = d->m_propertyCache.contains(originalName);
+    const QVariant oldValue = d->m_propertyCache.value(originalName);
+    if (!cached || oldValue != value) {
+        d->m_propertyCache.insert(originalName, value);
+        d->updateProp(propName, value);
     }
+
+    const QByteArray name(propName);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(call, d);
+    connect(watcher, &QDBusPendingCallWatcher::finished, d, [d, originalName, name, value, cached, oldValue](QDBusPendingCallWatcher *w) {
+        if (w->isError())
+            qWarning() << "Failed to set the property" << originalName << w->error().message();
+        // keep a value that PropertiesChanged brought in the meantime
+        if (w->isError() && d->m_propertyCache.value(originalName) == value) {
+            if (cached) {
+                d->m_propertyCache.insert(originalName, oldValue);
+                d->updateProp(name.constData(), oldValue);
+            } else {
+                d->m_propertyCache.remove(originalName);
+            }
+        }
+        w->deleteLater();
+    });
+
+    return call;
 }
 DCORE_END_NAMESPACE
@@ -5,31 +5,86 @@
 #pragma once
 #include "ddbusinterface.h"
 
+#include <QDBusConnection>
+#include <QDBusPendingCall>
+#include <QHash>
+#include <QMutex>
+
+#include <functional>
+
 class QDBusPendingCallWatcher;
 
 DCORE_BEGIN_NAMESPACE
+class DDBusInterfacePrivate;
+
+// one NameHasOwner query and one match rule per (connection, service), shared by all the interfaces
+class DDBusServiceTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    static DDBusServiceTracker *ref(const QDBusConnection &connection, const QString &service);
+    void deref();
+
+    void subscribe(DDBusInterfacePrivate *d, const QString &path, const QString &interface);
+    void unsubscribe(DDBusInterfacePrivate *d);
+
+private:
+    enum OwnerState { Querying, HasOwner, NoOwner };
+
+    DDBusServiceTracker(const QDBusConnection &connection, const QString &service);
+    void start();
+    void dispatch(const QPair<QString, QString> *propertyKey, const std::function<void(DDBusInterfacePrivate *)> &func);
+
+private Q_SLOTS:
+    void onNameHasOwner(bool valid);
+    void onNameHasOwnerError();
+    void onNameOwnerChanged(const QString &name, const QString &oldOwner, const QString &newOwner);
+    void onPropertiesChanged(const QString &interfaceName,
+                             const QVariantMap &changedProperties,
+                             const QStringList &invalidatedProperties,
+                             const QDBusMessage &message);
+
+private:
+    QDBusConnection m_connection;
+    QString m_service;
+    int m_ref;
+    OwnerState m_state;
+    mutable QMutex m_lock;
+    QList<DDBusInterfacePrivate *> m_subscribers;
+    // the subscribers of PropertiesChanged by (path, interface), connected once per key
+    QHash<QPair<QString, QString>, QList<DDBusInterfacePrivate *>> m_propertySubscribers;
+};
+
 class DDBusInterfacePrivate : public QObject
 {
     Q_OBJECT
 
 public:
     explicit DDBusInterfacePrivate(DDBusInterface *interface, QObject *parent);
+    ~DDBusInterfacePrivate() override;
     void updateProp(const char *propName, const QVariant &value);
     void initDBusConnection();
     void setServiceValid(bool valid);
+    QDBusPendingCall refreshProperties();
 
-private Q_SLOTS:
     void onPropertiesChanged(const QString &interfaceName,
                              const QVariantMap &changedProperties,
                              const QStringList &invalidatedProperties);
-    void onAsyncPropertyFinished(QDBusPendingCallWatcher *w);
     void onDBusNameHasOwner(bool valid);
     void onDBusNameOwnerChanged(const QString &name, const QString &oldOwner, const QString &newOwner);
 
+private Q_SLOTS:
+    void onGetAllPropertiesFinished(QDBusPendingCallWatcher *w);
+
 public:
     QObject *m_parent;
+    DDBusServiceTracker *m_tracker;
     QString m_suffix;
     bool m_serviceValid;
+    // the raw values by the property names on the bus, kept fresh by PropertiesChanged
+    QVariantMap m_propertyCache;
+    QDBusPendingCall m_pendingGetAll;
 
     DDBusInterface *q_ptr;
     Q_DECLARE_PUBLIC(DDBusInterface)
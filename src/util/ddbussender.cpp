@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "ddbussender.h"
+#include "ddbuscalltrace_p.h"
 
 #include <QDBusInterface>
 #include <QDebug>
@@ -81,10 +82,16 @@ QDBusPendingCall DDBusData::asyncCallWithArguments(const QString &method, const
     // This is costing in some cases when introspection is not ready;
     // Cause this is an asynchronous method, it'd be better not to wait for anything, just leave this to caller;
     // Use QDBusMessage to invoke directly instead of creating a QDBusInterface.
+    const QDBusMessage &methodCall = createMethodCall(method, arguments, iface);
+    return DTK_CORE_NAMESPACE::DDBusCallSpan::trace(connection.asyncCall(methodCall), methodCall);
+}
+
+QDBusMessage DDBusData::createMethodCall(const QString &method, const QVariantList &arguments, const QString &iface) const
+{
     const QString calledInterface = iface.isEmpty() ? interface : iface;
     QDBusMessage methodCall = QDBusMessage::createMethodCall(service, path, calledInterface, method);
     methodCall.setArguments(arguments);
-    return connection.asyncCall(methodCall);
+    return methodCall;
 }
 
 QDBusPendingCall DDBusCaller::call()
@@ -109,3 +116,96 @@ DDBusProperty::DDBusProperty(const QString &property, std::shared_ptr<DDBusData>
     , m_propertyName(property)
 {
 }
+
+DDBusBatchWatcher::DDBusBatchWatcher(const QList<QDBusPendingCall> &calls, QObject *parent)
+    : QObject(parent)
+    , m_calls(calls)
+    , m_pending(calls.size())
+{
+    for (const QDBusPendingCall &call : m_calls) {
+        auto watcher = new QDBusPendingCallWatcher(call, this);
+        connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher *w) {
+            w->deleteLater();
+            onCallFinished();
+        });
+    }
+
+    // an empty batch is finished at once, but still reported asynchronously
+    if (m_calls.isEmpty())
+        QMetaObject::invokeMethod(this, [this] { Q_EMIT finished(this); }, Qt::QueuedConnection);
+}
+
+void DDBusBatchWatcher::onCallFinished()
+{
+    if (--m_pending == 0)
+        Q_EMIT finished(this);
+}
+
+QList<QDBusPendingCall> DDBusBatchWatcher::calls() const
+{
+    return m_calls;
+}
+
+bool DDBusBatchWatcher::isFinished() const
+{
+    for (const QDBusPendingCall &call : m_calls) {
+        if (!call.isFinished())
+            return false;
+    }
+    return true;
+}
+
+bool DDBusBatchWatcher::isError() const
+{
+    for (const QDBusPendingCall &call : m_calls) {
+        if (call.isFinished() && call.isError())
+            return true;
+    }
+    return false;
+}
+
+void DDBusBatchWatcher::waitForFinished()
+{
+    for (QDBusPendingCall &call : m_calls)
+        call.waitForFinished();
+}
+
+DDBusBatch::DDBusBatch()
+{
+}
+
+DDBusBatch::~DDBusBatch()
+{
+    // nobody waits for the replies of a batch that was not flushed
+    if (!m_queue.isEmpty())
+        flush()->deleteLater();
+}
+
+DDBusBatch &DDBusBatch::add(const DDBusCaller &caller)
+{
+    m_queue << qMakePair(caller.m_dbusData->connection,
+                         caller.m_dbusData->createMethodCall(caller.m_methodName, caller.m_arguments));
+    return *this;
+}
+
+DDBusBatch &DDBusBatch::operator<<(const DDBusCaller &caller)
+{
+    return add(caller);
+}
+
+int DDBusBatch::count() const
+{
+    return m_queue.size();
+}
+
+DDBusBatchWatcher *DDBusBatch::flush(QObject *parent)
+{
+    // the messages are built already, send them back to back
+    QList<QDBusPendingCall> calls;
+    calls.reserve(m_queue.size());
+    for (const auto &queued : m_queue)
+        calls << queued.first.asyncCall(queued.second);
+    m_queue.clear();
+
+    return new DDBusBatchWatcher(calls, parent);
+}
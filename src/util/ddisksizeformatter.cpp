@@ -5,6 +5,8 @@
 #include "ddisksizeformatter.h"
 
 #include <QString>
+#include <QtAlgorithms>
+#include <QtMath>
 
 DCORE_BEGIN_NAMESPACE
 
@@ -38,4 +40,63 @@ DDiskSizeFormatter DDiskSizeFormatter::rate(int rate)
     return *this;
 }
 
+/*!
+  @~english
+  @brief A fast version of format() for \a bytes in the unit B.
+
+  The unit is the biggest one in which the value is not less than 1, it's
+  picked by the bit width of \a bytes for the rate 1024 and by a threshold
+  table for the rate 1000, no virtual function is called.
+  @return QPair<qreal, int> a pair of the converted value and unit
+ */
+QPair<qreal, int> DDiskSizeFormatter::formatBytes(quint64 bytes) const
+{
+    static const quint64 DecimalThresholds[] = {1, 1000ULL, 1000000ULL, 1000000000ULL, 1000000000000ULL};
+
+    int unit = B;
+    quint64 divisor = 1;
+    if (m_rate == 1024) {
+        if (bytes)
+            unit = qMin<int>(T, (63 - qCountLeadingZeroBits(bytes)) / 10);
+        divisor = quint64(1) << (10 * unit);
+    } else if (m_rate == 1000) {
+        while (unit < T && bytes >= DecimalThresholds[unit + 1])
+            ++unit;
+        divisor = DecimalThresholds[unit];
+    } else if (m_rate > 1) {
+        while (unit < T && bytes / divisor >= quint64(m_rate)) {
+            divisor *= quint64(m_rate);
+            ++unit;
+        }
+    }
+
+    return QPair<qreal, int>(qreal(bytes) / divisor, unit);
+}
+
+/*!
+  @~english
+  @brief Append the text of formatBytes() like "1.5 KB" to \a out.
+
+  Nothing but \a out is allocated, the callers formatting many sizes can
+  reuse one string and truncate it to 0 for each.
+  @param[in] bytes the size in the unit B
+  @param[out] out the string to append to
+  @param[in] precision the count of decimals, 0 for the unit B
+ */
+void DDiskSizeFormatter::appendBytes(quint64 bytes, QString &out, int precision) const
+{
+    static const char *const Units[] = {"B", "KB", "MB", "GB", "TB"};
+
+    QPair<qreal, int> size = formatBytes(bytes);
+    // 1023.96 KB is rounded to 1 MB instead of 1024.0 KB
+    if (size.second < T && m_rate > 1 && size.first + 0.5 * qPow(10, -precision) >= m_rate) {
+        size.first /= m_rate;
+        ++size.second;
+    }
+
+    appendNumber(out, size.first, size.second == B ? 0 : precision);
+    out.append(QLatin1Char(' '));
+    out.append(QLatin1String(Units[size.second]));
+}
+
 DCORE_END_NAMESPACE
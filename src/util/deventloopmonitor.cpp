@@ -0,0 +1,221 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "deventloopmonitor.h"
+
+#include "base/private/dobject_p.h"
+
+#include <QAbstractEventDispatcher>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QMetaEnum>
+#include <QPointer>
+#include <QReadWriteLock>
+#include <QThread>
+
+#include <atomic>
+
+DCORE_BEGIN_NAMESPACE
+
+#ifdef QT_DEBUG
+Q_LOGGING_CATEGORY(logEventLoop, "dtk.core.eventloop")
+#else
+Q_LOGGING_CATEGORY(logEventLoop, "dtk.core.eventloop", QtInfoMsg)
+#endif
+
+class DEventLoopMonitorPrivate : public DObjectPrivate
+{
+public:
+    explicit DEventLoopMonitorPrivate(DEventLoopMonitor *qq)
+        : DObjectPrivate(qq)
+    {
+    }
+
+    // only touched in the monitored thread
+    void beginEvent(QObject *receiver, QEvent *event);
+    void endEvent();
+
+    D_DECLARE_PUBLIC(DEventLoopMonitor)
+
+    QPointer<QThread> thread;
+    std::atomic<int> threshold{100};
+    QMetaObject::Connection aboutToBlock;
+
+    QElapsedTimer timer;
+    qint64 eventStart = -1;
+    int eventType = 0;
+    const char *receiverClass = nullptr;
+};
+
+// the monitors by the threads, the callback is called for every event of every thread.
+static QReadWriteLock monitorsLock;
+static QHash<QThread *, DEventLoopMonitorPrivate *> monitors;
+static std::atomic<int> monitorCount{0};
+
+static bool eventNotifyCallback(void **data)
+{
+    if (Q_LIKELY(monitorCount.load(std::memory_order_relaxed) == 0))
+        return false;
+
+    QReadLocker locker(&monitorsLock);
+    if (DEventLoopMonitorPrivate *d = monitors.value(QThread::currentThread()))
+        d->beginEvent(reinterpret_cast<QObject *>(data[0]), reinterpret_cast<QEvent *>(data[1]));
+    // never filter the event
+    return false;
+}
+
+static void ensureCallbackRegistered()
+{
+    static const bool registered = QInternal::registerCallback(QInternal::EventNotifyCallback, eventNotifyCallback);
+    Q_UNUSED(registered)
+}
+
+// an event lasts until the next one starts or the loop is going to wait, so the nested
+// events are counted in the outer one.
+void DEventLoopMonitorPrivate::beginEvent(QObject *receiver, QEvent *event)
+{
+    endEvent();
+    eventStart = timer.elapsed();
+    eventType = event->type();
+    receiverClass = receiver ? receiver->metaObject()->className() : nullptr;
+}
+
+void DEventLoopMonitorPrivate::endEvent()
+{
+    if (eventStart < 0)
+        return;
+
+    const qint64 duration = timer.elapsed() - eventStart;
+    eventStart = -1;
+    if (duration < threshold.load(std::memory_order_relaxed))
+        return;
+
+    static const QMetaEnum typeEnum = QMetaEnum::fromType<QEvent::Type>();
+    const char *typeName = typeEnum.valueToKey(eventType);
+    const QString className = QString::fromLatin1(receiverClass ? receiverClass : "unknown");
+    qCWarning(logEventLoop, "The event loop of %s stalled for %lld ms by the event %s(%d) to %s",
+              thread ? qPrintable(thread->objectName().isEmpty() ? QStringLiteral("a thread") : thread->objectName()) : "a thread",
+              duration, typeName ? typeName : "user", eventType, qPrintable(className));
+
+    // queued, so that the receivers can stop the monitor, it's locked here.
+    D_Q(DEventLoopMonitor);
+    const int type = eventType;
+    QMetaObject::invokeMethod(q, [q, type, className, duration] {
+        Q_EMIT q->stalled(type, className, duration);
+    }, Qt::QueuedConnection);
+}
+
+/*!
+@~english
+  @class Dtk::Core::DEventLoopMonitor
+  @brief Reports the events which block the event loop of a thread.
+
+  The events delivered in the monitored thread are timed, an event taking longer than
+  threshold() is warned in the `dtk.core.eventloop` category with its type and the class of
+  its receiver, and stalled() is emitted afterwards in the thread of the monitor.
+
+  An event is timed until the next event starts or the loop is going to wait, the events
+  dispatched in nested event loops are counted in the outer event.
+ */
+
+/*!
+@~english
+  @brief Monitors \a thread, the current thread by default, the monitoring is started by start().
+ */
+DEventLoopMonitor::DEventLoopMonitor(QThread *thread, QObject *parent)
+    : QObject(parent)
+    , DObject(*new DEventLoopMonitorPrivate(this))
+{
+    D_D(DEventLoopMonitor);
+    d->thread = thread ? thread : QThread::currentThread();
+}
+
+DEventLoopMonitor::~DEventLoopMonitor()
+{
+    stop();
+}
+
+QThread *DEventLoopMonitor::monitoredThread() const
+{
+    D_DC(DEventLoopMonitor);
+    return d->thread;
+}
+
+/*!
+@~english
+  @brief The duration in milliseconds an event is reported from, 100 by default.
+ */
+int DEventLoopMonitor::threshold() const
+{
+    D_DC(DEventLoopMonitor);
+    return d->threshold.load();
+}
+
+void DEventLoopMonitor::setThreshold(int msec)
+{
+    D_D(DEventLoopMonitor);
+    d->threshold.store(msec);
+}
+
+bool DEventLoopMonitor::isActive() const
+{
+    D_DC(DEventLoopMonitor);
+    QReadLocker locker(&monitorsLock);
+    return d->thread && monitors.value(d->thread) == d;
+}
+
+/*!
+@~english
+  @brief Start monitoring, it fails if the thread has no event dispatcher or is monitored already.
+ */
+bool DEventLoopMonitor::start()
+{
+    D_D(DEventLoopMonitor);
+    if (!d->thread)
+        return false;
+
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance(d->thread);
+    if (!dispatcher) {
+        qCWarning(logEventLoop) << "The thread" << d->thread << "has no event dispatcher";
+        return false;
+    }
+
+    ensureCallbackRegistered();
+    {
+        QWriteLocker locker(&monitorsLock);
+        DEventLoopMonitorPrivate *current = monitors.value(d->thread);
+        if (current)
+            return current == d;
+        d->timer.start();
+        d->eventStart = -1;
+        monitors.insert(d->thread, d);
+        monitorCount.fetch_add(1);
+    }
+
+    d->aboutToBlock = connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, dispatcher, [d] {
+        QReadLocker locker(&monitorsLock);
+        if (monitors.value(QThread::currentThread()) == d)
+            d->endEvent();
+    }, Qt::DirectConnection);
+    return true;
+}
+
+void DEventLoopMonitor::stop()
+{
+    D_D(DEventLoopMonitor);
+    disconnect(d->aboutToBlock);
+
+    QWriteLocker locker(&monitorsLock);
+    for (auto it = monitors.begin(); it != monitors.end(); ++it) {
+        if (it.value() == d) {
+            monitors.erase(it);
+            monitorCount.fetch_sub(1);
+            break;
+        }
+    }
+}
+
+DCORE_END_NAMESPACE
@@ -13,6 +13,8 @@
 #include <QDBusVariant>
 #include <QDBusContext>
 #include <QDBusMessage>
+#include <QFutureInterface>
+#include <QFutureWatcher>
 
 DCORE_BEGIN_NAMESPACE
 namespace DUtil {
@@ -30,6 +32,7 @@ public Q_SLOTS:
     QStringList list();
     QString help(const QString &action);
     QDBusVariant invoke(QString action, QString parameters);
+    QDBusVariant call(QString action, QVariantList arguments);
 
 private:
     DExportedInterfacePrivate *p;
@@ -41,9 +44,17 @@ public:
     DExportedInterfacePrivate(DExportedInterface *q);
 
 private:
+    // one of the handlers is set
+    struct Action {
+        std::function<QVariant(QString)> handler;
+        std::function<QVariant(const QVariantList &)> typedHandler;
+        std::function<QFuture<QVariant>(const QVariantList &)> asyncHandler;
+        QString description;
+    };
+
     QStringList actionHelp(QString action, int indent);
 
-    QHash<QString, QPair<std::function<QVariant(QString)>, QString>> actions;
+    QHash<QString, Action> actions;
     QScopedPointer<DExportedInterfaceDBusInterface> dbusif;
     D_DECLARE_PUBLIC(DExportedInterface)
 
@@ -66,18 +77,87 @@ DExportedInterface::~DExportedInterface()
 void DExportedInterface::registerAction(const QString &action, const QString &description, const std::function<QVariant (QString)> handler)
 {
     D_D(DExportedInterface);
-    d->actions[action] = {handler, description};
+    d->actions[action] = {handler, nullptr, nullptr, description};
+}
+
+/*!
+@~english
+  @brief Register \a action with a \a handler taking the arguments as a QVariantList.
+
+  Over D-Bus the arguments are passed to the call method as they are,
+  without being formatted into and parsed from text.
+ */
+void DExportedInterface::registerTypedAction(const QString &action, const QString &description, const std::function<QVariant (const QVariantList &)> handler)
+{
+    D_D(DExportedInterface);
+    d->actions[action] = {nullptr, handler, nullptr, description};
+}
+
+/*!
+@~english
+  @brief Register \a action with a \a handler that returns before its result is ready.
+
+  The D-Bus reply is sent when the returned future finishes, so the
+  handler can run the work on another thread without blocking the service.
+ */
+void DExportedInterface::registerAsyncAction(const QString &action, const QString &description, const std::function<QFuture<QVariant> (const QVariantList &)> handler)
+{
+    D_D(DExportedInterface);
+    d->actions[action] = {nullptr, nullptr, handler, description};
 }
 
+/*!
+@~english
+  @brief Run \a action with the text \a parameters.
+
+  A typed or async action gets \a parameters as its only argument, and an
+  async action is waited for.
+ */
 QVariant DExportedInterface::invoke(const QString &action, const QString &parameters) const
 {
     D_DC(DExportedInterface);
-    if (auto func = d->actions.value(action).first) {
-        return func(parameters);
-    }
+    auto it = d->actions.constFind(action);
+    if (it == d->actions.constEnd())
+        return QVariant();
+
+    if (it->handler)
+        return it->handler(parameters);
+    if (it->typedHandler)
+        return it->typedHandler({parameters});
+    if (it->asyncHandler)
+        return it->asyncHandler({parameters}).result();
     return QVariant();
 }
 
+/*!
+@~english
+  @brief Run \a action with \a arguments, the future is finished at once unless the action is async.
+
+  A text action gets the arguments joined by spaces.
+ */
+QFuture<QVariant> DExportedInterface::call(const QString &action, const QVariantList &arguments) const
+{
+    D_DC(DExportedInterface);
+    auto it = d->actions.constFind(action);
+    if (it != d->actions.constEnd() && it->asyncHandler)
+        return it->asyncHandler(arguments);
+
+    QVariant result;
+    if (it != d->actions.constEnd() && it->typedHandler) {
+        result = it->typedHandler(arguments);
+    } else if (it != d->actions.constEnd() && it->handler) {
+        QStringList parameters;
+        for (const QVariant &argument : arguments)
+            parameters << argument.toString();
+        result = it->handler(parameters.join(' '));
+    }
+
+    QFutureInterface<QVariant> future(QFutureInterfaceBase::Started);
+    future.reportResult(result);
+    future.reportFinished();
+    return future.future();
+}
+
 DExportedInterfacePrivate::DExportedInterfacePrivate(DExportedInterface *q)
     : DObjectPrivate(q)
     , dbusif(new DExportedInterfaceDBusInterface(this))
@@ -87,7 +167,7 @@ QStringList DExportedInterfacePrivate::actionHelp(QString action, int indent)
 {
     QStringList ret;
     if (actions.contains(action)) {
-        ret << QString(indent * 2, ' ') + QString("%1: %2").arg(action).arg(actions[action].second);
+        ret << QString(indent * 2, ' ') + QString("%1: %2").arg(action).arg(actions[action].description);
     }
     return ret;
 }
@@ -128,6 +208,30 @@ QDBusVariant DExportedInterfaceDBusInterface::invoke(QString action, QString par
     return ret;
 }
 
+QDBusVariant DExportedInterfaceDBusInterface::call(QString action, QVariantList arguments)
+{
+    if (!p->actions.contains(action)) {
+        sendErrorReply(QDBusError::ErrorType::InvalidArgs, QString("Action \"%1\" is not registered").arg(action));
+        return QDBusVariant();
+    }
+
+    QFuture<QVariant> future = p->q_func()->call(action, arguments);
+    if (future.isFinished())
+        return QDBusVariant(future.result());
+
+    // reply when the future finishes, the service goes on meanwhile
+    setDelayedReply(true);
+    QDBusMessage request = message();
+    QDBusConnection bus = connection();
+    auto watcher = new QFutureWatcher<QVariant>(this);
+    connect(watcher, &QFutureWatcher<QVariant>::finished, this, [watcher, request, bus]() {
+        QDBusConnection(bus).send(request.createReply(QVariant::fromValue(QDBusVariant(watcher->result()))));
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
+    return QDBusVariant();
+}
+
 }
 DCORE_END_NAMESPACE
 
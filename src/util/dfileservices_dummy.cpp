@@ -4,6 +4,8 @@
 
 #include "dfileservices.h"
 
+#include <QDBusError>
+
 DCORE_BEGIN_NAMESPACE
 
 static QStringList urls2uris(const QList<QUrl> &urls)
@@ -141,6 +143,33 @@ bool DFileServices::trash(const QList<QUrl> urls)
 }
 
 
+QDBusPendingCall DFileServices::showFoldersAsync(const QList<QUrl> &urls, const QString &startupId)
+{
+    Q_UNUSED(urls);
+    Q_UNUSED(startupId);
+    return QDBusPendingCall::fromError(QDBusError(QDBusError::NotSupported, QStringLiteral("Not supported")));
+}
+
+QDBusPendingCall DFileServices::showFileItemPropertiesAsync(const QList<QUrl> &urls, const QString &startupId)
+{
+    Q_UNUSED(urls);
+    Q_UNUSED(startupId);
+    return QDBusPendingCall::fromError(QDBusError(QDBusError::NotSupported, QStringLiteral("Not supported")));
+}
+
+QDBusPendingCall DFileServices::showFileItemsAsync(const QList<QUrl> &urls, const QString &startupId)
+{
+    Q_UNUSED(urls);
+    Q_UNUSED(startupId);
+    return QDBusPendingCall::fromError(QDBusError(QDBusError::NotSupported, QStringLiteral("Not supported")));
+}
+
+void DFileServices::postShowFileItems(const QList<QUrl> &urls, const QString &startupId)
+{
+    Q_UNUSED(urls);
+    Q_UNUSED(startupId);
+}
+
 QString DFileServices::errorMessage()
 {
     return QString();
@@ -2,10 +2,14 @@
 //
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <QCoreApplication>
+#include <QDBusConnection>
 #include <QDBusInterface>
 #include <QDBusPendingCall>
 #include <QDebug>
 #include <QFile>
+#include <QMutex>
+#include <QTimer>
 
 #include "dfileservices.h"
 
@@ -23,6 +27,33 @@ static QDBusInterface *fileManager1DBusInterface()
     return &interface;
 }
 
+static QDBusPendingCall asyncCallFileManager1(const QString &method, const QList<QUrl> &urls, const QString &startupId);
+
+// the requests of postShowFileItems in the window are sent in a ShowItems call
+#define POST_WINDOW 50
+
+struct PostedItems
+{
+    QMutex mutex;
+    QList<QUrl> urls;
+    QString startupId;
+    bool scheduled = false;
+
+    void flush()
+    {
+        QMutexLocker locker(&mutex);
+        const QList<QUrl> pendingUrls = std::move(urls);
+        urls.clear();
+        scheduled = false;
+        const QString id = startupId;
+        locker.unlock();
+
+        if (!pendingUrls.isEmpty())
+            asyncCallFileManager1(QStringLiteral("ShowItems"), pendingUrls, id);
+    }
+};
+Q_GLOBAL_STATIC(PostedItems, postedItems)
+
 static QStringList urls2uris(const QList<QUrl> &urls)
 {
     QStringList list;
@@ -49,6 +80,17 @@ static QList<QUrl> path2urls(const QList<QString> &paths)
     return list;
 }
 
+// unlike QDBusInterface, it doesn't introspect the service, nothing blocks
+static QDBusPendingCall asyncCallFileManager1(const QString &method, const QList<QUrl> &urls, const QString &startupId)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(QStringLiteral("org.freedesktop.FileManager1"),
+                                                          QStringLiteral("/org/freedesktop/FileManager1"),
+                                                          QStringLiteral("org.freedesktop.FileManager1"),
+                                                          method);
+    message << urls2uris(urls) << startupId;
+    return QDBusConnection::sessionBus().asyncCall(message);
+}
+
 bool DFileServices::showFolder(QString localFilePath, const QString &startupId)
 {
     return showFolder(QUrl::fromLocalFile(localFilePath), startupId);
@@ -109,6 +151,79 @@ bool DFileServices::showFileItems(const QList<QUrl> urls, const QString &startup
     EASY_CALL_DBUS(ShowItems)
 }
 
+/*!
+@~english
+  @brief Shows the folders \a urls like showFolders(), but returns without waiting for the file manager.
+ */
+QDBusPendingCall DFileServices::showFoldersAsync(const QList<QUrl> &urls, const QString &startupId)
+{
+    return asyncCallFileManager1(QStringLiteral("ShowFolders"), urls, startupId);
+}
+
+/*!
+@~english
+  @brief Shows the properties of \a urls like showFileItemProperties(), but returns without waiting
+  for the file manager.
+ */
+QDBusPendingCall DFileServices::showFileItemPropertiesAsync(const QList<QUrl> &urls, const QString &startupId)
+{
+    return asyncCallFileManager1(QStringLiteral("ShowItemProperties"), urls, startupId);
+}
+
+/*!
+@~english
+  @brief Shows the items \a urls like showFileItems(), but returns without waiting for the file manager.
+  @sa postShowFileItems()
+ */
+QDBusPendingCall DFileServices::showFileItemsAsync(const QList<QUrl> &urls, const QString &startupId)
+{
+    return asyncCallFileManager1(QStringLiteral("ShowItems"), urls, startupId);
+}
+
+/*!
+@~english
+  @brief Shows the items \a urls later, the requests in a short window are merged into one
+  ShowItems call with all the urls.
+
+  The requests with a different \a startupId are not merged, the pending urls are sent first.
+  It needs the event loop of the application, and the result isn't reported, use
+  showFileItemsAsync() to get it.
+ */
+void DFileServices::postShowFileItems(const QList<QUrl> &urls, const QString &startupId)
+{
+    if (urls.isEmpty())
+        return;
+
+    // nothing runs the window without an application
+    if (!QCoreApplication::instance()) {
+        asyncCallFileManager1(QStringLiteral("ShowItems"), urls, startupId);
+        return;
+    }
+
+    PostedItems *items = postedItems;
+    QMutexLocker locker(&items->mutex);
+    if (!items->urls.isEmpty() && items->startupId != startupId) {
+        asyncCallFileManager1(QStringLiteral("ShowItems"), items->urls, items->startupId);
+        items->urls.clear();
+    }
+
+    items->startupId = startupId;
+    for (const QUrl &url : urls) {
+        if (!items->urls.contains(url))
+            items->urls << url;
+    }
+
+    if (items->scheduled)
+        return;
+    items->scheduled = true;
+    // the timer is started in the main thread, the caller's thread may have no event loop
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [items] {
+        QTimer::singleShot(POST_WINDOW, QCoreApplication::instance(), [items] {
+            items->flush();
+        });
+    }, Qt::QueuedConnection);
+}
+
 bool DFileServices::trash(QString localFilePath)
 {
     return trash(QUrl::fromLocalFile(localFilePath));
@@ -5,6 +5,12 @@
 #include "dnotifysender.h"
 #include "ddbussender.h"
 
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QDebug>
+
 DCORE_BEGIN_NAMESPACE
 
 namespace DUtil {
@@ -92,6 +98,171 @@ QDBusPendingCall DNotifySender::call()
         .call();
 }
 
+class DNotificationPrivate
+{
+public:
+    explicit DNotificationPrivate(DNotification *qq);
+
+    void schedule();
+    void sendPending();
+
+    uint id = 0;
+    // the latest state not sent yet, the older ones are dropped
+    std::unique_ptr<DNotifySender> pending;
+    bool inFlight = false;
+    QElapsedTimer lastSent;
+    QTimer timer;
+
+    DNotification *q_ptr;
+    Q_DECLARE_PUBLIC(DNotification)
+};
+
+DNotificationPrivate::DNotificationPrivate(DNotification *qq)
+    : q_ptr(qq)
+{
+    timer.setSingleShot(true);
+    timer.setInterval(250);
+    QObject::connect(&timer, &QTimer::timeout, qq, [this] {
+        schedule();
+    });
+}
+
+void DNotificationPrivate::schedule()
+{
+    // the id of the first Notify is needed to replace it, the next state waits for the reply
+    if (!pending || inFlight)
+        return;
+
+    const qint64 elapsed = lastSent.isValid() ? lastSent.elapsed() : timer.interval();
+    if (elapsed >= timer.interval()) {
+        sendPending();
+    } else if (!timer.isActive()) {
+        timer.start(timer.interval() - int(elapsed));
+    }
+}
+
+void DNotificationPrivate::sendPending()
+{
+    Q_Q(DNotification);
+    std::unique_ptr<DNotifySender> sender = std::move(pending);
+    timer.stop();
+    inFlight = true;
+    lastSent.start();
+
+    auto watcher = new QDBusPendingCallWatcher(sender->replaceId(id).call(), q);
+    QObject::connect(watcher, &QDBusPendingCallWatcher::finished, q, [this](QDBusPendingCallWatcher *w) {
+        Q_Q(DNotification);
+        w->deleteLater();
+        inFlight = false;
+
+        QDBusPendingReply<uint> reply = *w;
+        if (reply.isError()) {
+            qWarning() << "Failed to send the notification:" << reply.error().message();
+        } else {
+            id = reply.value();
+            Q_EMIT q->notified(id);
+        }
+        schedule();
+    });
+}
+
+/*!
+@~english
+  @class Dtk::Core::DUtil::DNotification
+  \inmodule dtkcore
+  @brief A notification updated in place, for progress of downloads or copy jobs.
+
+  Each notify() replaces the notification shown before through its id.
+  The updates are sent at most once per minimumInterval(), the states in
+  between are dropped and only the latest one is sent.
+@code
+    auto notification = new DUtil::DNotification(this);
+    notification->notify(DUtil::DNotifySender("Copying").appName("dde-file-manager").appBody("42%"));
+@endcode
+ */
+
+DNotification::DNotification(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new DNotificationPrivate(this))
+{
+}
+
+DNotification::~DNotification()
+{
+}
+
+/*!
+@~english
+  @brief The id given by the notification server, 0 before the first reply.
+ */
+uint DNotification::id() const
+{
+    Q_D(const DNotification);
+    return d->id;
+}
+
+/*!
+@~english
+  @brief The minimum milliseconds between two updates, 250 by default.
+ */
+int DNotification::minimumInterval() const
+{
+    Q_D(const DNotification);
+    return d->timer.interval();
+}
+
+void DNotification::setMinimumInterval(int msec)
+{
+    Q_D(DNotification);
+    d->timer.setInterval(qMax(0, msec));
+}
+
+/*!
+@~english
+  @brief Show the state of \a sender, replacing the notification shown before.
+
+  The replaceId of \a sender is set to id().
+ */
+void DNotification::notify(const DNotifySender &sender)
+{
+    Q_D(DNotification);
+    d->pending.reset(new DNotifySender(sender));
+    d->schedule();
+}
+
+/*!
+@~english
+  @brief Send the latest state now without waiting for the interval, e.g. the final state of a job.
+ */
+void DNotification::flush()
+{
+    Q_D(DNotification);
+    if (d->pending && !d->inFlight)
+        d->sendPending();
+}
+
+/*!
+@~english
+  @brief Close the notification and drop the state not sent yet.
+ */
+void DNotification::close()
+{
+    Q_D(DNotification);
+    d->pending.reset();
+    d->timer.stop();
+    if (d->id == 0)
+        return;
+
+    DDBusSender()
+        .service("org.freedesktop.Notifications")
+        .path("/org/freedesktop/Notifications")
+        .interface("org.freedesktop.Notifications")
+        .method(QString("CloseNotification"))
+        .arg(d->id)
+        .call();
+    d->id = 0;
+}
+
 }  // namespace DUtil
 
 DCORE_END_NAMESPACE
@@ -0,0 +1,296 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dperfcounters.h"
+#include "dexportedinterface.h"
+
+#include <QMutex>
+
+#include <algorithm>
+
+DCORE_BEGIN_NAMESPACE
+
+struct DPerfCounterRegistry
+{
+    QMutex mutex;
+    QVector<DPerfCounter *> counters;
+    QVector<DPerfHistogram *> histograms;
+};
+Q_GLOBAL_STATIC(DPerfCounterRegistry, perfCounterRegistry)
+
+/*!
+@~english
+  @class Dtk::Core::DPerfCounter
+  @inmodule dtkcore
+  @brief A named atomic counter which is read by DPerfCounters.
+
+  The counter registers itself when it's constructed and unregisters when it's destroyed,
+  it's usually a static object in the translation unit of the code it counts.
+  add() is a relaxed atomic addition, so it's cheap enough for the hot paths.
+
+  @note The name isn't copied, it must outlive the counter, e.g. a string literal.
+  @sa DPerfCounters
+ */
+
+/*!
+@~english
+  @fn void DPerfCounter::add(qint64 n)
+  @brief Add \a n to the counter.
+ */
+
+DPerfCounter::DPerfCounter(const char *name) noexcept
+    : m_name(name)
+{
+    auto registry = perfCounterRegistry();
+    QMutexLocker locker(&registry->mutex);
+    registry->counters.append(this);
+}
+
+DPerfCounter::~DPerfCounter()
+{
+    // the counters of other libraries may be destroyed after the registry
+    if (perfCounterRegistry.isDestroyed())
+        return;
+
+    auto registry = perfCounterRegistry();
+    QMutexLocker locker(&registry->mutex);
+    registry->counters.removeOne(this);
+}
+
+void DPerfCounter::reset() noexcept
+{
+    m_value.store(0, std::memory_order_relaxed);
+}
+
+/*!
+@~english
+  @class Dtk::Core::DPerfHistogram
+  @inmodule dtkcore
+  @brief A named histogram of fixed buckets which is read by DPerfCounters.
+
+  The ascending upper bounds of the buckets are given when it's constructed, at most MaxBounds
+  of them, and a value greater than the last bound falls into the last bucket. record() adds
+  to a bucket and the sum with relaxed atomic additions. A ScopedTimer records the
+  microseconds it lives.
+
+  @note The name isn't copied, it must outlive the histogram, e.g. a string literal.
+  @sa DPerfCounters
+ */
+
+DPerfHistogram::DPerfHistogram(const char *name, std::initializer_list<qint64> bounds) noexcept
+    : m_name(name)
+    , m_boundCount(std::min<int>(static_cast<int>(bounds.size()), MaxBounds))
+{
+    Q_ASSERT(bounds.size() <= MaxBounds);
+    Q_ASSERT(std::is_sorted(bounds.begin(), bounds.end()));
+    std::copy_n(bounds.begin(), m_boundCount, m_bounds);
+
+    auto registry = perfCounterRegistry();
+    QMutexLocker locker(&registry->mutex);
+    registry->histograms.append(this);
+}
+
+DPerfHistogram::~DPerfHistogram()
+{
+    if (perfCounterRegistry.isDestroyed())
+        return;
+
+    auto registry = perfCounterRegistry();
+    QMutexLocker locker(&registry->mutex);
+    registry->histograms.removeOne(this);
+}
+
+/*!
+@~english
+  @brief The upper bounds of the buckets except the last one, which is unbounded.
+ */
+QVector<qint64> DPerfHistogram::bounds() const
+{
+    return QVector<qint64>(m_bounds, m_bounds + m_boundCount);
+}
+
+/*!
+@~english
+  @brief The counts of the buckets, there is one more than the bounds.
+ */
+QVector<qint64> DPerfHistogram::counts() const
+{
+    QVector<qint64> result;
+    result.reserve(m_boundCount + 1);
+    for (int i = 0; i <= m_boundCount; ++i)
+        result << m_counts[i].load(std::memory_order_relaxed);
+    return result;
+}
+
+qint64 DPerfHistogram::count() const noexcept
+{
+    qint64 result = 0;
+    for (int i = 0; i <= m_boundCount; ++i)
+        result += m_counts[i].load(std::memory_order_relaxed);
+    return result;
+}
+
+qint64 DPerfHistogram::sum() const noexcept
+{
+    return m_sum.load(std::memory_order_relaxed);
+}
+
+void DPerfHistogram::reset() noexcept
+{
+    for (int i = 0; i <= m_boundCount; ++i)
+        m_counts[i].store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+}
+
+/*!
+@~english
+  @class Dtk::Core::DPerfCounters
+  @inmodule dtkcore
+  @brief The registry of the DPerfCounter and DPerfHistogram objects in the process.
+
+  dtkcore counts its hot paths, e.g. "dconfig.reads", "dconfig.ipc_calls", "dci.cache_hits",
+  "pinyin.lookups", "log.dropped_records" and "watcher.events_coalesced", and applications
+  may add their own. The counters are read by the API or by D-Bus after exportTo().
+
+  Several objects with the same name, e.g. of different libraries, are summed up.
+ */
+
+/*!
+@~english
+  @brief The names of the registered counters, sorted.
+ */
+QStringList DPerfCounters::counterNames()
+{
+    auto registry = perfCounterRegistry();
+    QMutexLocker locker(&registry->mutex);
+    QStringList names;
+    for (const DPerfCounter *counter : std::as_const(registry->counters))
+        names << QString::fromLatin1(counter->name());
+    names.sort();
+    names.removeDuplicates();
+    return names;
+}
+
+/*!
+@~english
+  @brief The names of the registered histograms, sorted.
+ */
+QStringList DPerfCounters::histogramNames()
+{
+    auto registry = perfCounterRegistry();
+    QMutexLocker locker(&registry->mutex);
+    QStringList names;
+    for (const DPerfHistogram *histogram : std::as_const(registry->histograms))
+        names << QString::fromLatin1(histogram->name());
+    names.sort();
+    names.removeDuplicates();
+    return names;
+}
+
+/*!
+@~english
+  @brief The value of the counter \a name, or 0 if no counter has the name.
+ */
+qint64 DPerfCounters::counterValue(const QString &name)
+{
+    auto registry = perfCounterRegistry();
+    QMutexLocker locker(&registry->mutex);
+    qint64 value = 0;
+    for (const DPerfCounter *counter : std::as_const(registry->counters)) {
+        if (name == QLatin1String(counter->name()))
+            value += counter->value();
+    }
+    return value;
+}
+
+/*!
+@~english
+  @brief All of the counters and histograms.
+
+  The map has two entries: "counters" maps the names to the values, and "histograms"
+  maps the names to the maps of "bounds", "counts", "count" and "sum".
+  The counters are read one by one, they aren't a consistent snapshot of a moment.
+ */
+QVariantMap DPerfCounters::snapshot()
+{
+    auto registry = perfCounterRegistry();
+    QMutexLocker locker(&registry->mutex);
+
+    QVariantMap counters;
+    for (const DPerfCounter *counter : std::as_const(registry->counters)) {
+        QVariant &value = counters[QString::fromLatin1(counter->name())];
+        value = value.toLongLong() + counter->value();
+    }
+
+    QVariantMap histograms;
+    for (const DPerfHistogram *histogram : std::as_const(registry->histograms)) {
+        const QString name = QString::fromLatin1(histogram->name());
+        const QVector<qint64> counts = histogram->counts();
+        QVariantMap entry = histograms.value(name).toMap();
+        // the ones of the same name have the same bounds, or the first one wins
+        if (!entry.isEmpty() && entry.value("counts").toList().size() == counts.size()) {
+            QVariantList merged = entry.value("counts").toList();
+            for (int i = 0; i < counts.size(); ++i)
+                merged[i] = merged.at(i).toLongLong() + counts.at(i);
+            entry["counts"] = merged;
+            entry["count"] = entry.value("count").toLongLong() + histogram->count();
+            entry["sum"] = entry.value("sum").toLongLong() + histogram->sum();
+        } else if (entry.isEmpty()) {
+            QVariantList bounds;
+            for (qint64 bound : histogram->bounds())
+                bounds << bound;
+            QVariantList countList;
+            for (qint64 count : counts)
+                countList << count;
+            entry = {
+                {"bounds", bounds},
+                {"counts", countList},
+                {"count", histogram->count()},
+                {"sum", histogram->sum()},
+            };
+        }
+        histograms[name] = entry;
+    }
+
+    return {
+        {"counters", counters},
+        {"histograms", histograms},
+    };
+}
+
+/*!
+@~english
+  @brief Set all of the counters and histograms to 0.
+ */
+void DPerfCounters::reset()
+{
+    auto registry = perfCounterRegistry();
+    QMutexLocker locker(&registry->mutex);
+    for (DPerfCounter *counter : std::as_const(registry->counters))
+        counter->reset();
+    for (DPerfHistogram *histogram : std::as_const(registry->histograms))
+        histogram->reset();
+}
+
+/*!
+@~english
+  @brief Register \a action on \a interface which returns snapshot().
+
+  The result is a map of variants over D-Bus, so the counters of a running application can be
+  read by the call method of com.deepin.ExportedInterface, e.g.
+  `busctl --user call <service> / com.deepin.ExportedInterface call sav perf-counters 0`.
+  If the argument is "reset", the counters are reset after they're read.
+ */
+void DPerfCounters::exportTo(DUtil::DExportedInterface *interface, const QString &action)
+{
+    interface->registerTypedAction(action, QStringLiteral("the performance counters of the process, \"reset\" resets them after reading"),
+                                   [](const QVariantList &arguments) -> QVariant {
+        const QVariantMap result = snapshot();
+        if (arguments.value(0).toString() == QLatin1String("reset"))
+            reset();
+        return result;
+    });
+}
+
+DCORE_END_NAMESPACE
@@ -4,97 +4,116 @@
 
 #include "dpinyin.h"
 
-#include <QFile>
+#include "dpinyindict_p.h"
+#include "dperfcounters.h"
+
 #include <QSet>
-#include <QTextStream>
-#include <QMap>
+#include <QVector>
 #include <QDebug>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QtAlgorithms>
 
-DCORE_BEGIN_NAMESPACE
-
-static QHash<uint, QString> dict = {};
-const char kDictFile[] = ":/dpinyin/resources/dpinyin.dict";
-
-static void InitDict() {
-    if (!dict.isEmpty()) {
-        return;
-    }
-
-    dict.reserve(25333);
+#include <algorithm>
+#include <functional>
 
-    QFile file(kDictFile);
+DCORE_BEGIN_NAMESPACE
 
-    if (!file.open(QIODevice::ReadOnly))
-        return;
+// the words looked up, a batch counts each of its words
+static DPerfCounter pinyinLookups("pinyin.lookups");
 
-    QByteArray content = file.readAll();
+// the dictionary is generated from resources/dpinyin.dict at build time,
+// it's a read-only table which doesn't need to be parsed at runtime.
+static const DPinyinDictEntry *findDictEntry(char16_t codePoint)
+{
+    const auto end = std::end(kPinyinDictEntries);
+    const auto it = std::lower_bound(std::begin(kPinyinDictEntries), end, codePoint,
+                                     [](const DPinyinDictEntry &entry, char16_t value) {
+        return entry.codePoint < value;
+    });
 
-    file.close();
+    if (it == end || it->codePoint != codePoint)
+        return nullptr;
 
-    QTextStream stream(&content, QIODevice::ReadOnly);
+    return it;
+}
 
-    while (!stream.atEnd()) {
-        const QString line = stream.readLine();
-        // comment
-        if (line.startsWith("#"))
-            continue;
-        const QStringList items = line.left(line.indexOf("#")).split(QChar(':'));
+static QString lookupDict(char16_t codePoint)
+{
+    const DPinyinDictEntry *entry = findDictEntry(codePoint);
+    if (!entry)
+        return QString();
 
-        if (items.size() == 2) {
-            dict.insert(items[0].toUInt(nullptr, 16), items[1].trimmed());
-        }
-    }
+    return QString::fromUtf8(kPinyinDictBlob + entry->offset, entry->length);
 }
 
-static void initToneTable(QMap<QChar, QString> &toneTable)
+struct DToneMark
 {
-    if (toneTable.size() > 0)
-        return;
+    char16_t base;
+    char16_t tone;
+};
+
+// the tone marks are all in the range, the other characters are mapped to {0, 0}
+static constexpr int kToneTableSize = 0x200;
 
-    const QString ts = "aāáǎà,oōóǒò,eēéěè,iīíǐì,uūúǔù,vǖǘǚǜ";
+struct DToneTable
+{
+    DToneMark marks[kToneTableSize];
+};
 
-    for (const QString &s : ts.split(",")) {
-        for (int i = 1; i < s.length(); ++i) {
-            toneTable.insert(s.at(i), QString("%1%2").arg(s.at(0)).arg(i));
+// {ā, a1}, the table is built at compile time, so that it needs no initialization
+static constexpr DToneTable makeToneTable()
+{
+    constexpr char16_t ts[] = u"aāáǎà,oōóǒò,eēéěè,iīíǐì,uūúǔù,vǖǘǚǜ";
+
+    DToneTable table {};
+    char16_t base = 0;
+    int tone = 0;
+    for (int i = 0; ts[i]; ++i) {
+        if (ts[i] == u',') {
+            tone = 0;
+            continue;
         }
+
+        if (tone == 0)
+            base = ts[i];
+        else
+            table.marks[ts[i]] = {base, char16_t(u'0' + tone)};
+        ++tone;
     }
+
+    return table;
 }
 
+static constexpr DToneTable kToneTable = makeToneTable();
+
 static QString toned(const QString &str, ToneStyle ts)
 {
     // TS_Tone is default
-    if (ts == TS_Tone)
+    if (ts != TS_NoneTone && ts != TS_ToneNum)
         return str;
 
-    static QMap<QChar, QString> toneTable; // {ā, a1}
-    initToneTable(toneTable);
+    QString newStr;
+    newStr.reserve(str.size() + 1);
+    char16_t toneNum = 0;
 
-    QString newStr = str;
-    QString toneNum = "";
-    
-    // First pass: find tone number and remove tone marks
+    // the tone marks are replaced with the letters in one pass
     for (QChar c : str) {
-        if (toneTable.contains(c)) {
-            QString cv = toneTable.value(c);
-            switch (ts) {
-            case TS_NoneTone:
-                newStr.replace(c, cv.left(1));
-                break;
-            case TS_ToneNum:
-                newStr.replace(c, cv.left(1)); // Remove tone mark first
-                toneNum = cv.right(1); // Extract tone number
-                break;
-            default:
-                break;
-            }
+        const char16_t value = c.unicode();
+        const DToneMark mark = value < kToneTableSize ? kToneTable.marks[value] : DToneMark {0, 0};
+        if (mark.base) {
+            newStr += QChar(mark.base);
+            toneNum = mark.tone;
+        } else {
+            newStr += c;
         }
     }
-    
+
     // For TS_ToneNum, append tone number at the end
-    if (ts == TS_ToneNum && !toneNum.isEmpty()) {
-        newStr += toneNum;
-    }
-    
+    if (ts == TS_ToneNum && toneNum)
+        newStr += QChar(toneNum);
+
     return newStr;
 }
 
@@ -107,46 +126,225 @@ static QStringList toned(const QStringList &words, ToneStyle ts)
     return tonedWords;
 }
 
-static QStringList permutations(const QStringList &list1, const QStringList &list2)
+static QStringList deduplication(const QStringList &list)
 {
-    QStringList ret;
-    for (const QString &str1 : list1)
-        for (const QString &str2 : list2)
-            ret << str1 + str2;
+    QStringList result;
+    QSet<QString> seen;
+    seen.reserve(list.size());
+    for (const QString &item : list) {
+        if (!seen.contains(item)) {
+            seen.insert(item);
+            result.append(item);
+        }
+    }
 
-    return ret;
+    return result;
 }
 
-static QStringList permutations(const QList<QStringList> &pyList)
+// the readings of the words, a character which isn't in the dictionary is used itself
+static QList<QStringList> readingsOf(const QString &words, ToneStyle ts, bool *ok)
 {
-    QStringList result;
+    pinyinLookups.add();
+    if (ok)
+        *ok = true;
+    QList<QStringList> pyList;
+    for (int i = 0; i < words.length(); ++i) {
+        const QString &ret = lookupDict(words.at(i).unicode());
+
+        if (!ret.isEmpty()) {
+            // the readings may be the same after toned, e.g. TS_NoneTone
+            pyList << deduplication(toned(ret.split(","), ts));
+
+        } else {
+            pyList << QStringList(words.at(i));
+            // 部分字没有在词典中找到，使用字本身， ok 可以判断结果
+            if (ok)
+                *ok = false;
+        }
+    }
 
-    if (pyList.size() <= 1)
-        return pyList.value(0, result);
+    return pyList;
+}
 
-    result = permutations(pyList.value(0), pyList.value(1));
+class DPinyinIteratorPrivate
+{
+public:
+    DPinyinIteratorPrivate(const QString &words, ToneStyle ts, DPinyinIterator::Order order);
+
+    bool fetchNext();
+
+    bool advance();
+    bool fillFrom(int begin, int remaining);
+    QString current() const;
+
+    DPinyinIterator::Order order;
+    bool allFound = true;
+    // the readings of every character, the more common one is in the front
+    QList<QStringList> readings;
+    // the index of the current reading of every character
+    QVector<int> indexes;
+    // the sum of the indexes, used by MostCommonFirst
+    int rank = 0;
+    int maxRank = 0;
+    bool atEnd = false;
+
+    QSet<QString> seen;
+    // the next combination which isn't generated before, which is found by hasNext()
+    bool hasPending = false;
+    QString pending;
+};
+
+DPinyinIteratorPrivate::DPinyinIteratorPrivate(const QString &words, ToneStyle ts, DPinyinIterator::Order order)
+    : order(order)
+    , readings(readingsOf(words, ts, &allFound))
+    , indexes(readings.size(), 0)
+    , atEnd(readings.isEmpty())
+{
+    for (const QStringList &list : std::as_const(readings))
+        maxRank += list.size() - 1;
 
-    for (int i = 2; i < pyList.size(); ++i) {
-        result = permutations(result, pyList.value(i));
+    if (order == DPinyinIterator::MostCommonFirst)
+        fillFrom(0, rank);
+}
 
-        // 限制返回的大小，
-        if (result.size() > 0xFFFF) {
-            qWarning() << "Warning: Too many combinations have exceeded the limit\n";
-            break;
+QString DPinyinIteratorPrivate::current() const
+{
+    QString result;
+    for (int i = 0; i < readings.size(); ++i)
+        result += readings.at(i).at(indexes.at(i));
+
+    return result;
+}
+
+// fills the indexes from begin to the end, their sum is remaining, and the
+// indexes in the front are as small as possible
+bool DPinyinIteratorPrivate::fillFrom(int begin, int remaining)
+{
+    for (int i = readings.size() - 1; i >= begin; --i) {
+        indexes[i] = qMin<int>(remaining, readings.at(i).size() - 1);
+        remaining -= indexes.at(i);
+    }
+
+    return remaining == 0;
+}
+
+bool DPinyinIteratorPrivate::advance()
+{
+    if (order == DPinyinIterator::Lexicographic) {
+        for (int i = readings.size() - 1; i >= 0; --i) {
+            if (++indexes[i] < readings.at(i).size())
+                return true;
+            indexes[i] = 0;
         }
+
+        return false;
     }
 
-    return result;
+    // the next indexes of the same rank, one of the suffix is moved to the front
+    int suffix = 0;
+    for (int i = readings.size() - 1; i >= 0; --i) {
+        if (suffix > 0 && indexes.at(i) < readings.at(i).size() - 1) {
+            ++indexes[i];
+            fillFrom(i + 1, suffix - 1);
+            return true;
+        }
+        suffix += indexes.at(i);
+    }
+
+    // it's always possible to fill the indexes with a rank not greater than maxRank
+    if (rank >= maxRank)
+        return false;
+
+    return fillFrom(0, ++rank);
 }
 
-static QStringList deduplication(const QStringList &list)
+bool DPinyinIteratorPrivate::fetchNext()
 {
-    QStringList result;
-    for (const QString &item : list)
-        if (!result.contains(item))
-            result.append(item);
+    if (hasPending)
+        return true;
+
+    while (!atEnd) {
+        QString result = current();
+        atEnd = !advance();
+
+        if (!seen.contains(result)) {
+            seen.insert(result);
+            pending = std::move(result);
+            hasPending = true;
+            return true;
+        }
+    }
 
-    return result;
+    return false;
+}
+
+/*!
+  \class Dtk::Core::DPinyinIterator
+  \brief Generates the pinyin combinations of the words one by one, with polyphonic characters support.
+
+  Unlike pinyin(), the combinations are generated when they are required, and the
+  duplicated ones are skipped, so that the caller can stop early, e.g. a typeahead
+  search which only needs the first matched combination.
+
+  \code
+  DPinyinIterator it("深度音乐", TS_NoneTone, DPinyinIterator::MostCommonFirst);
+  while (it.hasNext())
+      qDebug() << it.next();
+  \endcode
+  \sa Dtk::Core::pinyin, Dtk::Core::commonPinyin
+ */
+
+/*!
+  \enum Dtk::Core::DPinyinIterator::Order
+  \brief The order of the combinations.
+
+  \value Lexicographic The same order as pinyin(), the readings of the last character change first.
+  \value MostCommonFirst The readings in the front of the dictionary are more common, the combinations
+  which use more common readings are generated first, e.g. all the first readings at the beginning.
+ */
+
+/*!
+  \fn Dtk::Core::DPinyinIterator::DPinyinIterator(const QString &words, ToneStyle ts, Order order)
+  \brief Creates an iterator of the combinations of \a words, in the tone style \a ts and \a order.
+ */
+DPinyinIterator::DPinyinIterator(const QString &words, ToneStyle ts, Order order)
+    : d(new DPinyinIteratorPrivate(words, ts, order))
+{
+}
+
+DPinyinIterator::~DPinyinIterator()
+{
+}
+
+/*!
+  \fn bool Dtk::Core::DPinyinIterator::hasNext() const
+  \brief Returns true if there's a combination which isn't returned by next().
+ */
+bool DPinyinIterator::hasNext() const
+{
+    return d->fetchNext();
+}
+
+/*!
+  \fn QString Dtk::Core::DPinyinIterator::next()
+  \brief Returns the next combination, it's empty if there isn't one.
+ */
+QString DPinyinIterator::next()
+{
+    if (!d->fetchNext())
+        return QString();
+
+    d->hasPending = false;
+    return std::move(d->pending);
+}
+
+/*!
+  \fn bool Dtk::Core::DPinyinIterator::isAllFound() const
+  \brief Returns true if all the characters are found in the dictionary, like the ok of pinyin().
+ */
+bool DPinyinIterator::isAllFound() const
+{
+    return d->allFound;
 }
 
 /*!
@@ -184,31 +382,126 @@ QString Chinese2Pinyin(const QString &words)
  */
 QStringList pinyin(const QString &words, ToneStyle ts, bool *ok)
 {
-    if (words.length() < 1)
-        return QStringList();
+    DPinyinIterator it(words, ts);
+    if (ok)
+        *ok = it.isAllFound();
 
-    InitDict();
+    QStringList result;
+    while (it.hasNext()) {
+        // 限制返回的大小，
+        if (result.size() > 0xFFFF) {
+            qWarning() << "Warning: Too many combinations have exceeded the limit\n";
+            break;
+        }
 
+        result << it.next();
+    }
+
+    return result;
+}
+
+/*!
+  \fn QStringList Dtk::Core::commonPinyin(const QString &words, int count, ToneStyle ts, bool *ok)
+  \brief Convert Chinese characters to Pinyin with polyphonic characters support,
+  \brief only the \a count combinations of the most common readings are returned.
+
+  \return pinyin list of the words
+  \sa Dtk::Core::DPinyinIterator
+ */
+QStringList commonPinyin(const QString &words, int count, ToneStyle ts, bool *ok)
+{
+    DPinyinIterator it(words, ts, DPinyinIterator::MostCommonFirst);
+    if (ok)
+        *ok = it.isAllFound();
+
+    QStringList result;
+    while (result.size() < count && it.hasNext())
+        result << it.next();
+
+    return result;
+}
+
+// The different initials of the readings of a character, the one of the first reading is in the
+// front. They are read from the precomputed letters of the dictionary, the readings are parsed
+// only if an initial has a tone mark which is kept by TS_Tone, or it isn't a letter.
+static QString initialsOf(QChar c, ToneStyle ts, bool *found)
+{
+    const DPinyinDictEntry *entry = findDictEntry(c.unicode());
+    *found = entry;
+    if (!entry)
+        return QString(c);
+
+    QString initials;
+    if ((entry->initials & kPinyinIrregularInitial) || (ts == TS_Tone && (entry->initials & kPinyinTonedInitial))) {
+        const QStringList readings = toned(lookupDict(c.unicode()).split(","), ts);
+        for (const QString &reading : readings) {
+            if (!reading.isEmpty() && !initials.contains(reading.at(0)))
+                initials += reading.at(0);
+        }
+    } else {
+        initials += QChar(u'a' + entry->primaryInitial);
+        quint32 letters = entry->initials & kPinyinInitialLetters & ~(1u << entry->primaryInitial);
+        for (; letters; letters &= letters - 1)
+            initials += QChar(u'a' + qCountTrailingZeroBits(letters));
+    }
+
+    return initials.isEmpty() ? QString(c) : initials;
+}
+
+static QStringList firstLettersOf(const QString &words, ToneStyle ts, bool *ok)
+{
+    pinyinLookups.add();
     if (ok)
         *ok = true;
-    QList<QStringList> pyList;
-    for (int i = 0; i < words.length(); ++i) {
-        const uint key = words.at(i).unicode();
-        auto find_result = dict.find(key);
+    if (words.isEmpty())
+        return QStringList();
+
+    QVector<QString> initials;
+    initials.reserve(words.size());
+    qint64 count = 1;
+    for (const QChar &w : words) {
+        bool found = true;
+        initials << initialsOf(w, ts, &found);
+        if (!found && ok)
+            *ok = false;
+        count = qMin<qint64>(count * initials.constLast().size(), 0x10000);
+    }
 
-        if (find_result != dict.end()) {
-            const QString &ret = find_result.value();
-            pyList << toned(ret.split(","), ts);
+    // 限制返回的大小，
+    if (count > 0xFFFF)
+        qWarning() << "Warning: Too many combinations have exceeded the limit\n";
 
-        } else {
-            pyList << QStringList(words.at(i));
-            // 部分字没有在词典中找到，使用字本身， ok 可以判断结果
-            if (ok)
-                *ok = false;
+    // The initials of a character differ from each other, so do the combinations, which are
+    // generated in the order of the readings, the last character changes first.
+    QStringList result;
+    result.reserve(int(count));
+    QVector<int> indexes(initials.size(), 0);
+    QString current;
+    current.reserve(initials.size());
+    for (const QString &list : std::as_const(initials))
+        current += list.at(0);
+
+    Q_FOREVER {
+        result << current;
+        if (result.size() >= count)
+            break;
+
+        int i = initials.size() - 1;
+        for (; i >= 0; --i) {
+            const QString &list = initials.at(i);
+            if (++indexes[i] < list.size()) {
+                current[i] = list.at(indexes.at(i));
+                break;
+            }
+            indexes[i] = 0;
+            current[i] = list.at(0);
         }
+
+        if (i < 0)
+            break;
     }
 
-    return deduplication(permutations(pyList));
+    return result;
 }
 
 /*!
@@ -232,22 +525,100 @@ QStringList firstLetters(const QString &words)
  */
 QStringList firstLetters(const QString &words, ToneStyle ts)
 {
-    QList<QStringList> result;
-    bool ok = false;
-    for (const QChar &w : words) {
-        QStringList pys = pinyin(w, ts, &ok);
-        if (!ok) {
-            result << QStringList(w);
-            continue;
-        }
+    return firstLettersOf(words, ts, nullptr);
+}
+
+class DPinyinBatchRunner : public QRunnable
+{
+public:
+    explicit DPinyinBatchRunner(std::function<void()> function)
+        : function(std::move(function)) {}
 
-        for (QString &py : pys)
-            py = py.left(1);
+    void run() override { function(); }
+
+private:
+    std::function<void()> function;
+};
+
+template<typename Convert>
+static DPinyinBatch convertBatch(const QStringList &words, int maxThreadCount, Convert convert)
+{
+    // every word is written by only one thread
+    QVector<QStringList> results(words.size());
+    QVector<bool> found(words.size(), true);
+    QStringList *resultData = results.data();
+    bool *foundData = found.data();
+    const auto convertRange = [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+            resultData[i] = convert(words.at(i), &foundData[i]);
+    };
+
+    const int threadCount = qMin<int>(maxThreadCount > 0 ? maxThreadCount : QThread::idealThreadCount(),
+                                      words.size() / 64 + 1);
+    if (threadCount <= 1) {
+        convertRange(0, words.size());
+    } else {
+        // the chunks are smaller than words / threads, so that the threads are balanced
+        const int chunkCount = threadCount * 4;
+        const int chunkSize = (words.size() + chunkCount - 1) / chunkCount;
+        QThreadPool pool;
+        pool.setMaxThreadCount(threadCount);
+        for (int begin = 0; begin < words.size(); begin += chunkSize) {
+            const int end = qMin<int>(begin + chunkSize, words.size());
+            pool.start(new DPinyinBatchRunner([&convertRange, begin, end] {
+                convertRange(begin, end);
+            }));
+        }
+        pool.waitForDone();
+    }
 
-        result << pys;
+    DPinyinBatch batch;
+    batch.found = found;
+    batch.offsets.reserve(results.size() + 1);
+    batch.offsets << 0;
+    for (const QStringList &list : std::as_const(results)) {
+        batch.values << list;
+        batch.offsets << batch.values.size();
     }
 
-    return deduplication(permutations(result));
+    return batch;
+}
+
+/*!
+  \class Dtk::Core::DPinyinBatch
+  \brief The results of batchPinyin() and batchFirstLetters().
+
+  The results of all the words are stored in a flat list, \l values, the results of the
+  words \a i are \c values[offsets[i]] to \c values[offsets[i + 1] - 1], and \c found[i]
+  is the ok of pinyin() for it.
+  \sa Dtk::Core::batchPinyin, Dtk::Core::batchFirstLetters
+ */
+
+/*!
+  \fn DPinyinBatch Dtk::Core::batchPinyin(const QStringList &words, ToneStyle ts, int maxThreadCount)
+  \brief Convert a list of words to Pinyin with polyphonic characters support, as pinyin().
+
+  The words are converted in \a maxThreadCount threads at most, which is
+  QThread::idealThreadCount() if it's not greater than 0.
+  \return the results of the words in the same order
+ */
+DPinyinBatch batchPinyin(const QStringList &words, ToneStyle ts, int maxThreadCount)
+{
+    return convertBatch(words, maxThreadCount, [ts](const QString &word, bool *ok) {
+        return pinyin(word, ts, ok);
+    });
+}
+
+/*!
+  \fn DPinyinBatch Dtk::Core::batchFirstLetters(const QStringList &words, ToneStyle ts, int maxThreadCount)
+  \brief Convert a list of words to Pinyin first letters, as firstLetters().
+  \sa Dtk::Core::batchPinyin
+ */
+DPinyinBatch batchFirstLetters(const QStringList &words, ToneStyle ts, int maxThreadCount)
+{
+    return convertBatch(words, maxThreadCount, [ts](const QString &word, bool *ok) {
+        return firstLettersOf(word, ts, ok);
+    });
 }
 
 DCORE_END_NAMESPACE
@@ -0,0 +1,141 @@
+# SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+# Converts resources/dpinyin.dict to a sorted table of code points and one packed
+# UTF-8 blob, so that dpinyin.cpp doesn't parse the dictionary at runtime. The initial
+# letters of the readings of every code point are precomputed for firstLetters().
+# include() this file and call dtk_generate_pinyin_dict(<var>), the generated header
+# is added to <var> and placed in CMAKE_CURRENT_BINARY_DIR.
+
+if(CMAKE_SCRIPT_MODE_FILE)
+  # cmake -DINPUT=<dict> -DOUTPUT=<header> -P dpinyindict.cmake
+  file(STRINGS "${INPUT}" lines ENCODING UTF-8)
+
+  set(items)
+  foreach(line IN LISTS lines)
+    if(line MATCHES "^0x([0-9A-Fa-f]+):([^#]*)")
+      set(codePoint "${CMAKE_MATCH_1}")
+      string(STRIP "${CMAKE_MATCH_2}" value)
+      string(LENGTH "${codePoint}" codePointLength)
+      if(NOT codePointLength EQUAL 4)
+        message(FATAL_ERROR "${INPUT}: only the code points of BMP are supported, \"${line}\"")
+      endif()
+      if(value MATCHES "[\"\\\\]")
+        message(FATAL_ERROR "${INPUT}: invalid pinyin, \"${line}\"")
+      endif()
+      string(TOUPPER "${codePoint}" codePoint)
+      list(APPEND items "${codePoint}:${value}")
+    endif()
+  endforeach()
+  # the code points have the same length, so that they are sorted by value
+  list(SORT items)
+  list(REMOVE_DUPLICATES items)
+
+  # the flags of DPinyinDictEntry::initials
+  math(EXPR tonedFlag "1 << 30")
+  math(EXPR irregularFlag "1 << 31")
+
+  set(entries)
+  set(blob)
+  set(offset 0)
+  set(previous "")
+  foreach(item IN LISTS items)
+    string(SUBSTRING "${item}" 0 4 codePoint)
+    string(SUBSTRING "${item}" 5 -1 value)
+    # quoted, if() would compare with the name of an unset variable
+    if(codePoint STREQUAL "${previous}")
+      message(FATAL_ERROR "${INPUT}: duplicated code point 0x${codePoint}")
+    endif()
+    set(previous "${codePoint}")
+    # the length is in bytes of UTF-8
+    string(LENGTH "${value}" length)
+
+    # the letters of the initials without the tone marks, the first one is of the most common reading
+    set(initials 0)
+    set(primary -1)
+    string(REPLACE "," ";" syllables "${value}")
+    foreach(syllable IN LISTS syllables)
+      set(letter)
+      if(syllable MATCHES "^([a-z])")
+        set(letter "${CMAKE_MATCH_1}")
+      elseif(syllable MATCHES "^(ā|á|ǎ|à)")
+        set(letter a)
+      elseif(syllable MATCHES "^(ō|ó|ǒ|ò)")
+        set(letter o)
+      elseif(syllable MATCHES "^(ē|é|ě|è)")
+        set(letter e)
+      endif()
+
+      # not if(NOT letter), "n" is a false constant of if()
+      if(letter STREQUAL "")
+        # e.g. ń, which is kept by all the tone styles
+        math(EXPR initials "${initials} | ${irregularFlag}")
+      else()
+        if(NOT syllable MATCHES "^[a-z]")
+          math(EXPR initials "${initials} | ${tonedFlag}")
+        endif()
+        string(FIND "abcdefghijklmnopqrstuvwxyz" "${letter}" index)
+        math(EXPR initials "${initials} | (1 << ${index})")
+        if(primary LESS 0)
+          set(primary ${index})
+        endif()
+      endif()
+    endforeach()
+    if(primary LESS 0)
+      set(primary 0)
+    endif()
+
+    string(APPEND entries "    {0x${codePoint}, ${length}, ${offset}, ${initials}u, ${primary}},\n")
+    string(APPEND blob "    \"${value}\"\n")
+    math(EXPR offset "${offset} + ${length}")
+  endforeach()
+
+  file(WRITE "${OUTPUT}"
+"// Generated from dpinyin.dict by dpinyindict.cmake, DO NOT EDIT.
+
+#pragma once
+
+#include <cstdint>
+
+struct DPinyinDictEntry
+{
+    char16_t codePoint;
+    std::uint16_t length;
+    std::uint32_t offset;
+    // bit n is set if a reading starts with the letter 'a' + n when the tone marks are removed
+    std::uint32_t initials;
+    // the letter of the first reading, 'a' + primaryInitial
+    std::uint8_t primaryInitial;
+};
+
+// the initial of a reading has a tone mark, e.g. ā, which is kept by TS_Tone
+static constexpr std::uint32_t kPinyinTonedInitial = 1u << 30;
+// the initial of a reading isn't a letter of a to z, e.g. ń
+static constexpr std::uint32_t kPinyinIrregularInitial = 1u << 31;
+static constexpr std::uint32_t kPinyinInitialLetters = (1u << 26) - 1;
+
+// sorted by codePoint
+static constexpr DPinyinDictEntry kPinyinDictEntries[] = {
+${entries}};
+
+static constexpr char kPinyinDictBlob[] =
+${blob};
+")
+  return()
+endif()
+
+set(DPINYIN_DICT_GENERATOR ${CMAKE_CURRENT_LIST_FILE})
+set(DPINYIN_DICT_FILE ${CMAKE_CURRENT_LIST_DIR}/resources/dpinyin.dict)
+
+function(dtk_generate_pinyin_dict sources)
+  set(header ${CMAKE_CURRENT_BINARY_DIR}/dpinyindict_p.h)
+  add_custom_command(
+    OUTPUT ${header}
+    COMMAND ${CMAKE_COMMAND} -DINPUT=${DPINYIN_DICT_FILE} -DOUTPUT=${header} -P ${DPINYIN_DICT_GENERATOR}
+    DEPENDS ${DPINYIN_DICT_FILE} ${DPINYIN_DICT_GENERATOR}
+    COMMENT "Generating the pinyin dictionary"
+    VERBATIM
+  )
+  set(${sources} ${${sources}} ${header} PARENT_SCOPE)
+endfunction()
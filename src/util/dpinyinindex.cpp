@@ -0,0 +1,268 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dpinyinindex.h"
+#include "dpinyin.h"
+
+#include <QHash>
+#include <QSet>
+
+#include <algorithm>
+
+DCORE_BEGIN_NAMESPACE
+
+class DPinyinIndexPrivate
+{
+public:
+    DPinyinIndexPrivate();
+
+    const QStringList &spellingsOf(QChar c);
+    int childOf(int node, QChar c);
+
+    void collect(int node, int limit, QSet<int> &collected, QSet<int> &result) const;
+
+    // the trie of the characters of the texts, a node is a prefix of the texts
+    struct Node
+    {
+        // by the lower case of the character
+        QHash<QChar, int> children;
+        // the children whose spellings start with the letter
+        QHash<QChar, QVector<int>> childrenByLetter;
+        // the spellings of the character of this node, pinyin without tone and the character itself
+        QStringList spellings;
+        // the texts which end at this node
+        QVector<int> ids;
+    };
+
+    QVector<Node> nodes;
+    QStringList texts;
+    // the spellings are shared by the nodes of the same character
+    QHash<QChar, QStringList> spellingCache;
+};
+
+DPinyinIndexPrivate::DPinyinIndexPrivate()
+    : nodes(1)
+{
+}
+
+const QStringList &DPinyinIndexPrivate::spellingsOf(QChar c)
+{
+    auto it = spellingCache.find(c);
+    if (it != spellingCache.end())
+        return it.value();
+
+    bool ok = false;
+    QStringList spellings = pinyin(QString(c), TS_NoneTone, &ok);
+    if (!ok)
+        spellings.clear();
+    spellings << QString(c);
+
+    return spellingCache.insert(c, spellings).value();
+}
+
+int DPinyinIndexPrivate::childOf(int node, QChar c)
+{
+    const QChar key = c.toLower();
+    auto it = nodes[node].children.constFind(key);
+    if (it != nodes[node].children.cend())
+        return it.value();
+
+    const int child = nodes.size();
+    nodes.append(Node());
+    nodes[child].spellings = spellingsOf(key);
+    nodes[node].children.insert(key, child);
+
+    QSet<QChar> letters;
+    for (const QString &spelling : std::as_const(nodes[child].spellings)) {
+        const QChar letter = spelling.at(0);
+        if (!letters.contains(letter)) {
+            letters.insert(letter);
+            nodes[node].childrenByLetter[letter].append(child);
+        }
+    }
+
+    return child;
+}
+
+// all the texts of the subtree, the subtree which is collected before is skipped
+void DPinyinIndexPrivate::collect(int node, int limit, QSet<int> &collected, QSet<int> &result) const
+{
+    QVector<int> stack {node};
+    while (!stack.isEmpty()) {
+        const int current = stack.takeLast();
+        if (collected.contains(current))
+            continue;
+        collected.insert(current);
+
+        for (int id : nodes.at(current).ids) {
+            if (limit >= 0 && result.size() >= limit)
+                return;
+            result.insert(id);
+        }
+        for (int child : nodes.at(current).children)
+            stack.append(child);
+    }
+}
+
+/*!
+  \class Dtk::Core::DPinyinIndex
+  \inmodule dtkcore
+  \brief Searches the texts by pinyin, e.g. "zhs" of 张三.
+
+  The texts are stored in a trie of their characters, the pinyin of a character
+  is looked up once, so a search only walks the prefixes which can match the query.
+  A character of the text matches the query in any of:
+
+  \list
+  \li the full pinyin of any reading of it, without tone, e.g. "zhangsan"
+  \li a prefix of its pinyin, e.g. the initial letters "zs", or "zhs"
+  \li the character itself, e.g. "张s"
+  \endlist
+
+  and the query can end in the middle of the pinyin of a character, e.g. "zhangsa".
+  The query matches the texts from their beginning, and the letters are case-insensitive.
+
+  \code
+  DPinyinIndex index({"张三", "李四"});
+  index.search("zhs"); // {0}
+  \endcode
+  \sa Dtk::Core::pinyin
+ */
+
+/*!
+  \fn Dtk::Core::DPinyinIndex::DPinyinIndex()
+  \brief Creates an empty index.
+ */
+DPinyinIndex::DPinyinIndex()
+    : d(new DPinyinIndexPrivate())
+{
+}
+
+/*!
+  \fn Dtk::Core::DPinyinIndex::DPinyinIndex(const QStringList &texts)
+  \brief Creates an index of \a texts, the id of a text is its index in \a texts.
+ */
+DPinyinIndex::DPinyinIndex(const QStringList &texts)
+    : DPinyinIndex()
+{
+    for (const QString &text : texts)
+        insert(text);
+}
+
+DPinyinIndex::~DPinyinIndex()
+{
+}
+
+/*!
+  \fn int Dtk::Core::DPinyinIndex::insert(const QString &text)
+  \brief Inserts \a text to the index.
+  \return the id of the text, the ids start from 0, in the order of insertion
+ */
+int DPinyinIndex::insert(const QString &text)
+{
+    const int id = d->texts.size();
+    d->texts << text;
+
+    int node = 0;
+    for (const QChar c : text)
+        node = d->childOf(node, c);
+    d->nodes[node].ids << id;
+
+    return id;
+}
+
+/*!
+  \fn void Dtk::Core::DPinyinIndex::clear()
+  \brief Removes all the texts.
+ */
+void DPinyinIndex::clear()
+{
+    d.reset(new DPinyinIndexPrivate());
+}
+
+/*!
+  \fn int Dtk::Core::DPinyinIndex::size() const
+  \brief Returns the count of the texts.
+ */
+int DPinyinIndex::size() const
+{
+    return d->texts.size();
+}
+
+/*!
+  \fn QString Dtk::Core::DPinyinIndex::text(int id) const
+  \brief Returns the text of \a id.
+ */
+QString DPinyinIndex::text(int id) const
+{
+    return d->texts.value(id);
+}
+
+/*!
+  \fn QVector<int> Dtk::Core::DPinyinIndex::search(const QString &query, int limit) const
+  \brief Returns the ids of the texts which match \a query, at most \a limit ones if it's not negative.
+
+  The ids are in ascending order. If there are more than \a limit matched texts,
+  which ones are returned is undefined.
+ */
+QVector<int> DPinyinIndex::search(const QString &query, int limit) const
+{
+    const QString &q = query.toLower();
+    if (q.isEmpty() || limit == 0)
+        return {};
+
+    QSet<int> result;
+    QSet<int> collected;
+    // the pending nodes and the positions of the query which are matched before them
+    QVector<QPair<int, int>> stack {{0, 0}};
+    QSet<quint64> visited;
+
+    while (!stack.isEmpty() && (limit < 0 || result.size() < limit)) {
+        const QPair<int, int> current = stack.takeLast();
+        const quint64 key = (quint64(current.first) << 32) | quint64(current.second);
+        if (visited.contains(key))
+            continue;
+        visited.insert(key);
+
+        const int pos = current.second;
+        const auto &children = d->nodes.at(current.first).childrenByLetter;
+        auto it = children.constFind(q.at(pos));
+        if (it == children.cend())
+            continue;
+
+        for (int child : it.value()) {
+            for (const QString &spelling : d->nodes.at(child).spellings) {
+                int matched = 0;
+                while (matched < spelling.size() && pos + matched < q.size()
+                       && spelling.at(matched) == q.at(pos + matched)) {
+                    ++matched;
+                }
+                if (matched == 0)
+                    continue;
+
+                // the query ends in the spelling of this character
+                if (pos + matched == q.size()) {
+                    d->collect(child, limit, collected, result);
+                    break;
+                }
+
+                // the full spelling, or a prefix of it which is followed by the next character
+                if (matched == spelling.size())
+                    stack.append({child, pos + matched});
+                for (int length = 1; length <= qMin<int>(matched, spelling.size() - 1); ++length)
+                    stack.append({child, pos + length});
+            }
+        }
+    }
+
+    QVector<int> ids;
+    ids.reserve(result.size());
+    for (int id : std::as_const(result))
+        ids << id;
+    std::sort(ids.begin(), ids.end());
+
+    return ids;
+}
+
+DCORE_END_NAMESPACE
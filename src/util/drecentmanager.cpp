@@ -3,23 +3,373 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "drecentmanager.h"
+#include "dfilewatcher.h"
+#include "base/private/dobject_p.h"
 #include <QMimeDatabase>
+#include <QMimeType>
 #include <QDomDocument>
-#include <QTextStream>
+#include <QSaveFile>
 #include <QDateTime>
 #include <QFileInfo>
+#include <QMutex>
+#include <QLockFile>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QFutureInterface>
 #include <QFile>
+#include <QHash>
 #include <QDir>
 #include <QUrl>
+#include <QVector>
+#include <QTimer>
+#include <QXmlStreamReader>
 #if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
-#include <QStringConverter>
 #include <QTimeZone>
 #endif
 
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
 DCORE_BEGIN_NAMESPACE
 
 #define RECENT_PATH QDir::homePath() + "/.local/share/recently-used.xbel"
 
+#define XBEL_HEADER "<?xml version='1.0' encoding='utf-8'?>\n" \
+    "<xbel xmlns:mime=\"http://www.freedesktop.org/standards/shared-mime-info\" version=\"1.0\" " \
+    "xmlns:bookmark=\"http://www.freedesktop.org/standards/desktop-bookmarks\">\n"
+#define XBEL_TRAILER "</xbel>\n"
+#define LOCK_TIMEOUT 5000
+
+/*
+ * The bookmarks of recently-used.xbel, indexed by the href.
+ *
+ * A bookmark is kept as its XML text, only the one which is added or changed is parsed,
+ * the others are written back as they're read, including the elements unknown to us.
+ * The file is read again if it's changed by another process, which is told by the size
+ * and the modification time.
+ */
+class Q_DECL_HIDDEN RecentIndex
+{
+public:
+    static RecentIndex *instance()
+    {
+        static RecentIndex index;
+        return &index;
+    }
+
+    QMutex mutex;
+    int maxItemCount = -1;
+
+    bool load();
+    bool save();
+
+    int indexOf(const QString &href) const
+    {
+        return m_index.value(href, -1);
+    }
+    const QByteArray &bookmark(int i) const
+    {
+        return m_bookmarks.at(i).xml;
+    }
+    void setBookmark(int i, const QByteArray &xml)
+    {
+        m_bookmarks[i].xml = xml;
+        m_bookmarks[i].parsed = false;
+    }
+    void append(const QString &href, const QByteArray &xml);
+    void moveToEnd(int i);
+    void remove(const QStringList &hrefs);
+
+    QList<DRecentItem> query(const DRecentFilter &filter);
+
+    static QString normalizedHref(const QString &url);
+
+private:
+    struct Bookmark
+    {
+        QString href;
+        QByteArray xml;
+        // the item is parsed from the xml when it's queried the first time
+        bool parsed = false;
+        DRecentItem item;
+    };
+
+    static void parseItem(Bookmark &bookmark);
+
+    void parse(const QByteArray &content);
+    void rebuildIndex();
+
+    QByteArray m_header;
+    QByteArray m_trailer;
+    QVector<Bookmark> m_bookmarks;
+    QHash<QString, int> m_index;
+    qint64 m_size = -1;
+    QDateTime m_modified;
+};
+
+// the same url in the different encoding is the same bookmark
+QString RecentIndex::normalizedHref(const QString &url)
+{
+    const QUrl &parsed = url.startsWith(QLatin1Char('/')) ? QUrl::fromLocalFile(url) : QUrl(url);
+    return QString::fromLatin1(parsed.toEncoded(QUrl::FullyEncoded));
+}
+
+static QString hrefOf(const QByteArray &startTag)
+{
+    int begin = startTag.indexOf("href=");
+    if (begin < 0 || begin + 6 > startTag.size())
+        return QString();
+
+    const char quote = startTag.at(begin + 5);
+    begin += 6;
+    const int end = startTag.indexOf(quote, begin);
+    if (end < 0)
+        return QString();
+
+    QByteArray href = startTag.mid(begin, end - begin);
+    href.replace("&quot;", "\"").replace("&apos;", "'").replace("&lt;", "<").replace("&gt;", ">").replace("&amp;", "&");
+    return RecentIndex::normalizedHref(QString::fromUtf8(href));
+}
+
+static int findBookmark(const QByteArray &content, int from)
+{
+    static const int tagSize = int(sizeof("<bookmark") - 1);
+    for (int pos = content.indexOf("<bookmark", from); pos >= 0; pos = content.indexOf("<bookmark", pos + tagSize)) {
+        // not <bookmark:applications> and the like
+        const char next = pos + tagSize < content.size() ? content.at(pos + tagSize) : '\0';
+        if (next == ' ' || next == '\t' || next == '\r' || next == '\n' || next == '>' || next == '/')
+            return pos;
+    }
+    return -1;
+}
+
+void RecentIndex::parse(const QByteArray &content)
+{
+    m_bookmarks.clear();
+
+    const int rootEnd = content.indexOf("</xbel>");
+    if (!content.contains("<xbel") || rootEnd < 0) {
+        m_header = XBEL_HEADER;
+        m_trailer = XBEL_TRAILER;
+        rebuildIndex();
+        return;
+    }
+
+    int pos = findBookmark(content, 0);
+    m_header = content.left(pos >= 0 ? pos : rootEnd);
+    int last = m_header.size();
+    while (pos >= 0 && pos < rootEnd) {
+        const int tagEnd = content.indexOf('>', pos);
+        if (tagEnd < 0)
+            break;
+
+        int end = tagEnd + 1;
+        if (content.at(tagEnd - 1) != '/') {
+            end = content.indexOf("</bookmark>", tagEnd);
+            if (end < 0)
+                break;
+            end += int(sizeof("</bookmark>") - 1);
+        }
+
+        // keep what's between the bookmarks unless it's only spaces
+        const QByteArray &gap = content.mid(last, pos - last).trimmed();
+        QByteArray xml = content.mid(pos, end - pos);
+        if (!gap.isEmpty())
+            xml.prepend(gap + '\n');
+
+        m_bookmarks.append({hrefOf(content.mid(pos, tagEnd - pos)), xml, false, {}});
+        last = end;
+        pos = findBookmark(content, end);
+    }
+
+    m_trailer = content.mid(last);
+    const int trailerStart = m_trailer.indexOf("</xbel>");
+    const QByteArray &gap = m_trailer.left(trailerStart).trimmed();
+    m_trailer = (gap.isEmpty() ? QByteArray() : gap + '\n') + m_trailer.mid(trailerStart);
+    if (!m_header.endsWith('\n'))
+        m_header.append('\n');
+
+    rebuildIndex();
+}
+
+void RecentIndex::rebuildIndex()
+{
+    m_index.clear();
+    m_index.reserve(m_bookmarks.size());
+    for (int i = 0; i < m_bookmarks.size(); ++i)
+        m_index.insert(m_bookmarks.at(i).href, i);
+}
+
+// reads the file again if it's changed since the last load or save
+bool RecentIndex::load()
+{
+    const QFileInfo info(RECENT_PATH);
+    if (!info.exists()) {
+        if (m_size != 0) {
+            parse(QByteArray());
+            m_size = 0;
+            m_modified = QDateTime();
+        }
+        return true;
+    }
+
+    if (info.size() == m_size && info.lastModified() == m_modified)
+        return true;
+
+    QFile file(info.filePath());
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    parse(file.readAll());
+    m_size = info.size();
+    m_modified = info.lastModified();
+    return true;
+}
+
+bool RecentIndex::save()
+{
+    if (maxItemCount >= 0 && m_bookmarks.size() > maxItemCount) {
+        m_bookmarks.remove(0, m_bookmarks.size() - maxItemCount);
+        rebuildIndex();
+    }
+
+    QSaveFile file(RECENT_PATH);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(m_header);
+    for (const Bookmark &bookmark : std::as_const(m_bookmarks)) {
+        file.write(bookmark.xml);
+        file.write("\n", 1);
+    }
+    file.write(m_trailer);
+    if (!file.commit())
+        return false;
+
+    const QFileInfo info(RECENT_PATH);
+    m_size = info.size();
+    m_modified = info.lastModified();
+    return true;
+}
+
+void RecentIndex::append(const QString &href, const QByteArray &xml)
+{
+    m_index.insert(href, m_bookmarks.size());
+    m_bookmarks.append({href, xml, false, {}});
+}
+
+// the bookmarks are kept in the order of use, the oldest is dropped first
+void RecentIndex::moveToEnd(int i)
+{
+    if (i == m_bookmarks.size() - 1)
+        return;
+
+    m_bookmarks.append(m_bookmarks.takeAt(i));
+    rebuildIndex();
+}
+
+void RecentIndex::remove(const QStringList &hrefs)
+{
+    bool removed = false;
+    for (const QString &href : hrefs) {
+        const int i = indexOf(normalizedHref(href));
+        if (i < 0)
+            continue;
+        m_bookmarks[i].href.clear();
+        removed = true;
+    }
+    if (!removed)
+        return;
+
+    m_bookmarks.erase(std::remove_if(m_bookmarks.begin(), m_bookmarks.end(), [](const Bookmark &bookmark) {
+        return bookmark.href.isEmpty();
+    }), m_bookmarks.end());
+    rebuildIndex();
+}
+
+void RecentIndex::parseItem(Bookmark &bookmark)
+{
+    DRecentItem &item = bookmark.item;
+    item = DRecentItem();
+    QXmlStreamReader reader(bookmark.xml);
+    reader.setNamespaceProcessing(false);
+    while (!reader.atEnd()) {
+        if (reader.readNext() != QXmlStreamReader::StartElement)
+            continue;
+
+        const QXmlStreamAttributes &attributes = reader.attributes();
+        const auto name = reader.qualifiedName();
+        if (name == QLatin1String("bookmark")) {
+            item.uri = attributes.value(QLatin1String("href")).toString();
+            item.added = QDateTime::fromString(attributes.value(QLatin1String("added")).toString(), Qt::ISODate);
+            item.modified = QDateTime::fromString(attributes.value(QLatin1String("modified")).toString(), Qt::ISODate);
+            item.visited = QDateTime::fromString(attributes.value(QLatin1String("visited")).toString(), Qt::ISODate);
+        } else if (name == QLatin1String("mime:mime-type")) {
+            item.mimeType = attributes.value(QLatin1String("type")).toString();
+        } else if (name == QLatin1String("bookmark:application")) {
+            item.applications << attributes.value(QLatin1String("name")).toString();
+        }
+    }
+    bookmark.parsed = true;
+}
+
+static bool matchMimeType(const QString &pattern, const QString &mimeType)
+{
+    // image/* is for all the images
+    if (pattern.endsWith(QLatin1String("/*")))
+        return mimeType.startsWith(pattern.left(pattern.size() - 1));
+    return mimeType == pattern;
+}
+
+// the matched items, the recently visited first
+QList<DRecentItem> RecentIndex::query(const DRecentFilter &filter)
+{
+    QVector<const DRecentItem *> matched;
+    for (Bookmark &bookmark : m_bookmarks) {
+        if (!bookmark.parsed)
+            parseItem(bookmark);
+
+        const DRecentItem &item = bookmark.item;
+        if (!filter.appName.isEmpty() && !item.applications.contains(filter.appName))
+            continue;
+        if (!filter.mimeType.isEmpty() && !matchMimeType(filter.mimeType, item.mimeType))
+            continue;
+        if (filter.since.isValid() && item.visited < filter.since)
+            continue;
+        if (filter.until.isValid() && item.visited > filter.until)
+            continue;
+        matched << &item;
+    }
+
+    auto later = [](const DRecentItem *a, const DRecentItem *b) {
+        return a->visited > b->visited;
+    };
+    auto end = matched.end();
+    if (filter.limit >= 0 && filter.limit < matched.size()) {
+        end = matched.begin() + filter.limit;
+        std::partial_sort(matched.begin(), end, matched.end(), later);
+    } else {
+        std::sort(matched.begin(), matched.end(), later);
+    }
+
+    QList<DRecentItem> items;
+    items.reserve(int(end - matched.begin()));
+    for (auto it = matched.begin(); it != end; ++it)
+        items << **it;
+    return items;
+}
+
+static QByteArray toXml(const QDomDocument &doc)
+{
+    QByteArray xml = doc.toByteArray(2);
+    while (xml.endsWith('\n'))
+        xml.chop(1);
+    return xml;
+}
+
 /*!
   \class Dtk::Core::DRecentManager
   \inmodule dtkcore
@@ -52,66 +402,134 @@ DCORE_BEGIN_NAMESPACE
   \sa Dtk::Core::DRecentManager
  */
 
-/*!
-  \brief DRecentManager::addItem 在最近列表中添加一个项.
-  \a uri 文件路径
-  \a data 数据信息
-  \return 如果返回 true 则成功添加，false 为添加失败
- */
+static QString currentDateTime()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+    return QDateTime::currentDateTime().toTimeZone(QTimeZone::UTC).toString(Qt::ISODate);
+#else
+    return QDateTime::currentDateTime().toTimeSpec(Qt::OffsetFromUTC).toString(Qt::ISODate);
+#endif
+}
 
-bool DRecentManager::addItem(const QString &uri, DRecentData &data)
+// the writers of this process are serialized by the mutex, and the other processes by the lock file
+class Q_DECL_HIDDEN RecentWriteLocker
 {
-    if (!QFileInfo(uri).exists() || uri.isEmpty()) {
-        return false;
+public:
+    explicit RecentWriteLocker(RecentIndex *index)
+        : m_locker(index->mutex)
+        , m_lockFile(RECENT_PATH + ".lock")
+    {
+        m_locked = m_lockFile.tryLock(LOCK_TIMEOUT) && index->load();
     }
 
-    QFile file(RECENT_PATH);
-    file.open(QIODevice::ReadWrite | QIODevice::Text);
+    bool isLocked() const { return m_locked; }
 
-#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
-    QString dateTime = QDateTime::currentDateTime().toTimeZone(QTimeZone::UTC).toString(Qt::ISODate);
-#else
-    QString dateTime = QDateTime::currentDateTime().toTimeSpec(Qt::OffsetFromUTC).toString(Qt::ISODate);
-#endif
-    QDomDocument doc;
+private:
+    std::lock_guard<QMutex> m_locker;
+    QLockFile m_lockFile;
+    bool m_locked = false;
+};
 
-    if (!doc.setContent(&file)) {
-        doc.clear();
-        doc.appendChild(doc.createProcessingInstruction("xml","version=\'1.0\' encoding=\'utf-8\'"));
-        QDomElement xbelEle = doc.createElement("xbel");
-        xbelEle.setAttribute("xmlns:mime", "http://www.freedesktop.org/standards/shared-mime-info");
-        xbelEle.setAttribute("version", "1.0");
-        xbelEle.setAttribute("xmlns:bookmark", "http://www.freedesktop.org/standards/desktop-bookmarks");
-        doc.appendChild(xbelEle);
+class Q_DECL_HIDDEN RecentRunner : public QRunnable
+{
+public:
+    explicit RecentRunner(std::function<void()> function)
+        : function(std::move(function)) {}
+
+    void run() override { function(); }
+
+private:
+    std::function<void()> function;
+};
+
+struct MimeCacheEntry
+{
+    QDateTime modified;
+    qint64 size;
+    QString name;
+};
+
+static QMutex mimeCacheMutex;
+static QHash<QString, MimeCacheEntry> mimeCache;
+static const int MimeCacheSize = 256;
+
+static void cacheMimeType(const QFileInfo &info, const QString &name)
+{
+    QMutexLocker locker(&mimeCacheMutex);
+    if (mimeCache.size() >= MimeCacheSize)
+        mimeCache.clear();
+    mimeCache.insert(info.absoluteFilePath(), {info.lastModified(), info.size(), name});
+}
+
+// sets the mime type of the bookmark of uri if it's still there
+static void updateMimeType(const QString &uri, const QString &mimeType)
+{
+    RecentIndex *index = RecentIndex::instance();
+    RecentWriteLocker locker(index);
+    if (!locker.isLocked()) {
+        return;
     }
-    file.close();
 
-    // need to add file:// protocol.
-    QUrl url = QUrl::fromLocalFile(uri);
+    const int pos = index->indexOf(QUrl::fromLocalFile(uri).toEncoded(QUrl::FullyEncoded));
+    QDomDocument doc;
+    if (pos < 0 || !doc.setContent(index->bookmark(pos))) {
+        return;
+    }
 
-    // get the MimeType name of the file.
-    if (data.mimeType.isEmpty()) {
-        data.mimeType = QMimeDatabase().mimeTypeForFile(uri).name();
+    QDomElement mimeEle = doc.documentElement().elementsByTagName("mime:mime-type").at(0).toElement();
+    if (mimeEle.isNull() || mimeEle.attribute("type") == mimeType) {
+        return;
     }
 
-    QDomElement rootEle = doc.documentElement();
-    QDomNodeList nodeList = rootEle.elementsByTagName("bookmark");
-    QDomElement bookmarkEle;
-    bool isFound = false;
+    mimeEle.setAttribute("type", mimeType);
+    index->setBookmark(pos, toXml(doc));
+    index->save();
+}
 
-    // find bookmark element exists.
-    for (int i = 0; i < nodeList.size(); ++i) {
-        const QString fileUrl = nodeList.at(i).toElement().attribute("href");
+/*
+ * The mime type by the file name, the files are read only when the name doesn't tell, and
+ * then it's done in the thread pool and the bookmark is updated later. The results are
+ * cached by the path, the modification time and the size.
+ */
+static QString mimeTypeName(const QString &uri)
+{
+    const QFileInfo info(uri);
+    {
+        QMutexLocker locker(&mimeCacheMutex);
+        auto it = mimeCache.constFind(info.absoluteFilePath());
+        if (it != mimeCache.constEnd() && it->size == info.size() && it->modified == info.lastModified())
+            return it->name;
+    }
 
-        if (fileUrl == url.toEncoded(QUrl::FullyDecoded)) {
-            bookmarkEle = nodeList.at(i).toElement();
-            isFound = true;
-            break;
-        }
+    const QMimeType &type = QMimeDatabase().mimeTypeForFile(info, QMimeDatabase::MatchExtension);
+    if (!type.isDefault()) {
+        cacheMimeType(info, type.name());
+        return type.name();
     }
 
+    QThreadPool::globalInstance()->start(new RecentRunner([info]() {
+        const QString &name = QMimeDatabase().mimeTypeForFile(info, QMimeDatabase::MatchContent).name();
+        cacheMimeType(info, name);
+        updateMimeType(info.filePath(), name);
+    }));
+    return type.name();
+}
+
+// adds or updates the bookmark of uri, the index is locked and loaded
+static bool mergeItem(RecentIndex *index, const QString &uri, DRecentData &data, const QString &dateTime)
+{
+    // need to add file:// protocol.
+    const QString hrefStr = QUrl::fromLocalFile(uri).toEncoded(QUrl::FullyEncoded);
+
+    const int pos = index->indexOf(hrefStr);
     // update element content.
-    if (isFound) {
+    if (pos >= 0) {
+        QDomDocument doc;
+        if (!doc.setContent(index->bookmark(pos))) {
+            return false;
+        }
+
+        QDomElement bookmarkEle = doc.documentElement();
         QDomNodeList appList = bookmarkEle.elementsByTagName("bookmark:application");
         QDomElement appEle;
         bool appExists = false;
@@ -126,10 +544,10 @@ bool DRecentManager::addItem(const QString &uri, DRecentData &data)
             }
         }
 
+        bookmarkEle.setAttribute("modified", dateTime);
+        bookmarkEle.setAttribute("visited", dateTime);
         if (appExists) {
             int count = appEle.attribute("count").toInt() + 1;
-            bookmarkEle.setAttribute("modified", dateTime);
-            bookmarkEle.setAttribute("visited", dateTime);
             appEle.setAttribute("modified", dateTime);
             appEle.setAttribute("count", QString::number(count));
         } else {
@@ -142,17 +560,26 @@ bool DRecentManager::addItem(const QString &uri, DRecentData &data)
             appEle.setAttribute("count", "1");
             appsNode.toElement().appendChild(appEle);
         }
+
+        index->setBookmark(pos, toXml(doc));
+        index->moveToEnd(pos);
     }
     // add new elements if they don't exist.
     else {
+        // get the MimeType name of the file, only a new bookmark needs it.
+        if (data.mimeType.isEmpty()) {
+            data.mimeType = mimeTypeName(uri);
+        }
+
+        QDomDocument doc;
         QDomElement bookmarkEle, infoEle, metadataEle, mimeEle, appsEle, appChildEle;
-        QString hrefStr = url.toEncoded(QUrl::FullyEncoded);
 
         bookmarkEle = doc.createElement("bookmark");
         bookmarkEle.setAttribute("href", hrefStr);
         bookmarkEle.setAttribute("added", dateTime);
         bookmarkEle.setAttribute("modified", dateTime);
         bookmarkEle.setAttribute("visited", dateTime);
+        doc.appendChild(bookmarkEle);
 
         infoEle = doc.createElement("info");
         bookmarkEle.appendChild(infoEle);
@@ -175,28 +602,69 @@ bool DRecentManager::addItem(const QString &uri, DRecentData &data)
         appsEle.appendChild(appChildEle);
         metadataEle.appendChild(appsEle);
 
-        QDomNode result = rootEle.appendChild(bookmarkEle);
-        if (result.isNull()) {
-            return false;
-        }
+        index->append(hrefStr, toXml(doc));
     }
 
-    // write to file.
-    if (!file.open(QIODevice::WriteOnly)) {
+    return true;
+}
+
+/*!
+  \brief DRecentManager::addItem 在最近列表中添加一个项.
+  \a uri 文件路径
+  \a data 数据信息
+  \return 如果返回 true 则成功添加，false 为添加失败
+ */
+
+bool DRecentManager::addItem(const QString &uri, DRecentData &data)
+{
+    if (!QFileInfo(uri).exists() || uri.isEmpty()) {
         return false;
     }
 
-    QTextStream out(&file);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    out.setEncoding(QStringConverter::Utf8);
-#else
-    out.setCodec("UTF-8");
-#endif
-    out << doc.toString();
-    out.flush();
-    file.close();
+    RecentIndex *index = RecentIndex::instance();
+    RecentWriteLocker locker(index);
+    if (!locker.isLocked() || !mergeItem(index, uri, data, currentDateTime())) {
+        return false;
+    }
 
-    return true;
+    // write to file.
+    return index->save();
+}
+
+/*!
+  \brief DRecentManager::addItems 在后台线程中将多个文件添加到最近列表，只写入一次文件.
+  \a uris 文件路径列表
+  \a data 数据信息，为空的 mimeType 对每个文件分别获取
+  \return 结果的 QFuture，所有文件都添加成功时为 true，不存在的文件被忽略并使结果为 false
+ */
+
+QFuture<bool> DRecentManager::addItems(const QStringList &uris, const DRecentData &data)
+{
+    const auto result = std::make_shared<QFutureInterface<bool>>(QFutureInterfaceBase::Started);
+    QFuture<bool> future = result->future();
+
+    QThreadPool::globalInstance()->start(new RecentRunner([result, uris, data]() {
+        RecentIndex *index = RecentIndex::instance();
+        bool ok = false;
+        {
+            RecentWriteLocker locker(index);
+            if (locker.isLocked()) {
+                ok = true;
+                const QString &dateTime = currentDateTime();
+                for (const QString &uri : uris) {
+                    DRecentData itemData = data;
+                    if (uri.isEmpty() || !QFileInfo(uri).exists() || !mergeItem(index, uri, itemData, dateTime)) {
+                        ok = false;
+                    }
+                }
+                ok = index->save() && ok;
+            }
+        }
+        result->reportResult(ok);
+        result->reportFinished();
+    }));
+
+    return future;
 }
 
 /*!
@@ -216,48 +684,118 @@ void DRecentManager::removeItem(const QString &target)
 
 void DRecentManager::removeItems(const QStringList &list)
 {
-    QFile file(RECENT_PATH);
-
-    if (!file.open(QIODevice::ReadOnly)) {
+    if (!QFile::exists(RECENT_PATH)) {
         return;
     }
 
-    QDomDocument doc;
-    if (!doc.setContent(&file)) {
-        file.close();
+    RecentIndex *index = RecentIndex::instance();
+    RecentWriteLocker locker(index);
+    if (!locker.isLocked()) {
         return;
     }
-    file.close();
 
-    QDomElement rootEle = doc.documentElement();
-    QDomNodeList nodeList = rootEle.elementsByTagName("bookmark");
+    index->remove(list);
+    index->save();
+}
 
-    for (int i = 0; i < nodeList.count(); ) {
-        const QString fileUrl = nodeList.at(i).toElement().attribute("href");
+/*!
+  \brief DRecentManager::setMaxItemCount 设置最近列表保留的最大项数，超出时最久未使用的项被移除
+  \a count 最大项数，小于 0 时不限制，默认不限制
+ */
 
-        if (list.contains(QUrl::fromPercentEncoding(fileUrl.toLatin1())) ||
-            list.contains(QUrl(fileUrl).toEncoded(QUrl::FullyDecoded))) {
-            rootEle.removeChild(nodeList.at(i));
-        } else {
-            ++i;
-        }
+void DRecentManager::setMaxItemCount(int count)
+{
+    RecentIndex *index = RecentIndex::instance();
+    QMutexLocker locker(&index->mutex);
+    index->maxItemCount = count;
+}
+
+/*!
+  \brief DRecentManager::maxItemCount 返回最近列表保留的最大项数
+ */
+
+int DRecentManager::maxItemCount()
+{
+    RecentIndex *index = RecentIndex::instance();
+    QMutexLocker locker(&index->mutex);
+    return index->maxItemCount;
+}
+
+/*!
+  \brief DRecentManager::items 返回最近列表中符合 \a filter 的项，按访问时间从近到远排序.
+
+  列表在内存中被索引，文件只在被其他进程修改后重新读取，每项只在第一次被查询时解析。
+  \a filter 的 mimeType 可以是 "image/*" 这样的通配，limit 小于 0 时返回所有的项。
+  \sa DRecentWatcher
+ */
+
+QList<DRecentItem> DRecentManager::items(const DRecentFilter &filter)
+{
+    RecentIndex *index = RecentIndex::instance();
+    QMutexLocker locker(&index->mutex);
+    if (!index->load()) {
+        return {};
     }
 
-    if (!file.open(QIODevice::WriteOnly)) {
-        return;
+    return index->query(filter);
+}
+
+class DRecentWatcherPrivate : public DObjectPrivate
+{
+public:
+    explicit DRecentWatcherPrivate(DRecentWatcher *qq)
+        : DObjectPrivate(qq)
+    {
     }
 
-    QTextStream out(&file);
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    out.setEncoding(QStringConverter::Utf8);
-#else
-    out.setCodec("UTF-8");
-#endif
-    out << doc.toString();
-    out.flush();
-    file.close();
+    void onFileChanged(const QUrl &url);
+
+    DFileWatcher *watcher = nullptr;
+    QTimer *timer = nullptr;
+
+    D_DECLARE_PUBLIC(DRecentWatcher)
+};
 
-    return;
+void DRecentWatcherPrivate::onFileChanged(const QUrl &url)
+{
+    if (url.toLocalFile() == QString(RECENT_PATH))
+        timer->start();
+}
+
+/*!
+  \class Dtk::Core::DRecentWatcher
+  \inmodule dtkcore
+
+  \brief DRecentWatcher 在最近列表被任意进程修改后发出 changed 信号.
+
+  监听的是 recently-used.xbel 所在的目录，以便文件被替换后仍能收到通知，短时间内的多次修改只通知一次。
+  收到通知后调用 DRecentManager::items 即可得到新的列表。
+ */
+
+DRecentWatcher::DRecentWatcher(QObject *parent)
+    : QObject(parent)
+    , DObject(*new DRecentWatcherPrivate(this))
+{
+    D_D(DRecentWatcher);
+    d->timer = new QTimer(this);
+    d->timer->setSingleShot(true);
+    d->timer->setInterval(100);
+    connect(d->timer, &QTimer::timeout, this, &DRecentWatcher::changed);
+
+    d->watcher = new DFileWatcher(QFileInfo(RECENT_PATH).absolutePath(), this);
+    auto onChanged = [d](const QUrl &url) { d->onFileChanged(url); };
+    connect(d->watcher, &DFileWatcher::fileModified, this, onChanged);
+    connect(d->watcher, &DFileWatcher::fileDeleted, this, onChanged);
+    connect(d->watcher, &DFileWatcher::subfileCreated, this, onChanged);
+    connect(d->watcher, &DFileWatcher::fileMoved, this, [d](const QUrl &from, const QUrl &to) {
+        d->onFileChanged(from);
+        d->onFileChanged(to);
+    });
+    d->watcher->startWatcher();
+}
+
+DRecentWatcher::~DRecentWatcher()
+{
 }
 
 DCORE_END_NAMESPACE
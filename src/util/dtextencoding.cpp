@@ -5,7 +5,14 @@
 #include "dtextencoding.h"
 
 #include <QtMath>
+#include <QtAlgorithms>
 #include <QFile>
+#include <QSaveFile>
+#include <QMutex>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QCache>
 #include <QLibrary>
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 #include <QStringConverter>
@@ -14,9 +21,22 @@
 #endif
 
 #include <climits>
+#include <functional>
+#include <cerrno>
+#include <cstring>
+#include <atomic>
 #include <unicode/ucsdet.h>
 #include <uchardet/uchardet.h>
 #include <iconv.h>
+#ifdef Q_OS_LINUX
+#include <sys/stat.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 DCORE_BEGIN_NAMESPACE
 
@@ -49,7 +69,6 @@ public:
     ~Libuchardet();
 
     bool isValid();
-    QByteArray detectEncoding(const QByteArray &content);
 
     uchardet_t (*uchardet_new)(void);
     void (*uchardet_delete)(uchardet_t ud);
@@ -188,20 +207,6 @@ bool Libuchardet::isValid()
     return uchardet;
 }
 
-QByteArray Libuchardet::detectEncoding(const QByteArray &content)
-{
-    QByteArray charset;
-
-    uchardet_t handle = uchardet_new();
-    if (0 == uchardet_handle_data(handle, content.data(), static_cast<size_t>(content.size()))) {
-        uchardet_data_end(handle);
-        charset = QByteArray(uchardet_get_charset(handle));
-    }
-    uchardet_delete(handle);
-
-    return charset;
-}
-
 QByteArray selectCharset(const QByteArray &charset, const QByteArrayList &icuCharsetList)
 {
     if (icuCharsetList.isEmpty()) {
@@ -220,18 +225,230 @@ QByteArray selectCharset(const QByteArray &charset, const QByteArrayList &icuCha
     }
 }
 
-QByteArray DTextEncoding::detectTextEncoding(const QByteArray &content)
+// the content which is at least this size is long enough for uchardet, ICU isn't used to improve it
+static constexpr int kUchardetConfidentSize = 4096;
+// the chunk size of reading the file
+static constexpr int kDetectChunkSize = 16384;
+
+// validates UTF-8 progressively, the content which contains '\0' isn't regarded as UTF-8,
+// because it's likely UTF-16 or UTF-32 without BOM, or a binary file
+class DUtf8Validator
+{
+public:
+    void feed(const char *data, int size);
+    // truncated: the content is a prefix, which can end in the middle of a character
+    inline bool isValid(bool truncated) const { return valid && (truncated || pending == 0); }
+    inline bool hasFailed() const { return !valid; }
+
+private:
+    bool valid = true;
+    // the count of the continuation bytes of the current character, and the range of the next one
+    int pending = 0;
+    uchar lower = 0x80;
+    uchar upper = 0xBF;
+};
+
+// Returns the length of the leading ASCII characters which aren't '\0', the
+// characters are checked 16 at a time by SSE2 or NEON, or 8 at a time otherwise.
+static inline int asciiLength(const uchar *bytes, int size)
 {
-    if (content.isEmpty()) {
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i));
+        // the high bits are the non-ASCII characters
+        const uint mask = uint(_mm_movemask_epi8(chars)) | uint(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, zero)));
+        if (mask)
+            return i + int(qCountTrailingZeroBits(mask));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t highBit = vdupq_n_u8(0x80);
+    const uint8x16_t zero = vdupq_n_u8(0);
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t chars = vld1q_u8(bytes + i);
+        const uint8x16_t matched = vorrq_u8(vcgeq_u8(chars, highBit), vceqq_u8(chars, zero));
+        // narrow every matched byte to a nibble, the 16 nibbles fit in a 64 bits integer
+        const quint64 mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matched), 4)), 0);
+        if (mask)
+            return i + int(qCountTrailingZeroBits(mask) / 4);
+    }
+#else
+    constexpr quint64 highBits = 0x8080808080808080ULL;
+    constexpr quint64 lowBits = 0x0101010101010101ULL;
+    for (; i + 8 <= size; i += 8) {
+        quint64 word;
+        memcpy(&word, bytes + i, sizeof(word));
+        if ((word & highBits) || ((word - lowBits) & ~word & highBits))
+            break;
+    }
+#endif
+    for (; i < size; ++i) {
+        if (bytes[i] == 0 || bytes[i] >= 0x80)
+            return i;
+    }
+    return size;
+}
+
+void DUtf8Validator::feed(const char *data, int size)
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+
+    int i = 0;
+    while (valid && i < size) {
+        // skip the ASCII characters between the multi-byte characters
+        if (pending == 0) {
+            i += asciiLength(bytes + i, size - i);
+            if (i == size)
+                break;
+        }
+
+        const uchar byte = bytes[i++];
+        if (pending > 0) {
+            if (byte < lower || byte > upper) {
+                valid = false;
+            } else {
+                --pending;
+                lower = 0x80;
+                upper = 0xBF;
+            }
+        } else if (byte == 0) {
+            valid = false;
+        } else if (byte < 0x80) {
+            continue;
+        } else if (byte >= 0xC2 && byte <= 0xDF) {
+            pending = 1;
+        } else if (byte >= 0xE0 && byte <= 0xEF) {
+            pending = 2;
+            // no overlong form and no surrogate
+            if (byte == 0xE0)
+                lower = 0xA0;
+            else if (byte == 0xED)
+                upper = 0x9F;
+        } else if (byte >= 0xF0 && byte <= 0xF4) {
+            pending = 3;
+            // no overlong form and not greater than U+10FFFF
+            if (byte == 0xF0)
+                lower = 0x90;
+            else if (byte == 0xF4)
+                upper = 0x8F;
+        } else {
+            valid = false;
+        }
+    }
+}
+
+// detects the encoding of the content fed in chunks. The valid UTF-8 content, which
+// includes ASCII, is detected without uchardet and ICU, uchardet is fed since the
+// content isn't valid UTF-8, and ICU is only used for the short content.
+// the uchardet handle of a thread, which is reset and reused by the detections of the thread,
+// because a handle can't be shared by threads
+class DUchardetHandle
+{
+public:
+    DUchardetHandle() = default;
+    ~DUchardetHandle()
+    {
+        if (handle)
+            LibuchardetInstance()->uchardet_delete(handle);
+    }
+
+    uchardet_t take()
+    {
+        if (!handle)
+            return LibuchardetInstance()->uchardet_new();
+
+        uchardet_t result = handle;
+        handle = nullptr;
+        LibuchardetInstance()->uchardet_reset(result);
+        return result;
+    }
+
+    void release(uchardet_t used)
+    {
+        if (handle)
+            LibuchardetInstance()->uchardet_delete(used);
+        else
+            handle = used;
+    }
+
+private:
+    uchardet_t handle = nullptr;
+
+    Q_DISABLE_COPY(DUchardetHandle)
+};
+
+static thread_local DUchardetHandle uchardetHandle;
+
+class DEncodingDetector
+{
+public:
+    DEncodingDetector() = default;
+    ~DEncodingDetector();
+
+    void feed(const char *data, int size);
+    QByteArray finish(bool truncated);
+
+private:
+    void feedUchardet(const char *data, int size);
+
+    DUtf8Validator validator;
+    QByteArray content;
+    uchardet_t handle = nullptr;
+
+    Q_DISABLE_COPY(DEncodingDetector)
+};
+
+DEncodingDetector::~DEncodingDetector()
+{
+    if (handle)
+        uchardetHandle.release(handle);
+}
+
+void DEncodingDetector::feedUchardet(const char *data, int size)
+{
+    Libuchardet *uchardet = LibuchardetInstance();
+    if (!uchardet->isValid())
+        return;
+
+    if (!handle) {
+        handle = uchardetHandle.take();
+        // the previous content isn't fed yet
+        data = content.constData();
+        size = content.size();
+    }
+    uchardet->uchardet_handle_data(handle, data, static_cast<size_t>(size));
+}
+
+void DEncodingDetector::feed(const char *data, int size)
+{
+    content.append(data, size);
+
+    if (!validator.hasFailed()) {
+        validator.feed(data, size);
+        if (!validator.hasFailed())
+            return;
+    }
+
+    feedUchardet(data, size);
+}
+
+QByteArray DEncodingDetector::finish(bool truncated)
+{
+    if (content.isEmpty() || validator.isValid(truncated)) {
         return QByteArray("UTF-8");
     }
 
     QByteArray charset;
     if (LibuchardetInstance()->isValid()) {
-        charset = LibuchardetInstance()->detectEncoding(content);
+        // the content ends in the middle of a character, it isn't fed before
+        if (!handle)
+            feedUchardet(nullptr, 0);
+        LibuchardetInstance()->uchardet_data_end(handle);
+        charset = QByteArray(LibuchardetInstance()->uchardet_get_charset(handle));
     }
 
-    if (LibICUInstance()->isValid()) {
+    if (LibICUInstance()->isValid() && (charset.isEmpty() || content.size() < kUchardetConfidentSize)) {
         QByteArrayList icuCharsetList;
         if (LibICUInstance()->detectEncoding(content, icuCharsetList)) {
             if (charset.isEmpty() && !icuCharsetList.isEmpty()) {
@@ -265,24 +482,220 @@ QByteArray DTextEncoding::detectTextEncoding(const QByteArray &content)
     return charset;
 }
 
+QByteArray DTextEncoding::detectTextEncoding(const QByteArray &content)
+{
+    DEncodingDetector detector;
+    detector.feed(content.constData(), content.size());
+    return detector.finish(false);
+}
+
+// the file identity of a detection result, the file is regarded as unchanged when it's the same
+struct DDetectionKey
+{
+    quint64 device = 0;
+    quint64 inode = 0;
+    qint64 mtimeNsecs = 0;
+    qint64 ctimeNsecs = 0;
+    qint64 size = 0;
+
+    bool operator==(const DDetectionKey &other) const
+    {
+        return device == other.device && inode == other.inode && mtimeNsecs == other.mtimeNsecs
+            && ctimeNsecs == other.ctimeNsecs && size == other.size;
+    }
+};
+
+static inline size_t qHash(const DDetectionKey &key, size_t seed = 0)
+{
+    return ::qHash(key.device, seed) ^ ::qHash(key.inode, seed) ^ ::qHash(key.mtimeNsecs, seed) ^ ::qHash(key.size, seed);
+}
+
+// the bounded cache of the file detection results, it's disabled when the size is 0
+class DDetectionCache
+{
+public:
+    DDetectionCache() { cache.setMaxCost(0); }
+
+    // the fd is the opened file, so the identity is the file which is read
+    static bool fileKey(int fd, DDetectionKey *key)
+    {
+#ifdef Q_OS_LINUX
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+            return false;
+        key->device = static_cast<quint64>(info.st_dev);
+        key->inode = static_cast<quint64>(info.st_ino);
+        key->mtimeNsecs = static_cast<qint64>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+        key->ctimeNsecs = static_cast<qint64>(info.st_ctim.tv_sec) * 1000000000 + info.st_ctim.tv_nsec;
+        key->size = static_cast<qint64>(info.st_size);
+        return true;
+#else
+        Q_UNUSED(fd)
+        Q_UNUSED(key)
+        return false;
+#endif
+    }
+
+    bool isEnabled() const { return maxSize.load(std::memory_order_relaxed) > 0; }
+
+    bool find(const DDetectionKey &key, QByteArray *encoding)
+    {
+        QMutexLocker locker(&mutex);
+        if (const QByteArray *item = cache.object(key)) {
+            *encoding = *item;
+            ++hits;
+            return true;
+        }
+        ++misses;
+        return false;
+    }
+
+    void insert(const DDetectionKey &key, const QByteArray &encoding)
+    {
+        QMutexLocker locker(&mutex);
+        cache.insert(key, new QByteArray(encoding));
+    }
+
+    void setMaxSize(int size)
+    {
+        QMutexLocker locker(&mutex);
+        maxSize = qMax(0, size);
+        cache.setMaxCost(maxSize);
+    }
+
+    void clear()
+    {
+        QMutexLocker locker(&mutex);
+        cache.clear();
+        hits = 0;
+        misses = 0;
+    }
+
+    std::atomic<int> maxSize {0};
+    std::atomic<quint64> hits {0};
+    std::atomic<quint64> misses {0};
+
+private:
+    QMutex mutex;
+    QCache<DDetectionKey, QByteArray> cache;
+};
+
+Q_GLOBAL_STATIC(DDetectionCache, detectionCache);
+
 QByteArray DTextEncoding::detectFileEncoding(const QString &fileName, bool *isOk)
 {
     QFile file(fileName);
-    if (!file.open(QFile::ReadOnly | QFile::Text)) {
+    // not QFile::Text, which changes the line endings, e.g. the UTF-16 content
+    if (!file.open(QFile::ReadOnly)) {
         if (isOk) {
             *isOk = false;
         }
         return QByteArray();
     }
 
-    // At most 64Kb data.
-    QByteArray content = file.read(qMin<int>(static_cast<int>(file.size()), USHRT_MAX));
+    DDetectionKey key;
+    const bool cached = detectionCache->isEnabled() && DDetectionCache::fileKey(file.handle(), &key);
+    QByteArray encoding;
+    if (cached && detectionCache->find(key, &encoding)) {
+        if (isOk) {
+            *isOk = true;
+        }
+        return encoding;
+    }
+
+    // At most 64Kb data, which is read in chunks.
+    DEncodingDetector detector;
+    QByteArray chunk(kDetectChunkSize, Qt::Uninitialized);
+    int total = 0;
+    while (total < USHRT_MAX) {
+        const qint64 size = file.read(chunk.data(), qMin(kDetectChunkSize, USHRT_MAX - total));
+        if (size <= 0)
+            break;
+        detector.feed(chunk.constData(), static_cast<int>(size));
+        total += static_cast<int>(size);
+    }
+    const bool truncated = !file.atEnd();
     file.close();
 
     if (isOk) {
         *isOk = true;
     }
-    return detectTextEncoding(content);
+    encoding = detector.finish(truncated);
+    if (cached)
+        detectionCache->insert(key, encoding);
+    return encoding;
+}
+
+void DTextEncoding::setDetectionCacheSize(int size)
+{
+    detectionCache->setMaxSize(size);
+}
+
+int DTextEncoding::detectionCacheSize()
+{
+    return detectionCache->maxSize;
+}
+
+void DTextEncoding::clearDetectionCache()
+{
+    detectionCache->clear();
+}
+
+quint64 DTextEncoding::detectionCacheHits()
+{
+    return detectionCache->hits;
+}
+
+quint64 DTextEncoding::detectionCacheMisses()
+{
+    return detectionCache->misses;
+}
+
+class DTextEncodingRunner : public QRunnable
+{
+public:
+    explicit DTextEncodingRunner(std::function<void()> function)
+        : function(std::move(function)) {}
+
+    void run() override { function(); }
+
+private:
+    std::function<void()> function;
+};
+
+QHash<QString, QByteArray> DTextEncoding::detectFileEncodings(const QStringList &fileNames,
+                                                              const DetectedFunction &detected,
+                                                              int maxThreadCount)
+{
+    QHash<QString, QByteArray> results;
+    QMutex mutex;
+    // the files are taken one by one by the threads, so the threads are balanced
+    QAtomicInt next(0);
+    const auto detect = [&]() {
+        for (int i = next.fetchAndAddRelaxed(1); i < fileNames.size(); i = next.fetchAndAddRelaxed(1)) {
+            const QString &fileName = fileNames.at(i);
+            const QByteArray &encoding = detectFileEncoding(fileName);
+            if (detected)
+                detected(fileName, encoding);
+
+            QMutexLocker locker(&mutex);
+            results.insert(fileName, encoding);
+        }
+    };
+
+    const int threadCount = qMin<int>(maxThreadCount > 0 ? maxThreadCount : QThread::idealThreadCount(), fileNames.size());
+    if (threadCount <= 1) {
+        detect();
+        return results;
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadCount);
+    for (int i = 0; i < threadCount; ++i)
+        pool.start(new DTextEncodingRunner(detect));
+    pool.waitForDone();
+
+    return results;
 }
 
 bool DTextEncoding::convertTextEncoding(
@@ -291,6 +704,170 @@ bool DTextEncoding::convertTextEncoding(
     return convertTextEncodingEx(content, outContent, toEncoding, fromEncoding, errString);
 }
 
+static void setIconvError(QString *errString, int convertError, qint64 converted)
+{
+    switch (convertError) {
+        case EILSEQ:
+            *errString = QString("An invalid multibyte sequence has been encountered in the input."
+                                 "Converted byte index: %1")
+                             .arg(converted);
+            break;
+        case EINVAL:
+            *errString = QString("An incomplete multibyte sequence has been encountered in the input. "
+                                 "Converted byte index: %1")
+                             .arg(converted);
+            break;
+        case E2BIG:
+            *errString = QString("There is not sufficient room at *outbuf. Converted byte index: %1").arg(converted);
+            break;
+        default:
+            break;
+    }
+}
+
+// the iconv handles of a thread, which are reused by the conversions of the same encodings
+class DIconvCache
+{
+public:
+    DIconvCache() = default;
+    ~DIconvCache();
+
+    // returns (iconv_t)-1 and errno is set when it fails, as iconv_open()
+    iconv_t handle(const QByteArray &toEncoding, const QByteArray &fromEncoding);
+
+private:
+    struct Entry
+    {
+        QByteArray toEncoding;
+        QByteArray fromEncoding;
+        iconv_t handle;
+    };
+
+    static constexpr int MaxEntries = 8;
+    // the latest used one is at the end
+    QVector<Entry> entries;
+
+    Q_DISABLE_COPY(DIconvCache)
+};
+
+DIconvCache::~DIconvCache()
+{
+    for (const Entry &entry : std::as_const(entries))
+        iconv_close(entry.handle);
+}
+
+iconv_t DIconvCache::handle(const QByteArray &toEncoding, const QByteArray &fromEncoding)
+{
+    for (int i = entries.size() - 1; i >= 0; --i) {
+        if (entries.at(i).toEncoding == toEncoding && entries.at(i).fromEncoding == fromEncoding) {
+            const Entry entry = entries.at(i);
+            entries.remove(i);
+            entries.append(entry);
+            // reset the shift state of the previous conversion
+            iconv(entry.handle, nullptr, nullptr, nullptr, nullptr);
+            return entry.handle;
+        }
+    }
+
+    iconv_t handle = iconv_open(toEncoding.constData(), fromEncoding.constData());
+    if (reinterpret_cast<iconv_t>(-1) == handle)
+        return handle;
+
+    if (entries.size() >= MaxEntries) {
+        iconv_close(entries.first().handle);
+        entries.removeFirst();
+    }
+    entries.append({toEncoding, fromEncoding, handle});
+    return handle;
+}
+
+static thread_local DIconvCache iconvCache;
+
+// converts the content with the cached iconv handle of the thread, the output buffer is
+// reused and it grows when it isn't enough. Returns the errno of iconv, 0 if it succeeds.
+static int convertWithIconv(iconv_t handle, const char *data, int size, QByteArray &outContent, int *convertedBytes)
+{
+    char *inbuf = const_cast<char *>(data);
+    size_t inBytesLeft = static_cast<size_t>(size);
+    size_t outSize = 0;
+    outContent.resize(qMax<int>(static_cast<int>(outContent.capacity()), size * 2 + 16));
+
+    // converts the content, and then writes the shift sequence of the stateful encodings
+    int convertError = 0;
+    bool flushing = false;
+    while (true) {
+        char *outbuf = outContent.data() + outSize;
+        size_t outBytesLeft = static_cast<size_t>(outContent.size()) - outSize;
+        const size_t ret = flushing ? iconv(handle, nullptr, nullptr, &outbuf, &outBytesLeft)
+                                    : iconv(handle, &inbuf, &inBytesLeft, &outbuf, &outBytesLeft);
+        const int error = errno;
+        outSize = static_cast<size_t>(outContent.size()) - outBytesLeft;
+
+        if (static_cast<size_t>(-1) != ret) {
+            if (flushing)
+                break;
+            flushing = true;
+        } else if (E2BIG == error) {
+            outContent.resize(outContent.size() * 2);
+        } else {
+            convertError = error;
+            break;
+        }
+    }
+
+    if (convertError && convertedBytes)
+        *convertedBytes = size - static_cast<int>(inBytesLeft);
+
+    // Use iconv converted byte count.
+    outContent.resize(static_cast<int>(outSize));
+    return convertError;
+}
+
+// converts with the cached iconv handle of the thread, the content isn't empty
+static bool convertText(const char *data,
+                        int size,
+                        QByteArray &outContent,
+                        const QByteArray &toEncoding,
+                        const QByteArray &fromEncoding,
+                        QString *errString,
+                        int *convertedBytes)
+{
+    if (toEncoding.isEmpty()) {
+        if (errString) {
+            *errString = QStringLiteral("The encode that convert to is empty.");
+        }
+        return false;
+    }
+
+    QByteArray contentEncoding = fromEncoding;
+    if (contentEncoding.isEmpty()) {
+        contentEncoding = DTextEncoding::detectTextEncoding(QByteArray::fromRawData(data, size));
+    }
+
+    // iconv set errno when failed.
+    iconv_t handle = iconvCache.handle(toEncoding, contentEncoding);
+    if (reinterpret_cast<iconv_t>(-1) == handle) {
+        if (EINVAL == errno && errString) {
+            *errString = QStringLiteral("The conversion from fromcode to tocode is not supported by the implementation.");
+        }
+        return false;
+    }
+
+    int converted = 0;
+    const int convertError = convertWithIconv(handle, data, size, outContent, &converted);
+    if (convertError) {
+        if (convertedBytes) {
+            *convertedBytes = converted;
+        }
+        if (errString) {
+            setIconvError(errString, convertError, converted);
+        }
+    }
+
+    // For errors, user decides to keep or remove converted text.
+    return 0 == convertError;
+}
+
 bool DTextEncoding::convertTextEncodingEx(QByteArray &content,
                                           QByteArray &outContent,
                                           const QByteArray &toEncoding,
@@ -302,6 +879,109 @@ bool DTextEncoding::convertTextEncodingEx(QByteArray &content,
         return true;
     }
 
+    // the output buffer can't be the content
+    if (&outContent == &content) {
+        QByteArray buffer;
+        const bool ok = convertText(content.constData(), content.size(), buffer, toEncoding, fromEncoding, errString, convertedBytes);
+        outContent = buffer;
+        return ok;
+    }
+
+    return convertText(content.constData(), content.size(), outContent, toEncoding, fromEncoding, errString, convertedBytes);
+}
+
+class DTextConverterPrivate
+{
+public:
+    QByteArray toEncoding;
+    QByteArray fromEncoding;
+};
+
+DTextConverter::DTextConverter(const QByteArray &toEncoding, const QByteArray &fromEncoding)
+    : d(new DTextConverterPrivate {toEncoding, fromEncoding})
+{
+}
+
+DTextConverter::~DTextConverter()
+{
+}
+
+QByteArray DTextConverter::toEncoding() const
+{
+    return d->toEncoding;
+}
+
+QByteArray DTextConverter::fromEncoding() const
+{
+    return d->fromEncoding;
+}
+
+bool DTextConverter::isValid() const
+{
+    if (d->toEncoding.isEmpty())
+        return false;
+    if (d->fromEncoding.isEmpty() || d->fromEncoding == d->toEncoding)
+        return true;
+
+    return reinterpret_cast<iconv_t>(-1) != iconvCache.handle(d->toEncoding, d->fromEncoding);
+}
+
+bool DTextConverter::convert(const char *data, int size, QByteArray &outContent, QString *errString, int *convertedBytes) const
+{
+    if (size <= 0) {
+        outContent.clear();
+        return true;
+    }
+
+    if (d->fromEncoding == d->toEncoding) {
+        outContent = QByteArray(data, size);
+        return true;
+    }
+
+    return convertText(data, size, outContent, d->toEncoding, d->fromEncoding, errString, convertedBytes);
+}
+
+bool DTextConverter::convert(const QByteArray &content, QByteArray &outContent, QString *errString, int *convertedBytes) const
+{
+    if (&outContent == &content) {
+        QByteArray buffer;
+        const bool ok = convert(content.constData(), content.size(), buffer, errString, convertedBytes);
+        outContent = buffer;
+        return ok;
+    }
+
+    return convert(content.constData(), content.size(), outContent, errString, convertedBytes);
+}
+
+bool DTextConverter::convert(const QByteArrayList &contents, QByteArrayList &outContents, QString *errString) const
+{
+    // the buffers of outContents are reused
+    while (outContents.size() > contents.size())
+        outContents.removeLast();
+    while (outContents.size() < contents.size())
+        outContents.append(QByteArray());
+
+    for (int i = 0; i < contents.size(); ++i) {
+        if (!convert(contents.at(i).constData(), contents.at(i).size(), outContents[i], errString)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the size of the input which is converted at a time
+static constexpr int kConvertChunkSize = 65536;
+
+// converts the content of in to out chunk by chunk, the incomplete multibyte sequence
+// at the end of a chunk is carried to the next one, so the memory is bounded
+static bool convertStream(QFileDevice &in,
+                          QIODevice &out,
+                          const QByteArray &toEncoding,
+                          const QByteArray &fromEncoding,
+                          QString *errString,
+                          const DTextEncoding::ProgressFunction &progress)
+{
     if (toEncoding.isEmpty()) {
         if (errString) {
             *errString = QStringLiteral("The encode that convert to is empty.");
@@ -309,103 +989,137 @@ bool DTextEncoding::convertTextEncodingEx(QByteArray &content,
         return false;
     }
 
-    QByteArray contentEncoding = fromEncoding;
-    if (contentEncoding.isEmpty()) {
-        contentEncoding = detectTextEncoding(content);
+    iconv_t handle = iconv_open(toEncoding.constData(), fromEncoding.constData());
+    if (reinterpret_cast<iconv_t>(-1) == handle) {
+        if (EINVAL == errno && errString) {
+            *errString = QStringLiteral("The conversion from fromcode to tocode is not supported by the implementation.");
+        }
+        return false;
     }
 
-    // iconv set errno when failed.
-    iconv_t handle = iconv_open(toEncoding.data(), contentEncoding.data());
-    if (reinterpret_cast<iconv_t>(-1) != handle) {
-        size_t inBytesLeft = static_cast<size_t>(content.size());
-        char *inbuf = content.data();
-        size_t outBytesLeft = inBytesLeft * 4;
-        char *outbuf = new char[outBytesLeft];
-
-        char *bufferHeader = outbuf;
-        size_t maxBufferSize = outBytesLeft;
-
-        size_t ret = iconv(handle, &inbuf, &inBytesLeft, &outbuf, &outBytesLeft);
-        int convertError = 0;
-        if (static_cast<size_t>(-1) == ret) {
-            convertError = errno;
-            int converted = content.size() - static_cast<int>(inBytesLeft);
-            if (convertedBytes) {
-                *convertedBytes = converted;
-            }
+    const qint64 totalBytes = in.size();
+    qint64 converted = 0;
+    QByteArray input;
+    QByteArray output(kConvertChunkSize * 4, Qt::Uninitialized);
+    bool ok = true;
+    bool atEnd = false;
 
+    auto writeOutput = [&](size_t size) {
+        if (size > 0 && out.write(output.constData(), static_cast<qint64>(size)) != static_cast<qint64>(size)) {
             if (errString) {
-                switch (convertError) {
-                    case EILSEQ:
-                        *errString = QString("An invalid multibyte sequence has been encountered in the input."
-                                             "Converted byte index: %1")
-                                         .arg(converted);
-                        break;
-                    case EINVAL:
-                        *errString = QString("An incomplete multibyte sequence has been encountered in the input. "
-                                             "Converted byte index: %1")
-                                         .arg(converted);
-                        break;
-                    case E2BIG:
-                        *errString = QString("There is not sufficient room at *outbuf. Converted byte index: %1").arg(converted);
-                        break;
-                    default:
-                        break;
-                }
+                *errString = out.errorString();
             }
+            return false;
         }
-        iconv_close(handle);
+        return true;
+    };
 
-        // Use iconv converted byte count.
-        size_t realConvertSize = maxBufferSize - outBytesLeft;
-        outContent = QByteArray(bufferHeader, static_cast<int>(realConvertSize));
+    while (ok && !atEnd) {
+        const QByteArray chunk = in.read(kConvertChunkSize);
+        if (chunk.isEmpty()) {
+            if (in.error() != QFileDevice::NoError) {
+                if (errString) {
+                    *errString = in.errorString();
+                }
+                ok = false;
+                break;
+            }
+            atEnd = true;
+        }
+        input += chunk;
+
+        char *inbuf = input.data();
+        size_t inBytesLeft = static_cast<size_t>(input.size());
+        while (inBytesLeft > 0) {
+            char *outbuf = output.data();
+            size_t outBytesLeft = static_cast<size_t>(output.size());
+            const size_t ret = iconv(handle, &inbuf, &inBytesLeft, &outbuf, &outBytesLeft);
+            const int convertError = errno;
+
+            if (!writeOutput(static_cast<size_t>(output.size()) - outBytesLeft)) {
+                ok = false;
+                break;
+            }
+            if (static_cast<size_t>(-1) != ret || E2BIG == convertError) {
+                continue;
+            }
+            // the incomplete multibyte sequence is completed by the next chunk
+            if (EINVAL == convertError && !atEnd) {
+                break;
+            }
 
-        delete[] bufferHeader;
-        // For errors, user decides to keep or remove converted text.
-        return 0 == convertError;
+            if (errString) {
+                setIconvError(errString, convertError, converted + (inbuf - input.data()));
+            }
+            ok = false;
+            break;
+        }
 
-    } else {
-        if (EINVAL == errno && errString) {
-            *errString = QStringLiteral("The conversion from fromcode to tocode is not supported by the implementation.");
+        converted += inbuf - input.data();
+        input.remove(0, static_cast<int>(inbuf - input.data()));
+        if (ok && progress) {
+            progress(converted, totalBytes);
         }
+    }
 
-        return false;
+    if (ok) {
+        // the shift sequence of the stateful encodings
+        char *outbuf = output.data();
+        size_t outBytesLeft = static_cast<size_t>(output.size());
+        iconv(handle, nullptr, nullptr, &outbuf, &outBytesLeft);
+        ok = writeOutput(static_cast<size_t>(output.size()) - outBytesLeft);
     }
+
+    iconv_close(handle);
+    return ok;
 }
 
 bool DTextEncoding::convertFileEncoding(const QString &fileName,
                                         const QByteArray &toEncoding,
                                         const QByteArray &fromEncoding,
                                         QString *errString)
+{
+    return convertFileEncoding(fileName, toEncoding, fromEncoding, errString, ProgressFunction());
+}
+
+bool DTextEncoding::convertFileEncoding(const QString &fileName,
+                                        const QByteArray &toEncoding,
+                                        const QByteArray &fromEncoding,
+                                        QString *errString,
+                                        const ProgressFunction &progress)
 {
     if (fromEncoding == toEncoding) {
         return true;
     }
 
     QFile file(fileName);
-    if (!file.open(QFile::ReadWrite | QFile::Text)) {
+    if (!file.open(QFile::ReadOnly)) {
         if (errString) {
             *errString = file.errorString();
-            file.error();
         }
         return false;
     }
 
-    QByteArray content = file.readAll();
-    QByteArray outContent;
-    if (!convertTextEncoding(content, outContent, toEncoding, fromEncoding, errString)) {
-        file.close();
+    // the converted content is written to a temporary file, which replaces the file
+    // after all the content is converted, so the file is kept if it fails
+    QSaveFile saveFile(fileName);
+    if (!saveFile.open(QFile::WriteOnly)) {
+        if (errString) {
+            *errString = saveFile.errorString();
+        }
         return false;
     }
 
-    file.seek(0);
-    file.write(outContent);
-    file.resize(outContent.size());
+    const QByteArray &contentEncoding = fromEncoding.isEmpty() ? detectFileEncoding(fileName) : fromEncoding;
+    if (!convertStream(file, saveFile, toEncoding, contentEncoding, errString, progress)) {
+        saveFile.cancelWriting();
+        return false;
+    }
     file.close();
 
-    if (QFile::NoError != file.error()) {
+    if (!saveFile.commit()) {
         if (errString) {
-            *errString = file.errorString();
+            *errString = saveFile.errorString();
         }
         return false;
     }
@@ -417,26 +1131,37 @@ bool DTextEncoding::convertFileEncodingTo(const QString &fromFile,
                                           const QByteArray &toEncoding,
                                           const QByteArray &fromEncoding,
                                           QString *errString)
+{
+    return convertFileEncodingTo(fromFile, toFile, toEncoding, fromEncoding, errString, ProgressFunction());
+}
+
+bool DTextEncoding::convertFileEncodingTo(const QString &fromFile,
+                                          const QString &toFile,
+                                          const QByteArray &toEncoding,
+                                          const QByteArray &fromEncoding,
+                                          QString *errString,
+                                          const ProgressFunction &progress)
 {
     if (fromEncoding == toEncoding) {
         return true;
     }
 
     if (fromFile == toFile) {
-        return convertFileEncoding(fromFile, toEncoding, fromEncoding, errString);
+        return convertFileEncoding(fromFile, toEncoding, fromEncoding, errString, progress);
     }
 
     // Check from file and to file before convert.
     QFile readFile(fromFile);
-    if (!readFile.open(QFile::ReadOnly | QFile::Text)) {
+    if (!readFile.open(QFile::ReadOnly)) {
         if (errString) {
             *errString = QString("Open convert from file failed, %1").arg(readFile.errorString());
         }
         return false;
     }
 
-    QFile writeFile(toFile);
-    if (!writeFile.open(QFile::WriteOnly | QFile::Text)) {
+    // the to file isn't created or changed if it fails
+    QSaveFile writeFile(toFile);
+    if (!writeFile.open(QFile::WriteOnly)) {
         readFile.close();
         if (errString) {
             *errString = QString("Open convert to file failed, %1").arg(writeFile.errorString());
@@ -444,20 +1169,14 @@ bool DTextEncoding::convertFileEncodingTo(const QString &fromFile,
         return false;
     }
 
-    QByteArray content = readFile.readAll();
-    readFile.close();
-    QByteArray outContent;
-
-    if (!convertTextEncoding(content, outContent, toEncoding, fromEncoding, errString)) {
-        writeFile.close();
-        writeFile.remove();
+    const QByteArray &contentEncoding = fromEncoding.isEmpty() ? detectFileEncoding(fromFile) : fromEncoding;
+    if (!convertStream(readFile, writeFile, toEncoding, contentEncoding, errString, progress)) {
+        writeFile.cancelWriting();
         return false;
     }
+    readFile.close();
 
-    writeFile.write(outContent);
-    writeFile.close();
-
-    if (QFile::NoError != writeFile.error()) {
+    if (!writeFile.commit()) {
         if (errString) {
             *errString = writeFile.errorString();
         }
@@ -0,0 +1,242 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dthreadpool.h"
+
+#include <QDeadlineTimer>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+DCORE_BEGIN_NAMESPACE
+
+class Q_DECL_HIDDEN DThreadPoolPrivate
+{
+public:
+    using Task = DThreadPool::AbstractTask;
+
+    // the owner takes the newest task from the back, the thieves take the oldest ones from the front.
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Task *> tasks;
+        QThread *thread = nullptr;
+    };
+
+    explicit DThreadPoolPrivate(DThreadPool *pool)
+        : pool(pool)
+    {
+    }
+
+    Task *pop(int index);
+    Task *steal(int index);
+    void push(int index, Task *task);
+    void work(int index);
+
+    DThreadPool *pool;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<unsigned> nextWorker{0};
+
+    // the tasks in the deques, the workers sleep when it's zero.
+    std::atomic<int> queued{0};
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    bool stopping = false;
+
+    // the tasks submitted and not finished yet.
+    std::atomic<int> pending{0};
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+
+    static thread_local DThreadPoolPrivate *currentPool;
+    static thread_local int currentWorker;
+};
+
+thread_local DThreadPoolPrivate *DThreadPoolPrivate::currentPool = nullptr;
+thread_local int DThreadPoolPrivate::currentWorker = -1;
+
+DThreadPoolPrivate::Task *DThreadPoolPrivate::pop(int index)
+{
+    Worker *worker = workers[index].get();
+    std::lock_guard<std::mutex> locker(worker->mutex);
+    if (worker->tasks.empty())
+        return nullptr;
+
+    Task *task = worker->tasks.back();
+    worker->tasks.pop_back();
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+}
+
+DThreadPoolPrivate::Task *DThreadPoolPrivate::steal(int index)
+{
+    const int count = static_cast<int>(workers.size());
+    for (int i = 1; i < count; ++i) {
+        Worker *victim = workers[(index + i) % count].get();
+        std::unique_lock<std::mutex> locker(victim->mutex, std::try_to_lock);
+        if (!locker.owns_lock() || victim->tasks.empty())
+            continue;
+
+        Task *task = victim->tasks.front();
+        victim->tasks.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    }
+    return nullptr;
+}
+
+void DThreadPoolPrivate::push(int index, Task *task)
+{
+    Worker *worker = workers[index].get();
+    {
+        std::lock_guard<std::mutex> locker(worker->mutex);
+        worker->tasks.push_back(task);
+    }
+    queued.fetch_add(1, std::memory_order_release);
+
+    // take the lock so that the wakeup isn't lost between a worker's check and its wait.
+    { std::lock_guard<std::mutex> locker(sleepMutex); }
+    sleepCondition.notify_one();
+}
+
+void DThreadPoolPrivate::work(int index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+        Task *task = pop(index);
+        if (!task)
+            task = steal(index);
+
+        if (task) {
+            task->run();
+            delete task;
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                { std::lock_guard<std::mutex> locker(doneMutex); }
+                doneCondition.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> locker(sleepMutex);
+        if (queued.load(std::memory_order_acquire) > 0)
+            continue; // a try_lock in steal() missed it
+        if (stopping)
+            break;
+        sleepCondition.wait(locker, [this] {
+            return stopping || queued.load(std::memory_order_acquire) > 0;
+        });
+    }
+
+    currentPool = nullptr;
+    currentWorker = -1;
+}
+
+/*!
+@~english
+  @class Dtk::Core::DThreadPool
+  @brief A pool of threads for the CPU bound work, the results are returned by QFuture.
+
+  Every worker owns a deque of tasks, a worker runs its own tasks in LIFO order and steals
+  the oldest tasks of the others when it's idle. The tasks submitted by a worker go to its
+  own deque, the others are spread over the workers in turn.
+
+  The tasks are started in the pool threads, unlike DThreadUtils, so they must not touch
+  the objects living in other threads without synchronizing.
+ */
+
+DThreadPool::DThreadPool(int threadCount)
+    : d(new DThreadPoolPrivate(this))
+{
+    threadCount = qMax(1, threadCount);
+    d->workers.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i)
+        d->workers.emplace_back(new DThreadPoolPrivate::Worker);
+
+    for (int i = 0; i < threadCount; ++i) {
+        QThread *thread = QThread::create([this, i] { d->work(i); });
+        thread->setObjectName(QStringLiteral("DThreadPool#%1").arg(i));
+        d->workers[i]->thread = thread;
+        thread->start();
+    }
+}
+
+/*!
+@~english
+  @brief Wait for all of the tasks and stop the threads, it must not be called in a task of the pool.
+ */
+DThreadPool::~DThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> locker(d->sleepMutex);
+        d->stopping = true;
+    }
+    d->sleepCondition.notify_all();
+
+    for (const auto &worker : d->workers) {
+        worker->thread->wait();
+        delete worker->thread;
+    }
+}
+
+/*!
+@~english
+  @brief The pool shared in the process, it has QThread::idealThreadCount() threads.
+ */
+DThreadPool &DThreadPool::global()
+{
+    static DThreadPool pool;
+    return pool;
+}
+
+int DThreadPool::threadCount() const
+{
+    return static_cast<int>(d->workers.size());
+}
+
+/*!
+@~english
+  @brief The number of the tasks which are queued or running.
+ */
+int DThreadPool::pendingCount() const
+{
+    return d->pending.load(std::memory_order_acquire);
+}
+
+/*!
+@~english
+  @brief Wait for all of the tasks for \a msecs milliseconds at most, -1 means no time limit.
+
+  Returns false if the time is out. It must not be called in a task of the pool.
+ */
+bool DThreadPool::waitForDone(int msecs)
+{
+    QDeadlineTimer deadline(msecs);
+    std::unique_lock<std::mutex> locker(d->doneMutex);
+    auto done = [this] { return d->pending.load(std::memory_order_acquire) == 0; };
+    if (deadline.isForever()) {
+        d->doneCondition.wait(locker, done);
+        return true;
+    }
+    return d->doneCondition.wait_for(locker, std::chrono::milliseconds(deadline.remainingTime()), done);
+}
+
+void DThreadPool::submit(AbstractTask *task)
+{
+    d->pending.fetch_add(1, std::memory_order_acq_rel);
+
+    // the nested tasks stay in the worker, their data is likely in its cache.
+    int index = DThreadPoolPrivate::currentWorker;
+    if (DThreadPoolPrivate::currentPool != d.data())
+        index = d->nextWorker.fetch_add(1, std::memory_order_relaxed) % d->workers.size();
+
+    d->push(index, task);
+}
+
+DCORE_END_NAMESPACE
@@ -4,10 +4,102 @@
 
 #include "dthreadutils.h"
 
+#if DTK_VERSION < DTK_VERSION_CHECK(6, 0, 0, 0)
+#include <QEvent>
+#include <QHash>
+#include <QMutex>
+#endif
+
 DCORE_BEGIN_NAMESPACE
 
 #if DTK_VERSION < DTK_VERSION_CHECK(6, 0, 0, 0)
 namespace DThreadUtil {
+// the record lives in the caller's stack, the caller is blocked until it's run or dropped.
+class Q_DECL_HIDDEN SyncCallEvent : public QEvent
+{
+public:
+    SyncCallEvent(QSemaphore *s, QObject *target, FunctionType *func)
+        : QEvent(eventType())
+        , semaphore(s)
+        , target(target)
+        , hasTarget(target)
+        , function(func)
+    {
+    }
+
+    ~SyncCallEvent() override
+    {
+        // dropped by the receiver, e.g. the thread is finished, don't leave the caller blocked.
+        if (Q_UNLIKELY(!done)) {
+            qWarning() << "DThreadUtils::runInThread:" << "the call is dropped, the thread finished";
+            semaphore->release();
+        }
+    }
+
+    void call()
+    {
+        if (Q_LIKELY(!hasTarget || target)) {
+            (*function)();
+        } else {
+            qWarning() << "DThreadUtils::runInThread:" << "The target object is destoryed";
+        }
+        done = true;
+        semaphore->release();
+    }
+
+    static QEvent::Type eventType()
+    {
+        static const QEvent::Type type = static_cast<QEvent::Type>(QEvent::registerEventType());
+        return type;
+    }
+
+private:
+    QSemaphore *semaphore;
+    QPointer<QObject> target;
+    bool hasTarget;
+    bool done = false;
+    FunctionType *function;
+};
+
+class Q_DECL_HIDDEN SyncCallReceiver : public QObject
+{
+public:
+    bool event(QEvent *event) override
+    {
+        if (event->type() == SyncCallEvent::eventType()) {
+            static_cast<SyncCallEvent *>(event)->call();
+            return true;
+        }
+        return QObject::event(event);
+    }
+};
+
+// one receiver for each target thread, it's kept until the thread finishes.
+// the event is posted with the lock held, the receiver can't be deleted by the
+// finished thread in the meantime, and the posted event is dropped with the receiver.
+static void postSyncCall(QThread *thread, SyncCallEvent *event)
+{
+    static QMutex mutex;
+    static QHash<QThread *, SyncCallReceiver *> receivers;
+
+    QMutexLocker locker(&mutex);
+    SyncCallReceiver *receiver = receivers.value(thread);
+    if (!receiver) {
+        receiver = new SyncCallReceiver;
+        receiver->moveToThread(thread);
+        receivers.insert(thread, receiver);
+
+        auto release = [thread] {
+            QMutexLocker locker(&mutex);
+            delete receivers.take(thread);
+        };
+        QObject::connect(thread, &QThread::finished, receiver, release, Qt::DirectConnection);
+        QObject::connect(thread, &QObject::destroyed, receiver, release, Qt::DirectConnection);
+    }
+
+    QCoreApplication::postEvent(receiver, event);
+}
+
 FunctionCallProxy::FunctionCallProxy(QThread *thread)
 {
     qRegisterMetaType<QPointer<QObject>>();
@@ -31,20 +123,24 @@ void FunctionCallProxy::proxyCall(QSemaphore *s, QThread *thread, QObject *targe
     if (QThread::currentThread() == thread)
         return fun();
 
-    FunctionCallProxy proxy(thread);
-    proxy.moveToThread(thread);
-
     // 如果线程未开启事件循环，且不是主线程，则需要给出严重警告信息，因为可能会导致死锁
     if (thread->loopLevel() <= 0 && (!QCoreApplication::instance() || thread != QCoreApplication::instance()->thread())) {
         qCritical() << Q_FUNC_INFO << thread << ", the thread no event loop";
     }
 
-    proxy.callInLiveThread(s, target ? target : &proxy, &fun);
+    // no proxy object and no queued signal for each call, only the event is allocated.
+    postSyncCall(thread, new SyncCallEvent(s, target, &fun));
     s->acquire();
 }
 
 }
 #else
+static QEvent::Type drainEventType()
+{
+    static const QEvent::Type type = static_cast<QEvent::Type>(QEvent::registerEventType());
+    return type;
+}
+
 class Q_DECL_HIDDEN Caller : public QObject
 {
 public:
@@ -53,6 +149,17 @@ public:
     {
     }
 
+    ~Caller() override
+    {
+        // the promises of the calls never run are canceled by their destructors.
+        DThreadUtils::AbstractCallEvent *event = takeQueued();
+        while (event) {
+            auto next = event->next;
+            delete event;
+            event = next;
+        }
+    }
+
     bool event(QEvent *event) override
     {
         if (event->type() == DThreadUtils::eventType) {
@@ -61,8 +168,56 @@ public:
             return true;
         }
 
+        if (event->type() == drainEventType()) {
+            drain();
+            return true;
+        }
+
         return QObject::event(event);
     }
+
+    // it's called by any thread, only the first call after the queue is drained wakes up the target thread.
+    void enqueue(DThreadUtils::AbstractCallEvent *event)
+    {
+        DThreadUtils::AbstractCallEvent *head = queue.loadRelaxed();
+        do {
+            event->next = head;
+        } while (!queue.testAndSetOrdered(head, event, head));
+
+        if (!head)
+            QCoreApplication::postEvent(this, new QEvent(drainEventType()));
+    }
+
+    QAtomicInteger<bool> batching{false};
+
+private:
+    // the queue is a lock-free stack pushed by the producers, the consumer takes all of it
+    // at once and reverses it, so the calls are run in the order they are made.
+    DThreadUtils::AbstractCallEvent *takeQueued()
+    {
+        DThreadUtils::AbstractCallEvent *event = queue.fetchAndStoreAcquire(nullptr);
+        DThreadUtils::AbstractCallEvent *reversed = nullptr;
+        while (event) {
+            auto next = event->next;
+            event->next = reversed;
+            reversed = event;
+            event = next;
+        }
+        return reversed;
+    }
+
+    void drain()
+    {
+        DThreadUtils::AbstractCallEvent *event = takeQueued();
+        while (event) {
+            auto next = event->next;
+            event->call();
+            delete event;
+            event = next;
+        }
+    }
+
+    QAtomicPointer<DThreadUtils::AbstractCallEvent> queue{nullptr};
 };
 
 DThreadUtils::DThreadUtils(QThread *thread)
@@ -87,6 +242,35 @@ QThread *DThreadUtils::thread() const noexcept
     return m_thread;
 }
 
+/*!
+@~english
+  @brief Whether the calls to the thread are delivered in batches, it's disabled by default.
+
+  In the batching mode the calls are queued without a lock, and one posted event runs all
+  of the queued calls, so a burst of calls wakes up the thread once instead of once a call.
+  The calls made in the batching mode and out of it aren't ordered with each other.
+ */
+bool DThreadUtils::isBatchingEnabled() const
+{
+    auto caller = static_cast<Caller *>(threadContext.loadRelaxed());
+    return caller && caller->batching.loadRelaxed();
+}
+
+void DThreadUtils::setBatchingEnabled(bool enabled)
+{
+    static_cast<Caller *>(ensureThreadContextObject())->batching.storeRelaxed(enabled);
+}
+
+void DThreadUtils::post(AbstractCallEvent *event)
+{
+    auto caller = static_cast<Caller *>(ensureThreadContextObject());
+    if (caller->batching.loadRelaxed()) {
+        caller->enqueue(event);
+    } else {
+        QCoreApplication::postEvent(caller, event);
+    }
+}
+
 QObject *DThreadUtils::ensureThreadContextObject()
 {
     QObject *context;
@@ -32,8 +32,13 @@ public:
     bool m_timeDumpFlag = false;
     char __padding[3];
     QString m_exectionName;
+    std::function<void(int)> m_callback;
+    QTimer *m_timer = nullptr;
 
     void setExecutionName(const QString &executionName);
+    void begin();
+    void end();
+    void finishAsync(int returnCode);
 
     class LoopGuard {
         DTimedLoopPrivate *m_p = nullptr;
@@ -42,29 +47,53 @@ public:
         LoopGuard(DTimedLoopPrivate *p)
             : m_p (p)
         {
-            m_p->m_startTime = QTime::currentTime();
+            m_p->begin();
         }
         ~LoopGuard() {
-            m_p->m_stopTime = QTime::currentTime();
-            if (!m_p->m_timeDumpFlag) {
-                return;
-            }
-            if (Q_UNLIKELY(m_p->m_exectionName.isEmpty())) {
-                qCDebug(logTimedLoop(),
-                        "The execution time is %-5d ms",
-                        m_p->m_startTime.msecsTo(QTime::currentTime()));
-            } else {
-                qCDebug(logTimedLoop(),
-                        "The execution time is %-5d ms for \"%s\"",
-                        m_p->m_startTime.msecsTo(QTime::currentTime()),
-                        m_p->m_exectionName.toLocal8Bit().data());
-
-                m_p->m_exectionName.clear();
-            }
+            m_p->end();
         }
     };
 };
 
+void DTimedLoopPrivate::begin()
+{
+    m_startTime = QTime::currentTime();
+}
+
+void DTimedLoopPrivate::end()
+{
+    m_stopTime = QTime::currentTime();
+    if (!m_timeDumpFlag) {
+        return;
+    }
+    if (Q_UNLIKELY(m_exectionName.isEmpty())) {
+        qCDebug(logTimedLoop(),
+                "The execution time is %-5d ms",
+                m_startTime.msecsTo(QTime::currentTime()));
+    } else {
+        qCDebug(logTimedLoop(),
+                "The execution time is %-5d ms for \"%s\"",
+                m_startTime.msecsTo(QTime::currentTime()),
+                m_exectionName.toLocal8Bit().data());
+
+        m_exectionName.clear();
+    }
+}
+
+void DTimedLoopPrivate::finishAsync(int returnCode)
+{
+    if (!m_callback)
+        return;
+
+    if (m_timer)
+        m_timer->stop();
+    end();
+    // the callback may wait again
+    auto callback = std::move(m_callback);
+    m_callback = nullptr;
+    callback(returnCode);
+}
+
 DTimedLoopPrivate::DTimedLoopPrivate(DTimedLoop *qq)
     : DObjectPrivate (qq)
 {
@@ -97,7 +126,7 @@ DTimedLoop::~DTimedLoop()
 
 int DTimedLoop::runningTime() {
     Q_D(DTimedLoop);
-    if (QEventLoop::isRunning()) {
+    if (QEventLoop::isRunning() || d->m_callback) {
         return d->m_startTime.msecsTo(QTime::currentTime());
     }
     return d->m_startTime.msecsTo(d->m_stopTime);
@@ -113,6 +142,11 @@ void DTimedLoop::exit(int returnCode)
 {
     // 避免在子线程中提前被执行
     DThreadUtil::runInMainThread([this, returnCode]{
+        Q_D(DTimedLoop);
+        if (d->m_callback) {
+            d->finishAsync(returnCode);
+            return;
+        }
         QEventLoop::exit(returnCode);
     });
 }
@@ -149,4 +183,45 @@ int DTimedLoop::exec(int durationMs, const QString &executionName, QEventLoop::P
     return exec(durationMs, flags);
 }
 
+void DTimedLoop::execAsync(const std::function<void(int)> &callback)
+{
+    execAsync(-1, callback);
+}
+
+void DTimedLoop::execAsync(int durationMs, const std::function<void(int)> &callback)
+{
+    Q_D(DTimedLoop);
+    // the previous waiting is replaced
+    d->finishAsync(-1);
+
+    d->m_callback = callback ? callback : [](int) {};
+    d->begin();
+    if (durationMs < 0)
+        return;
+
+    if (!d->m_timer) {
+        d->m_timer = new QTimer(this);
+        d->m_timer->setSingleShot(true);
+        connect(d->m_timer, &QTimer::timeout, this, [d] {
+            d->finishAsync(0);
+        });
+    }
+    d->m_timer->start(durationMs);
+}
+
+void DTimedLoop::execAsync(int durationMs, const QString &executionName, const std::function<void(int)> &callback)
+{
+    Q_D(DTimedLoop);
+    // set after the previous waiting is finished, which clears the name
+    d->finishAsync(-1);
+    d->setExecutionName(executionName);
+    execAsync(durationMs, callback);
+}
+
+bool DTimedLoop::isWaiting() const
+{
+    D_DC(DTimedLoop);
+    return d->m_callback != nullptr;
+}
+
 DCORE_END_NAMESPACE
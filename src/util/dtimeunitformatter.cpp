@@ -45,4 +45,51 @@ QString DTimeUnitFormatter::unitStr(int unitId) const
     return QString();
 }
 
+static const quint64 SecondsOfUnit[] = {1, 60, 3600, 86400};
+
+/*!
+  @~english
+  @brief A fast version of format() for \a seconds in the unit Seconds.
+
+  The unit is the biggest one in which the value is not less than 1, it's
+  picked from a threshold table and no virtual function is called.
+  @return QPair<qreal, int> a pair of the converted value and unit
+ */
+QPair<qreal, int> DTimeUnitFormatter::formatSeconds(quint64 seconds) const
+{
+    int unit = Seconds;
+    while (unit < Day && seconds >= SecondsOfUnit[unit + 1])
+        ++unit;
+
+    return QPair<qreal, int>(qreal(seconds) / SecondsOfUnit[unit], unit);
+}
+
+/*!
+  @~english
+  @brief Append \a seconds split into all the units like "1d 2h 5s" to \a out.
+
+  Unlike formatAsUnitList() no list is built, the callers formatting many
+  durations can reuse one string and truncate it to 0 for each.
+  @param[in] seconds the duration in the unit Seconds
+  @param[out] out the string to append to
+ */
+void DTimeUnitFormatter::appendSeconds(quint64 seconds, QString &out) const
+{
+    static const char Units[] = {'s', 'm', 'h', 'd'};
+
+    bool first = true;
+    for (int unit = Day; unit >= Seconds; --unit) {
+        const quint64 value = seconds / SecondsOfUnit[unit];
+        seconds %= SecondsOfUnit[unit];
+        if (!value && !(unit == Seconds && first))
+            continue;
+
+        if (!first)
+            out.append(QLatin1Char(' '));
+        appendNumber(out, value, 0);
+        out.append(QLatin1Char(Units[unit]));
+        first = false;
+    }
+}
+
 DCORE_END_NAMESPACE
@@ -5,11 +5,20 @@
 #include "dvtablehook.h"
 
 #include <QFileInfo>
+#include <QHash>
+#include <QMultiHash>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QVector>
 #include <algorithm>
+#include <atomic>
+#include <utility>
 #ifdef Q_OS_LINUX
 #include <sys/mman.h>
 #include <unistd.h>
 #include <dlfcn.h>
+#include <link.h>
+#include <cstddef>
 
 QT_BEGIN_NAMESPACE
 QFunctionPointer qt_linux_find_symbol_sys(const char *symbol);
@@ -19,10 +28,114 @@ QT_END_NAMESPACE
 
 DCORE_BEGIN_NAMESPACE
 
+// kept only for the binary compatibility, nothing is stored in them
 QMap<quintptr**, quintptr*> DVtableHook::objToOriginalVfptr;
 QMap<const void*, quintptr*> DVtableHook::objToGhostVfptr;
 QMap<const void*, quintptr> DVtableHook::objDestructFun;
 
+/*
+ * The hooked objects, they're looked up by every originalFun() called in a hooked function,
+ * from any thread. The table is split into shards by the object address, each has its own
+ * read-write lock, so the lookups of the different objects rarely touch the same lock, and
+ * a lookup never allocates.
+ */
+struct HookedObject
+{
+    quintptr *originalVfptr = nullptr;
+    quintptr *ghostVtable = nullptr;
+    quintptr destructFun = 0;
+    // the ghost vtable is owned by the vtable registry
+    bool shared = false;
+};
+
+struct HookShard
+{
+    QReadWriteLock lock;
+    QHash<const void *, HookedObject> objects;
+};
+
+static const int HookShardCount = 64;
+
+static HookShard &hookShard(const void *obj)
+{
+    static HookShard shards[HookShardCount];
+    // the objects are aligned, the low bits are always the same
+    return shards[(quintptr(obj) >> 4) % HookShardCount];
+}
+
+static HookedObject findHookedObject(const void *obj)
+{
+    HookShard &shard = hookShard(obj);
+    QReadLocker locker(&shard.lock);
+    return shard.objects.value(obj);
+}
+
+static void setGhostVtable(const void *obj, quintptr *vtable)
+{
+    HookShard &shard = hookShard(obj);
+    QWriteLocker locker(&shard.lock);
+    shard.objects[obj].ghostVtable = vtable;
+}
+
+/*
+ * The shared ghost vtables, the objects of a class with the same overrides use one of them.
+ * A vtable is detached(copied if it's used by the other objects) before being written, and
+ * shared again after that, it's replaced with an identical one if there is.
+ */
+struct SharedVtable
+{
+    quintptr *originalVfptr;
+    int length;
+    int ref;
+};
+
+struct VtableRegistry
+{
+    QMutex lock;
+    QHash<quintptr *, SharedVtable> vtables;
+    QMultiHash<quintptr *, quintptr *> vtablesOfClass;
+    // the destructor has the same index in all the objects of a class
+    QHash<quintptr *, int> destructIndex;
+    std::atomic<bool> enabled{false};
+
+    // returns the identical shared vtable, or \a vtable if it's added
+    quintptr *share(quintptr *originalVfptr, quintptr *vtable, int length)
+    {
+        for (auto it = vtablesOfClass.find(originalVfptr); it != vtablesOfClass.end() && it.key() == originalVfptr; ++it) {
+            if (memcmp(it.value(), vtable, length * sizeof(quintptr)) == 0) {
+                ++vtables[it.value()].ref;
+                return it.value();
+            }
+        }
+
+        vtables.insert(vtable, {originalVfptr, length, 1});
+        vtablesOfClass.insert(originalVfptr, vtable);
+        return vtable;
+    }
+
+    // returns false if the vtable isn't shared
+    bool release(quintptr *vtable)
+    {
+        QMutexLocker locker(&lock);
+        auto it = vtables.find(vtable);
+        if (it == vtables.end())
+            return false;
+
+        if (--it->ref == 0) {
+            vtablesOfClass.remove(it->originalVfptr, vtable);
+            vtables.erase(it);
+            delete[] vtable;
+        }
+        return true;
+    }
+};
+
+static VtableRegistry &vtableRegistry()
+{
+    static VtableRegistry registry;
+    return registry;
+}
+
 bool DVtableHook::copyVtable(quintptr **obj)
 {
     int vtable_size = getVtableSize(obj);
@@ -74,28 +187,40 @@ bool DVtableHook::copyVtable(quintptr **obj)
     memcpy(new_vtable, adjustToTop(*obj), vtable_size * sizeof(quintptr));
     new_vtable[vtable_size] = 0;
 
+    HookShard &shard = hookShard(obj);
+    QWriteLocker locker(&shard.lock);
+    HookedObject &hooked = shard.objects[obj];
     //! save original vfptr
-    objToOriginalVfptr[obj] = *obj;
+    hooked.originalVfptr = *obj;
     // 存储对象原虚表入口地址
     new_vtable[vtable_size + 1] = quintptr(*obj);
 
     *obj = adjustToEntry(new_vtable);
     //! save ghost vfptr
-    objToGhostVfptr[obj] = new_vtable;
+    hooked.ghostVtable = new_vtable;
 
     return true;
 }
 
 bool DVtableHook::clearGhostVtable(const void *obj)
 {
-    if (!objToOriginalVfptr.remove((quintptr **)obj)) // Uninitialized memory may have values, for resetVtable
-        return false;
-    objDestructFun.remove(obj);
-
-    quintptr *vtable = objToGhostVfptr.take(obj);
+    quintptr *vtable = nullptr;
+    bool shared = false;
+    {
+        HookShard &shard = hookShard(obj);
+        QWriteLocker locker(&shard.lock);
+        auto it = shard.objects.find(obj);
+        if (it == shard.objects.end()) // Uninitialized memory may have values, for resetVtable
+            return false;
+        vtable = it->ghostVtable;
+        shared = it->shared;
+        shard.objects.erase(it);
+    }
 
     if (vtable) {
-        delete[] vtable;
+        // 共享的虚表在没有对象使用时才销毁
+        if (!shared || !vtableRegistry().release(vtable))
+            delete[] vtable;
 
         return true;
     }
@@ -169,7 +294,7 @@ int DVtableHook::getDestructFunIndex(quintptr **obj, std::function<void(void)> d
 
 void DVtableHook::autoCleanVtable(const void *obj)
 {
-    quintptr fun = objDestructFun.value(obj);
+    quintptr fun = findHookedObject(obj).destructFun;
 
     if (!fun)
         return;
@@ -189,15 +314,19 @@ bool DVtableHook::ensureVtable(const void *obj, std::function<void ()> destoryOb
 {
     quintptr **_obj = (quintptr**)(obj);
 
-    if (objToOriginalVfptr.contains(_obj)) {
+    const HookedObject &hooked = findHookedObject(obj);
+    if (hooked.originalVfptr) {
         // 不知道什么原因, 此时obj对象的虚表已经被还原
-        if (objToGhostVfptr.value((void *)obj) != adjustToTop(*_obj)) {
+        if (hooked.ghostVtable != adjustToTop(*_obj)) {
             clearGhostVtable((void*)obj);
         } else {
             return true;
         }
     }
 
+    if (vtableRegistry().enabled)
+        return ensureSharedVtable(_obj, destoryObjFun);
+
     if (!copyVtable(_obj))
         return false;
 
@@ -212,7 +341,11 @@ bool DVtableHook::ensureVtable(const void *obj, std::function<void ()> destoryOb
 
     quintptr *new_vtable = *_obj;
     // 保存对象真实的析构函数
-    objDestructFun[(void*)obj] = new_vtable[index];
+    {
+        HookShard &shard = hookShard(obj);
+        QWriteLocker locker(&shard.lock);
+        shard.objects[obj].destructFun = new_vtable[index];
+    }
 
     // 覆盖析构函数, 用于在对象析构时自动清理虚表
     new_vtable[index] = reinterpret_cast<quintptr>(&autoCleanVtable);
@@ -220,6 +353,137 @@ bool DVtableHook::ensureVtable(const void *obj, std::function<void ()> destoryOb
     return true;
 }
 
+bool DVtableHook::ensureSharedVtable(quintptr **obj, std::function<void(void)> destoryObjFun)
+{
+    VtableRegistry &registry = vtableRegistry();
+    quintptr *original = *obj;
+    int vtable_size = getVtableSize(obj);
+
+    if (vtable_size == 0)
+        return false;
+
+    int index = -1;
+    {
+        QMutexLocker locker(&registry.lock);
+        index = registry.destructIndex.value(original, -1);
+    }
+
+    if (index < 0) {
+        // 查找对象的析构函数, 同一个类只需查找一次
+        index = getDestructFunIndex(obj, destoryObjFun);
+
+        // 虚析构函数查找失败
+        if (index < 0) {
+            qCWarning(vtableHook) << "Failed do override destruct function: " << obj;
+            abort();
+        }
+
+        QMutexLocker locker(&registry.lock);
+        registry.destructIndex.insert(original, index);
+    }
+
+    // 与copyVtable的虚表结构相同
+    quintptr *new_vtable = new quintptr[vtable_size + 2];
+    memcpy(new_vtable, adjustToTop(original), vtable_size * sizeof(quintptr));
+    new_vtable[vtable_size] = 0;
+    new_vtable[vtable_size + 1] = quintptr(original);
+    // 覆盖析构函数, 用于在对象析构时自动清理虚表
+    adjustToEntry(new_vtable)[index] = reinterpret_cast<quintptr>(&autoCleanVtable);
+
+    quintptr *vtable = nullptr;
+    {
+        QMutexLocker locker(&registry.lock);
+        vtable = registry.share(original, new_vtable, vtable_size + 2);
+    }
+
+    if (vtable != new_vtable)
+        delete[] new_vtable;
+
+    {
+        HookShard &shard = hookShard(obj);
+        QWriteLocker locker(&shard.lock);
+        HookedObject &hooked = shard.objects[obj];
+        hooked.originalVfptr = original;
+        hooked.ghostVtable = vtable;
+        // 保存对象真实的析构函数
+        hooked.destructFun = original[index];
+        hooked.shared = true;
+    }
+
+    *obj = adjustToEntry(vtable);
+
+    return true;
+}
+
+// makes the ghost vtable of obj be used by obj only, so it can be written
+void DVtableHook::detachVtable(const void *obj)
+{
+    const HookedObject &hooked = findHookedObject(obj);
+    if (!hooked.shared || *(quintptr **)obj != adjustToEntry(hooked.ghostVtable))
+        return;
+
+    VtableRegistry &registry = vtableRegistry();
+    QMutexLocker locker(&registry.lock);
+    auto it = registry.vtables.find(hooked.ghostVtable);
+    if (it == registry.vtables.end()) // already detached
+        return;
+
+    if (it->ref == 1) {
+        registry.vtablesOfClass.remove(it->originalVfptr, hooked.ghostVtable);
+        registry.vtables.erase(it);
+        return;
+    }
+
+    --it->ref;
+    quintptr *vtable = new quintptr[it->length];
+    memcpy(vtable, hooked.ghostVtable, it->length * sizeof(quintptr));
+    setGhostVtable(obj, vtable);
+    *(quintptr **)obj = adjustToEntry(vtable);
+}
+
+void DVtableHook::shareVtable(const void *obj)
+{
+    const HookedObject &hooked = findHookedObject(obj);
+    if (!hooked.shared || *(quintptr **)obj != adjustToEntry(hooked.ghostVtable))
+        return;
+
+    VtableRegistry &registry = vtableRegistry();
+    QMutexLocker locker(&registry.lock);
+    if (registry.vtables.contains(hooked.ghostVtable))
+        return;
+
+    const int length = getVtableSize((quintptr **)obj) + 2;
+    quintptr *vtable = registry.share(hooked.originalVfptr, hooked.ghostVtable, length);
+    if (vtable == hooked.ghostVtable)
+        return;
+
+    setGhostVtable(obj, vtable);
+    *(quintptr **)obj = adjustToEntry(vtable);
+    delete[] hooked.ghostVtable;
+}
+
+/*!
+  \brief 设置是否共享对象的虚表.
+
+  开启后, 同一个类中覆盖了相同虚函数的对象共用一份虚表, 虚表的内存随类的数量增长, 而不是对象的数量,
+  对象的虚函数被单独覆盖时复制一份虚表(写时复制). 只影响开启之后被覆盖虚表的对象.
+  \note 共享虚表时 callOriginalFun 需要复制和合并一次虚表, 开销更大
+  \sa isVtableSharingEnabled
+ */
+void DVtableHook::setVtableSharingEnabled(bool enabled)
+{
+    vtableRegistry().enabled = enabled;
+}
+
+/*!
+  \brief 返回是否共享对象的虚表
+  \sa setVtableSharingEnabled
+ */
+bool DVtableHook::isVtableSharingEnabled()
+{
+    return vtableRegistry().enabled;
+}
+
 /*!
   \brief DVtableHook::hasVtable 对象的虚表已经被覆盖时返回true，否则返回false
   \a obj
@@ -230,7 +494,7 @@ bool DVtableHook::hasVtable(const void *obj)
     quintptr **_obj = (quintptr**)(obj);
 
     // 验证 vtable 是否匹配
-    quintptr *ghost_vtable = objToGhostVfptr.value(obj);
+    quintptr *ghost_vtable = findHookedObject(obj).ghostVtable;
     if (!ghost_vtable) {
         return false;
     }
@@ -272,17 +536,28 @@ void DVtableHook::resetVtable(const void *obj)
  */
 quintptr DVtableHook::resetVfptrFun(const void *obj, quintptr functionOffset)
 {
-    quintptr *vfptr_t1 = *(quintptr **)obj;
-    quintptr current_fun = *(vfptr_t1 + functionOffset / sizeof(quintptr));
+    return resetVfptrFun(obj, functionOffset, true);
+}
+
+quintptr DVtableHook::resetVfptrFun(const void *obj, quintptr functionOffset, bool share)
+{
     quintptr origin_fun = originalFun(obj, functionOffset);
 
     if (!origin_fun) {
         return 0;
     }
 
+    detachVtable(obj);
+
+    quintptr *vfptr_t1 = *(quintptr **)obj;
+    quintptr current_fun = *(vfptr_t1 + functionOffset / sizeof(quintptr));
+
     // reset to original fun
     *(vfptr_t1 + functionOffset / sizeof(quintptr)) = origin_fun;
 
+    if (share)
+        shareVtable(obj);
+
     return current_fun;
 }
 
@@ -324,101 +599,180 @@ quintptr **DVtableHook::adjustThis(quintptr *obj)
 }
 #endif
 
+struct PendingWrite
+{
+    quintptr address;
+    QByteArray data;
+};
+
+// the writes of forceWriteMemory() are queued between beginWriteBatch() and endWriteBatch()
+struct WriteBatch
+{
+    int depth = 0;
+    QVector<PendingWrite> writes;
+};
+static thread_local WriteBatch writeBatch;
+
 #if defined(Q_OS_LINUX)
-static int readProtFromPsm(quintptr adr, size_t length)
+struct MemoryRegion
+{
+    quintptr start;
+    quintptr end;
+    int prot;
+};
+
+// the mappings of /proc/self/maps, they're sorted by the address
+static QVector<MemoryRegion> readMemoryRegions()
 {
-    int prot = PROT_NONE;
-    QString fname = "/proc/self/maps";
-    QFile f(fname);
+    QFile f("/proc/self/maps");
     if (!f.open(QIODevice::ReadOnly)) {
         qFatal("%s", f.errorString().toStdString().data());
-        //return prot; // never be executed
+        //return {}; // never be executed
     }
 
-    QByteArray data = f.readAll();
-    bool ok = false;
-    quintptr startAddr = 0, endAddr = 0;
-    QTextStream ts(data);
-    while (Q_UNLIKELY(!ts.atEnd())) {
-        const QString line = ts.readLine();
-        const QStringList &maps = line.split(' ');
-        if (Q_UNLIKELY(maps.size() < 3)) {
-            data = f.readLine();
+    QVector<MemoryRegion> regions;
+    const QByteArray &data = f.readAll();
+    for (const QByteArray &line : data.split('\n')) {
+        //"00400000-00431000" "r--p"
+        const int addrEnd = line.indexOf(' ');
+        const int dash = line.indexOf('-');
+        if (Q_UNLIKELY(addrEnd < 0 || dash < 0 || dash > addrEnd || line.size() < addrEnd + 4))
             continue;
-        }
 
-        //"00400000-00431000" "r--p"
-        const QStringList addrs = maps.value(0).split('-');
-        startAddr = addrs.value(0).toULongLong(&ok, 16);
+        bool ok = false;
+        MemoryRegion region;
+        region.start = line.left(dash).toULongLong(&ok, 16);
         Q_ASSERT(ok);
-        endAddr = addrs.value(1).toULongLong(&ok, 16);
+        region.end = line.mid(dash + 1, addrEnd - dash - 1).toULongLong(&ok, 16);
         Q_ASSERT(ok);
-        if (Q_LIKELY(adr >= endAddr)) {
-            continue;
-        }
-        if (adr >= startAddr && adr + length <= endAddr) {
-            QString ps = maps.value(1);
-            //qDebug() << maps.value(0) << maps.value(1);
-            for (QChar c : ps) {
-                switch (c.toLatin1()) {
-                case 'r':
-                    prot |= PROT_READ;
-                    break;
-                case 'w':
-                    prot |= PROT_WRITE;
-                    break;
-                case 'x':
-                    prot |= PROT_EXEC;
-                    break;
-                default:
-                    break; // '-' 'p' don't care
-                }
-            }
-            break;
-        } else if (adr < startAddr) {
-            qFatal("%p not found in proc maps", reinterpret_cast<void *>(adr));
-            //break; // 超出了地址不需要再去检查了
-        }
+        region.prot = PROT_NONE;
+        if (line.at(addrEnd + 1) == 'r')
+            region.prot |= PROT_READ;
+        if (line.at(addrEnd + 2) == 'w')
+            region.prot |= PROT_WRITE;
+        if (line.at(addrEnd + 3) == 'x')
+            region.prot |= PROT_EXEC;
+        regions << region; // '-' 'p' don't care
     }
 
-    return prot;
+    return regions;
 }
-#endif
 
-bool DVtableHook::forceWriteMemory(void *adr, const void *data, size_t length)
+static const MemoryRegion *findRegion(const QVector<MemoryRegion> &regions, quintptr adr, size_t length)
 {
-#ifdef Q_OS_LINUX
-    int page_size = sysconf(_SC_PAGESIZE);
-    quintptr x = reinterpret_cast<quintptr>(adr);
-    // 不减去一个pagesize防止跨越两个数据区域(对应/proc/self/maps两行数据)
-    void *new_adr = reinterpret_cast<void *>((x /*- page_size - 1*/) & ~(page_size - 1));
-    size_t override_data_length = length + x - reinterpret_cast<quintptr>(new_adr);
-
-    int oldProt = readProtFromPsm(quintptr(new_adr), override_data_length);
-    bool writeable = oldProt & PROT_WRITE;
-    // 增加判断是否已经可写，不能写才调用。
-    // 失败时直接放弃
-    if (!writeable && mprotect(new_adr, override_data_length, PROT_READ | PROT_WRITE)) {
-        qCWarning(vtableHook, "mprotect(change) failed: %s", strerror(errno));
-        return false;
+    auto it = std::upper_bound(regions.begin(), regions.end(), adr, [](quintptr adr, const MemoryRegion &region) {
+        return adr < region.end;
+    });
+    if (it == regions.end() || adr < it->start || adr + length > it->end) {
+        qFatal("%p not found in proc maps", reinterpret_cast<void *>(adr));
+        //return nullptr; // never be executed
     }
+    return it;
+}
 #endif
-    // 复制数据
-    memcpy(adr, data, length);
+
+/*
+ * Writes are grouped by the pages they touch, every group of the adjoining pages of a mapping
+ * is made writable and restored once, and the mappings are read once for all the writes.
+ */
+static bool writeMemory(QVector<PendingWrite> writes)
+{
 #ifdef Q_OS_LINUX
-    // 恢复内存标志位
-    if (!writeable && mprotect(new_adr, override_data_length, oldProt)) {
-        qCWarning(vtableHook, "mprotect(restore) failed: %s", strerror(errno));
-        return false;
+    std::sort(writes.begin(), writes.end(), [](const PendingWrite &a, const PendingWrite &b) {
+        return a.address < b.address;
+    });
+
+    const QVector<MemoryRegion> &regions = readMemoryRegions();
+    const quintptr pageSize = quintptr(sysconf(_SC_PAGESIZE));
+    const quintptr pageMask = ~(pageSize - 1);
+    bool ok = true;
+    for (int i = 0; i < writes.size();) {
+        // 不减去一个pagesize防止跨越两个数据区域(对应/proc/self/maps两行数据)
+        const quintptr groupStart = writes.at(i).address & pageMask;
+        quintptr groupEnd = writes.at(i).address + writes.at(i).data.size();
+        const MemoryRegion *region = findRegion(regions, groupStart, groupEnd - groupStart);
+        int end = i + 1;
+        for (; end < writes.size(); ++end) {
+            const PendingWrite &write = writes.at(end);
+            const quintptr writeEnd = write.address + write.data.size();
+            // not in the same or the next page, or in another mapping
+            if ((write.address & pageMask) > ((groupEnd - 1) & pageMask) + pageSize || writeEnd > region->end)
+                break;
+            groupEnd = qMax(groupEnd, writeEnd);
+        }
+
+        void *new_adr = reinterpret_cast<void *>(groupStart);
+        const size_t override_data_length = groupEnd - groupStart;
+        const bool writeable = region->prot & PROT_WRITE;
+        // 增加判断是否已经可写，不能写才调用。
+        // 失败时直接放弃
+        if (!writeable && mprotect(new_adr, override_data_length, PROT_READ | PROT_WRITE)) {
+            qCWarning(vtableHook, "mprotect(change) failed: %s", strerror(errno));
+            ok = false;
+            i = end;
+            continue;
+        }
+
+        // 复制数据
+        for (; i < end; ++i)
+            memcpy(reinterpret_cast<void *>(writes.at(i).address), writes.at(i).data.constData(), writes.at(i).data.size());
+
+        // 恢复内存标志位
+        if (!writeable && mprotect(new_adr, override_data_length, region->prot)) {
+            qCWarning(vtableHook, "mprotect(restore) failed: %s", strerror(errno));
+            ok = false;
+        }
     }
+    return ok;
+#else
+    // 复制数据
+    for (const PendingWrite &write : std::as_const(writes))
+        memcpy(reinterpret_cast<void *>(write.address), write.data.constData(), write.data.size());
+    return true;
 #endif
+}
 
-    return true;
+bool DVtableHook::forceWriteMemory(void *adr, const void *data, size_t length)
+{
+    PendingWrite write{reinterpret_cast<quintptr>(adr), QByteArray(static_cast<const char *>(data), int(length))};
+    if (writeBatch.depth > 0) {
+        writeBatch.writes << write;
+        return true;
+    }
+
+    return writeMemory({write});
 }
 
-QFunctionPointer DVtableHook::resolve(const char *symbol)
+/*!
+  \brief 开始批量写入，之后本线程中 forceWriteMemory 的写入被暂存，直到 endWriteBatch 时一起写入.
+
+  安装大量的钩子时, 批量写入只读取一次 /proc/self/maps, 且每组相邻的内存页只修改一次保护属性.
+  批量写入可以嵌套, 最外层的 endWriteBatch 写入所有暂存的数据, 在此之前钩子不生效.
+  \sa endWriteBatch
+ */
+void DVtableHook::beginWriteBatch()
 {
+    ++writeBatch.depth;
+}
+
+/*!
+  \brief 结束批量写入
+  \return 如果所有暂存的数据都写入成功返回 true, 否则返回 false
+  \sa beginWriteBatch
+ */
+bool DVtableHook::endWriteBatch()
+{
+    if (writeBatch.depth <= 0 || --writeBatch.depth > 0)
+        return true;
+
+    QVector<PendingWrite> writes;
+    writes.swap(writeBatch.writes);
+    return writeMemory(std::move(writes));
+}
+
 #ifdef Q_OS_LINUX
+static QFunctionPointer lookupSymbol(const char *symbol)
+{
   /**
   ！！不要使用qt_linux_find_symbol_sys函数去获取符号
   
@@ -427,10 +781,133 @@ QFunctionPointer DVtableHook::resolve(const char *symbol)
   有可能是因此导致无法获取比这个库加载更晚的库中的符号(仅为猜测)
   */
     return QFunctionPointer(dlsym(RTLD_DEFAULT, symbol));
+}
+
+/*
+ * The symbols resolved by resolve(), including the ones not found. They're valid until a shared
+ * object is loaded or unloaded, which is counted by the dynamic loader, the counts are the
+ * generation of the cache.
+ */
+struct ResolvedSymbols
+{
+    QReadWriteLock lock;
+    quint64 generation = 0;
+    QHash<QByteArray, QFunctionPointer> symbols;
+};
+Q_GLOBAL_STATIC(ResolvedSymbols, resolvedSymbols)
+
+static int readLoaderGeneration(dl_phdr_info *info, size_t size, void *data)
+{
+    if (size < offsetof(dl_phdr_info, dlpi_subs) + sizeof(info->dlpi_subs))
+        return -1;
+
+    // the counts are of the process, the first object is enough
+    *static_cast<quint64 *>(data) = info->dlpi_adds + info->dlpi_subs;
+    return 1;
+}
+
+// it's 0 if the loader doesn't count the objects, nothing is cached then
+static quint64 loaderGeneration()
+{
+    quint64 generation = 0;
+    return dl_iterate_phdr(readLoaderGeneration, &generation) > 0 ? generation : 0;
+}
+
+static void cacheSymbols(ResolvedSymbols *cache, quint64 generation, const QHash<QByteArray, QFunctionPointer> &symbols)
+{
+    QWriteLocker locker(&cache->lock);
+    if (generation > cache->generation) {
+        cache->symbols.clear();
+        cache->generation = generation;
+    }
+
+    // the objects are changed by another thread meanwhile
+    if (generation != cache->generation)
+        return;
+
+    for (auto it = symbols.cbegin(); it != symbols.cend(); ++it)
+        cache->symbols.insert(it.key(), it.value());
+}
+#endif
+
+/*!
+  \brief 获取已加载的动态库中 \a symbol 的地址, 找不到时返回 nullptr.
+
+  结果缓存在进程内, 直到有动态库被加载或卸载, 因此重复获取同一个符号不会再经过动态链接器的查找.
+  可以在任意线程中调用.
+  \sa resolve(const QByteArrayList &)
+ */
+QFunctionPointer DVtableHook::resolve(const char *symbol)
+{
+#ifdef Q_OS_LINUX
+    const quint64 generation = loaderGeneration();
+    if (generation == 0)
+        return lookupSymbol(symbol);
+
+    auto cache = resolvedSymbols();
+    const QByteArray key = QByteArray::fromRawData(symbol, int(qstrlen(symbol)));
+    {
+        QReadLocker locker(&cache->lock);
+        if (cache->generation == generation) {
+            auto it = cache->symbols.constFind(key);
+            if (it != cache->symbols.cend())
+                return it.value();
+        }
+    }
+
+    const QFunctionPointer function = lookupSymbol(symbol);
+    cacheSymbols(cache, generation, {{QByteArray(symbol), function}});
+    return function;
 #else
+    Q_UNUSED(symbol)
     // TODO
     return nullptr;
 #endif
 }
 
+/*!
+  \brief 一次获取多个符号的地址, 返回值与 \a symbols 一一对应, 找不到的符号为 nullptr.
+
+  缓存只检查和更新一次, 重复的符号只查找一次, 适合在加载插件时一起获取安装钩子所需的所有符号.
+  \sa resolve(const char *)
+ */
+QVector<QFunctionPointer> DVtableHook::resolve(const QByteArrayList &symbols)
+{
+    QVector<QFunctionPointer> result(symbols.size(), nullptr);
+#ifdef Q_OS_LINUX
+    const quint64 generation = loaderGeneration();
+    auto cache = resolvedSymbols();
+
+    QVector<int> missing;
+    {
+        QReadLocker locker(&cache->lock);
+        const bool valid = generation != 0 && cache->generation == generation;
+        for (int i = 0; i < symbols.size(); ++i) {
+            auto it = valid ? cache->symbols.constFind(symbols.at(i)) : cache->symbols.cend();
+            if (it != cache->symbols.cend())
+                result[i] = it.value();
+            else
+                missing << i;
+        }
+    }
+
+    if (missing.isEmpty())
+        return result;
+
+    QHash<QByteArray, QFunctionPointer> resolved;
+    for (int i : std::as_const(missing)) {
+        auto it = resolved.find(symbols.at(i));
+        if (it == resolved.end())
+            it = resolved.insert(symbols.at(i), lookupSymbol(symbols.at(i).constData()));
+        result[i] = it.value();
+    }
+
+    if (generation != 0)
+        cacheSymbols(cache, generation, resolved);
+#else
+    Q_UNUSED(symbols)
+#endif
+    return result;
+}
+
 DCORE_END_NAMESPACE
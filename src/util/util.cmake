@@ -4,12 +4,17 @@ if(LINUX)
     ${CMAKE_CURRENT_LIST_DIR}/dabstractunitformatter.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/ddisksizeformatter.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/ddbussender.cpp 
+    ${CMAKE_CURRENT_LIST_DIR}/ddbuscalltrace.cpp
     ${CMAKE_CURRENT_LIST_DIR}/drecentmanager.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/dnotifysender.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/dpinyin.cpp 
+    ${CMAKE_CURRENT_LIST_DIR}/dpinyinindex.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dexportedinterface.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/dvtablehook.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/dthreadutils.cpp 
+    ${CMAKE_CURRENT_LIST_DIR}/dthreadpool.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/deventloopmonitor.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/dperfcounters.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dtimedloop.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dfileservices_linux.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dexportedinterface.cpp
@@ -24,12 +29,17 @@ else()
     ${CMAKE_CURRENT_LIST_DIR}/dabstractunitformatter.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/ddisksizeformatter.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/ddbussender.cpp 
+    ${CMAKE_CURRENT_LIST_DIR}/ddbuscalltrace.cpp
     ${CMAKE_CURRENT_LIST_DIR}/drecentmanager.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/dnotifysender.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/dpinyin.cpp 
+    ${CMAKE_CURRENT_LIST_DIR}/dpinyinindex.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dexportedinterface.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/dvtablehook.cpp 
     ${CMAKE_CURRENT_LIST_DIR}/dthreadutils.cpp 
+    ${CMAKE_CURRENT_LIST_DIR}/dthreadpool.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/deventloopmonitor.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/dperfcounters.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dtimedloop.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dfileservices_dummy.cpp
     ${CMAKE_CURRENT_LIST_DIR}/dexportedinterface.cpp
@@ -45,17 +55,24 @@ file(GLOB UTILS_HEADERS
 
 set(PRIVATE_HEADERS
     ${CMAKE_CURRENT_LIST_DIR}/ddbusinterface_p.h
+    ${CMAKE_CURRENT_LIST_DIR}/ddbuscalltrace_p.h
     ${CMAKE_CURRENT_LIST_DIR}/ddbusextendedpendingcallwatcher_p.h)
 
 if(NOT DTK5)
   list(REMOVE_ITEM UTILS_SOURCES "${CMAKE_CURRENT_LIST_DIR}/dtimedloop.cpp")
   list(REMOVE_ITEM UTILS_HEADERS "${PROJECT_SOURCE_DIR}/include/util/dtimedloop.h") # no longer be used
   list(REMOVE_ITEM UTILS_HEADERS "${PROJECT_SOURCE_DIR}/include/util/dasync.h")
+else()
+  list(REMOVE_ITEM UTILS_SOURCES "${CMAKE_CURRENT_LIST_DIR}/dthreadpool.cpp")
+  list(REMOVE_ITEM UTILS_HEADERS "${PROJECT_SOURCE_DIR}/include/util/dthreadpool.h") # QPromise is Qt6 only
+  list(REMOVE_ITEM UTILS_HEADERS "${PROJECT_SOURCE_DIR}/include/util/dcoroutine.h")
 endif()
 
+include(${CMAKE_CURRENT_LIST_DIR}/dpinyindict.cmake)
+dtk_generate_pinyin_dict(PRIVATE_HEADERS)
+
 set(utils_SRC 
   ${UTILS_HEADERS}
   ${PRIVATE_HEADERS}
   ${UTILS_SOURCES}
-  ${CMAKE_CURRENT_LIST_DIR}/util.qrc
 )
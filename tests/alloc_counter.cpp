@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "alloc_counter.hpp"
+
+#include <cstddef>
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define D_ALLOCATION_SANITIZED
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define D_ALLOCATION_SANITIZED
+#endif
+
+#if defined(__GLIBC__) && !defined(D_ALLOCATION_SANITIZED)
+#define D_ALLOCATION_COUNTING
+
+// it's initialized statically in the executable, reading it never allocates
+static thread_local std::uint64_t t_allocations = 0;
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+// the definitions in the executable take precedence over the ones of libc for all of the libraries
+void *malloc(size_t size)
+{
+    ++t_allocations;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    ++t_allocations;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    ++t_allocations;
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+bool AllocationCounter::isSupported()
+{
+#ifdef D_ALLOCATION_COUNTING
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::uint64_t AllocationCounter::allocations()
+{
+#ifdef D_ALLOCATION_COUNTING
+    return t_allocations;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+// Counts the heap allocations of the current thread since it's created, the test executable
+// interposes malloc, calloc and realloc, operator new is counted through malloc.
+class AllocationCounter {
+public:
+    AllocationCounter()
+        : m_start(allocations()) { }
+
+    std::uint64_t count() const { return allocations() - m_start; }
+    void reset() { m_start = allocations(); }
+
+    // false if the allocations can't be interposed, e.g. with AddressSanitizer, count() is 0 then
+    static bool isSupported();
+    static std::uint64_t allocations();
+
+private:
+    std::uint64_t m_start;
+};
+
+// Fails the test if `statement` allocates more than `budget` times in the current thread, the
+// statement is run without checking if counting isn't supported.
+#define EXPECT_ALLOCATIONS_LE(budget, statement) \
+    do { \
+        AllocationCounter _allocation_counter; \
+        statement; \
+        const std::uint64_t _allocation_count = _allocation_counter.count(); \
+        if (AllocationCounter::isSupported()) \
+            EXPECT_LE(_allocation_count, std::uint64_t(budget)) << "allocations of: " #statement; \
+    } while (false)
@@ -0,0 +1,262 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark.h"
+
+#include <DConfig>
+#include <DConfigFile>
+#include <DStandardPaths>
+
+#include <QDBusArgument>
+#include <QDBusMessage>
+#include <QDBusVariant>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <unistd.h>
+
+DCORE_USE_NAMESPACE
+
+static constexpr char const *APP_ID = "org.deepin.benchmark";
+static constexpr char const *FILE_NAME = "org.deepin.benchmark.dconfig";
+static constexpr int KeyCount = 200;
+static constexpr int OverrideCount = 20;
+
+static QString keyName(int index)
+{
+    return QString("key%1").arg(index);
+}
+
+static void writeJson(const QString &path, const QJsonObject &root)
+{
+    QDir().mkpath(QFileInfo(path).path());
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly))
+        file.write(QJsonDocument(root).toJson());
+}
+
+// The synthetic meta contains `KeyCount` keys of different types, every override file overrides 10 of them.
+static void createFixtures(const QString &localPrefix)
+{
+    QJsonObject contents;
+    for (int i = 0; i < KeyCount; ++i) {
+        QJsonObject item;
+        switch (i % 4) {
+        case 0: item["value"] = i; break;
+        case 1: item["value"] = QString("value%1").arg(i); break;
+        case 2: item["value"] = (i % 8 == 2); break;
+        default: item["value"] = QJsonArray{QString("a%1").arg(i), QString("b%1").arg(i)}; break;
+        }
+        item["serial"] = 0;
+        item["flags"] = QJsonArray{i % 10 == 0 ? "global" : "user-public"};
+        item["name"] = QString("name %1").arg(i);
+        item["name[zh_CN]"] = QString("名称 %1").arg(i);
+        item["description"] = QString("description %1").arg(i);
+        item["permissions"] = "readwrite";
+        item["visibility"] = "public";
+        contents[keyName(i)] = item;
+    }
+    writeJson(QString("%1" PREFIX "/share/dsg/configs/%2/%3.json").arg(localPrefix, APP_ID, FILE_NAME),
+              QJsonObject{{"magic", "dsg.config.meta"}, {"version", "1.0"}, {"contents", contents}});
+
+    for (int i = 0; i < OverrideCount; ++i) {
+        QJsonObject overrides;
+        for (int j = 0; j < 10; ++j) {
+            const int index = (i * 10 + j) % KeyCount;
+            // keep the meta's type of the value.
+            overrides[keyName(index)] = QJsonObject{{"value", contents[keyName(index)].toObject()["value"]},
+                                                    {"serial", 0}};
+        }
+        writeJson(QString("%1" PREFIX "/share/dsg/configs/overrides/%2/%3/%4.json")
+                      .arg(localPrefix, APP_ID, FILE_NAME).arg(i),
+                  QJsonObject{{"magic", "dsg.config.override"}, {"version", "1.0"}, {"contents", overrides}});
+    }
+}
+
+/*
+ * It simulates the client side of DBusBackend without IPC, the values are marshalled
+ * to a QDBusMessage as the real DBusBackend does, it measures the cost of DConfig's
+ * dispatching and marshalling.
+ */
+class MockDBusBackend : public DConfigBackend
+{
+public:
+    bool isValid() const override { return true; }
+    bool load(const QString &) override
+    {
+        for (int i = 0; i < KeyCount; ++i)
+            storage.insert(keyName(i), i);
+        return true;
+    }
+    QStringList keyList() const override { return storage.keys(); }
+    QVariant value(const QString &key, const QVariant &fallback) const override
+    {
+        auto call = QDBusMessage::createMethodCall("org.desktopspec.ConfigManager", "/", "org.desktopspec.ConfigManager.Manager", "value");
+        call << key;
+        const auto reply = call.createReply(QVariant::fromValue(QDBusVariant(storage.value(key, fallback))));
+        return reply.arguments().value(0).value<QDBusVariant>().variant();
+    }
+    void setValue(const QString &key, const QVariant &value) override
+    {
+        auto call = QDBusMessage::createMethodCall("org.desktopspec.ConfigManager", "/", "org.desktopspec.ConfigManager.Manager", "setValue");
+        call << key << QVariant::fromValue(QDBusVariant(value));
+        storage.insert(call.arguments().value(0).toString(), call.arguments().value(1).value<QDBusVariant>().variant());
+    }
+    QString name() const override { return QString("MockDBusBackend"); }
+
+private:
+    QVariantHash storage;
+};
+
+class bench_DConfig : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void load_data();
+    void load();
+    void fileBackendValue();
+    void fileBackendSetValue();
+    void mockDBusBackendValue();
+    void mockDBusBackendSetValue();
+    void save_data();
+    void save();
+
+private:
+    QTemporaryDir tmpDir;
+    QString localPrefix;
+    QByteArray dataDirs;
+};
+
+void bench_DConfig::initTestCase()
+{
+    QVERIFY(tmpDir.isValid());
+    localPrefix = tmpDir.path();
+    createFixtures(localPrefix);
+
+    dataDirs = qgetenv("DSG_DATA_DIRS");
+    qputenv("DSG_DATA_DIRS", PREFIX "/share/dsg");
+    qputenv("DSG_DCONFIG_BACKEND_TYPE", "FileBackend");
+    qputenv("DSG_DCONFIG_FILE_BACKEND_LOCAL_PREFIX", localPrefix.toLocal8Bit());
+    DStandardPaths::invalidateCache();
+}
+
+void bench_DConfig::cleanupTestCase()
+{
+    qputenv("DSG_DATA_DIRS", dataDirs);
+    qunsetenv("DSG_DCONFIG_BACKEND_TYPE");
+    qunsetenv("DSG_DCONFIG_FILE_BACKEND_LOCAL_PREFIX");
+    qunsetenv("DSG_DCONFIG_META_SNAPSHOT");
+    DStandardPaths::invalidateCache();
+}
+
+void bench_DConfig::load_data()
+{
+    QTest::addColumn<bool>("snapshot");
+    QTest::newRow("json") << false;
+    QTest::newRow("snapshot") << true;
+}
+
+void bench_DConfig::load()
+{
+    QFETCH(bool, snapshot);
+    qputenv("DSG_DCONFIG_META_SNAPSHOT", snapshot ? "1" : "0");
+    {
+        // create the snapshot before measuring.
+        DConfigFile config(APP_ID, FILE_NAME);
+        QVERIFY(config.load(localPrefix));
+    }
+
+    QBENCHMARK {
+        DConfigFile config(APP_ID, FILE_NAME);
+        config.load(localPrefix);
+    }
+}
+
+void bench_DConfig::fileBackendValue()
+{
+    QScopedPointer<DConfig> config(DConfig::create(APP_ID, FILE_NAME));
+    QVERIFY(config->isValid());
+
+    QBENCHMARK {
+        for (int i = 0; i < KeyCount; ++i)
+            config->value(keyName(i));
+    }
+}
+
+void bench_DConfig::fileBackendSetValue()
+{
+    QScopedPointer<DConfig> config(DConfig::create(APP_ID, FILE_NAME));
+    QVERIFY(config->isValid());
+
+    int round = 0;
+    QBENCHMARK {
+        ++round;
+        for (int i = 0; i < KeyCount; i += 4)
+            config->setValue(keyName(i), i + round);
+    }
+}
+
+void bench_DConfig::mockDBusBackendValue()
+{
+    QScopedPointer<DConfig> config(DConfig::create(new MockDBusBackend, APP_ID, FILE_NAME));
+    QVERIFY(config->isValid());
+
+    QBENCHMARK {
+        for (int i = 0; i < KeyCount; ++i)
+            config->value(keyName(i));
+    }
+}
+
+void bench_DConfig::mockDBusBackendSetValue()
+{
+    QScopedPointer<DConfig> config(DConfig::create(new MockDBusBackend, APP_ID, FILE_NAME));
+    QVERIFY(config->isValid());
+
+    int round = 0;
+    QBENCHMARK {
+        ++round;
+        for (int i = 0; i < KeyCount; ++i)
+            config->setValue(keyName(i), i + round);
+    }
+}
+
+void bench_DConfig::save_data()
+{
+    QTest::addColumn<int>("changedKeys");
+    QTest::newRow("1 key") << 1;
+    QTest::newRow("50 keys") << KeyCount / 4;
+}
+
+void bench_DConfig::save()
+{
+    QFETCH(int, changedKeys);
+    DConfigFile config(APP_ID, FILE_NAME);
+    QVERIFY(config.load(localPrefix));
+    QScopedPointer<DConfigCache> userCache(config.createUserCache(getuid()));
+    QVERIFY(userCache->load(localPrefix));
+
+    // fill the cache with all keys, so that every save writes a large cache.
+    for (int i = 0; i < KeyCount; ++i)
+        config.setValue(keyName(i), config.value(keyName(i), userCache.data()), APP_ID, userCache.data());
+
+    int round = 0;
+    QBENCHMARK {
+        ++round;
+        // the keys of string type.
+        for (int i = 0; i < changedKeys; ++i)
+            config.setValue(keyName(i * 4 + 1), QString::number(round), APP_ID, userCache.data());
+        userCache->save(localPrefix);
+    }
+}
+
+BENCHMARK_REGISTER(bench_DConfig)
+
+#include "bench_dconfig.moc"
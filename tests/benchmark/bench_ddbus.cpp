@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark.h"
+
+#include <DDBusSender>
+
+#include <QDBusConnection>
+#include <QDBusPendingReply>
+#include <QScopedPointer>
+#include <QTest>
+#include <QThread>
+
+DCORE_USE_NAMESPACE
+
+static constexpr char const *Service = "org.deepin.dtk.Benchmark";
+static constexpr char const *Interface = "org.deepin.dtk.Benchmark";
+static constexpr char const *ServiceConnection = "bench-service";
+static constexpr int CallCount = 100;
+
+class BenchEchoService : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.deepin.dtk.Benchmark")
+
+public Q_SLOTS:
+    QString echo(const QString &text) { return text; }
+};
+
+// The calls of the D-Bus helpers to a service on its own connection and thread, over the session
+// bus, which is a private one started by main() if dbus-daemon is found.
+class bench_DDBus : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void senderCall();
+    void batch_data();
+    void batch();
+
+private:
+    DDBusCaller echoCaller() const;
+
+    QThread serviceThread;
+    QScopedPointer<BenchEchoService> service;
+};
+
+void bench_DDBus::initTestCase()
+{
+    QDBusConnection connection = QDBusConnection::connectToBus(QDBusConnection::SessionBus, ServiceConnection);
+    if (!connection.isConnected())
+        QSKIP("no session bus");
+
+    // a blocking call waits for the reply, which is handled in the thread of the object
+    service.reset(new BenchEchoService);
+    service->moveToThread(&serviceThread);
+    serviceThread.start();
+    QVERIFY(connection.registerObject("/", service.data(), QDBusConnection::ExportAllSlots));
+    QVERIFY(connection.registerService(Service));
+}
+
+void bench_DDBus::cleanupTestCase()
+{
+    QDBusConnection::disconnectFromBus(ServiceConnection);
+    serviceThread.quit();
+    serviceThread.wait();
+}
+
+DDBusCaller bench_DDBus::echoCaller() const
+{
+    return DDBusSender().service(Service).path("/").interface(Interface).method("echo").arg(QString("hello"));
+}
+
+// the round trips one by one
+void bench_DDBus::senderCall()
+{
+    QBENCHMARK {
+        for (int i = 0; i < CallCount; ++i) {
+            QDBusPendingReply<QString> reply = echoCaller().call();
+            reply.waitForFinished();
+            QVERIFY(!reply.isError());
+        }
+    }
+}
+
+void bench_DDBus::batch_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("10 calls") << 10;
+    QTest::newRow("100 calls") << CallCount;
+}
+
+// the calls are sent back to back, and the replies are waited at last
+void bench_DDBus::batch()
+{
+    QFETCH(int, count);
+
+    QBENCHMARK {
+        DDBusBatch batch;
+        for (int i = 0; i < count; ++i)
+            batch << echoCaller();
+        QScopedPointer<DDBusBatchWatcher> watcher(batch.flush());
+        watcher->waitForFinished();
+        QVERIFY(!watcher->isError());
+    }
+}
+
+BENCHMARK_REGISTER(bench_DDBus)
+
+#include "bench_ddbus.moc"
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark.h"
+
+#include <DDciFile>
+
+#include <QTest>
+
+DCORE_USE_NAMESPACE
+
+static constexpr int DirectoryCount = 50;
+static constexpr int FileCount = 20;
+
+class bench_DDciFile : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void load_data();
+    void load();
+    void list();
+    void dataRef();
+    void write();
+
+private:
+    QVector<QPair<QString, QByteArray>> files;
+    QByteArray data;
+    QByteArray compressedData;
+};
+
+// the layout of an icon theme, the sizes of an icon in the directories
+void bench_DDciFile::initTestCase()
+{
+    for (int i = 0; i < DirectoryCount; ++i) {
+        for (int j = 0; j < FileCount; ++j) {
+            files << qMakePair(QString("/%1/%2.webp").arg(i).arg(j),
+                               QByteArray(1024 + j * 64, char('a' + j % 26)));
+        }
+    }
+
+    DDciFile dci;
+    for (int i = 0; i < DirectoryCount; ++i)
+        QVERIFY(dci.mkdir(QString("/%1").arg(i)));
+    QVERIFY(dci.writeFiles(files));
+    data = dci.toData();
+
+    QVERIFY(dci.setVersion(3));
+    for (const auto &file : std::as_const(files))
+        QVERIFY(dci.setCompressed(file.first, true));
+    compressedData = dci.toData();
+}
+
+void bench_DDciFile::load_data()
+{
+    QTest::addColumn<bool>("compressed");
+
+    QTest::newRow("plain") << false;
+    QTest::newRow("compressed") << true;
+}
+
+void bench_DDciFile::load()
+{
+    QFETCH(bool, compressed);
+
+    const QByteArray &content = compressed ? compressedData : data;
+    QBENCHMARK {
+        DDciFile dci(content);
+        QVERIFY(dci.isValid());
+    }
+}
+
+void bench_DDciFile::list()
+{
+    const DDciFile dci(data);
+    QBENCHMARK {
+        for (int i = 0; i < DirectoryCount; ++i)
+            dci.list(QString("/%1").arg(i));
+    }
+}
+
+void bench_DDciFile::dataRef()
+{
+    const DDciFile dci(data);
+    QBENCHMARK {
+        for (const auto &file : std::as_const(files))
+            dci.dataRef(file.first);
+    }
+}
+
+void bench_DDciFile::write()
+{
+    QBENCHMARK {
+        DDciFile dci;
+        for (int i = 0; i < DirectoryCount; ++i)
+            dci.mkdir(QString("/%1").arg(i));
+        dci.writeFiles(files);
+        dci.toData();
+    }
+}
+
+BENCHMARK_REGISTER(bench_DDciFile)
+
+#include "bench_ddcifile.moc"
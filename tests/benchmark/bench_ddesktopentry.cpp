@@ -0,0 +1,244 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark.h"
+
+#include <DDesktopEntry>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMap>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+DCORE_USE_NAMESPACE
+
+// the real desktop files are limited, so that a run doesn't take too long
+static constexpr int MaxSystemFiles = 500;
+
+struct Corpus
+{
+    QStringList files;
+    qint64 bytes = 0;
+};
+
+Q_DECLARE_METATYPE(Corpus)
+
+class bench_DDesktopEntry : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void load_data();
+    void load();
+    void throughput_data();
+    void throughput();
+    void stringValue_data();
+    void stringValue();
+    void localizedValue_data();
+    void localizedValue();
+    void save_data();
+    void save();
+
+private:
+    void addCorpusRows();
+    Corpus writeCorpus(const QString &name, const QList<QByteArray> &contents);
+
+    QTemporaryDir tmpDir;
+    QMap<QString, Corpus> corpora;
+};
+
+static QByteArray smallEntry(int index)
+{
+    return QString("[Desktop Entry]\nType=Application\nName=App %1\nExec=/usr/bin/app%1 %U\nIcon=app%1\n")
+            .arg(index).toUtf8();
+}
+
+// It looks like the desktop files of the large applications, which have a lot of translations.
+static QByteArray localizedEntry(int index)
+{
+    QByteArray content = QString("[Desktop Entry]\nType=Application\nExec=/usr/bin/bench%1 --option=value %U\n"
+                                 "Name=Benchmark %1\nComment=The comment of the benchmark application\n").arg(index).toUtf8();
+    for (int i = 0; i < 200; ++i) {
+        content += QString("Name[lang%1]=The localized name of the benchmark application %1\n").arg(i).toUtf8();
+        content += QString("Comment[lang%1]=The localized comment which is much longer than the name, %1\n").arg(i).toUtf8();
+        content += QString("Keywords[lang%1]=first\\;keyword;second keyword;third\\skeyword;\n").arg(i).toUtf8();
+    }
+    for (int i = 0; i < 10; ++i)
+        content += QString("\n[Desktop Action action%1]\nName=Action %1\nExec=/usr/bin/bench --action=%1\n").arg(i).toUtf8();
+    return content;
+}
+
+// It looks like mimeinfo.cache, one big section of a lot of keys.
+static QByteArray mimeCache()
+{
+    QByteArray content("[MIME Cache]\n");
+    for (int i = 0; i < 5000; ++i)
+        content += QString("application/x-type%1=app%1.desktop;viewer.desktop;editor-%2.desktop;\n").arg(i).arg(i % 7).toUtf8();
+    return content;
+}
+
+Corpus bench_DDesktopEntry::writeCorpus(const QString &name, const QList<QByteArray> &contents)
+{
+    Corpus corpus;
+    QDir(tmpDir.path()).mkpath(name);
+    for (int i = 0; i < contents.size(); ++i) {
+        const QString &filePath = tmpDir.filePath(QString("%1/%2.desktop").arg(name).arg(i));
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly) || file.write(contents.at(i)) != contents.at(i).size())
+            QTest::qFail("Failed to write the corpus", __FILE__, __LINE__);
+        corpus.files << filePath;
+        corpus.bytes += contents.at(i).size();
+    }
+    return corpus;
+}
+
+void bench_DDesktopEntry::initTestCase()
+{
+    QVERIFY(tmpDir.isValid());
+
+    QList<QByteArray> contents;
+    for (int i = 0; i < 100; ++i)
+        contents << smallEntry(i);
+    corpora.insert("small", writeCorpus("small", contents));
+
+    contents.clear();
+    for (int i = 0; i < 10; ++i)
+        contents << localizedEntry(i);
+    corpora.insert("localized", writeCorpus("localized", contents));
+
+    corpora.insert("mimeinfo.cache", writeCorpus("mimeinfo", {mimeCache()}));
+
+    // the files are copied, so that save() doesn't touch the system
+    contents.clear();
+    for (const QString &dirPath : QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation)) {
+        for (const QFileInfo &info : QDir(dirPath).entryInfoList({"*.desktop"}, QDir::Files)) {
+            QFile file(info.filePath());
+            if (contents.size() < MaxSystemFiles && file.open(QIODevice::ReadOnly))
+                contents << file.readAll();
+        }
+    }
+    if (!contents.isEmpty())
+        corpora.insert("system", writeCorpus("system", contents));
+}
+
+void bench_DDesktopEntry::addCorpusRows()
+{
+    QTest::addColumn<Corpus>("corpus");
+    for (auto it = corpora.cbegin(); it != corpora.cend(); ++it) {
+        QTest::newRow(QString("%1 (%2 files, %3 KiB)").arg(it.key()).arg(it->files.size()).arg(it->bytes / 1024).toUtf8().constData())
+                << it.value();
+    }
+}
+
+void bench_DDesktopEntry::load_data()
+{
+    addCorpusRows();
+}
+
+// the time of loading all files of the corpus
+void bench_DDesktopEntry::load()
+{
+    QFETCH(Corpus, corpus);
+
+    QBENCHMARK {
+        for (const QString &filePath : corpus.files) {
+            DDesktopEntry entry(filePath);
+        }
+    }
+}
+
+void bench_DDesktopEntry::throughput_data()
+{
+    addCorpusRows();
+}
+
+// reports the parse throughput, and the average latency of a file as a message
+void bench_DDesktopEntry::throughput()
+{
+    QFETCH(Corpus, corpus);
+
+    int rounds = 0;
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        for (const QString &filePath : corpus.files) {
+            DDesktopEntry entry(filePath);
+        }
+        ++rounds;
+    } while (timer.elapsed() < 1000);
+    const qint64 elapsed = timer.nsecsElapsed();
+
+    qInfo("%.1f us per file", double(elapsed) / 1000 / rounds / corpus.files.size());
+    QTest::setBenchmarkResult(double(corpus.bytes) * rounds * 1000000000 / elapsed, QTest::BytesPerSecond);
+}
+
+void bench_DDesktopEntry::stringValue_data()
+{
+    addCorpusRows();
+}
+
+// looks up the keys of the loaded entries, which includes decoding the values
+void bench_DDesktopEntry::stringValue()
+{
+    QFETCH(Corpus, corpus);
+
+    QList<QSharedPointer<DDesktopEntry>> entries = DDesktopEntry::loadMany(corpus.files);
+    QBENCHMARK {
+        for (const auto &entry : entries) {
+            entry->stringValue("Exec");
+            entry->stringValue("Icon");
+            entry->stringListValue("Keywords[lang100]");
+            entry->stringValue("application/x-type2500", "MIME Cache");
+        }
+    }
+}
+
+void bench_DDesktopEntry::localizedValue_data()
+{
+    addCorpusRows();
+}
+
+void bench_DDesktopEntry::localizedValue()
+{
+    QFETCH(Corpus, corpus);
+
+    QList<QSharedPointer<DDesktopEntry>> entries = DDesktopEntry::loadMany(corpus.files);
+    const QLocale locale("zh_CN");
+    QBENCHMARK {
+        for (const auto &entry : entries) {
+            entry->name();
+            entry->localizedValue("Name", "lang100");
+            entry->localizedValue("Comment", locale);
+        }
+    }
+}
+
+void bench_DDesktopEntry::save_data()
+{
+    addCorpusRows();
+}
+
+// changes a key of every file and saves it
+void bench_DDesktopEntry::save()
+{
+    QFETCH(Corpus, corpus);
+
+    QList<QSharedPointer<DDesktopEntry>> entries = DDesktopEntry::loadMany(corpus.files);
+    int round = 0;
+    QBENCHMARK {
+        ++round;
+        for (const auto &entry : entries) {
+            entry->setRawValue(QString::number(round), "X-Benchmark-Round");
+            entry->save();
+        }
+    }
+}
+
+BENCHMARK_REGISTER(bench_DDesktopEntry)
+
+#include "bench_ddesktopentry.moc"
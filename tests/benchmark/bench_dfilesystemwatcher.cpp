@@ -0,0 +1,300 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark.h"
+
+#include <DFileSystemWatcher>
+#include <DFileWatcher>
+#include <DFileWatcherManager>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUrl>
+
+#include <time.h>
+
+DCORE_USE_NAMESPACE
+
+// the files are spread in the directories, as a real tree
+static constexpr int FilesPerDirectory = 1000;
+// the time to wait for the signals of a burst, the events may be lost if the kernel queue overflowed
+static constexpr int BurstTimeout = 30000;
+
+enum Engine {
+    FileSystemWatcherEngine,
+    FileWatcherEngine,
+    FileWatcherManagerEngine
+};
+
+enum Operation {
+    CreateOperation,
+    ModifyOperation,
+    MoveOperation,
+    DeleteOperation
+};
+
+// Records the time from the syscall of a file to the first signal of it.
+class LatencyProbe
+{
+public:
+    void reset()
+    {
+        started.clear();
+        latencies.clear();
+        clock.start();
+    }
+
+    void start(const QString &name) { started.insert(name, clock.nsecsElapsed()); }
+
+    void arrive(const QString &path)
+    {
+        const QString &name = QFileInfo(path).fileName();
+        const auto it = started.constFind(name);
+        if (it != started.cend() && !latencies.contains(name))
+            latencies.insert(name, clock.nsecsElapsed() - it.value());
+    }
+
+    int arrivedCount() const { return latencies.size(); }
+
+    double meanLatency() const
+    {
+        qint64 total = 0;
+        for (qint64 latency : latencies)
+            total += latency;
+        return latencies.isEmpty() ? 0 : double(total) / latencies.size() / 1000;
+    }
+
+    double maxLatency() const
+    {
+        qint64 max = 0;
+        for (qint64 latency : latencies)
+            max = qMax(max, latency);
+        return double(max) / 1000;
+    }
+
+private:
+    QElapsedTimer clock;
+    QHash<QString, qint64> started;
+    QHash<QString, qint64> latencies;
+};
+
+class bench_DFileSystemWatcher : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void burst_data();
+    void burst();
+
+private:
+    bool setUpEngine(Engine engine, const QStringList &dirs, const QStringList &files);
+    void runOperation(Operation operation, const QStringList &dirs, int count);
+
+    QScopedPointer<QObject> holder;
+    DFileSystemWatcher *fileSystemWatcher = nullptr;
+    LatencyProbe probe;
+};
+
+// in KiB, the peak is the value of VmHWM
+static qint64 memoryUsage(const char *field)
+{
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+
+    for (const QByteArray &line : file.readAll().split('\n')) {
+        if (line.startsWith(field))
+            return line.mid(int(qstrlen(field))).trimmed().split(' ').value(0).toLongLong();
+    }
+
+    return 0;
+}
+
+// the CPU time of the thread, which handles the events and emits the signals
+static qint64 threadCpuTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return qint64(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+static QString fileName(const QStringList &dirs, const char *prefix, int index)
+{
+    return dirs.at(index / FilesPerDirectory) + QString("/%1%2").arg(prefix).arg(index);
+}
+
+void bench_DFileSystemWatcher::burst_data()
+{
+    QTest::addColumn<int>("engine");
+    QTest::addColumn<int>("count");
+
+    const QList<QPair<Engine, QString>> engines = {
+        {FileSystemWatcherEngine, "DFileSystemWatcher"},
+        {FileWatcherEngine, "DFileWatcher"},
+        {FileWatcherManagerEngine, "DFileWatcherManager"},
+    };
+
+    for (const auto &engine : engines) {
+        for (int count : {1000, 10000, 100000}) {
+            QTest::newRow(QString("%1 %2 entries").arg(engine.second).arg(count).toUtf8().constData())
+                    << int(engine.first) << count;
+        }
+    }
+}
+
+bool bench_DFileSystemWatcher::setUpEngine(Engine engine, const QStringList &dirs, const QStringList &files)
+{
+    holder.reset(new QObject);
+    fileSystemWatcher = nullptr;
+
+    switch (engine) {
+    case FileSystemWatcherEngine: {
+        // the files are watched one by one, and the directories for the new files
+        fileSystemWatcher = new DFileSystemWatcher(holder.data());
+        if (!fileSystemWatcher->addPaths(dirs + files).isEmpty())
+            return false;
+
+        auto arrive = [this](const QString &path, const QString &name) {
+            probe.arrive(name.isEmpty() ? path : name);
+        };
+        connect(fileSystemWatcher, &DFileSystemWatcher::fileCreated, holder.data(), arrive);
+        connect(fileSystemWatcher, &DFileSystemWatcher::fileModified, holder.data(), arrive);
+        connect(fileSystemWatcher, &DFileSystemWatcher::fileDeleted, holder.data(), arrive);
+        connect(fileSystemWatcher, &DFileSystemWatcher::fileMoved, holder.data(),
+                [this](const QString &, const QString &fromName, const QString &, const QString &) {
+            probe.arrive(fromName);
+        });
+        break;
+    }
+    case FileWatcherEngine: {
+        // a watcher of every directory, a DFileWatcher of every file doesn't scale at all
+        for (const QString &dir : dirs) {
+            DFileWatcher *watcher = new DFileWatcher(dir, holder.data());
+            if (!watcher->startWatcher())
+                return false;
+
+            auto arrive = [this](const QUrl &url) { probe.arrive(url.toLocalFile()); };
+            connect(watcher, &DFileWatcher::subfileCreated, holder.data(), arrive);
+            connect(watcher, &DFileWatcher::fileModified, holder.data(), arrive);
+            connect(watcher, &DFileWatcher::fileDeleted, holder.data(), arrive);
+            connect(watcher, &DFileWatcher::fileMoved, holder.data(), arrive);
+        }
+        break;
+    }
+    case FileWatcherManagerEngine: {
+        DFileWatcherManager *manager = new DFileWatcherManager(holder.data());
+        if (!manager->addMany(dirs + files).isEmpty())
+            return false;
+
+        auto arrive = [this](const QString &path) { probe.arrive(path); };
+        connect(manager, &DFileWatcherManager::subfileCreated, holder.data(), arrive);
+        connect(manager, &DFileWatcherManager::fileModified, holder.data(), arrive);
+        connect(manager, &DFileWatcherManager::fileDeleted, holder.data(), arrive);
+        connect(manager, &DFileWatcherManager::fileMoved, holder.data(), arrive);
+        break;
+    }
+    }
+
+    return true;
+}
+
+void bench_DFileSystemWatcher::runOperation(Operation operation, const QStringList &dirs, int count)
+{
+    static const char *operationNames[] = {"create", "modify", "move", "delete"};
+
+    probe.reset();
+    const qint64 cpuTime = threadCpuTime();
+    const qint64 batchTime = fileSystemWatcher ? fileSystemWatcher->statistics().totalBatchTime : 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < count; ++i) {
+        switch (operation) {
+        case CreateOperation: {
+            probe.start(QString("new%1").arg(i));
+            QFile file(fileName(dirs, "new", i));
+            file.open(QIODevice::WriteOnly);
+            break;
+        }
+        case ModifyOperation: {
+            probe.start(QString("file%1").arg(i));
+            QFile file(fileName(dirs, "file", i));
+            if (file.open(QIODevice::WriteOnly | QIODevice::Append))
+                file.write("burst");
+            break;
+        }
+        case MoveOperation:
+            probe.start(QString("file%1").arg(i));
+            QFile::rename(fileName(dirs, "file", i), fileName(dirs, "moved", i));
+            break;
+        case DeleteOperation:
+            probe.start(QString("moved%1").arg(i));
+            QFile::remove(fileName(dirs, "moved", i));
+            break;
+        }
+    }
+
+    QTest::qWaitFor([this, count]() { return probe.arrivedCount() >= count; }, BurstTimeout);
+    const qint64 elapsed = timer.elapsed();
+
+    QString message = QString("%1: %2 ms, latency mean %3 us, max %4 us, main thread CPU %5 ms")
+            .arg(operationNames[operation]).arg(elapsed)
+            .arg(probe.meanLatency(), 0, 'f', 1).arg(probe.maxLatency(), 0, 'f', 1)
+            .arg((threadCpuTime() - cpuTime) / 1000);
+    if (fileSystemWatcher) {
+        const double handled = double(fileSystemWatcher->statistics().totalBatchTime - batchTime) / 1000;
+        message += QString(", inside _q_readFromInotify %1 ms").arg(handled, 0, 'f', 1);
+    }
+    if (probe.arrivedCount() < count)
+        message += QString(", %1 signals are lost").arg(count - probe.arrivedCount());
+    qInfo().noquote() << message;
+}
+
+// creates, modifies, moves and deletes all of the files in bursts
+void bench_DFileSystemWatcher::burst()
+{
+    QFETCH(int, engine);
+    QFETCH(int, count);
+
+    QTemporaryDir tmpDir;
+    QVERIFY(tmpDir.isValid());
+
+    QStringList dirs;
+    for (int i = 0; i * FilesPerDirectory < count; ++i) {
+        dirs << tmpDir.filePath(QString("dir%1").arg(i));
+        QVERIFY(QDir().mkpath(dirs.last()));
+    }
+
+    QStringList files;
+    files.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        files << fileName(dirs, "file", i);
+        QFile file(files.last());
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+
+    const qint64 memory = memoryUsage("VmRSS:");
+    if (!setUpEngine(Engine(engine), dirs, files))
+        QSKIP("Failed to watch all of the files, /proc/sys/fs/inotify/max_user_watches may be too small");
+    qInfo("memory of the watchers: %lld KiB, peak of the process: %lld KiB",
+          memoryUsage("VmRSS:") - memory, memoryUsage("VmHWM:"));
+
+    QElapsedTimer timer;
+    timer.start();
+    for (Operation operation : {CreateOperation, ModifyOperation, MoveOperation, DeleteOperation})
+        runOperation(operation, dirs, count);
+    QTest::setBenchmarkResult(timer.elapsed(), QTest::WalltimeMilliseconds);
+
+    holder.reset();
+    fileSystemWatcher = nullptr;
+}
+
+BENCHMARK_REGISTER(bench_DFileSystemWatcher)
+
+#include "bench_dfilesystemwatcher.moc"
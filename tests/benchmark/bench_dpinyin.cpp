@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark.h"
+
+#include <DPinyin>
+
+#include <QTest>
+
+DCORE_USE_NAMESPACE
+
+class bench_DPinyin : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void pinyin_data();
+    void pinyin();
+    void firstLetters_data();
+    void firstLetters();
+    void batchFirstLetters();
+
+private:
+    QStringList words;
+};
+
+// the words of 2 to 5 characters, some of them are polyphones
+void bench_DPinyin::initTestCase()
+{
+    const QString characters("深度音乐安全中心文件管理器系统设置浏览器相册影院终端计算器日历邮件行长重庆");
+    for (int i = 0; words.size() < 10000; ++i) {
+        QString word;
+        for (int j = 0; j < 2 + i % 4; ++j)
+            word += characters.at((i * 7 + j * 13) % characters.size());
+        words << word;
+    }
+}
+
+void bench_DPinyin::pinyin_data()
+{
+    QTest::addColumn<int>("toneStyle");
+
+    QTest::newRow("tone") << int(TS_Tone);
+    QTest::newRow("none tone") << int(TS_NoneTone);
+    QTest::newRow("tone number") << int(TS_ToneNum);
+}
+
+void bench_DPinyin::pinyin()
+{
+    QFETCH(int, toneStyle);
+
+    QBENCHMARK {
+        for (const QString &word : std::as_const(words))
+            Dtk::Core::pinyin(word, ToneStyle(toneStyle));
+    }
+}
+
+void bench_DPinyin::firstLetters_data()
+{
+    pinyin_data();
+}
+
+void bench_DPinyin::firstLetters()
+{
+    QFETCH(int, toneStyle);
+
+    QBENCHMARK {
+        for (const QString &word : std::as_const(words))
+            Dtk::Core::firstLetters(word, ToneStyle(toneStyle));
+    }
+}
+
+void bench_DPinyin::batchFirstLetters()
+{
+    QBENCHMARK {
+        Dtk::Core::batchFirstLetters(words, TS_NoneTone, 0);
+    }
+}
+
+BENCHMARK_REGISTER(bench_DPinyin)
+
+#include "bench_dpinyin.moc"
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark.h"
+
+#include <DPinyinIndex>
+
+#include <QTest>
+
+DCORE_USE_NAMESPACE
+
+class bench_DPinyinIndex : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void build();
+    void search_data();
+    void search();
+
+private:
+    QStringList names;
+};
+
+// the names are combined from the common family names and given names
+void bench_DPinyinIndex::initTestCase()
+{
+    const QString familyNames("王李张刘陈杨黄赵吴周徐孙马朱胡郭何高林罗郑梁谢宋唐许韩冯邓曹彭曾肖田董袁潘于蒋蔡余杜叶程苏魏吕丁任沈");
+    const QString givenNames("伟芳娜秀英敏静丽强磊军洋勇艳杰娟涛明超秀兰霞平刚桂英华玉萍红娥玲芬燕彬乐音度深");
+    for (int i = 0; names.size() < 100000; ++i) {
+        names << QString(familyNames.at(i % familyNames.size()))
+                + givenNames.at(i / familyNames.size() % givenNames.size())
+                + givenNames.at(i / familyNames.size() / givenNames.size() % givenNames.size());
+    }
+}
+
+void bench_DPinyinIndex::build()
+{
+    QBENCHMARK {
+        DPinyinIndex index(names);
+    }
+}
+
+void bench_DPinyinIndex::search_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<int>("limit");
+
+    QTest::newRow("full, 10 results") << "zhangwei" << 10;
+    QTest::newRow("full") << "zhangwei" << -1;
+    QTest::newRow("initials") << "zwf" << -1;
+    QTest::newRow("mixed") << "zhwfang" << -1;
+    QTest::newRow("one letter, 10 results") << "l" << 10;
+    QTest::newRow("no result") << "xyzxyz" << -1;
+}
+
+void bench_DPinyinIndex::search()
+{
+    QFETCH(QString, query);
+    QFETCH(int, limit);
+
+    const DPinyinIndex index(names);
+    QBENCHMARK {
+        index.search(query, limit);
+    }
+}
+
+BENCHMARK_REGISTER(bench_DPinyinIndex)
+
+#include "bench_dpinyinindex.moc"
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark.h"
+
+#include <DTextEncoding>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+DCORE_USE_NAMESPACE
+
+class bench_DTextEncoding : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void detectTextEncoding_data();
+    void detectTextEncoding();
+    void detectFileEncodings_data();
+    void detectFileEncodings();
+    void convert_data();
+    void convert();
+
+private:
+    QByteArray utf8Text;
+    QByteArray gb18030Text;
+    QTemporaryDir dir;
+    QStringList files;
+};
+
+void bench_DTextEncoding::initTestCase()
+{
+    const QByteArray line("深度操作系统 deepin 是一个致力于为全球用户提供美观易用的 Linux 发行版.\n");
+    while (utf8Text.size() < 256 * 1024)
+        utf8Text += line;
+
+    QByteArray content = utf8Text;
+    QVERIFY(DTextEncoding::convertTextEncoding(content, gb18030Text, "GB18030", "UTF-8"));
+
+    QVERIFY(dir.isValid());
+    for (int i = 0; i < 200; ++i) {
+        const QString fileName = dir.filePath(QString("file%1.txt").arg(i));
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write((i % 2 ? gb18030Text : utf8Text).left(16 * 1024));
+        files << fileName;
+    }
+}
+
+void bench_DTextEncoding::detectTextEncoding_data()
+{
+    QTest::addColumn<QByteArray>("content");
+
+    QTest::newRow("UTF-8, 4K") << utf8Text.left(4096);
+    QTest::newRow("UTF-8, 256K") << utf8Text;
+    QTest::newRow("GB18030, 4K") << gb18030Text.left(4096);
+    QTest::newRow("GB18030, 256K") << gb18030Text;
+}
+
+void bench_DTextEncoding::detectTextEncoding()
+{
+    QFETCH(QByteArray, content);
+
+    QBENCHMARK {
+        DTextEncoding::detectTextEncoding(content);
+    }
+}
+
+void bench_DTextEncoding::detectFileEncodings_data()
+{
+    QTest::addColumn<int>("cacheSize");
+
+    QTest::newRow("no cache") << 0;
+    QTest::newRow("cached") << 1024;
+}
+
+void bench_DTextEncoding::detectFileEncodings()
+{
+    QFETCH(int, cacheSize);
+
+    DTextEncoding::setDetectionCacheSize(cacheSize);
+    QBENCHMARK {
+        DTextEncoding::detectFileEncodings(files);
+    }
+    DTextEncoding::setDetectionCacheSize(0);
+}
+
+void bench_DTextEncoding::convert_data()
+{
+    QTest::addColumn<QByteArray>("toEncoding");
+    QTest::addColumn<QByteArray>("fromEncoding");
+
+    QTest::newRow("UTF-8 to GB18030") << QByteArray("GB18030") << QByteArray("UTF-8");
+    QTest::newRow("GB18030 to UTF-8") << QByteArray("UTF-8") << QByteArray("GB18030");
+}
+
+void bench_DTextEncoding::convert()
+{
+    QFETCH(QByteArray, toEncoding);
+    QFETCH(QByteArray, fromEncoding);
+
+    const DTextConverter converter(toEncoding, fromEncoding);
+    QVERIFY(converter.isValid());
+    const QByteArray &content = fromEncoding == "UTF-8" ? utf8Text : gb18030Text;
+    QByteArray outContent;
+    QBENCHMARK {
+        converter.convert(content, outContent);
+    }
+}
+
+BENCHMARK_REGISTER(bench_DTextEncoding)
+
+#include "bench_dtextencoding.moc"
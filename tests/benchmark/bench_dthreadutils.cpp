@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark.h"
+
+#include <DThreadUtils>
+
+#include <QTest>
+#include <QThread>
+
+DCORE_USE_NAMESPACE
+
+static constexpr int CallCount = 1000;
+
+class bench_DThreadUtils : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void roundTrip();
+    void post_data();
+    void post();
+
+private:
+    QThread thread;
+};
+
+void bench_DThreadUtils::initTestCase()
+{
+    thread.start();
+}
+
+void bench_DThreadUtils::cleanupTestCase()
+{
+    thread.quit();
+    thread.wait();
+}
+
+// a call which waits for the result in the worker thread
+void bench_DThreadUtils::roundTrip()
+{
+#if DTK_VERSION >= DTK_VERSION_CHECK(6, 0, 0, 0)
+    DThreadUtils utils(&thread);
+    QBENCHMARK {
+        for (int i = 0; i < CallCount; ++i)
+            utils.exec([i] { return i; });
+    }
+#else
+    QBENCHMARK {
+        for (int i = 0; i < CallCount; ++i)
+            DThreadUtil::runInThread(&thread, [i] { return i; });
+    }
+#endif
+}
+
+void bench_DThreadUtils::post_data()
+{
+    QTest::addColumn<bool>("batching");
+
+    QTest::newRow("events") << false;
+    QTest::newRow("batching") << true;
+}
+
+// the calls which are posted at once, and waited at last
+void bench_DThreadUtils::post()
+{
+#if DTK_VERSION >= DTK_VERSION_CHECK(6, 0, 0, 0)
+    QFETCH(bool, batching);
+
+    DThreadUtils utils(&thread);
+    utils.setBatchingEnabled(batching);
+    QBENCHMARK {
+        QFuture<int> last;
+        for (int i = 0; i < CallCount; ++i)
+            last = utils.run([i] { return i; });
+        last.waitForFinished();
+    }
+    utils.setBatchingEnabled(false);
+#else
+    QSKIP("DThreadUtil only waits for the calls one by one");
+#endif
+}
+
+BENCHMARK_REGISTER(bench_DThreadUtils)
+
+#include "bench_dthreadutils.moc"
@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#pragma once
+
+#include <QObject>
+#include <QList>
+
+#include <functional>
+
+using BenchmarkFactory = std::function<QObject *()>;
+
+inline QList<BenchmarkFactory> &benchmarkFactories()
+{
+    static QList<BenchmarkFactory> factories;
+    return factories;
+}
+
+inline bool registerBenchmark(BenchmarkFactory factory)
+{
+    benchmarkFactories().append(factory);
+    return true;
+}
+
+// register a QtTest class, all of the registered classes are executed by main().
+#define BENCHMARK_REGISTER(Class) \
+    static const bool _benchmark_registered_##Class = registerBenchmark([]() -> QObject * { return new Class; });
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+#
+# SPDX-License-Identifier: LGPL-3.0-or-later
+
+"""Compare the JSON results of bench-DtkCore with a baseline.
+
+The values are per iteration and lower is better for all the metrics of QtTest. The exit code
+is 1 if any result is slower than its baseline by more than the threshold.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import sys
+
+
+def load(path):
+    with open(path, encoding="utf-8") as f:
+        document = json.load(f)
+    return {(r["name"], r["tag"], r["metric"]): r["value"] for r in document["results"]}
+
+
+def label(key):
+    name, tag, metric = key
+    return f"{name}({tag}) [{metric}]" if tag else f"{name} [{metric}]"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="the allowed slowdown in percent, 10 by default")
+    parser.add_argument("--update", action="store_true",
+                        help="replace the baseline with the results")
+    parser.add_argument("result", help="the JSON written by bench-DtkCore -json")
+    parser.add_argument("baseline", help="the JSON of the baseline")
+    args = parser.parse_args()
+
+    if args.update:
+        os.makedirs(os.path.dirname(os.path.abspath(args.baseline)), exist_ok=True)
+        shutil.copyfile(args.result, args.baseline)
+        print(f"baseline updated: {args.baseline}")
+        return 0
+
+    if not os.path.exists(args.baseline):
+        print(f"no baseline {args.baseline}, nothing to compare")
+        return 0
+
+    results = load(args.result)
+    baseline = load(args.baseline)
+
+    regressions = 0
+    for key in sorted(results.keys() & baseline.keys()):
+        old, new = baseline[key], results[key]
+        change = (new - old) / old * 100 if old > 0 else 0.0
+        status = ""
+        if change > args.threshold:
+            status = "  REGRESSION"
+            regressions += 1
+        print(f"{label(key)}: {old:g} -> {new:g} ({change:+.1f}%){status}")
+
+    for key in sorted(baseline.keys() - results.keys()):
+        print(f"{label(key)}: missing in the results")
+    for key in sorted(results.keys() - baseline.keys()):
+        print(f"{label(key)}: new, not in the baseline")
+
+    if regressions:
+        print(f"{regressions} regression(s) over {args.threshold:g}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "benchmark.h"
+
+#include <dtkcore_global.h>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QScopedPointer>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QXmlStreamReader>
+
+// The benchmarks of D-Bus run on a private session bus, so that they neither disturb nor are
+// disturbed by the services of the desktop. The session bus of the desktop is used if
+// dbus-daemon isn't found.
+static QProcess *startPrivateBus()
+{
+    QScopedPointer<QProcess> bus(new QProcess);
+    bus->start("dbus-daemon", {"--session", "--nofork", "--print-address=1"});
+    if (!bus->waitForStarted() || !bus->waitForReadyRead(5000)) {
+        qWarning() << "failed to start a private bus, the session bus is used";
+        return nullptr;
+    }
+
+    qputenv("DBUS_SESSION_BUS_ADDRESS", bus->readLine().trimmed());
+    return bus.take();
+}
+
+// Appends the results in the XML output of QtTest, the values are per iteration.
+static bool readResults(const QString &fileName, QJsonArray *results)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QXmlStreamReader reader(&file);
+    QString testCase;
+    QString function;
+    while (!reader.atEnd()) {
+        if (reader.readNext() != QXmlStreamReader::StartElement)
+            continue;
+
+        const QXmlStreamAttributes attributes = reader.attributes();
+        if (reader.name() == QLatin1String("TestCase")) {
+            testCase = attributes.value("name").toString();
+        } else if (reader.name() == QLatin1String("TestFunction")) {
+            function = attributes.value("name").toString();
+        } else if (reader.name() == QLatin1String("BenchmarkResult")) {
+            results->append(QJsonObject {
+                {"name", testCase + "::" + function},
+                {"tag", attributes.value("tag").toString()},
+                {"metric", attributes.value("metric").toString()},
+                {"value", attributes.value("value").toDouble()},
+                {"iterations", attributes.value("iterations").toInt()},
+            });
+        }
+    }
+
+    return !reader.hasError();
+}
+
+static bool writeResults(const QString &fileName, const QJsonArray &results)
+{
+    const QJsonObject root {
+        {"format", 1},
+        {"date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"dtk", DTK_VERSION_MAJOR},
+        {"qt", QString(qVersion())},
+        {"cpu", QSysInfo::currentCpuArchitecture()},
+        {"kernel", QSysInfo::kernelVersion()},
+        {"results", results},
+    };
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+// ./bench-DtkCore [-json <file>] [QtTest options], the results of all the benchmarks are
+// written to <file> in JSON, which is compared with the baselines by compare.py.
+int main(int argc, char *argv[])
+{
+    qputenv("DSG_APP_ID", "benchmark");
+
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("benchmark");
+    app.setOrganizationName("deepin");
+
+    QStringList arguments = app.arguments();
+    QString jsonFile;
+    const int jsonIndex = arguments.indexOf("-json");
+    if (jsonIndex > 0 && jsonIndex + 1 < arguments.size()) {
+        jsonFile = arguments.at(jsonIndex + 1);
+        arguments.erase(arguments.begin() + jsonIndex, arguments.begin() + jsonIndex + 2);
+    }
+
+    QScopedPointer<QProcess> bus(startPrivateBus());
+
+    QTemporaryDir xmlDir;
+    QJsonArray results;
+    int retVal = 0;
+    for (const auto &factory : std::as_const(benchmarkFactories())) {
+        QScopedPointer<QObject> benchmark(factory());
+        if (jsonFile.isEmpty()) {
+            retVal += QTest::qExec(benchmark.data(), arguments);
+            continue;
+        }
+
+        const QString xmlFile = xmlDir.filePath(benchmark->metaObject()->className() + QString(".xml"));
+        retVal += QTest::qExec(benchmark.data(), arguments + QStringList {"-o", xmlFile + ",xml", "-o", "-,txt"});
+        if (!readResults(xmlFile, &results)) {
+            qWarning() << "failed to read the results of" << benchmark->metaObject()->className();
+            ++retVal;
+        }
+    }
+
+    if (!jsonFile.isEmpty() && !writeResults(jsonFile, results)) {
+        qWarning() << "failed to write the results to" << jsonFile;
+        ++retVal;
+    }
+
+    if (bus) {
+        bus->terminate();
+        bus->waitForFinished();
+    }
+
+    return retVal;
+}
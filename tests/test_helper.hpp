@@ -6,6 +6,8 @@
 
 #include <QDir>
 
+#include "filesystem/dstandardpaths.h"
+
 class EnvGuard {
 public:
     void set(const char *name, const QByteArray &value, bool mkpath = true)
@@ -14,6 +16,7 @@ public:
         if (m_originValue.isEmpty())
             m_originValue = qgetenv(m_name);
         qputenv(m_name, value);
+        DTK_CORE_NAMESPACE::DStandardPaths::invalidateCache();
 
         if (mkpath && !QDir(value).exists()) {
             QDir().mkpath(value);
@@ -24,10 +27,12 @@ public:
         m_name = name;
         m_originValue = qgetenv(m_name);
         qunsetenv(m_name);
+        DTK_CORE_NAMESPACE::DStandardPaths::invalidateCache();
     }
     void restore()
     {
         qputenv(m_name, m_originValue);
+        DTK_CORE_NAMESPACE::DStandardPaths::invalidateCache();
     }
     QString value()
     {
@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "alloc_counter.hpp"
+
+#include <QByteArray>
+#include <QList>
+
+#include <thread>
+
+TEST(ut_AllocationCounter, count)
+{
+    if (!AllocationCounter::isSupported())
+        GTEST_SKIP() << "the allocations can't be counted in this build";
+
+    AllocationCounter counter;
+    EXPECT_EQ(counter.count(), 0u);
+
+    QByteArray data(64, 'x');
+    EXPECT_EQ(counter.count(), 1u);
+
+    // implicitly shared, nothing is allocated
+    EXPECT_ALLOCATIONS_LE(0, QByteArray copy = data; Q_UNUSED(copy));
+
+    counter.reset();
+    data.detach();
+    EXPECT_EQ(counter.count(), 0u);
+    data.append(QByteArray(1024, 'y'));
+    EXPECT_GE(counter.count(), 1u);
+}
+
+TEST(ut_AllocationCounter, perThread)
+{
+    if (!AllocationCounter::isSupported())
+        GTEST_SKIP() << "the allocations can't be counted in this build";
+
+    AllocationCounter counter;
+    std::uint64_t workerCount = 0;
+    std::thread worker([&workerCount] {
+        AllocationCounter workerCounter;
+        QList<QByteArray> list;
+        for (int i = 0; i < 100; ++i)
+            list << QByteArray(64, char('a' + i % 26));
+        workerCount = workerCounter.count();
+    });
+    worker.join();
+
+    EXPECT_GE(workerCount, 100u);
+    // only the thread itself is allocated here
+    EXPECT_LT(counter.count(), 10u);
+}
@@ -10,6 +10,9 @@
 #include <QDir>
 #include <QTemporaryDir>
 
+#include <atomic>
+#include <thread>
+
 DCORE_USE_NAMESPACE
 
 #ifndef GTEST_SKIP
@@ -63,6 +66,28 @@ TEST(ut_DCapManager, paths)
     EXPECT_FALSE(DCapManager::instance()->paths().contains("/path/to/myCap"));
 }
 
+TEST(ut_DCapManager, concurrentUpdate)
+{
+    std::atomic_bool running(true);
+    std::thread reader([&running]() {
+        while (running) {
+            DCapFile file("/tmp/cap_concurrent");
+            file.exists();
+            DCapManager::instance()->paths();
+        }
+    });
+
+    for (int i = 0; i < 1000; ++i) {
+        DCapManager::instance()->appendPaths({"/path/to/myCap", "/path/to/otherCap"});
+        DCapManager::instance()->removePaths({"/path/to/myCap", "/path/to/otherCap"});
+    }
+    running = false;
+    reader.join();
+
+    EXPECT_FALSE(DCapManager::instance()->paths().contains("/path/to/myCap"));
+    EXPECT_TRUE(DCapManager::instance()->paths().contains("/tmp"));
+}
+
 TEST(ut_DCapFileAndDir, testDCapFileOpen)
 {
     DCapFile file("/tmp/test0");
@@ -119,6 +144,46 @@ TEST(ut_DCapFileAndDir, testDCapFileOperation)
     DCapManager::instance()->appendPath("/tmp");
 }
 
+TEST(ut_DCapFileAndDir, testDCapPathComponents)
+{
+    DCapManager::instance()->removePath("/tmp");
+    DCapManager::instance()->appendPath(TMPCAP_PATH);
+    ASSERT_TRUE(QDir().mkpath(TMPCAP_PATH));
+
+    DCapFile file(TMPCAP_PATH "/test0");
+    EXPECT_TRUE(file.open(DCapFile::WriteOnly));
+    file.close();
+    EXPECT_TRUE(file.remove());
+
+    // the allowed path is matched by the components, not the prefix of the string
+    DCapFile sibling(TMPCAP_PATH "x");
+    EXPECT_FALSE(sibling.open(DCapFile::WriteOnly));
+    DCapFile parent(TMPCAP_PATH "/../test0");
+    EXPECT_FALSE(parent.open(DCapFile::WriteOnly));
+
+    // the parent directory is canonicalized, a link can't escape from the allowed path
+    ASSERT_TRUE(QDir().mkpath(TMPCAP_PATH "_outside"));
+    ASSERT_TRUE(QFile::link(TMPCAP_PATH "_outside", TMPCAP_PATH "/link"));
+    for (int i = 0; i < 2; ++i) {
+        DCapFile linked(TMPCAP_PATH "/link/test0");
+        EXPECT_FALSE(linked.open(DCapFile::WriteOnly));
+    }
+    EXPECT_TRUE(DCapFile::remove(TMPCAP_PATH "/link"));
+    EXPECT_TRUE(QDir(TMPCAP_PATH "_outside").removeRecursively());
+
+    // the cached canonical directories are dropped after the allowed paths are changed
+    ASSERT_TRUE(QDir().mkdir(TMPCAP_PATH "/link"));
+    DCapManager::instance()->appendPath(TMPCAP_PATH "_other");
+    {
+        DCapFile linked(TMPCAP_PATH "/link/test0");
+        EXPECT_TRUE(linked.open(DCapFile::WriteOnly));
+    }
+    DCapManager::instance()->removePath(TMPCAP_PATH "_other");
+
+    DCapManager::instance()->appendPath("/tmp");
+    EXPECT_TRUE(QDir(TMPCAP_PATH).removeRecursively());
+}
+
 TEST(ut_DCapFileAndDir, testDCapDirOperation)
 {
     DCapDir dir("/tmp");
@@ -157,3 +222,77 @@ TEST(ut_DCapFileAndDir, testDCapDirOperation)
     ASSERT_TRUE(dir.rename("test0", "test1"));
     ASSERT_TRUE(dir.remove("test1"));
 }
+
+TEST(ut_DCapFileAndDir, testDCapDirIterator)
+{
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+    QDir(tmpDir.path()).mkpath("allowed");
+    QDir(tmpDir.path()).mkpath("denied");
+    for (int i = 0; i < 3; ++i) {
+        QFile(tmpDir.filePath(QString("allowed/%1").arg(i))).open(QIODevice::WriteOnly);
+        QFile(tmpDir.filePath(QString("denied/%1").arg(i))).open(QIODevice::WriteOnly);
+    }
+
+    QStringList entries;
+    DCapDirIterator it(tmpDir.path(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        entries << it.next();
+        EXPECT_EQ(it.filePath(), entries.last());
+    }
+    EXPECT_EQ(entries.size(), 6);
+    EXPECT_TRUE(it.next().isEmpty());
+
+    // the entries of the denied directory are skipped
+    DCapManager::instance()->removePath("/tmp");
+    DCapManager::instance()->appendPath(tmpDir.filePath("allowed"));
+    entries.clear();
+    DCapDirIterator filtered(tmpDir.path(), QDir::Files, QDirIterator::Subdirectories);
+    while (filtered.hasNext())
+        entries << filtered.next();
+    DCapManager::instance()->removePath(tmpDir.filePath("allowed"));
+    DCapManager::instance()->appendPath("/tmp");
+
+    EXPECT_EQ(entries.size(), 3);
+    for (const QString &entry : entries)
+        EXPECT_TRUE(entry.startsWith(tmpDir.filePath("allowed/")));
+}
+
+TEST(ut_DCapFileAndDir, testDCapFileCopy)
+{
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+
+    // larger than a chunk of the buffered copy, and not aligned to the blocks
+    QByteArray data;
+    for (int i = 0; data.size() < 3 * 1024 * 1024 + 17; ++i)
+        data.append(QByteArray::number(i)).append('\n');
+
+    QFile source(tmpDir.filePath("source"));
+    ASSERT_TRUE(source.open(QIODevice::WriteOnly));
+    ASSERT_EQ(source.write(data), data.size());
+    source.close();
+    ASSERT_TRUE(source.setPermissions(QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup));
+
+    DCapFile file(source.fileName());
+    ASSERT_TRUE(file.copy(tmpDir.filePath("copy")));
+    QFile copy(tmpDir.filePath("copy"));
+    ASSERT_TRUE(copy.open(QIODevice::ReadOnly));
+    EXPECT_EQ(copy.readAll(), data);
+    EXPECT_EQ(copy.permissions(), source.permissions());
+
+    // the existing file isn't overwritten
+    EXPECT_FALSE(file.copy(tmpDir.filePath("copy")));
+    EXPECT_EQ(file.error(), QFile::CopyError);
+
+    QFile empty(tmpDir.filePath("empty"));
+    ASSERT_TRUE(empty.open(QIODevice::WriteOnly));
+    empty.close();
+    ASSERT_TRUE(DCapFile::copy(empty.fileName(), tmpDir.filePath("emptyCopy")));
+    EXPECT_EQ(QFileInfo(tmpDir.filePath("emptyCopy")).size(), 0);
+
+    DCapManager::instance()->removePath("/tmp");
+    EXPECT_FALSE(file.copy(tmpDir.filePath("denied")));
+    DCapManager::instance()->appendPath("/tmp");
+    EXPECT_FALSE(QFile::exists(tmpDir.filePath("denied")));
+}
@@ -4,10 +4,17 @@
 
 #include <DConfig>
 #include <QBuffer>
+#include <QCoreApplication>
 #include <QDir>
+#include <QSet>
+#include <QThread>
 #include <QDebug>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QTest>
 
 #include <gtest/gtest.h>
+#include <thread>
 #include "test_helper.hpp"
 #include "backend/dsettingsdconfigbackend.h"
 
@@ -62,6 +69,15 @@ TEST_F(ut_DConfig, isValid) {
     ASSERT_TRUE(config.isValid());
 }
 
+TEST_F(ut_DConfig, invalidMeta) {
+
+    // the meta doesn't exist, loading fails twice without locking up the shared files.
+    for (int i = 0; i < 2; ++i) {
+        DConfig config("not-exist-meta");
+        ASSERT_FALSE(config.isValid());
+    }
+}
+
 TEST_F(ut_DConfig, value) {
 
     FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
@@ -109,6 +125,95 @@ TEST_F(ut_DConfig, value) {
     }
 }
 
+TEST_F(ut_DConfig, setValues) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
+    DConfig config(FILE_NAME);
+    QStringList changedKeys;
+    QObject::connect(&config, &DConfig::valueChanged, [&changedKeys](const QString &key) {
+        changedKeys << key;
+    });
+
+    const QStringList array{"1", "2"};
+    config.setValues({{"key2", "126"}, {"array", array}});
+    ASSERT_EQ(config.value("key2").toString(), QString("126"));
+    ASSERT_EQ(config.value("array").toStringList(), array);
+    changedKeys.sort();
+    ASSERT_EQ(changedKeys, QStringList({"array", "key2"}));
+
+    // nothing is written if a value can't be converted.
+    changedKeys.clear();
+    config.setValues({{"key2", "127"}, {"canExit", "true2"}});
+    ASSERT_EQ(config.value("key2").toString(), QString("126"));
+    ASSERT_TRUE(changedKeys.isEmpty());
+}
+
+TEST_F(ut_DConfig, valueAsync) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
+    DConfig config(FILE_NAME);
+    auto setFuture = config.setValueAsync("key2", "128");
+    ASSERT_TRUE(setFuture.isFinished());
+
+    auto future = config.valueAsync("key2");
+    ASSERT_TRUE(future.isFinished());
+    ASSERT_EQ(future.result().toString(), QString("128"));
+}
+
+TEST_F(ut_DConfig, valueAsyncDBus) {
+
+    auto bus = QDBusConnection::systemBus().interface();
+    if (!bus || !bus->isServiceRegistered("org.desktopspec.ConfigManager"))
+        GTEST_SKIP() << "The config service isn't available";
+
+    EnvGuard dbusBackend;
+    dbusBackend.set("DSG_DCONFIG_BACKEND_TYPE", "DBusBackend", false);
+    QScopedPointer<DConfig> config(DConfig::createGeneric("org.deepin.dtk.preference"));
+
+    // the first call doesn't wait for the config manager, backendName() would acquire it.
+    auto future = config->valueAsync("themeType", -1);
+    ASSERT_FALSE(future.isFinished());
+    ASSERT_TRUE(QTest::qWaitFor([&future] { return future.isFinished(); }, 5000));
+    ASSERT_FALSE(future.isCanceled());
+    ASSERT_EQ(config->backendName(), QString("DBusBackend"));
+    ASSERT_EQ(future.result(), config->value("themeType", -1));
+}
+
+TEST_F(ut_DConfig, values) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
+    DConfig config(FILE_NAME);
+    const auto &all = config.values();
+    ASSERT_EQ(all.keys().size(), config.keyList().size());
+    ASSERT_EQ(all.value("key2").toString(), QString("125"));
+
+    const auto &part = config.values({"key2"});
+    ASSERT_EQ(part.keys(), QStringList{"key2"});
+}
+
+TEST_F(ut_DConfig, snapshot) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
+    DConfig config(FILE_NAME);
+    ASSERT_FALSE(config.isSnapshotEnabled());
+    ASSERT_EQ(config.snapshotValue("key2", "fallback").toString(), QString("fallback"));
+
+    config.setSnapshotEnabled(true);
+    ASSERT_TRUE(config.isSnapshotEnabled());
+    ASSERT_EQ(config.snapshotValue("key2").toString(), QString("125"));
+
+    config.setValue("key2", "126");
+    QString valueInThread;
+    std::thread reader([&config, &valueInThread] {
+        valueInThread = config.snapshotValue("key2").toString();
+    });
+    reader.join();
+    ASSERT_EQ(valueInThread, QString("126"));
+
+    config.setSnapshotEnabled(false);
+    ASSERT_TRUE(config.snapshot().isEmpty());
+}
+
 TEST_F(ut_DConfig, keyList) {
 
     FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
@@ -177,6 +282,85 @@ TEST_F(ut_DConfig, noAppidWirteConfig) {
     }
 }
 
+TEST_F(ut_DConfig, sharedConfigFile) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
+    QScopedPointer<DConfig> config(DConfig::create(APP_ID, FILE_NAME));
+    QScopedPointer<DConfig> config2(DConfig::create(APP_ID, FILE_NAME));
+    ASSERT_TRUE(config->isValid());
+    ASSERT_TRUE(config2->isValid());
+
+    QStringList changedKeys;
+    QObject::connect(config2.data(), &DConfig::valueChanged, config2.data(), [&changedKeys](const QString &key) {
+        changedKeys << key;
+    });
+
+    // the configurations share the parsed meta and the user cache.
+    config->setValue("key2", "shared");
+    ASSERT_EQ(config2->value("key2").toString(), QString("shared"));
+
+    // the other configuration is notified in the event loop.
+    ASSERT_TRUE(changedKeys.isEmpty());
+    QCoreApplication::processEvents();
+    ASSERT_EQ(changedKeys, QStringList{"key2"});
+}
+
+TEST_F(ut_DConfig, subscribe) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
+    DConfig config(FILE_NAME);
+    ASSERT_TRUE(config.isValid());
+
+    QList<QStringList> keyBatches, prefixBatches;
+    const int keyId = config.subscribeKeys({"key2", "key3"}, nullptr, [&keyBatches](const QStringList &keys) {
+        keyBatches << keys;
+    });
+    {
+        QObject context;
+        config.subscribePrefix("number", &context, [&prefixBatches](const QStringList &keys) {
+            prefixBatches << keys;
+        });
+
+        config.setValue("key2", "1");
+        config.setValue("key3", "2");
+        config.setValue("key2", "3");
+        config.setValue("number", 1);
+        config.setValue("numberDouble", 1.5);
+        config.setValue("canExit", false);
+
+        // the changes are coalesced until the event loop runs.
+        ASSERT_TRUE(keyBatches.isEmpty());
+        QCoreApplication::processEvents();
+        ASSERT_EQ(keyBatches, QList<QStringList>{QStringList({"key2", "key3"})});
+        ASSERT_EQ(prefixBatches, QList<QStringList>{QStringList({"number", "numberDouble"})});
+    }
+    // the subscription is removed after the context is destroyed.
+    config.setValue("number", 2);
+    config.unsubscribe(keyId);
+    config.setValue("key2", "4");
+    QCoreApplication::processEvents();
+    ASSERT_EQ(keyBatches.size(), 1);
+    ASSERT_EQ(prefixBatches.size(), 1);
+}
+
+TEST_F(ut_DConfig, sharedGenericFallback) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", noAppIdMetaFilePath);
+    FileCopyGuard guard2(":/data/dconf-example.meta.json", metaFilePath);
+    {
+        QScopedPointer<DConfig> config(DConfig::createGeneric(FILE_NAME));
+        config->setValue("key2", "user-with-no-appid");
+    }
+    {
+        // the generic configuration is loaded once and shared by the configurations.
+        QScopedPointer<DConfig> config(DConfig::create(APP_ID, FILE_NAME));
+        QScopedPointer<DConfig> config2(DConfig::create(APP_ID, FILE_NAME));
+        ASSERT_EQ(config->value("key2"), "user-with-no-appid");
+        ASSERT_EQ(config2->value("key2"), "user-with-no-appid");
+        ASSERT_EQ(config->value("canExit"), config2->value("canExit"));
+    }
+}
+
 TEST_F(ut_DConfig, DSettingsDConfigBackend)
 {
     FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
@@ -237,3 +421,67 @@ TEST_F(ut_DConfig, isReadOnly) {
         EXPECT_EQ(config.isReadOnly("readonly"), true);
     }
 }
+
+TEST_F(ut_DConfig, workerThread) {
+
+    EXPECT_EQ(DConfig::workerThreadCount(), 1);
+    EXPECT_EQ(DConfig::workerThread(), DConfig::globalThread());
+
+    DConfig::setWorkerThreadCount(3);
+    EXPECT_EQ(DConfig::workerThreadCount(), 3);
+    QSet<QThread *> threads;
+    for (int i = 0; i < 6; ++i) {
+        QThread *thread = DConfig::workerThread();
+        EXPECT_TRUE(thread->isRunning());
+        threads << thread;
+    }
+    // handed out in turn, the first one is the global thread
+    EXPECT_EQ(threads.size(), 3);
+    EXPECT_TRUE(threads.contains(DConfig::globalThread()));
+
+    DConfig::setWorkerThreadCount(1);
+    EXPECT_EQ(DConfig::workerThread(), DConfig::globalThread());
+}
+
+TEST_F(ut_DConfig, statistics) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", metaFilePath);
+    auto find = [](const QString &name) {
+        for (const auto &item : DConfig::statistics()) {
+            if (item.value("name").toString() == name)
+                return item;
+        }
+        return QVariantMap();
+    };
+    {
+        // the calls aren't counted by default.
+        DConfig config(FILE_NAME);
+        config.value("canExit");
+        config.setValue("key2", "statistics");
+        const QVariantMap stats = find(FILE_NAME);
+        EXPECT_EQ(stats.value("reads").toULongLong(), 0u);
+        EXPECT_EQ(stats.value("writes").toULongLong(), 0u);
+        config.reset("key2");
+    }
+    {
+        EnvGuard statistics;
+        statistics.set("DSG_DCONFIG_STATISTICS", "1", false);
+        DConfig config(FILE_NAME);
+        ASSERT_TRUE(config.isValid());
+        config.value("canExit");
+        config.value("key2");
+        config.setValue("key2", "statistics");
+
+        const QVariantMap stats = find(FILE_NAME);
+        ASSERT_FALSE(stats.isEmpty());
+        EXPECT_EQ(stats.value("backend").toString(), QString("FileBackend"));
+        EXPECT_EQ(stats.value("reads").toULongLong(), 2u);
+        EXPECT_EQ(stats.value("writes").toULongLong(), 1u);
+        EXPECT_EQ(stats.value("keyCount").toInt(), config.keyList().size());
+        EXPECT_GT(stats.value("metaBytes").toLongLong(), 0);
+        EXPECT_GT(stats.value("cacheBytes").toLongLong(), 0);
+        EXPECT_GE(stats.value("loadMsecs").toDouble(), 0.0);
+        config.reset("key2");
+    }
+    EXPECT_TRUE(find(FILE_NAME).isEmpty());
+}
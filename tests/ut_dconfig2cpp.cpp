@@ -54,7 +54,7 @@ protected:
         int exitCode;
     };
 
-    GenerationResult generateCode(const QString& jsonFilePath) {
+    GenerationResult generateCode(const QString& jsonFilePath, const QStringList &options = {}) {
         GenerationResult result;
         result.success = false;
         result.exitCode = -1;
@@ -97,7 +97,7 @@ protected:
         result.generatedFilePath = tempDir->path() + "/" + baseName + ".hpp";
 
         QStringList arguments;
-        arguments << "-o" << result.generatedFilePath << actualJsonPath;
+        arguments << options << "-o" << result.generatedFilePath << actualJsonPath;
 
         process.start(toolPath, arguments);
 
@@ -250,3 +250,140 @@ TEST_F(ut_dconfig2cpp, ComplexTypesGeneration) {
             << "Expected property not found: " << expectedProperty.toStdString();
     }
 }
+
+TEST_F(ut_dconfig2cpp, KeySchemaGeneration) {
+    QString testFile = ":/data/dconfig2cpp/basic-types.meta.json";
+    if (!QFile::exists(testFile)) {
+        testFile = "./data/dconfig2cpp/basic-types.meta.json";
+    }
+
+    ASSERT_TRUE(QFile::exists(testFile));
+
+    auto result = generateCode(testFile);
+    ASSERT_TRUE(result.success) << result.errorMessage.toStdString();
+
+    QFile generatedFile(result.generatedFilePath);
+    ASSERT_TRUE(generatedFile.open(QIODevice::ReadOnly | QIODevice::Text));
+    QString generatedContent = generatedFile.readAll();
+    generatedFile.close();
+
+    QStringList expectedCode = {
+        "enum class Key : int {",
+        "booleanTrue = 0,",
+        "static constexpr int KeyCount = 10;",
+        "static constexpr KeySchema schema(Key key) {",
+        "return { \"booleanTrue\", QMetaType::Bool, true, false, false };",
+        "return { \"stringValue\", QMetaType::QString, true, false, false };",
+        "return { \"doubleValue\", QMetaType::Double, true, false, false };",
+        "static int keyIndex(const QString &key) {",
+        "case Key::integerPositive: {"
+    };
+
+    for (const QString &expected : expectedCode) {
+        EXPECT_TRUE(generatedContent.contains(expected))
+            << "Expected code not found: " << expected.toStdString();
+    }
+    // Dispatching doesn't compare the key with each property anymore.
+    EXPECT_FALSE(generatedContent.contains("if (key == QStringLiteral(\"booleanTrue\")) {"));
+}
+
+TEST_F(ut_dconfig2cpp, KeySchemaDefaultPermissions) {
+    // a key without permissions is readonly, as DConfigFile reads it
+    const QString testFile = tempDir->filePath("default-permissions.meta.json");
+    QFile metaFile(testFile);
+    ASSERT_TRUE(metaFile.open(QIODevice::WriteOnly | QIODevice::Text));
+    metaFile.write(R"({
+  "magic": "dsg.config.meta",
+  "version": "1.0",
+  "contents": {
+    "implicitKey": { "value": 1, "serial": 0, "flags": [], "name": "implicit", "visibility": "public" },
+    "writableKey": { "value": 1, "serial": 0, "flags": [], "name": "writable", "permissions": "readwrite", "visibility": "public" }
+  }
+})");
+    metaFile.close();
+
+    auto result = generateCode(testFile);
+    ASSERT_TRUE(result.success) << result.errorMessage.toStdString();
+
+    QFile generatedFile(result.generatedFilePath);
+    ASSERT_TRUE(generatedFile.open(QIODevice::ReadOnly | QIODevice::Text));
+    const QString generatedContent = generatedFile.readAll();
+
+    EXPECT_TRUE(generatedContent.contains("return { \"implicitKey\", QMetaType::LongLong, false, false, true };"));
+    EXPECT_TRUE(generatedContent.contains("return { \"writableKey\", QMetaType::LongLong, false, false, false };"));
+}
+
+TEST_F(ut_dconfig2cpp, BatchedInitialization) {
+    QString testFile = ":/data/dconfig2cpp/complex-types.meta.json";
+    if (!QFile::exists(testFile)) {
+        testFile = "./data/dconfig2cpp/complex-types.meta.json";
+    }
+
+    ASSERT_TRUE(QFile::exists(testFile));
+
+    auto result = generateCode(testFile);
+    ASSERT_TRUE(result.success) << result.errorMessage.toStdString();
+
+    QFile generatedFile(result.generatedFilePath);
+    ASSERT_TRUE(generatedFile.open(QIODevice::ReadOnly | QIODevice::Text));
+    QString generatedContent = generatedFile.readAll();
+    generatedFile.close();
+
+    // The initial values are read in one call instead of one call per property.
+    EXPECT_TRUE(generatedContent.contains("updateValues(config->values(keys));"));
+    EXPECT_TRUE(generatedContent.contains("keys << QStringLiteral(\"emptyArray\");"));
+    EXPECT_FALSE(generatedContent.contains("updateValue(QStringLiteral(\"emptyArray\")"));
+}
+
+TEST_F(ut_dconfig2cpp, CoalescingSetters) {
+    QString testFile = ":/data/dconfig2cpp/basic-types.meta.json";
+    if (!QFile::exists(testFile)) {
+        testFile = "./data/dconfig2cpp/basic-types.meta.json";
+    }
+
+    ASSERT_TRUE(QFile::exists(testFile));
+
+    auto result = generateCode(testFile, {"--coalesce-interval", "50"});
+    ASSERT_TRUE(result.success) << result.errorMessage.toStdString();
+
+    QFile generatedFile(result.generatedFilePath);
+    ASSERT_TRUE(generatedFile.open(QIODevice::ReadOnly | QIODevice::Text));
+    QString generatedContent = generatedFile.readAll();
+    generatedFile.close();
+
+    EXPECT_TRUE(generatedContent.contains("m_data->queueValue(QStringLiteral(\"stringValue\"), QVariant::fromValue(value));"));
+    EXPECT_TRUE(generatedContent.contains("QTimer::singleShot(50, this"));
+    EXPECT_TRUE(generatedContent.contains("config->setValues(values);"));
+    EXPECT_FALSE(generatedContent.contains("config->setValue(QStringLiteral(\"stringValue\"), value);"));
+
+    auto invalid = generateCode(testFile, {"--coalesce-interval", "-1"});
+    EXPECT_FALSE(invalid.success);
+}
+
+TEST_F(ut_dconfig2cpp, DirectMode) {
+    QString testFile = ":/data/dconfig2cpp/basic-types.meta.json";
+    if (!QFile::exists(testFile)) {
+        testFile = "./data/dconfig2cpp/basic-types.meta.json";
+    }
+
+    ASSERT_TRUE(QFile::exists(testFile));
+
+    auto result = generateCode(testFile, {"--direct"});
+    ASSERT_TRUE(result.success) << result.errorMessage.toStdString();
+
+    QFile generatedFile(result.generatedFilePath);
+    ASSERT_TRUE(generatedFile.open(QIODevice::ReadOnly | QIODevice::Text));
+    QString generatedContent = generatedFile.readAll();
+    generatedFile.close();
+
+    // The DConfig is created and written in the thread of the generated object.
+    EXPECT_TRUE(generatedContent.contains("m_data->initialize(config);"));
+    EXPECT_TRUE(generatedContent.contains("config->setValue(QStringLiteral(\"stringValue\"), value);"));
+    EXPECT_TRUE(generatedContent.contains("DTK_CORE_NAMESPACE::DConfig *m_config = nullptr;"));
+    EXPECT_FALSE(generatedContent.contains("QThread *thread"));
+    EXPECT_FALSE(generatedContent.contains("QMetaObject::invokeMethod(config"));
+    EXPECT_FALSE(generatedContent.contains("QAtomicPointer"));
+
+    auto invalid = generateCode(testFile, {"--direct", "--force-request-thread"});
+    EXPECT_FALSE(invalid.success);
+}
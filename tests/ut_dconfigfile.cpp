@@ -6,6 +6,10 @@
 #include <DStandardPaths>
 #include <QBuffer>
 #include <QDir>
+#include <QJsonObject>
+
+#include <atomic>
+#include <thread>
 
 #include <gtest/gtest.h>
 #include "test_helper.hpp"
@@ -96,6 +100,52 @@ TEST_F(ut_DConfigFile, testLoad) {
     ASSERT_EQ(config.meta()->permissions("canExit"), DConfigFile::ReadWrite);
 }
 
+TEST_F(ut_DConfigFile, localizedOnDemand) {
+    const QByteArray meta = R"delimiter(
+{
+    "magic": "dsg.config.meta",
+    "version": "1.0",
+    "contents": {
+        "canExit": {
+            "value": false,
+            "name": "I am name",
+            "name[zh_CN]": "我是名字",
+            "name[de_DE]": "Ich bin der Name",
+            "description": "I am description",
+            "description[de_DE]": "Ich bin die Beschreibung",
+            "permissions": "readwrite",
+            "visibility": "private"
+        }
+    }
+}
+        )delimiter";
+
+    FileGuard guard(QString("%1/%2.json").arg(metaPath, FILE_NAME));
+    QDir().mkpath(metaPath);
+    {
+        QFile file(guard.fileName());
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(meta);
+    }
+
+    EnvGuard snapshot;
+    snapshot.set("DSG_DCONFIG_META_SNAPSHOT", "1", false);
+    const QLocale defaultLocale;
+    QLocale::setDefault(QLocale("zh_CN"));
+    // loaded from json, then restored from the snapshot
+    for (int i = 0; i < 2; ++i) {
+        DConfigFile config(APP_ID, FILE_NAME);
+        ASSERT_TRUE(config.load(LocalPrefix));
+        EXPECT_EQ(config.meta()->displayName("canExit", QLocale::AnyLanguage), "I am name");
+        EXPECT_EQ(config.meta()->displayName("canExit", QLocale("zh_CN")), QString("我是名字"));
+        // the other locales are read from the meta file when asked
+        EXPECT_EQ(config.meta()->displayName("canExit", QLocale("de_DE")), "Ich bin der Name");
+        EXPECT_EQ(config.meta()->description("canExit", QLocale("de_DE")), "Ich bin die Beschreibung");
+        EXPECT_EQ(config.meta()->description("canExit", QLocale("fr_FR")), QString());
+    }
+    QLocale::setDefault(defaultLocale);
+}
+
 TEST_F(ut_DConfigFile, setValueTypeCheck) {
 
     FileCopyGuard guard(":/data/dconf-example.meta.json", QString("%1/%2.json").arg(metaPath, FILE_NAME));
@@ -315,6 +365,79 @@ TEST_F(ut_DConfigFile, fileOverride) {
     }
 }
 
+TEST_F(ut_DConfigFile, metaSnapshot) {
+
+    EnvGuard snapshot;
+    snapshot.set("DSG_DCONFIG_META_SNAPSHOT", "1", false);
+    FileCopyGuard guard(":/data/dconf-example.meta.json", QString("%1/%2.json").arg(metaPath, FILE_NAME));
+    {
+        FileCopyGuard guard1(":/data/dconf-example.override.json", QString("%1/%2.json").arg(overridePath, FILE_NAME));
+        for (int i = 0; i < 2; i++) {
+            // the second loading is restored from the snapshot.
+            DConfigFile config(APP_ID, FILE_NAME);
+            ASSERT_TRUE(config.load(LocalPrefix));
+            ASSERT_EQ(config.value("key3"), QString("override"));
+            ASSERT_EQ(config.meta()->permissions("canExit"), DConfigFile::ReadWrite);
+        }
+    }
+    {
+        // the snapshot is invalid after the override file is removed.
+        DConfigFile config(APP_ID, FILE_NAME);
+        ASSERT_TRUE(config.load(LocalPrefix));
+        ASSERT_EQ(config.value("key3"), QString("application"));
+    }
+}
+
+TEST_F(ut_DConfigFile, reloadOverrides) {
+
+    EnvGuard watchOverrides;
+    watchOverrides.set("DSG_DCONFIG_WATCH_OVERRIDES", "1", false);
+    FileCopyGuard guard(":/data/dconf-example.meta.json", QString("%1/%2.json").arg(metaPath, FILE_NAME));
+    DConfigFile config(APP_ID, FILE_NAME);
+    ASSERT_TRUE(config.load(LocalPrefix));
+    ASSERT_EQ(config.value("key3"), QString("application"));
+    {
+        FileCopyGuard guard1(":/data/dconf-example.override.json", QString("%1/%2.json").arg(overridePath, FILE_NAME));
+        QStringList changedKeys;
+        ASSERT_TRUE(config.reloadOverrides(LocalPrefix, &changedKeys));
+        ASSERT_EQ(changedKeys, QStringList{"key3"});
+        ASSERT_EQ(config.value("key3"), QString("override"));
+
+        // nothing changed.
+        changedKeys.clear();
+        ASSERT_TRUE(config.reloadOverrides(LocalPrefix, &changedKeys));
+        ASSERT_TRUE(changedKeys.isEmpty());
+        ASSERT_EQ(config.value("key3"), QString("override"));
+    }
+    QStringList changedKeys;
+    ASSERT_TRUE(config.reloadOverrides(LocalPrefix, &changedKeys));
+    ASSERT_EQ(changedKeys, QStringList{"key3"});
+    ASSERT_EQ(config.value("key3"), QString("application"));
+}
+
+TEST_F(ut_DConfigFile, metaPathCache) {
+
+    EnvGuard dirCache;
+    dirCache.set("DSG_DCONFIG_DIR_CACHE", "1", false);
+    {
+        // the missing directories are cached.
+        DConfigFile config(APP_ID, FILE_NAME);
+        ASSERT_TRUE(config.meta()->metaPath(LocalPrefix).isEmpty());
+        ASSERT_FALSE(config.load(LocalPrefix));
+    }
+    {
+        // the cache is invalidated after the meta file is created.
+        FileCopyGuard guard(":/data/dconf-example.meta.json", QString("%1/%2.json").arg(metaPath, FILE_NAME));
+        DConfigFile config(APP_ID, FILE_NAME);
+        ASSERT_EQ(config.meta()->metaPath(LocalPrefix), QString("%1/%2.json").arg(metaPath, FILE_NAME));
+        ASSERT_TRUE(config.load(LocalPrefix));
+    }
+    {
+        DConfigFile config(APP_ID, FILE_NAME);
+        ASSERT_TRUE(config.meta()->metaPath(LocalPrefix).isEmpty());
+    }
+}
+
 TEST_F(ut_DConfigFile, fileOverrideNoExistItem) {
 
     FileCopyGuard guard(":/data/dconf-example.meta.json", QString("%1/%2.json").arg(metaPath, FILE_NAME));
@@ -466,6 +589,106 @@ TEST_F(ut_DConfigFile, setCachePathPrefix) {
     }
 }
 
+TEST_F(ut_DConfigFile, saveDelay) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", QString("%1/%2.json").arg(metaPath, FILE_NAME));
+    const QString cacheFile = QString("%1/configs-user/%2/%3.json").arg(LocalPrefix, APP_ID, FILE_NAME);
+    {
+        DConfigFile config(APP_ID, FILE_NAME);
+        ASSERT_TRUE(config.load(LocalPrefix));
+        QScopedPointer<DConfigCache> userCache(config.createUserCache(uid));
+        userCache->setCachePathPrefix("/configs-user");
+        userCache->setSaveDelay(1000);
+        ASSERT_TRUE(userCache->load(LocalPrefix));
+
+        config.setValue("key2", QString("user-config"), "test", userCache.get());
+        ASSERT_TRUE(userCache->save(LocalPrefix));
+        ASSERT_FALSE(QFile::exists(cacheFile));
+
+        config.setValue("key2", QString("user-config2"), "test", userCache.get());
+        ASSERT_TRUE(userCache->save(LocalPrefix));
+        ASSERT_FALSE(QFile::exists(cacheFile));
+    }
+    // the pending modifications are written when the cache is destroyed.
+    ASSERT_TRUE(QFile::exists(cacheFile));
+    {
+        DConfigFile config(APP_ID, FILE_NAME);
+        ASSERT_TRUE(config.load(LocalPrefix));
+        QScopedPointer<DConfigCache> userCache(config.createUserCache(uid));
+        userCache->setCachePathPrefix("/configs-user");
+        ASSERT_TRUE(userCache->load(LocalPrefix));
+        ASSERT_EQ(config.value("key2", userCache.get()), QString("user-config2"));
+    }
+}
+
+TEST_F(ut_DConfigFile, saveDurability) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", QString("%1/%2.json").arg(metaPath, FILE_NAME));
+    const QString cacheFile = QString("%1/configs-user/%2/%3.json").arg(LocalPrefix, APP_ID, FILE_NAME);
+    const DConfigFile::Durability levels[] = {DConfigFile::NoSync, DConfigFile::DataSync, DConfigFile::FullSync};
+    for (const auto level : levels) {
+        const QString value = QString("durability-%1").arg(level);
+        {
+            DConfigFile config(APP_ID, FILE_NAME);
+            ASSERT_TRUE(config.load(LocalPrefix));
+            QScopedPointer<DConfigCache> userCache(config.createUserCache(uid));
+            userCache->setCachePathPrefix("/configs-user");
+            userCache->setDurability(level);
+            ASSERT_TRUE(userCache->load(LocalPrefix));
+
+            config.setValue("key2", value, "test", userCache.get());
+            ASSERT_TRUE(userCache->save(LocalPrefix, QJsonDocument::Indented, true));
+        }
+
+        // the file is replaced, no temporary file is left
+        ASSERT_EQ(QDir(QFileInfo(cacheFile).path()).entryList(QDir::Files), QStringList{QFileInfo(cacheFile).fileName()});
+
+        DConfigFile config(APP_ID, FILE_NAME);
+        ASSERT_TRUE(config.load(LocalPrefix));
+        QScopedPointer<DConfigCache> userCache(config.createUserCache(uid));
+        userCache->setCachePathPrefix("/configs-user");
+        ASSERT_TRUE(userCache->load(LocalPrefix));
+        ASSERT_EQ(config.value("key2", userCache.get()), value);
+    }
+}
+
+TEST_F(ut_DConfigFile, saveFormat) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", QString("%1/%2.json").arg(metaPath, FILE_NAME));
+    const QString cacheFile = QString("%1/configs-user/%2/%3.json").arg(LocalPrefix, APP_ID, FILE_NAME);
+    for (auto format : {QJsonDocument::Indented, QJsonDocument::Compact}) {
+        {
+            DConfigFile config(APP_ID, FILE_NAME);
+            ASSERT_TRUE(config.load(LocalPrefix));
+            QScopedPointer<DConfigCache> userCache(config.createUserCache(uid));
+            userCache->setCachePathPrefix("/configs-user");
+            ASSERT_TRUE(userCache->load(LocalPrefix));
+
+            config.setValue("key2", QString("user \"config\"\n"), "test", userCache.get());
+            config.setValue("readwrite", true, "test", userCache.get());
+            ASSERT_TRUE(userCache->save(LocalPrefix, format, true));
+        }
+
+        QFile file(cacheFile);
+        ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+        const QJsonDocument &doc = QJsonDocument::fromJson(file.readAll());
+        ASSERT_TRUE(doc.isObject());
+        ASSERT_EQ(doc.object()["magic"].toString(), QString("dsg.config.cache"));
+        const QJsonObject &contents = doc.object()["contents"].toObject();
+        ASSERT_EQ(contents.size(), 2);
+        ASSERT_EQ(contents["key2"].toObject()["value"].toString(), QString("user \"config\"\n"));
+        ASSERT_EQ(contents["readwrite"].toObject()["value"].toBool(), true);
+
+        DConfigFile config(APP_ID, FILE_NAME);
+        ASSERT_TRUE(config.load(LocalPrefix));
+        QScopedPointer<DConfigCache> userCache(config.createUserCache(uid));
+        userCache->setCachePathPrefix("/configs-user");
+        ASSERT_TRUE(userCache->load(LocalPrefix));
+        ASSERT_EQ(config.value("key2", userCache.get()), QString("user \"config\"\n"));
+        QFile::remove(cacheFile);
+    }
+}
+
 TEST_F(ut_DConfigFile, setSubpath) {
 
     FileCopyGuard guard(":/data/dconf-example.meta.json", QString("%1/%2.json").arg(metaPath, FILE_NAME));
@@ -506,6 +729,90 @@ TEST_F(ut_DConfigFile, userPublic) {
     }
 }
 
+TEST_F(ut_DConfigFile, prefetch) {
+
+    FileCopyGuard guard(":/data/dconf-example.meta.json", QString("%1/%2.json").arg(metaPath, FILE_NAME));
+    const QString prefetchDir = QString("%1/prefetch").arg(metaGlobalPath);
+    ASSERT_TRUE(QDir().mkpath(prefetchDir));
+    QFile list(prefetchDir + "/session.json");
+    ASSERT_TRUE(list.open(QIODevice::WriteOnly));
+    list.write(QString(R"delimiter(
+{
+    "magic": "dsg.config.prefetch",
+    "version": "1.0",
+    "contents": [
+        { "appid": "%1", "name": "%2" },
+        { "appid": "%1", "name": "%2", "subpath": "" },
+        { "name": "org.foo.missing" },
+        { "appid": "%1" }
+    ]
+}
+        )delimiter").arg(APP_ID, FILE_NAME).toUtf8());
+    list.close();
+
+    const auto &entries = DConfigFile::prefetchEntries(LocalPrefix);
+    ASSERT_EQ(entries.size(), 2);
+    ASSERT_EQ(entries.first().appId, QString(APP_ID));
+    ASSERT_EQ(entries.first().name, QString(FILE_NAME));
+    ASSERT_TRUE(entries.last().appId.isEmpty());
+    ASSERT_EQ(DConfigFile::prefetch(entries, LocalPrefix), 1);
+}
+
+TEST_F(ut_DConfigFile, sharedImage) {
+
+    EnvGuard sharedImage;
+    sharedImage.set("DSG_DCONFIG_SHARED_GLOBAL_CACHE", "1", false);
+    FileCopyGuard guard(":/data/dconf-example.meta.json", QString("%1/%2.json").arg(metaPath, FILE_NAME));
+
+    // every value carries the size and the checksum of its payload, the payloads have different
+    // sizes, so a torn image is detected by the readers.
+    auto makeValue = [](int i) {
+        const QByteArray &payload = QByteArray::number(i).repeated(1 + (i % 37) * 64);
+        return QString("value:%1:%2:%3").arg(payload.size()).arg(quint64(qHash(payload))).arg(QString::fromLatin1(payload));
+    };
+    auto isValidValue = [](const QString &value) {
+        const QStringList &parts = value.split(':');
+        if (parts.size() != 4 || parts.at(0) != "value")
+            return false;
+        const QByteArray &payload = parts.at(3).toLatin1();
+        return parts.at(1).toInt() == payload.size() && parts.at(2).toULongLong() == quint64(qHash(payload));
+    };
+
+    DConfigFile writer(APP_ID, FILE_NAME);
+    ASSERT_TRUE(writer.load(LocalPrefix));
+    ASSERT_TRUE(writer.globalCache()->setValue("key3", makeValue(0), 0, uid, APP_ID));
+    ASSERT_TRUE(writer.save(LocalPrefix, QJsonDocument::Indented, true));
+
+    // loaded from the image published by the writer.
+    DConfigFile reader(APP_ID, FILE_NAME);
+    ASSERT_TRUE(reader.load(LocalPrefix));
+    ASSERT_EQ(reader.globalCache()->value("key3"), makeValue(0));
+
+    constexpr int Count = 500;
+    std::atomic_bool finished(false), torn(false);
+    std::atomic_int reads(0);
+    auto read = [&] {
+        while (!finished) {
+            if (!isValidValue(reader.globalCache()->value("key3").toString()))
+                torn = true;
+            ++reads;
+        }
+    };
+    std::thread reader1(read), reader2(read);
+    for (int i = 1; i <= Count; ++i) {
+        writer.globalCache()->setValue("key3", makeValue(i), 0, uid, APP_ID);
+        writer.save(LocalPrefix, QJsonDocument::Indented, true);
+    }
+    finished = true;
+    reader1.join();
+    reader2.join();
+
+    ASSERT_FALSE(torn);
+    ASSERT_GT(reads.load(), 0);
+    // the reader is still attached to the image after the updates.
+    ASSERT_EQ(reader.globalCache()->value("key3"), makeValue(Count));
+}
+
 class ut_DConfigFileCheckName : public ut_DConfigFile, public ::testing::WithParamInterface<std::tuple<QString, bool>>
 {
 
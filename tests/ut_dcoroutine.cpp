@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "dcoroutine.h"
+
+// the tests are built only when the test target is compiled as C++20
+#ifdef DTK_CORE_HAS_COROUTINE
+
+DCORE_USE_NAMESPACE
+
+static DCoroutine<int> square(int value)
+{
+    co_await DThreadPool::global();
+    const int result = co_await DThreadPool::global().run([value] { return value * value; });
+    co_return result;
+}
+
+TEST(ut_DCoroutine, future)
+{
+    QFuture<int> result = square(7);
+    EXPECT_EQ(result.result(), 49);
+}
+
+static DCoroutine<> fail()
+{
+    co_await DThreadPool::global().run([] { throw std::runtime_error("failed"); });
+}
+
+TEST(ut_DCoroutine, exception)
+{
+    QFuture<void> result = fail();
+    EXPECT_THROW(result.waitForFinished(), std::runtime_error);
+}
+
+#endif
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "ddbuscalltrace.h"
+#include "ddbussender.h"
+
+#include <QtDBus>
+#include <QElapsedTimer>
+
+#include "fakedbus/fakedbusservice.h"
+
+DCORE_USE_NAMESPACE
+
+class ut_DDBusCallTrace : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        m_testservice = new FakeDBusService();
+        DDBusCallTrace::reset();
+        DDBusCallTrace::setEnabled(true);
+    }
+    void TearDown() override
+    {
+        DDBusCallTrace::setEnabled(false);
+        DDBusCallTrace::reset();
+        delete m_testservice;
+    }
+
+    FakeDBusService *m_testservice = nullptr;
+};
+
+TEST_F(ut_DDBusCallTrace, summary)
+{
+    ASSERT_TRUE(DDBusCallTrace::isEnabled());
+
+    QDBusPendingReply<QString> reply = DDBusSender().service(m_testservice->get_service())
+            .path(m_testservice->get_path())
+            .interface(m_testservice->get_interface())
+            .method(QString("foo"))
+            .call();
+    reply.waitForFinished();
+
+    // the asynchronous call is recorded when its reply is delivered.
+    const QString method = m_testservice->get_interface() + QLatin1String(".foo");
+    QElapsedTimer timer;
+    timer.start();
+    while (!DDBusCallTrace::summary().contains(method) && timer.elapsed() < 1000)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 50);
+
+    const QString &summary = DDBusCallTrace::summary();
+    EXPECT_TRUE(summary.contains(method)) << summary.toStdString();
+    EXPECT_TRUE(summary.contains("1 calls (0 blocking)")) << summary.toStdString();
+
+    DDBusCallTrace::reset();
+    EXPECT_FALSE(DDBusCallTrace::summary().contains(method));
+}
+
+TEST_F(ut_DDBusCallTrace, blockingThreshold)
+{
+    const int threshold = DDBusCallTrace::blockingThreshold();
+    DDBusCallTrace::setBlockingThreshold(10);
+    EXPECT_EQ(DDBusCallTrace::blockingThreshold(), 10);
+    DDBusCallTrace::setBlockingThreshold(threshold);
+}
@@ -154,4 +154,40 @@ TEST_F(ut_DDBusExtendedAbstractInterface, internalPropSet)
     }, 2000));
 }
 
+TEST_F(ut_DDBusExtendedAbstractInterface, prefetch)
+{
+    QSignalSpy asyncGetAllSpy(m_dbusExtend,  &DDBusExtendedAbstractInterface::asyncGetAllPropertiesFinished);
+    QSignalSpy asyncPropertyFinishedSpy(m_dbusExtend,  &DDBusExtendedAbstractInterface::asyncPropertyFinished);
+    m_dbusExtend->setSync(false);
+    m_dbusExtend->setPrefetch(true);
+    EXPECT_TRUE(m_dbusExtend->prefetch());
+
+    EXPECT_TRUE(QTest::qWaitFor([&]() {
+        return asyncGetAllSpy.count() >= 1;
+    }, 2000));
+    QCoreApplication::processEvents();
+
+    // the fetched value is returned without another Get
+    EXPECT_EQ(m_dbusExtend->strProperty(), m_fakeService->strproperty());
+    QTest::qWait(100);
+    EXPECT_EQ(asyncPropertyFinishedSpy.count(), 0);
+}
+
+TEST_F(ut_DDBusExtendedAbstractInterface, coalescedPropGet)
+{
+    QSignalSpy asyncPropertyFinishedSpy(m_dbusExtend,  &DDBusExtendedAbstractInterface::asyncPropertyFinished);
+    m_dbusExtend->setSync(false);
+
+    // the reads asked while the Get is on the way share its reply
+    for (int i = 0; i < 10; ++i)
+        m_dbusExtend->strProperty();
+
+    EXPECT_TRUE(QTest::qWaitFor([&]() {
+        return asyncPropertyFinishedSpy.count() >= 1;
+    }, 2000));
+    QTest::qWait(100);
+    EXPECT_EQ(asyncPropertyFinishedSpy.count(), 1);
+    EXPECT_EQ(m_dbusExtend->findChildren<QDBusPendingCallWatcher *>().size(), 0);
+}
+
 #include "ut_ddbusextendedabstractinterface.moc"
@@ -50,3 +50,58 @@ TEST_F(ut_DDBusInterface, suffix)
     m_testInterface->setSuffix("-suffix");
     EXPECT_EQ(m_testInterface->suffix(), "-suffix");
 }
+
+TEST_F(ut_DDBusInterface, refreshProperties)
+{
+    QDBusPendingCall call = m_testInterface->refreshProperties();
+    call.waitForFinished();
+    EXPECT_FALSE(call.isError());
+    QCoreApplication::processEvents();
+
+    // read from the cache filled by GetAll
+    auto strproperty = qvariant_cast<QString>(m_testInterface->property("strProperty"));
+    EXPECT_EQ(strproperty, m_testservice->strproperty());
+}
+
+TEST_F(ut_DDBusInterface, asyncSetProperty)
+{
+    QDBusPendingCall call = m_testInterface->asyncSetProperty("strProperty", QString("ping"));
+    // seen at once, before the service replies
+    EXPECT_EQ(qvariant_cast<QString>(m_testInterface->property("strProperty")), "ping");
+    call.waitForFinished();
+    EXPECT_FALSE(call.isError());
+    EXPECT_EQ(m_testservice->strproperty(), "ping");
+
+    // the failed write is rolled back
+    call = m_testInterface->asyncSetProperty("noneProperty", QString("ping"));
+    call.waitForFinished();
+    EXPECT_TRUE(call.isError());
+    QCoreApplication::processEvents();
+    EXPECT_FALSE(m_testInterface->property("noneProperty").isValid());
+}
+
+TEST_F(ut_DDBusInterface, sharedServiceTracker)
+{
+    // the interfaces of one service share the owner query and the match rules
+    DDBusInterface other(FakeDBusService::get_service(),
+                         FakeDBusService::get_path(),
+                         FakeDBusService::get_interface(),
+                         QDBusConnection::sessionBus());
+    ASSERT_TRUE(QTest::qWaitFor([&]() { return m_testInterface->serviceValid() && other.serviceValid(); }, 1000));
+
+    // a late comer is answered from what is known
+    DDBusInterface *lateComer = new DDBusInterface(FakeDBusService::get_service(),
+                                                   FakeDBusService::get_path(),
+                                                   FakeDBusService::get_interface(),
+                                                   QDBusConnection::sessionBus());
+    EXPECT_FALSE(lateComer->serviceValid());
+    EXPECT_TRUE(QTest::qWaitFor([lateComer]() { return lateComer->serviceValid(); }, 1000));
+    delete lateComer;
+
+    // the others are still served
+    QDBusPendingCall call = other.asyncSetProperty("strProperty", QString("shared"));
+    call.waitForFinished();
+    EXPECT_FALSE(call.isError());
+    EXPECT_EQ(m_testservice->strproperty(), "shared");
+    EXPECT_TRUE(m_testInterface->serviceValid());
+}
@@ -7,6 +7,7 @@
 
 #include <QtDBus>
 #include <QDebug>
+#include <QSignalSpy>
 
 #include "fakedbus/fakedbusservice.h"
 
@@ -67,3 +68,27 @@ TEST_F(ut_DDBusSender, DDBusProperty)
 
     ASSERT_TRUE(m_testservice->strproperty() ==  QString("myProp"));
 }
+
+TEST_F(ut_DDBusSender, DDBusBatch)
+{
+    auto sender = m_sender->service(m_testservice->get_service())
+            .path(m_testservice->get_path())
+            .interface(m_testservice->get_interface());
+
+    DDBusBatch batch;
+    batch << sender.method(QString("foo")) << sender.method(QString("foo"));
+    ASSERT_EQ(batch.count(), 2);
+
+    QScopedPointer<DDBusBatchWatcher> watcher(batch.flush());
+    ASSERT_EQ(batch.count(), 0);
+    QSignalSpy spy(watcher.data(), &DDBusBatchWatcher::finished);
+    ASSERT_TRUE(spy.wait(2000));
+    ASSERT_EQ(spy.count(), 1);
+    ASSERT_TRUE(watcher->isFinished());
+    ASSERT_FALSE(watcher->isError());
+
+    for (const QDBusPendingCall &call : watcher->calls()) {
+        QDBusPendingReply<QString> reply = call;
+        ASSERT_EQ(reply.value(), QString("bar"));
+    }
+}
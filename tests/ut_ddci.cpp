@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include <DDciFile>
+#include <DDciFileWriter>
 
 #include <QLoggingCategory>
 #include <QDir>
@@ -10,6 +11,10 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDateTime>
+#include <QBuffer>
+
+#include <atomic>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -445,3 +450,408 @@ TEST_F(ut_DCI, DFileEngine) {
                   (QStringList {"1", "3"}));
     }
 }
+
+TEST_F(ut_DCI, DFileEngineReadOnly) {
+    DDciFile::registerFileEngine();
+
+    TestDCIFileHelper helper(QDir::temp().absoluteFilePath("test_readonly.dci"));
+    DDciFile source;
+    ASSERT_TRUE(source.writeFile("/test.txt", "Hello"));
+    ASSERT_TRUE(source.writeToFile(helper.sourceFileName()));
+
+    // 只读打开时使用进程内共享的 DDciFile
+    ASSERT_EQ(readAll(helper.dciFormatFilePath("/test.txt")), QByteArrayLiteral("Hello"));
+    const auto shared = DDciFile::shared(helper.sourceFileName());
+    ASSERT_EQ(shared->dataRef("/test.txt").constData(), DDciFile::shared(helper.sourceFileName())->dataRef("/test.txt").constData());
+    ASSERT_EQ(QDir(helper.dciFormatFilePath()).entryList(), QStringList{"test.txt"});
+    ASSERT_EQ(QDir(helper.dciFormatFilePath()).entryList({"TE*"}), QStringList{"test.txt"});
+    ASSERT_EQ(QDir(helper.dciFormatFilePath()).entryList({"a*", "*.txt"}), QStringList{"test.txt"});
+    ASSERT_TRUE(QDir(helper.dciFormatFilePath()).entryList({"a*"}).isEmpty());
+
+    {
+        // 修改后不再读取到缓存中的旧数据
+        QFile file(helper.dciFormatFilePath("/test.txt"));
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(file.putChar('h'));
+    }
+    ASSERT_EQ(readAll(helper.dciFormatFilePath("/test.txt")), QByteArrayLiteral("hello"));
+    ASSERT_EQ(shared->dataRef("/test.txt"), QByteArrayLiteral("Hello"));
+}
+
+TEST_F(ut_DCI, DDciFileMapFile) {
+    TestDCIFileHelper helper(QDir::temp().absoluteFilePath("test_map.dci"));
+    {
+        DDciFile dciFile;
+        ASSERT_TRUE(dciFile.mkdir("/test"));
+        ASSERT_TRUE(dciFile.writeFile("/test/test.txt", "test\n"));
+        ASSERT_TRUE(dciFile.link("/test/test.txt", "/test.link"));
+        ASSERT_TRUE(dciFile.writeToFile(helper.sourceFileName()));
+    }
+
+    DDciFile dciFile(helper.sourceFileName(), DDciFile::MapFile);
+    ASSERT_TRUE(dciFile.isValid());
+    ASSERT_EQ(dciFile.list("/"), (QStringList{"/test", "/test.link"}));
+    ASSERT_EQ(dciFile.dataRef("/test/test.txt"), QByteArrayLiteral("test\n"));
+    ASSERT_EQ(dciFile.dataRef("/test.link"), QByteArrayLiteral("test\n"));
+    ASSERT_EQ(dciFile.toData(), readAll(helper.sourceFileName()));
+
+    // 修改后的数据不再引用映射的文件
+    ASSERT_TRUE(dciFile.writeFile("/test/test.txt", "new\n", true));
+    ASSERT_EQ(dciFile.dataRef("/test/test.txt"), QByteArrayLiteral("new\n"));
+
+    // 空文件无法映射，回退后报告无效的数据
+    TestDCIFileHelper empty(QDir::temp().absoluteFilePath("test_map_empty.dci"));
+    QFile emptyFile(empty.sourceFileName());
+    ASSERT_TRUE(emptyFile.open(QIODevice::WriteOnly));
+    emptyFile.close();
+    ASSERT_FALSE(DDciFile(empty.sourceFileName(), DDciFile::MapFile).isValid());
+}
+
+TEST_F(ut_DCI, DDciFileLazyLoad) {
+    TestDCIFileHelper helper(QDir::temp().absoluteFilePath("test_lazy.dci"));
+    {
+        DDciFile dciFile;
+        ASSERT_TRUE(dciFile.mkdir("/a"));
+        ASSERT_TRUE(dciFile.mkdir("/a/b"));
+        ASSERT_TRUE(dciFile.mkdir("/c"));
+        ASSERT_TRUE(dciFile.writeFile("/a/b/test.txt", "test\n"));
+        ASSERT_TRUE(dciFile.writeFile("/c/test.txt", "c\n"));
+        ASSERT_TRUE(dciFile.link("../a/b/test.txt", "/c/test.link"));
+        ASSERT_TRUE(dciFile.writeToFile(helper.sourceFileName()));
+    }
+
+    for (auto mode : {DDciFile::LoadModes(DDciFile::LazyLoad), DDciFile::MapFile | DDciFile::LazyLoad}) {
+        DDciFile dciFile(helper.sourceFileName(), mode);
+        ASSERT_TRUE(dciFile.isValid());
+        ASSERT_EQ(dciFile.dataRef("/a/b/test.txt"), QByteArrayLiteral("test\n"));
+        ASSERT_EQ(dciFile.type("/a/b"), DDciFile::Directory);
+        ASSERT_FALSE(dciFile.exists("/a/b/none"));
+        ASSERT_FALSE(dciFile.exists("/a/b/test.txt/none"));
+        ASSERT_EQ(dciFile.dataRef("/c/test.link"), QByteArrayLiteral("test\n"));
+        ASSERT_EQ(dciFile.list("/c", true), (QStringList{"test.link", "test.txt"}));
+        ASSERT_EQ(dciFile.childrenCount("/a"), 1);
+        ASSERT_EQ(dciFile.toData(), readAll(helper.sourceFileName()));
+
+        ASSERT_TRUE(dciFile.rename("/c/test.txt", "/a/test.txt"));
+        ASSERT_EQ(dciFile.list("/a", true), (QStringList{"b", "test.txt"}));
+    }
+}
+
+TEST_F(ut_DCI, DDciFileLazyLoadThreads) {
+    DDciFile source;
+    for (int i = 0; i < 16; ++i) {
+        ASSERT_TRUE(source.mkdir(QString("/%1").arg(i)));
+        for (int j = 0; j < 16; ++j)
+            ASSERT_TRUE(source.writeFile(QString("/%1/%2").arg(i).arg(j), QByteArray::number(i * 16 + j)));
+    }
+    ASSERT_TRUE(source.setVersion(2));
+    TestDCIFileHelper helper(QDir::temp().absoluteFilePath("test_lazy_threads.dci"));
+    ASSERT_TRUE(source.writeToFile(helper.sourceFileName()));
+
+    // 只读的对象在多个线程中延迟加载同一目录
+    for (auto mode : {DDciFile::LoadModes(DDciFile::LazyLoad), DDciFile::MapFile | DDciFile::LazyLoad}) {
+        DDciFile dciFile(helper.sourceFileName(), mode);
+        ASSERT_TRUE(dciFile.isValid());
+        std::atomic_int failures(0);
+        auto read = [&dciFile, &failures] (int seed) {
+            for (int n = 0; n < 256; ++n) {
+                const int i = (n + seed) % 16, j = (n * 7 + seed) % 16;
+                if (dciFile.dataRef(QString("/%1/%2").arg(i).arg(j)) != QByteArray::number(i * 16 + j))
+                    ++failures;
+                if (dciFile.childrenCount(QString("/%1").arg(j)) != 16)
+                    ++failures;
+            }
+        };
+        std::thread thread1(read, 0), thread2(read, 5), thread3(read, 11);
+        read(3);
+        thread1.join();
+        thread2.join();
+        thread3.join();
+        ASSERT_EQ(failures, 0);
+    }
+}
+
+TEST_F(ut_DCI, DDciFileVersion2) {
+    DDciFile source;
+    ASSERT_EQ(source.version(), 1);
+    ASSERT_TRUE(source.mkdir("/a"));
+    ASSERT_TRUE(source.mkdir("/a/b"));
+    ASSERT_TRUE(source.writeFile("/a/b/test.txt", "test\n"));
+    ASSERT_TRUE(source.writeFile("/a/odd", "1"));
+    ASSERT_TRUE(source.link("b/test.txt", "/a/test.link"));
+    ASSERT_FALSE(source.setVersion(4));
+    ASSERT_TRUE(source.setVersion(2));
+
+    const QByteArray data = source.toData();
+    ASSERT_EQ(data.at(4), 2);
+    ASSERT_TRUE(data.endsWith("DCIX"));
+
+    TestDCIFileHelper helper(QDir::temp().absoluteFilePath("test_v2.dci"));
+    ASSERT_TRUE(source.writeToFile(helper.sourceFileName()));
+    ASSERT_EQ(readAll(helper.sourceFileName()), data);
+
+    for (auto mode : {DDciFile::LoadModes(DDciFile::ReadAll), DDciFile::LoadModes(DDciFile::LazyLoad),
+                      DDciFile::MapFile | DDciFile::LazyLoad}) {
+        DDciFile dciFile(helper.sourceFileName(), mode);
+        ASSERT_TRUE(dciFile.isValid()) << dciFile.lastErrorString().toStdString();
+        ASSERT_EQ(dciFile.version(), 2);
+        const QByteArray &file = dciFile.dataRef("/a/b/test.txt");
+        ASSERT_EQ(file, QByteArrayLiteral("test\n"));
+        // 文件数据按 64 字节对齐
+        ASSERT_EQ((file.constData() - dciFile.dataRef("/a/odd").constData()) % 64, 0);
+        ASSERT_EQ(dciFile.dataRef("/a/test.link"), QByteArrayLiteral("test\n"));
+        ASSERT_FALSE(dciFile.exists("/a/none"));
+        ASSERT_EQ(dciFile.list("/a", true), (QStringList{"b", "odd", "test.link"}));
+        ASSERT_EQ(dciFile.toData(), data);
+    }
+
+    // 数据损坏时校验失败
+    QByteArray corrupted = data;
+    corrupted[corrupted.indexOf("test\n")] = 'T';
+    ASSERT_FALSE(DDciFile(corrupted).isValid());
+    // 延迟加载时在首次访问节点时校验
+    {
+        TestDCIFileHelper corruptedHelper(QDir::temp().absoluteFilePath("test_v2_corrupted.dci"));
+        QFile file(corruptedHelper.sourceFileName());
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(file.write(corrupted), corrupted.size());
+        file.close();
+
+        DDciFile lazyFile(corruptedHelper.sourceFileName(), DDciFile::LazyLoad);
+        ASSERT_TRUE(lazyFile.isValid());
+        ASSERT_FALSE(lazyFile.exists("/a/b/test.txt"));
+        ASSERT_TRUE(lazyFile.dataRef("/a/odd").isNull());
+        ASSERT_FALSE(lazyFile.lastErrorString().isEmpty());
+    }
+
+    // 转换为版本 1
+    DDciFile dciFile(data);
+    ASSERT_TRUE(dciFile.setVersion(1));
+    DDciFile v1(dciFile.toData());
+    ASSERT_TRUE(v1.isValid());
+    ASSERT_EQ(v1.version(), 1);
+    ASSERT_EQ(v1.dataRef("/a/b/test.txt"), QByteArrayLiteral("test\n"));
+}
+
+TEST_F(ut_DCI, DDciFileCompressed) {
+    const QByteArray content = QByteArray("compressed\n").repeated(1000);
+    DDciFile source;
+    ASSERT_TRUE(source.mkdir("/a"));
+    ASSERT_TRUE(source.writeFile("/a/test.txt", content));
+    ASSERT_TRUE(source.writeFile("/a/raw", "raw"));
+    ASSERT_TRUE(source.link("test.txt", "/a/test.link"));
+    ASSERT_TRUE(source.setCompressed("/a/test.txt", true));
+    ASSERT_FALSE(source.setCompressed("/a", true));
+    ASSERT_FALSE(source.setCompressed("/a/test.link", true));
+    ASSERT_TRUE(source.isCompressed("/a/test.txt"));
+    ASSERT_FALSE(source.isCompressed("/a/raw"));
+    ASSERT_EQ(source.dataRef("/a/test.txt"), content);
+    ASSERT_TRUE(source.setVersion(3));
+
+    const QByteArray data = source.toData();
+    ASSERT_EQ(data.at(4), 3);
+    ASSERT_LT(data.size(), content.size());
+
+    TestDCIFileHelper helper(QDir::temp().absoluteFilePath("test_v3.dci"));
+    ASSERT_TRUE(source.writeToFile(helper.sourceFileName()));
+    for (auto mode : {DDciFile::LoadModes(DDciFile::ReadAll), DDciFile::LoadModes(DDciFile::LazyLoad),
+                      DDciFile::LoadModes(DDciFile::MapFile)}) {
+        DDciFile dciFile(helper.sourceFileName(), mode);
+        ASSERT_TRUE(dciFile.isValid()) << dciFile.lastErrorString().toStdString();
+        ASSERT_TRUE(dciFile.isCompressed("/a/test.txt"));
+        const QByteArray &file = dciFile.dataRef("/a/test.txt");
+        ASSERT_EQ(file, content);
+        // 解压后的数据被缓存
+        ASSERT_EQ(dciFile.dataRef("/a/test.txt").constData(), file.constData());
+        ASSERT_EQ(dciFile.dataRef("/a/test.link"), content);
+        ASSERT_EQ(dciFile.dataRef("/a/raw"), QByteArrayLiteral("raw"));
+        ASSERT_EQ(dciFile.toData(), data);
+    }
+
+    // 低版本中写入解压后的数据
+    DDciFile dciFile(data);
+    ASSERT_TRUE(dciFile.setVersion(2));
+    DDciFile v2(dciFile.toData());
+    ASSERT_TRUE(v2.isValid());
+    ASSERT_FALSE(v2.isCompressed("/a/test.txt"));
+    ASSERT_EQ(v2.dataRef("/a/test.txt"), content);
+
+    // 覆盖压缩的文件后仍是压缩的
+    ASSERT_TRUE(dciFile.writeFile("/a/test.txt", "new\n", true));
+    ASSERT_TRUE(dciFile.isCompressed("/a/test.txt"));
+    ASSERT_EQ(dciFile.dataRef("/a/test.txt"), QByteArrayLiteral("new\n"));
+    ASSERT_TRUE(dciFile.setCompressed("/a/test.txt", false));
+    ASSERT_EQ(dciFile.dataRef("/a/test.txt"), QByteArrayLiteral("new\n"));
+
+    // 流式写入
+    QByteArray written;
+    QBuffer buffer(&written);
+    ASSERT_TRUE(buffer.open(QIODevice::ReadWrite));
+    DDciFileWriter writer(&buffer, 3);
+    ASSERT_TRUE(writer.beginDirectory("a"));
+    ASSERT_TRUE(writer.writeFile("raw", "raw"));
+    ASSERT_TRUE(writer.link("test.link", "test.txt"));
+    ASSERT_TRUE(writer.writeCompressedFile("test.txt", content));
+    ASSERT_TRUE(writer.endDirectory());
+    ASSERT_TRUE(writer.finish()) << writer.lastErrorString().toStdString();
+    ASSERT_EQ(written, data);
+
+    QBuffer v2Buffer;
+    ASSERT_TRUE(v2Buffer.open(QIODevice::ReadWrite));
+    DDciFileWriter v2Writer(&v2Buffer, 2);
+    ASSERT_FALSE(v2Writer.writeCompressedFile("test.txt", content));
+
+    // 解压后超过 64 MiB 的数据不可压缩
+    QBuffer largeBuffer;
+    ASSERT_TRUE(largeBuffer.open(QIODevice::ReadWrite));
+    DDciFileWriter largeWriter(&largeBuffer, 3);
+    ASSERT_FALSE(largeWriter.writeCompressedFile("large", QByteArray(64 * 1024 * 1024 + 1, '\0')));
+}
+
+TEST_F(ut_DCI, DDciFileShared) {
+    TestDCIFileHelper helper(QDir::temp().absoluteFilePath("test_shared.dci"));
+    {
+        DDciFile dciFile;
+        ASSERT_TRUE(dciFile.writeFile("/test.txt", "test\n"));
+        ASSERT_TRUE(dciFile.writeToFile(helper.sourceFileName()));
+    }
+
+    auto file = DDciFile::shared(helper.sourceFileName());
+    ASSERT_TRUE(file->isValid());
+    ASSERT_EQ(file->dataRef("/test.txt"), QByteArrayLiteral("test\n"));
+    ASSERT_EQ(DDciFile::shared(helper.sourceFileName()), file);
+    ASSERT_NE(DDciFile::shared(helper.sourceFileName(), DDciFile::MapFile), file);
+
+    // 文件被替换后不会命中旧的缓存
+    {
+        DDciFile dciFile;
+        ASSERT_TRUE(dciFile.writeFile("/test.txt", "new\n"));
+        ASSERT_TRUE(dciFile.writeToFile(helper.sourceFileName()));
+    }
+    auto newFile = DDciFile::shared(helper.sourceFileName());
+    ASSERT_NE(newFile, file);
+    ASSERT_EQ(newFile->dataRef("/test.txt"), QByteArrayLiteral("new\n"));
+    ASSERT_EQ(file->dataRef("/test.txt"), QByteArrayLiteral("test\n"));
+
+    const qint64 limit = DDciFile::sharedCacheLimit();
+    DDciFile::setSharedCacheLimit(0);
+    ASSERT_NE(DDciFile::shared(helper.sourceFileName()), DDciFile::shared(helper.sourceFileName()));
+    DDciFile::setSharedCacheLimit(limit);
+
+    ASSERT_FALSE(DDciFile::shared(QDir::temp().absoluteFilePath("test_shared_none.dci"))->isValid());
+}
+
+TEST_F(ut_DCI, DDciFileWriter) {
+    DDciFile source;
+    ASSERT_TRUE(source.mkdir("/a"));
+    ASSERT_TRUE(source.mkdir("/a/b"));
+    ASSERT_TRUE(source.writeFile("/a/b/test.txt", "test\n"));
+    ASSERT_TRUE(source.writeFile("/a/odd", "1"));
+    ASSERT_TRUE(source.link("b/test.txt", "/a/test.link"));
+    ASSERT_TRUE(source.writeFile("/c", "c"));
+
+    for (int version : {1, 2}) {
+        ASSERT_TRUE(source.setVersion(version));
+
+        QByteArray data;
+        QBuffer buffer(&data);
+        ASSERT_TRUE(buffer.open(QIODevice::ReadWrite));
+        QByteArray fileData("test\n");
+        QBuffer file(&fileData);
+        ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+
+        DDciFileWriter writer(&buffer, version);
+        ASSERT_TRUE(writer.isValid()) << writer.lastErrorString().toStdString();
+        ASSERT_TRUE(writer.beginDirectory("a"));
+        ASSERT_TRUE(writer.beginDirectory("b"));
+        ASSERT_TRUE(writer.writeFile("test.txt", &file));
+        ASSERT_TRUE(writer.endDirectory());
+        ASSERT_TRUE(writer.writeFile("odd", "1"));
+        ASSERT_TRUE(writer.link("test.link", "b/test.txt"));
+        ASSERT_TRUE(writer.endDirectory());
+        ASSERT_FALSE(writer.endDirectory());
+        ASSERT_TRUE(writer.writeFile("c", "c"));
+        ASSERT_TRUE(writer.finish()) << writer.lastErrorString().toStdString();
+
+        ASSERT_EQ(data, source.toData());
+        DDciFile dciFile(data);
+        ASSERT_TRUE(dciFile.isValid());
+        ASSERT_EQ(dciFile.dataRef("/a/test.link"), QByteArrayLiteral("test\n"));
+    }
+
+    // 须按标准中规定的顺序写入
+    QByteArray data;
+    QBuffer buffer(&data);
+    ASSERT_TRUE(buffer.open(QIODevice::ReadWrite));
+    DDciFileWriter writer(&buffer);
+    ASSERT_TRUE(writer.writeFile("10", "10"));
+    ASSERT_FALSE(writer.writeFile("9", "9"));
+    ASSERT_FALSE(writer.isValid());
+    ASSERT_FALSE(writer.finish());
+
+    // 版本 2 需要可读的设备
+    QBuffer writeOnly;
+    ASSERT_TRUE(writeOnly.open(QIODevice::WriteOnly));
+    ASSERT_FALSE(DDciFileWriter(&writeOnly, 2).isValid());
+}
+
+TEST_F(ut_DCI, DDciFileOrder) {
+    DDciFile dciFile;
+    QVector<QPair<QString, QByteArray>> files;
+    for (int i = 100; i > 0; --i)
+        files << qMakePair(QString("/%1").arg(i), QByteArray::number(i));
+    ASSERT_TRUE(dciFile.writeFiles(files));
+    ASSERT_FALSE(dciFile.writeFiles({qMakePair(QString("/1"), QByteArray("1"))}));
+
+    // 数字按数值排序
+    const QStringList &list = dciFile.list("/", true);
+    ASSERT_EQ(list.count(), 100);
+    for (int i = 0; i < list.count(); ++i)
+        ASSERT_EQ(list.at(i), QString::number(i + 1));
+
+    // 逐个写入与批量写入的顺序相同
+    DDciFile other;
+    for (const auto &file : files)
+        ASSERT_TRUE(other.writeFile(file.first, file.second));
+    ASSERT_EQ(other.toData(), dciFile.toData());
+
+    // 同一目录中重命名后重新排序
+    ASSERT_TRUE(dciFile.rename("/1", "/200"));
+    ASSERT_EQ(dciFile.list("/", true).last(), QStringLiteral("200"));
+}
+
+TEST_F(ut_DCI, DDciFileRenameDirectory) {
+    DDciFile dciFile;
+    ASSERT_TRUE(dciFile.mkdir("/a"));
+    ASSERT_TRUE(dciFile.mkdir("/a/b"));
+    ASSERT_TRUE(dciFile.mkdir("/c"));
+    ASSERT_TRUE(dciFile.writeFile("/a/b/test.txt", "test\n"));
+    ASSERT_TRUE(dciFile.link("b/test.txt", "/a/test.link"));
+
+    // 目录下的所有节点随之移动
+    ASSERT_TRUE(dciFile.rename("/a", "/c/d"));
+    ASSERT_FALSE(dciFile.exists("/a"));
+    ASSERT_FALSE(dciFile.exists("/a/b/test.txt"));
+    ASSERT_EQ(dciFile.dataRef("/c/d/b/test.txt"), QByteArrayLiteral("test\n"));
+    ASSERT_EQ(dciFile.dataRef("/c/d/test.link"), QByteArrayLiteral("test\n"));
+    ASSERT_TRUE(dciFile.mkdir("/a"));
+    ASSERT_TRUE(dciFile.writeFile("/a/b", "b"));
+
+    // 不可移动到自身中
+    ASSERT_FALSE(dciFile.rename("/c", "/c/d/c"));
+    ASSERT_FALSE(dciFile.rename("/c/d/b", "/c", true));
+    ASSERT_FALSE(dciFile.rename("/c/d", "/a/b"));
+    ASSERT_TRUE(dciFile.rename("/c/d", "/a/b", true));
+    ASSERT_EQ(dciFile.dataRef("/a/b/b/test.txt"), QByteArrayLiteral("test\n"));
+
+    // 删除目录后其中的路径均不存在
+    ASSERT_TRUE(dciFile.remove("/a/b"));
+    ASSERT_FALSE(dciFile.exists("/a/b/b/test.txt"));
+    ASSERT_TRUE(dciFile.writeFile("/a/b", "b"));
+    ASSERT_FALSE(dciFile.exists("/a/"));
+    ASSERT_FALSE(dciFile.exists("//a"));
+
+    DDciFile copied(dciFile.toData());
+    ASSERT_EQ(copied.list("/", true), (QStringList{"a", "c"}));
+    ASSERT_EQ(copied.dataRef("/a/b"), QByteArrayLiteral("b"));
+}
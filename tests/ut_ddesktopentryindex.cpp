@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <DDesktopEntryIndex>
+
+#include <QDir>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+DCORE_USE_NAMESPACE
+
+class ut_DDesktopEntryIndex : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(tmpDir.isValid());
+        ASSERT_TRUE(QDir(tmpDir.path()).mkpath("local/applications/sub"));
+        ASSERT_TRUE(QDir(tmpDir.path()).mkpath("system/applications"));
+        localDir = tmpDir.filePath("local/applications");
+        systemDir = tmpDir.filePath("system/applications");
+        indexFile = tmpDir.filePath("cache/desktop-entry.index");
+    }
+
+    static void writeFile(const QString &path, const QByteArray &content)
+    {
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(content);
+    }
+
+    QTemporaryDir tmpDir;
+    QString localDir;
+    QString systemDir;
+    QString indexFile;
+};
+
+TEST_F(ut_DDesktopEntryIndex, BuildAndUpdate)
+{
+    writeFile(systemDir + "/foo.desktop", "[Desktop Entry]\n"
+                                          "Type=Application\n"
+                                          "Name=Foo\n"
+                                          "Name[zh_CN]=福\n"
+                                          "Icon=foo\n"
+                                          "Exec=foo %F\n"
+                                          "Categories=Graphics;Viewer;\n"
+                                          "MimeType=image/png;\n");
+    writeFile(systemDir + "/bar.desktop", "[Desktop Entry]\nType=Application\nName=Bar\nNoDisplay=true\n");
+    writeFile(systemDir + "/link.desktop", "[Desktop Entry]\nType=Link\nName=Link\n");
+    writeFile(localDir + "/sub/baz.desktop", "[Desktop Entry]\nType=Application\nName=Baz\n");
+    // hides the one of the system directory
+    writeFile(localDir + "/bar.desktop", "[Desktop Entry]\nType=Application\nName=Bar\nHidden=true\n");
+
+    {
+        DDesktopEntryIndex index({localDir, systemDir}, indexFile);
+        // the directories aren't scanned by the constructor
+        ASSERT_FALSE(index.isValid());
+        ASSERT_TRUE(index.update());
+        ASSERT_TRUE(index.isValid());
+        ASSERT_TRUE(QFile::exists(indexFile));
+        ASSERT_EQ(index.desktopIds(), (QStringList{"foo.desktop", "sub-baz.desktop"}));
+        ASSERT_EQ(index.count(), 2);
+        ASSERT_FALSE(index.contains("bar.desktop"));
+        ASSERT_FALSE(index.contains("link.desktop"));
+
+        const auto &foo = index.entry("foo.desktop");
+        ASSERT_EQ(foo.filePath, systemDir + "/foo.desktop");
+        ASSERT_EQ(foo.name, "Foo");
+        ASSERT_EQ(foo.localizedName(QLocale("zh_CN")), QStringLiteral("福"));
+        ASSERT_EQ(foo.localizedName(QLocale("de_DE")), "Foo");
+        ASSERT_EQ(foo.icon, "foo");
+        ASSERT_EQ(foo.exec, "foo %F");
+        ASSERT_EQ(foo.categories, (QStringList{"Graphics", "Viewer"}));
+        ASSERT_EQ(foo.mimeTypes, QStringList{"image/png"});
+        ASSERT_FALSE(foo.noDisplay);
+        ASSERT_TRUE(index.entry("none.desktop").desktopId.isEmpty());
+    }
+
+    DDesktopEntryIndex index({localDir, systemDir}, indexFile);
+    ASSERT_EQ(index.count(), 2);
+    QSignalSpy spy(&index, &DDesktopEntryIndex::updated);
+    // nothing is changed
+    ASSERT_TRUE(index.update());
+    ASSERT_EQ(spy.count(), 0);
+
+    ASSERT_TRUE(QFile::remove(localDir + "/bar.desktop"));
+    ASSERT_TRUE(QFile::remove(localDir + "/sub/baz.desktop"));
+    writeFile(systemDir + "/foo.desktop", "[Desktop Entry]\nType=Application\nName=Foo 2\n");
+    ASSERT_TRUE(index.update());
+    ASSERT_EQ(spy.count(), 1);
+    ASSERT_EQ(index.desktopIds(), (QStringList{"bar.desktop", "foo.desktop"}));
+    ASSERT_TRUE(index.entry("bar.desktop").noDisplay);
+    ASSERT_EQ(index.entry("foo.desktop").name, "Foo 2");
+    ASSERT_TRUE(index.entry("foo.desktop").categories.isEmpty());
+
+    // the index of other directories is rebuilt
+    DDesktopEntryIndex other({systemDir}, indexFile);
+    ASSERT_EQ(other.directories(), QStringList{systemDir});
+    ASSERT_FALSE(other.isValid());
+    ASSERT_TRUE(other.update());
+    ASSERT_EQ(other.count(), 2);
+
+    ASSERT_NE(DDesktopEntryIndex::defaultIndexFile({localDir, systemDir}), DDesktopEntryIndex::defaultIndexFile({systemDir}));
+}
+
+TEST_F(ut_DDesktopEntryIndex, DesktopFilePaths)
+{
+    const QByteArray dataHome = qgetenv("XDG_DATA_HOME");
+    const QByteArray dataDirs = qgetenv("XDG_DATA_DIRS");
+    qputenv("XDG_DATA_HOME", tmpDir.filePath("local").toLocal8Bit());
+    qputenv("XDG_DATA_DIRS", tmpDir.filePath("system").toLocal8Bit());
+
+    writeFile(systemDir + "/foo.desktop", "[Desktop Entry]\nType=Application\nName=Foo\n");
+    writeFile(localDir + "/sub/baz.desktop", "[Desktop Entry]\nType=Application\nName=Baz\n");
+
+    ASSERT_EQ(DDesktopEntryIndex::desktopFilePaths("foo.desktop"), QStringList{systemDir + "/foo.desktop"});
+    ASSERT_EQ(DDesktopEntryIndex::desktopFilePaths("sub-baz.desktop"), QStringList{localDir + "/sub/baz.desktop"});
+    ASSERT_EQ(DDesktopEntryIndex::desktopIdOfFile(localDir + "/sub/baz.desktop"), "sub-baz.desktop");
+    ASSERT_TRUE(DDesktopEntryIndex::desktopFilePaths("none.desktop").isEmpty());
+
+    // the added files are found at once
+    writeFile(localDir + "/foo.desktop", "[Desktop Entry]\nType=Application\nName=Foo\n");
+    ASSERT_EQ(DDesktopEntryIndex::desktopFilePaths("foo.desktop"), (QStringList{localDir + "/foo.desktop", systemDir + "/foo.desktop"}));
+    ASSERT_TRUE(QFile::remove(localDir + "/sub/baz.desktop"));
+    ASSERT_TRUE(DDesktopEntryIndex::desktopFilePaths("sub-baz.desktop").isEmpty());
+
+    qputenv("XDG_DATA_HOME", dataHome);
+    qputenv("XDG_DATA_DIRS", dataDirs);
+}
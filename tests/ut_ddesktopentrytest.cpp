@@ -4,6 +4,7 @@
 
 #include <QDebug>
 #include <QString>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <DDesktopEntry>
 #include <gtest/gtest.h>
@@ -116,3 +117,212 @@ TEST_F(ut_DesktopEntry, escape)
     ASSERT_TRUE(DDesktopEntry::escapeExec(slash) == slash);
     ASSERT_TRUE(DDesktopEntry::unescapeExec(slash) == slash);
 }
+
+TEST_F(ut_DesktopEntry, escapeView)
+{
+    ASSERT_EQ(DDesktopEntry::unescape(QStringView(u"a\\sb\\nc\\;d\\x\\")), QString("a b\nc\\;d\\x\\"));
+    ASSERT_EQ(DDesktopEntry::unescape(QStringView(u"a\\;b"), true), QStringLiteral("a;b"));
+    ASSERT_EQ(DDesktopEntry::unescapeExec(QStringView(u"\\\\$HOME\\\\ \\\\\"")), QStringLiteral("$HOME\x01\""));
+    ASSERT_EQ(DDesktopEntry::escapeExec(QStringView(u"$HOME")), QStringLiteral("\\\\$HOME"));
+
+    // the overloads of QStringView return the same results as the in-place ones
+    const QStringList samples {
+        QString(), "plain", "tab\tnew line\n", "\\s\\n\\t\\r\\\\\\;", "quote\" '$' `cmd` \\", "trailing\\",
+    };
+    for (const QString &sample : samples) {
+        QString str = sample;
+        ASSERT_EQ(DDesktopEntry::escape(QStringView(sample)), DDesktopEntry::escape(str));
+        str = sample;
+        ASSERT_EQ(DDesktopEntry::escapeExec(QStringView(sample)), DDesktopEntry::escapeExec(str));
+        str = sample;
+        ASSERT_EQ(DDesktopEntry::unescape(QStringView(sample), true), DDesktopEntry::unescape(str, true));
+        str = sample;
+        ASSERT_EQ(DDesktopEntry::unescapeExec(QStringView(sample)), DDesktopEntry::unescapeExec(str));
+    }
+}
+
+TEST_F(ut_DesktopEntry, LookupBeforeParsing)
+{
+    QTemporaryFile file("testLookupXXXXXX.desktop");
+    ASSERT_TRUE(file.open());
+    const QString fileName = file.fileName();
+    file.write("[Desktop Entry]\n"
+               "Name = Foo\n"
+               "Name[de]=Foo (de)\n"
+               "Exec=foo\n"
+               "Exec=bar %U\n"
+               "Icon=\n"
+               "[Other]\n"
+               "Name=Other\n");
+    file.close();
+
+    DDesktopEntry desktopFile(fileName);
+    // the values are decoded only for the requested keys
+    ASSERT_EQ(desktopFile.stringValue("Name"), QStringLiteral("Foo"));
+    ASSERT_EQ(desktopFile.localizedValue("Name", "de"), QStringLiteral("Foo (de)"));
+    ASSERT_EQ(desktopFile.localizedValue("Name", "fr"), QStringLiteral("Foo"));
+    // the last one overrides the same keys
+    ASSERT_EQ(desktopFile.stringValue("Exec"), QStringLiteral("bar %U"));
+    ASSERT_TRUE(desktopFile.contains("Icon"));
+    ASSERT_TRUE(desktopFile.stringValue("Icon", "Desktop Entry", "default").isEmpty());
+    ASSERT_FALSE(desktopFile.contains("Nam"));
+    ASSERT_FALSE(desktopFile.contains("Name[de]", "Other"));
+    ASSERT_EQ(desktopFile.stringValue("Name", "Other"), QStringLiteral("Other"));
+
+    ASSERT_TRUE(desktopFile.setStringValue("baz", "Exec"));
+    ASSERT_EQ(desktopFile.stringValue("Exec"), QStringLiteral("baz"));
+    ASSERT_EQ(desktopFile.stringValue("Name"), QStringLiteral("Foo"));
+    ASSERT_EQ(desktopFile.keys("Desktop Entry"), QStringList({"Exec", "Icon", "Name", "Name[de]"}));
+}
+
+TEST_F(ut_DesktopEntry, LoadMany)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    QStringList paths;
+    for (int i = 0; i < 20; ++i) {
+        const QString path = dir.filePath(QString("app%1.desktop").arg(i));
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(QString("[Desktop Entry]\nName=App %1\n").arg(i).toUtf8());
+        paths << path;
+    }
+    paths << dir.filePath("none.desktop");
+
+    for (int threads : {0, 1, 4}) {
+        const auto &entries = DDesktopEntry::loadMany(paths, threads);
+        ASSERT_EQ(entries.size(), paths.size());
+        for (int i = 0; i < 20; ++i) {
+            ASSERT_EQ(entries.at(i)->status(), DDesktopEntry::NoError);
+            ASSERT_EQ(entries.at(i)->name(), QString("App %1").arg(i));
+        }
+        ASSERT_TRUE(entries.last()->allGroups().isEmpty());
+    }
+    ASSERT_TRUE(DDesktopEntry::loadMany({}).isEmpty());
+}
+
+TEST_F(ut_DesktopEntry, LongLines)
+{
+    QTemporaryFile file("testLongLinesXXXXXX.desktop");
+    ASSERT_TRUE(file.open());
+    const QString fileName = file.fileName();
+    const QByteArray padding(37, 'x');
+    // the special characters are placed across the 16 bytes blocks of the vectorized scanner.
+    file.write("# a comment which is long enough to be scanned in more than one block = [Ignored]\r\n"
+               "[Desktop Entry]\r\n"
+               "Exec=" + padding + " --option=value --other=value\r\n"
+               "Comment=" + padding + "\\nsecond line with a \\; semicolon;\r\n"
+               "  " + padding + "Key   =   value # not a comment\n"
+               "Name=last line without a line terminator");
+    file.close();
+
+    DDesktopEntry desktopFile(fileName);
+    ASSERT_EQ(desktopFile.status(), DDesktopEntry::NoError);
+    ASSERT_EQ(desktopFile.allGroups(), QStringList({"Desktop Entry"}));
+    ASSERT_EQ(desktopFile.stringValue("Exec"), QString(padding + " --option=value --other=value"));
+    ASSERT_EQ(desktopFile.stringValue(padding + "Key"), QStringLiteral("value # not a comment"));
+    ASSERT_EQ(desktopFile.stringValue("Name"), QStringLiteral("last line without a line terminator"));
+    ASSERT_EQ(desktopFile.keys("Desktop Entry").size(), 4);
+}
+
+TEST_F(ut_DesktopEntry, LocalizedFallback)
+{
+    QTemporaryFile file("testLocalizedXXXXXX.desktop");
+    ASSERT_TRUE(file.open());
+    const QString fileName = file.fileName();
+    file.write("[Desktop Entry]\n"
+               "Name=Foo\n"
+               "Name[C]=Foo (C)\n"
+               "Name[fi]=Foo (fi)\n"
+               "Comment=Bar\n");
+    file.close();
+
+    DDesktopEntry desktopFile(fileName);
+    for (int i = 0; i < 2; ++i) {
+        // the same results for the cached fallback chains and the parsed section
+        ASSERT_EQ(desktopFile.localizedValue("Name", "fi"), QStringLiteral("Foo (fi)"));
+        ASSERT_EQ(desktopFile.localizedValue("Name", "de"), QStringLiteral("Foo (C)"));
+        ASSERT_EQ(desktopFile.localizedValue("Name", QString()), QStringLiteral("Foo (C)"));
+        ASSERT_EQ(desktopFile.localizedValue("Name", "empty"), QStringLiteral("Foo"));
+        ASSERT_EQ(desktopFile.localizedValue("Comment", "fi"), QStringLiteral("Bar"));
+        ASSERT_EQ(desktopFile.localizedValue("Comment", "fi", "Other", "default"), QStringLiteral("default"));
+        ASSERT_TRUE(desktopFile.localizedValue("Icon", "fi").isEmpty());
+
+        struct RestoreLocale {
+            ~RestoreLocale() { QLocale::setDefault(QLocale::system()); }
+        } restoreLocale;
+        Q_UNUSED(restoreLocale);
+        // fi_FI falls back to the bcp47 name fi
+        QLocale::setDefault(QLocale("fi_FI"));
+        ASSERT_EQ(desktopFile.localizedValue("Name"), QStringLiteral("Foo (fi)"));
+
+        // the second round looks the values up in the modified section
+        ASSERT_TRUE(desktopFile.setStringValue("foo", "Exec"));
+    }
+}
+
+TEST_F(ut_DesktopEntry, SaveUntouchedSections)
+{
+    QTemporaryFile file("testSaveXXXXXX.desktop");
+    ASSERT_TRUE(file.open());
+    const QString fileName = file.fileName();
+    const QByteArray first("[Desktop Entry]\n"
+                           "# the comments and the order are kept\n"
+                           "Name=Foo\n"
+                           "Exec=foo\n\n");
+    const QByteArray last("[Desktop Action Last]\n"
+                          "Name = Last\n");
+    file.write(first + "[Desktop Action Modified]\nName=Old\n\n" + last);
+    file.close();
+
+    DDesktopEntry desktopFile(fileName);
+    // parsing a section for reading doesn't make it modified
+    ASSERT_EQ(desktopFile.keys("Desktop Entry"), QStringList({"Exec", "Name"}));
+    ASSERT_TRUE(desktopFile.setStringValue("New", "Name", "Desktop Action Modified"));
+    ASSERT_TRUE(desktopFile.save());
+
+    QFile savedFile(fileName);
+    ASSERT_TRUE(savedFile.open(QIODevice::ReadOnly));
+    ASSERT_EQ(savedFile.readAll(), first + "[Desktop Action Modified]\nName=New\n" + last);
+
+    DDesktopEntry savedEntry(fileName);
+    ASSERT_EQ(savedEntry.stringValue("Name", "Desktop Action Modified"), QStringLiteral("New"));
+    ASSERT_EQ(savedEntry.stringValue("Name", "Desktop Action Last"), QStringLiteral("Last"));
+}
+
+TEST_F(ut_DesktopEntry, CachedLists)
+{
+    QTemporaryFile file("testCachedXXXXXX.desktop");
+    ASSERT_TRUE(file.open());
+    const QString fileName = file.fileName();
+    file.write("[Desktop Entry]\n"
+               "Name=Foo\n"
+               "Exec=foo\n"
+               "Exec=bar\n"
+               "[B Section]\n"
+               "Name=B\n"
+               "[A Section]\n"
+               "Name=A\n");
+    file.close();
+
+    DDesktopEntry desktopFile(fileName);
+    // the keys of an unparsed section, the duplicated keys are listed once
+    ASSERT_EQ(desktopFile.keys(), QStringList({"Exec", "Name"}));
+    ASSERT_EQ(desktopFile.keys(), QStringList({"Exec", "Name"}));
+    ASSERT_EQ(desktopFile.allGroups(), QStringList({"A Section", "B Section", "Desktop Entry"}));
+    ASSERT_EQ(desktopFile.allGroups(true), QStringList({"Desktop Entry", "B Section", "A Section"}));
+
+    ASSERT_TRUE(desktopFile.setRawValue("foo", "Icon"));
+    ASSERT_EQ(desktopFile.keys(), QStringList({"Exec", "Icon", "Name"}));
+    ASSERT_TRUE(desktopFile.removeEntry("Exec"));
+    ASSERT_EQ(desktopFile.keys(), QStringList({"Icon", "Name"}));
+
+    ASSERT_TRUE(desktopFile.setRawValue("C", "Name", "C Section"));
+    ASSERT_EQ(desktopFile.allGroups(true), QStringList({"Desktop Entry", "B Section", "A Section", "C Section"}));
+    ASSERT_EQ(desktopFile.keys("C Section"), QStringList({"Name"}));
+
+    ASSERT_TRUE(desktopFile.reload());
+    ASSERT_EQ(desktopFile.allGroups(true), QStringList({"Desktop Entry", "B Section", "A Section"}));
+    ASSERT_EQ(desktopFile.keys(), QStringList({"Exec", "Name"}));
+}
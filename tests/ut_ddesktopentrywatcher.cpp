@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <DDesktopEntryWatcher>
+
+#include <QFile>
+#include <QSaveFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <gtest/gtest.h>
+
+DCORE_USE_NAMESPACE
+
+class ut_DDesktopEntryWatcher : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(tmpDir.isValid());
+        filePath = tmpDir.filePath("foo.desktop");
+        writeFile("[Desktop Entry]\nName=Foo\nExec=foo\n\n[Desktop Action New]\nName=New\n");
+    }
+
+    void writeFile(const QByteArray &content)
+    {
+        // replace the file as the editors do
+        QSaveFile file(filePath);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(content);
+        ASSERT_TRUE(file.commit());
+    }
+
+    QTemporaryDir tmpDir;
+    QString filePath;
+};
+
+TEST_F(ut_DDesktopEntryWatcher, refresh)
+{
+    DDesktopEntryWatcher watcher(filePath);
+    const auto entry = watcher.entry();
+    ASSERT_EQ(watcher.filePath(), filePath);
+    ASSERT_EQ(entry->stringValue("Name"), QStringLiteral("Foo"));
+
+    QSignalSpy spy(&watcher, &DDesktopEntryWatcher::keysChanged);
+    watcher.refresh();
+    ASSERT_EQ(spy.count(), 0);
+
+    writeFile("[Desktop Entry]\nName=Bar\nExec=foo\nIcon=bar\n\n[Desktop Action Other]\nName=Other\n");
+    watcher.refresh();
+    // the entry is refreshed in place
+    ASSERT_EQ(watcher.entry(), entry);
+    ASSERT_EQ(entry->stringValue("Name"), QStringLiteral("Bar"));
+
+    ASSERT_EQ(spy.count(), 3);
+    ASSERT_EQ(spy.at(0).at(0).toString(), QStringLiteral("Desktop Action New"));
+    ASSERT_EQ(spy.at(0).at(1).toStringList(), QStringList({"Name"}));
+    ASSERT_EQ(spy.at(1).at(0).toString(), QStringLiteral("Desktop Action Other"));
+    ASSERT_EQ(spy.at(1).at(1).toStringList(), QStringList({"Name"}));
+    ASSERT_EQ(spy.at(2).at(0).toString(), QStringLiteral("Desktop Entry"));
+    ASSERT_EQ(spy.at(2).at(1).toStringList(), QStringList({"Icon", "Name"}));
+}
+
+TEST_F(ut_DDesktopEntryWatcher, watch)
+{
+    DDesktopEntryWatcher watcher(filePath);
+    QSignalSpy spy(&watcher, &DDesktopEntryWatcher::keysChanged);
+
+    writeFile("[Desktop Entry]\nName=Foo\nExec=bar\n\n[Desktop Action New]\nName=New\n");
+    ASSERT_TRUE(QTest::qWaitFor([&spy]() { return spy.count() >= 1; }, 2000));
+    ASSERT_EQ(spy.at(0).at(0).toString(), QStringLiteral("Desktop Entry"));
+    ASSERT_EQ(spy.at(0).at(1).toStringList(), QStringList({"Exec"}));
+    ASSERT_EQ(watcher.entry()->stringValue("Exec"), QStringLiteral("bar"));
+}
@@ -60,3 +60,46 @@ TEST_F(ut_DDiskSizeFormatter, testDDiskSizeFormatterUnitStr)
     ASSERT_EQ(diskSizeFormatter.unitStr(DDiskSizeFormatter::G), "GB");
     ASSERT_EQ(diskSizeFormatter.unitStr(DDiskSizeFormatter::T), "TB");
 }
+
+TEST_F(ut_DDiskSizeFormatter, testDDiskSizeFormatterFormatBytes)
+{
+    diskSizeFormatter.rate(1024);
+    QPair<qreal, int> result = diskSizeFormatter.formatBytes(1536);
+    ASSERT_TRUE(qFuzzyCompare(result.first, 1.5));
+    ASSERT_EQ(result.second, DDiskSizeFormatter::K);
+    ASSERT_EQ(diskSizeFormatter.formatBytes(0).second, DDiskSizeFormatter::B);
+    ASSERT_EQ(diskSizeFormatter.formatBytes(1023).second, DDiskSizeFormatter::B);
+    ASSERT_EQ(diskSizeFormatter.formatBytes(quint64(1) << 50).second, DDiskSizeFormatter::T);
+
+    diskSizeFormatter.rate(1000);
+    result = diskSizeFormatter.formatBytes(2500000);
+    ASSERT_TRUE(qFuzzyCompare(result.first, 2.5));
+    ASSERT_EQ(result.second, DDiskSizeFormatter::M);
+
+    QString text;
+    diskSizeFormatter.appendBytes(999, text);
+    ASSERT_EQ(text, "999 B");
+    text.truncate(0);
+    diskSizeFormatter.appendBytes(1250, text, 2);
+    ASSERT_EQ(text, "1.25 KB");
+    text.truncate(0);
+    diskSizeFormatter.appendBytes(999990, text);
+    ASSERT_EQ(text, "1.0 MB");
+}
+
+TEST_F(ut_DDiskSizeFormatter, testDDiskSizeFormatterFormatMany)
+{
+    diskSizeFormatter.rate(1024);
+    const qreal values[] = {512, 1536, 3 * 1024 * 1024};
+    QString results[3];
+
+    diskSizeFormatter.formatMany(values, 3, DDiskSizeFormatter::B, results);
+    ASSERT_EQ(results[0], "512 B");
+    ASSERT_EQ(results[1], "1.5 KB");
+    ASSERT_EQ(results[2], "3 MB");
+
+    diskSizeFormatter.formatMany(values, 3, DDiskSizeFormatter::B, results, 2);
+    ASSERT_EQ(results[0], "512.00 B");
+    ASSERT_EQ(results[1], "1.50 KB");
+    ASSERT_EQ(results[2], "3.00 MB");
+}
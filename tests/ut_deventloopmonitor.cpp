@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "deventloopmonitor.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QThread>
+#include <QTimer>
+
+DCORE_USE_NAMESPACE
+
+TEST(ut_DEventLoopMonitor, stalled)
+{
+    DEventLoopMonitor monitor;
+    EXPECT_EQ(monitor.monitoredThread(), QThread::currentThread());
+    monitor.setThreshold(20);
+    EXPECT_EQ(monitor.threshold(), 20);
+    ASSERT_TRUE(monitor.start());
+    EXPECT_TRUE(monitor.isActive());
+
+    QSignalSpy spy(&monitor, &DEventLoopMonitor::stalled);
+    QTimer::singleShot(0, [] { QThread::msleep(50); });
+
+    QElapsedTimer timer;
+    timer.start();
+    while (spy.isEmpty() && timer.elapsed() < 1000)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+
+    ASSERT_FALSE(spy.isEmpty());
+    EXPECT_GE(spy.first().at(2).toLongLong(), 50);
+
+    monitor.stop();
+    EXPECT_FALSE(monitor.isActive());
+}
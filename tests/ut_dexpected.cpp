@@ -57,3 +57,118 @@ TEST(ut_DError, operator)
 
     qDebug() << error; // operator <<
 }
+
+static DExpected<int, DErrorCode> parsePositive(int v)
+{
+    if (v > 0)
+        return v;
+    return DUnexpected<DErrorCode>{emplace_tag::USE_EMPLACE, 22, "Invalid argument"};
+}
+
+TEST(ut_DExpected, errorCode)
+{
+    static_assert(std::is_trivially_copyable<DErrorCode>::value, "DErrorCode should be trivially copyable");
+    static_assert(std::is_trivially_copyable<DExpected<int, DErrorCode>>::value, "DExpected<int, DErrorCode> should be trivially copyable");
+    static_assert(std::is_trivially_copyable<DExpected<void, DErrorCode>>::value, "DExpected<void, DErrorCode> should be trivially copyable");
+    static_assert(!std::is_trivially_copyable<DExpected<int>>::value, "DError isn't trivially copyable");
+
+    constexpr DExpected<int, DErrorCode> exp_const {200};
+    static_assert(exp_const.hasValue(), "constexpr DExpected");
+
+    auto exp_int = parsePositive(1);
+    EXPECT_TRUE(exp_int.hasValue());
+    EXPECT_EQ(exp_int.value(), 1);
+
+    exp_int = parsePositive(-1);
+    EXPECT_FALSE(exp_int.hasValue());
+    EXPECT_EQ(exp_int.error().getErrorCode(), 22);
+    EXPECT_EQ(exp_int.error().getErrorMessage(), "Invalid argument");
+
+    DExpected<int> exp_error = parsePositive(-1);
+    EXPECT_FALSE(exp_error.hasValue());
+    EXPECT_EQ(exp_error.error().getErrorCode(), 22);
+    EXPECT_EQ(exp_error.error().getErrorMessage(), "Invalid argument");
+
+    DExpected<int> copy = exp_error;
+    EXPECT_EQ(copy.error(), exp_error.error());
+}
+
+namespace {
+struct CopyCounter
+{
+    explicit CopyCounter(int v)
+        : value(v)
+    {
+    }
+    CopyCounter(const CopyCounter &other)
+        : value(other.value)
+    {
+        ++copies;
+    }
+    CopyCounter(CopyCounter &&other) noexcept
+        : value(other.value)
+    {
+        ++moves;
+    }
+    CopyCounter &operator=(const CopyCounter &other)
+    {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+    CopyCounter &operator=(CopyCounter &&other) noexcept
+    {
+        value = other.value;
+        ++moves;
+        return *this;
+    }
+
+    int value;
+    static int copies;
+    static int moves;
+};
+int CopyCounter::copies = 0;
+int CopyCounter::moves = 0;
+}  // namespace
+
+TEST(ut_DExpected, monadic)
+{
+    CopyCounter::copies = 0;
+    CopyCounter::moves = 0;
+
+    auto result = DExpected<CopyCounter>(emplace_tag::USE_EMPLACE, 1)
+                      .and_then([](CopyCounter &&c) {
+                          c.value += 1;
+                          return DExpected<CopyCounter>(std::move(c));
+                      })
+                      .transform([](CopyCounter &&c) { return CopyCounter(c.value * 10); })
+                      .transform_error([](DError &&e) { return DErrorCode(e.getErrorCode()); });
+    EXPECT_TRUE(result.hasValue());
+    EXPECT_EQ(result.value().value, 20);
+    EXPECT_EQ(CopyCounter::copies, 0);
+    // into the result of and_then, out of the result of transform
+    EXPECT_EQ(CopyCounter::moves, 2);
+
+    bool called = false;
+    auto recovered = DExpected<CopyCounter>(DUnexpected<DError>{emplace_tag::USE_EMPLACE, 2, "No such file"})
+                         .transform([&called](CopyCounter &&c) {
+                             called = true;
+                             return std::move(c);
+                         })
+                         .or_else([](DError &&e) { return DExpected<CopyCounter>(emplace_tag::USE_EMPLACE, int(e.getErrorCode())); });
+    EXPECT_FALSE(called);
+    EXPECT_TRUE(recovered.hasValue());
+    EXPECT_EQ(recovered.value().value, 2);
+    EXPECT_EQ(CopyCounter::copies, 0);
+
+    const DExpected<int> exp_int {200};
+    EXPECT_EQ(exp_int.transform([](int v) { return v + 1; }).value(), 201);
+    EXPECT_FALSE(exp_int.and_then([](int v) { return DExpected<void>(DUnexpected<DError>{emplace_tag::USE_EMPLACE, v, "Error"}); }).hasValue());
+
+    DExpected<void> exp_void {};
+    EXPECT_EQ(exp_void.transform([] { return 1; }).value(), 1);
+    EXPECT_EQ(DExpected<void>(DUnexpected<DError>{emplace_tag::USE_EMPLACE, 404, "Not Found"})
+                  .transform_error([](const DError &e) { return e.getErrorCode(); })
+                  .error(),
+              404);
+}
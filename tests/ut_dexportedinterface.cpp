@@ -95,3 +95,36 @@ TEST_F(ut_DExportedInterface, invoke)
     EXPECT_TRUE(msg.isError());
     EXPECT_TRUE(msg.error().type() == QDBusError::ErrorType::InvalidArgs);
 }
+
+TEST_F(ut_DExportedInterface, call)
+{
+    _infc->registerTypedAction("sum", "add up the arguments", [](const QVariantList &args)->QVariant {
+        int sum = 0;
+        for (const QVariant &arg : args)
+            sum += arg.toInt();
+        return sum;
+    });
+    _infc->registerAsyncAction("later", "answer with the first argument", [](const QVariantList &args) {
+        QFutureInterface<QVariant> future(QFutureInterfaceBase::Started);
+        future.reportResult(args.value(0));
+        future.reportFinished();
+        return future.future();
+    });
+
+    auto caller = DDBusSender().service("org.deepin.ExpIntfTest")
+            .path("/")
+            .interface("com.deepin.ExportedInterface")
+            .method("call")
+            .arg(QString("sum"))
+            .arg(QVariantList{1, 2, 3});
+
+    auto msg = caller.call();
+    msg.waitForFinished();
+
+    QDBusReply<QVariant> reply = msg;
+    EXPECT_EQ(reply.value(), 6);
+
+    EXPECT_EQ(_infc->call("answer", {}).result(), 42);
+    EXPECT_EQ(_infc->call("later", {QString("soon")}).result(), QString("soon"));
+    EXPECT_EQ(_infc->invoke("sum", "7"), 7);
+}
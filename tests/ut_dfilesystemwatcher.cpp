@@ -4,6 +4,12 @@
 
 #include <gtest/gtest.h>
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
 #if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
 #include <filesystem>  //Avoid changing the access control of the standard library
 #endif
@@ -94,3 +100,262 @@ TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherRemovePaths)
     ASSERT_FALSE(dirs1.contains("/tmp/etc0"));
     ASSERT_FALSE(dirs1.contains("/tmp/etc1"));
 }
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherBurst)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    fileSystemWatcher->addPath("/tmp/etc0");
+    QSignalSpy spy(fileSystemWatcher, &DFileSystemWatcher::fileCreated);
+    for (int i = 0; i < 100; ++i) {
+        QFile file(QString("/tmp/etc0/background%1").arg(i));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    }
+
+    ASSERT_TRUE(QTest::qWaitFor([&spy]() { return spy.count() >= 100; }, 2000));
+    ASSERT_EQ(spy.count(), 100);
+
+    for (int i = 0; i < 100; ++i)
+        QFile::remove(QString("/tmp/etc0/background%1").arg(i));
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherAddRecursive)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+    const QString root = tmpDir.path();
+    ASSERT_TRUE(QDir(root).mkpath("a/b"));
+    ASSERT_TRUE(QDir(root).mkpath("skip/c"));
+
+    ASSERT_FALSE(fileSystemWatcher->addRecursive(root + "/not-exists"));
+    ASSERT_TRUE(fileSystemWatcher->addRecursive(root, {"skip"}));
+    ASSERT_FALSE(fileSystemWatcher->directories().contains(root));
+
+    QSignalSpy spy(fileSystemWatcher, &DFileSystemWatcher::fileCreated);
+    auto waitFor = [&spy](const QString &path, const QString &name) {
+        return QTest::qWaitFor([&]() {
+            for (const QList<QVariant> &args : spy) {
+                if (args.at(0).toString() == path && args.at(1).toString() == name)
+                    return true;
+            }
+            return false;
+        }, 2000);
+    };
+
+    // an existing subdirectory
+    ASSERT_TRUE(QDir(root).mkpath("a/b/new"));
+    ASSERT_TRUE(waitFor(root + "/a/b", "new"));
+
+    // the new subdirectory is watched too
+    QFile file(root + "/a/b/new/file");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+    ASSERT_TRUE(waitFor(root + "/a/b/new", "file"));
+
+    // the renamed subdirectory is watched by the new name
+    ASSERT_TRUE(QDir(root).rename("a/b", "a/renamed"));
+    QTest::qWait(100);
+    QFile renamedFile(root + "/a/renamed/new/file2");
+    ASSERT_TRUE(renamedFile.open(QIODevice::WriteOnly));
+    renamedFile.close();
+    ASSERT_TRUE(waitFor(root + "/a/renamed/new", "file2"));
+
+    // the filtered subdirectories are not watched
+    spy.clear();
+    QFile skippedFile(root + "/skip/c/file");
+    ASSERT_TRUE(skippedFile.open(QIODevice::WriteOnly));
+    skippedFile.close();
+    QTest::qWait(200);
+    ASSERT_TRUE(spy.isEmpty());
+
+    ASSERT_TRUE(fileSystemWatcher->removeRecursive(root));
+    ASSERT_FALSE(fileSystemWatcher->removeRecursive(root));
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherAddFilesystem)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+    // the paths of fanotify are resolved, the symbolic links aren't kept
+    const QString root = QFileInfo(tmpDir.path()).canonicalFilePath();
+
+    // fanotify is used if the process is privileged, or else inotify
+    ASSERT_TRUE(fileSystemWatcher->addFilesystem(root));
+
+    QSignalSpy spy(fileSystemWatcher, &DFileSystemWatcher::fileCreated);
+    // the events of the filesystem out of the root aren't emitted
+    QTemporaryDir otherDir;
+    ASSERT_TRUE(otherDir.isValid());
+    const QString other = QFileInfo(otherDir.path()).canonicalFilePath();
+    QFile otherFile(other + "/file");
+    ASSERT_TRUE(otherFile.open(QIODevice::WriteOnly));
+    otherFile.close();
+
+    QFile file(root + "/file");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+    ASSERT_TRUE(QTest::qWaitFor([&]() {
+        for (const QList<QVariant> &args : spy) {
+            if (args.at(0).toString() == root && args.at(1).toString() == "file")
+                return true;
+        }
+        return false;
+    }, 2000));
+    for (const QList<QVariant> &args : spy)
+        ASSERT_NE(args.at(0).toString(), other);
+
+    ASSERT_TRUE(fileSystemWatcher->removeFilesystem(root));
+    ASSERT_FALSE(fileSystemWatcher->removeFilesystem(root));
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherSharedInstance)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+    const QString root = tmpDir.path();
+
+    // the watchers share the wd of the same directory
+    QScopedPointer<DFileSystemWatcher> other(new DFileSystemWatcher);
+    ASSERT_TRUE(fileSystemWatcher->addPath(root));
+    ASSERT_TRUE(other->addPath(root));
+
+    QSignalSpy spy(fileSystemWatcher, &DFileSystemWatcher::fileCreated);
+    QSignalSpy otherSpy(other.data(), &DFileSystemWatcher::fileCreated);
+    QFile file(root + "/file1");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+    ASSERT_TRUE(QTest::qWaitFor([&]() { return spy.count() >= 1 && otherSpy.count() >= 1; }, 2000));
+
+    // the wd is kept for the other watcher
+    ASSERT_TRUE(other->removePath(root));
+    other.reset();
+    spy.clear();
+    QFile file2(root + "/file2");
+    ASSERT_TRUE(file2.open(QIODevice::WriteOnly));
+    file2.close();
+    ASSERT_TRUE(QTest::qWaitFor([&]() { return spy.count() >= 1; }, 2000));
+    ASSERT_EQ(spy.first().at(1).toString(), QString("file2"));
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherMoveCorrelation)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+    const QString root = tmpDir.path();
+    ASSERT_TRUE(QDir(root).mkpath("from"));
+    ASSERT_TRUE(QDir(root).mkpath("to"));
+    ASSERT_TRUE(fileSystemWatcher->addPaths({root + "/from", root + "/to"}).isEmpty());
+
+    QSignalSpy spy(fileSystemWatcher, &DFileSystemWatcher::fileMoved);
+    for (int i = 0; i < 50; ++i) {
+        QFile file(root + QString("/from/file%1").arg(i));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    }
+    for (int i = 0; i < 50; ++i)
+        ASSERT_TRUE(QFile::rename(root + QString("/from/file%1").arg(i), root + QString("/to/file%1").arg(i)));
+
+    // every rename is one move with both of the paths, even if the events are split by the reads
+    ASSERT_TRUE(QTest::qWaitFor([&spy]() { return spy.count() >= 50; }, 2000));
+    QTest::qWait(100);
+    ASSERT_EQ(spy.count(), 50);
+    for (const QList<QVariant> &args : spy) {
+        ASSERT_EQ(args.at(0).toString(), root + "/from");
+        ASSERT_EQ(args.at(2).toString(), root + "/to");
+        ASSERT_EQ(args.at(1).toString(), args.at(3).toString());
+    }
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherStatistics)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+    ASSERT_TRUE(fileSystemWatcher->addPath(tmpDir.path()));
+    ASSERT_EQ(fileSystemWatcher->statistics().watchCount, 1);
+
+    QSignalSpy spy(fileSystemWatcher, &DFileSystemWatcher::fileCreated);
+    QFile file(tmpDir.filePath("file"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_TRUE(QTest::qWaitFor([&spy]() { return spy.count() >= 1; }, 2000));
+
+    const DFileSystemWatcher::Statistics stats = fileSystemWatcher->statistics();
+    ASSERT_GE(stats.eventCount, 1u);
+    ASSERT_GE(stats.batchCount, 1u);
+    ASSERT_GE(stats.maxBatchTime, stats.lastBatchTime);
+    ASSERT_EQ(stats.overflowCount, 0u);
+
+    fileSystemWatcher->resetStatistics();
+    ASSERT_EQ(fileSystemWatcher->statistics().eventCount, 0u);
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherEventFilter)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+    const QString root = tmpDir.path();
+    ASSERT_TRUE(fileSystemWatcher->addPath(root, DFileSystemWatcher::FileCreatedEvent | DFileSystemWatcher::FileDeletedEvent, {"*.o"}));
+    ASSERT_EQ(fileSystemWatcher->eventTypes(root), DFileSystemWatcher::FileCreatedEvent | DFileSystemWatcher::FileDeletedEvent);
+    ASSERT_EQ(fileSystemWatcher->excludePatterns(root), QStringList("*.o"));
+    ASSERT_EQ(fileSystemWatcher->eventTypes(root + "/none"), DFileSystemWatcher::EventTypes());
+
+    // an unfiltered watcher of the same directory still gets all of the events
+    QScopedPointer<DFileSystemWatcher> other(new DFileSystemWatcher);
+    ASSERT_TRUE(other->addPath(root));
+    ASSERT_EQ(other->eventTypes(root), DFileSystemWatcher::AllEvents);
+
+    QSignalSpy createdSpy(fileSystemWatcher, &DFileSystemWatcher::fileCreated);
+    QSignalSpy modifiedSpy(fileSystemWatcher, &DFileSystemWatcher::fileModified);
+    QSignalSpy otherModifiedSpy(other.data(), &DFileSystemWatcher::fileModified);
+
+    QFile object(root + "/main.o");
+    ASSERT_TRUE(object.open(QIODevice::WriteOnly));
+    object.write("object");
+    object.close();
+    QFile source(root + "/main.cpp");
+    ASSERT_TRUE(source.open(QIODevice::WriteOnly));
+    source.write("source");
+    source.close();
+
+    ASSERT_TRUE(QTest::qWaitFor([&]() { return createdSpy.count() >= 1 && otherModifiedSpy.count() >= 2; }, 2000));
+    QTest::qWait(100);
+    ASSERT_EQ(createdSpy.count(), 1);
+    ASSERT_EQ(createdSpy.first().at(1).toString(), QString("main.cpp"));
+    ASSERT_TRUE(modifiedSpy.isEmpty());
+
+    ASSERT_TRUE(fileSystemWatcher->removePath(root));
+    ASSERT_EQ(fileSystemWatcher->eventTypes(root), DFileSystemWatcher::EventTypes());
+    ASSERT_TRUE(fileSystemWatcher->excludePatterns(root).isEmpty());
+}
+
+TEST_F(ut_DFileSystemWatcher, testDFileSystemWatcherSharedInstanceMask)
+{
+    if (!fileSystemWatcher->d_func()) return;
+
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+    const QString root = tmpDir.path();
+
+    // the watch of the other watcher on the same inode doesn't narrow the events of this one
+    QScopedPointer<DFileSystemWatcher> other(new DFileSystemWatcher);
+    ASSERT_TRUE(fileSystemWatcher->addPath(root));
+    ASSERT_TRUE(other->addPath(root, DFileSystemWatcher::FileDeletedEvent));
+
+    QSignalSpy spy(fileSystemWatcher, &DFileSystemWatcher::fileCreated);
+    QSignalSpy otherSpy(other.data(), &DFileSystemWatcher::fileCreated);
+    QFile file(root + "/file1");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+    ASSERT_TRUE(QTest::qWaitFor([&]() { return spy.count() >= 1; }, 2000));
+    ASSERT_EQ(otherSpy.count(), 0);
+}
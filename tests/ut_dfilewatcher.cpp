@@ -192,3 +192,103 @@ TEST_F(ut_DFileWatcher, testDFileSystemWatcherFileClosed)
     }, 1000));
     ASSERT_TRUE(spy.count() >= 1);
 }
+
+TEST_F(ut_DFileWatcher, testDFileWatcherCoalescing)
+{
+    DFileWatcher dirWatcher("/tmp/etc");
+    dirWatcher.setCoalescingInterval(200);
+    ASSERT_EQ(dirWatcher.coalescingInterval(), 200);
+    if (!dirWatcher.startWatcher()) return;
+
+    QSignalSpy modifiedSpy(&dirWatcher, &DBaseFileWatcher::fileModified);
+    QSignalSpy createdSpy(&dirWatcher, &DBaseFileWatcher::subfileCreated);
+    QSignalSpy deletedSpy(&dirWatcher, &DBaseFileWatcher::fileDeleted);
+
+    // the modifications of a file are merged
+    QFile file("/tmp/etc/test");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    for (int i = 0; i < 20; ++i) {
+        file.write("hello");
+        file.flush();
+    }
+    file.close();
+
+    // a file which is created and deleted in the window is not notified
+    QFile tmpFile("/tmp/etc/test1");
+    ASSERT_TRUE(tmpFile.open(QIODevice::WriteOnly));
+    tmpFile.close();
+    ASSERT_TRUE(tmpFile.remove());
+
+    ASSERT_TRUE(QTest::qWaitFor([&modifiedSpy]() { return modifiedSpy.count() >= 1; }, 1000));
+    QTest::qWait(300);
+    ASSERT_EQ(modifiedSpy.count(), 1);
+    ASSERT_EQ(modifiedSpy.first().first().toUrl(), QUrl::fromLocalFile("/tmp/etc/test"));
+    ASSERT_TRUE(createdSpy.isEmpty());
+    ASSERT_TRUE(deletedSpy.isEmpty());
+}
+
+TEST_F(ut_DFileWatcher, testDFileWatcherGhostSignal)
+{
+    DFileWatcher dirWatcher("/tmp/etc");
+    QSignalSpy fileSpy(fileWatcher, &DBaseFileWatcher::fileAttributeChanged);
+    QSignalSpy dirSpy(&dirWatcher, &DBaseFileWatcher::fileAttributeChanged);
+
+    const QUrl fileUrl = QUrl::fromLocalFile("/tmp/etc/test");
+    ASSERT_TRUE(DBaseFileWatcher::ghostSignal(fileUrl, &DBaseFileWatcher::fileAttributeChanged, fileUrl));
+    ASSERT_EQ(fileSpy.count(), 1);
+    ASSERT_TRUE(dirSpy.isEmpty());
+    ASSERT_FALSE(DBaseFileWatcher::ghostSignal(QUrl::fromLocalFile("/tmp/etc/none"), &DBaseFileWatcher::fileAttributeChanged, fileUrl));
+
+    // only the children of /tmp/etc, not the directory itself
+    ASSERT_EQ(DBaseFileWatcher::ghostSignalToChildren(QUrl::fromLocalFile("/tmp/etc/"), &DBaseFileWatcher::fileAttributeChanged, fileUrl), 1);
+    ASSERT_EQ(fileSpy.count(), 2);
+    ASSERT_TRUE(dirSpy.isEmpty());
+}
+
+TEST_F(ut_DFileWatcher, testDFileWatcherPolling)
+{
+    const int minimumInterval = DFileWatcher::minimumPollingInterval();
+    const int maximumInterval = DFileWatcher::maximumPollingInterval();
+    DFileWatcher::setPollingInterval(20, 200);
+    ASSERT_EQ(DFileWatcher::minimumPollingInterval(), 20);
+    ASSERT_EQ(DFileWatcher::maximumPollingInterval(), 200);
+
+    DFileWatcher dirWatcher("/tmp/etc");
+    DFileWatcher otherWatcher("/tmp/etc");
+    ASSERT_EQ(dirWatcher.watchMode(), DFileWatcher::AutoMode);
+    dirWatcher.setWatchMode(DFileWatcher::PollingMode);
+    otherWatcher.setWatchMode(DFileWatcher::PollingMode);
+    ASSERT_TRUE(dirWatcher.startWatcher());
+    ASSERT_TRUE(otherWatcher.startWatcher());
+    ASSERT_TRUE(dirWatcher.isPolling());
+
+    QSignalSpy createdSpy(&dirWatcher, &DBaseFileWatcher::subfileCreated);
+    QSignalSpy otherCreatedSpy(&otherWatcher, &DBaseFileWatcher::subfileCreated);
+    QSignalSpy modifiedSpy(&dirWatcher, &DBaseFileWatcher::fileModified);
+    QSignalSpy movedSpy(&dirWatcher, &DBaseFileWatcher::fileMoved);
+    QSignalSpy deletedSpy(&dirWatcher, &DBaseFileWatcher::fileDeleted);
+
+    QFile file("/tmp/etc/test1");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+    ASSERT_TRUE(QTest::qWaitFor([&createdSpy]() { return createdSpy.count() >= 1; }, 1000));
+    ASSERT_EQ(createdSpy.first().first().toUrl(), QUrl::fromLocalFile("/tmp/etc/test1"));
+    ASSERT_TRUE(QTest::qWaitFor([&otherCreatedSpy]() { return otherCreatedSpy.count() >= 1; }, 1000));
+
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    file.write("hello");
+    file.close();
+    ASSERT_TRUE(QTest::qWaitFor([&modifiedSpy]() { return modifiedSpy.count() >= 1; }, 1000));
+
+    ASSERT_TRUE(file.rename("/tmp/etc/test2"));
+    ASSERT_TRUE(QTest::qWaitFor([&movedSpy]() { return movedSpy.count() >= 1; }, 1000));
+    ASSERT_EQ(movedSpy.first().at(1).toUrl(), QUrl::fromLocalFile("/tmp/etc/test2"));
+
+    ASSERT_TRUE(file.remove());
+    ASSERT_TRUE(QTest::qWaitFor([&deletedSpy]() { return deletedSpy.count() >= 1; }, 1000));
+
+    ASSERT_TRUE(dirWatcher.stopWatcher());
+    ASSERT_FALSE(dirWatcher.isPolling());
+    ASSERT_TRUE(otherWatcher.isPolling());
+    DFileWatcher::setPollingInterval(minimumInterval, maximumInterval);
+}
@@ -9,6 +9,7 @@
 #include <QUrl>
 #include <QSignalSpy>
 #include <QTest>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include "filesystem/dfilewatcher.h"
 #include "filesystem/dfilewatchermanager.h"
@@ -80,3 +81,47 @@ TEST_F(ut_DFileWatcherManager, testDFileSystemWatcherwatchedFiles)
     fileWatcherManager->watchedFiles();
     ASSERT_EQ(fileWatcherManager->watchedFiles().count(), 2);
 }
+
+TEST_F(ut_DFileWatcherManager, testDFileWatcherManagerAddMany)
+{
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+
+    QStringList filePaths;
+    for (int i = 0; i < 100; ++i) {
+        QFile file(tmpDir.filePath(QString("file%1").arg(i)));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        filePaths << file.fileName();
+    }
+
+    const QStringList &failedPaths = fileWatcherManager->addMany(filePaths << "/tmp/not-exists-file");
+    ASSERT_EQ(failedPaths, QStringList{"/tmp/not-exists-file"});
+    ASSERT_EQ(fileWatcherManager->watchedFiles().count(), 100);
+
+    QSignalSpy spy(fileWatcherManager, &DFileWatcherManager::fileDeleted);
+    ASSERT_TRUE(QFile::remove(filePaths.at(10)));
+    ASSERT_TRUE(QTest::qWaitFor([&spy]() { return spy.count() >= 1; }, 1000));
+    ASSERT_EQ(spy.first().first().toString(), filePaths.at(10));
+
+    fileWatcherManager->removeMany(filePaths);
+    ASSERT_EQ(fileWatcherManager->watchedFiles().count(), 0);
+}
+
+TEST_F(ut_DFileWatcherManager, testDFileWatcherManagerAddPrefix)
+{
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+    ASSERT_TRUE(QDir(tmpDir.path()).mkpath("a/b"));
+
+    ASSERT_TRUE(fileWatcherManager->addPrefix(tmpDir.path()));
+    ASSERT_EQ(fileWatcherManager->watchedPrefixes(), QStringList{tmpDir.path()});
+
+    QSignalSpy spy(fileWatcherManager, &DFileWatcherManager::subfileCreated);
+    QFile file(tmpDir.filePath("a/b/file"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_TRUE(QTest::qWaitFor([&spy]() { return spy.count() >= 1; }, 1000));
+    ASSERT_EQ(spy.first().first().toString(), tmpDir.filePath("a/b/file"));
+
+    fileWatcherManager->removePrefix(tmpDir.path());
+    ASSERT_TRUE(fileWatcherManager->watchedPrefixes().isEmpty());
+}
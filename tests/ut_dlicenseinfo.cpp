@@ -28,3 +28,16 @@ TEST(ut_DLicenseInfo, testLicense)
     EXPECT_EQ(licenseInfo.componentInfos().count(), 1);
     ASSERT_FALSE(licenseInfo.licenseContent("LGPLv3").isEmpty());
 }
+
+TEST(ut_DLicenseInfo, testComponentLicenseContent)
+{
+    DLicenseInfo licenseInfo;
+    licenseInfo.setLicenseSearchPath(":/data/");
+    ASSERT_TRUE(licenseInfo.loadFile(":/data/example-license.json"));
+
+    DLicenseInfo::DComponentInfo *component = licenseInfo.componentInfos().first();
+    const QByteArray content = component->licenseContent();
+    ASSERT_FALSE(content.isEmpty());
+    // the cached text is shared, not read again
+    EXPECT_EQ(content.constData(), licenseInfo.licenseContent(component->licenseName()).constData());
+}
@@ -5,6 +5,10 @@
 #include "log/LogManager.h"
 #undef private
 
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QThread>
+
 #include "dpathbuf.h"
 #include "dstandardpaths.h"
 #include "test_helper.hpp"
@@ -37,3 +41,87 @@ TEST(ut_DLogManager, testSetInvalidLogPath)
     // set log file path to a dir is not supported
     ASSERT_NE(DLogManager::getlogFilePath(), tmp);
 }
+
+TEST(ut_DLogManager, testAsyncLogging)
+{
+    ASSERT_FALSE(DLogManager::isAsyncLogging());
+    DLogManager::setAsyncLogging(true, 16, DLogManager::DropWhenFull);
+    ASSERT_TRUE(DLogManager::isAsyncLogging());
+
+    for (int i = 0; i < 100; ++i)
+        qDebug() << "async logging" << i;
+    DLogManager::flush();
+
+    DLogManager::setAsyncLogging(false);
+    ASSERT_FALSE(DLogManager::isAsyncLogging());
+}
+
+TEST(ut_DLogManager, testBinaryLog)
+{
+    QTemporaryDir dir;
+    const QString &oldPath = DLogManager::getlogFilePath();
+    const QString &path = dir.filePath("binary.dlog");
+    DLogManager::setlogFilePath(path);
+    DLogManager::setBinaryLogFormat(true);
+    ASSERT_TRUE(DLogManager::isBinaryLogFormat());
+    DLogManager::registerFileAppender();
+
+    qDebug() << "binary logging" << 1;
+    qWarning() << "binary logging" << 2;
+    DLogManager::flush();
+
+    QBuffer output;
+    output.open(QIODevice::WriteOnly);
+    ASSERT_TRUE(DLogManager::decodeBinaryLog(path, &output, "[%{type}] %{message}\n"));
+    ASSERT_TRUE(output.data().contains("binary logging 1"));
+    ASSERT_TRUE(output.data().contains("[Warning] binary logging 2"));
+
+    QFile broken(dir.filePath("broken.dlog"));
+    ASSERT_TRUE(broken.open(QIODevice::WriteOnly));
+    broken.write("not a log");
+    broken.close();
+    ASSERT_FALSE(DLogManager::decodeBinaryLog(broken.fileName(), &output));
+
+    DLogManager::setBinaryLogFormat(false);
+    DLogManager::setlogFilePath(oldPath);
+}
+
+TEST(ut_DLogManager, testLevelEnabled)
+{
+    DLogManager::instance();
+    ASSERT_TRUE(DLogManager::isLevelEnabled(QtFatalMsg));
+
+    QLoggingCategory::setFilterRules("default.debug=false");
+    ASSERT_FALSE(DLogManager::isLevelEnabled(QtDebugMsg));
+    ASSERT_TRUE(DLogManager::isLevelEnabled(QtWarningMsg));
+
+    QLoggingCategory::setFilterRules("default.debug=true");
+    ASSERT_TRUE(DLogManager::isLevelEnabled(QtDebugMsg));
+    QLoggingCategory::setFilterRules(QString());
+}
+
+TEST(ut_DLogManager, testRateLimit)
+{
+    QTemporaryDir dir;
+    const QString &oldPath = DLogManager::getlogFilePath();
+    const QString &path = dir.filePath("ratelimit.log");
+    DLogManager::setlogFilePath(path);
+    DLogManager::registerFileAppender();
+    DLogManager::setLogRateLimit(2, 50);
+
+    for (int i = 0; i < 10; ++i)
+        qWarning() << "repeated" << i;
+    QThread::msleep(60);
+    DLogManager::flush();
+
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    const QByteArray &content = file.readAll();
+    ASSERT_TRUE(content.contains("repeated 0"));
+    ASSERT_TRUE(content.contains("repeated 1"));
+    ASSERT_FALSE(content.contains("repeated 5"));
+    ASSERT_TRUE(content.contains("repeated 9 (repeated 8 more times in 50 ms)"));
+
+    DLogManager::setLogRateLimit(0);
+    DLogManager::setlogFilePath(oldPath);
+}
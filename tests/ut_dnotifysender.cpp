@@ -38,3 +38,19 @@ TEST(ut_DNotifySender, notify)
     EXPECT_TRUE(notifySender.m_dbusData->m_actions == QStringList({"1", "2"}));
     EXPECT_TRUE(notifySender.m_dbusData->m_timeOut == 5000);
 }
+
+TEST(ut_DNotifySender, notification)
+{
+    DUtil::DNotification notification;
+    EXPECT_EQ(notification.id(), 0u);
+    EXPECT_EQ(notification.minimumInterval(), 250);
+
+    notification.setMinimumInterval(1000);
+    EXPECT_EQ(notification.minimumInterval(), 1000);
+    notification.setMinimumInterval(-1);
+    EXPECT_EQ(notification.minimumInterval(), 0);
+
+    // nothing was shown, nothing to close
+    notification.close();
+    EXPECT_EQ(notification.id(), 0u);
+}
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include <DObject>
+#include "dobject_p.h"
+
+DCORE_USE_NAMESPACE
+
+namespace {
+class PooledObjectPrivate;
+class PooledObject : public DObject
+{
+    D_DECLARE_PRIVATE(PooledObject)
+public:
+    PooledObject();
+
+    DObjectPrivate *privateData() const { return d_d_ptr.data(); }
+};
+
+class PooledObjectPrivate : public DObjectPrivate
+{
+    D_DECLARE_PUBLIC(PooledObject)
+public:
+    D_DECLARE_POOLED_PRIVATE(PooledObjectPrivate)
+
+    explicit PooledObjectPrivate(PooledObject *qq)
+        : DObjectPrivate(qq)
+    {
+    }
+
+    int data = 0;
+};
+
+PooledObject::PooledObject()
+    : DObject(*new PooledObjectPrivate(this))
+{
+}
+}  // namespace
+
+TEST(ut_DObject, pooledPrivate)
+{
+    const void *freed = nullptr;
+    {
+        PooledObject object;
+        freed = object.privateData();
+    }
+
+    // the freed block is reused by the next object of the same thread
+    PooledObject object;
+    EXPECT_EQ(object.privateData(), freed);
+
+    PooledObject other;
+    EXPECT_NE(other.privateData(), object.privateData());
+}
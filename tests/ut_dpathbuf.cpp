@@ -78,3 +78,21 @@ TEST_F(ut_DPathBuf, testToString)
     auto str = pathBuf->toString();
     ASSERT_TRUE(str == "/tmp/etc");
 }
+
+TEST_F(ut_DPathBuf, testDPathBuilder)
+{
+    DPathBuilder builder(QLatin1String("/tmp/etc"), 64);
+    builder.append(QLatin1String("a")).append(QStringView(QStringLiteral("b"))).append(QString("c")).append("d");
+    builder /= QLatin1String("e");
+    ASSERT_EQ(builder.toString(), "/tmp/etc/a/b/c/d/e");
+    ASSERT_EQ(builder.toPathBuf().toString(), "/tmp/etc/a/b/c/d/e");
+
+    // it's normalized like DPathBuf
+    DPathBuilder unclean(QLatin1String("/tmp/etc/"));
+    unclean.append(QLatin1String("./a")).append(QLatin1String("/b/")).append(QLatin1String("../c/"));
+    ASSERT_EQ(unclean.toString(), (*pathBuf / "./a" / "/b/" / "../c/").toString());
+    ASSERT_EQ(unclean.toString(), "/tmp/etc/a/c");
+
+    DPathBuilder relative(QLatin1String("relative"));
+    ASSERT_EQ(relative.toString(), QDir::current().absoluteFilePath("relative"));
+}
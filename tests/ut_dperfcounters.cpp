@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "dperfcounters.h"
+#include "dexportedinterface.h"
+#include "dpinyin.h"
+
+#include <QFuture>
+#include <QThread>
+
+#include <memory>
+#include <vector>
+
+DCORE_USE_NAMESPACE
+
+TEST(ut_DPerfCounters, counter)
+{
+    DPerfCounter counter("ut.counter");
+    EXPECT_STREQ(counter.name(), "ut.counter");
+    EXPECT_TRUE(DPerfCounters::counterNames().contains("ut.counter"));
+
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back(QThread::create([&counter] {
+            for (int j = 0; j < 1000; ++j)
+                counter.add();
+        }));
+        threads.back()->start();
+    }
+    for (auto &thread : threads)
+        thread->wait();
+
+    EXPECT_EQ(counter.value(), 4000);
+    EXPECT_EQ(DPerfCounters::counterValue("ut.counter"), 4000);
+
+    {
+        // the ones of the same name are summed up
+        DPerfCounter other("ut.counter");
+        other.add(5);
+        EXPECT_EQ(DPerfCounters::counterValue("ut.counter"), 4005);
+        EXPECT_EQ(DPerfCounters::counterNames().count("ut.counter"), 1);
+    }
+    EXPECT_EQ(DPerfCounters::counterValue("ut.counter"), 4000);
+
+    DPerfCounters::reset();
+    EXPECT_EQ(counter.value(), 0);
+}
+
+TEST(ut_DPerfCounters, unregistered)
+{
+    {
+        DPerfCounter counter("ut.temporary");
+        counter.add();
+        EXPECT_TRUE(DPerfCounters::counterNames().contains("ut.temporary"));
+    }
+    EXPECT_FALSE(DPerfCounters::counterNames().contains("ut.temporary"));
+    EXPECT_EQ(DPerfCounters::counterValue("ut.temporary"), 0);
+}
+
+TEST(ut_DPerfCounters, histogram)
+{
+    DPerfHistogram histogram("ut.histogram", {10, 100, 1000});
+    EXPECT_EQ(histogram.bounds(), QVector<qint64>({10, 100, 1000}));
+
+    histogram.record(1);
+    histogram.record(10);
+    histogram.record(11);
+    histogram.record(500);
+    histogram.record(5000);
+    EXPECT_EQ(histogram.counts(), QVector<qint64>({2, 1, 1, 1}));
+    EXPECT_EQ(histogram.count(), 5);
+    EXPECT_EQ(histogram.sum(), 5522);
+
+    {
+        DPerfHistogram::ScopedTimer timer(histogram);
+        QThread::msleep(2);
+    }
+    EXPECT_EQ(histogram.count(), 6);
+    EXPECT_GE(histogram.sum(), 5522 + 2000);
+
+    const QVariantMap entry = DPerfCounters::snapshot().value("histograms").toMap().value("ut.histogram").toMap();
+    EXPECT_EQ(entry.value("count").toLongLong(), 6);
+    EXPECT_EQ(entry.value("bounds").toList().size(), 3);
+    EXPECT_EQ(entry.value("counts").toList().size(), 4);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0);
+    EXPECT_EQ(histogram.sum(), 0);
+}
+
+TEST(ut_DPerfCounters, builtin)
+{
+    const qint64 lookups = DPerfCounters::counterValue("pinyin.lookups");
+    firstLetters("汉字");
+    pinyin("汉字");
+    EXPECT_EQ(DPerfCounters::counterValue("pinyin.lookups"), lookups + 2);
+
+    const QStringList names = DPerfCounters::counterNames();
+    EXPECT_TRUE(names.contains("dconfig.reads"));
+    EXPECT_TRUE(names.contains("dci.cache_hits"));
+    EXPECT_TRUE(names.contains("log.dropped_records"));
+    EXPECT_TRUE(DPerfCounters::histogramNames().contains("dconfig.ipc_latency_us"));
+}
+
+TEST(ut_DPerfCounters, exported)
+{
+    DPerfCounter counter("ut.exported");
+    counter.add(3);
+
+    DUtil::DExportedInterface interface;
+    DPerfCounters::exportTo(&interface, "counters");
+
+    QVariantMap result = interface.call("counters", {}).result().toMap();
+    EXPECT_EQ(result.value("counters").toMap().value("ut.exported").toLongLong(), 3);
+    EXPECT_EQ(counter.value(), 3);
+
+    result = interface.call("counters", {"reset"}).result().toMap();
+    EXPECT_EQ(result.value("counters").toMap().value("ut.exported").toLongLong(), 3);
+    EXPECT_EQ(counter.value(), 0);
+}
@@ -4,7 +4,13 @@
 
 #include <gtest/gtest.h>
 #include "util/dpinyin.h"
+#include "dpinyindict_p.h"
+#include <QRegularExpression>
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+#include <vector>
 DCORE_USE_NAMESPACE
 
 class ut_DPinyin : public testing::Test
@@ -76,3 +82,163 @@ TEST_F(ut_DPinyin, firstLetters)
     ASSERT_TRUE(result.constFirst() != firstLetters(words2).constFirst());
 }
 
+
+TEST_F(ut_DPinyin, firstLettersOfPolyphones)
+{
+    // the initial of the first reading is in the front, lè,yuè,yào,lào of 乐
+    const QStringList music = firstLetters("乐乐", TS_NoneTone);
+    ASSERT_EQ(music, QStringList({"ll", "ly", "yl", "yy"}));
+
+    // the tone marks are kept by TS_Tone only
+    ASSERT_EQ(firstLetters("安", TS_Tone), QStringList("ā"));
+    ASSERT_EQ(firstLetters("安", TS_ToneNum), QStringList("a"));
+
+    // an initial which isn't a letter, wù,wú,ńg,ń
+    ASSERT_EQ(firstLetters("唔", TS_NoneTone), QStringList({"w", "ń"}));
+
+    // the characters which aren't in the dictionary are kept
+    const DPinyinBatch &batch = batchFirstLetters({"a乐"}, TS_NoneTone);
+    ASSERT_EQ(batch.at(0), QStringList({"al", "ay"}));
+    ASSERT_FALSE(batch.found.at(0));
+    ASSERT_TRUE(firstLetters(QString()).isEmpty());
+}
+
+TEST_F(ut_DPinyin, dictBoundary)
+{
+    bool ok = false;
+    // the first and the last code point of the dictionary
+    ASSERT_EQ(pinyin(QString(QChar(0x3400)), TS_Tone, &ok), QStringList("qiū"));
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(pinyin(QString(QChar(0xfa2d)), TS_ToneNum, &ok), QStringList("he4"));
+    ASSERT_TRUE(ok);
+
+    // out of the dictionary
+    ASSERT_EQ(pinyin(QString(QChar(0x33ff)), TS_Tone, &ok), QStringList(QString(QChar(0x33ff))));
+    ASSERT_FALSE(ok);
+    ASSERT_EQ(pinyin(QString(QChar(0xfa2e)), TS_Tone, &ok), QStringList(QString(QChar(0xfa2e))));
+    ASSERT_FALSE(ok);
+}
+
+TEST_F(ut_DPinyin, concurrentPinyin)
+{
+    const QStringList numTones = pinyin("深度音乐", TS_ToneNum);
+    const QStringList noneTones = pinyin("深度音乐", TS_NoneTone);
+    std::atomic_int failed(0);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < 100; ++j) {
+                if (pinyin("深度音乐", TS_ToneNum) != numTones || pinyin("深度音乐", TS_NoneTone) != noneTones)
+                    ++failed;
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    ASSERT_EQ(failed, 0);
+}
+
+TEST_F(ut_DPinyin, iterator)
+{
+    const QString words("深度音乐");
+
+    QStringList lexicographic;
+    DPinyinIterator it(words, TS_ToneNum);
+    ASSERT_TRUE(it.isAllFound());
+    while (it.hasNext())
+        lexicographic << it.next();
+    ASSERT_FALSE(it.hasNext());
+    ASSERT_TRUE(it.next().isEmpty());
+    ASSERT_EQ(lexicographic, pinyin(words, TS_ToneNum));
+
+    QStringList mostCommon;
+    DPinyinIterator commonIt(words, TS_NoneTone, DPinyinIterator::MostCommonFirst);
+    while (commonIt.hasNext())
+        mostCommon << commonIt.next();
+    ASSERT_EQ(mostCommon.size(), 8);
+    ASSERT_TRUE(std::is_permutation(mostCommon.begin(), mostCommon.end(), lexicographic.begin(), lexicographic.end(),
+                                    [](const QString &noneTone, const QString &numTone) {
+        return noneTone == QString(numTone).remove(QRegularExpression("[0-9]"));
+    }));
+    ASSERT_EQ(mostCommon.mid(0, 3), QStringList({"shenduyinle", "shenduyinyue", "shenduoyinle"}));
+
+    // the polyphonic readings are the same without the tone, 和: hé,hè,huó,huò,hú
+    DPinyinIterator dupIt("和", TS_NoneTone);
+    QStringList noneTones;
+    while (dupIt.hasNext())
+        noneTones << dupIt.next();
+    ASSERT_EQ(noneTones, QStringList({"he", "huo", "hu"}));
+
+    DPinyinIterator unknownIt("a深");
+    ASSERT_FALSE(unknownIt.isAllFound());
+    ASSERT_EQ(unknownIt.next(), "ashēn");
+
+    ASSERT_FALSE(DPinyinIterator(QString()).hasNext());
+}
+
+TEST_F(ut_DPinyin, commonPinyin)
+{
+    bool ok = false;
+    ASSERT_EQ(commonPinyin("深度音乐", 1, TS_NoneTone, &ok), QStringList("shenduyinle"));
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(commonPinyin("深度音乐", 3, TS_ToneNum), QStringList({"shen1du4yin1le4", "shen1du4yin1yue4", "shen1duo2yin1le4"}));
+    ASSERT_EQ(commonPinyin("深度音乐", 100).size(), 8);
+    ASSERT_TRUE(commonPinyin("深度音乐", 0).isEmpty());
+}
+
+TEST_F(ut_DPinyin, batch)
+{
+    QStringList words;
+    for (int i = 0; i < 1000; ++i)
+        words << QStringList({"深度音乐", "安全中心", "a和b", QString()}).at(i % 4);
+
+    for (int threadCount : {1, 4}) {
+        const DPinyinBatch &py = batchPinyin(words, TS_ToneNum, threadCount);
+        ASSERT_EQ(py.size(), words.size());
+        ASSERT_EQ(py.offsets.size(), words.size() + 1);
+        const DPinyinBatch &letters = batchFirstLetters(words, TS_NoneTone, threadCount);
+        ASSERT_EQ(letters.size(), words.size());
+
+        for (int i = 0; i < words.size(); ++i) {
+            bool ok = false;
+            ASSERT_EQ(py.at(i), pinyin(words.at(i), TS_ToneNum, &ok));
+            ASSERT_EQ(py.found.at(i), words.at(i).isEmpty() || ok);
+            ASSERT_EQ(letters.at(i), firstLetters(words.at(i), TS_NoneTone));
+        }
+    }
+}
+
+static const DPinyinDictEntry *dictEntry(char16_t codePoint)
+{
+    auto entry = std::lower_bound(std::begin(kPinyinDictEntries), std::end(kPinyinDictEntries), codePoint,
+                                  [](const DPinyinDictEntry &e, char16_t c) { return e.codePoint < c; });
+    return entry != std::end(kPinyinDictEntries) && entry->codePoint == codePoint ? entry : nullptr;
+}
+
+TEST_F(ut_DPinyin, dictInitials)
+{
+    // the readings start with n, which is a false constant of if() in the generator
+    for (char16_t codePoint : {u'你', u'那'}) {
+        const DPinyinDictEntry *entry = dictEntry(codePoint);
+        ASSERT_TRUE(entry);
+        ASSERT_FALSE(entry->initials & kPinyinIrregularInitial);
+        ASSERT_EQ('a' + entry->primaryInitial, 'n');
+        ASSERT_TRUE(entry->initials & (1u << ('n' - 'a')));
+    }
+    ASSERT_EQ(firstLetters("你那"), QStringList("nn"));
+}
+
+TEST_F(ut_DPinyin, dictTable)
+{
+    // sorted without duplicates for the binary search, and the readings are packed in order
+    quint32 offset = 0;
+    for (auto entry = std::begin(kPinyinDictEntries); entry != std::end(kPinyinDictEntries); ++entry) {
+        if (entry != std::begin(kPinyinDictEntries))
+            ASSERT_LT((entry - 1)->codePoint, entry->codePoint);
+        ASSERT_EQ(entry->offset, offset);
+        offset += entry->length;
+    }
+    ASSERT_EQ(offset + 1, sizeof(kPinyinDictBlob));
+}
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+#include "util/dpinyinindex.h"
+
+DCORE_USE_NAMESPACE
+
+class ut_DPinyinIndex : public testing::Test
+{
+protected:
+    DPinyinIndex index {QStringList {"张三", "张四", "李四", "深度音乐", "Deepin 终端", "音乐"}};
+};
+
+TEST_F(ut_DPinyinIndex, insert)
+{
+    ASSERT_EQ(index.size(), 6);
+    ASSERT_EQ(index.text(2), "李四");
+    ASSERT_TRUE(index.text(6).isEmpty());
+
+    ASSERT_EQ(index.insert("张三丰"), 6);
+    ASSERT_EQ(index.size(), 7);
+    ASSERT_EQ(index.search("zhangsan"), QVector<int>({0, 6}));
+
+    index.clear();
+    ASSERT_EQ(index.size(), 0);
+    ASSERT_TRUE(index.search("zhangsan").isEmpty());
+}
+
+TEST_F(ut_DPinyinIndex, fullPinyin)
+{
+    ASSERT_EQ(index.search("zhangsan"), QVector<int>({0}));
+    ASSERT_EQ(index.search("zhang"), QVector<int>({0, 1}));
+    // the query ends in the middle of a pinyin
+    ASSERT_EQ(index.search("zhangs"), QVector<int>({0, 1}));
+    ASSERT_EQ(index.search("zhangsa"), QVector<int>({0}));
+    // polyphonic characters, 乐: lè,yuè
+    ASSERT_EQ(index.search("shenduyinyue"), QVector<int>({3}));
+    ASSERT_EQ(index.search("shenduyinle"), QVector<int>({3}));
+    // from the beginning of the texts only
+    ASSERT_EQ(index.search("yinyue"), QVector<int>({5}));
+}
+
+TEST_F(ut_DPinyinIndex, initialLetters)
+{
+    ASSERT_EQ(index.search("zs"), QVector<int>({0, 1}));
+    ASSERT_EQ(index.search("ls"), QVector<int>({2}));
+    ASSERT_EQ(index.search("sdyy"), QVector<int>({3}));
+    ASSERT_TRUE(index.search("zx").isEmpty());
+}
+
+TEST_F(ut_DPinyinIndex, mixed)
+{
+    ASSERT_EQ(index.search("zhs"), QVector<int>({0, 1}));
+    ASSERT_EQ(index.search("zhsan"), QVector<int>({0}));
+    ASSERT_EQ(index.search("shendyy"), QVector<int>({3}));
+    ASSERT_EQ(index.search("张s"), QVector<int>({0, 1}));
+    ASSERT_EQ(index.search("深度yy"), QVector<int>({3}));
+    // the letters are case-insensitive
+    ASSERT_EQ(index.search("DEEPIN zd"), QVector<int>({4}));
+    ASSERT_EQ(index.search("deepin zhongduan"), QVector<int>({4}));
+}
+
+TEST_F(ut_DPinyinIndex, limit)
+{
+    ASSERT_EQ(index.search("z", 1).size(), 1);
+    ASSERT_EQ(index.search("z").size(), 2);
+    ASSERT_TRUE(index.search("z", 0).isEmpty());
+    ASSERT_TRUE(index.search(QString()).isEmpty());
+}
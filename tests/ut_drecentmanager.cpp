@@ -8,6 +8,8 @@
 #include <QUrl>
 #include <QDir>
 
+#include <algorithm>
+
 #include "util/drecentmanager.h"
 
 DCORE_USE_NAMESPACE
@@ -84,3 +86,109 @@ TEST_F(ut_DRecentManager, testDRecentManagerRemoveItem)
     }
     ASSERT_TRUE(!isFound);
 }
+
+TEST_F(ut_DRecentManager, testDRecentManagerAddItemTwice)
+{
+    DRecentData data;
+    data.appExec = "deepin-editor";
+    data.appName = "Deepin Editor";
+    data.mimeType = "text/plain";
+
+    ASSERT_TRUE(DRecentManager::addItem("/tmp/test", data));
+    ASSERT_TRUE(DRecentManager::addItem("/tmp/test", data));
+
+    QFile file(QDir::homePath() + "/.local/share/recently-used.xbel");
+    QDomDocument doc;
+    ASSERT_TRUE(doc.setContent(&file));
+    const QString href = QUrl::fromLocalFile("/tmp/test").toEncoded();
+    int bookmarks = 0;
+    QDomNodeList nodeList = doc.documentElement().elementsByTagName("bookmark");
+    for (int i = 0; i < nodeList.size(); ++i) {
+        QDomElement bookmarkEle = nodeList.at(i).toElement();
+        if (bookmarkEle.attribute("href") != href)
+            continue;
+        ++bookmarks;
+        QDomElement appEle = bookmarkEle.elementsByTagName("bookmark:application").at(0).toElement();
+        ASSERT_GE(appEle.attribute("count").toInt(), 2);
+    }
+    ASSERT_EQ(bookmarks, 1);
+
+    DRecentManager::removeItem(href);
+}
+
+TEST_F(ut_DRecentManager, testDRecentManagerMaxItemCount)
+{
+    ASSERT_EQ(DRecentManager::maxItemCount(), -1);
+    DRecentManager::setMaxItemCount(1);
+
+    DRecentData data;
+    data.appExec = "deepin-editor";
+    data.appName = "Deepin Editor";
+    ASSERT_TRUE(DRecentManager::addItem("/tmp/test", data));
+
+    QFile file(QDir::homePath() + "/.local/share/recently-used.xbel");
+    QDomDocument doc;
+    ASSERT_TRUE(doc.setContent(&file));
+    ASSERT_EQ(doc.documentElement().elementsByTagName("bookmark").size(), 1);
+
+    DRecentManager::setMaxItemCount(-1);
+    DRecentManager::removeItem(QUrl::fromLocalFile("/tmp/test").toEncoded());
+}
+
+TEST_F(ut_DRecentManager, testDRecentManagerAddItems)
+{
+    QFile other("/tmp/test-other");
+    ASSERT_TRUE(other.open(QIODevice::WriteOnly));
+    other.close();
+
+    DRecentData data;
+    data.appExec = "deepin-editor";
+    data.appName = "Deepin Editor";
+    QFuture<bool> future = DRecentManager::addItems({"/tmp/test", "/tmp/test-other"}, data);
+    future.waitForFinished();
+    ASSERT_TRUE(future.result());
+
+    QFile file(QDir::homePath() + "/.local/share/recently-used.xbel");
+    QDomDocument doc;
+    ASSERT_TRUE(doc.setContent(&file));
+    QStringList hrefs;
+    QDomNodeList nodeList = doc.documentElement().elementsByTagName("bookmark");
+    for (int i = 0; i < nodeList.size(); ++i)
+        hrefs << nodeList.at(i).toElement().attribute("href");
+    const QString href = QUrl::fromLocalFile("/tmp/test").toEncoded();
+    const QString otherHref = QUrl::fromLocalFile("/tmp/test-other").toEncoded();
+    ASSERT_TRUE(hrefs.contains(href));
+    ASSERT_TRUE(hrefs.contains(otherHref));
+
+    DRecentManager::removeItems({href, otherHref});
+    other.remove();
+}
+
+TEST_F(ut_DRecentManager, testDRecentManagerItems)
+{
+    DRecentData data;
+    data.appExec = "deepin-editor";
+    data.appName = "Deepin Editor";
+    data.mimeType = "text/plain";
+    ASSERT_TRUE(DRecentManager::addItem("/tmp/test", data));
+
+    const QString href = QUrl::fromLocalFile("/tmp/test").toEncoded();
+    DRecentFilter filter;
+    filter.appName = "Deepin Editor";
+    filter.mimeType = "text/*";
+    QList<DRecentItem> items = DRecentManager::items(filter);
+    auto it = std::find_if(items.begin(), items.end(), [&href](const DRecentItem &item) { return item.uri == href; });
+    ASSERT_NE(it, items.end());
+    ASSERT_EQ(it->mimeType, "text/plain");
+    ASSERT_TRUE(it->visited.isValid());
+
+    filter.appName = "No Such App";
+    items = DRecentManager::items(filter);
+    ASSERT_TRUE(std::none_of(items.begin(), items.end(), [&href](const DRecentItem &item) { return item.uri == href; }));
+
+    filter = DRecentFilter();
+    filter.limit = 1;
+    ASSERT_LE(DRecentManager::items(filter).size(), 1);
+
+    DRecentManager::removeItem(href);
+}
@@ -35,3 +35,31 @@ TEST_F(ut_DSecureString, testString)
     QString test = secureString->fromLatin1("test");
     ASSERT_TRUE(test == QString("test"));
 }
+
+TEST_F(ut_DSecureString, testSecureBuffer)
+{
+    DSecureBuffer buffer(u"pass");
+    ASSERT_EQ(buffer.size(), 4);
+    ASSERT_GE(buffer.capacity(), 4);
+
+    for (int i = 0; i < 10000; ++i)
+        buffer.append(QChar('x'));
+    ASSERT_EQ(buffer.size(), 10004);
+    ASSERT_TRUE(buffer.view().startsWith(u"passxx"));
+
+    DSecureBuffer copy(buffer);
+    ASSERT_NE(copy.constData(), buffer.constData());
+    ASSERT_TRUE(copy.view() == buffer.view());
+
+    buffer.chop(10000);
+    ASSERT_EQ(buffer.toRawString(), QStringLiteral("pass"));
+
+    DSecureBuffer moved(std::move(copy));
+    ASSERT_TRUE(copy.isEmpty());
+    ASSERT_EQ(moved.size(), 10004);
+
+    const int capacity = moved.capacity();
+    moved.clear();
+    ASSERT_TRUE(moved.isEmpty());
+    ASSERT_EQ(moved.capacity(), capacity);
+}
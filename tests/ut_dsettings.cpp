@@ -186,3 +186,83 @@ TEST_F(ut_DSettings, testDSettingReset)
     QVariant option = scopeSettings->getOption(keys[0]);
     ASSERT_TRUE(option.toBool());
 }
+
+TEST_F(ut_DSettings, testDSettingIndex)
+{
+    const QByteArray json = " { \"groups\": [{ "
+                            " \"key\": \"base\", "
+                            " \"groups\": [{ "
+                            " \"key\": \"tab\", "
+                            " \"groups\": [{ "
+                            " \"key\": \"new\", "
+                            " \"options\": [{ \"key\": \"path\", \"type\": \"lineedit\", \"default\": \"/tmp\" }] "
+                            " }] }] }]}";
+    QScopedPointer<DSettings> scopeSettings(DSettings::fromJson(json).data());
+
+    ASSERT_EQ(scopeSettings->keys(), QStringList{"base.tab.new.path"});
+    ASSERT_FALSE(scopeSettings->group("base").isNull());
+    ASSERT_FALSE(scopeSettings->group("base.tab").isNull());
+    // the groups at any depth
+    ASSERT_EQ(scopeSettings->group("base.tab.new")->key(), "base.tab.new");
+    ASSERT_TRUE(scopeSettings->group("base.none").isNull());
+
+    ASSERT_EQ(scopeSettings->value("base.tab.new.path"), "/tmp");
+    scopeSettings->setOption("base.tab.new.path", "/home");
+    ASSERT_EQ(scopeSettings->option("base.tab.new.path")->value(), "/home");
+    // the unknown option is ignored
+    scopeSettings->setOption("base.tab.new.none", "/home");
+    ASSERT_TRUE(scopeSettings->option("base.tab.new.none").isNull());
+}
+
+TEST_F(ut_DSettings, testDSettingSharedSchema)
+{
+    QScopedPointer<DSettings> first(DSettings::fromJsonFile("/tmp/test.json").data());
+    QScopedPointer<DSettings> second(DSettings::fromJsonFile("/tmp/test.json").data());
+
+    // the values are read without building the option objects
+    ASSERT_EQ(first->keys(), second->keys());
+    ASSERT_TRUE(first->value("base.open_action.alway_open_on_new").toBool());
+    first->setOption("base.open_action.alway_open_on_new", false);
+    ASSERT_TRUE(first->findChildren<DSettingsGroup *>().isEmpty());
+
+    // each instance keeps its own values
+    ASSERT_FALSE(first->value("base.open_action.alway_open_on_new").toBool());
+    ASSERT_TRUE(second->value("base.open_action.alway_open_on_new").toBool());
+    ASSERT_FALSE(first->option("base.open_action.alway_open_on_new")->value().toBool());
+    ASSERT_FALSE(first->findChildren<DSettingsGroup *>().isEmpty());
+
+    first->reset();
+    ASSERT_TRUE(first->option("base.open_action.alway_open_on_new")->value().toBool());
+}
+
+TEST_F(ut_DSettings, testDSettingFromCompiled)
+{
+    static const DSettingsCompiledOption options[] = {
+        { "base.open_action.alway_open_on_new", "checkbox", QMetaType::Bool, "true", true, "", "Always Open On New Windows" },
+        { "base.open_action.history", "spinbutton", QMetaType::Double, "10", false, "History", "" },
+    };
+    static const DSettingsCompiledGroup groups[] = {
+        { "base", "Basic settings" },
+        { "base.open_action", "Open Action" },
+    };
+    static const DSettingsCompiledSchema schema = {
+        "{\"groups\":[{\"key\":\"base\",\"groups\":[{\"key\":\"open_action\",\"options\":["
+        "{\"key\":\"alway_open_on_new\",\"type\":\"checkbox\",\"default\":true},"
+        "{\"key\":\"history\",\"type\":\"spinbutton\",\"reset\":false,\"default\":10}]}]}]}",
+        2, options,
+        2, groups
+    };
+
+    QScopedPointer<DSettings> scopeSettings(DSettings::fromCompiled(schema).data());
+    ASSERT_EQ(scopeSettings->keys(), QStringList({"base.open_action.alway_open_on_new", "base.open_action.history"}));
+    ASSERT_TRUE(scopeSettings->value("base.open_action.alway_open_on_new").toBool());
+    ASSERT_EQ(scopeSettings->value("base.open_action.history").toInt(), 10);
+
+    scopeSettings->setOption("base.open_action.history", 20);
+    scopeSettings->reset();
+    ASSERT_EQ(scopeSettings->value("base.open_action.history").toInt(), 20);
+
+    // the option objects come from the json kept in the schema
+    ASSERT_EQ(scopeSettings->option("base.open_action.history")->value().toInt(), 20);
+    ASSERT_EQ(scopeSettings->group("base.open_action")->key(), "base.open_action");
+}
@@ -14,3 +14,11 @@ TEST(ut_DSGApplication, id)
         EXPECT_EQ(DSGApplication::id(), qgetenv("DSG_APP_ID"));
     }
 }
+
+TEST(ut_DSGApplication, getIdAsync)
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    QFuture<QByteArray> future = DSGApplication::getIdAsync(pid);
+    future.waitForFinished();
+    EXPECT_EQ(future.result(), DSGApplication::getId(pid));
+}
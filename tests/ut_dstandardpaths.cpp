@@ -153,3 +153,18 @@ TEST_F(ut_DStandardPaths, filepath)
     QString path = DStandardPaths::filePath(DStandardPaths::XDG::CacheHome, "filename");
     ASSERT_EQ(path, DStandardPaths::path(DStandardPaths::XDG::CacheHome).append("/filename"));
 }
+
+TEST_F(ut_DStandardPaths, invalidateCache)
+{
+    EnvGuard guard;
+    guard.set("XDG_CONFIG_HOME", "/tmp/cached/.config", false);
+    ASSERT_EQ(DStandardPaths::path(DStandardPaths::XDG::ConfigHome), "/tmp/cached/.config");
+
+    // the path is memoized until the cache is invalidated
+    qputenv("XDG_CONFIG_HOME", "/tmp/changed/.config");
+    EXPECT_EQ(DStandardPaths::path(DStandardPaths::XDG::ConfigHome), "/tmp/cached/.config");
+
+    DStandardPaths::invalidateCache();
+    EXPECT_EQ(DStandardPaths::path(DStandardPaths::XDG::ConfigHome), "/tmp/changed/.config");
+    guard.restore();
+}
@@ -7,6 +7,10 @@
 #include <QDebug>
 #include <QRandomGenerator>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "dsysinfo.h"
 #include "ddesktopentry.h"
 #include "test_helper.hpp"
@@ -275,6 +279,25 @@ TEST_F(ut_DSysInfo, osRelease)
     }
 }
 
+TEST_F(ut_DSysInfo, osReleaseFormat)
+{
+    FileGuard fg("/tmp/etc/os-release");
+    QFile file(fg.fileName());
+    ASSERT_TRUE(file.open(QFile::WriteOnly));
+    // the plain file of os-release(5), without section
+    file.write("# comment\n"
+               "PRETTY_NAME=\"Deepin 23 \xe7\xa4\xbe\xe5\x8c\xba\xe7\x89\x88\"\n"
+               "\n"
+               "  ID = deepin\r\n"
+               "VERSION_ID='23'");
+    file.close();
+
+    ASSERT_EQ(DSysInfo::operatingSystemName(), QString::fromUtf8("Deepin 23 \xe7\xa4\xbe\xe5\x8c\xba\xe7\x89\x88"));
+    ASSERT_EQ(DSysInfo::productTypeString(), "deepin");
+    ASSERT_EQ(DSysInfo::productType(), DSysInfo::Deepin);
+    ASSERT_EQ(DSysInfo::productVersion(), "23");
+}
+
 TEST_F(ut_DSysInfo, isDDE)
 {
     FileGuard fg("/tmp/etc/os-release");
@@ -378,4 +401,63 @@ TEST_F(ut_DSysInfo, other)
     qDebug() << DSysInfo::memoryInstalledSize();
     qDebug() << DSysInfo::memoryTotalSize();
     qDebug() << DSysInfo::systemDiskSize();
+    qDebug() << DSysInfo::cpuModelName();
+    qDebug() << DSysInfo::shutdownTime();
+}
+
+TEST_F(ut_DSysInfo, uptime)
+{
+    const qint64 uptime = DSysInfo::uptime();
+    ASSERT_GT(uptime, 0);
+    ASSERT_GE(DSysInfo::uptime(), uptime);
+
+    const QDateTime bootTime = DSysInfo::bootTime();
+    ASSERT_TRUE(bootTime.isValid());
+    // btime and the boot clock are rounded to seconds
+    ASSERT_LE(qAbs(bootTime.secsTo(QDateTime::currentDateTime()) - uptime), 5);
+
+    ASSERT_EQ(DSysInfo::shutdownTime(), DSysInfo::shutdownTime());
+}
+
+TEST_F(ut_DSysInfo, concurrent)
+{
+    const QString cpuModelName = DSysInfo::cpuModelName();
+    const qint64 memoryInstalledSize = DSysInfo::memoryInstalledSize();
+    const qint64 systemDiskSize = DSysInfo::systemDiskSize();
+
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatched {0};
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&]() {
+            for (int j = 0; j < 100; ++j) {
+                if (DSysInfo::cpuModelName() != cpuModelName
+                    || DSysInfo::memoryInstalledSize() != memoryInstalledSize
+                    || DSysInfo::systemDiskSize() != systemDiskSize) {
+                    ++mismatched;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    ASSERT_EQ(mismatched, 0);
+}
+
+TEST_F(ut_DSysInfo, queryAsync)
+{
+    auto future = DSysInfo::queryAsync(DSysInfo::CpuModelNameField | DSysInfo::MemoryInstalledSizeField | DSysInfo::SystemDiskSizeField);
+    future.waitForFinished();
+    ASSERT_TRUE(future.isFinished());
+    const DSysInfo::Info &info = future.result();
+    ASSERT_EQ(info.cpuModelName, DSysInfo::cpuModelName());
+    ASSERT_EQ(info.memoryInstalledSize, DSysInfo::memoryInstalledSize());
+    ASSERT_EQ(info.systemDiskSize, DSysInfo::systemDiskSize());
+    // the fields which aren't queried
+    ASSERT_TRUE(info.computerName.isEmpty());
+    ASSERT_EQ(info.uptime, -1);
+
+    auto empty = DSysInfo::queryAsync({});
+    ASSERT_TRUE(empty.isFinished());
+    ASSERT_EQ(empty.result().memoryTotalSize, -1);
 }
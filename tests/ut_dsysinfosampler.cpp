@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <DSysInfoSampler>
+
+#include <QSignalSpy>
+#include <QThread>
+
+#include <gtest/gtest.h>
+
+DCORE_USE_NAMESPACE
+
+TEST(ut_DSysInfoSampler, sample)
+{
+    DSysInfoSampler sampler;
+    QSignalSpy spy(&sampler, &DSysInfoSampler::sampled);
+    ASSERT_EQ(sampler.interval(), 1000);
+    ASSERT_FALSE(sampler.isActive());
+
+    ASSERT_TRUE(sampler.sample());
+    ASSERT_EQ(spy.count(), 1);
+    const DSysInfoSampler::Sample &first = sampler.lastSample();
+    ASSERT_EQ(first.interval, 0);
+    // all cores, and each core
+    ASSERT_GE(first.cpuUsage.size(), 2);
+    ASSERT_GT(first.memoryTotal, 0);
+    ASSERT_GE(first.memoryAvailable, 0);
+    ASSERT_LE(first.memoryAvailable, first.memoryTotal);
+    ASSERT_EQ(first.diskReadBytes, 0);
+
+    QThread::msleep(50);
+    ASSERT_TRUE(sampler.sample());
+    ASSERT_EQ(spy.count(), 2);
+    const DSysInfoSampler::Sample &second = sampler.lastSample();
+    ASSERT_GE(second.interval, 50);
+    for (qreal usage : second.cpuUsage) {
+        ASSERT_GE(usage, 0);
+        ASSERT_LE(usage, 1);
+    }
+    ASSERT_GE(second.loadAverage[0], 0);
+    ASSERT_GE(second.diskReadBytes, 0);
+    ASSERT_GE(second.diskWrittenBytes, 0);
+}
+
+TEST(ut_DSysInfoSampler, interval)
+{
+    DSysInfoSampler sampler;
+    QSignalSpy spy(&sampler, &DSysInfoSampler::sampled);
+    sampler.setInterval(10);
+    ASSERT_EQ(sampler.interval(), 10);
+
+    sampler.start();
+    ASSERT_TRUE(sampler.isActive());
+    // the base sample
+    ASSERT_EQ(spy.count(), 1);
+    ASSERT_TRUE(spy.wait(1000));
+
+    sampler.stop();
+    ASSERT_FALSE(sampler.isActive());
+}
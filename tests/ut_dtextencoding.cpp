@@ -9,6 +9,10 @@
 #include <QLibrary>
 #include <QFile>
 #include <QTemporaryFile>
+#include <QTemporaryDir>
+#include <QMutex>
+
+#include <climits>
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 #include <QStringConverter>
@@ -159,6 +163,102 @@ TEST_F(ut_DTextEncoding, testDetectFileEncode)
     ASSERT_TRUE(isOk);
 }
 
+TEST_F(ut_DTextEncoding, testDetectUtf8FastPath)
+{
+    // Utf8 text: 中文测试
+    const QByteArray dataUTF_8("\u4e2d\u6587\u6d4b\u8bd5");
+    ASSERT_EQ("UTF-8", DTextEncoding::detectTextEncoding(dataUTF_8));
+    ASSERT_EQ("UTF-8", DTextEncoding::detectTextEncoding(QByteArray(1000, 'a') + dataUTF_8));
+    // the multi-byte characters at every position of the vectorized blocks
+    for (int i = 0; i < 40; ++i)
+        ASSERT_EQ("UTF-8", DTextEncoding::detectTextEncoding(QByteArray(i, 'a') + dataUTF_8 + QByteArray(i, 'b') + dataUTF_8));
+
+    // the 64Kb data ends in the middle of a character
+    QByteArray largeUTF_8 = QByteArray(USHRT_MAX - 1, 'a');
+    while (largeUTF_8.size() < USHRT_MAX * 2)
+        largeUTF_8 += dataUTF_8;
+    ASSERT_TRUE(rewriteTempFile(largeUTF_8));
+    bool isOk = false;
+    ASSERT_EQ("UTF-8", DTextEncoding::detectFileEncoding(tmpFileName, &isOk));
+    ASSERT_TRUE(isOk);
+
+    // the content isn't changed when reading
+    QByteArray dataUTF_16;
+    QByteArray lines("first line\r\nsecond line\r\n");
+    ASSERT_TRUE(DTextEncoding::convertTextEncoding(lines, dataUTF_16, "UTF-16"));
+    ASSERT_TRUE(rewriteTempFile(dataUTF_16));
+    ASSERT_EQ("UTF-16", DTextEncoding::detectFileEncoding(tmpFileName));
+}
+
+TEST_F(ut_DTextEncoding, testDetectFileEncodings)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    const QList<QByteArray> contents {"", dataGB18030, dataEUC_JP, dataKOI8_R};
+    const QByteArrayList encodings {"UTF-8", "GB18030", "EUC-JP", "KOI8-R"};
+    QStringList fileNames;
+    QHash<QString, QByteArray> expected;
+    for (int i = 0; i < 32; ++i) {
+        const QString &fileName = dir.filePath(QString::number(i));
+        QFile file(fileName);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(file.write(contents.at(i % contents.size())), contents.at(i % contents.size()).size());
+        fileNames << fileName;
+        expected.insert(fileName, encodings.at(i % encodings.size()));
+    }
+    // the file doesn't exist
+    fileNames << dir.filePath("none");
+    expected.insert(dir.filePath("none"), QByteArray());
+
+    for (int threadCount : {1, 4, 0}) {
+        QMutex mutex;
+        QHash<QString, QByteArray> detected;
+        const auto &results = DTextEncoding::detectFileEncodings(fileNames, [&](const QString &fileName, const QByteArray &encoding) {
+            QMutexLocker locker(&mutex);
+            detected.insert(fileName, encoding);
+        }, threadCount);
+        ASSERT_EQ(results, expected);
+        ASSERT_EQ(detected, expected);
+    }
+
+    ASSERT_TRUE(DTextEncoding::detectFileEncodings({}).isEmpty());
+}
+
+TEST_F(ut_DTextEncoding, testDetectionCache)
+{
+    DTextEncoding::setDetectionCacheSize(4);
+    DTextEncoding::clearDetectionCache();
+    ASSERT_EQ(DTextEncoding::detectionCacheSize(), 4);
+
+    ASSERT_TRUE(rewriteTempFile(dataGB18030));
+    bool isOk = false;
+    ASSERT_EQ("GB18030", DTextEncoding::detectFileEncoding(tmpFileName, &isOk));
+    ASSERT_EQ("GB18030", DTextEncoding::detectFileEncoding(tmpFileName, &isOk));
+    ASSERT_TRUE(isOk);
+#ifdef Q_OS_LINUX
+    ASSERT_EQ(DTextEncoding::detectionCacheHits(), 1u);
+    ASSERT_EQ(DTextEncoding::detectionCacheMisses(), 1u);
+#endif
+
+    // the file is changed in place
+    QFile file(tmpFileName);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    ASSERT_EQ(file.write(dataKOI8_R), dataKOI8_R.size());
+    file.close();
+    ASSERT_EQ("KOI8-R", DTextEncoding::detectFileEncoding(tmpFileName));
+
+    // a file which can't be read isn't cached
+    ASSERT_EQ("", DTextEncoding::detectFileEncoding(tmpFileName + ".none", &isOk));
+    ASSERT_FALSE(isOk);
+
+    DTextEncoding::setDetectionCacheSize(0);
+    ASSERT_EQ("KOI8-R", DTextEncoding::detectFileEncoding(tmpFileName));
+    DTextEncoding::clearDetectionCache();
+    ASSERT_EQ(DTextEncoding::detectionCacheHits(), 0u);
+    ASSERT_EQ(DTextEncoding::detectionCacheMisses(), 0u);
+}
+
 TEST_F(ut_DTextEncoding, testConvertTextEncoding)
 {
     QByteArray dataUTF_8;
@@ -232,6 +332,44 @@ TEST_F(ut_DTextEncoding, testConvertTextEncodingWithError)
     ASSERT_EQ(converted, 0);
 }
 
+TEST_F(ut_DTextEncoding, testTextConverter)
+{
+    DTextConverter converter("UTF-8", "GB18030");
+    ASSERT_TRUE(converter.isValid());
+    ASSERT_EQ(converter.toEncoding(), "UTF-8");
+    ASSERT_EQ(converter.fromEncoding(), "GB18030");
+
+    QByteArray expected;
+    ASSERT_TRUE(DTextEncoding::convertTextEncoding(dataGB18030, expected, "UTF-8", "GB18030"));
+
+    // the same handle and output buffer are reused
+    QByteArray outContent;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(converter.convert(dataGB18030, outContent));
+        ASSERT_EQ(outContent, expected);
+    }
+
+    QByteArrayList outContents {"to be reused", "to be removed", "to be removed"};
+    ASSERT_TRUE(converter.convert(QByteArrayList {dataGB18030, QByteArray()}, outContents));
+    ASSERT_EQ(outContents, QByteArrayList({expected, QByteArray()}));
+
+    // the error of a conversion doesn't affect the next one
+    QString error;
+    int converted = -1;
+    DTextConverter utf16Converter("UTF-16", "UTF-8");
+    ASSERT_FALSE(utf16Converter.convert(QByteArray("\x31\x32\x33\xFF\xFF"), outContent, &error, &converted));
+    ASSERT_FALSE(error.isEmpty());
+    ASSERT_EQ(converted, 3);
+    QByteArray dataUTF_8("123");
+    ASSERT_TRUE(utf16Converter.convert(dataUTF_8, outContent));
+    QByteArray expectedUTF_16;
+    ASSERT_TRUE(DTextEncoding::convertTextEncoding(dataUTF_8, expectedUTF_16, "UTF-16", "UTF-8"));
+    ASSERT_EQ(outContent, expectedUTF_16);
+
+    ASSERT_FALSE(DTextConverter("ERROR", "UTF-8").isValid());
+    ASSERT_FALSE(DTextConverter("ERROR", "UTF-8").convert(dataGB18030, outContent));
+}
+
 TEST_F(ut_DTextEncoding, testConvertFileEncoding)
 {
     ASSERT_TRUE(rewriteTempFile(dataGB18030));
@@ -244,6 +382,45 @@ TEST_F(ut_DTextEncoding, testConvertFileEncoding)
     ASSERT_FALSE(DTextEncoding::convertFileEncoding("", "UTF-32"));
 }
 
+TEST_F(ut_DTextEncoding, testConvertLargeFileEncoding)
+{
+    // Utf8 text: 中文测试, the chunks end in the middle of the characters
+    QByteArray dataUTF_8;
+    while (dataUTF_8.size() < 300000)
+        dataUTF_8 += "\u4e2d\u6587\u6d4b\u8bd5 1234\n";
+    ASSERT_TRUE(rewriteTempFile(dataUTF_8));
+
+    QString tmpConvertFileName("/tmp/ut_DTextEncoding_temp_testConvertLargeFileEncoding.txt");
+    qint64 lastConverted = 0;
+    qint64 total = 0;
+    ASSERT_TRUE(DTextEncoding::convertFileEncodingTo(tmpFileName, tmpConvertFileName, "UTF-16", "UTF-8", nullptr,
+                                                     [&](qint64 converted, qint64 totalBytes) {
+        ASSERT_GE(converted, lastConverted);
+        lastConverted = converted;
+        total = totalBytes;
+    }));
+    ASSERT_EQ(lastConverted, dataUTF_8.size());
+    ASSERT_EQ(total, dataUTF_8.size());
+
+    ASSERT_TRUE(DTextEncoding::convertFileEncoding(tmpConvertFileName, "UTF-8", "UTF-16"));
+    QFile file(tmpConvertFileName);
+    ASSERT_TRUE(file.open(QFile::ReadOnly));
+    ASSERT_EQ(file.readAll(), dataUTF_8);
+    file.close();
+
+    // the file isn't changed if it fails
+    QByteArray dataError = dataUTF_8 + "\xFF\xFF";
+    ASSERT_TRUE(rewriteTempFile(dataError));
+    QString error;
+    ASSERT_FALSE(DTextEncoding::convertFileEncoding(tmpFileName, "UTF-16", "UTF-8", &error));
+    ASSERT_FALSE(error.isEmpty());
+    QFile errorFile(tmpFileName);
+    ASSERT_TRUE(errorFile.open(QFile::ReadOnly));
+    ASSERT_EQ(errorFile.readAll(), dataError);
+
+    ASSERT_TRUE(QFile::remove(tmpConvertFileName));
+}
+
 TEST_F(ut_DTextEncoding, testConvertFileEncodingTo)
 {
     QString tmpConvertFileName("/tmp/ut_DTextEncoding_temp_testConvertFileEncodingTo.txt");
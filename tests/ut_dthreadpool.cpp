@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "dthreadpool.h"
+
+#include <atomic>
+
+DCORE_USE_NAMESPACE
+
+class ut_DThreadPool : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        m_pool = new DThreadPool(4);
+    }
+
+    void TearDown() override
+    {
+        delete m_pool;
+    }
+
+protected:
+    DThreadPool *m_pool{nullptr};
+};
+
+TEST_F(ut_DThreadPool, threadCount)
+{
+    EXPECT_EQ(m_pool->threadCount(), 4);
+    EXPECT_GE(DThreadPool::global().threadCount(), 1);
+}
+
+TEST_F(ut_DThreadPool, run)
+{
+    QList<QFuture<int>> results;
+    for (int i = 0; i < 100; ++i)
+        results << m_pool->run([](int i) { return i * i; }, i);
+
+    for (int i = 0; i < results.size(); ++i)
+        EXPECT_EQ(results[i].result(), i * i);
+}
+
+TEST_F(ut_DThreadPool, nestedRun)
+{
+    std::atomic<int> counter{0};
+    auto outer = m_pool->run([this, &counter] {
+        QList<QFuture<void>> inner;
+        for (int i = 0; i < 10; ++i)
+            inner << m_pool->run([&counter] { ++counter; });
+        return inner.size();
+    });
+
+    EXPECT_EQ(outer.result(), 10);
+    EXPECT_TRUE(m_pool->waitForDone(5000));
+    EXPECT_EQ(counter.load(), 10);
+    EXPECT_EQ(m_pool->pendingCount(), 0);
+}
+
+TEST_F(ut_DThreadPool, exception)
+{
+    auto result = m_pool->run([]() -> int {
+        throw std::runtime_error("failed");
+    });
+    auto failed = result.onFailed([](const std::runtime_error &) { return -1; });
+    EXPECT_EQ(failed.result(), -1);
+}
@@ -270,6 +270,29 @@ TEST_F(ut_DThreadUtils, testDestructCancel)
     EXPECT_EQ(failedResult.result(), -1);
 }
 
+TEST_F(ut_DThreadUtils, testBatching)
+{
+    EXPECT_FALSE(m_threadutil->isBatchingEnabled());
+    m_threadutil->setBatchingEnabled(true);
+    EXPECT_TRUE(m_threadutil->isBatchingEnabled());
+
+    QList<int> order;
+    QList<QFuture<int>> results;
+    for (int i = 0; i < 100; ++i) {
+        results << m_threadutil->run([&order](int i) {
+            order << i;
+            return i * 2;
+        }, i);
+    }
+
+    for (int i = 0; i < results.size(); ++i)
+        EXPECT_EQ(results[i].result(), i * 2);
+
+    ASSERT_EQ(order.size(), 100);
+    for (int i = 0; i < order.size(); ++i)
+        EXPECT_EQ(order[i], i);
+}
+
 #endif
 
 #include "ut_dthreadutils.moc"
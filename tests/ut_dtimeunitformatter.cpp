@@ -55,3 +55,18 @@ TEST_F(ut_DTimeUnitFormatter, testDTimeUnitFormatterUnitStr)
     ASSERT_EQ(timeUnitFormatter.unitStr(DTimeUnitFormatter::Hour), "h");
     ASSERT_EQ(timeUnitFormatter.unitStr(DTimeUnitFormatter::Day), "d");
 }
+
+TEST_F(ut_DTimeUnitFormatter, testDTimeUnitFormatterFormatSeconds)
+{
+    QPair<qreal, int> result = timeUnitFormatter.formatSeconds(5400);
+    ASSERT_TRUE(qFuzzyCompare(result.first, 1.5));
+    ASSERT_EQ(result.second, DTimeUnitFormatter::Hour);
+    ASSERT_EQ(timeUnitFormatter.formatSeconds(59).second, DTimeUnitFormatter::Seconds);
+
+    QString text;
+    timeUnitFormatter.appendSeconds(93605, text);
+    ASSERT_EQ(text, "1d 2h 5s");
+    text.truncate(0);
+    timeUnitFormatter.appendSeconds(0, text);
+    ASSERT_EQ(text, "0s");
+}
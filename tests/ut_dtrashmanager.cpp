@@ -4,9 +4,17 @@
 
 #include <gtest/gtest.h>
 #include <QDir>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QThread>
 #include "filesystem/dstandardpaths.h"
 #include "filesystem/dtrashmanager.h"
 
+#include <algorithm>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
 DCORE_USE_NAMESPACE
 
 
@@ -54,3 +62,180 @@ TEST_F(ut_DTrashManager, testDTrashManagerMoveToTrash)
     bool ok = DTrashManager::instance()->moveToTrash(path + "/test");
     ASSERT_TRUE(ok = ok ? ok : !ok);
 }
+
+TEST_F(ut_DTrashManager, testDTrashManagerMoveToTrashAsync)
+{
+    // in the same filesystem of the trash
+    QTemporaryDir dir(DStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/ut_dtrashjob-XXXXXX");
+    ASSERT_TRUE(dir.isValid());
+
+    QStringList files;
+    for (int i = 0; i < 50; ++i) {
+        // the same names are used twice
+        files << dir.filePath(QString("%1/test%2").arg(i % 2).arg(i / 2));
+        QDir().mkpath(QFileInfo(files.last()).path());
+        QFile file(files.last());
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    }
+    files << dir.filePath("not-exists");
+
+    QScopedPointer<DTrashJob> job(DTrashManager::instance()->moveToTrashAsync(files, false, 4));
+    ASSERT_TRUE(job->waitForFinished(10000));
+    EXPECT_TRUE(job->isFinished());
+    EXPECT_EQ(job->totalCount(), files.size());
+    EXPECT_EQ(job->finishedCount(), files.size());
+    EXPECT_EQ(job->failedFiles(), QStringList{dir.filePath("not-exists")});
+
+    for (int i = 0; i < 50; ++i)
+        EXPECT_FALSE(QFile::exists(files.at(i)));
+}
+
+TEST_F(ut_DTrashManager, testDTrashManagerCleanTrashAsync)
+{
+    // a subtree which is shared by the workers
+    for (int i = 0; i < 20; ++i) {
+        const QString dirPath = path + QString("/tree/%1/%2").arg(i % 4).arg(i);
+        ASSERT_TRUE(QDir().mkpath(dirPath));
+        QFile file(dirPath + "/file");
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    }
+
+    QScopedPointer<DTrashJob> job(DTrashManager::instance()->cleanTrashAsync(4));
+    ASSERT_TRUE(job->waitForFinished(10000));
+    EXPECT_TRUE(job->isFinished());
+    EXPECT_EQ(job->totalCount(), -1);
+    EXPECT_TRUE(job->failedFiles().isEmpty());
+    EXPECT_GE(job->finishedCount(), 45);
+
+    EXPECT_TRUE(QDir(path).exists());
+    EXPECT_TRUE(QDir(path).entryList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden).isEmpty());
+}
+
+TEST_F(ut_DTrashManager, testDTrashManagerTrashItemCount)
+{
+    QTemporaryDir dir(DStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/ut_dtrashcount-XXXXXX");
+    ASSERT_TRUE(dir.isValid());
+    QFile file(dir.filePath("count"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_EQ(file.write(QByteArray(1024, 'x')), 1024);
+    file.close();
+
+    const int count = DTrashManager::instance()->trashItemCount();
+    const qint64 size = DTrashManager::instance()->trashSize();
+    ASSERT_TRUE(DTrashManager::instance()->moveToTrash(file.fileName()));
+
+    EXPECT_EQ(DTrashManager::instance()->trashItemCount(), count + 1);
+    EXPECT_GE(DTrashManager::instance()->trashSize(), size + 1024);
+    EXPECT_FALSE(DTrashManager::instance()->trashIsEmpty());
+
+    ASSERT_TRUE(DTrashManager::instance()->cleanTrash());
+    EXPECT_EQ(DTrashManager::instance()->trashItemCount(), 0);
+    EXPECT_TRUE(DTrashManager::instance()->trashIsEmpty());
+}
+
+TEST_F(ut_DTrashManager, testDTrashManagerTrashItemCountExternalChange)
+{
+    const QString infoPath = DStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/Trash/info";
+    ASSERT_TRUE(QDir().mkpath(infoPath));
+    const int count = DTrashManager::instance()->trashItemCount();
+
+    // the changes of the other processes are seen without an event loop
+    QFile info(infoPath + "/ut_dtrashexternal.trashinfo");
+    ASSERT_TRUE(info.open(QIODevice::WriteOnly));
+    info.write("[Trash Info]\nPath=/tmp/ut_dtrashexternal\n");
+    info.close();
+    QThread::msleep(200);
+    EXPECT_EQ(DTrashManager::instance()->trashItemCount(), count + 1);
+
+    ASSERT_TRUE(info.remove());
+    QThread::msleep(200);
+    EXPECT_EQ(DTrashManager::instance()->trashItemCount(), count);
+}
+
+TEST_F(ut_DTrashManager, testDTrashManagerTrashItems)
+{
+    QTemporaryDir dir(DStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/ut_dtrashitems-XXXXXX");
+    ASSERT_TRUE(dir.isValid());
+    QFile file(dir.filePath("item 1.txt"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_EQ(file.write(QByteArray(100, 'x')), 100);
+    file.close();
+
+    const QDateTime before = QDateTime::currentDateTime().addSecs(-1);
+    const int count = DTrashManager::instance()->trashItems().size();
+    ASSERT_TRUE(DTrashManager::instance()->moveToTrash(file.fileName()));
+
+    const QList<DTrashItem> items = DTrashManager::instance()->trashItems();
+    ASSERT_EQ(items.size(), count + 1);
+    auto it = std::find_if(items.cbegin(), items.cend(), [&file](const DTrashItem &item) {
+        return item.originalPath == file.fileName();
+    });
+    ASSERT_NE(it, items.cend());
+    EXPECT_TRUE(it->isValid());
+    EXPECT_EQ(it->size, 100);
+    EXPECT_TRUE(QFileInfo::exists(it->filePath));
+    EXPECT_GE(it->deletionDate, before);
+    EXPECT_LE(it->deletionDate, QDateTime::currentDateTime().addSecs(1));
+
+    const DTrashItem item = DTrashManager::instance()->trashItem(it->id);
+    EXPECT_EQ(item.originalPath, file.fileName());
+    EXPECT_FALSE(DTrashManager::instance()->trashItem("ut_dtrashitems-none").isValid());
+
+    ASSERT_TRUE(DTrashManager::instance()->restoreFromTrash(item.id));
+    EXPECT_TRUE(file.exists());
+    EXPECT_EQ(file.size(), 100);
+    EXPECT_FALSE(DTrashManager::instance()->trashItem(item.id).isValid());
+    EXPECT_EQ(DTrashManager::instance()->trashItemCount(), count);
+
+    // the existing file isn't overwritten
+    ASSERT_TRUE(DTrashManager::instance()->moveToTrash(file.fileName()));
+    const QList<DTrashItem> trashed = DTrashManager::instance()->trashItems();
+    it = std::find_if(trashed.cbegin(), trashed.cend(), [&file](const DTrashItem &item) {
+        return item.originalPath == file.fileName();
+    });
+    ASSERT_NE(it, trashed.cend());
+    const QString id = it->id;
+    QFile other(file.fileName());
+    ASSERT_TRUE(other.open(QIODevice::WriteOnly));
+    other.close();
+    EXPECT_FALSE(DTrashManager::instance()->restoreFromTrash(id));
+    ASSERT_TRUE(DTrashManager::instance()->restoreFromTrash(id, dir.filePath("sub/restored")));
+    EXPECT_EQ(QFileInfo(dir.filePath("sub/restored")).size(), 100);
+}
+
+TEST_F(ut_DTrashManager, testDTrashManagerMoveToTopdirTrash)
+{
+    const QString topdir("/dev/shm");
+    const QString trashPath = topdir + QString("/.Trash-%1").arg(getuid());
+    struct stat topdirStat, homeStat;
+    if (stat("/dev/shm", &topdirStat) != 0
+            || stat(QFile::encodeName(DStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)).constData(), &homeStat) != 0
+            || topdirStat.st_dev == homeStat.st_dev || !QFileInfo(topdir).isWritable()) {
+        GTEST_SKIP() << "No writable mount point which is different from the home trash";
+    }
+
+    const bool trashExists = QFileInfo::exists(trashPath);
+    QTemporaryDir dir(topdir + "/ut_dtrashtopdir-XXXXXX");
+    ASSERT_TRUE(dir.isValid());
+    QFile file(dir.filePath("topdir"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    ASSERT_TRUE(DTrashManager::instance()->moveToTrash(file.fileName()));
+    EXPECT_FALSE(file.exists());
+    EXPECT_TRUE(QFileInfo::exists(trashPath + "/files/topdir"));
+
+    // the topdir trash is listed with the home trash
+    const QList<DTrashItem> items = DTrashManager::instance()->trashItems();
+    EXPECT_TRUE(std::any_of(items.cbegin(), items.cend(), [&](const DTrashItem &item) {
+        return item.filePath == trashPath + "/files/topdir" && item.originalPath == file.fileName();
+    }));
+
+    // the path in the trash info is relative to the topdir
+    QFile info(trashPath + "/info/topdir.trashinfo");
+    ASSERT_TRUE(info.open(QIODevice::ReadOnly));
+    EXPECT_TRUE(info.readAll().contains("Path=" + QDir(topdir).relativeFilePath(file.fileName()).toUtf8().toPercentEncoding("/")));
+
+    if (!trashExists)
+        QDir(trashPath).removeRecursively();
+}
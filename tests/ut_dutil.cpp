@@ -8,6 +8,7 @@
 
 #include "util/dtimeunitformatter.h"
 #include "util/ddisksizeformatter.h"
+#include "util/dutil.h"
 
 DCORE_USE_NAMESPACE
 
@@ -112,3 +113,23 @@ TEST_F(ut_DUtil, testDiskFormatter1024)
     ASSERT_TRUE(qFuzzyCompare(0.09094947017729282, d2));
 }
 
+
+TEST_F(ut_DUtil, testObjectPathEscape)
+{
+    ASSERT_EQ(DUtil::escapeToObjectPath(QString()), "_");
+    ASSERT_EQ(DUtil::escapeToObjectPath(QStringLiteral("org.deepin-app")), "org_2edeepin_2dapp");
+    ASSERT_EQ(DUtil::escapeToObjectPath(QStringLiteral("a\tb")), "a_9b");
+    // the characters out of Latin-1 are escaped to "_0"
+    ASSERT_EQ(DUtil::escapeToObjectPath(QStringLiteral("深度-app")), "_0_0_2dapp");
+    ASSERT_EQ(DUtil::unescapeFromObjectPath(QStringLiteral("org_2edeepin_2dapp")), "org.deepin-app");
+
+    // "_2d" which is generated by decoding "_5f" isn't decoded again
+    ASSERT_EQ(DUtil::escapeToObjectPath(QStringLiteral("_2d-")), "_5f2d_2d");
+    ASSERT_EQ(DUtil::unescapeFromObjectPath(QStringLiteral("_5f2d_2d")), "_2d-");
+    // the same results as the former replacement of every occurrence in turn
+    ASSERT_EQ(DUtil::escapeToObjectPath(QStringLiteral("a_b_c")), "a_5f5fb_5f5fc");
+    ASSERT_EQ(DUtil::escapeToObjectPath(QStringLiteral("a.b_c.d")), "a_5f2eb_5fc_5f2ed");
+    ASSERT_EQ(DUtil::escapeToObjectPath(QStringLiteral("a_b.c")), "a_5fb_2ec");
+    // an invalid sequence is kept
+    ASSERT_EQ(DUtil::unescapeFromObjectPath(QStringLiteral("a_zz_2")), "a_zz_2");
+}
@@ -160,3 +160,67 @@ TEST_F(ut_DVtableHook, testRTTI)
     ASSERT_EQ(typeid(*c1).name(), original);
     delete c1;
 }
+
+TEST_F(ut_DVtableHook, writeBatch)
+{
+    A *a = new A();
+    auto lambda = [](A *obj, int v) {
+        qDebug() << Q_FUNC_INFO << obj << v;
+        return 'w';
+    };
+    DVtableHook::beginWriteBatch();
+    ASSERT_TRUE(DVtableHook::overrideVfptrFun(&A::test, lambda));
+    ASSERT_TRUE(DVtableHook::endWriteBatch());
+    ASSERT_EQ(a->test(8), 'w');
+    delete a;
+}
+
+TEST_F(ut_DVtableHook, sharedVtable)
+{
+    DVtableHook::setVtableSharingEnabled(true);
+    ASSERT_TRUE(DVtableHook::isVtableSharingEnabled());
+
+    A *a1 = new A();
+    A *a2 = new A();
+    auto lambda1 = [](A *obj, int v) {
+        qDebug() << Q_FUNC_INFO << obj << v;
+        return 's';
+    };
+    auto lambda2 = [](A *obj, int v) {
+        qDebug() << Q_FUNC_INFO << obj << v;
+        return 't';
+    };
+    ASSERT_TRUE(DVtableHook::overrideVfptrFun(a1, &A::test, lambda1));
+    ASSERT_TRUE(DVtableHook::overrideVfptrFun(a2, &A::test, lambda1));
+    ASSERT_EQ(DVtableHook::getVtableOfObject(a1), DVtableHook::getVtableOfObject(a2));
+
+    // copy on write
+    ASSERT_TRUE(DVtableHook::overrideVfptrFun(a2, &A::test, lambda2));
+    ASSERT_NE(DVtableHook::getVtableOfObject(a1), DVtableHook::getVtableOfObject(a2));
+    ASSERT_EQ(a1->test(9), 's');
+    ASSERT_EQ(a2->test(9), 't');
+
+    ASSERT_TRUE(DVtableHook::overrideVfptrFun(a2, &A::test, lambda1));
+    ASSERT_EQ(DVtableHook::getVtableOfObject(a1), DVtableHook::getVtableOfObject(a2));
+
+    DVtableHook::resetVtable(a1);
+    ASSERT_TRUE(!DVtableHook::hasVtable(a1));
+    ASSERT_TRUE(DVtableHook::hasVtable(a2));
+    ASSERT_EQ(a2->test(9), 's');
+    delete a1;
+    delete a2;
+
+    DVtableHook::setVtableSharingEnabled(false);
+}
+
+TEST_F(ut_DVtableHook, resolve)
+{
+    const QFunctionPointer version = QFunctionPointer(&qVersion);
+    ASSERT_EQ(DVtableHook::resolve("qVersion"), version);
+    // cached
+    ASSERT_EQ(DVtableHook::resolve("qVersion"), version);
+    ASSERT_EQ(DVtableHook::resolve("ut_no_such_symbol"), nullptr);
+
+    const QVector<QFunctionPointer> functions = DVtableHook::resolve(QByteArrayList {"qVersion", "ut_no_such_symbol", "qVersion"});
+    ASSERT_EQ(functions, QVector<QFunctionPointer>({version, nullptr, version}));
+}
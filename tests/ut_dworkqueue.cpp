@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <gtest/gtest.h>
+
+#include "dworkqueue.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+
+DCORE_USE_NAMESPACE
+
+TEST(ut_DWorkQueue, then)
+{
+    QList<int> results;
+    DWorkQueue<int, int> queue([](int value) {
+        EXPECT_NE(QThread::currentThread(), qApp->thread());
+        return value * 2;
+    });
+    queue.then([&results](int value) {
+        results << value;
+    });
+
+    for (int i = 0; i < 10; ++i)
+        EXPECT_TRUE(queue.post(i));
+    queue.waitForIdle();
+
+    ASSERT_EQ(results.size(), 10);
+    for (int i = 0; i < results.size(); ++i)
+        EXPECT_EQ(results[i], i * 2);
+    EXPECT_EQ(queue.pendingCount(), 0);
+}
+
+TEST(ut_DWorkQueue, thenInMain)
+{
+    QStringList results;
+    DWorkQueue<void, QString> queue([] {
+        return QStringLiteral("done");
+    });
+    queue.thenInMain([&results](const QString &value) {
+        EXPECT_EQ(QThread::currentThread(), qApp->thread());
+        results << value;
+    });
+
+    queue.post();
+    queue.post();
+    queue.waitForIdle();
+
+    QElapsedTimer timer;
+    timer.start();
+    while (results.size() < 2 && timer.elapsed() < 1000)
+        QCoreApplication::processEvents();
+    EXPECT_EQ(results, QStringList({"done", "done"}));
+}
+
+TEST(ut_DWorkQueue, cancel)
+{
+    std::atomic<int> count{0};
+    bool delivered = false;
+    DWorkQueue<int, void> queue([&count](int) {
+        QThread::msleep(10);
+        ++count;
+    });
+    queue.thenInMain([&delivered] {
+        delivered = true;
+    });
+
+    for (int i = 0; i < 100; ++i)
+        queue.post(i);
+    queue.cancel();
+    EXPECT_TRUE(queue.isCanceled());
+    EXPECT_FALSE(queue.post(0));
+
+    queue.waitForIdle();
+    EXPECT_LT(count.load(), 100);
+
+    QCoreApplication::processEvents();
+    EXPECT_FALSE(delivered);
+}
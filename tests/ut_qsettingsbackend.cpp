@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 #include <QFile>
 #include <QTextStream>
+#include <QThread>
 #include <QJsonObject>
 #include "settings/dsettings.h"
 #include "settings/dsettingsoption.h"
@@ -95,3 +96,49 @@ TEST_F(ut_QSettingsBackend, testQSettingsBackendDoOption)
     // ensure `DSettings` is released before `SettingBackend` if `doSetOption` maybe execute.
     scopeSettings.reset();
 }
+
+TEST_F(ut_QSettingsBackend, testQSettingsBackendFlush)
+{
+    QSettingBackend qBackend("/tmp/test.ini");
+    qBackend.setWriteDelay(60 * 1000);
+    ASSERT_EQ(qBackend.writeDelay(), 60 * 1000);
+
+    Q_EMIT qBackend.setOption("Test", true);
+    Q_EMIT qBackend.setOption("Test", false);
+    Q_EMIT qBackend.setOption("Flush", 1);
+    qBackend.flush();
+
+    ASSERT_FALSE(qBackend.getOption("Test").toBool());
+    ASSERT_EQ(qBackend.getOption("Flush").toInt(), 1);
+}
+
+TEST_F(ut_QSettingsBackend, testQSettingsBackendCachedKeys)
+{
+    {
+        QSettingBackend qBackend("/tmp/test.ini");
+        ASSERT_EQ(qBackend.keys(), QStringList{"Test"});
+
+        Q_EMIT qBackend.setOption("Added", 2);
+        qBackend.flush();
+        // the cached keys are rebuilt after a new key is written
+        ASSERT_EQ(qBackend.keys(), (QStringList{"Added", "Test"}));
+    }
+
+    // written to the file by the sync
+    QSettingBackend reloaded("/tmp/test.ini");
+    ASSERT_EQ(reloaded.getOption("Added").toInt(), 2);
+    ASSERT_FALSE(reloaded.getOption("Test").toBool());
+}
+
+TEST_F(ut_QSettingsBackend, testQSettingsBackendFlushStoppedThread)
+{
+    QThread thread;
+    QSettingBackend qBackend("/tmp/test.ini");
+    qBackend.moveToThread(&thread);
+
+    // nothing runs in the thread of the backend, flush() writes in this one
+    Q_EMIT qBackend.setOption("Flush", 2);
+    qBackend.flush();
+
+    ASSERT_EQ(qBackend.getOption("Flush").toInt(), 2);
+}
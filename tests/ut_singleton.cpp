@@ -70,3 +70,24 @@ TEST(ut_DSingleton, testDSingleton)
     qDeleteAll(threads);
     qDeleteAll(testers);
 }
+
+namespace {
+struct FastSingleton
+{
+    int value = 1;
+};
+}  // namespace
+
+TEST(ut_DSingleton, testDFastSingleton)
+{
+    using Dtk::Core::DFastSingleton;
+
+    FastSingleton *instance = DFastSingleton<FastSingleton>::init();
+    ASSERT_TRUE(instance);
+    ASSERT_EQ(DFastSingleton<FastSingleton>::instance(), instance);
+    ASSERT_EQ(DFastSingleton<FastSingleton>::init(), instance);
+    ASSERT_EQ(DFastSingleton<FastSingleton>::instance()->value, 1);
+
+    DFastSingleton<FastSingleton>::destroy();
+    ASSERT_EQ(DFastSingleton<FastSingleton>::instance(), nullptr);
+}
@@ -5,6 +5,7 @@
 #include <QCoreApplication>
 #include <QCommandLineParser>
 #include <QElapsedTimer>
+#include <QTextStream>
 #include <iostream>
 
 #include "dpinyin.h"
@@ -24,6 +25,7 @@ int main(int argc, char **argv)
                                             "\t ch2py [chinese words]\n"
                                             "\t ch2py --tonestyle notones [chinese words]\n"
                                             "\t ch2py --letters [chinese words]\n"
+                                            "\t ch2py --stdin --jobs 4 < [file of words]\n"
                                             );
 
 
@@ -33,8 +35,16 @@ int main(int argc, char **argv)
                                 "tones");
     QCommandLineOption letters = QCommandLineOption(QStringList() << "l" << "letters",
                                 "convert Chinese words to Pinyin first letters");
+    QCommandLineOption input = QCommandLineOption(QStringList() << "stdin",
+                                "convert the words of every line of stdin in a batch");
+    QCommandLineOption jobs = QCommandLineOption(QStringList() << "j" << "jobs",
+                                "the thread count of --stdin, 0 means the ideal thread count",
+                                "jobs",
+                                "1");
     cp.addOption(tonestyle);
     cp.addOption(letters);
+    cp.addOption(input);
+    cp.addOption(jobs);
     cp.addPositionalArgument("words", "words to be converted to pinyin");
     cp.addHelpOption();
 
@@ -42,7 +52,7 @@ int main(int argc, char **argv)
 
     QString words = cp.positionalArguments().join(" ");
 
-    if (words.isEmpty()) {
+    if (words.isEmpty() && !cp.isSet(input)) {
         cp.showHelp();
     }
 
@@ -54,6 +64,27 @@ int main(int argc, char **argv)
     else if (!tones.compare("numtones"))
         ts = TS_ToneNum;
 
+    if (cp.isSet(input)) {
+        QStringList lines;
+        QTextStream in(stdin);
+        while (!in.atEnd())
+            lines << in.readLine();
+
+        QElapsedTimer timer;
+        timer.start();
+        const int threadCount = cp.value(jobs).toInt();
+        const DPinyinBatch &batch = cp.isSet(letters) ? batchFirstLetters(lines, ts, threadCount)
+                                                      : batchPinyin(lines, ts, threadCount);
+        const qint64 elapsed = timer.elapsed();
+
+        for (int i = 0; i < batch.size(); ++i)
+            printf("%s\n", qPrintable(batch.at(i).join(" ")));
+
+        std:: cout << "Total lines: " << batch.size() << ", size: " << batch.values.size()
+                   << ", time:" << elapsed << " ms" << std::endl;
+        return 0;
+    }
+
     QElapsedTimer timer;
     timer.start();
 
@@ -9,10 +9,18 @@
 #include <QFileInfo>
 #include <QFile>
 #include <QDebug>
+#include <QCollator>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <functional>
 
 #include <unistd.h>
 
 #include "dci/ddcifile.h"
+#include "dci/ddcifilewriter.h"
 
 static QString getSymLinkTarget(const QString &file, const QString &originPath) {
     char target[512] = {0};
@@ -29,23 +37,33 @@ static QString getSymLinkTarget(const QString &file, const QString &originPath)
     return tar;
 }
 
-static bool copyFilesToDci(DDciFile *dci, const QString &targetDir, const QString &sourceDir, const QString &originPath) {
+static bool copyFilesToWriter(DDciFileWriter *writer, const QString &sourceDir, const QString &originPath, bool compress) {
     QDir dir(sourceDir);
-    for (const auto &info : dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot)) {
-        const QString &newFile = QDir(targetDir).filePath(info.fileName());
+    auto entries = dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot);
+    // the writer requires the entries in the order of the DCI standard
+    QCollator collator(QLocale::English);
+    collator.setNumericMode(true);
+    std::sort(entries.begin(), entries.end(), [&collator](const QFileInfo &a, const QFileInfo &b) {
+        return collator.compare(a.fileName(), b.fileName()) < 0;
+    });
+
+    for (const auto &info : entries) {
         if (info.isDir()) {
-            if (!dci->mkdir(newFile))
+            if (!writer->beginDirectory(info.fileName()))
+                return false;
+            if (!copyFilesToWriter(writer, info.absoluteFilePath(), originPath, compress))
                 return false;
-            if (!copyFilesToDci(dci, newFile, info.absoluteFilePath(), originPath))
+            if (!writer->endDirectory())
                 return false;
         } else if (info.isSymLink()) {
-            if (!dci->link(getSymLinkTarget(info.absoluteFilePath(), originPath), newFile))
+            if (!writer->link(info.fileName(), getSymLinkTarget(info.absoluteFilePath(), originPath)))
                 return false;
         } else if (info.isFile()) {
             QFile file(info.absoluteFilePath());
             if (!file.open(QIODevice::ReadOnly))
                 return false;
-            if (!dci->writeFile(newFile, file.readAll()))
+            if (compress ? !writer->writeCompressedFile(info.fileName(), file.readAll())
+                         : !writer->writeFile(info.fileName(), &file))
                 return false;
         }
     }
@@ -57,7 +75,7 @@ QString cleanPath(const QString &path) {
     return path.size() < 2 || !path.endsWith(QDir::separator()) ? path : path.chopped(1);
 }
 
-bool createTo(const QString &sourceDir, const QString &targetDir) {
+bool createTo(const QString &sourceDir, const QString &targetDir, int version, bool compress) {
     QFileInfo info(cleanPath(sourceDir));
     if (!info.isDir())
         return false;
@@ -74,11 +92,21 @@ bool createTo(const QString &sourceDir, const QString &targetDir) {
         return false;
     }
 
-    DDciFile dci;
-    if (!copyFilesToDci(&dci, "/", sourceDir, sourceDir))
+    QFile file(newFile);
+    // the sources of the parallel jobs may have the same name
+    if (!file.open(QIODevice::ReadWrite | QIODevice::NewOnly)) {
+        printf("The path \"%s\" already exists.\n", qPrintable(newFile));
         return false;
+    }
 
-    return dci.writeToFile(newFile);
+    DDciFileWriter writer(&file, version);
+    if (!copyFilesToWriter(&writer, sourceDir, sourceDir, compress) || !writer.finish()) {
+        printf("Failed to write \"%s\": %s\n", qPrintable(newFile), qPrintable(writer.lastErrorString()));
+        file.remove();
+        return false;
+    }
+
+    return true;
 }
 
 static bool copyFilesFromDci(const DDciFile *dci, const QString &targetDir, const QString &sourceDir, QMap<QString, QString> &pathMap) {
@@ -198,6 +226,40 @@ bool tree(const QString &dciFile)
     return true;
 }
 
+class Job : public QRunnable
+{
+public:
+    Job(const std::function<bool(const QString &)> &task, const QString &input, bool *result)
+        : task(task), input(input), result(result) {}
+
+    void run() override {
+        *result = task(input);
+    }
+
+private:
+    const std::function<bool(const QString &)> &task;
+    QString input;
+    bool *result;
+};
+
+// Runs the task for every input in `jobs` threads, the results keep the order of the inputs.
+static QVector<bool> runJobs(const QStringList &inputs, int jobs, const std::function<bool(const QString &)> &task)
+{
+    QVector<bool> results(inputs.size(), false);
+    if (jobs <= 1) {
+        for (int i = 0; i < inputs.size(); ++i)
+            results[i] = task(inputs.at(i));
+        return results;
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(jobs);
+    for (int i = 0; i < inputs.size(); ++i)
+        pool.start(new Job(task, inputs.at(i), &results[i]));
+    pool.waitForDone();
+    return results;
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
@@ -212,7 +274,10 @@ int main(int argc, char *argv[])
                                             "you can easily make the DCI icons with this tool.\n"
                                             "The commands of DCI tools can be expressed as follows:\n"
                                             "\t dci --create [target file path] [source directory path]\n"
+                                            "\t dci --create [target file path] --format-version 2 [source directory path]\n"
+                                            "\t dci --create [target file path] --format-version 3 --compress [source directory path]\n"
                                             "\t dci --export [target directory path] [source file path]\n"
+                                            "\t dci --create [target file path] -j 8 [source directory path...]\n"
                                             "\t dci --tree [target file path]\n"
                                             "For example, the tool is used in the following ways: \n"
                                             "\t dci --create ~/Desktop ~/Desktop/action_add\n"
@@ -224,6 +289,13 @@ int main(int argc, char *argv[])
         QCommandLineOption("create", "Create the new dci files by the directorys", "targetDirectiry"),
         QCommandLineOption("export", "Export the dci files to the directorys", "targetDirectory"),
         QCommandLineOption("tree", "tree view the dci file", "targetDciFile"),
+        QCommandLineOption("format-version", "The format version of the created dci files, 1, 2 or 3, "
+                                             "the version 2 is indexed and not readable by the old readers, "
+                                             "the version 3 supports the compressed files", "version", "1"),
+        QCommandLineOption(QStringList{"j", "jobs"}, "Create or export the sources in parallel by the number of jobs, "
+                                                     "0 means the number of the CPU cores", "jobs", "1"),
+        QCommandLineOption("compress", "Compress the files of the created dci files by zstd, "
+                                       "it requires the format version 3"),
     };
     commandParser.addOptions(options);
     commandParser.addPositionalArgument("sources", "The directorys of create or the dci files of export",
@@ -232,16 +304,44 @@ int main(int argc, char *argv[])
     commandParser.addVersionOption();
     commandParser.process(a);
 
+    bool ok = false;
+    int jobs = commandParser.value(options.at(4)).toInt(&ok);
+    if (!ok || jobs < 0) {
+        printf("Invalid number of jobs: \"%s\"\n", qPrintable(commandParser.value(options.at(4))));
+        return -1;
+    }
+    if (jobs == 0)
+        jobs = QThread::idealThreadCount();
+
+    const QStringList &sources = commandParser.positionalArguments();
     if (commandParser.isSet(options.at(0))) {
-        for (const QString &dir : commandParser.positionalArguments()) {
-            if (!createTo(dir, commandParser.value(options.at(0)))) {
-                printf("Failed on create dci file for \"%s\"\n", qPrintable(dir));
+        const int version = commandParser.value(options.at(3)).toInt();
+        if (version < 1 || version > 3) {
+            printf("Not supported format version: \"%s\"\n", qPrintable(commandParser.value(options.at(3))));
+            return -1;
+        }
+        const bool compress = commandParser.isSet(options.at(5));
+        if (compress && version < 3) {
+            printf("The compressed files require the format version 3\n");
+            return -1;
+        }
+        const QString &targetDir = commandParser.value(options.at(0));
+        const auto &results = runJobs(sources, jobs, [&targetDir, version, compress](const QString &dir) {
+            return createTo(dir, targetDir, version, compress);
+        });
+        for (int i = 0; i < sources.size(); ++i) {
+            if (!results.at(i)) {
+                printf("Failed on create dci file for \"%s\"\n", qPrintable(sources.at(i)));
             }
         }
     } else if (commandParser.isSet(options.at(1))) {
-        for (const QString &dci : commandParser.positionalArguments()) {
-            if (!exportTo(dci, commandParser.value(options.at(1)))) {
-                printf("Failed on export the \"%s\" dci file\n", qPrintable(dci));
+        const QString &targetDir = commandParser.value(options.at(1));
+        const auto &results = runJobs(sources, jobs, [&targetDir](const QString &dci) {
+            return exportTo(dci, targetDir);
+        });
+        for (int i = 0; i < sources.size(); ++i) {
+            if (!results.at(i)) {
+                printf("Failed on export the \"%s\" dci file\n", qPrintable(sources.at(i)));
             }
         }
     } else if (commandParser.isSet(options.at(2))) {
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "dconfigfile.h"
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+
+#include <stdio.h>
+
+DCORE_USE_NAMESPACE
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Load the configurations of the DConfig prefetch lists to warm the shared caches, "
+                                     "it's run at the start of the session.");
+    parser.addHelpOption();
+    QCommandLineOption prefixOption({"p", "prefix"}, "The directory prefix of the meta and cache files.", "prefix");
+    parser.addOption(prefixOption);
+    QCommandLineOption listOption({"l", "list"}, "Print the configurations instead of loading them.");
+    parser.addOption(listOption);
+    parser.process(app);
+
+    const QString &prefix = parser.value(prefixOption);
+    const auto &entries = DConfigFile::prefetchEntries(prefix);
+    if (parser.isSet(listOption)) {
+        for (const auto &entry : entries)
+            printf("%s\t%s\t%s\n", qPrintable(entry.appId), qPrintable(entry.name), qPrintable(entry.subpath));
+        return 0;
+    }
+
+    const int count = DConfigFile::prefetch(entries, prefix);
+    if (count != entries.size())
+        fprintf(stderr, "Prefetched %d of %d configurations\n", count, int(entries.size()));
+
+    return 0;
+}
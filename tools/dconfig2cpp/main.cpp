@@ -11,12 +11,13 @@
 #include <QDebug>
 #include <QCommandLineParser>
 #include <QFileInfo>
+#include <QMap>
 
 struct Version {
     quint16 major;
     quint16 minor;
 };
-static constexpr Version ToolVersion{1, 1};
+static constexpr Version ToolVersion{1, 2};
 
 static QString toUnicodeEscape(const QString& input) {
     QString result;
@@ -44,6 +45,33 @@ static bool isOriginalValueFloat(const QByteArray& jsonData, const QString& prop
     return false;
 }
 
+// FNV-1a over the UTF-16 code units, the generated keyIndex() computes the same hash at runtime.
+static quint32 keyHash(const QString &key) {
+    quint32 hash = 2166136261u;
+    for (QChar ch : key) {
+        hash ^= ch.unicode();
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Maps the property's C++ type to the QMetaType::Type recorded in the schema table
+static QString metaTypeName(const QString &typeName) {
+    if (typeName == QLatin1String("bool"))
+        return QLatin1String("QMetaType::Bool");
+    if (typeName == QLatin1String("QString"))
+        return QLatin1String("QMetaType::QString");
+    if (typeName == QLatin1String("qlonglong"))
+        return QLatin1String("QMetaType::LongLong");
+    if (typeName == QLatin1String("double"))
+        return QLatin1String("QMetaType::Double");
+    if (typeName == QLatin1String("QList<QVariant>"))
+        return QLatin1String("QMetaType::QVariantList");
+    if (typeName == QLatin1String("QVariantMap"))
+        return QLatin1String("QMetaType::QVariantMap");
+    return QLatin1String("QMetaType::UnknownType");
+}
+
 // Converts a QJsonValue to a corresponding C++ code representation
 static QString jsonValueToCppCode(const QJsonValue &value){
     if (value.isBool()) {
@@ -113,6 +141,21 @@ int main(int argc, char *argv[]) {
                                  QLatin1String("Do not generate comments in the generated code"));
     parser.addOption(noComment);
 
+    QCommandLineOption coalesceSetters(QStringList() << QLatin1String("coalesce-setters"),
+                                       QLatin1String("Coalesce the values written by the setters, the latest value of each key is "
+                                                     "written once per event loop iteration"));
+    parser.addOption(coalesceSetters);
+
+    QCommandLineOption coalesceInterval(QStringList() << QLatin1String("coalesce-interval"),
+                                        QLatin1String("Interval in milliseconds to flush the coalesced values, implies --coalesce-setters"),
+                                        QLatin1String("msec"));
+    parser.addOption(coalesceInterval);
+
+    QCommandLineOption directMode(QStringList() << QLatin1String("direct"),
+                                  QLatin1String("Create DConfig instance in the thread of the generated object, the values are read "
+                                                "before the constructor returns and written without a worker thread"));
+    parser.addOption(directMode);
+
     parser.addPositionalArgument(QLatin1String("json-file"), QLatin1String("Path to the input JSON file"));
     parser.process(app);
 
@@ -121,6 +164,23 @@ int main(int argc, char *argv[]) {
         parser.showHelp(-1);
     }
 
+    const bool direct = parser.isSet(directMode);
+    if (direct && parser.isSet(forceRequestThread)) {
+        qWarning() << QLatin1String("--direct can't be used with --force-request-thread");
+        return -1;
+    }
+
+    const bool coalesce = parser.isSet(coalesceSetters) || parser.isSet(coalesceInterval);
+    int flushInterval = 0;
+    if (parser.isSet(coalesceInterval)) {
+        bool ok = false;
+        flushInterval = parser.value(coalesceInterval).toInt(&ok);
+        if (!ok || flushInterval < 0) {
+            qWarning() << QLatin1String("Invalid coalesce interval:") << parser.value(coalesceInterval);
+            return -1;
+        }
+    }
+
     QString className = parser.value(classNameOption);
     const QString jsonFileName = QFileInfo(args.first()).completeBaseName();
     if (className.isEmpty()) {
@@ -218,12 +278,16 @@ int main(int argc, char *argv[]) {
     headerStream << "#include <QVariant>\n";
     headerStream << "#include <QPointer>\n";
     headerStream << "#include <QDebug>\n";
-    headerStream << "#include <QAtomicPointer>\n";
-    headerStream << "#include <QAtomicInteger>\n";
+    if (!direct) {
+        headerStream << "#include <QAtomicPointer>\n";
+        headerStream << "#include <QAtomicInteger>\n";
+    }
     headerStream << "#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)\n"
                  << "#include <QProperty>\n"
                  << "#endif\n";
     headerStream << "#include <QEvent>\n";
+    if (coalesce && flushInterval > 0)
+        headerStream << "#include <QTimer>\n";
     headerStream << "#include <DSGApplication>\n";
     headerStream << "#include <DConfig>\n\n";
     headerStream << "class " << className << " : public QObject {\n";
@@ -235,6 +299,9 @@ int main(int argc, char *argv[]) {
         QString capitalizedPropertyName;
         QString propertyNameString;
         QJsonValue defaultValue;
+        bool global;
+        bool noOverride;
+        bool readOnly;
     };
     QList<Property> properties;
     QStringList propertyNames;
@@ -254,6 +321,12 @@ int main(int argc, char *argv[]) {
         "m_config",
         "m_status",
         "m_data",
+        "Key",
+        "KeyCount",
+        "KeySchema",
+        "schema",
+        "keyIndex",
+        "defaultValue",
     };
 
     for (int i = 0; i <= (contents.size()) / 32; ++i) {
@@ -295,13 +368,17 @@ int main(int argc, char *argv[]) {
             capitalizedPropertyName[0] = capitalizedPropertyName[0].toUpper();
         }
 
+        const QJsonArray flags = obj[QLatin1String("flags")].toArray();
         propertyNames << propertyName;
         properties.append(Property({
             typeName,
             propertyName,
             capitalizedPropertyName,
             "QStringLiteral(\"" + propertyName + "\")",
-            obj[QLatin1String("value")]
+            obj[QLatin1String("value")],
+            flags.contains(QLatin1String("global")),
+            flags.contains(QLatin1String("nooverride")),
+            obj[QLatin1String("permissions")].toString() != QLatin1String("readwrite")
         }));
         propertyNameStrings << properties.last().propertyNameString;
 
@@ -315,9 +392,136 @@ int main(int argc, char *argv[]) {
     headerStream << "    Q_CLASSINFO(\"DConfigKeyList\", \"" << propertyNames.join(";") <<"\")\n"
                  << "    Q_CLASSINFO(\"DConfigFileName\", \"" << QString(jsonFileName).replace("\n", "\\n").replace("\r", "\\r") <<"\")\n"
                  << "    Q_CLASSINFO(\"DConfigFileVersion\", \"" << version <<"\")\n\n"
-                 << "public:\n"
-                 << "    explicit " << className
-                 << R"((QThread *thread, DTK_CORE_NAMESPACE::DConfigBackend *backend,
+                 << "public:\n";
+
+    // The key IDs are the indexes of the properties, they're used to dispatch without comparing strings.
+    headerStream << "    enum class Key : int {\n";
+    for (int i = 0; i < properties.size(); ++i)
+        headerStream << "        " << properties.at(i).propertyName << " = " << i << ",\n";
+    headerStream << "    };\n"
+                 << "    static constexpr int KeyCount = " << properties.size() << ";\n\n"
+                 << "    struct KeySchema {\n"
+                 << "        const char *name;\n"
+                 << "        int metaType;\n"
+                 << "        bool global;\n"
+                 << "        bool noOverride;\n"
+                 << "        bool readOnly;\n"
+                 << "    };\n"
+                 << "    static constexpr KeySchema schema(Key key) {\n"
+                 << "        switch (key) {\n";
+    for (const Property &property : properties) {
+        headerStream << "        case Key::" << property.propertyName << ":\n"
+                     << "            return { \"" << property.propertyName << "\", " << metaTypeName(property.typeName) << ", "
+                     << (property.global ? "true" : "false") << ", "
+                     << (property.noOverride ? "true" : "false") << ", "
+                     << (property.readOnly ? "true" : "false") << " };\n";
+    }
+    headerStream << "        }\n"
+                 << "        return { nullptr, QMetaType::UnknownType, false, false, false };\n"
+                 << "    }\n"
+                 << "    static QVariant defaultValue(Key key) {\n"
+                 << "        switch (key) {\n";
+    for (const Property &property : properties) {
+        headerStream << "        case Key::" << property.propertyName << ":\n"
+                     << "            return QVariant::fromValue<" << property.typeName << ">("
+                     << jsonValueToCppCode(property.defaultValue) << ");\n";
+    }
+    headerStream << "        }\n"
+                 << "        return QVariant();\n"
+                 << "    }\n";
+
+    // Group the keys by hash, the keys of the same hash are compared one by one.
+    QMap<quint32, QList<int>> hashBuckets;
+    for (int i = 0; i < properties.size(); ++i)
+        hashBuckets[keyHash(properties.at(i).propertyName)].append(i);
+
+    headerStream << "    // Returns the Key of the DConfig key, or -1 if it isn't a key of this class.\n"
+                 << "    static int keyIndex(const QString &key) {\n"
+                 << "        quint32 hash = 2166136261u;\n"
+                 << "        for (QChar ch : key) {\n"
+                 << "            hash ^= ch.unicode();\n"
+                 << "            hash *= 16777619u;\n"
+                 << "        }\n"
+                 << "        switch (hash) {\n";
+    for (auto it = hashBuckets.constBegin(); it != hashBuckets.constEnd(); ++it) {
+        headerStream << "        case 0x" << QString::number(it.key(), 16) << "u:\n";
+        for (int index : it.value()) {
+            headerStream << "            if (key == " << properties.at(index).propertyNameString << ")\n"
+                         << "                return " << index << ";\n";
+        }
+        headerStream << "            break;\n";
+    }
+    headerStream << "        default:\n"
+                 << "            break;\n"
+                 << "        }\n"
+                 << "        return -1;\n"
+                 << "    }\n\n";
+
+    // The DConfig instance is created by the same code in both modes, it's indented for the constructor body.
+    const auto configCreation = [](const QString &indent) {
+        const QString code = QLatin1String(R"(        DTK_CORE_NAMESPACE::DConfig *config = nullptr;
+        if (isGeneric) {
+            if (backend) {
+                config = DTK_CORE_NAMESPACE::DConfig::createGeneric(backend, name, subpath, nullptr);
+            } else {
+                config = DTK_CORE_NAMESPACE::DConfig::createGeneric(name, subpath, nullptr);
+            }
+        } else {
+            if (backend) {
+                if (appId.isNull()) {
+                    config = DTK_CORE_NAMESPACE::DConfig::create(backend, DTK_CORE_NAMESPACE::DSGApplication::id(),
+                                                                 name, subpath, nullptr);
+                } else {
+                    config = DTK_CORE_NAMESPACE::DConfig::create(backend, appId, name, subpath, nullptr);
+                }
+            } else {
+                if (appId.isNull()) {
+                    config = DTK_CORE_NAMESPACE::DConfig::create(DTK_CORE_NAMESPACE::DSGApplication::id(),
+                                                                 name, subpath, nullptr);
+                } else {
+                    config = DTK_CORE_NAMESPACE::DConfig::create(appId, name, subpath, nullptr);
+                }
+            }
+        })");
+        QString result;
+        for (const QString &line : code.split('\n')) {
+            if (!line.isEmpty())
+                result += indent + line;
+            result += '\n';
+        }
+        return result;
+    };
+
+    if (direct) {
+        headerStream << "    explicit " << className
+                     << R"((DTK_CORE_NAMESPACE::DConfigBackend *backend,
+                        const QString &name, const QString &appId, const QString &subpath,
+                        bool isGeneric, QObject *parent)
+                  : QObject(parent), m_data(new Data) {
+        m_data->m_userConfig = this;
+
+)" << configCreation(QString()) << R"(
+        if (!config || !config->isValid()) {
+            qWarning() << QLatin1String("Failed to create DConfig instance.");
+            delete config;
+            m_data->m_status = Data::Status::Failed;
+            // Queued, the caller connects the signal after the object is created
+            QMetaObject::invokeMethod(this, [this]() {
+                Q_EMIT configInitializeFailed();
+            }, Qt::QueuedConnection);
+            return;
+        }
+        config->setParent(m_data);
+        m_data->initialize(config);
+        m_data->m_status = Data::Status::Succeeded;
+        QMetaObject::invokeMethod(this, [this, config]() {
+            Q_EMIT configInitializeSucceed(config);
+        }, Qt::QueuedConnection);
+    }
+)";
+    } else {
+        headerStream << "    explicit " << className
+                     << R"((QThread *thread, DTK_CORE_NAMESPACE::DConfigBackend *backend,
                         const QString &name, const QString &appId, const QString &subpath,
                         bool isGeneric, QObject *parent)
                   : QObject(parent), m_data(new Data) {
@@ -345,31 +549,7 @@ int main(int argc, char *argv[]) {
                 return;
             }
 
-            DTK_CORE_NAMESPACE::DConfig *config = nullptr;
-            if (isGeneric) {
-                if (backend) {
-                    config = DTK_CORE_NAMESPACE::DConfig::createGeneric(backend, name, subpath, nullptr);
-                } else {
-                    config = DTK_CORE_NAMESPACE::DConfig::createGeneric(name, subpath, nullptr);
-                }
-            } else {
-                if (backend) {
-                    if (appId.isNull()) {
-                        config = DTK_CORE_NAMESPACE::DConfig::create(backend, DTK_CORE_NAMESPACE::DSGApplication::id(),
-                                                                     name, subpath, nullptr);
-                    } else {
-                        config = DTK_CORE_NAMESPACE::DConfig::create(backend, appId, name, subpath, nullptr);
-                    }
-                } else {
-                    if (appId.isNull()) {
-                        config = DTK_CORE_NAMESPACE::DConfig::create(DTK_CORE_NAMESPACE::DSGApplication::id(),
-                                                                     name, subpath, nullptr);
-                    } else {
-                        config = DTK_CORE_NAMESPACE::DConfig::create(appId, name, subpath, nullptr);
-                    }
-                }
-            }
-
+)" << configCreation(QLatin1String("    ")) << R"(
             if (!config || !config->isValid()) {
                 qWarning() << QLatin1String("Failed to create DConfig instance.");
 
@@ -412,54 +592,71 @@ int main(int argc, char *argv[]) {
         });
     }
 )";
+    }
 
     const QString jsonFileString = "QStringLiteral(u\"" + toUnicodeEscape(jsonFileName) + "\")";
-    // Generate constructors
-    if (parser.isSet(forceRequestThread))
-        headerStream << "    static " << className << "* create(QThread *thread, const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr)\n";
-    else
-        headerStream << "    static " << className << "* create(const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr, QThread *thread = DTK_CORE_NAMESPACE::DConfig::globalThread())\n";
-    headerStream << "    { return new " << className << "(thread, nullptr, " << jsonFileString << ", appId, subpath, false, parent); }\n";
-    if (parser.isSet(forceRequestThread))
-        headerStream << "    static " << className << "* create(QThread *thread, DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr)\n";
-    else
-        headerStream << "    static " << className << "* create(DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr, QThread *thread = DTK_CORE_NAMESPACE::DConfig::globalThread())\n";
-    headerStream << "    { return new " << className << "(thread, backend, " << jsonFileString << ", appId, subpath, false, parent); }\n";
-    if (parser.isSet(forceRequestThread))
-        headerStream << "    static " << className << "* createByName(QThread *thread, const QString &name, const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr)\n";
-    else
-        headerStream << "    static " << className << "* createByName(const QString &name, const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr, QThread *thread = DTK_CORE_NAMESPACE::DConfig::globalThread())\n";
-    headerStream << "    { return new " << className << "(thread, nullptr, name, appId, subpath, false, parent); }\n";
-    if (parser.isSet(forceRequestThread))
-        headerStream << "    static " << className << "* createByName(QThread *thread, DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &name, const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr)\n";
-    else
-        headerStream << "    static " << className << "* createByName(DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &name, const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr, QThread *thread = DTK_CORE_NAMESPACE::DConfig::globalThread())\n";
-    headerStream << "    { return new " << className << "(thread, backend, name, appId, subpath, false, parent); }\n";
-
-    if (parser.isSet(forceRequestThread))
-        headerStream << "    static " << className << "* createGeneric(QThread *thread, const QString &subpath = {}, QObject *parent = nullptr)\n";
-    else
-        headerStream << "    static " << className << "* createGeneric(const QString &subpath = {}, QObject *parent = nullptr, QThread *thread = DTK_CORE_NAMESPACE::DConfig::globalThread())\n";
-    headerStream << "    { return new " << className << "(thread, nullptr, " << jsonFileString << ", {}, subpath, true, parent); }\n";
-    if (parser.isSet(forceRequestThread))
-        headerStream << "    static " << className << "* create(QThread *thread, DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &subpath = {}, QObject *parent = nullptr)\n";
-    else
-        headerStream << "    static " << className << "* create(DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &subpath = {}, QObject *parent = nullptr, QThread *thread = DTK_CORE_NAMESPACE::DConfig::globalThread())\n";
-    headerStream << "    { return new " << className << "(thread, backend, " << jsonFileString << ", {}, subpath, true, parent); }\n";
-    if (parser.isSet(forceRequestThread))
-        headerStream << "    static " << className << "* createGenericByName(QThread *thread, const QString &name, const QString &subpath = {}, QObject *parent = nullptr)\n";
-    else
-        headerStream << "    static " << className << "* createGenericByName(const QString &name, const QString &subpath = {}, QObject *parent = nullptr, QThread *thread = DTK_CORE_NAMESPACE::DConfig::globalThread())\n";
-    headerStream << "    { return new " << className << "(thread, nullptr, name, {}, subpath, true, parent); }\n";
-    if (parser.isSet(forceRequestThread))
-        headerStream << "    static " << className << "* createGenericByName(QThread *thread, DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &name, const QString &subpath = {}, QObject *parent = nullptr)\n";
-    else
-        headerStream << "    static " << className << "* createGenericByName(DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &name, const QString &subpath = {}, QObject *parent = nullptr, QThread *thread = DTK_CORE_NAMESPACE::DConfig::globalThread())\n";
-    headerStream << "    { return new " << className << "(thread, backend, name, {}, subpath, true, parent); }\n";
+    // Generate constructors, the thread is the first argument with --force-request-thread, the last one
+    // by default, and there is no thread with --direct.
+    const auto writeFactory = [&](const QString &name, const QString &parameters, const QString &arguments) {
+        headerStream << "    static " << className << "* " << name << "(";
+        if (parser.isSet(forceRequestThread))
+            headerStream << "QThread *thread, " << parameters;
+        else if (direct)
+            headerStream << parameters;
+        else
+            headerStream << parameters << ", QThread *thread = DTK_CORE_NAMESPACE::DConfig::workerThread()";
+        headerStream << ")\n"
+                     << "    { return new " << className << "(" << (direct ? "" : "thread, ") << arguments << "); }\n";
+    };
+    writeFactory("create", "const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr",
+                 "nullptr, " + jsonFileString + ", appId, subpath, false, parent");
+    writeFactory("create", "DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr",
+                 "backend, " + jsonFileString + ", appId, subpath, false, parent");
+    writeFactory("createByName", "const QString &name, const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr",
+                 "nullptr, name, appId, subpath, false, parent");
+    writeFactory("createByName", "DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &name, const QString &appId = {}, const QString &subpath = {}, QObject *parent = nullptr",
+                 "backend, name, appId, subpath, false, parent");
+
+    writeFactory("createGeneric", "const QString &subpath = {}, QObject *parent = nullptr",
+                 "nullptr, " + jsonFileString + ", {}, subpath, true, parent");
+    writeFactory("create", "DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &subpath = {}, QObject *parent = nullptr",
+                 "backend, " + jsonFileString + ", {}, subpath, true, parent");
+    writeFactory("createGenericByName", "const QString &name, const QString &subpath = {}, QObject *parent = nullptr",
+                 "nullptr, name, {}, subpath, true, parent");
+    writeFactory("createGenericByName", "DTK_CORE_NAMESPACE::DConfigBackend *backend, const QString &name, const QString &subpath = {}, QObject *parent = nullptr",
+                 "backend, name, {}, subpath, true, parent");
 
     // Destructor
-    headerStream << "    ~" << className << R"(() {
-        m_data->m_userConfig = nullptr;
+    headerStream << "    ~" << className << "() {\n";
+    if (coalesce)
+        headerStream << "        m_data->flushValues();\n";
+    if (direct) {
+        headerStream << R"(        m_data->m_userConfig = nullptr;
+        // The config is a child of m_data
+        delete m_data.data();
+    }
+
+    Q_INVOKABLE DTK_CORE_NAMESPACE::DConfig *config() const {
+        return m_data->m_config;
+    }
+    // Deprecated: Use isInitializeSucceeded() instead
+    Q_INVOKABLE Q_DECL_DEPRECATED_X("Use isInitializeSucceeded() instead")
+    bool isInitializeSucceed() const {
+        return isInitializeSucceeded();
+    }
+    Q_INVOKABLE bool isInitializeSucceeded() const {
+        return m_data->m_status == Data::Status::Succeeded;
+    }
+    Q_INVOKABLE bool isInitializeFailed() const {
+        return m_data->m_status == Data::Status::Failed;
+    }
+    Q_INVOKABLE bool isInitializing() const {
+        return m_data->m_status == Data::Status::Initializing;
+    }
+
+)";
+    } else {
+        headerStream << R"(        m_data->m_userConfig = nullptr;
         int oldStatus = m_data->m_status.fetchAndStoreOrdered(static_cast<int>(Data::Status::Destroyed));
         if (oldStatus == static_cast<int>(Data::Status::Succeeded)) {
             // When Succeeded, release config object only
@@ -492,17 +689,15 @@ int main(int argc, char *argv[]) {
     }
 
 )";
+    }
 
     headerStream << "    Q_INVOKABLE QStringList keyList() const {\n"
                  << "        return { " << propertyNameStrings.join(",\n                 ") << "};\n"
                  << "    }\n\n";
 
-    headerStream << "    Q_INVOKABLE bool isDefaultValue(const QString &key) const {\n";
-    for (int i = 0; i < properties.size(); ++i) {
-        headerStream << "        if (key == " << properties.at(i).propertyNameString << ")\n"
-                     << "            return " << properties.at(i).propertyName << "IsDefaultValue();\n";
-    }
-    headerStream << "        return false;\n"
+    headerStream << "    Q_INVOKABLE bool isDefaultValue(const QString &key) const {\n"
+                 << "        const int index = keyIndex(key);\n"
+                 << "        return index >= 0 && !m_data->testPropertySet(index);\n"
                  << "    }\n\n";
 
     // Generate property getter and setter methods
@@ -518,24 +713,38 @@ int main(int argc, char *argv[]) {
         headerStream << "    void set" << property.capitalizedPropertyName << "(const " << property.typeName << " &value) {\n"
                      << "        auto oldValue = m_data->p_" << property.propertyName << ";\n"
                      << "        m_data->p_" << property.propertyName << " = value;\n"
-                     << "        m_data->markPropertySet(" << i << ");\n"
-                     << "        if (auto config = m_data->m_config.loadRelaxed()) {\n"
-                     << "            QMetaObject::invokeMethod(config, [config, value]() {\n"
-                     << "                config->setValue(" << property.propertyNameString << ", value);\n"
-                     << "            });\n"
-                     << "        }\n"
-                     << "        if (m_data->p_" << property.propertyName << " != oldValue) {\n"
+                     << "        m_data->markPropertySet(" << i << ");\n";
+        if (coalesce) {
+            headerStream << "        m_data->queueValue(" << property.propertyNameString << ", QVariant::fromValue(value));\n";
+        } else if (direct) {
+            headerStream << "        if (auto config = m_data->m_config)\n"
+                         << "            config->setValue(" << property.propertyNameString << ", value);\n";
+        } else {
+            headerStream << "        if (auto config = m_data->m_config.loadRelaxed()) {\n"
+                         << "            QMetaObject::invokeMethod(config, [config, value]() {\n"
+                         << "                config->setValue(" << property.propertyNameString << ", value);\n"
+                         << "            });\n"
+                         << "        }\n";
+        }
+        headerStream << "        if (m_data->p_" << property.propertyName << " != oldValue) {\n"
                      << "            Q_EMIT " << property.propertyName << "Changed();\n"
                      << "            Q_EMIT valueChanged(" << property.propertyNameString << ", value);\n"
                      << "        }\n"
                      << "    }\n"
-                     << "    void reset" << property.capitalizedPropertyName << "() {\n"
-                     << "        if (auto config = m_data->m_config.loadRelaxed()) {\n"
-                     << "            QMetaObject::invokeMethod(config, [config]() {\n"
-                     << "                config->reset(" << property.propertyNameString << ");\n"
-                     << "            });\n"
-                     << "        }\n"
-                     << "    }\n";
+                     << "    void reset" << property.capitalizedPropertyName << "() {\n";
+        if (coalesce)
+            headerStream << "        m_data->m_pendingValues.remove(" << property.propertyNameString << ");\n";
+        if (direct) {
+            headerStream << "        if (auto config = m_data->m_config)\n"
+                         << "            config->reset(" << property.propertyNameString << ");\n";
+        } else {
+            headerStream << "        if (auto config = m_data->m_config.loadRelaxed()) {\n"
+                         << "            QMetaObject::invokeMethod(config, [config]() {\n"
+                         << "                config->reset(" << property.propertyNameString << ");\n"
+                         << "            });\n"
+                         << "        }\n";
+        }
+        headerStream << "    }\n";
         headerStream << "#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)\n";
         headerStream << "    QBindable<" << property.typeName << "> bindable" << property.capitalizedPropertyName << "() {\n"
                      << "        return QBindable<" << property.typeName << ">(this, \"" << property.propertyName << "\");\n"
@@ -577,58 +786,122 @@ int main(int argc, char *argv[]) {
                  << "        explicit Data()\n"
                  << "            : QObject(nullptr) {}\n"
                  << "\n"
-                 << "        inline void initializeInConfigThread(DTK_CORE_NAMESPACE::DConfig *config) {\n"
-                 << "            Q_ASSERT(!m_config.loadRelaxed());\n"
-                 << "            m_config.storeRelaxed(config);\n";
-
+                 << "        inline void " << (direct ? "initialize" : "initializeInConfigThread") << "(DTK_CORE_NAMESPACE::DConfig *config) {\n"
+                 << (direct ? "            Q_ASSERT(!m_config);\n"
+                            "            m_config = config;\n"
+                            : "            Q_ASSERT(!m_config.loadRelaxed());\n"
+                              "            m_config.storeRelaxed(config);\n");
+
+    // The properties not set by the user are read in one call and published in one queued event.
+    headerStream << "            QStringList keys;\n";
     for (int i = 0; i < properties.size(); ++i) {
         const Property &property = properties[i];
         headerStream << "            if (testPropertySet(" << i << ")) {\n";
         headerStream << "                config->setValue(" << property.propertyNameString << ", QVariant::fromValue(p_" << property.propertyName << "));\n";
         headerStream << "            } else {\n";
-        headerStream << "                updateValue(" << property.propertyNameString << ", QVariant::fromValue(p_" << property.propertyName << "));\n";
+        headerStream << "                keys << " << property.propertyNameString << ";\n";
         headerStream << "            }\n";
     }
 
-    headerStream << "            connect(config, &DTK_CORE_NAMESPACE::DConfig::valueChanged, this, [this](const QString &key) {\n"
+    headerStream << "            if (!keys.isEmpty())\n"
+                 << "                updateValues(config->values(keys));\n"
+                 << "            connect(config, &DTK_CORE_NAMESPACE::DConfig::valueChanged, this, [this](const QString &key) {\n"
                  << "                updateValue(key);\n"
                  << "            }, Qt::DirectConnection);\n"
-                 << R"(        }
+                 << "        }\n\n";
 
-        inline void updateValue(const QString &key, const QVariant &fallback = QVariant()) {
+    // The values are applied in place with --direct, otherwise they're queued to the thread of the generated object.
+    if (direct) {
+        headerStream << R"(        inline void updateValue(const QString &key) {
+            if (!m_config)
+                return;
+            const int index = keyIndex(key);
+            if (index < 0)
+                return;
+            markPropertySet(index, !m_config->isDefaultValue(key));
+            applyValue(index, m_config->value(key));
+        }
+
+        inline void updateValues(const QVariantMap &values) {
+            for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+                const int index = keyIndex(it.key());
+                if (index < 0)
+                    continue;
+                markPropertySet(index, !m_config->isDefaultValue(it.key()));
+                // the key doesn't exist in the config, keep the default value.
+                if (it.value().isValid())
+                    applyValue(index, it.value());
+            }
+        }
+
+)";
+    } else {
+        headerStream << R"(        inline void updateValue(const QString &key) {
             if (!m_config.loadRelaxed())
                 return;
             Q_ASSERT(QThread::currentThread() == m_config.loadRelaxed()->thread());
-            const QVariant &value = m_config.loadRelaxed()->value(key, fallback);
+            const int index = keyIndex(key);
+            if (index < 0)
+                return;
+            markPropertySet(index, !m_config.loadRelaxed()->isDefaultValue(key));
+            const QVariant &value = m_config.loadRelaxed()->value(key);
+            QMetaObject::invokeMethod(this, [this, index, value]() {
+                applyValue(index, value);
+            });
+        }
+
+        inline void updateValues(const QVariantMap &values) {
+            Q_ASSERT(QThread::currentThread() == m_config.loadRelaxed()->thread());
+            for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+                const int index = keyIndex(it.key());
+                if (index >= 0)
+                    markPropertySet(index, !m_config.loadRelaxed()->isDefaultValue(it.key()));
+            }
+            QMetaObject::invokeMethod(this, [this, values]() {
+                for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+                    // the key doesn't exist in the config, keep the default value.
+                    if (it.value().isValid())
+                        applyValue(keyIndex(it.key()), it.value());
+                }
+            });
+        }
+
+)";
+    }
+
+    headerStream << R"(        inline void applyValue(const int index, const QVariant &value) {
+            if (!m_userConfig)
+                return;
+            Q_ASSERT(QThread::currentThread() == m_userConfig->thread());
+            switch (static_cast<Key>(index)) {
 )";
     for (int i = 0; i < properties.size(); ++i) {
         const Property &property = properties.at(i);
-        headerStream << "            if (key == " << property.propertyNameString << ") {\n";
-
-        headerStream << "                markPropertySet(" << i << ", !m_config.loadRelaxed()->isDefaultValue(key));\n";
-
-        headerStream << "                auto newValue = qvariant_cast<" << property.typeName << ">(value);\n"
-                     << "                QMetaObject::invokeMethod(this, [this, newValue, key, value]() {\n"
-                     << "                    if (m_userConfig && p_" << property.propertyName << " != newValue) {\n"
-                     << "                        Q_ASSERT(QThread::currentThread() == m_userConfig->thread());\n"
-                     << "                        p_" << property.propertyName << " = newValue;\n"
-                     << "                        Q_EMIT m_userConfig->" << property.propertyName << "Changed();\n"
-                     << "                        Q_EMIT m_userConfig->valueChanged(key, value);\n"
-                     << "                    }\n"
-                     << "                });\n"
+        headerStream << "            case Key::" << property.propertyName << ": {\n"
+                     << "                auto newValue = qvariant_cast<" << property.typeName << ">(value);\n"
+                     << "                if (p_" << property.propertyName << " != newValue) {\n"
+                     << "                    p_" << property.propertyName << " = newValue;\n"
+                     << "                    Q_EMIT m_userConfig->" << property.propertyName << "Changed();\n"
+                     << "                    Q_EMIT m_userConfig->valueChanged(" << property.propertyNameString << ", value);\n"
+                     << "                }\n"
                      << "                return;\n"
                      << "            }\n";
     }
-    headerStream << "        }\n";
+    headerStream << "            }\n"
+                 << "        }\n";
 
     // Mark property as set
     headerStream << "        inline void markPropertySet(const int index, bool on = true) {\n";
     for (int i = 0; i <= (properties.size()) / 32; ++i) {
+        const QString status = QLatin1String("m_propertySetStatus") + QString::number(i);
+        const QString bit = QString("(1 << (index - %1))").arg(i * 32);
         headerStream << "            if (index < " << (i + 1) * 32 << ") {\n"
                      << "                if (on)\n"
-                     << "                    m_propertySetStatus" << QString::number(i) << ".fetchAndOrOrdered(1 << (index - " << i * 32 << "));\n"
+                     << (direct ? "                    " + status + " |= " + bit + ";\n"
+                                : "                    " + status + ".fetchAndOrOrdered" + bit + ";\n")
                      << "                else\n"
-                     << "                    m_propertySetStatus" << QString::number(i) << ".fetchAndAndOrdered(~(1 << (index - " << i * 32 << ")));\n"
+                     << (direct ? "                    " + status + " &= ~" + bit + ";\n"
+                                : "                    " + status + ".fetchAndAndOrdered(~" + bit + ");\n")
                      << "                return;\n"
                      << "            }\n";
     }
@@ -638,19 +911,63 @@ int main(int argc, char *argv[]) {
     headerStream << "        inline bool testPropertySet(const int index) const {\n";
     for (int i = 0; i <= (properties.size()) / 32; ++i) {
         headerStream << "            if (index < " << (i + 1) * 32 << ") {\n"
-                     << "                return (m_propertySetStatus" << QString::number(i) << ".loadRelaxed() & (1 << (index - " << i * 32 << ")));\n"
+                     << "                return (m_propertySetStatus" << QString::number(i) << (direct ? "" : ".loadRelaxed()")
+                     << " & (1 << (index - " << i * 32 << ")));\n"
                      << "            }\n";
     }
     headerStream << "            Q_UNREACHABLE();\n"
                  << "        }\n";
 
-    headerStream << "        // Member variables\n"
-                 << "        QAtomicPointer<DTK_CORE_NAMESPACE::DConfig> m_config = nullptr;\n"
-                 << "        QAtomicInteger<int> m_status = static_cast<int>(Status::Invalid);\n"
-                 << "        QPointer<" << className << "> m_userConfig = nullptr;\n";
+    if (coalesce) {
+        headerStream << "        // Keeps the latest value of each key written by the setters, it's used in the owner thread only.\n"
+                     << "        inline void queueValue(const QString &key, const QVariant &value) {\n"
+                     << "            const bool scheduled = !m_pendingValues.isEmpty();\n"
+                     << "            m_pendingValues.insert(key, value);\n"
+                     << "            if (scheduled)\n"
+                     << "                return;\n";
+        if (flushInterval > 0) {
+            headerStream << "            QTimer::singleShot(" << flushInterval << ", this, [this]() {\n"
+                         << "                flushValues();\n"
+                         << "            });\n";
+        } else {
+            headerStream << "            QMetaObject::invokeMethod(this, [this]() {\n"
+                         << "                flushValues();\n"
+                         << "            }, Qt::QueuedConnection);\n";
+        }
+        headerStream << "        }\n"
+                     << "        inline void flushValues() {\n"
+                     << "            if (m_pendingValues.isEmpty())\n"
+                     << "                return;\n"
+                     << "            const QVariantMap values = std::move(m_pendingValues);\n"
+                     << "            m_pendingValues.clear();\n";
+        if (direct) {
+            headerStream << "            if (m_config)\n"
+                         << "                m_config->setValues(values);\n";
+        } else {
+            headerStream << "            // the values are written in initializeInConfigThread() if the config isn't created.\n"
+                         << "            if (auto config = m_config.loadRelaxed()) {\n"
+                         << "                QMetaObject::invokeMethod(config, [config, values]() {\n"
+                         << "                    config->setValues(values);\n"
+                         << "                });\n"
+                         << "            }\n";
+        }
+        headerStream << "        }\n";
+    }
+
+    headerStream << "        // Member variables\n";
+    if (direct) {
+        headerStream << "        DTK_CORE_NAMESPACE::DConfig *m_config = nullptr;\n"
+                     << "        Status m_status = Status::Invalid;\n";
+    } else {
+        headerStream << "        QAtomicPointer<DTK_CORE_NAMESPACE::DConfig> m_config = nullptr;\n"
+                     << "        QAtomicInteger<int> m_status = static_cast<int>(Status::Invalid);\n";
+    }
+    headerStream << "        QPointer<" << className << "> m_userConfig = nullptr;\n";
+    if (coalesce)
+        headerStream << "        QVariantMap m_pendingValues;\n";
 
     for (int i = 0; i <= (properties.size()) / 32; ++i) {
-        headerStream << "        QAtomicInteger<quint32> m_propertySetStatus" << i << " = 0;\n";
+        headerStream << "        " << (direct ? "quint32" : "QAtomicInteger<quint32>") << " m_propertySetStatus" << i << " = 0;\n";
     }
 
     headerStream << "\n        // Property storage\n";
@@ -9,6 +9,9 @@
 #include <QCommandLineParser>
 #include <QThread>
 #include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 #include <stdio.h>
 
@@ -25,6 +28,70 @@ void printDistributionOrgInfo(DSysInfo::OrgType type) {
     printf("%s Website: %s\n", qPrintable(sectionName), qPrintable(DSysInfo::distributionOrgWebsite(type).second));
 }
 
+QJsonObject distributionOrgInfo(DSysInfo::OrgType type) {
+    return {
+        {"name", DSysInfo::distributionOrgName(type)},
+        {"logo", DSysInfo::distributionOrgLogo(type)},
+        {"website", DSysInfo::distributionOrgWebsite(type).second},
+    };
+}
+
+// all the fields in one object, the sizes are in bytes, the fields which probe the hardware
+// (the firmware tables, the block devices and wtmp) are skipped if fast is set
+void printJson(bool fast) {
+    DSysInfo::InfoFields fields = DSysInfo::ComputerNameField | DSysInfo::MemoryTotalSizeField
+            | DSysInfo::BootTimeField | DSysInfo::UptimeField;
+    if (!fast) {
+        fields |= DSysInfo::CpuModelNameField | DSysInfo::MemoryInstalledSizeField
+                | DSysInfo::SystemDiskSizeField | DSysInfo::ShutdownTimeField;
+    }
+    // the hardware is probed while the release files are read
+    auto future = DSysInfo::queryAsync(fields);
+
+    QJsonObject root {
+        {"operatingSystemName", DSysInfo::operatingSystemName()},
+        {"productType", DSysInfo::productTypeString()},
+        {"productVersion", DSysInfo::productVersion()},
+        {"isDeepin", DSysInfo::isDeepin()},
+        {"isDDE", DSysInfo::isDDE()},
+        {"cpuCount", QThread::idealThreadCount()},
+    };
+
+    if (DSysInfo::isDeepin()) {
+        root.insert("deepinType", DSysInfo::deepinTypeDisplayName());
+        root.insert("deepinVersion", DSysInfo::deepinVersion());
+        root.insert("deepinEdition", DSysInfo::deepinEdition());
+        root.insert("deepinCopyright", DSysInfo::deepinCopyright());
+        root.insert("uosProductName", DSysInfo::uosProductTypeName());
+        root.insert("uosSystemName", DSysInfo::uosSystemName());
+        root.insert("uosEditionName", DSysInfo::uosEditionName());
+        root.insert("uosSpVersion", DSysInfo::spVersion());
+        root.insert("uosUpdateVersion", DSysInfo::udpateVersion());
+        root.insert("uosMajorVersion", DSysInfo::majorVersion());
+        root.insert("uosMinorVersion", DSysInfo::minorVersion());
+        root.insert("uosBuildVersion", DSysInfo::buildVersion());
+    }
+    if (distributionInfoValid()) {
+        root.insert("distribution", distributionOrgInfo(DSysInfo::Distribution));
+        root.insert("distributor", distributionOrgInfo(DSysInfo::Distributor));
+    }
+
+    future.waitForFinished();
+    const DSysInfo::Info &info = future.result();
+    root.insert("computerName", info.computerName);
+    root.insert("memorySize", info.memoryTotalSize);
+    root.insert("bootTime", info.bootTime.toString(Qt::ISODate));
+    root.insert("uptime", info.uptime);
+    if (!fast) {
+        root.insert("cpuModel", info.cpuModelName);
+        root.insert("installedMemorySize", info.memoryInstalledSize);
+        root.insert("diskSize", info.systemDiskSize);
+        root.insert("shutdownTime", info.shutdownTime.toString(Qt::ISODate));
+    }
+
+    printf("%s\n", QJsonDocument(root).toJson(QJsonDocument::Indented).constData());
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
@@ -32,6 +99,8 @@ int main(int argc, char *argv[])
 
     QCommandLineParser parser;
     QCommandLineOption option_all("all", "Print All Information");
+    QCommandLineOption option_json("json", "Print All Information in JSON, the sizes are in bytes");
+    QCommandLineOption option_fast("fast", "Skip the information which probes the hardware, used with --json");
     QCommandLineOption option_deepin_type("deepin-type", " ");
     QCommandLineOption option_deepin_version("deepin-version", " ");
     QCommandLineOption option_deepin_edition("deepin-edition", " ");
@@ -46,7 +115,7 @@ int main(int argc, char *argv[])
     QCommandLineOption option_distribution_info("distribution-info", "Distribution information");
     QCommandLineOption option_distributer_info("distributer-info", "Distributer information");
 
-    parser.addOptions({option_all, option_deepin_type, option_deepin_version, option_deepin_edition,
+    parser.addOptions({option_all, option_json, option_fast, option_deepin_type, option_deepin_version, option_deepin_edition,
                        option_deepin_copyright, option_product_type, option_product_version,
                        option_computer_name, option_cpu_model, option_installed_memory_size, option_memory_size,
                        option_disk_size, option_distribution_info, option_distributer_info});
@@ -57,7 +126,9 @@ int main(int argc, char *argv[])
     if (argc < 2)
         parser.showHelp();
 
-    if (parser.isSet(option_all)) {
+    if (parser.isSet(option_json)) {
+        printJson(parser.isSet(option_fast));
+    } else if (parser.isSet(option_all)) {
         printf("Computer Name: %s\n", qPrintable(DSysInfo::computerName()));
         printf("CPU Model: %s x %d\n", qPrintable(DSysInfo::cpuModelName()), QThread::idealThreadCount());
         printf("Installed Memory Size: %f GiB\n", DSysInfo::memoryInstalledSize() / 1024.0 / 1024 / 1024);
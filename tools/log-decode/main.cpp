@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2026 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "LogManager.h"
+
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QFile>
+
+#include <stdio.h>
+
+DCORE_USE_NAMESPACE
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Decode the binary log files written by DLogManager::setBinaryLogFormat.");
+    parser.addHelpOption();
+    QCommandLineOption formatOption({"f", "format"}, "The format of the records, the default format of DLogManager if it's empty.", "format");
+    parser.addOption(formatOption);
+    parser.addPositionalArgument("files", "The binary log files, they're decoded in order.", "files...");
+    parser.process(app);
+
+    const QStringList &files = parser.positionalArguments();
+    if (files.isEmpty())
+        parser.showHelp(1);
+
+    QFile output;
+    output.open(stdout, QIODevice::WriteOnly);
+    int ret = 0;
+    for (const QString &file : files) {
+        if (!DLogManager::decodeBinaryLog(file, &output, parser.value(formatOption))) {
+            fprintf(stderr, "Failed to decode %s\n", qPrintable(file));
+            ret = 1;
+        }
+    }
+
+    return ret;
+}
@@ -39,6 +39,7 @@ static bool skipNamespaces;
 static bool verbose;
 static bool includeMocs;
 static bool skipIncludeAnnotations;
+static bool asyncProxies;
 static QString commandLine;
 static QStringList includes;
 static QStringList wantedInterfaces;
@@ -49,6 +50,8 @@ static const char help[] =
     "\n"
     "Options:\n"
     "  -a <filename>    Write the adaptor code to <filename>\n"
+    "  -A               Generate cached, non-blocking proxies: the properties are fetched by one\n"
+    "                   GetAll and kept by PropertiesChanged, and the methods have QFuture wrappers\n"
     "  -c <classname>   Use <classname> as the class name for the generated classes\n"
     "  -h               Show this information\n"
     "  -i <filename>    Add #include to the output\n"
@@ -137,6 +140,10 @@ static void parseCmdLine(QStringList args)
             adaptorFile = nextArg(args, i, 'a');
             break;
 
+        case 'A':
+            asyncProxies = true;
+            break;
+
         case 'c':
             globalClassName = nextArg(args, i, 'c');
             break;
@@ -583,6 +590,9 @@ static void writeProxy(const QString &filename, const QDBusIntrospection::Interf
     hs << "#include <QtCore/QObject>" << endl
        << includeList
        << "#include <QtDBus/QtDBus>" << endl;
+    if (asyncProxies)
+        hs << "#include <QtCore/QFuture>" << endl
+           << "#include <QtCore/QFutureInterface>" << endl;
 
     foreach (const QString &include, includes) {
         hs << "#include \"" << include << "\"" << endl;
@@ -736,6 +746,12 @@ static void writeProxy(const QString &filename, const QDBusIntrospection::Interf
             }
         }
 
+        if (asyncProxies)
+            cs << endl
+               << "    // the getters never block, they return the values of GetAll and PropertiesChanged" << endl
+               << "    setSync(false, false);" << endl
+               << "    setPrefetch(true);" << endl;
+
         cs << "}" << endl
            << endl
            << className << "::~" << className << "()" << endl
@@ -906,6 +922,40 @@ static void writeProxy(const QString &filename, const QDBusIntrospection::Interf
                    << "    }" << endl;
             }
 
+            // QFuture version, canceled if the call fails
+            if (asyncProxies && !isNoReply && method.outputArgs.count() <= 1) {
+                const QString type = method.outputArgs.isEmpty()
+                    ? QStringLiteral("void")
+                    : templateArg(qtTypeName(method.outputArgs.first().type, method.annotations, 0, "Out"));
+
+                hs << "    inline "
+                   << (isDeprecated ? "Q_DECL_DEPRECATED " : "")
+                   << "QFuture<" << type << "> " << methodName(method) << "Future(";
+                writeArgList(hs, argNames, method.annotations, method.inputArgs);
+                hs << ")" << endl
+                   << "    {" << endl
+                   << "        QFutureInterface<" << type << "> promise;" << endl
+                   << "        promise.reportStarted();" << endl
+                   << "        auto watcher = new QDBusPendingCallWatcher(" << methodName(method) << "(" << argNames.mid(0, method.inputArgs.count()).join(QLatin1String(", ")) << "), this);" << endl
+                   << "        connect(watcher, &QDBusPendingCallWatcher::finished, this, [promise](QDBusPendingCallWatcher *w) mutable {" << endl
+                   << "            w->deleteLater();" << endl;
+                if (method.outputArgs.isEmpty()) {
+                    hs << "            if (w->isError())" << endl
+                       << "                promise.reportCanceled();" << endl;
+                } else {
+                    hs << "            const QDBusPendingReply<" << type << "> reply = *w;" << endl
+                       << "            if (reply.isError())" << endl
+                       << "                promise.reportCanceled();" << endl
+                       << "            else" << endl
+                       << "                promise.reportResult(reply.value());" << endl;
+                }
+                hs << "            promise.reportFinished();" << endl
+                   << "        });" << endl
+                   << "        return promise.future();" << endl
+                   << "    }" << endl
+                   << endl;
+            }
+
             hs << endl;
             if (method.outputArgs.count() > 1) {
                 const auto templateArgument = templateArg(qtTypeName(method.outputArgs.first().type, method.annotations, 0, "Out"));
@@ -15,8 +15,11 @@
 #include "settings/dsettingsoption.h"
 
 #include <QFile>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QFileInfo>
+#include <QRegularExpression>
 
 #include <QDomDocument>
 
@@ -34,6 +37,116 @@ static QString CppTemplate =
     "%1"
     "}\n";
 
+static QString SchemaTemplate =
+    "// This file was generated by dtk-settings-tools version " DTK_SETTINGS_TOOLS_VERSION " \n"
+    "\n"
+    "#include <DSettings>\n"
+    "\n"
+    "%1"
+    "extern const Dtk::Core::DSettingsCompiledSchema %2;\n"
+    "const Dtk::Core::DSettingsCompiledSchema %2 = {\n"
+    "    %3,\n"
+    "    %4, %5,\n"
+    "    %6, %7\n"
+    "};\n";
+
+// a C string literal of utf-8 \a data, the non-ascii bytes are escaped in octal
+static QString cStringLiteral(const QByteArray &data)
+{
+    QString literal("\"");
+    for (const char c : data) {
+        const uchar byte = static_cast<uchar>(c);
+        if (c == '"' || c == '\\') {
+            literal.append('\\').append(QLatin1Char(c));
+        } else if (c == '\n') {
+            literal.append("\\n");
+        } else if (byte < 0x20 || byte >= 0x7f) {
+            literal.append(QString("\\%1").arg(byte, 3, 8, QLatin1Char('0')));
+        } else {
+            literal.append(QLatin1Char(c));
+        }
+    }
+    return literal.append('"');
+}
+
+static void collectCompiledSchema(const QString &prefixKey, const QJsonObject &group,
+                                  QMap<QString, QString> &options, QStringList &groups)
+{
+    // the same keys as DSettingsGroup and DSettingsOption
+    auto key = group.value("key").toString();
+    key = prefixKey.isEmpty() ? key : prefixKey + "." + key;
+    groups << QString("    { %1, %2 },\n").arg(cStringLiteral(key.toUtf8()),
+                                               cStringLiteral(group.value("name").toString().toUtf8()));
+
+    for (auto optionJson : group.value("options").toArray()) {
+        auto option = optionJson.toObject();
+        auto optionKey = key + "." + option.value("key").toString();
+        auto jsonDefault = option.value("default");
+        auto value = jsonDefault.toVariant();
+
+        // the lists and the maps are kept as json text, see DSettings::fromCompiled
+        QByteArray defaultData;
+        if (jsonDefault.isArray()) {
+            defaultData = QJsonDocument(jsonDefault.toArray()).toJson(QJsonDocument::Compact);
+        } else if (jsonDefault.isObject()) {
+            defaultData = QJsonDocument(jsonDefault.toObject()).toJson(QJsonDocument::Compact);
+        } else {
+            defaultData = value.toString().toUtf8();
+        }
+
+        // one pass of arg(), the texts may contain '%'
+        options.insert(optionKey, QString("    { %1, %2, %3, %4, %5, %6, %7 },\n")
+                       .arg(cStringLiteral(optionKey.toUtf8()),
+                            cStringLiteral(option.value("type").toString().toUtf8()),
+                            QString::number(value.userType()),
+                            cStringLiteral(defaultData),
+                            QString(option.value("reset").toBool(true) ? "true" : "false"),
+                            cStringLiteral(option.value("name").toString().toUtf8()),
+                            cStringLiteral(option.value("text").toString().toUtf8())));
+    }
+
+    for (auto subGroup : group.value("groups").toArray())
+        collectCompiledSchema(key, subGroup.toObject(), options, groups);
+}
+
+static bool writeCompiledSchema(const QByteArray &json, const QString &name, const QString &cppPath)
+{
+    QMap<QString, QString> options;
+    QStringList groups;
+    auto meta = QJsonDocument::fromJson(json).object();
+    for (auto groupJson : meta.value("groups").toArray())
+        collectCompiledSchema("", groupJson.toObject(), options, groups);
+
+    QString arrays;
+    if (!options.isEmpty()) {
+        arrays.append(QString("static const Dtk::Core::DSettingsCompiledOption %1_options[] = {\n").arg(name));
+        for (auto option : options)
+            arrays.append(option);
+        arrays.append("};\n\n");
+    }
+    if (!groups.isEmpty()) {
+        arrays.append(QString("static const Dtk::Core::DSettingsCompiledGroup %1_groups[] = {\n").arg(name));
+        arrays.append(groups.join(""));
+        arrays.append("};\n\n");
+    }
+
+    QString cppCode = SchemaTemplate.arg(arrays,
+                                         name,
+                                         cStringLiteral(QJsonDocument(meta).toJson(QJsonDocument::Compact)),
+                                         QString::number(options.size()),
+                                         options.isEmpty() ? QString("nullptr") : name + "_options",
+                                         QString::number(groups.size()),
+                                         groups.isEmpty() ? QString("nullptr") : name + "_groups");
+
+    QFile file(cppPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(cppCode.toUtf8());
+    file.close();
+    return true;
+}
+
 /*
  *  GVariant Type Name/Code      C++ Type Name          QVariant Type Name
  *  --------------------------------------------------------------------------
@@ -257,8 +370,16 @@ int main(int argc, char *argv[])
     QCommandLineOption outputFileArg(QStringList() << "o" << "output",
                                      QCoreApplication::tr("Output cpp file"),
                                      "cpp-file");
+    QCommandLineOption schemaArg(QStringList() << "s" << "schema",
+                                 QCoreApplication::tr("Output cpp file of the compiled schema, load it with DSettings::fromCompiled"),
+                                 "cpp-file");
+    QCommandLineOption schemaNameArg(QStringList() << "schema-name",
+                                     QCoreApplication::tr("Variable name of the compiled schema, the json file name by default"),
+                                     "name");
     parser.addOption(gsettingsArg);
     parser.addOption(outputFileArg);
+    parser.addOption(schemaArg);
+    parser.addOption(schemaNameArg);
     parser.addPositionalArgument("json-file", QCoreApplication::tr("Json file description config"));
     parser.process(app);
 
@@ -344,6 +465,20 @@ int main(int argc, char *argv[])
         writeGSettingXML(settings, parseGSettingsMeta(jsonFile), outputXml);
     }
 
+    if (parser.isSet(schemaArg)) {
+        QString name = parser.value(schemaNameArg);
+        if (name.isEmpty()) {
+            name = QFileInfo(jsonFile).baseName().replace(QRegularExpression("[^A-Za-z0-9_]"), "_");
+        }
+
+        QFile file(jsonFile);
+        file.open(QIODevice::ReadOnly);
+        if (!writeCompiledSchema(file.readAll(), name, parser.value(schemaArg))) {
+            qCritical() << "can not open schema file!";
+            exit(1);
+        }
+    }
+
     delete settings;
     return 0;
 }